@@ -5,6 +5,7 @@
 #include "legato.h"
 
 #include "assetData.h"
+#include "timeSeriesSpool.h"
 #include "le_print.h"
 
 
@@ -245,6 +246,24 @@ void RunTest(void)
     LE_TEST(18 == value);
 
     LE_TEST(LE_NOT_FOUND == assetData_client_GetInt(testOneRefZero, 50, &value));
+    LE_TEST(LE_NOT_FOUND == assetData_client_GetInt(testOneRefZero, -1, &value));
+
+    // Field ids missing from the lwm2m object 9 model
+    LE_TEST(LE_NOT_FOUND == assetData_client_GetInt(lwm2mRefZero, 5, &value));
+    LE_TEST(LE_NOT_FOUND == assetData_client_GetInt(lwm2mRefZero, 13, &value));
+
+
+    banner("Field ids from names");
+    int fieldId;
+
+    LE_TEST(LE_OK == assetData_GetFieldIdFromName(testOneRefZero, "Bedroom/temp", &fieldId));
+    LE_TEST(4 == fieldId);
+    LE_TEST(LE_OK == assetData_GetFieldIdFromName(testOneRefOne, "Bathroom/humidity", &fieldId));
+    LE_TEST(14 == fieldId);
+    LE_TEST(LE_OK == assetData_GetFieldIdFromName(lwm2mRefZero, "Update Result", &fieldId));
+    LE_TEST(9 == fieldId);
+    LE_TEST(LE_FAULT == assetData_GetFieldIdFromName(testOneRefZero, "Bedroom", &fieldId));
+    LE_TEST(LE_FAULT == assetData_GetFieldIdFromName(testOneRefZero, "Garage/temp", &fieldId));
 
 
     banner("Read/Write integer fields as values");
@@ -397,10 +416,218 @@ void RunTest(void)
 }
 
 
+// Number of instances and of field accesses of the lookup benchmark
+#define BENCHMARK_INSTANCES 500
+#define BENCHMARK_ACCESSES 100000
+
+void RunLookupBenchmark(void)
+{
+    banner("Field lookup benchmark");
+
+    // Integer fields without write handlers
+    static const char* fieldNames[] = { "Livingroom/temp", "Bathroom/temp" };
+    assetData_InstanceDataRef_t instanceRefs[BENCHMARK_INSTANCES];
+    assetData_InstanceDataRef_t instanceRef;
+    le_clk_Time_t startTime;
+    le_clk_Time_t elapsedTime;
+    int firstInstanceId;
+    int fieldId;
+    int value;
+    int i;
+
+    for (i=0; i<BENCHMARK_INSTANCES; i++)
+    {
+        LE_ASSERT(LE_OK == assetData_CreateInstanceById("testOne", 1000, -1, &instanceRefs[i]));
+    }
+    LE_ASSERT(LE_OK == assetData_GetInstanceId(instanceRefs[0], &firstInstanceId));
+
+    // Access the instances as the LWM2M server does, by path, and the fields as le_avdata does,
+    // by name.
+    startTime = le_clk_GetRelativeTime();
+    for (i=0; i<BENCHMARK_ACCESSES; i++)
+    {
+        LE_ASSERT(LE_OK == assetData_GetInstanceRefById("testOne", 1000,
+                                                        firstInstanceId + i % BENCHMARK_INSTANCES,
+                                                        &instanceRef));
+        LE_ASSERT(LE_OK == assetData_GetFieldIdFromName(instanceRef, fieldNames[i % 2], &fieldId));
+        LE_ASSERT(LE_OK == assetData_client_SetInt(instanceRef, fieldId, i));
+        LE_ASSERT(LE_OK == assetData_client_GetInt(instanceRef, fieldId, &value));
+        LE_ASSERT(i == value);
+    }
+    elapsedTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    LE_INFO("%d field set/get on %d instances in %ld.%06ld s",
+            BENCHMARK_ACCESSES, BENCHMARK_INSTANCES,
+            (long)elapsedTime.sec, (long)elapsedTime.usec);
+
+    for (i=0; i<BENCHMARK_INSTANCES; i++)
+    {
+        assetData_DeleteInstance(instanceRefs[i]);
+    }
+    LE_TEST(LE_NOT_FOUND == assetData_GetInstanceRefById("testOne", 1000, firstInstanceId,
+                                                         &instanceRef));
+}
+
+
+#ifdef LEGATO_FEATURE_TIMESERIES
+
+// Number of samples per batch and number of batches of the time series test
+#define BATCH_SAMPLES 64
+#define BATCH_COUNT 100
+
+void RunTimeSeriesBatchTest(void)
+{
+    banner("Time series batches");
+
+    assetData_InstanceDataRef_t instanceRef;
+    uint64_t timeStamps[BATCH_SAMPLES];
+    int32_t intValues[BATCH_SAMPLES];
+    double floatValues[BATCH_SAMPLES];
+    size_t numRecorded;
+    le_result_t result;
+    bool isTimeSeries;
+    int numDataPoints;
+    le_clk_Time_t startTime;
+    le_clk_Time_t elapsedTime;
+    int value;
+    int i;
+    int j;
+
+    LE_ASSERT(timeSeriesSpool_IsEnabled());
+    LE_ASSERT(LE_OK == assetData_CreateInstanceById("testOne", 1000, -1, &instanceRef));
+
+    for (j=0; j<BATCH_SAMPLES; j++)
+    {
+        timeStamps[j] = 0;
+        intValues[j] = 0;
+        floatValues[j] = 0.0;
+    }
+
+    // Time series not started, or wrong field type
+    LE_TEST(LE_CLOSED == assetData_client_RecordIntBatch(instanceRef, 0, timeStamps, intValues,
+                                                         BATCH_SAMPLES, &numRecorded));
+    LE_TEST(0 == numRecorded);
+    LE_ASSERT(LE_OK == assetData_client_StartTimeSeries(instanceRef, 0, 1, 1));
+    LE_TEST(LE_FAULT == assetData_client_RecordFloatBatch(instanceRef, 0, timeStamps, floatValues,
+                                                          BATCH_SAMPLES, &numRecorded));
+
+    // The session is not open, so each full time series buffer is moved to the spool.
+    startTime = le_clk_GetRelativeTime();
+    for (i=0; i<BATCH_COUNT; i++)
+    {
+        for (j=0; j<BATCH_SAMPLES; j++)
+        {
+            timeStamps[j] = 1500000000000ULL + (uint64_t)(i * BATCH_SAMPLES + j) * 1000;
+            intValues[j] = i * BATCH_SAMPLES + j;
+        }
+
+        result = assetData_client_RecordIntBatch(instanceRef, 0, timeStamps, intValues,
+                                                 BATCH_SAMPLES, &numRecorded);
+        LE_ASSERT((LE_OK == result) || (LE_NO_MEMORY == result));
+        LE_ASSERT(BATCH_SAMPLES == numRecorded);
+    }
+    elapsedTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    LE_INFO("%d samples recorded in batches of %d in %ld.%06ld s, %u time series spooled",
+            BATCH_COUNT * BATCH_SAMPLES, BATCH_SAMPLES,
+            (long)elapsedTime.sec, (long)elapsedTime.usec, timeSeriesSpool_GetCount());
+
+    LE_TEST(timeSeriesSpool_GetCount() > 0);
+    LE_TEST(LE_OK == assetData_client_GetInt(instanceRef, 0, &value));
+    LE_TEST(BATCH_COUNT * BATCH_SAMPLES - 1 == value);
+    LE_TEST(LE_OK == assetData_client_GetTimeSeriesStatus(instanceRef, 0, &isTimeSeries,
+                                                          &numDataPoints));
+    LE_TEST(isTimeSeries);
+    LE_TEST((numDataPoints > 0) && (numDataPoints < BATCH_COUNT * BATCH_SAMPLES));
+
+    // Without session nor observe, the push goes to the spool too.
+    LE_TEST(LE_OK == assetData_client_PushTimeSeries(instanceRef, 0, false));
+    LE_TEST(LE_OK == assetData_client_GetTimeSeriesStatus(instanceRef, 0, &isTimeSeries,
+                                                          &numDataPoints));
+    LE_TEST(!isTimeSeries);
+
+    assetData_DeleteInstance(instanceRef);
+}
+
+
+// Push a time series of one sample to the spool
+static void SpoolOneSample(assetData_InstanceDataRef_t instanceRef, int value)
+{
+    uint64_t timeStamp = 1500000000000ULL + (uint64_t)value * 1000;
+    size_t numRecorded;
+
+    LE_ASSERT(LE_OK == assetData_client_RecordIntBatch(instanceRef, 0, &timeStamp, &value, 1,
+                                                       &numRecorded));
+    LE_ASSERT(LE_OK == assetData_client_PushTimeSeries(instanceRef, 0, true));
+}
+
+void RunTimeSeriesSpoolTest(void)
+{
+    banner("Time series spool");
+
+    assetData_InstanceDataRef_t observedRef;
+    assetData_InstanceDataRef_t unobservedRef;
+    uint8_t token = 1;
+    int halfCount = TIME_SERIES_SPOOL_SLOT_COUNT / 2;
+    int i;
+
+    LE_ASSERT(timeSeriesSpool_IsEnabled());
+    LE_ASSERT(0 == timeSeriesSpool_GetCount());
+    LE_ASSERT(LE_OK == assetData_CreateInstanceById("testOne", 1000, -1, &observedRef));
+    LE_ASSERT(LE_OK == assetData_CreateInstanceById("testOne", 1000, -1, &unobservedRef));
+    LE_ASSERT(LE_OK == assetData_client_StartTimeSeries(observedRef, 0, 1, 1));
+    LE_ASSERT(LE_OK == assetData_client_StartTimeSeries(unobservedRef, 0, 1, 1));
+
+    // Fill the spool with the time series of both fields, interleaved.
+    assetData_SessionStatus(ASSET_DATA_SESSION_UNAVAILABLE);
+    for (i=0; i<halfCount; i++)
+    {
+        SpoolOneSample(observedRef, i);
+        SpoolOneSample(unobservedRef, i);
+    }
+    LE_TEST(TIME_SERIES_SPOOL_SLOT_COUNT == timeSeriesSpool_GetCount());
+
+    // Only the time series of the observed field leave the spool.
+    assetData_SessionStatus(ASSET_DATA_SESSION_AVAILABLE);
+    LE_TEST(TIME_SERIES_SPOOL_SLOT_COUNT == timeSeriesSpool_GetCount());
+    LE_ASSERT(LE_OK == assetData_SetObserve(observedRef, true, &token, sizeof(token)));
+    LE_TEST(halfCount == timeSeriesSpool_GetCount());
+
+    // The slots freed between the remaining time series are used before any is dropped.
+    assetData_SessionStatus(ASSET_DATA_SESSION_UNAVAILABLE);
+    for (i=halfCount; i<TIME_SERIES_SPOOL_SLOT_COUNT; i++)
+    {
+        SpoolOneSample(unobservedRef, i);
+        LE_TEST(i + 1 == timeSeriesSpool_GetCount());
+    }
+
+    // The spool is full: the oldest time series is dropped.
+    SpoolOneSample(unobservedRef, TIME_SERIES_SPOOL_SLOT_COUNT);
+    LE_TEST(TIME_SERIES_SPOOL_SLOT_COUNT == timeSeriesSpool_GetCount());
+
+    assetData_SessionStatus(ASSET_DATA_SESSION_AVAILABLE);
+    LE_ASSERT(LE_OK == assetData_SetObserve(unobservedRef, true, &token, sizeof(token)));
+    LE_TEST(0 == timeSeriesSpool_GetCount());
+
+    assetData_SetObserve(observedRef, false, NULL, 0);
+    assetData_SetObserve(unobservedRef, false, NULL, 0);
+    assetData_SessionStatus(ASSET_DATA_SESSION_UNAVAILABLE);
+    assetData_DeleteInstance(observedRef);
+    assetData_DeleteInstance(unobservedRef);
+}
+
+#endif
+
+
 COMPONENT_INIT
 {
     LE_TEST_INIT;
 
+#ifdef LEGATO_FEATURE_TIMESERIES
+    // Start with an empty time series spool.
+    unlink(TIME_SERIES_SPOOL_FILE);
+#endif
+
     // todo: this should eventually be done in avcServer.c
     assetData_Init();
 
@@ -412,6 +639,11 @@ COMPONENT_INIT
     SemCreateTwo = le_sem_Create("SemCreateTwo", 0);
 
     RunTest();
+    RunLookupBenchmark();
+#ifdef LEGATO_FEATURE_TIMESERIES
+    RunTimeSeriesSpoolTest();
+    RunTimeSeriesBatchTest();
+#endif
 
     LE_TEST_EXIT;
 }
@@ -30,6 +30,8 @@ static int humidityCount = 0;
 #define TEMPERATURE_INCREMENT        0.01
 #define TEMPERATURE_SCALE            100
 
+#define BENCHMARK_SAMPLES            1024                       // multiple of the batch size.
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -52,6 +54,74 @@ void PrintTimeSeriesStatus
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record temperature samples with one call per sample, then in batches, and log the durations.
+ * Full time series buffers are spooled by the service.
+ */
+//--------------------------------------------------------------------------------------------------
+
+void RecordTemperatureBatches
+(
+    le_avdata_AssetInstanceRef_t instRef
+)
+{
+    uint64_t timeStamps[LE_AVDATA_MAX_BATCH_SAMPLES];
+    double values[LE_AVDATA_MAX_BATCH_SAMPLES];
+    uint32_t numRecorded;
+    le_result_t result;
+    le_clk_Time_t startTime;
+    le_clk_Time_t singleTime;
+    le_clk_Time_t batchTime;
+    uint64_t utcMilliSec;
+    struct timeval tv;
+    int i;
+    int j;
+
+    gettimeofday(&tv, NULL);
+    utcMilliSec = (uint64_t)(tv.tv_sec) * 1000 + (uint64_t)(tv.tv_usec) / 1000;
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < BENCHMARK_SAMPLES; i++)
+    {
+        result = le_avdata_RecordFloat(instRef, "Temperature", temperatureCount, utcMilliSec);
+        LE_FATAL_IF((result != LE_OK) && (result != LE_NO_MEMORY),
+                    "Failed to record temperature (%s)", LE_RESULT_TXT(result));
+        temperatureCount = temperatureCount + TEMPERATURE_INCREMENT;
+        utcMilliSec = utcMilliSec + SLEEP_MSEC;
+    }
+    singleTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < BENCHMARK_SAMPLES; i += LE_AVDATA_MAX_BATCH_SAMPLES)
+    {
+        for (j = 0; j < LE_AVDATA_MAX_BATCH_SAMPLES; j++)
+        {
+            timeStamps[j] = utcMilliSec;
+            values[j] = temperatureCount;
+            temperatureCount = temperatureCount + TEMPERATURE_INCREMENT;
+            utcMilliSec = utcMilliSec + SLEEP_MSEC;
+        }
+
+        result = le_avdata_RecordFloatBatch(instRef, "Temperature",
+                                            timeStamps, LE_AVDATA_MAX_BATCH_SAMPLES,
+                                            values, LE_AVDATA_MAX_BATCH_SAMPLES,
+                                            &numRecorded);
+        LE_FATAL_IF(((result != LE_OK) && (result != LE_NO_MEMORY)) ||
+                    (numRecorded != LE_AVDATA_MAX_BATCH_SAMPLES),
+                    "Failed to record temperature batch (%s), %u samples recorded",
+                    LE_RESULT_TXT(result), numRecorded);
+    }
+    batchTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    LE_INFO("%d temperature samples: %ld.%06ld s one by one, %ld.%06ld s in batches of %d",
+            BENCHMARK_SAMPLES,
+            (long)singleTime.sec, (long)singleTime.usec,
+            (long)batchTime.sec, (long)batchTime.usec,
+            LE_AVDATA_MAX_BATCH_SAMPLES);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Init the component
@@ -129,6 +199,8 @@ COMPONENT_INIT
         usleep(SLEEP_USEC);
     }
 
+    RecordTemperatureBatches(instZeroRef);
+
     // Job is done! Push data and get out!
     result = le_avdata_IsObserve(instZeroRef, "Humidity", &isObserve);
     if (result == LE_OK)
@@ -58,6 +58,25 @@ sleep 1
 
 CheckAppIsRunning testAppInfo
 
+echo "Check the resource usage of testAppInfo is being sampled."
+sleep 3
+numMatches=$(ssh root@$targetAddr "$BIN_PATH/app usage testAppInfo | grep -c \"cpu:\"")
+if [ $numMatches -eq 0 ]
+then
+    echo -e $COLOR_ERROR "No resource usage samples for testAppInfo." $COLOR_RESET
+    exit 1
+fi
+
+echo "Check there is no resource usage for testAppInfo once it is stopped."
+ssh root@$targetAddr  "$BIN_PATH/app stop testAppInfo"
+CheckRet
+numMatches=$(ssh root@$targetAddr "$BIN_PATH/app usage testAppInfo | grep -c \"\[no samples\]\"")
+if [ $numMatches -eq 0 ]
+then
+    echo -e $COLOR_ERROR "Resource usage samples still reported for stopped testAppInfo." $COLOR_RESET
+    exit 1
+fi
+
 ssh root@$targetAddr  "$BIN_PATH/app remove testAppInfo"
 CheckRet
 
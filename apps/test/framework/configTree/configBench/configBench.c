@@ -0,0 +1,701 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * Benchmark for saving and loading a large configuration tree.
+ *
+ * Run with "save" to build the tree and time a number of commits, each of which writes the whole
+ * tree to the filesystem.  Then restart the configTree daemon and run with "load" to time the
+ * first access to the tree, which loads it from the filesystem, and to check its contents.
+ *
+ * Run with "contention" to time commits and reads made at the same time, and to check that read
+ * transactions see a stable snapshot of the tree while commits go on around them.
+ *
+ * Run with "cache" to time repeated reads of the same values with and without the client-side
+ * cache, and to check that the cache drops values when they change.
+ *
+ * Run with "batch" to time reading an app's settings in one batched call against reading them one
+ * by one, and to check that batched writes read back the same.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "legato.h"
+#include "interfaces.h"
+#include "cfgCache.h"
+
+
+
+
+/// Root of the benchmark tree.
+#define BENCH_ROOT "configBench:/"
+
+/// Number of "apps" in the benchmark tree, and of "procs" in each app.  Together with the values
+/// of each proc this gives a tree of about 25000 nodes.
+#define NUM_APPS   300
+#define NUM_PROCS  10
+#define NUM_ARGS   5
+
+/// Number of commits timed.
+#define NUM_COMMITS 10
+
+/// Number of commits made while the reader thread is reading, in the contention benchmark.
+#define NUM_CONTENDED_COMMITS 50
+
+
+/// Number of times the cache benchmark reads its set of values, each way.
+#define NUM_CACHE_ROUNDS 100
+
+/// Value changed by the cache benchmark to check invalidation.
+#define CACHE_CHECK_PATH BENCH_ROOT "app0/procs/proc0/priority"
+
+/// Number of times to check for the cache invalidation, 10 ms apart, before giving up.
+#define MAX_CACHE_CHECKS 200
+
+
+/// Number of times the batch benchmark reads one app's settings, each way.
+#define NUM_BATCH_ROUNDS 100
+
+
+/// Set by the contention benchmark once all of its commits are done, to stop the reader thread.
+static volatile bool WritesDone = false;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of milliseconds elapsed since a given time.
+ */
+//--------------------------------------------------------------------------------------------------
+static double MsSince
+(
+    le_clk_Time_t startTime
+)
+{
+    le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    return (elapsed.sec * 1000.0) + (elapsed.usec / 1000.0);
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the benchmark tree, then time commits of small changes to it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SaveBench
+(
+    void
+)
+{
+    char path[LE_CFG_STR_LEN_BYTES];
+    int app, proc, arg;
+
+    // Each app is written in its own transaction, to stay well within the transaction timeout.
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    le_cfg_IteratorRef_t iterRef;
+
+    for (app = 0; app < NUM_APPS; app++)
+    {
+        iterRef = le_cfg_CreateWriteTxn(BENCH_ROOT);
+
+        snprintf(path, sizeof(path), "app%d/version", app);
+        le_cfg_SetString(iterRef, path, "1.0 \"quoted\" \\ text");
+
+        snprintf(path, sizeof(path), "app%d/sandboxed", app);
+        le_cfg_SetBool(iterRef, path, (app % 2) == 0);
+
+        for (proc = 0; proc < NUM_PROCS; proc++)
+        {
+            snprintf(path, sizeof(path), "app%d/procs/proc%d/priority", app, proc);
+            le_cfg_SetInt(iterRef, path, proc - 5);
+
+            snprintf(path, sizeof(path), "app%d/procs/proc%d/ratio", app, proc);
+            le_cfg_SetFloat(iterRef, path, proc * 0.25);
+
+            for (arg = 0; arg < NUM_ARGS; arg++)
+            {
+                snprintf(path, sizeof(path), "app%d/procs/proc%d/args/%d", app, proc, arg);
+                le_cfg_SetString(iterRef, path, "--arg");
+            }
+        }
+
+        le_cfg_CommitTxn(iterRef);
+    }
+
+    LE_INFO("Built the tree in %.1f ms.", MsSince(startTime));
+
+    int i;
+    startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NUM_COMMITS; i++)
+    {
+        iterRef = le_cfg_CreateWriteTxn(BENCH_ROOT);
+        le_cfg_SetInt(iterRef, "commitCount", i + 1);
+        le_cfg_CommitTxn(iterRef);
+    }
+
+    LE_INFO("Saved the tree %d times, %.1f ms per commit.",
+            NUM_COMMITS,
+            MsSince(startTime) / NUM_COMMITS);
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time the first access to the benchmark tree, then check its contents.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadBench
+(
+    void
+)
+{
+    char path[LE_CFG_STR_LEN_BYTES];
+    char value[LE_CFG_STR_LEN_BYTES];
+    int app, proc;
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(BENCH_ROOT);
+
+    LE_INFO("Loaded the tree in %.1f ms.", MsSince(startTime));
+
+    LE_FATAL_IF(le_cfg_GetInt(iterRef, "commitCount", 0) != NUM_COMMITS, "Bad commit count.");
+
+    for (app = 0; app < NUM_APPS; app++)
+    {
+        snprintf(path, sizeof(path), "app%d/version", app);
+        LE_FATAL_IF(le_cfg_GetString(iterRef, path, value, sizeof(value), "") != LE_OK,
+                    "Could not read '%s'.",
+                    path);
+        LE_FATAL_IF(strcmp(value, "1.0 \"quoted\" \\ text") != 0, "Bad value for '%s'.", path);
+
+        snprintf(path, sizeof(path), "app%d/sandboxed", app);
+        LE_FATAL_IF(le_cfg_GetBool(iterRef, path, (app % 2) != 0) != ((app % 2) == 0),
+                    "Bad value for '%s'.",
+                    path);
+
+        for (proc = 0; proc < NUM_PROCS; proc++)
+        {
+            snprintf(path, sizeof(path), "app%d/procs/proc%d/priority", app, proc);
+            LE_FATAL_IF(le_cfg_GetInt(iterRef, path, 0) != proc - 5, "Bad value for '%s'.", path);
+
+            snprintf(path, sizeof(path), "app%d/procs/proc%d/ratio", app, proc);
+            LE_FATAL_IF(le_cfg_GetFloat(iterRef, path, -1.0) != proc * 0.25,
+                        "Bad value for '%s'.",
+                        path);
+
+            snprintf(path, sizeof(path), "app%d/procs/proc%d/args/%d", app, proc, NUM_ARGS - 1);
+            LE_FATAL_IF(le_cfg_GetNodeType(iterRef, path) != LE_CFG_TYPE_STRING,
+                        "Bad type for '%s'.",
+                        path);
+        }
+    }
+
+    le_cfg_CancelTxn(iterRef);
+
+    LE_INFO("Checked the tree in %.1f ms.", MsSince(startTime));
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reader thread for the contention benchmark.  Reads part of the tree in one read transaction after
+ * another, until the writes are done, and checks that each transaction sees a consistent tree.
+ *
+ * @return The number of read transactions completed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* ReaderThread
+(
+    void* contextPtr
+)
+{
+    le_cfg_ConnectService();
+
+    char path[LE_CFG_STR_LEN_BYTES];
+    size_t numReads = 0;
+    int app;
+
+    while (!WritesDone)
+    {
+        le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(BENCH_ROOT);
+
+        // The writer always changes the counter and the apps' priorities together, so within
+        // a snapshot they must all agree.
+        int count = le_cfg_GetInt(iterRef, "contentionCount", 0);
+
+        for (app = 0; app < NUM_APPS; app += 10)
+        {
+            snprintf(path, sizeof(path), "app%d/procs/proc0/priority", app);
+            LE_FATAL_IF(le_cfg_GetInt(iterRef, path, 0) != count - 5,
+                        "Inconsistent read of '%s' at count %d.",
+                        path,
+                        count);
+        }
+
+        le_cfg_CancelTxn(iterRef);
+        numReads++;
+    }
+
+    le_cfg_DisconnectService();
+
+    return (void*)numReads;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time commits while read transactions are open on the tree, and check the readers' snapshots.
+ * The tree must have been built by the save benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ContentionBench
+(
+    void
+)
+{
+    char path[LE_CFG_STR_LEN_BYTES];
+    int i, app;
+
+    // Set up a known state, which the readers check.
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(BENCH_ROOT);
+    le_cfg_SetInt(iterRef, "contentionCount", 5);
+    for (app = 0; app < NUM_APPS; app += 10)
+    {
+        snprintf(path, sizeof(path), "app%d/procs/proc0/priority", app);
+        le_cfg_SetInt(iterRef, path, 0);
+    }
+    le_cfg_CommitTxn(iterRef);
+
+    // Hold a read transaction open across a commit and a quick set, neither of which may wait for
+    // it.  It must keep seeing the tree as it was, while a new reader sees the changes.
+    le_cfg_IteratorRef_t heldIterRef = le_cfg_CreateReadTxn(BENCH_ROOT);
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    iterRef = le_cfg_CreateWriteTxn(BENCH_ROOT);
+    le_cfg_SetInt(iterRef, "contentionCount", 6);
+    for (app = 0; app < NUM_APPS; app += 10)
+    {
+        snprintf(path, sizeof(path), "app%d/procs/proc0/priority", app);
+        le_cfg_SetInt(iterRef, path, 1);
+    }
+    le_cfg_CommitTxn(iterRef);
+
+    LE_INFO("Committed with a read transaction open in %.1f ms.", MsSince(startTime));
+
+    startTime = le_clk_GetRelativeTime();
+    le_cfg_QuickSetString(BENCH_ROOT "quickValue", "changed");
+    LE_INFO("Quick set with a read transaction open in %.1f ms.", MsSince(startTime));
+
+    LE_FATAL_IF(le_cfg_GetInt(heldIterRef, "contentionCount", 0) != 5,
+                "Read transaction saw a later commit.");
+    LE_FATAL_IF(le_cfg_NodeExists(heldIterRef, "quickValue"),
+                "Read transaction saw a later quick set.");
+
+    iterRef = le_cfg_CreateReadTxn(BENCH_ROOT);
+    LE_FATAL_IF(le_cfg_GetInt(iterRef, "contentionCount", 0) != 6,
+                "New read transaction did not see the commit.");
+    LE_FATAL_IF(!le_cfg_NodeExists(iterRef, "quickValue"),
+                "New read transaction did not see the quick set.");
+    le_cfg_CancelTxn(iterRef);
+
+    le_cfg_CancelTxn(heldIterRef);
+
+    // Now commit over and over while another thread keeps reading.
+    le_thread_Ref_t readerRef = le_thread_Create("configBenchReader", ReaderThread, NULL);
+    le_thread_SetJoinable(readerRef);
+    le_thread_Start(readerRef);
+
+    startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NUM_CONTENDED_COMMITS; i++)
+    {
+        iterRef = le_cfg_CreateWriteTxn(BENCH_ROOT);
+        le_cfg_SetInt(iterRef, "contentionCount", i + 7);
+        for (app = 0; app < NUM_APPS; app += 10)
+        {
+            snprintf(path, sizeof(path), "app%d/procs/proc0/priority", app);
+            le_cfg_SetInt(iterRef, path, i + 2);
+        }
+        le_cfg_CommitTxn(iterRef);
+    }
+
+    double writeMs = MsSince(startTime);
+
+    WritesDone = true;
+
+    void* numReadsPtr;
+    LE_ASSERT(le_thread_Join(readerRef, &numReadsPtr) == LE_OK);
+
+    LE_INFO("With a concurrent reader: %.1f ms per commit, %zu read transactions in %.1f ms.",
+            writeMs / NUM_CONTENDED_COMMITS,
+            (size_t)numReadsPtr,
+            MsSince(startTime));
+
+    le_cfg_QuickDeleteNode(BENCH_ROOT "contentionCount");
+    le_cfg_QuickDeleteNode(BENCH_ROOT "quickValue");
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read one app's settings, either directly or through the cache.
+ *
+ * @return A sum of the values read, to compare the two ways of reading.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ReadAppSettings
+(
+    bool useCache
+)
+{
+    char path[LE_CFG_STR_LEN_BYTES];
+    char value[LE_CFG_STR_LEN_BYTES];
+    double sum = 0;
+    int proc;
+
+    if (useCache)
+    {
+        LE_ASSERT(cfgCache_GetString(BENCH_ROOT "app0/version", value, sizeof(value), "") == LE_OK);
+        sum += strlen(value);
+        sum += cfgCache_GetBool(BENCH_ROOT "app0/sandboxed", false);
+    }
+    else
+    {
+        LE_ASSERT(le_cfg_QuickGetString(BENCH_ROOT "app0/version", value, sizeof(value), "") ==
+                  LE_OK);
+        sum += strlen(value);
+        sum += le_cfg_QuickGetBool(BENCH_ROOT "app0/sandboxed", false);
+    }
+
+    for (proc = 0; proc < NUM_PROCS; proc++)
+    {
+        snprintf(path, sizeof(path), BENCH_ROOT "app0/procs/proc%d/priority", proc);
+        sum += useCache ? cfgCache_GetInt(path, 0) : le_cfg_QuickGetInt(path, 0);
+
+        snprintf(path, sizeof(path), BENCH_ROOT "app0/procs/proc%d/ratio", proc);
+        sum += useCache ? cfgCache_GetFloat(path, 0.0) : le_cfg_QuickGetFloat(path, 0.0);
+    }
+
+    return sum;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether the cache has seen the change made by the cache benchmark yet, and if so, that
+ * the new value is read.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CacheCheckTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    int32_t* expectedPtr = le_timer_GetContextPtr(timerRef);
+    cfgCache_Stats_t stats;
+
+    cfgCache_GetStats(&stats);
+
+    if (stats.invalidations == 0)
+    {
+        LE_FATAL_IF(le_timer_GetExpiryCount(timerRef) >= MAX_CACHE_CHECKS,
+                    "Cache was not told about the change.");
+        return;
+    }
+
+    LE_FATAL_IF(cfgCache_GetInt(CACHE_CHECK_PATH, 0) != *expectedPtr,
+                "Cache returned a stale value.");
+
+    le_cfg_QuickSetInt(CACHE_CHECK_PATH, *expectedPtr - 1);
+
+    LE_INFO("Cache dropped %" PRIu64 " values after the change.", stats.invalidations);
+
+    exit(EXIT_SUCCESS);
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time repeated reads of one app's settings with and without the cache, then change one of them
+ * and wait for the cache to drop it.  The tree must have been built by the save benchmark.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CacheBench
+(
+    void
+)
+{
+    double directSum = 0;
+    double cachedSum = 0;
+    int i;
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NUM_CACHE_ROUNDS; i++)
+    {
+        directSum += ReadAppSettings(false);
+    }
+
+    double directMs = MsSince(startTime);
+    startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NUM_CACHE_ROUNDS; i++)
+    {
+        cachedSum += ReadAppSettings(true);
+    }
+
+    double cachedMs = MsSince(startTime);
+
+    LE_FATAL_IF(directSum != cachedSum, "Cached values differ from the configTree's.");
+
+    cfgCache_Stats_t stats;
+    cfgCache_GetStats(&stats);
+
+    LE_INFO("Read %d settings %d times: %.1f ms direct, %.1f ms cached "
+            "(%" PRIu64 " hits, %" PRIu64 " misses, %zu watches).",
+            2 + (2 * NUM_PROCS),
+            NUM_CACHE_ROUNDS,
+            directMs,
+            cachedMs,
+            stats.hits,
+            stats.misses,
+            stats.numWatches);
+
+    // Change a cached value, and wait for the change notification to drop it from the cache.
+    static int32_t expected;
+    expected = cfgCache_GetInt(CACHE_CHECK_PATH, 0) + 1;
+    le_cfg_QuickSetInt(CACHE_CHECK_PATH, expected);
+
+    le_timer_Ref_t timerRef = le_timer_Create("cacheCheck");
+    LE_ASSERT(le_timer_SetMsInterval(timerRef, 10) == LE_OK);
+    LE_ASSERT(le_timer_SetRepeat(timerRef, 0) == LE_OK);
+    LE_ASSERT(le_timer_SetContextPtr(timerRef, &expected) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(timerRef, CacheCheckTimerHandler) == LE_OK);
+    LE_ASSERT(le_timer_Start(timerRef) == LE_OK);
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a record to a batch buffer.
+ *
+ * @return The new length of the buffer's contents.
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t AppendRecord
+(
+    uint8_t* bufferPtr,
+    size_t used,
+    le_cfg_nodeType_t type,
+    const char* pathPtr,
+    const char* valuePtr
+)
+{
+    size_t pathSize = strlen(pathPtr) + 1;
+    size_t valueSize = strlen(valuePtr) + 1;
+
+    LE_ASSERT(used + 1 + pathSize + valueSize <= LE_CFG_BATCH_MAX_BYTES);
+
+    bufferPtr[used++] = type;
+    memcpy(bufferPtr + used, pathPtr, pathSize);
+    used += pathSize;
+    memcpy(bufferPtr + used, valuePtr, valueSize);
+
+    return used + valueSize;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Count the records in a batch buffer: a type byte, then two NUL terminated strings each.
+ *
+ * @return The number of records.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t CountRecords
+(
+    const uint8_t* bufferPtr,
+    size_t used
+)
+{
+    uint32_t count = 0;
+    size_t pos = 0;
+
+    while (pos < used)
+    {
+        pos += 1 + strlen((const char*)bufferPtr + pos + 1) + 1;
+        pos += strlen((const char*)bufferPtr + pos) + 1;
+        count++;
+    }
+
+    return count;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read all of the values of a subtree with batched reads, as many pages as it takes.
+ *
+ * @return The number of values read.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t QuickReadSubtree
+(
+    const char* pathPtr
+)
+{
+    uint8_t records[LE_CFG_BATCH_MAX_BYTES];
+    uint32_t numValues = 0;
+    le_result_t result;
+
+    do
+    {
+        size_t recordsSize = sizeof(records);
+
+        result = le_cfg_QuickGetBatch(pathPtr, NULL, 0, numValues, records, &recordsSize);
+        LE_ASSERT((result == LE_OK) || ((result == LE_OVERFLOW) && (recordsSize > 0)));
+
+        numValues += CountRecords(records, recordsSize);
+    }
+    while (result == LE_OVERFLOW);
+
+    return numValues;
+}
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Time reading one app's settings with batched reads against one read per value, then write a
+ * few values with a batched write and check that they read back.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BatchBench
+(
+    void
+)
+{
+    uint8_t records[LE_CFG_BATCH_MAX_BYTES];
+    size_t recordsSize = 0;
+    uint32_t numValues = 0;
+    int i;
+
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NUM_BATCH_ROUNDS; i++)
+    {
+        ReadAppSettings(false);
+    }
+
+    double singleMs = MsSince(startTime);
+    startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < NUM_BATCH_ROUNDS; i++)
+    {
+        numValues = QuickReadSubtree(BENCH_ROOT "app0");
+    }
+
+    double batchMs = MsSince(startTime);
+
+    LE_FATAL_IF(numValues != 2 + (NUM_PROCS * (2 + NUM_ARGS)),
+                "Batch read returned %" PRIu32 " values.",
+                numValues);
+
+    LE_INFO("Read app settings %d times: %.1f ms one by one (%d values), "
+            "%.1f ms batched (%" PRIu32 " values).",
+            NUM_BATCH_ROUNDS,
+            singleMs,
+            2 + (2 * NUM_PROCS),
+            batchMs,
+            numValues);
+
+    // Write a few values in one go, then read them back in one go.
+    size_t used = 0;
+
+    used = AppendRecord(records, used, LE_CFG_TYPE_STRING, "version", "2.0");
+    used = AppendRecord(records, used, LE_CFG_TYPE_BOOL, "sandboxed", "false");
+    used = AppendRecord(records, used, LE_CFG_TYPE_INT, "procs/proc0/priority", "42");
+
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateWriteTxn(BENCH_ROOT "app1");
+    LE_ASSERT(le_cfg_SetBatch(iterRef, "", records, used) == LE_OK);
+    le_cfg_CommitTxn(iterRef);
+
+    static const char pathList[] = "version\0sandboxed\0procs/proc0/priority\0missing";
+    uint8_t expected[LE_CFG_BATCH_MAX_BYTES];
+
+    memcpy(expected, records, used);
+    used = AppendRecord(expected, used, LE_CFG_TYPE_DOESNT_EXIST, "missing", "");
+
+    recordsSize = sizeof(records);
+    LE_ASSERT(le_cfg_QuickGetBatch(BENCH_ROOT "app1",
+                                   (const uint8_t*)pathList,
+                                   sizeof(pathList),
+                                   0,
+                                   records,
+                                   &recordsSize) == LE_OK);
+
+    LE_FATAL_IF((recordsSize != used) || (memcmp(records, expected, used) != 0),
+                "Batched read doesn't match batched write.");
+}
+
+
+
+
+COMPONENT_INIT
+{
+    const char* modePtr = le_arg_GetArg(0);
+
+    if ((modePtr != NULL) && (strcmp(modePtr, "save") == 0))
+    {
+        SaveBench();
+    }
+    else if ((modePtr != NULL) && (strcmp(modePtr, "load") == 0))
+    {
+        LoadBench();
+    }
+    else if ((modePtr != NULL) && (strcmp(modePtr, "contention") == 0))
+    {
+        ContentionBench();
+    }
+    else if ((modePtr != NULL) && (strcmp(modePtr, "cache") == 0))
+    {
+        // Finishes once the cache has been told about a change.
+        CacheBench();
+        return;
+    }
+    else if ((modePtr != NULL) && (strcmp(modePtr, "batch") == 0))
+    {
+        BatchBench();
+    }
+    else
+    {
+        fprintf(stderr, "Usage: configBench save|load|contention|cache|batch\n");
+        exit(EXIT_FAILURE);
+    }
+
+    exit(EXIT_SUCCESS);
+}
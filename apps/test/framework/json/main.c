@@ -0,0 +1,334 @@
+ /**
+  * This module is for unit testing the le_json module in the legato runtime library, and for
+  * measuring how fast it parses a large document from each kind of input.
+  *
+  * Copyright (C) Sierra Wireless Inc.
+  */
+
+#include "legato.h"
+
+
+/// Number of array elements in the generated document.  Each is about 80 bytes, making a
+/// document of around 200 KB.
+#define NUM_ITEMS       2500
+
+/// Bytes written after the end of the document, which the parser must leave unread.
+#define TRAILER         "TRAILING DATA"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Input kinds, tested in this order.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    TEST_MEMORY,
+    TEST_FILE,
+    TEST_SOCKET,
+    TEST_PIPE,
+    TEST_DONE
+}
+TestInput_t;
+
+static const char* TestNames[] = { "memory", "file", "socket", "pipe" };
+
+
+static char* DocPtr;            ///< The generated document, followed by the trailer.
+static size_t DocSize;          ///< Size of the document, not counting the trailer.
+
+static TestInput_t CurrentTest;
+static int ReadFd = -1;
+static le_clk_Time_t StartTime;
+
+/// Counts of the events reported for the current test.
+static size_t NumObjects;
+static size_t NumMembers;
+static size_t NumStrings;
+static size_t NumNumbers;
+static size_t NumTrue;
+static size_t NumNull;
+static double NumberSum;
+
+
+static void StartTest(void* param1Ptr, void* param2Ptr);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds the test document.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MakeDocument
+(
+    void
+)
+{
+    size_t bufSize = (NUM_ITEMS * 128) + 64;
+    DocPtr = malloc(bufSize);
+    LE_ASSERT(DocPtr != NULL);
+
+    size_t len = snprintf(DocPtr, bufSize, "{\n  \"items\": [\n");
+
+    int i;
+    for (i = 0; i < NUM_ITEMS; i++)
+    {
+        len += snprintf(DocPtr + len, bufSize - len,
+                        "    { \"name\": \"item%d\", \"value\": %d.5, \"on\": true, \"x\": null }%s\n",
+                        i, i, (i < NUM_ITEMS - 1) ? "," : "");
+        LE_ASSERT(len < bufSize);
+    }
+
+    len += snprintf(DocPtr + len, bufSize - len, "  ]\n}");
+    DocSize = len;
+
+    len += snprintf(DocPtr + len, bufSize - len, TRAILER);
+    LE_ASSERT(len < bufSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread that writes the document and trailer into a pipe or socket.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* WriterThread
+(
+    void* contextPtr
+)
+{
+    int fd = (int)(intptr_t)contextPtr;
+    const char* dataPtr = DocPtr;
+    size_t remaining = DocSize + strlen(TRAILER);
+
+    while (remaining > 0)
+    {
+        ssize_t result = write(fd, dataPtr, remaining);
+
+        if ((result == -1) && (errno == EINTR))
+        {
+            continue;
+        }
+
+        LE_ASSERT(result > 0);
+
+        dataPtr += result;
+        remaining -= result;
+    }
+
+    close(fd);
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks that the rest of the input, after the document, is exactly the trailer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckTrailer
+(
+    void
+)
+{
+    char buf[64];
+    size_t len = 0;
+
+    // The reader fd is non-blocking, but the writer may not have finished yet.
+    fcntl(ReadFd, F_SETFL, fcntl(ReadFd, F_GETFL) & ~O_NONBLOCK);
+
+    for (;;)
+    {
+        ssize_t result = read(ReadFd, buf + len, sizeof(buf) - 1 - len);
+
+        if ((result == -1) && (errno == EINTR))
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            break;
+        }
+
+        len += result;
+    }
+
+    buf[len] = '\0';
+
+    LE_TEST(strcmp(buf, TRAILER) == 0);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Error handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ErrorHandler
+(
+    le_json_Error_t error,
+    const char* msg
+)
+{
+    LE_TEST(false);
+    LE_ERROR("JSON parsing error (%s input): %s", TestNames[CurrentTest], msg);
+
+    LE_TEST_EXIT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event handler.  Counts events, and checks the results at the end of the document.
+ */
+//--------------------------------------------------------------------------------------------------
+static void EventHandler
+(
+    le_json_Event_t event
+)
+{
+    switch (event)
+    {
+        case LE_JSON_OBJECT_START:
+            NumObjects++;
+            break;
+
+        case LE_JSON_OBJECT_MEMBER:
+            NumMembers++;
+            break;
+
+        case LE_JSON_STRING:
+            NumStrings++;
+            break;
+
+        case LE_JSON_NUMBER:
+            NumNumbers++;
+            NumberSum += le_json_GetNumber();
+            break;
+
+        case LE_JSON_TRUE:
+            NumTrue++;
+            break;
+
+        case LE_JSON_NULL:
+            NumNull++;
+            break;
+
+        case LE_JSON_DOC_END:
+        {
+            le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), StartTime);
+            double seconds = elapsed.sec + (elapsed.usec / 1000000.0);
+
+            LE_INFO("Parsed %zu bytes from %s in %.3f s (%.1f KB/s).",
+                    DocSize,
+                    TestNames[CurrentTest],
+                    seconds,
+                    (seconds > 0) ? (DocSize / 1024.0 / seconds) : 0.0);
+
+            LE_TEST(le_json_GetBytesRead(le_json_GetSession()) == DocSize);
+            LE_TEST(NumObjects == NUM_ITEMS + 1);
+            LE_TEST(NumMembers == (NUM_ITEMS * 4) + 1);
+            LE_TEST(NumStrings == NUM_ITEMS);
+            LE_TEST(NumNumbers == NUM_ITEMS);
+            LE_TEST(NumTrue == NUM_ITEMS);
+            LE_TEST(NumNull == NUM_ITEMS);
+            LE_TEST(NumberSum == (((double)NUM_ITEMS * (NUM_ITEMS - 1)) / 2) + (NUM_ITEMS * 0.5));
+
+            // Parsing must have stopped exactly at the end of the document.
+            if (ReadFd != -1)
+            {
+                CheckTrailer();
+                close(ReadFd);
+                ReadFd = -1;
+            }
+
+            le_json_Cleanup(le_json_GetSession());
+
+            CurrentTest++;
+            le_event_QueueFunction(StartTest, NULL, NULL);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts parsing the document from the current test's kind of input.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartTest
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    NumObjects = 0;
+    NumMembers = 0;
+    NumStrings = 0;
+    NumNumbers = 0;
+    NumTrue = 0;
+    NumNull = 0;
+    NumberSum = 0;
+
+    int fds[2];
+    char filePath[] = "/tmp/jsonTestXXXXXX";
+
+    switch (CurrentTest)
+    {
+        case TEST_MEMORY:
+            StartTime = le_clk_GetRelativeTime();
+            le_json_ParseBuffer(DocPtr, DocSize, EventHandler, ErrorHandler, NULL);
+            return;
+
+        case TEST_FILE:
+            ReadFd = mkstemp(filePath);
+            LE_ASSERT(ReadFd != -1);
+            LE_ASSERT(unlink(filePath) == 0);
+            LE_ASSERT(write(ReadFd, DocPtr, DocSize + strlen(TRAILER)) ==
+                      DocSize + strlen(TRAILER));
+            LE_ASSERT(lseek(ReadFd, 0, SEEK_SET) == 0);
+            break;
+
+        case TEST_SOCKET:
+        case TEST_PIPE:
+            if (CurrentTest == TEST_SOCKET)
+            {
+                LE_ASSERT(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+            }
+            else
+            {
+                LE_ASSERT(pipe(fds) == 0);
+            }
+            ReadFd = fds[0];
+            le_thread_Start(le_thread_Create("writer", WriterThread, (void*)(intptr_t)fds[1]));
+            break;
+
+        case TEST_DONE:
+            free(DocPtr);
+            LE_INFO("======== JSON Test Complete ========");
+            LE_TEST_EXIT;
+    }
+
+    fcntl(ReadFd, F_SETFL, fcntl(ReadFd, F_GETFL) | O_NONBLOCK);
+
+    StartTime = le_clk_GetRelativeTime();
+    le_json_Parse(ReadFd, EventHandler, ErrorHandler, NULL);
+}
+
+
+COMPONENT_INIT
+{
+    LE_TEST_INIT;
+
+    LE_INFO("======== Starting JSON Test ========");
+
+    MakeDocument();
+
+    CurrentTest = TEST_MEMORY;
+    le_event_QueueFunction(StartTest, NULL, NULL);
+}
@@ -30,6 +30,75 @@ static const char* GetProcLabel
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test loading a rule set into a fake SMACK file system directory, and check exactly what is
+ * written to the load file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestRuleSetInFakeFs
+(
+    void
+)
+{
+    char dirPath[] = "/tmp/smackFsXXXXXX";
+    LE_ASSERT(mkdtemp(dirPath) != NULL);
+
+    char loadPath[LIMIT_MAX_PATH_BYTES];
+    LE_ASSERT(snprintf(loadPath, sizeof(loadPath), "%s/load2", dirPath) < sizeof(loadPath));
+
+    int fd = open(loadPath, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    LE_ASSERT(fd != -1);
+    fd_Close(fd);
+
+    smack_SetFsDir(dirPath);
+
+    // An empty rule set is not written at all.
+    smack_RuleSetRef_t ruleSetRef = smack_CreateRuleSet();
+    smack_LoadRuleSet(ruleSetRef);
+    smack_DeleteRuleSet(ruleSetRef);
+
+    // Enough rules to need more than one chunk.
+    ruleSetRef = smack_CreateRuleSet();
+
+    int i;
+    char objLabel[LIMIT_MAX_SMACK_LABEL_BYTES];
+
+    for (i = 0; i < 200; i++)
+    {
+        snprintf(objLabel, sizeof(objLabel), "fakeObject%d", i);
+        smack_AddRule(ruleSetRef, "fakeSubject", (i % 2) ? "rw" : "x", objLabel);
+    }
+
+    smack_LoadRuleSet(ruleSetRef);
+    smack_DeleteRuleSet(ruleSetRef);
+
+    smack_SetFsDir("/legato/smack");
+
+    // Read back what was written and check every rule is there, in order, once.
+    FILE* filePtr = fopen(loadPath, "r");
+    LE_ASSERT(filePtr != NULL);
+
+    char line[128];
+    char expected[128];
+
+    for (i = 0; i < 200; i++)
+    {
+        snprintf(expected, sizeof(expected), "fakeSubject fakeObject%d %s\n",
+                 i, (i % 2) ? "rw---" : "--x--");
+
+        LE_TEST((fgets(line, sizeof(line), filePtr) != NULL) && (strcmp(line, expected) == 0));
+    }
+
+    LE_TEST(fgets(line, sizeof(line), filePtr) == NULL);
+
+    fclose(filePtr);
+
+    LE_ASSERT(unlink(loadPath) == 0);
+    LE_ASSERT(rmdir(dirPath) == 0);
+}
+
+
 COMPONENT_INIT
 {
     LE_TEST_INIT;
@@ -83,6 +152,25 @@ COMPONENT_INIT
     LE_TEST(!smack_HasAccess("testLabel1", "rw", "testLabel2"));
     LE_TEST(!smack_HasAccess("testLabel1", "r", "testLabel3"));
 
+    // Test loading a rule set.
+    smack_RuleSetRef_t ruleSetRef = smack_CreateRuleSet();
+    smack_AddRule(ruleSetRef, "testLabel1", "rw", "testLabel2");
+    smack_AddRule(ruleSetRef, "testLabel1", "x", "testLabel3");
+
+    LE_TEST(!smack_HasAccess("testLabel1", "rw", "testLabel2"));
+
+    smack_LoadRuleSet(ruleSetRef);
+    smack_DeleteRuleSet(ruleSetRef);
+
+    LE_TEST(smack_HasAccess("testLabel1", "rw", "testLabel2"));
+    LE_TEST(smack_HasAccess("testLabel1", "x", "testLabel3"));
+    LE_TEST(!smack_HasAccess("testLabel1", "r", "testLabel3"));
+
+    smack_RevokeSubject("testLabel1");
+    LE_TEST(!smack_HasAccess("testLabel1", "x", "testLabel3"));
+
+    TestRuleSetInFakeFs();
+
     // Cleanup.
     LE_ASSERT(smack_SetLabel("/dev/null", "_") == LE_OK);
     LE_ASSERT(smack_SetLabel("/dev/zero", "_") == LE_OK);
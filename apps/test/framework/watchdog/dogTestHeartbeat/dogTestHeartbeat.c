@@ -0,0 +1,94 @@
+#include "legato.h"
+#include "interfaces.h"
+#include <sys/mman.h>
+
+/*
+ * This watchdog test gets a shared memory heartbeat from the watchdog and kicks it by
+ * incrementing the counter, at an interval shorter than the configured timeout, for a number of
+ * kicks.  Throughout this time it should stay alive without sending any further IPC kicks.
+ * Then it stops kicking and sleeps.  The watchdog should time out within two timeouts and this
+ * test should be terminated.
+ * The arguments are the kick interval in milliseconds and the number of heartbeat kicks.
+ * An optional third argument is a timeout in milliseconds to set with le_wdog_Timeout() before
+ * the first heartbeat kick.  It should be shorter than the total kicking time, to check that
+ * heartbeat kicks are still picked up once that timeout has expired.
+ */
+
+COMPONENT_INIT
+{
+    LE_INFO("Watchdog test starting");
+
+    // Get the process name.
+    const char* procName = le_arg_GetProgramName();
+    LE_ASSERT(procName != NULL);
+
+    LE_INFO("======== Start '%s' Test ========", procName);
+
+    int numArgs = le_arg_NumArgs();
+    if (numArgs < 2)
+    {
+        LE_CRIT("Expected 2 or 3 arguments, got %d", numArgs);
+    }
+
+    const char* argStr;
+    le_result_t result;
+    int millisecondInterval;
+    int kickCount;
+    int millisecondTimeout = 0;
+
+    argStr = le_arg_GetArg(0);
+    LE_ASSERT(argStr != NULL);
+    result = le_utf8_ParseInt(&millisecondInterval, argStr);
+    LE_FATAL_IF(result != LE_OK,
+                "Invalid number of milliseconds between kicks (%s). le_utf8_ParseInt() returned %s.",
+                argStr,
+                LE_RESULT_TXT(result));
+
+    argStr = le_arg_GetArg(1);
+    LE_ASSERT(argStr != NULL);
+    result = le_utf8_ParseInt(&kickCount, argStr);
+    LE_FATAL_IF(result != LE_OK,
+                "Invalid number of kicks (%s). le_utf8_ParseInt() returned %s.",
+                argStr,
+                LE_RESULT_TXT(result));
+
+    if (numArgs > 2)
+    {
+        argStr = le_arg_GetArg(2);
+        LE_ASSERT(argStr != NULL);
+        result = le_utf8_ParseInt(&millisecondTimeout, argStr);
+        LE_FATAL_IF(result != LE_OK,
+                    "Invalid timeout in milliseconds (%s). le_utf8_ParseInt() returned %s.",
+                    argStr,
+                    LE_RESULT_TXT(result));
+    }
+
+    int fd;
+    LE_ASSERT(le_wdog_GetHeartbeat(&fd) == LE_OK);
+
+    volatile uint32_t* heartbeatPtr = mmap(NULL, sizeof(uint32_t), PROT_READ | PROT_WRITE,
+                                           MAP_SHARED, fd, 0);
+    LE_FATAL_IF(heartbeatPtr == MAP_FAILED, "Failed to map heartbeat (%m)");
+    close(fd);
+
+    if (millisecondTimeout > 0)
+    {
+        LE_INFO("Setting watchdog timeout to %d milliseconds", millisecondTimeout);
+        le_wdog_Timeout(millisecondTimeout);
+    }
+
+    LE_INFO("Kicking heartbeat every %d milliseconds, %d times", millisecondInterval, kickCount);
+    int i;
+    for (i = 0; i < kickCount; i++)
+    {
+        usleep(millisecondInterval * 1000);
+        (*heartbeatPtr)++;
+    }
+
+    // We should still be alive
+    LE_INFO("Stopped kicking heartbeat");
+    sleep(3600);
+
+    // We should never get here
+    LE_FATAL("FAIL");
+}
@@ -0,0 +1,59 @@
+# dogTestHeartbeat
+# This script watches the output of the dogTestHeartbeat
+# The test app gets a shared memory heartbeat from the watchdog and kicks it by incrementing
+# the counter for a while (interval and count passed as args in the adef; the interval is
+# shorter than the configured watchdogTimeout:).  The watchdog must not time out while the
+# heartbeat is being kicked.
+# Once the app stops kicking, the heartbeat is only sampled when the timer expires, so we
+# expect the watchdog to time out within two configured timeouts.
+# When a third arg sets a le_wdog_Timeout() shorter than the kicking time, the heartbeat kicks
+# must still keep the watchdog alive after that timeout has expired.
+
+TEST_NAME='dogTestHeartbeat'
+test_pid='XXXXXXXXXXX'
+
+# configured watchdogTimeout: in seconds, rounded up
+expected_max_expiry=4
+
+match_stop_kick="Stopped kicking heartbeat"
+
+stop_kick_time=0
+timedout_time=0
+
+#find where the supervisor starts the test and get the pid
+start_match="supervisor.*\| Starting process $TEST_NAME with pid ([0-9]*)"
+
+while read line
+do
+if [[ $line =~ $start_match ]]; then
+    test_pid=${BASH_REMATCH[1]}
+    echo "--$TEST_NAME started with pid ${test_pid}"
+fi
+
+if [[ $line =~ $test_pid ]]; then
+# These are potential lines of interest
+    echo "---$line"
+
+    if [[ $line =~ $match_stop_kick ]]; then
+        stop_kick_time=$(date +%s)
+    fi
+
+    timedout_match="proc ${test_pid} timed out"
+    if [[ $line =~ $timedout_match ]]; then
+        if [[ $stop_kick_time -eq 0 ]]; then
+            # Timed out while the heartbeat was still being kicked.
+            echo "--FAIL"
+            exit 1
+        fi
+        timedout_time=$(date +%s)
+        let expiry_time=$timedout_time-$stop_kick_time
+        if [[ $expiry_time -le $expected_max_expiry ]]; then
+            echo "--PASS"
+            exit 0
+        else
+            echo "--FAIL"
+            exit 1
+        fi
+    fi
+fi
+done
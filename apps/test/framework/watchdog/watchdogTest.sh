@@ -245,6 +245,16 @@ set_test_message dogTestRevertAfterTimeout "Test if watchdog reverts to regular
 launch dogTestRevertAfterTimeout dogTestRevertAfterTimeoutWatcher.sh 120
 sleep 2
 
+set_test_message dogTestHeartbeat "Test if shared memory heartbeat kicks keep the watchdog alive"
+launch dogTestHeartbeat dogTestHeartbeatWatcher.sh 60
+sleep 2
+
+wait_for_results
+
+# test that heartbeat kicks are still counted once a le_wdog_Timeout() has expired
+config_args dogTestHeartbeat dogTestHeartbeat "500 20 3000"
+set_test_message dogTestHeartbeat "Test if shared memory heartbeat kicks keep the watchdog alive after le_wdog_Timeout()"
+launch dogTestHeartbeat dogTestHeartbeatWatcher.sh 60
 wait_for_results
 
 cleanup
@@ -13,6 +13,7 @@
 #include "time.h"
 #include "le_sms_local.h"
 #include "pa_sms_simu.h"
+#include "smsStub.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -22,6 +23,12 @@
 //--------------------------------------------------------------------------------------------------
 #define LONG_TIMEOUT    5000
 #define SHORT_TIMEOUT   1000
+#define RETRY_TIMEOUT   20000
+
+/// Maximum number of messages waiting to be sent, and number of retries after temporary errors,
+/// as defined in le_sms.c.
+#define SEND_QUEUE_MAX_DEPTH    64
+#define SEND_MAX_RETRIES        3
 #define VOID_PATTERN  ""
 
 #define SHORT_TEXT_TEST_PATTERN  "Short"
@@ -873,6 +880,149 @@ static void CallbackSendTestHandler
     le_sem_Post(SmsSendSemaphore);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the delay between two sending attempts, in seconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckSendingDelay
+(
+    le_clk_Time_t firstTime,
+    le_clk_Time_t nextTime,
+    time_t expectedDelay
+)
+{
+    le_clk_Time_t delay = le_clk_Sub(nextTime, firstTime);
+
+    LE_INFO("Sending retried after %ld.%06ld s", (long)delay.sec, (long)delay.usec);
+    LE_ASSERT((delay.sec >= expectedDelay) && (delay.sec <= expectedDelay + 1));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Testle_sms_SendRetry: test the queuing and retries of the asynchronous sendings
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_sms_SendRetry
+(
+    void
+)
+{
+    le_sms_MsgRef_t myMsg;
+    le_clk_Time_t   attemptTimes[SEND_MAX_RETRIES + 1];
+    uint32_t        pendingCount, maxPendingCount, avgLatency, maxLatency, retryCount;
+    int             i;
+
+    pa_sms_SetSmsErrCause(LE_OK);
+
+    // Queue full: while the sender thread holds a sending, the queue is filled up.
+    smsStub_HoldSending(true);
+    LE_ASSERT(le_sms_SendText(DEST_TEST_PATTERN, SHORT_TEXT_TEST_PATTERN,
+                              CallbackSendTestHandler, (void*) SMS_SEND_TEST_NUMBER_1));
+    smsStub_WaitForHeldSending();
+
+    for (i = 0; i < SEND_QUEUE_MAX_DEPTH; i++)
+    {
+        LE_ASSERT(le_sms_SendText(DEST_TEST_PATTERN, SHORT_TEXT_TEST_PATTERN,
+                                  CallbackSendTestHandler, (void*) SMS_SEND_TEST_NUMBER_2));
+    }
+
+    le_sms_GetSendQueueStats(&pendingCount, &maxPendingCount, &avgLatency, &maxLatency,
+                             &retryCount);
+    LE_ASSERT(SEND_QUEUE_MAX_DEPTH == pendingCount);
+
+    // The queue is full, sendings are rejected.
+    LE_ASSERT(NULL == le_sms_SendText(DEST_TEST_PATTERN, SHORT_TEXT_TEST_PATTERN,
+                                      CallbackSendTestHandler, (void*) SMS_SEND_TEST_NUMBER_3));
+    myMsg = le_sms_Create();
+    LE_ASSERT(myMsg);
+    LE_ASSERT(le_sms_SetDestination(myMsg, DEST_TEST_PATTERN) == LE_OK);
+    LE_ASSERT(le_sms_SetText(myMsg, TEXT_TEST_PATTERN) == LE_OK);
+    LE_ASSERT(le_sms_SendAsync(myMsg, CallbackSendTestHandler,
+                               (void*) SMS_SEND_TEST_NUMBER_3) == LE_FAULT);
+
+    // Once released, all the queued messages are sent.
+    smsStub_HoldSending(false);
+    for (i = 0; i <= SEND_QUEUE_MAX_DEPTH; i++)
+    {
+        WaitForSem(SmsSendSemaphore, LONG_TIMEOUT, LE_OK);
+    }
+
+    le_sms_GetSendQueueStats(&pendingCount, &maxPendingCount, &avgLatency, &maxLatency,
+                             &retryCount);
+    LE_ASSERT(0 == pendingCount);
+    LE_ASSERT(SEND_QUEUE_MAX_DEPTH == maxPendingCount);
+    LE_ASSERT(0 == retryCount);
+
+    // The rejected message can be sent once the queue is drained.
+    LE_ASSERT(le_sms_SendAsync(myMsg, CallbackSendTestHandler,
+                               (void*) SMS_SEND_TEST_NUMBER_3) == LE_OK);
+    WaitForSem(SmsSendSemaphore, LONG_TIMEOUT, LE_OK);
+
+    // Temporary errors: the sending is retried after 2, 4 and 8 seconds, then succeeds.
+    smsStub_SetTemporaryErrorCount(SEND_MAX_RETRIES);
+    myMsg = le_sms_Create();
+    LE_ASSERT(myMsg);
+    LE_ASSERT(le_sms_SetDestination(myMsg, DEST_TEST_PATTERN) == LE_OK);
+    LE_ASSERT(le_sms_SetText(myMsg, TEXT_TEST_PATTERN) == LE_OK);
+    LE_ASSERT(le_sms_SendAsync(myMsg, CallbackSendTestHandler,
+                               (void*) SMS_SEND_TEST_NUMBER_4) == LE_OK);
+    WaitForSem(SmsSendSemaphore, RETRY_TIMEOUT, LE_OK);
+
+    LE_ASSERT(smsStub_GetSendingAttempts(attemptTimes, NUM_ARRAY_MEMBERS(attemptTimes)) ==
+              SEND_MAX_RETRIES + 1);
+    CheckSendingDelay(attemptTimes[0], attemptTimes[1], 2);
+    CheckSendingDelay(attemptTimes[1], attemptTimes[2], 4);
+    CheckSendingDelay(attemptTimes[2], attemptTimes[3], 8);
+
+    le_sms_GetSendQueueStats(&pendingCount, &maxPendingCount, &avgLatency, &maxLatency,
+                             &retryCount);
+    LE_ASSERT(SEND_MAX_RETRIES == retryCount);
+    LE_ASSERT(maxLatency >= 14000);
+
+    // Temporary errors beyond the maximum number of retries: the sending fails.
+    smsStub_SetTemporaryErrorCount(SEND_MAX_RETRIES + 1);
+    myMsg = le_sms_Create();
+    LE_ASSERT(myMsg);
+    LE_ASSERT(le_sms_SetDestination(myMsg, DEST_TEST_PATTERN) == LE_OK);
+    LE_ASSERT(le_sms_SetText(myMsg, TEXT_TEST_PATTERN) == LE_OK);
+    LE_ASSERT(le_sms_SendAsync(myMsg, CallbackSendTestHandler,
+                               (void*) SMS_SEND_TEST_FAILED) == LE_OK);
+    WaitForSem(SmsSendSemaphore, RETRY_TIMEOUT, LE_OK);
+
+    LE_ASSERT(smsStub_GetSendingAttempts(attemptTimes, NUM_ARRAY_MEMBERS(attemptTimes)) ==
+              SEND_MAX_RETRIES + 1);
+
+    le_sms_GetSendQueueStats(&pendingCount, &maxPendingCount, &avgLatency, &maxLatency,
+                             &retryCount);
+    LE_ASSERT(2 * SEND_MAX_RETRIES == retryCount);
+
+    // Retry vs timeout: a retry that would end after the message timeout is not scheduled, the
+    // sending fails after the first retry.
+    smsStub_SetTemporaryErrorCount(SEND_MAX_RETRIES);
+    myMsg = le_sms_Create();
+    LE_ASSERT(myMsg);
+    LE_ASSERT(le_sms_SetDestination(myMsg, DEST_TEST_PATTERN) == LE_OK);
+    LE_ASSERT(le_sms_SetText(myMsg, TEXT_TEST_PATTERN) == LE_OK);
+    LE_ASSERT(le_sms_SetTimeout(myMsg, 5) == LE_OK);
+    LE_ASSERT(le_sms_SendAsync(myMsg, CallbackSendTestHandler,
+                               (void*) SMS_SEND_TEST_FAILED) == LE_OK);
+    WaitForSem(SmsSendSemaphore, RETRY_TIMEOUT, LE_OK);
+
+    LE_ASSERT(smsStub_GetSendingAttempts(attemptTimes, NUM_ARRAY_MEMBERS(attemptTimes)) == 2);
+    CheckSendingDelay(attemptTimes[0], attemptTimes[1], 2);
+
+    le_sms_GetSendQueueStats(&pendingCount, &maxPendingCount, &avgLatency, &maxLatency,
+                             &retryCount);
+    LE_ASSERT(2 * SEND_MAX_RETRIES + 1 == retryCount);
+
+    smsStub_SetTemporaryErrorCount(0);
+
+    // Check that no more call of the semaphore
+    LE_ASSERT(le_sem_GetValue(SmsSendSemaphore) == 0);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Testle_sms_send: this function handles the different SMS sending
@@ -1022,6 +1172,20 @@ static void Testle_sms_Send
 
     // Check that no more call of the semaphore
     LE_ASSERT(le_sem_GetValue(SmsSendSemaphore) == 0);
+
+    // Check the sending queue statistics
+    uint32_t pendingCount, maxPendingCount, avgLatency, maxLatency, retryCount;
+    le_sms_GetSendQueueStats(&pendingCount, &maxPendingCount, &avgLatency, &maxLatency,
+                             &retryCount);
+    LE_INFO("Sending queue: pending %u, max pending %u, latency avg %u ms, max %u ms, retries %u",
+            pendingCount, maxPendingCount, avgLatency, maxLatency, retryCount);
+    LE_ASSERT(0 == pendingCount);
+    LE_ASSERT(maxPendingCount >= 1);
+    LE_ASSERT(maxLatency >= avgLatency);
+    LE_ASSERT(0 == retryCount);
+
+    // Test the sending queue limit and the retries after temporary errors
+    Testle_sms_SendRetry();
 }
 
 //--------------------------------------------------------------------------------------------------
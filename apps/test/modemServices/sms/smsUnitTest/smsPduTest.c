@@ -15,6 +15,9 @@
 
 #define PDU_MAX     256
 
+/// Number of PDUs encoded and decoded by the benchmark
+#define PDU_BENCHMARK_ROUNDS    10000
+
 
 typedef struct
 {
@@ -2097,6 +2100,77 @@ static le_result_t TestEncodePdu
     return LE_OK;
 }
 
+//--------------------------------------------------------------------------------------------------
+/*
+ * Benchmark of the GSM 7-bit encoding and decoding of a full length SMS, with some characters of
+ * the extension table.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t TestBenchmarkPdu
+(
+    void
+)
+{
+    static const char text[] = "Benchmark of the GSM 7 bits packing [with {escaped} characters]"
+                               " 0123456789 abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                               " ~|^\\ end";
+    pa_sms_Pdu_t pdu;
+    pa_sms_Message_t message;
+    smsPdu_DataToEncode_t data;
+    le_clk_Time_t startTime;
+    le_clk_Time_t encodeTime;
+    le_clk_Time_t decodeTime;
+    int i;
+
+    memset(&data, 0, sizeof(data));
+    data.protocol = PA_SMS_PROTOCOL_GSM;
+    data.messagePtr = (const uint8_t*)text;
+    data.length = strlen(text);
+    data.addressPtr = PduAssocDb[0].dest;
+    data.encoding = SMSPDU_7_BITS;
+    data.messageType = PA_SMS_SUBMIT;
+
+    startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < PDU_BENCHMARK_ROUNDS; i++)
+    {
+        if (smsPdu_Encode(&data, &pdu) != LE_OK)
+        {
+            return LE_FAULT;
+        }
+    }
+
+    encodeTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < PDU_BENCHMARK_ROUNDS; i++)
+    {
+        if (smsPdu_Decode(PA_SMS_PROTOCOL_GSM, pdu.data, pdu.dataLen, true, &message) != LE_OK)
+        {
+            return LE_FAULT;
+        }
+    }
+
+    decodeTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    if (   (message.type != PA_SMS_SUBMIT)
+        || (message.smsSubmit.dataLen != strlen(text))
+        || (memcmp(message.smsSubmit.data, text, strlen(text)) != 0)  )
+    {
+        LE_ERROR("Data (%u): '%s'", message.smsSubmit.dataLen, message.smsSubmit.data);
+        return LE_FAULT;
+    }
+
+    LE_INFO("Encoded %d PDUs in %ld.%06ld s", PDU_BENCHMARK_ROUNDS,
+            (long)encodeTime.sec, encodeTime.usec);
+    LE_INFO("Decoded %d PDUs in %ld.%06ld s", PDU_BENCHMARK_ROUNDS,
+            (long)decodeTime.sec, decodeTime.usec);
+
+    return LE_OK;
+}
+
 //--------------------------------------------------------------------------------------------------
 /*
  * SMS PDU encoding and decoding test
@@ -2114,5 +2188,8 @@ void testle_sms_SmsPduTest
     LE_INFO("Test DecodePdu started");
     LE_ASSERT_OK(TestDecodePdu());
 
+    LE_INFO("Test BenchmarkPdu started");
+    LE_ASSERT_OK(TestBenchmarkPdu());
+
     LE_INFO("smsPduTest SUCCESS");
 }
@@ -7,6 +7,27 @@
 
 #include "legato.h"
 #include "interfaces.h"
+#include "pa_sms.h"
+#include "smsStub.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of sendings left to fail with a temporary error, and times of the sending attempts.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t TemporaryErrorCount = 0;
+static le_clk_Time_t SendingAttemptTimes[SMS_STUB_MAX_SENDING_ATTEMPTS];
+static size_t SendingAttemptCount = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Held sendings: whether the sendings are held, the semaphore a held sending waits on, and the
+ * semaphore posted when a sending is held.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsSendingHeld = false;
+static le_sem_Ref_t HoldSendingSem = NULL;
+static le_sem_Ref_t SendingHeldSem = NULL;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -50,3 +71,154 @@ le_msg_SessionEventHandlerRef_t MyAddServiceCloseHandler
 {
     return NULL;
 }
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Platform adaptor sending of the simulation, wrapped at link time (see Component.cdef).
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t __real_pa_sms_SendPduMsg
+(
+    pa_sms_Protocol_t        protocol,
+    uint32_t                 length,
+    const uint8_t           *dataPtr,
+    uint32_t                 timeout,
+    pa_sms_SendingErrCode_t *errorCode
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wrapper of the platform adaptor sending: records the sending attempts, holds the sendings and
+ * simulates temporary errors, as requested by the test.  (STUBBED FUNCTION)
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t __wrap_pa_sms_SendPduMsg
+(
+    pa_sms_Protocol_t        protocol,   ///< [IN] protocol to use
+    uint32_t                 length,     ///< [IN] The length of the TP data unit in bytes.
+    const uint8_t           *dataPtr,    ///< [IN] The message.
+    uint32_t                 timeout,    ///< [IN] Timeout in seconds.
+    pa_sms_SendingErrCode_t *errorCode   ///< [OUT] The error code.
+)
+{
+    if (SendingAttemptCount < SMS_STUB_MAX_SENDING_ATTEMPTS)
+    {
+        SendingAttemptTimes[SendingAttemptCount] = le_clk_GetRelativeTime();
+    }
+    SendingAttemptCount++;
+
+    if (IsSendingHeld)
+    {
+        le_sem_Post(SendingHeldSem);
+        le_sem_Wait(HoldSendingSem);
+    }
+
+    if (TemporaryErrorCount > 0)
+    {
+        TemporaryErrorCount--;
+        errorCode->rp = LE_SMS_RP_ERROR_CONGESTION;
+        errorCode->tp = LE_SMS_ERROR_3GPP_MAX;
+        errorCode->code3GPP2 = LE_SMS_ERROR_3GPP2_MAX;
+        return LE_FAULT;
+    }
+
+    return __real_pa_sms_SendPduMsg(protocol, length, dataPtr, timeout, errorCode);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Platform adaptor batch read, wrapped at link time (see Component.cdef): the simulation reads the
+ * messages one by one.  (STUBBED FUNCTION)
+ *
+ * @return LE_UNSUPPORTED  The platform can't read several messages in a single request.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t __wrap_pa_sms_RdPDUMsgBatchFromMem
+(
+    const uint32_t*     indexArrayPtr,  ///< [IN] The places of storage in memory.
+    uint32_t            numOfMsg,       ///< [IN] The number of messages to read.
+    pa_sms_Protocol_t   protocol,       ///< [IN] The protocol used for these messages
+    pa_sms_Storage_t    storage,        ///< [IN] SMS Storage used
+    pa_sms_Pdu_t*       msgArrayPtr,    ///< [OUT] The messages.
+    le_result_t*        resultArrayPtr  ///< [OUT] The result of the read of each message.
+)
+{
+    return LE_UNSUPPORTED;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make the next sendings fail with a temporary error (RP cause congestion), and forget the
+ * recorded sending attempts.
+ */
+//--------------------------------------------------------------------------------------------------
+void smsStub_SetTemporaryErrorCount
+(
+    uint32_t count      ///< [IN] Number of sendings to fail.
+)
+{
+    TemporaryErrorCount = count;
+    SendingAttemptCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the times of the sending attempts recorded since smsStub_SetTemporaryErrorCount().
+ *
+ * @return Number of sending attempts.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t smsStub_GetSendingAttempts
+(
+    le_clk_Time_t* timesPtr,    ///< [OUT] Relative times of the attempts.
+    size_t timesCount           ///< [IN] Number of times that fit in timesPtr.
+)
+{
+    size_t i;
+
+    for (i = 0; (i < timesCount) && (i < SendingAttemptCount) &&
+                (i < SMS_STUB_MAX_SENDING_ATTEMPTS); i++)
+    {
+        timesPtr[i] = SendingAttemptTimes[i];
+    }
+
+    return SendingAttemptCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hold the sendings in the platform adaptor, or release them.
+ */
+//--------------------------------------------------------------------------------------------------
+void smsStub_HoldSending
+(
+    bool hold           ///< [IN] true to hold the sendings, false to release them.
+)
+{
+    if (NULL == HoldSendingSem)
+    {
+        HoldSendingSem = le_sem_Create("HoldSendingSem", 0);
+        SendingHeldSem = le_sem_Create("SendingHeldSem", 0);
+    }
+
+    IsSendingHeld = hold;
+
+    if (!hold)
+    {
+        // Release the sending being held, if any.
+        le_sem_Post(HoldSendingSem);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait until a sending is held in the platform adaptor.
+ */
+//--------------------------------------------------------------------------------------------------
+void smsStub_WaitForHeldSending
+(
+    void
+)
+{
+    le_sem_Wait(SendingHeldSem);
+}
@@ -0,0 +1,66 @@
+/**
+ * @file smsStub.h
+ *
+ * Stubs of the sms unit test, to control the sendings of the simulated platform adaptor.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#ifndef SMS_STUB_H_INCLUDE_GUARD
+#define SMS_STUB_H_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of sending attempts recorded.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMS_STUB_MAX_SENDING_ATTEMPTS   8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Make the next sendings fail with a temporary error (RP cause congestion), and forget the
+ * recorded sending attempts.
+ */
+//--------------------------------------------------------------------------------------------------
+void smsStub_SetTemporaryErrorCount
+(
+    uint32_t count      ///< [IN] Number of sendings to fail.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the times of the sending attempts recorded since smsStub_SetTemporaryErrorCount().
+ *
+ * @return Number of sending attempts.
+ */
+//--------------------------------------------------------------------------------------------------
+size_t smsStub_GetSendingAttempts
+(
+    le_clk_Time_t* timesPtr,    ///< [OUT] Relative times of the attempts.
+    size_t timesCount           ///< [IN] Number of times that fit in timesPtr.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hold the sendings in the platform adaptor, or release them.
+ */
+//--------------------------------------------------------------------------------------------------
+void smsStub_HoldSending
+(
+    bool hold           ///< [IN] true to hold the sendings, false to release them.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Wait until a sending is held in the platform adaptor.
+ */
+//--------------------------------------------------------------------------------------------------
+void smsStub_WaitForHeldSending
+(
+    void
+);
+
+#endif // SMS_STUB_H_INCLUDE_GUARD
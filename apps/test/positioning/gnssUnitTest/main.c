@@ -12,6 +12,8 @@
 #include "le_gnss_local.h"
 #include "le_log.h"
 
+#include <sys/socket.h>
+
 //--------------------------------------------------------------------------------------------------
 /**
  * SV ID definitions corresponding to SBAS constellation categories
@@ -80,6 +82,80 @@ static le_sem_Ref_t                 ThreadSemaphore;
 static le_thread_Ref_t              AppThreadRef;
 static le_clk_Time_t                TimeToWait = { 5, 0 };
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that le_gnss_GetSnapshot() returns the same values as the individual getters.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckGnssSnapshot
+(
+    le_gnss_SampleRef_t positionSampleRef
+)
+{
+    le_gnss_SampleFieldBitMask_t validFields;
+    le_gnss_FixState_t state, snapState;
+    int32_t latitude, longitude, hAccuracy, snapLatitude, snapLongitude, snapHAccuracy;
+    int32_t altitude, vAccuracy, snapAltitude, snapVAccuracy;
+    uint32_t hSpeed, hSpeedAccuracy, snapHSpeed, snapHSpeedAccuracy;
+    int32_t vSpeed, vSpeedAccuracy, snapVSpeed, snapVSpeedAccuracy;
+    uint32_t direction, directionAccuracy, snapDirection, snapDirectionAccuracy;
+    uint16_t year, month, day, snapYear, snapMonth, snapDay;
+    uint16_t hours, minutes, seconds, milliseconds;
+    uint16_t snapHours, snapMinutes, snapSeconds, snapMilliseconds;
+    le_result_t result;
+
+    result = le_gnss_GetSnapshot(positionSampleRef, &validFields, &snapState,
+                                 &snapLatitude, &snapLongitude, &snapHAccuracy,
+                                 &snapAltitude, &snapVAccuracy,
+                                 &snapHSpeed, &snapHSpeedAccuracy,
+                                 &snapVSpeed, &snapVSpeedAccuracy,
+                                 &snapDirection, &snapDirectionAccuracy,
+                                 &snapYear, &snapMonth, &snapDay,
+                                 &snapHours, &snapMinutes, &snapSeconds, &snapMilliseconds);
+    LE_ASSERT((LE_OK == result)||(LE_OUT_OF_RANGE == result));
+
+    LE_ASSERT_OK(le_gnss_GetPositionState(positionSampleRef, &state));
+    LE_ASSERT(state == snapState);
+
+    le_gnss_GetLocation(positionSampleRef, &latitude, &longitude, &hAccuracy);
+    LE_ASSERT((latitude == snapLatitude) && (longitude == snapLongitude) &&
+              (hAccuracy == snapHAccuracy));
+    LE_ASSERT(((validFields & LE_GNSS_SAMPLE_LATITUDE) != 0) == (INT32_MAX != latitude));
+
+    le_gnss_GetAltitude(positionSampleRef, &altitude, &vAccuracy);
+    LE_ASSERT((altitude == snapAltitude) && (vAccuracy == snapVAccuracy));
+
+    le_gnss_GetHorizontalSpeed(positionSampleRef, &hSpeed, &hSpeedAccuracy);
+    LE_ASSERT((hSpeed == snapHSpeed) && (hSpeedAccuracy == snapHSpeedAccuracy));
+
+    le_gnss_GetVerticalSpeed(positionSampleRef, &vSpeed, &vSpeedAccuracy);
+    LE_ASSERT((vSpeed == snapVSpeed) && (vSpeedAccuracy == snapVSpeedAccuracy));
+
+    le_gnss_GetDirection(positionSampleRef, &direction, &directionAccuracy);
+    LE_ASSERT((direction == snapDirection) && (directionAccuracy == snapDirectionAccuracy));
+
+    result = le_gnss_GetDate(positionSampleRef, &year, &month, &day);
+    LE_ASSERT((year == snapYear) && (month == snapMonth) && (day == snapDay));
+    LE_ASSERT(((validFields & LE_GNSS_SAMPLE_DATE) != 0) == (LE_OK == result));
+
+    result = le_gnss_GetTime(positionSampleRef, &hours, &minutes, &seconds, &milliseconds);
+    LE_ASSERT((hours == snapHours) && (minutes == snapMinutes) && (seconds == snapSeconds) &&
+              (milliseconds == snapMilliseconds));
+    LE_ASSERT(((validFields & LE_GNSS_SAMPLE_TIME) != 0) == (LE_OK == result));
+
+    // Pass invalid sample reference
+    LE_ASSERT(LE_FAULT == le_gnss_GetSnapshot(GnssPositionSampleRef, &validFields, &snapState,
+                                              &snapLatitude, &snapLongitude, &snapHAccuracy,
+                                              &snapAltitude, &snapVAccuracy,
+                                              &snapHSpeed, &snapHSpeedAccuracy,
+                                              &snapVSpeed, &snapVSpeedAccuracy,
+                                              &snapDirection, &snapDirectionAccuracy,
+                                              &snapYear, &snapMonth, &snapDay,
+                                              &snapHours, &snapMinutes, &snapSeconds,
+                                              &snapMilliseconds));
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handler function for Position Notifications.
@@ -224,6 +300,9 @@ static void GnssPositionHandlerFunction
     LE_ASSERT(LE_FAULT == (le_gnss_GetDirection(GnssPositionSampleRef, &direction,
                                                 &directionAccuracy)));
 
+    // Get all the parameters at once
+    CheckGnssSnapshot(positionSampleRef);
+
     // Get the magnetic deviation
     result = le_gnss_GetMagneticDeviation(positionSampleRef, &magneticDeviation);
     LE_ASSERT((LE_OK == result)||(LE_OUT_OF_RANGE == result));
@@ -767,6 +846,384 @@ static void Testle_gnss_DeviceReadyStateTest
     LE_ASSERT(LE_DUPLICATE == (le_gnss_Start()));
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Position history test parameters: a 100-fix ring filled at 10 Hz, and for the benchmark a
+ * one-hour ring filled at 1 Hz.
+ */
+//--------------------------------------------------------------------------------------------------
+#define HISTORY_TEST_SIZE           100
+#define HISTORY_TEST_FILE           "/tmp/gnssHistoryUnitTest"
+#define HISTORY_TEST_START_TIME     1500000000000ULL
+#define HISTORY_BENCHMARK_SIZE      3600
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add periodic fixes to the position history, without altitude nor horizontal speed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RecordHistoryFixes
+(
+    uint64_t startTime,
+    uint32_t period,
+    uint32_t count
+)
+{
+    pa_Gnss_Position_t position;
+    uint32_t i;
+
+    memset(&position, 0, sizeof(position));
+    position.fixState = LE_GNSS_STATE_FIX_3D;
+    position.latitudeValid = true;
+    position.longitudeValid = true;
+    position.hUncertaintyValid = true;
+    position.hUncertainty = 1000;
+    position.directionValid = true;
+    position.direction = 900;
+    position.timeValid = true;
+
+    for (i = 0; i < count; i++)
+    {
+        position.epochTime = startTime + (uint64_t)i * period;
+        position.latitude = 48823091 + i;
+        position.longitude = 2249324 + i;
+        gnssHistory_Record(&position);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a batch of fixes from the position history, and check their values.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetHistoryTimes
+(
+    uint64_t  startTime,
+    uint64_t  stopTime,
+    uint32_t  minInterval,
+    uint64_t* epochTimePtr,     ///< [OUT] LE_GNSS_HISTORY_BATCH_MAX_LEN times.
+    size_t*   countPtr
+)
+{
+    int32_t latitude[LE_GNSS_HISTORY_BATCH_MAX_LEN];
+    int32_t longitude[LE_GNSS_HISTORY_BATCH_MAX_LEN];
+    int32_t hAccuracy[LE_GNSS_HISTORY_BATCH_MAX_LEN];
+    int32_t altitude[LE_GNSS_HISTORY_BATCH_MAX_LEN];
+    uint32_t hSpeed[LE_GNSS_HISTORY_BATCH_MAX_LEN];
+    uint32_t direction[LE_GNSS_HISTORY_BATCH_MAX_LEN];
+    size_t epochTimeNumElements = LE_GNSS_HISTORY_BATCH_MAX_LEN;
+    size_t latitudeNumElements = LE_GNSS_HISTORY_BATCH_MAX_LEN;
+    size_t longitudeNumElements = LE_GNSS_HISTORY_BATCH_MAX_LEN;
+    size_t hAccuracyNumElements = LE_GNSS_HISTORY_BATCH_MAX_LEN;
+    size_t altitudeNumElements = LE_GNSS_HISTORY_BATCH_MAX_LEN;
+    size_t hSpeedNumElements = LE_GNSS_HISTORY_BATCH_MAX_LEN;
+    size_t directionNumElements = LE_GNSS_HISTORY_BATCH_MAX_LEN;
+    le_result_t result;
+    size_t i;
+
+    result = le_gnss_GetPositionHistory(startTime, stopTime, minInterval,
+                                        epochTimePtr, &epochTimeNumElements,
+                                        latitude, &latitudeNumElements,
+                                        longitude, &longitudeNumElements,
+                                        hAccuracy, &hAccuracyNumElements,
+                                        altitude, &altitudeNumElements,
+                                        hSpeed, &hSpeedNumElements,
+                                        direction, &directionNumElements);
+
+    LE_ASSERT((latitudeNumElements == epochTimeNumElements) &&
+              (directionNumElements == epochTimeNumElements));
+    for (i = 0; i < epochTimeNumElements; i++)
+    {
+        LE_ASSERT((latitude[i] - 48823091) == (longitude[i] - 2249324));
+        LE_ASSERT((1000 == hAccuracy[i]) && (900 == direction[i]));
+        LE_ASSERT((INT32_MAX == altitude[i]) && (UINT32_MAX == hSpeed[i]));
+    }
+
+    *countPtr = epochTimeNumElements;
+    return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the position history
+ *
+ * API tested:
+ * - le_gnss_GetPositionHistory
+ *
+ * The benchmark logs the cost of recording a fix, and the number of requests needed to read one
+ * hour of fixes, which is one per fix with a position handler.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_gnss_PositionHistory
+(
+    void
+)
+{
+    uint64_t epochTime[LE_GNSS_HISTORY_BATCH_MAX_LEN];
+    uint64_t firstTime = HISTORY_TEST_START_TIME + 150 * 100;
+    uint64_t startTime;
+    le_clk_Time_t recordTime;
+    le_clk_Time_t readTime;
+    le_clk_Time_t clock;
+    le_result_t result;
+    size_t count;
+    size_t total;
+    int requestCount;
+    size_t i;
+
+    // Disabled history
+    LE_ASSERT_OK(gnssHistory_Init(0, NULL));
+    LE_ASSERT(LE_UNAVAILABLE == GetHistoryTimes(0, UINT64_MAX, 0, epochTime, &count));
+    LE_ASSERT(0 == count);
+
+    // 250 fixes at 10 Hz in a ring of 100 fixes: the 100 last ones are kept.
+    unlink(HISTORY_TEST_FILE);
+    LE_ASSERT_OK(gnssHistory_Init(HISTORY_TEST_SIZE, HISTORY_TEST_FILE));
+    LE_ASSERT_OK(GetHistoryTimes(0, UINT64_MAX, 0, epochTime, &count));
+    LE_ASSERT(0 == count);
+    RecordHistoryFixes(HISTORY_TEST_START_TIME, 100, 250);
+
+    // A fix not newer than the last one is ignored.
+    RecordHistoryFixes(HISTORY_TEST_START_TIME, 100, 1);
+
+    LE_ASSERT(LE_OVERFLOW == GetHistoryTimes(0, UINT64_MAX, 0, epochTime, &count));
+    LE_ASSERT(LE_GNSS_HISTORY_BATCH_MAX_LEN == count);
+    for (i = 0; i < count; i++)
+    {
+        LE_ASSERT((firstTime + i * 100) == epochTime[i]);
+    }
+    startTime = epochTime[count - 1] + 1;
+    LE_ASSERT_OK(GetHistoryTimes(startTime, UINT64_MAX, 0, epochTime, &count));
+    LE_ASSERT((HISTORY_TEST_SIZE - LE_GNSS_HISTORY_BATCH_MAX_LEN) == count);
+    LE_ASSERT((firstTime + (HISTORY_TEST_SIZE - 1) * 100) == epochTime[count - 1]);
+
+    // Time range and decimation
+    LE_ASSERT_OK(GetHistoryTimes(firstTime + 2000, firstTime + 2450, 0, epochTime, &count));
+    LE_ASSERT((5 == count) && ((firstTime + 2000) == epochTime[0]));
+    LE_ASSERT_OK(GetHistoryTimes(0, UINT64_MAX, 1000, epochTime, &count));
+    LE_ASSERT(10 == count);
+    for (i = 0; i < count; i++)
+    {
+        LE_ASSERT((firstTime + i * 1000) == epochTime[i]);
+    }
+    LE_ASSERT(LE_BAD_PARAMETER == GetHistoryTimes(2, 1, 0, epochTime, &count));
+
+    // The history is reloaded from its file, unless the ring size changes.
+    gnssHistory_Flush();
+    LE_ASSERT_OK(gnssHistory_Init(HISTORY_TEST_SIZE, HISTORY_TEST_FILE));
+    LE_ASSERT(LE_OVERFLOW == GetHistoryTimes(0, UINT64_MAX, 0, epochTime, &count));
+    LE_ASSERT((LE_GNSS_HISTORY_BATCH_MAX_LEN == count) && (firstTime == epochTime[0]));
+    RecordHistoryFixes(firstTime + HISTORY_TEST_SIZE * 100, 100, 1);
+    LE_ASSERT_OK(GetHistoryTimes(firstTime + HISTORY_TEST_SIZE * 100, UINT64_MAX, 0,
+                                 epochTime, &count));
+    LE_ASSERT(1 == count);
+    LE_ASSERT_OK(gnssHistory_Init(HISTORY_TEST_SIZE / 2, HISTORY_TEST_FILE));
+    LE_ASSERT_OK(GetHistoryTimes(0, UINT64_MAX, 0, epochTime, &count));
+    LE_ASSERT(0 == count);
+
+    // Benchmark: one hour at 1 Hz, read in batches.
+    LE_ASSERT_OK(gnssHistory_Init(HISTORY_BENCHMARK_SIZE, NULL));
+    clock = le_clk_GetRelativeTime();
+    RecordHistoryFixes(HISTORY_TEST_START_TIME, 1000, HISTORY_BENCHMARK_SIZE);
+    recordTime = le_clk_Sub(le_clk_GetRelativeTime(), clock);
+
+    clock = le_clk_GetRelativeTime();
+    startTime = 0;
+    total = 0;
+    requestCount = 0;
+    do
+    {
+        result = GetHistoryTimes(startTime, UINT64_MAX, 0, epochTime, &count);
+        requestCount++;
+        total += count;
+        if (count > 0)
+        {
+            startTime = epochTime[count - 1] + 1;
+        }
+    }
+    while (LE_OVERFLOW == result);
+    readTime = le_clk_Sub(le_clk_GetRelativeTime(), clock);
+    LE_ASSERT_OK(result);
+    LE_ASSERT(HISTORY_BENCHMARK_SIZE == total);
+
+    LE_INFO("%d fixes recorded in %ld.%06ld s, read with %d requests in %ld.%06ld s"
+            " (%d with a position handler)",
+            HISTORY_BENCHMARK_SIZE, (long)recordTime.sec, (long)recordTime.usec,
+            requestCount, (long)readTime.sec, (long)readTime.usec, HISTORY_BENCHMARK_SIZE);
+
+    LE_ASSERT_OK(gnssHistory_Init(0, NULL));
+    unlink(HISTORY_TEST_FILE);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * NMEA stream test parameters.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NMEA_TEST_FRAME_BYTES       100
+#define NMEA_BENCHMARK_READERS      4
+#define NMEA_BENCHMARK_FRAMES       10240
+#define NMEA_BENCHMARK_BURST        32      // Frames between two reads, NMEA_BENCHMARK_FRAMES
+                                            // being a multiple of it.
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * NMEA frames of the NMEA stream test.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* NmeaTestFrames[] =
+{
+    "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47",
+    "$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A",
+    "$PQXFI,123519.0,4807.038,N,01131.000,E,545.4,0.9,1.2,0.3*5E",
+    "$GNRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*74",
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report an NMEA frame as the PA does, in a memory pool block.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportNmeaFrame
+(
+    le_mem_PoolRef_t poolRef,
+    const char*      framePtr
+)
+{
+    char* nmeaPtr = le_mem_ForceAlloc(poolRef);
+
+    LE_ASSERT_OK(le_utf8_Copy(nmeaPtr, framePtr, NMEA_TEST_FRAME_BYTES, NULL));
+    gnssNmea_Report(nmeaPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the next NMEA frame of a stream, NULL if no frame is expected.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckNmeaFrame
+(
+    int         fd,
+    const char* framePtr
+)
+{
+    char buffer[NMEA_TEST_FRAME_BYTES];
+    ssize_t size = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+    if (NULL == framePtr)
+    {
+        LE_ASSERT((-1 == size) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)));
+    }
+    else
+    {
+        LE_ASSERT((strlen(framePtr) + 1) == (size_t)size);
+        LE_ASSERT(0 == strcmp(framePtr, buffer));
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test the NMEA streams
+ *
+ * API tested:
+ * - le_gnss_OpenNmeaStream
+ * - le_gnss_CloseNmeaStream
+ *
+ * The benchmark logs the cost of sending the frames to several readers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_gnss_NmeaStreams
+(
+    void
+)
+{
+    le_mem_PoolRef_t poolRef = le_mem_CreatePool("NmeaTestPool", NMEA_TEST_FRAME_BYTES);
+    le_gnss_NmeaStreamRef_t streamRef[NMEA_BENCHMARK_READERS];
+    int streamFd[NMEA_BENCHMARK_READERS];
+    le_gnss_NmeaStreamRef_t ggaStreamRef;
+    le_gnss_NmeaStreamRef_t ptypeStreamRef;
+    le_gnss_NmeaStreamRef_t allStreamRef;
+    int ggaFd, ptypeFd, allFd, fd;
+    char buffer[NMEA_TEST_FRAME_BYTES];
+    le_clk_Time_t clock;
+    size_t received;
+    int i, j;
+
+    // NMEA frames reported by the PA
+    gnssNmea_Start();
+
+    LE_ASSERT(NULL == le_gnss_OpenNmeaStream(LE_GNSS_NMEA_SENTENCES_MAX + 1, &fd));
+    LE_ASSERT(-1 == fd);
+
+    ggaStreamRef = le_gnss_OpenNmeaStream(LE_GNSS_NMEA_MASK_GPGGA, &ggaFd);
+    ptypeStreamRef = le_gnss_OpenNmeaStream(LE_GNSS_NMEA_MASK_PTYPE, &ptypeFd);
+    allStreamRef = le_gnss_OpenNmeaStream(0, &allFd);
+    LE_ASSERT((NULL != ggaStreamRef) && (NULL != ptypeStreamRef) && (NULL != allStreamRef));
+
+    for (i = 0; i < (int)NUM_ARRAY_MEMBERS(NmeaTestFrames); i++)
+    {
+        ReportNmeaFrame(poolRef, NmeaTestFrames[i]);
+    }
+
+    // Each stream only gets the sentences of its filter.
+    CheckNmeaFrame(ggaFd, NmeaTestFrames[0]);
+    CheckNmeaFrame(ggaFd, NULL);
+    CheckNmeaFrame(ptypeFd, NmeaTestFrames[2]);
+    CheckNmeaFrame(ptypeFd, NULL);
+    for (i = 0; i < (int)NUM_ARRAY_MEMBERS(NmeaTestFrames); i++)
+    {
+        CheckNmeaFrame(allFd, NmeaTestFrames[i]);
+    }
+    CheckNmeaFrame(allFd, NULL);
+
+    // A closed stream gets the end of file.
+    le_gnss_CloseNmeaStream(ptypeStreamRef);
+    ReportNmeaFrame(poolRef, NmeaTestFrames[2]);
+    LE_ASSERT(0 == recv(ptypeFd, buffer, sizeof(buffer), MSG_DONTWAIT));
+    CheckNmeaFrame(allFd, NmeaTestFrames[2]);
+    close(ptypeFd);
+
+    le_gnss_CloseNmeaStream(ggaStreamRef);
+    le_gnss_CloseNmeaStream(allStreamRef);
+    close(ggaFd);
+    close(allFd);
+
+    // Benchmark: several readers getting all the frames, read in bursts.
+    for (i = 0; i < NMEA_BENCHMARK_READERS; i++)
+    {
+        streamRef[i] = le_gnss_OpenNmeaStream(0, &streamFd[i]);
+        LE_ASSERT(NULL != streamRef[i]);
+    }
+
+    clock = le_clk_GetRelativeTime();
+    received = 0;
+    for (i = 0; i < NMEA_BENCHMARK_FRAMES; i += NMEA_BENCHMARK_BURST)
+    {
+        for (j = 0; j < NMEA_BENCHMARK_BURST; j++)
+        {
+            ReportNmeaFrame(poolRef, NmeaTestFrames[j % NUM_ARRAY_MEMBERS(NmeaTestFrames)]);
+        }
+        for (j = 0; j < NMEA_BENCHMARK_READERS; j++)
+        {
+            while (recv(streamFd[j], buffer, sizeof(buffer), MSG_DONTWAIT) > 0)
+            {
+                received++;
+            }
+        }
+    }
+    clock = le_clk_Sub(le_clk_GetRelativeTime(), clock);
+
+    LE_ASSERT(received == (NMEA_BENCHMARK_FRAMES * NMEA_BENCHMARK_READERS));
+    LE_INFO("%d NMEA frames sent to %d readers in %ld.%06ld s",
+            NMEA_BENCHMARK_FRAMES, NMEA_BENCHMARK_READERS, (long)clock.sec, (long)clock.usec);
+
+    for (i = 0; i < NMEA_BENCHMARK_READERS; i++)
+    {
+        le_gnss_CloseNmeaStream(streamRef[i]);
+        close(streamFd[i]);
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * main of the test
@@ -816,6 +1273,12 @@ COMPONENT_INIT
     LE_INFO("======== GNSS SetSuplAssistedMode========");
     Testle_gnss_SetSuplAssistedMode();
 
+    LE_INFO("======== GNSS Position History========");
+    Testle_gnss_PositionHistory();
+
+    LE_INFO("======== GNSS NMEA Streams========");
+    Testle_gnss_NmeaStreams();
+
     LE_INFO("======== GNSS Remove Position Handler========");
     Testle_gnss_RemoveHandlers();
 
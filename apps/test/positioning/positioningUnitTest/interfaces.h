@@ -23,6 +23,8 @@ le_cfg_IteratorRef_t le_cfg_CreateReadTxn(const char *basePath);
 le_cfg_IteratorRef_t le_cfg_CreateWriteTxn(const char *basePath);
 int32_t le_cfg_GetInt(le_cfg_IteratorRef_t iteratorRef, const char *path,
                 int32_t defaultValue);
+le_result_t le_cfg_GetString(le_cfg_IteratorRef_t iteratorRef, const char *path,
+                char *value, size_t valueSize, const char *defaultValue);
 void le_cfg_SetInt(le_cfg_IteratorRef_t iteratorRef, const char *path,
                 int32_t value);
 
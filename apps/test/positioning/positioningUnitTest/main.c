@@ -692,6 +692,130 @@ static void Testle_pos_GetAcquisitionRate
     LE_ASSERT(acqRate == acquisitionRate);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of fixes read in the snapshot benchmark: one minute at 10 Hz.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SNAPSHOT_BENCHMARK_FIX_RATE     10
+#define SNAPSHOT_BENCHMARK_FIXES        (60 * SNAPSHOT_BENCHMARK_FIX_RATE)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of accessor calls needed to read a whole position sample without le_pos_sample_GetSnapshot
+ */
+//--------------------------------------------------------------------------------------------------
+#define SAMPLE_ACCESSOR_COUNT           9
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: le_pos_sample_GetSnapshot() returns the same values as the individual accessors, and
+ * compare the cost of reading a whole sample both ways.
+ *
+ * Each accessor call is one IPC request for a client, so the request counts are logged for a
+ * 10 Hz fix rate along with the time spent in the service.
+ */
+//--------------------------------------------------------------------------------------------------
+static void TestSampleSnapshot
+(
+    le_pos_SampleRef_t positionSampleRef
+)
+{
+    le_pos_SampleFieldBitMask_t validFields;
+    le_pos_FixState_t state, snapState;
+    int32_t latitude, longitude, hAccuracy, snapLatitude, snapLongitude, snapHAccuracy;
+    int32_t altitude, altitudeAccuracy, snapAltitude, snapAltitudeAccuracy;
+    uint32_t hSpeed, hSpeedAccuracy, snapHSpeed, snapHSpeedAccuracy;
+    int32_t vSpeed, vSpeedAccuracy, snapVSpeed, snapVSpeedAccuracy;
+    uint32_t heading, headingAccuracy, snapHeading, snapHeadingAccuracy;
+    uint32_t direction, directionAccuracy, snapDirection, snapDirectionAccuracy;
+    uint16_t year, month, day, snapYear, snapMonth, snapDay;
+    uint16_t hours, minutes, seconds, milliseconds;
+    uint16_t snapHours, snapMinutes, snapSeconds, snapMilliseconds;
+    le_clk_Time_t startTime;
+    le_clk_Time_t accessorsTime;
+    le_clk_Time_t snapshotTime;
+    int i;
+
+    // The heading is never set by the positioning service, so the snapshot is incomplete.
+    LE_ASSERT(LE_OUT_OF_RANGE == le_pos_sample_GetSnapshot(positionSampleRef, &validFields,
+                                        &snapState, &snapLatitude, &snapLongitude, &snapHAccuracy,
+                                        &snapAltitude, &snapAltitudeAccuracy,
+                                        &snapHSpeed, &snapHSpeedAccuracy,
+                                        &snapVSpeed, &snapVSpeedAccuracy,
+                                        &snapHeading, &snapHeadingAccuracy,
+                                        &snapDirection, &snapDirectionAccuracy,
+                                        &snapYear, &snapMonth, &snapDay,
+                                        &snapHours, &snapMinutes, &snapSeconds,
+                                        &snapMilliseconds));
+    LE_ASSERT(0 == (validFields & (LE_POS_SAMPLE_HEADING | LE_POS_SAMPLE_HEADING_ACCURACY)));
+    LE_ASSERT(validFields & LE_POS_SAMPLE_LATITUDE);
+    LE_ASSERT(validFields & LE_POS_SAMPLE_DATE);
+    LE_ASSERT(validFields & LE_POS_SAMPLE_TIME);
+
+    LE_ASSERT_OK(le_pos_sample_GetFixState(positionSampleRef, &state));
+    LE_ASSERT(state == snapState);
+    LE_ASSERT_OK(le_pos_sample_Get2DLocation(positionSampleRef, &latitude, &longitude,
+                                             &hAccuracy));
+    LE_ASSERT((latitude == snapLatitude) && (longitude == snapLongitude) &&
+              (hAccuracy == snapHAccuracy));
+    LE_ASSERT_OK(le_pos_sample_GetAltitude(positionSampleRef, &altitude, &altitudeAccuracy));
+    LE_ASSERT((altitude == snapAltitude) && (altitudeAccuracy == snapAltitudeAccuracy));
+    LE_ASSERT_OK(le_pos_sample_GetHorizontalSpeed(positionSampleRef, &hSpeed, &hSpeedAccuracy));
+    LE_ASSERT((hSpeed == snapHSpeed) && (hSpeedAccuracy == snapHSpeedAccuracy));
+    LE_ASSERT_OK(le_pos_sample_GetVerticalSpeed(positionSampleRef, &vSpeed, &vSpeedAccuracy));
+    LE_ASSERT((vSpeed == snapVSpeed) && (vSpeedAccuracy == snapVSpeedAccuracy));
+    le_pos_sample_GetHeading(positionSampleRef, &heading, &headingAccuracy);
+    LE_ASSERT((heading == snapHeading) && (headingAccuracy == snapHeadingAccuracy));
+    LE_ASSERT_OK(le_pos_sample_GetDirection(positionSampleRef, &direction, &directionAccuracy));
+    LE_ASSERT((direction == snapDirection) && (directionAccuracy == snapDirectionAccuracy));
+    LE_ASSERT_OK(le_pos_sample_GetDate(positionSampleRef, &year, &month, &day));
+    LE_ASSERT((year == snapYear) && (month == snapMonth) && (day == snapDay));
+    LE_ASSERT_OK(le_pos_sample_GetTime(positionSampleRef, &hours, &minutes, &seconds,
+                                       &milliseconds));
+    LE_ASSERT((hours == snapHours) && (minutes == snapMinutes) && (seconds == snapSeconds) &&
+              (milliseconds == snapMilliseconds));
+
+    // Benchmark: read one minute worth of 10 Hz fixes with the accessors, then with the snapshot.
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < SNAPSHOT_BENCHMARK_FIXES; i++)
+    {
+        le_pos_sample_GetFixState(positionSampleRef, &state);
+        le_pos_sample_Get2DLocation(positionSampleRef, &latitude, &longitude, &hAccuracy);
+        le_pos_sample_GetAltitude(positionSampleRef, &altitude, &altitudeAccuracy);
+        le_pos_sample_GetHorizontalSpeed(positionSampleRef, &hSpeed, &hSpeedAccuracy);
+        le_pos_sample_GetVerticalSpeed(positionSampleRef, &vSpeed, &vSpeedAccuracy);
+        le_pos_sample_GetHeading(positionSampleRef, &heading, &headingAccuracy);
+        le_pos_sample_GetDirection(positionSampleRef, &direction, &directionAccuracy);
+        le_pos_sample_GetDate(positionSampleRef, &year, &month, &day);
+        le_pos_sample_GetTime(positionSampleRef, &hours, &minutes, &seconds, &milliseconds);
+    }
+    accessorsTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    startTime = le_clk_GetRelativeTime();
+    for (i = 0; i < SNAPSHOT_BENCHMARK_FIXES; i++)
+    {
+        le_pos_sample_GetSnapshot(positionSampleRef, &validFields, &snapState,
+                                  &snapLatitude, &snapLongitude, &snapHAccuracy,
+                                  &snapAltitude, &snapAltitudeAccuracy,
+                                  &snapHSpeed, &snapHSpeedAccuracy,
+                                  &snapVSpeed, &snapVSpeedAccuracy,
+                                  &snapHeading, &snapHeadingAccuracy,
+                                  &snapDirection, &snapDirectionAccuracy,
+                                  &snapYear, &snapMonth, &snapDay,
+                                  &snapHours, &snapMinutes, &snapSeconds, &snapMilliseconds);
+    }
+    snapshotTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    LE_INFO("%d fixes at %d Hz: accessors %d requests/s in %ld.%06ld s,"
+            " snapshot %d requests/s in %ld.%06ld s",
+            SNAPSHOT_BENCHMARK_FIXES, SNAPSHOT_BENCHMARK_FIX_RATE,
+            SAMPLE_ACCESSOR_COUNT * SNAPSHOT_BENCHMARK_FIX_RATE,
+            (long)accessorsTime.sec, (long)accessorsTime.usec,
+            SNAPSHOT_BENCHMARK_FIX_RATE,
+            (long)snapshotTime.sec, (long)snapshotTime.usec);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handler function for Navigation notification.
@@ -746,6 +870,7 @@ static void NavigationHandler
     LE_ASSERT_OK(le_pos_sample_GetFixState(positionSampleRef, &state));
     LE_ASSERT(LE_OUT_OF_RANGE == (le_pos_sample_GetHeading(positionSampleRef, &heading,
                                                            &headingAccuracy)));
+    TestSampleSnapshot(positionSampleRef);
     le_pos_sample_Release(positionSampleRef);
     le_sem_Post(ThreadSemaphore);
 }
@@ -852,6 +977,332 @@ static void Testle_pos_RemoveMovementHandler
     le_thread_Cancel(NavigationThreadRef);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofence test and benchmark parameters.
+ *
+ * The benchmark geofences are 200 m circles, laid out on a 100 x 50 grid of about 1 km x 1.5 km
+ * cells around the test location, and a 10 Hz track crosses them diagonally.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FENCE_BENCHMARK_FENCES          5000
+#define FENCE_BENCHMARK_ROWS            100
+#define FENCE_BENCHMARK_RADIUS          200
+#define FENCE_BENCHMARK_FIXES           600
+#define FENCE_TRANSITION_MAX            8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofence thread, handler and geofences.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_thread_Ref_t                    FenceThreadRef;
+static le_pos_FenceTransitionHandlerRef_t FenceHandlerRef;
+static le_pos_FenceRef_t                  CircleFenceRef;
+static le_pos_FenceRef_t                  PolygonFenceRef;
+static le_pos_FenceRef_t                  BenchmarkFenceRefs[FENCE_BENCHMARK_FENCES];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofence transitions reported for the last position, and since the start of a replay.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_pos_FenceRef_t    TransitionFenceRefs[FENCE_TRANSITION_MAX];
+static le_pos_FenceEvent_t  TransitionEvents[FENCE_TRANSITION_MAX];
+static int                  TransitionCount;
+static int                  TransitionTotal;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler function for geofence transitions.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void FenceHandler
+(
+    le_pos_FenceRef_t   fenceRef,
+    le_pos_FenceEvent_t event,
+    void*               contextPtr
+)
+{
+    if (TransitionCount < FENCE_TRANSITION_MAX)
+    {
+        TransitionFenceRefs[TransitionCount] = fenceRef;
+        TransitionEvents[TransitionCount] = event;
+    }
+    TransitionCount++;
+    TransitionTotal++;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if a geofence transition was reported for the last position.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsTransitionReported
+(
+    le_pos_FenceRef_t   fenceRef,
+    le_pos_FenceEvent_t event
+)
+{
+    int i;
+
+    for (i = 0; (i < TransitionCount) && (i < FENCE_TRANSITION_MAX); i++)
+    {
+        if ((TransitionFenceRefs[i] == fenceRef) && (TransitionEvents[i] == event))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: this function posts the semaphore once the geofence thread has processed its events
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void SynchFenceThread
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    le_sem_Post(ThreadSemaphore);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Report a new position to the geofence thread and wait until it is processed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReplayFix
+(
+    int32_t latitude,
+    int32_t longitude
+)
+{
+    gnssSimuLocation_t gnssLocation;
+
+    gnssLocation.latitude = latitude;
+    gnssLocation.longitude = longitude;
+    gnssLocation.accuracy = 1000;
+    gnssLocation.result = LE_OK;
+    le_gnssSimu_SetLocation(gnssLocation);
+
+    TransitionCount = 0;
+    le_gnssSimu_ReportEvent();
+
+    // The position event is processed before the queued function
+    le_event_QueueFunctionToThread(FenceThreadRef, SynchFenceThread, NULL, NULL);
+    SynchTest();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: Create the geofences and add the geofence handler
+ *
+*/
+//--------------------------------------------------------------------------------------------------
+static void* FenceThread
+(
+    void* context
+)
+{
+    int32_t polygonLat[] = { 48830000, 48840000, 48840000, 48830000 };
+    int32_t polygonLon[] = { 2260000, 2260000, 2275000, 2275000 };
+
+    // test for invalid geofences
+    LE_ASSERT(NULL == le_pos_CreateCircleFence(90000001, 2249324, 500));
+    LE_ASSERT(NULL == le_pos_CreateCircleFence(48823091, 180000001, 500));
+    LE_ASSERT(NULL == le_pos_CreateCircleFence(48823091, 2249324, 0));
+    LE_ASSERT(NULL == le_pos_CreatePolygonFence(polygonLat, 2, polygonLon, 2));
+    LE_ASSERT(NULL == le_pos_CreatePolygonFence(polygonLat, 4, polygonLon, 3));
+
+    // test for Normal Behaviour
+    CircleFenceRef = le_pos_CreateCircleFence(48823091, 2249324, 500);
+    LE_ASSERT(NULL != CircleFenceRef);
+    PolygonFenceRef = le_pos_CreatePolygonFence(polygonLat, NUM_ARRAY_MEMBERS(polygonLat),
+                                                polygonLon, NUM_ARRAY_MEMBERS(polygonLon));
+    LE_ASSERT(NULL != PolygonFenceRef);
+
+    LE_ASSERT(NULL == le_pos_AddFenceTransitionHandler(NULL, NULL));
+    FenceHandlerRef = le_pos_AddFenceTransitionHandler(FenceHandler, NULL);
+    LE_ASSERT(NULL != FenceHandlerRef);
+
+    le_sem_Post(ThreadSemaphore);
+    le_event_RunLoop();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: this function creates or deletes the benchmark geofences
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetBenchmarkFences
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    bool create = (bool)(intptr_t)param1Ptr;
+    int i;
+
+    for (i = 0; i < FENCE_BENCHMARK_FENCES; i++)
+    {
+        if (create)
+        {
+            BenchmarkFenceRefs[i] = le_pos_CreateCircleFence(
+                                        48323091 + (i % FENCE_BENCHMARK_ROWS) * 10000,
+                                        1499324 + (i / FENCE_BENCHMARK_ROWS) * 15000,
+                                        FENCE_BENCHMARK_RADIUS);
+            LE_ASSERT(NULL != BenchmarkFenceRefs[i]);
+        }
+        else
+        {
+            le_pos_DeleteFence(BenchmarkFenceRefs[i]);
+        }
+    }
+
+    le_sem_Post(ThreadSemaphore);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replay the benchmark track.
+ *
+ * @return Time spent.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_clk_Time_t ReplayBenchmarkTrack
+(
+    void
+)
+{
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    int i;
+
+    TransitionTotal = 0;
+    for (i = 0; i < FENCE_BENCHMARK_FIXES; i++)
+    {
+        ReplayFix(48323091 + i * 1000, 1499324 + i * 1500);
+    }
+
+    return le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+}
+
+//--------------------------------------------------------------------------------------------
+/**
+ * Test: this function deletes a geofence
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteFence
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    le_pos_DeleteFence((le_pos_FenceRef_t)param1Ptr);
+    le_sem_Post(ThreadSemaphore);
+}
+
+//--------------------------------------------------------------------------------------------
+/**
+ * Test: this function removes the geofence handler
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void RemoveFenceHandler
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+{
+    le_pos_DeleteFence(CircleFenceRef);
+    le_pos_RemoveFenceTransitionHandler(FenceHandlerRef);
+    FenceHandlerRef = NULL;
+    le_sem_Post(ThreadSemaphore);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Tested API: le_pos_CreateCircleFence(), le_pos_CreatePolygonFence(), le_pos_DeleteFence(),
+ * le_pos_AddFenceTransitionHandler() and le_pos_RemoveFenceTransitionHandler()
+ *
+ * Verify that the geofence transitions are reported as expected, then measure the cost of the
+ * geofences per position, with and without FENCE_BENCHMARK_FENCES extra geofences.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_pos_Fences
+(
+    void
+)
+{
+    le_clk_Time_t baselineTime;
+    le_clk_Time_t fencesTime;
+    int baselineTotal;
+
+    FenceThreadRef = le_thread_Create("FenceThread", FenceThread, NULL);
+    le_thread_Start(FenceThreadRef);
+    SynchTest();
+
+    // Outside of the geofences
+    ReplayFix(48700000, 2249324);
+    LE_ASSERT(0 == TransitionCount);
+
+    // Into the circle
+    ReplayFix(48823091, 2249324);
+    LE_ASSERT(1 == TransitionCount);
+    LE_ASSERT(IsTransitionReported(CircleFenceRef, LE_POS_FENCE_ENTERED));
+
+    // Still inside the circle
+    ReplayFix(48823091, 2250324);
+    LE_ASSERT(0 == TransitionCount);
+
+    // From the circle into the polygon
+    ReplayFix(48835000, 2267000);
+    LE_ASSERT(2 == TransitionCount);
+    LE_ASSERT(IsTransitionReported(CircleFenceRef, LE_POS_FENCE_EXITED));
+    LE_ASSERT(IsTransitionReported(PolygonFenceRef, LE_POS_FENCE_ENTERED));
+
+    // A deleted geofence is not reported anymore
+    le_event_QueueFunctionToThread(FenceThreadRef, DeleteFence, PolygonFenceRef, NULL);
+    SynchTest();
+    ReplayFix(48700000, 2249324);
+    LE_ASSERT(0 == TransitionCount);
+
+    // Benchmark: replay the same track without and with the benchmark geofences.
+    baselineTime = ReplayBenchmarkTrack();
+    baselineTotal = TransitionTotal;
+
+    le_event_QueueFunctionToThread(FenceThreadRef, SetBenchmarkFences, (void*)true, NULL);
+    SynchTest();
+    fencesTime = ReplayBenchmarkTrack();
+    LE_ASSERT(TransitionTotal > baselineTotal);
+
+    LE_INFO("%d fixes: %ld.%06ld s with 1 geofence, %ld.%06ld s with %d geofences"
+            " (%d transitions)",
+            FENCE_BENCHMARK_FIXES,
+            (long)baselineTime.sec, (long)baselineTime.usec,
+            (long)fencesTime.sec, (long)fencesTime.usec,
+            FENCE_BENCHMARK_FENCES + 1, TransitionTotal);
+
+    le_event_QueueFunctionToThread(FenceThreadRef, SetBenchmarkFences, (void*)false, NULL);
+    SynchTest();
+
+    // Positions are not checked anymore once the handler is removed
+    le_event_QueueFunctionToThread(FenceThreadRef, RemoveFenceHandler, NULL, NULL);
+    SynchTest();
+    ReplayFix(48823091, 2249324);
+    LE_ASSERT(0 == TransitionCount);
+
+    le_thread_Cancel(FenceThreadRef);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * UnitTestInit thread: this function initializes the test and runs an eventLoop
@@ -865,6 +1316,7 @@ static void* UnitTestInit
 {
     Testle_pos_AddMovementHandler();
     Testle_pos_RemoveMovementHandler();
+    Testle_pos_Fences();
     le_sem_Post(InitSemaphore);
     le_event_RunLoop();
 }
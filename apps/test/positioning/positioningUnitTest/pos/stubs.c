@@ -70,6 +70,7 @@ typedef struct le_cfg_Iterator* le_cfg_IteratorRef_t;
  */
 //--------------------------------------------------------------------------------------------------
 static int32_t RateCount = 5000;
+static int32_t HistorySize = 0;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -87,6 +88,8 @@ static le_cfg_IteratorRef_t SimuIteratorRef;
 #define CFG_NODE_RATE               "acquisitionRate"
 #define CFG_POSITIONING_RATE_PATH   CFG_POSITIONING_PATH"/"CFG_NODE_RATE
 
+#define CFG_NODE_HISTORY_SIZE       "historySize"
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Add handler function for EVENT 'le_cfg_Change'
@@ -223,6 +226,10 @@ void le_cfgSimu_SetIntNodeValue
     {
         RateCount = value;
     }
+    else if (0 == strncmp(path, CFG_NODE_HISTORY_SIZE, strlen(CFG_NODE_HISTORY_SIZE)))
+    {
+        HistorySize = value;
+    }
     else
     {
         LE_ERROR("Unsupported path '%s'", path);
@@ -266,6 +273,10 @@ int32_t le_cfg_GetInt
     {
         value = RateCount;
     }
+    else if (0 == strncmp(path, CFG_NODE_HISTORY_SIZE, strlen(CFG_NODE_HISTORY_SIZE)))
+    {
+        value = HistorySize;
+    }
     else
     {
         value = defaultValue;
@@ -299,3 +310,37 @@ void le_cfg_SetInt
 {
    le_cfgSimu_SetIntNodeValue(iteratorRef, path, value);
 }
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a string value from the configuration tree. The default value is always returned, as no
+ *  string node is simulated.
+ */
+// -------------------------------------------------------------------------------------------------
+le_result_t le_cfg_GetString
+(
+    le_cfg_IteratorRef_t iteratorRef,
+        ///< [IN]
+        ///< Iterator to use as a basis for the transaction.
+
+    const char* path,
+        ///< [IN]
+        ///< Path to the target node. Can be an absolute path,
+        ///< or a path relative from the iterator's current
+        ///< position.
+
+    char* value,
+        ///< [OUT]
+        ///< Buffer to write the value into.
+
+    size_t valueSize,
+        ///< [IN]
+
+    const char* defaultValue
+        ///< [IN]
+        ///< Default value to use if the original can't be
+        ///<   read.
+)
+{
+    return le_utf8_Copy(value, defaultValue, valueSize, NULL);
+}
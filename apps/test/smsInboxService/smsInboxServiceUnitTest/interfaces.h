@@ -330,4 +330,15 @@ le_cfg_IteratorRef_t le_cfg_CreateReadTxn
 (
     const char* basePath    ///< [IN] Path to the location to create the new iterator.
 );
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulate the reception of a new SMS message (STUBBED FUNCTION)
+ */
+//--------------------------------------------------------------------------------------------------
+void le_smsInboxTest_SimulateRxMessage
+(
+    le_sms_MsgRef_t msgRef
+);
+
 #endif /* interfaces.h */
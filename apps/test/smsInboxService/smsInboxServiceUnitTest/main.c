@@ -17,6 +17,8 @@
 //--------------------------------------------------------------------------------------------------
 #define SIMU_MSG_PATH           " /tmp/smsInbox/msg/"
 #define SIMU_CONF_PATH          " /tmp/smsInbox/cfg/"
+#define SIMU_MSG_DIR            "/tmp/smsInbox/msg"
+#define SIMU_CONF_DIR           "/tmp/smsInbox/cfg"
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -28,6 +30,16 @@
 #define MAX_CMD_ARG             5
 #define MAX_MESSAGE_COUNT       50
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Benchmark parameters: message box size, number of received messages, and number of times the
+ * message box is listed and read.
+ */
+//--------------------------------------------------------------------------------------------------
+#define BENCH_MBOX_SIZE         100
+#define BENCH_RX_COUNT          120
+#define BENCH_ROUNDS            20
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Session Reference
@@ -431,6 +443,87 @@ static void Testle_smsInbox_GetSenderTel
 
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Test: full message box, and benchmark of the message box listing and reading.
+ *
+ * API tested:
+ * - le_smsInbox_GetFirst
+ * - le_smsInbox_GetNext
+ * - le_smsInbox_GetFormat
+ * - le_smsInbox_GetMsgLen
+ * - le_smsInbox_GetPdu
+ * - le_smsInbox_IsUnread
+ */
+//--------------------------------------------------------------------------------------------------
+static void Testle_smsInbox_Benchmark
+(
+    void
+)
+{
+    le_clk_Time_t startTime;
+    le_clk_Time_t rxTime;
+    le_clk_Time_t listTime = {0, 0};
+    le_clk_Time_t readTime = {0, 0};
+    uint32_t msgId;
+    int msgCount = 0;
+    int i;
+
+    LE_ASSERT_OK(le_smsInbox1_SetMaxMessages(BENCH_MBOX_SIZE));
+
+    // Fill the message box, the oldest messages are deleted when it is full
+    startTime = le_clk_GetRelativeTime();
+
+    for (i = 0; i < BENCH_RX_COUNT; i++)
+    {
+        le_smsInboxTest_SimulateRxMessage((le_sms_MsgRef_t) 0x10000001);
+    }
+
+    rxTime = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+    for (i = 0; i < BENCH_ROUNDS; i++)
+    {
+        startTime = le_clk_GetRelativeTime();
+
+        msgCount = 0;
+
+        for (msgId = le_smsInbox1_GetFirst(MyMbx1Ref);
+             msgId != 0;
+             msgId = le_smsInbox1_GetNext(MyMbx1Ref))
+        {
+            msgCount++;
+        }
+
+        listTime = le_clk_Add(listTime, le_clk_Sub(le_clk_GetRelativeTime(), startTime));
+
+        LE_ASSERT(msgCount == BENCH_MBOX_SIZE);
+
+        startTime = le_clk_GetRelativeTime();
+
+        for (msgId = le_smsInbox1_GetFirst(MyMbx1Ref);
+             msgId != 0;
+             msgId = le_smsInbox1_GetNext(MyMbx1Ref))
+        {
+            uint8_t pdu[LE_SMS_PDU_MAX_BYTES];
+            size_t pduLen = sizeof(pdu);
+
+            LE_ASSERT(le_smsInbox1_GetFormat(msgId) == LE_SMS_FORMAT_PDU);
+            LE_ASSERT(le_smsInbox1_GetMsgLen(msgId) != 0);
+            LE_ASSERT_OK(le_smsInbox1_GetPdu(msgId, pdu, &pduLen));
+            LE_ASSERT(le_smsInbox1_IsUnread(msgId) == false);
+        }
+
+        readTime = le_clk_Add(readTime, le_clk_Sub(le_clk_GetRelativeTime(), startTime));
+    }
+
+    LE_INFO("Received %d messages in %ld.%06ld s", BENCH_RX_COUNT,
+            (long) rxTime.sec, rxTime.usec);
+    LE_INFO("Listed %d messages %d times in %ld.%06ld s", msgCount, BENCH_ROUNDS,
+            (long) listTime.sec, listTime.usec);
+    LE_INFO("Read %d messages %d times in %ld.%06ld s", msgCount, BENCH_ROUNDS,
+            (long) readTime.sec, readTime.usec);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Simulate smsInbox config files
@@ -442,6 +535,7 @@ static void Simulate_smsInbox_cfgFileInit
 )
 {
     LE_INFO("Init Sms InBox cfg files");
+    LE_ASSERT_OK(le_dir_MakePath(SIMU_CONF_DIR, S_IRWXU));
     char cfgCpCommand[512] = "cp -rf ";
     size_t cfgFilePathLen = strlen(smsCfgFilePath);
     strncat(cfgCpCommand, smsCfgFilePath, cfgFilePathLen + 1);
@@ -460,6 +554,7 @@ static void Simulate_smsInbox_msgFileInit
 )
 {
     LE_INFO("Init Sms InBox msg files");
+    LE_ASSERT_OK(le_dir_MakePath(SIMU_MSG_DIR, S_IRWXU));
     char msgCpCommand[512]= "cp -rf ";
     size_t msgFilePathLen = strlen(smsMsgFilePath);
     strncat(msgCpCommand, smsMsgFilePath, msgFilePathLen + 1);
@@ -604,6 +699,9 @@ COMPONENT_INIT
     LE_INFO("======== smsInbox delete test ========");
     Testle_smsInbox_DeleteMsg();
 
+    LE_INFO("======== smsInbox Benchmark test ========");
+    Testle_smsInbox_Benchmark();
+
     LE_INFO("======== smsInbox Close test ========");
     Testle_smsInbox_Close();
 
@@ -30,6 +30,32 @@ static le_msg_SessionRef_t _ClientSessionRef = NULL;
 //--------------------------------------------------------------------------------------------------
 static le_event_Id_t SmsInboxRxEventId = NULL;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * New SMS message handler registered by the smsInbox service, and its context.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sms_RxMessageHandlerFunc_t RxMessageHandlerPtr = NULL;
+static void* RxMessageContextPtr = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Simulate the reception of a new SMS message. The smsInbox service handler is called directly,
+ * so that the message is stored when this function returns.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_smsInboxTest_SimulateRxMessage
+(
+    le_sms_MsgRef_t msgRef
+)
+{
+    if (RxMessageHandlerPtr)
+    {
+        RxMessageHandlerPtr(msgRef, RxMessageContextPtr);
+    }
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the server service reference
@@ -508,6 +534,9 @@ le_sms_RxMessageHandlerRef_t le_sms_AddRxMessageHandler
 
     le_event_SetContextPtr(handlerRef, contextPtr);
 
+    RxMessageHandlerPtr = handlerPtr;
+    RxMessageContextPtr = contextPtr;
+
     return (le_sms_RxMessageHandlerRef_t)(handlerRef);
 }
 
@@ -29,6 +29,7 @@
 
 #include "tinycbor/cbor.h"
 #include "zlib.h"
+#include "timeSeriesSpool.h"
 
 #endif
 
@@ -66,6 +67,24 @@
 #define MAX_CBOR_BUFFER_NUMBYTES 1024
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * The fields of an instance are indexed by field id in an array, unless their ids are too sparse:
+ * the array can have up to FIELD_ARRAY_DENSITY entries per field, plus FIELD_ARRAY_SLACK entries.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FIELD_ARRAY_DENSITY 4
+#define FIELD_ARRAY_SLACK 16
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the InstanceMap
+ */
+//--------------------------------------------------------------------------------------------------
+#define INSTANCE_MAP_SIZE 257
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Checks the return value from the tinyCBOR encoder and returns from function if an error is found.
@@ -138,6 +157,19 @@ typedef struct assetData_AssetData
 AssetData_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Key of an asset instance in the InstanceMap
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    AssetData_t* assetDataPtr;   ///< Asset data containing the instance
+    int instanceId;              ///< Id of the instance
+}
+InstanceKey_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Data contained in a single asset instance
@@ -149,6 +181,12 @@ typedef struct le_avdata_AssetInstance
     AssetData_t* assetDataPtr;   ///< Back reference to asset data containing this instance
     le_dls_List_t fieldList;     ///< List of fields for this instance
     le_dls_Link_t link;          ///< For adding to the asset instance list
+    InstanceKey_t mapKey;        ///< Key in the InstanceMap
+    struct FieldData** fieldArray;      ///< Fields indexed by field id, or NULL if the field ids
+                                        ///  are too sparse (see BuildFieldIndex())
+    int fieldArraySize;                 ///< Number of entries in fieldArray
+    struct FieldData** fieldNameArray;  ///< Fields sorted by name
+    int fieldCount;                     ///< Number of fields
 }
 InstanceData_t;
 
@@ -190,7 +228,7 @@ TimeSeriesData_t;
  * Data contained in a single field of an asset instance
  */
 //--------------------------------------------------------------------------------------------------
-typedef struct
+typedef struct FieldData
 {
     int fieldId;
     char name[100];
@@ -323,6 +361,23 @@ static le_hashmap_Ref_t AssetMap = NULL;
 static le_hashmap_Ref_t AssetMapByName = NULL;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Asset data block last found by GetAssetData(), so that repeated accesses to the same asset do not
+ * have to format and hash the (appName, assetId) key.
+ */
+//--------------------------------------------------------------------------------------------------
+static AssetData_t* LastAssetDataPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maps (asset data block, instanceId) to an InstanceData block.  Initialized in assetData_Init().
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t InstanceMap = NULL;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Used to delay reporting REG_UPDATE, so that we don't generate too much message traffic.
@@ -902,6 +957,14 @@ static le_result_t GetAssetData
 {
     char key[100];
 
+    if ( ( LastAssetDataPtr != NULL ) &&
+         ( LastAssetDataPtr->assetId == assetId ) &&
+         ( strcmp(LastAssetDataPtr->appName, appNamePtr) == 0 ) )
+    {
+        *assetDataPtrPtr = LastAssetDataPtr;
+        return LE_OK;
+    }
+
     if ( FormatString(key, sizeof(key), "%s/%i", appNamePtr, assetId) != LE_OK )
     {
         return LE_FAULT;
@@ -911,6 +974,7 @@ static le_result_t GetAssetData
 
     if ( *assetDataPtrPtr != NULL )
     {
+        LastAssetDataPtr = *assetDataPtrPtr;
         return LE_OK;
     }
     else
@@ -1105,6 +1169,172 @@ static le_result_t CreateAssetDataFromModelByName
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hash function for the InstanceMap keys
+ */
+//--------------------------------------------------------------------------------------------------
+static size_t HashInstanceKey
+(
+    const void* keyPtr
+)
+{
+    const InstanceKey_t* instanceKeyPtr = keyPtr;
+
+    return ( (size_t)instanceKeyPtr->assetDataPtr / sizeof(void*) ) * 31 +
+           (size_t)instanceKeyPtr->instanceId;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Equality function for the InstanceMap keys
+ */
+//--------------------------------------------------------------------------------------------------
+static bool EqualsInstanceKey
+(
+    const void* firstKeyPtr,
+    const void* secondKeyPtr
+)
+{
+    const InstanceKey_t* firstInstanceKeyPtr = firstKeyPtr;
+    const InstanceKey_t* secondInstanceKeyPtr = secondKeyPtr;
+
+    return ( firstInstanceKeyPtr->assetDataPtr == secondInstanceKeyPtr->assetDataPtr ) &&
+           ( firstInstanceKeyPtr->instanceId == secondInstanceKeyPtr->instanceId );
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare two fields by name, for sorting the fields of an instance
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareFieldNames
+(
+    const void* firstPtr,
+    const void* secondPtr
+)
+{
+    const FieldData_t* firstFieldPtr = *(FieldData_t* const*)firstPtr;
+    const FieldData_t* secondFieldPtr = *(FieldData_t* const*)secondPtr;
+    int result = strcmp(firstFieldPtr->name, secondFieldPtr->name);
+
+    if ( result == 0 )
+    {
+        result = ( firstFieldPtr->fieldId > secondFieldPtr->fieldId ) -
+                 ( firstFieldPtr->fieldId < secondFieldPtr->fieldId );
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compare a field name with a field, for searching the fields of an instance
+ */
+//--------------------------------------------------------------------------------------------------
+static int CompareFieldName
+(
+    const void* namePtr,
+    const void* fieldPtr
+)
+{
+    return strcmp(namePtr, (*(FieldData_t* const*)fieldPtr)->name);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Build the field indexes of an instance, once all its fields have been added to the field list.
+ *
+ * The fields are indexed by id in an array, unless the ids are negative or too sparse, and by name
+ * in a sorted array.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NO_MEMORY if the indexes could not be allocated
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t BuildFieldIndex
+(
+    InstanceData_t* assetInstPtr        ///< [IN]
+)
+{
+    FieldData_t* fieldDataPtr;
+    le_dls_Link_t* linkPtr;
+    int minFieldId = 0;
+    int maxFieldId = -1;
+    int i;
+
+    assetInstPtr->fieldArray = NULL;
+    assetInstPtr->fieldArraySize = 0;
+    assetInstPtr->fieldCount = le_dls_NumLinks(&assetInstPtr->fieldList);
+    assetInstPtr->fieldNameArray = calloc(assetInstPtr->fieldCount + 1, sizeof(FieldData_t*));
+    if ( assetInstPtr->fieldNameArray == NULL )
+    {
+        return LE_NO_MEMORY;
+    }
+
+    i = 0;
+    linkPtr = le_dls_Peek(&assetInstPtr->fieldList);
+    while ( linkPtr != NULL )
+    {
+        fieldDataPtr = CONTAINER_OF(linkPtr, FieldData_t, link);
+        assetInstPtr->fieldNameArray[i++] = fieldDataPtr;
+
+        if ( fieldDataPtr->fieldId < minFieldId )
+        {
+            minFieldId = fieldDataPtr->fieldId;
+        }
+        if ( fieldDataPtr->fieldId > maxFieldId )
+        {
+            maxFieldId = fieldDataPtr->fieldId;
+        }
+
+        linkPtr = le_dls_PeekNext(&assetInstPtr->fieldList, linkPtr);
+    }
+
+    qsort(assetInstPtr->fieldNameArray, assetInstPtr->fieldCount, sizeof(FieldData_t*),
+          CompareFieldNames);
+
+    // Without an array, the fields are found by id in the field list.
+    if ( ( minFieldId < 0 ) ||
+         ( maxFieldId >= assetInstPtr->fieldCount * FIELD_ARRAY_DENSITY + FIELD_ARRAY_SLACK ) )
+    {
+        LE_DEBUG("Field ids of %s/%i are too sparse to be indexed",
+                 assetInstPtr->assetDataPtr->appName, assetInstPtr->assetDataPtr->assetId);
+        return LE_OK;
+    }
+
+    assetInstPtr->fieldArraySize = maxFieldId + 1;
+    assetInstPtr->fieldArray = calloc(assetInstPtr->fieldArraySize + 1, sizeof(FieldData_t*));
+    if ( assetInstPtr->fieldArray == NULL )
+    {
+        free(assetInstPtr->fieldNameArray);
+        assetInstPtr->fieldNameArray = NULL;
+        return LE_NO_MEMORY;
+    }
+
+    linkPtr = le_dls_Peek(&assetInstPtr->fieldList);
+    while ( linkPtr != NULL )
+    {
+        fieldDataPtr = CONTAINER_OF(linkPtr, FieldData_t, link);
+
+        // With duplicate field ids, keep the first field of the list, as a list search would.
+        if ( assetInstPtr->fieldArray[fieldDataPtr->fieldId] == NULL )
+        {
+            assetInstPtr->fieldArray[fieldDataPtr->fieldId] = fieldDataPtr;
+        }
+
+        linkPtr = le_dls_PeekNext(&assetInstPtr->fieldList, linkPtr);
+    }
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the specified instance from the given asset data block
@@ -1121,25 +1351,15 @@ static le_result_t GetInstanceFromAssetData
     InstanceData_t** instanceDataPtrPtr   ///< [OUT]
 )
 {
+    InstanceKey_t key = { .assetDataPtr = assetDataPtr, .instanceId = instanceId };
     InstanceData_t* assetInstancePtr;
-    le_dls_Link_t* linkPtr;
 
-    // Get the start of the instance list
-    linkPtr = le_dls_Peek(&assetDataPtr->instanceList);
+    assetInstancePtr = le_hashmap_Get(InstanceMap, &key);
 
-    // Loop through the asset instances
-    while ( linkPtr != NULL )
+    if ( assetInstancePtr != NULL )
     {
-        assetInstancePtr = CONTAINER_OF(linkPtr, InstanceData_t, link);
-        //LE_PRINT_VALUE("%i", assetInstancePtr->instanceId);
-
-        if ( assetInstancePtr->instanceId == instanceId )
-        {
-            *instanceDataPtrPtr = assetInstancePtr;
-            return LE_OK;
-        }
-
-        linkPtr = le_dls_PeekNext(&assetDataPtr->instanceList, linkPtr);
+        *instanceDataPtrPtr = assetInstancePtr;
+        return LE_OK;
     }
 
     return LE_NOT_FOUND;
@@ -1165,6 +1385,19 @@ static le_result_t GetFieldFromInstance
     FieldData_t* fieldDataPtr;
     le_dls_Link_t* fieldLinkPtr;
 
+    // Use the field index, if the field ids are not too sparse
+    if ( instanceDataPtr->fieldArray != NULL )
+    {
+        if ( ( fieldId < 0 ) || ( fieldId >= instanceDataPtr->fieldArraySize ) ||
+             ( instanceDataPtr->fieldArray[fieldId] == NULL ) )
+        {
+            return LE_NOT_FOUND;
+        }
+
+        *fieldDataPtrPtr = instanceDataPtr->fieldArray[fieldId];
+        return LE_OK;
+    }
+
     // Get the start of the field list
     fieldLinkPtr = le_dls_Peek(&instanceDataPtr->fieldList);
 
@@ -1231,8 +1464,7 @@ static le_result_t GetInstance
 }
 
 
-#if 0
-// todo: Is this needed?
+#ifdef LEGATO_FEATURE_TIMESERIES
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the specified field from the AssetMap
@@ -1464,15 +1696,232 @@ static le_result_t StopTimeSeries
 }
 
 
+#ifdef LEGATO_FEATURE_TIMESERIES
 //--------------------------------------------------------------------------------------------------
 /**
- * Compress the accumulated CBOR encoded time series data and send it to server.
+ * Close the CBOR stream of a time series and compress it.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT on any error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CompressTimeSeries
+(
+    TimeSeriesData_t* timeSeriesPtr,            ///< [IN] Time series to close
+    uint8_t* bufPtr,                            ///< [OUT] Compressed data
+    size_t* bufNumBytesPtr                      ///< [IN/OUT] Buffer size; compressed data size
+)
+{
+    CborError err;
+    size_t cborStreamSize;
+    z_stream defstream;
+    int zResult;
+
+    // Close the map i.e done with entering in to sample array.
+    err = cbor_encoder_close_container_checked(&timeSeriesPtr->mapRef,
+                                               &timeSeriesPtr->sampleRef);
+    RETURN_IF_CBOR_ERROR(err);
+
+    // Close the stream.
+    err = cbor_encoder_close_container_checked(&timeSeriesPtr->streamRef,
+                                               &timeSeriesPtr->mapRef);
+    RETURN_IF_CBOR_ERROR(err);
+
+    // Dump CBOR encoded data.
+    cborStreamSize = cbor_encoder_get_buffer_size(&timeSeriesPtr->mapRef,
+                                                  timeSeriesPtr->bufferPtr);
+
+    //LE_DEBUG("cborStreamSize = %zd", cborStreamSize);
+    //LE_DUMP(timeSeriesPtr->bufferPtr, cborStreamSize);
+
+    // Compress the cbor encoded data
+    // ToDo: In place compression
+    defstream.zalloc = Z_NULL;
+    defstream.zfree = Z_NULL;
+    defstream.opaque = Z_NULL;
+
+    defstream.avail_in = cborStreamSize;
+    defstream.next_in = (Bytef *)timeSeriesPtr->bufferPtr;
+    defstream.avail_out = (uInt)*bufNumBytesPtr;
+    defstream.next_out = (Bytef *)bufPtr;
+
+    if (deflateInit(&defstream, Z_BEST_COMPRESSION) != Z_OK)
+    {
+        LE_ERROR("Failed to initialize time series compression.");
+        return LE_FAULT;
+    }
+    zResult = deflate(&defstream, Z_FINISH);
+    deflateEnd(&defstream);
+
+    if (zResult != Z_STREAM_END)
+    {
+        LE_ERROR("Failed to compress time series (%d).", zResult);
+        return LE_FAULT;
+    }
+
+    *bufNumBytesPtr = defstream.total_out;
+
+    //LE_DEBUG("Compressed size is: %zd\n", *bufNumBytesPtr);
+    //LE_DUMP(bufPtr, *bufNumBytesPtr);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a compressed time series to the server, as a notification of its observed field.
+ */
+//--------------------------------------------------------------------------------------------------
+static void NotifyTimeSeries
+(
+    const char* appNamePtr,                     ///< [IN] App containing the asset
+    int assetId,                                ///< [IN] Asset id
+    FieldData_t* fieldDataPtr,                  ///< [IN] Field of the time series
+    uint8_t* dataPtr,                           ///< [IN] Compressed time series
+    size_t dataNumBytes                         ///< [IN] Number of bytes of compressed data
+)
+{
+    pa_avc_LWM2MOperationDataRef_t opRef;
+
+    // Send the delta encoded + CBOR encoded + Zipped data to the server.
+    opRef = pa_avc_CreateOpData((char*)appNamePtr,
+                                assetId,
+                                -1,
+                                -1,
+                                PA_AVC_OPTYPE_NOTIFY,
+                                SIERRA_CBOR_ENCODING,
+                                fieldDataPtr->token,
+                                fieldDataPtr->tokenLength);
+
+    pa_avc_NotifyChange(opRef, dataPtr, dataNumBytes);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send handler of the time series spool: send a spooled time series if its field is observed.
+ *
+ * @return true if the time series was sent.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool SendSpooledTimeSeries
+(
+    const char* appNamePtr,                     ///< [IN] App containing the asset
+    int assetId,                                ///< [IN] Asset id
+    int instanceId,                             ///< [IN] Asset instance id
+    int fieldId,                                ///< [IN] Field of the time series
+    uint8_t* dataPtr,                           ///< [IN] Compressed time series
+    size_t dataNumBytes                         ///< [IN] Number of bytes of compressed data
+)
+{
+    FieldData_t* fieldDataPtr;
+
+    // The asset instance may not be created yet by its app, or not observed yet by the server.
+    if ( (GetField(appNamePtr, assetId, instanceId, fieldId, &fieldDataPtr) != LE_OK) ||
+         (!fieldDataPtr->isObserve) )
+    {
+        return false;
+    }
+
+    NotifyTimeSeries(appNamePtr, assetId, fieldDataPtr, dataPtr, dataNumBytes);
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send the spooled time series of the observed fields, if the session is open.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendTimeSeriesSpool
+(
+    void
+)
+{
+    if ( (CurrentAvSessionStatus == ASSET_DATA_SESSION_AVAILABLE) &&
+         (timeSeriesSpool_GetCount() > 0) )
+    {
+        timeSeriesSpool_Send(SendSpooledTimeSeries);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Move the full time series of a field to the spool, and restart it.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNAVAILABLE if the spool is disabled; the time series is unchanged
+ *      - LE_FAULT if the time series could not be spooled and was lost
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SpoolTimeSeries
+(
+    InstanceData_t* instanceDataPtr,            ///< [IN] Asset instance of the field
+    FieldData_t* fieldDataPtr                   ///< [IN] Field of the time series
+)
+{
+    le_result_t result;
+    uint8_t compressedBuf[TIME_SERIES_SPOOL_MAX_DATA_NUMBYTES];
+    size_t compressedNumBytes = sizeof(compressedBuf);
+    double dataFactor = fieldDataPtr->timeSeriesPtr->factor;
+    double timeStampFactor = fieldDataPtr->timeSeriesPtr->timeStampFactor;
+
+    if (!timeSeriesSpool_IsEnabled())
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    result = CompressTimeSeries(fieldDataPtr->timeSeriesPtr, compressedBuf, &compressedNumBytes);
+    if (result == LE_OK)
+    {
+        result = timeSeriesSpool_Add(instanceDataPtr->assetDataPtr->appName,
+                                     instanceDataPtr->assetDataPtr->assetId,
+                                     instanceDataPtr->instanceId,
+                                     fieldDataPtr->fieldId,
+                                     compressedBuf,
+                                     compressedNumBytes);
+    }
+
+    if (result != LE_OK)
+    {
+        LE_ERROR("Failed to spool time series of field %d; %d data points lost.",
+                 fieldDataPtr->fieldId,
+                 fieldDataPtr->timeSeriesPtr->numElements);
+    }
+    else
+    {
+        LE_DEBUG("Time series of field %d spooled.", fieldDataPtr->fieldId);
+    }
+
+    // The CBOR stream is closed, so restart the time series even if it could not be spooled.
+    StopTimeSeries(instanceDataPtr, fieldDataPtr->fieldId);
+
+    if (StartTimeSeries(instanceDataPtr, fieldDataPtr->fieldId, dataFactor, timeStampFactor)
+        != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    return (result == LE_OK) ? LE_OK : LE_FAULT;
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compress the accumulated CBOR encoded time series data and send it to server. While the session
+ * is not open, the compressed data is kept in the time series spool, to be sent when the session
+ * is opened and the field is observed.
  *
  * @return:
  *      - LE_OK on success
  *      - LE_NOT_FOUND if field not found
  *      - LE_CLOSED if time series not enabled on this field
- *      - LE_UNAVAILABLE if observe is not enabled on this field
+ *      - LE_UNAVAILABLE if observe is not enabled on this field, and the data can't be spooled
  *      - LE_FAULT if any other error
  */
 //--------------------------------------------------------------------------------------------------
@@ -1488,12 +1937,9 @@ static le_result_t PushTimeSeries
 
     le_result_t result;
     FieldData_t* fieldDataPtr;
-    uint32_t cborStreamSize;
-    unsigned char compressedBuf[MAX_CBOR_BUFFER_NUMBYTES];
-    unsigned long int compressBufLength;
-    z_stream defstream;
-    pa_avc_LWM2MOperationDataRef_t opRef;
-    CborError err;
+    uint8_t compressedBuf[TIME_SERIES_SPOOL_MAX_DATA_NUMBYTES];
+    size_t compressBufLength = sizeof(compressedBuf);
+    bool isSpooled;
 
     double dataFactor;
     double timeStampFactor;
@@ -1511,66 +1957,50 @@ static le_result_t PushTimeSeries
         return LE_CLOSED;
     }
 
-    // Check if observe is enabled on this field.
-    if (!fieldDataPtr->isObserve)
-    {
-        LE_ERROR("Observe not enabled on this field.");
-        return LE_UNAVAILABLE;
-    }
-
-    // Remember the factors used.
-    dataFactor = fieldDataPtr->timeSeriesPtr->factor;
-    timeStampFactor = fieldDataPtr->timeSeriesPtr->timeStampFactor;
-
-    // Close the map i.e done with entering in to sample array.
-    err = cbor_encoder_close_container_checked(&fieldDataPtr->timeSeriesPtr->mapRef,
-                                               &fieldDataPtr->timeSeriesPtr->sampleRef);
-
-    RETURN_IF_CBOR_ERROR(err);
-
-    // Close the stream.
-    err = cbor_encoder_close_container_checked(&fieldDataPtr->timeSeriesPtr->streamRef,
-                                               &fieldDataPtr->timeSeriesPtr->mapRef);
-    RETURN_IF_CBOR_ERROR(err);
-
-    // Dump CBOR encoded data.
-    cborStreamSize = cbor_encoder_get_buffer_size(&fieldDataPtr->timeSeriesPtr->mapRef,
-                                                  fieldDataPtr->timeSeriesPtr->bufferPtr);
-
-    //LE_DEBUG("cborStreamSize = %d", cborStreamSize);
-    //LE_DUMP(fieldDataPtr->timeSeriesPtr->bufferPtr, cborStreamSize);
-
-    // Compress the cbor encoded data
-    // ToDo: In place compression
-    defstream.zalloc = Z_NULL;
-    defstream.zfree = Z_NULL;
-    defstream.opaque = Z_NULL;
+    isSpooled = (CurrentAvSessionStatus != ASSET_DATA_SESSION_AVAILABLE) &&
+                timeSeriesSpool_IsEnabled();
 
-    defstream.avail_in = cborStreamSize;
-    defstream.next_in = (Bytef *)fieldDataPtr->timeSeriesPtr->bufferPtr;
-    defstream.avail_out = (uInt)sizeof(compressedBuf);
-    defstream.next_out = (Bytef *)compressedBuf;
-
-    deflateInit(&defstream, Z_BEST_COMPRESSION);
-    deflate(&defstream, Z_FINISH);
-    deflateEnd(&defstream);
-
-    compressBufLength = defstream.total_out;
+    // Check if observe is enabled on this field, unless the data is spooled.
+    if (!isSpooled && !fieldDataPtr->isObserve)
+    {
+        LE_ERROR("Observe not enabled on this field.");
+        return LE_UNAVAILABLE;
+    }
 
-    //LE_DEBUG("Compressed size is: %lu\n", compressBufLength);
-    //LE_DUMP(compressedBuf, compressBufLength);
+    // Remember the factors used.
+    dataFactor = fieldDataPtr->timeSeriesPtr->factor;
+    timeStampFactor = fieldDataPtr->timeSeriesPtr->timeStampFactor;
 
-    // Send the delta encoded + CBOR encoded + Zipped data to the server.
-    opRef = pa_avc_CreateOpData(instanceRef->assetDataPtr->appName,
-                                instanceRef->assetDataPtr->assetId,
-                                -1,
-                                -1,
-                                PA_AVC_OPTYPE_NOTIFY,
-                                SIERRA_CBOR_ENCODING,
-                                fieldDataPtr->token,
-                                fieldDataPtr->tokenLength);
+    result = CompressTimeSeries(fieldDataPtr->timeSeriesPtr, compressedBuf, &compressBufLength);
+    if (result != LE_OK)
+    {
+        return result;
+    }
 
-    pa_avc_NotifyChange(opRef, compressedBuf, compressBufLength);
+    if (isSpooled)
+    {
+        result = timeSeriesSpool_Add(instanceRef->assetDataPtr->appName,
+                                     instanceRef->assetDataPtr->assetId,
+                                     instanceRef->instanceId,
+                                     fieldId,
+                                     compressedBuf,
+                                     compressBufLength);
+        if (result != LE_OK)
+        {
+            LE_ERROR("Failed to spool time series of field %d.", fieldId);
+            return LE_FAULT;
+        }
+    }
+    else
+    {
+        // Spooled data is older, send it first.
+        SendTimeSeriesSpool();
+        NotifyTimeSeries(instanceRef->assetDataPtr->appName,
+                         instanceRef->assetDataPtr->assetId,
+                         fieldDataPtr,
+                         compressedBuf,
+                         compressBufLength);
+    }
 
     // Stop time series.
     result = StopTimeSeries(instanceRef, fieldId);
@@ -1644,7 +2074,8 @@ le_result_t GetTimeSeriesStatus
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add the sampled data in to the CBOR sample array.
+ * Add the sampled data in to the CBOR sample array. If the time series buffer is full, it is moved
+ * to the time series spool and the time series is restarted before adding the sampled data.
  *
  * @return:
  *      - LE_OK on success
@@ -1655,6 +2086,7 @@ le_result_t GetTimeSeriesStatus
 //--------------------------------------------------------------------------------------------------
 static le_result_t TimeSeriesAddEntry
 (
+    InstanceData_t* instanceDataPtr,
     FieldData_t* fieldDataPtr,
     uint64_t utcMilliSec
 )
@@ -1677,10 +2109,19 @@ static le_result_t TimeSeriesAddEntry
 
     if (currentSize > (fieldDataPtr->timeSeriesPtr->bufferSize - CBOR_RESERVED_BYTES))
     {
-        LE_WARN("Time series buffer overflow on field %d.", fieldDataPtr->fieldId);
-        LE_DEBUG("currentSize = %zd.", currentSize);
+        if (SpoolTimeSeries(instanceDataPtr, fieldDataPtr) == LE_UNAVAILABLE)
+        {
+            LE_WARN("Time series buffer overflow on field %d.", fieldDataPtr->fieldId);
+            LE_DEBUG("currentSize = %zd.", currentSize);
 
-        return LE_OVERFLOW;
+            return LE_OVERFLOW;
+        }
+
+        // The time series was restarted, even if it could not be spooled.
+        if (fieldDataPtr->timeSeriesPtr == NULL)
+        {
+            return LE_FAULT;
+        }
     }
 
     // Get current system time if utc milli seconds is not provided.
@@ -2200,7 +2641,7 @@ static le_result_t SetInt
     // not enabled send the observe notification right away.
     if (fieldDataPtr->timeSeriesPtr != NULL)
     {
-        return TimeSeriesAddEntry(fieldDataPtr, utcMilliSec);
+        return TimeSeriesAddEntry(instanceRef, fieldDataPtr, utcMilliSec);
     }
 
     // Notify the server if observe is enabled and the value is changed.
@@ -2314,7 +2755,7 @@ static le_result_t SetFloat
     // not enabled send the observe notification right away.
     if (fieldDataPtr->timeSeriesPtr != NULL)
     {
-        return TimeSeriesAddEntry(fieldDataPtr, utcMilliSec);
+        return TimeSeriesAddEntry(instanceRef, fieldDataPtr, utcMilliSec);
     }
 
     // Notify the server if observe is enabled and the value is changed.
@@ -2357,6 +2798,96 @@ static le_result_t SetFloat
     return LE_OK;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a batch of samples of an integer or float field in its time series. The field is set to
+ * each sample in turn, and its write handlers are called once for the batch.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if field not found
+ *      - LE_CLOSED if time series not enabled on this field
+ *      - LE_OVERFLOW if a sample was NOT added as the time series buffer is full; the samples
+ *                    before it were added.
+ *      - LE_NO_MEMORY if the samples were added but there is no space for next one.
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t RecordBatch
+(
+    assetData_InstanceDataRef_t instanceRef,    ///< [IN] Asset instance to use
+    int fieldId,                                ///< [IN] Field to write
+    DataTypes_t type,                           ///< [IN] DATA_TYPE_INT or DATA_TYPE_FLOAT
+    const uint64_t* timeStampsPtr,              ///< [IN] Timestamps in utc milli seconds
+    const int32_t* intValuesPtr,                ///< [IN] Values, if type is DATA_TYPE_INT
+    const double* floatValuesPtr,               ///< [IN] Values, if type is DATA_TYPE_FLOAT
+    size_t numSamples,                          ///< [IN] Number of samples
+    size_t* numRecordedPtr                      ///< [OUT] Number of samples added
+)
+{
+#ifdef LEGATO_FEATURE_TIMESERIES
+
+    le_result_t result;
+    FieldData_t* fieldDataPtr;
+    size_t i;
+
+    *numRecordedPtr = 0;
+
+    result = GetFieldFromInstance(instanceRef, fieldId, &fieldDataPtr);
+    if ( result != LE_OK )
+    {
+        return result;
+    }
+
+    if ( fieldDataPtr->type != type )
+    {
+        LE_ERROR("Field type mismatch: expected '%s', got '%s'",
+                 GetDataTypeStr(type),
+                 GetDataTypeStr(fieldDataPtr->type));
+        return LE_FAULT;
+    }
+
+    if (fieldDataPtr->timeSeriesPtr == NULL)
+    {
+        LE_ERROR("Time series not enabled on this field.");
+        return LE_CLOSED;
+    }
+
+    for (i = 0; i < numSamples; i++)
+    {
+        if (type == DATA_TYPE_INT)
+        {
+            fieldDataPtr->intValue = intValuesPtr[i];
+        }
+        else
+        {
+            fieldDataPtr->floatValue = floatValuesPtr[i];
+        }
+
+        // A full time series buffer is spooled by the next entry.
+        result = TimeSeriesAddEntry(instanceRef, fieldDataPtr, timeStampsPtr[i]);
+        if ( (result != LE_OK) && (result != LE_NO_MEMORY) )
+        {
+            break;
+        }
+
+        (*numRecordedPtr)++;
+    }
+
+    // Call any registered handlers to be notified of write.
+    if (*numRecordedPtr > 0)
+    {
+        CallFieldActionHandlers(instanceRef, fieldId, ASSET_DATA_ACTION_WRITE, true);
+    }
+
+    return result;
+
+#else
+    LE_ERROR("Time series not supported.");
+    return LE_FAULT;
+#endif
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the bool value for the specified field
@@ -2469,7 +3000,7 @@ static le_result_t SetBool
     // not enabled send the observe notification right away.
     if (fieldDataPtr->timeSeriesPtr != NULL)
     {
-        return TimeSeriesAddEntry(fieldDataPtr, utcMilliSec);
+        return TimeSeriesAddEntry(instanceRef, fieldDataPtr, utcMilliSec);
     }
 
     // Notify the server if observe is enabled and the value is changed.
@@ -2627,7 +3158,7 @@ static le_result_t SetString
     // not enabled send the observe notification right away.
     if (fieldDataPtr->timeSeriesPtr != NULL)
     {
-        return TimeSeriesAddEntry(fieldDataPtr, utcMilliSec);
+        return TimeSeriesAddEntry(instanceRef, fieldDataPtr, utcMilliSec);
     }
 
     // Notify the server if observe is enabled and the value is changed.
@@ -2871,6 +3402,10 @@ void assetData_SessionStatus
     {
         le_timer_Restart(RegUpdateTimerRef);
     }
+
+#ifdef LEGATO_FEATURE_TIMESERIES
+    SendTimeSeriesSpool();
+#endif
 }
 
 
@@ -2954,6 +3489,56 @@ void assetData_RegUpdateIfNotObserved
 //--------------------------------------------------------------------------------------------------
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release the fields of an asset instance
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseFields
+(
+    InstanceData_t* assetInstPtr        ///< [IN]
+)
+{
+    FieldData_t* fieldDataPtr;
+    le_dls_Link_t* linkPtr;
+
+    // Pop the first field from field list
+    linkPtr = le_dls_Pop(&assetInstPtr->fieldList);
+
+    // Loop through the fields, and release each field.
+    while ( linkPtr != NULL )
+    {
+        fieldDataPtr = CONTAINER_OF(linkPtr, FieldData_t, link);
+
+        // Some field types have allocated data, so release that first
+        switch ( fieldDataPtr->type )
+        {
+            case DATA_TYPE_STRING:
+                LE_DEBUG("Deleting string value for field %s", fieldDataPtr->name);
+                le_mem_Release(fieldDataPtr->strValuePtr);
+                break;
+
+            default:
+                break;
+        }
+
+        // Release Time Series resources.
+        if (fieldDataPtr->timeSeriesPtr != NULL)
+        {
+            LE_DEBUG("Releasing time series resources of %s", fieldDataPtr->name);
+            le_mem_Release(fieldDataPtr->timeSeriesPtr->bufferPtr);
+            le_mem_Release(fieldDataPtr->timeSeriesPtr);
+        }
+
+        // Release the field.
+        LE_DEBUG("Deleting field %s", fieldDataPtr->name);
+        le_mem_Release(fieldDataPtr);
+
+        linkPtr = le_dls_Pop(&assetInstPtr->fieldList);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Create a new instance of the given asset. This function will schedule a registration update after
@@ -3041,6 +3626,18 @@ le_result_t assetData_CreateInstanceById
         }
     }
 
+    // Add back reference from instance data to the asset containing the instance
+    assetInstPtr->assetDataPtr = assetDataPtr;
+
+    // Index the fields by id and by name
+    if ( BuildFieldIndex(assetInstPtr) != LE_OK )
+    {
+        LE_ERROR("Error in indexing fields");
+        ReleaseFields(assetInstPtr);
+        le_mem_Release(assetInstPtr);
+        return LE_FAULT;
+    }
+
     // Everything is okay, so finish initializing the instance data, and store it
 
     // If the instanceId is explicitly given, use it; we already know it is not a duplicate.
@@ -3060,12 +3657,12 @@ le_result_t assetData_CreateInstanceById
         assetInstPtr->instanceId = ++assetDataPtr->lastInstanceId;
     }
 
-    // Add back reference from instance data to the asset containing the instance
-    assetInstPtr->assetDataPtr = assetDataPtr;
-
-
     le_dls_Queue(&assetDataPtr->instanceList, &assetInstPtr->link);
 
+    assetInstPtr->mapKey.assetDataPtr = assetDataPtr;
+    assetInstPtr->mapKey.instanceId = assetInstPtr->instanceId;
+    le_hashmap_Put(InstanceMap, &assetInstPtr->mapKey, assetInstPtr);
+
     // todo: For now, for testing, print it out; add trace support later.
     if ( 0 )
         PrintAssetMap();
@@ -3164,46 +3761,15 @@ void assetData_DeleteInstance
                             instanceRef->instanceId,
                             ASSET_DATA_ACTION_DELETE);
 
-    FieldData_t* fieldDataPtr;
-    le_dls_Link_t* linkPtr;
-
-    // Pop the first field from field list
-    linkPtr = le_dls_Pop(&instanceRef->fieldList);
-
-    // Loop through the fields, and release each field.
-    while ( linkPtr != NULL )
-    {
-        fieldDataPtr = CONTAINER_OF(linkPtr, FieldData_t, link);
-
-        // Some field types have allocated data, so release that first
-        switch ( fieldDataPtr->type )
-        {
-            case DATA_TYPE_STRING:
-                LE_DEBUG("Deleting string value for field %s", fieldDataPtr->name);
-                le_mem_Release(fieldDataPtr->strValuePtr);
-                break;
-
-            default:
-                break;
-        }
-
-        // Release Time Series resources.
-        if (fieldDataPtr->timeSeriesPtr != NULL)
-        {
-            LE_DEBUG("Releasing time series resources of %s", fieldDataPtr->name);
-            le_mem_Release(fieldDataPtr->timeSeriesPtr->bufferPtr);
-            le_mem_Release(fieldDataPtr->timeSeriesPtr);
-        }
-
-        // Release the field.
-        LE_DEBUG("Deleting field %s", fieldDataPtr->name);
-        le_mem_Release(fieldDataPtr);
+    ReleaseFields(instanceRef);
 
-        linkPtr = le_dls_Pop(&instanceRef->fieldList);
-    }
+    // Release the field indexes
+    free(instanceRef->fieldArray);
+    free(instanceRef->fieldNameArray);
 
-    // Remove the instance from the asset instance list
+    // Remove the instance from the asset instance list and from the InstanceMap
     le_dls_Remove(&instanceRef->assetDataPtr->instanceList, &instanceRef->link);
+    le_hashmap_Remove(InstanceMap, &instanceRef->mapKey);
 
     // Lastly, release the instance data.
     le_mem_Release(instanceRef);
@@ -3306,6 +3872,11 @@ void assetData_DeleteInstanceAndAsset
          * Release the allocated asset data
          */
 
+        if ( LastAssetDataPtr == assetDataPtr )
+        {
+            LastAssetDataPtr = NULL;
+        }
+
         le_mem_Release(assetDataPtr);
     }
 }
@@ -3553,40 +4124,33 @@ le_result_t assetData_GetFieldIdFromName
     /*
      * NOTE:
      *   The main use for this function is to get the fieldId that is then passed to the various
-     *   assetData_client_Get* functions.  This is not particularly efficient as it requires
-     *   iterating twice through the field list.  One alternative would be to add a new set of
-     *   assetData_client_Get* functions that take a field name instead of field id.
-     *
-     *   For now, assume that the performance is good enough, but if it becomes an issue then
-     *   this second set of functions may need to be added.  Of course, there might also be some
-     *   other alternative solution that has not yet been considered.
+     *   assetData_client_Get* functions.  The fields are found by a binary search on the fields
+     *   sorted by name, and then by id in the field index (see BuildFieldIndex()), so that both
+     *   lookups stay cheap for assets with many fields.
      */
 
-    FieldData_t* fieldDataPtr;
-    le_dls_Link_t* fieldLinkPtr;
-
-    // Get the start of the field list
-    fieldLinkPtr = le_dls_Peek(&instanceRef->fieldList);
+    FieldData_t** fieldDataPtrPtr;
 
-    //LE_PRINT_VALUE("%s", instanceRef->assetDataPtr->appName);
-    //LE_PRINT_VALUE("%s", instanceRef->assetDataPtr->assetName);
+    fieldDataPtrPtr = bsearch(fieldNamePtr,
+                              instanceRef->fieldNameArray,
+                              instanceRef->fieldCount,
+                              sizeof(FieldData_t*),
+                              CompareFieldName);
 
-    // Loop through the fields
-    while ( fieldLinkPtr != NULL )
+    if ( fieldDataPtrPtr == NULL )
     {
-        fieldDataPtr = CONTAINER_OF(fieldLinkPtr, FieldData_t, link);
-        //LE_PRINT_VALUE("%s", fieldDataPtr->name);
-
-        if ( strcmp(fieldDataPtr->name, fieldNamePtr) == 0 )
-        {
-            *fieldIdPtr = fieldDataPtr->fieldId;
-            return LE_OK;
-        }
+        return LE_FAULT;
+    }
 
-        fieldLinkPtr = le_dls_PeekNext(&instanceRef->fieldList, fieldLinkPtr);
+    // With duplicate field names, return the lowest field id.
+    while ( ( fieldDataPtrPtr > instanceRef->fieldNameArray ) &&
+            ( strcmp((*(fieldDataPtrPtr - 1))->name, fieldNamePtr) == 0 ) )
+    {
+        fieldDataPtrPtr--;
     }
 
-    return LE_FAULT;
+    *fieldIdPtr = (*fieldDataPtrPtr)->fieldId;
+    return LE_OK;
 }
 
 
@@ -3732,6 +4296,64 @@ le_result_t assetData_client_RecordFloat
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a batch of samples of an integer variable field in time series.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if field not found
+ *      - LE_CLOSED if time series not enabled on this field
+ *      - LE_OVERFLOW if a sample was NOT added as the time series buffer is full; the samples
+ *                    before it were added.
+ *      - LE_NO_MEMORY if the samples were added but there is no space for next one.
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t assetData_client_RecordIntBatch
+(
+    assetData_InstanceDataRef_t instanceRef,    ///< [IN] Asset instance to use
+    int fieldId,                                ///< [IN] Field to write
+    const uint64_t* timeStampsPtr,              ///< [IN] Timestamps in msec
+    const int32_t* valuesPtr,                   ///< [IN] The values to write
+    size_t numSamples,                          ///< [IN] Number of samples
+    size_t* numRecordedPtr                      ///< [OUT] Number of samples added
+)
+{
+    return RecordBatch(instanceRef, fieldId, DATA_TYPE_INT, timeStampsPtr, valuesPtr, NULL,
+                       numSamples, numRecordedPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a batch of samples of a float variable field in time series.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if field not found
+ *      - LE_CLOSED if time series not enabled on this field
+ *      - LE_OVERFLOW if a sample was NOT added as the time series buffer is full; the samples
+ *                    before it were added.
+ *      - LE_NO_MEMORY if the samples were added but there is no space for next one.
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t assetData_client_RecordFloatBatch
+(
+    assetData_InstanceDataRef_t instanceRef,    ///< [IN] Asset instance to use
+    int fieldId,                                ///< [IN] Field to write
+    const uint64_t* timeStampsPtr,              ///< [IN] Timestamps in msec
+    const double* valuesPtr,                    ///< [IN] The values to write
+    size_t numSamples,                          ///< [IN] Number of samples
+    size_t* numRecordedPtr                      ///< [OUT] Number of samples added
+)
+{
+    return RecordBatch(instanceRef, fieldId, DATA_TYPE_FLOAT, timeStampsPtr, NULL, valuesPtr,
+                       numSamples, numRecordedPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the bool value for the specified field
@@ -4532,6 +5154,11 @@ le_result_t assetData_Init
     TimeSeriesDataPoolRef = le_mem_CreatePool("TimeSeries data pool", sizeof(TimeSeriesData_t));
     CborBufferPoolRef = le_mem_CreatePool("CBOR buffer pool", MAX_CBOR_BUFFER_NUMBYTES);
 
+#ifdef LEGATO_FEATURE_TIMESERIES
+    // Time series kept while the session is not open.
+    timeSeriesSpool_Init();
+#endif
+
     StringValuePoolRef = le_mem_CreatePool("String value pool", STRING_VALUE_NUMBYTES);
     AddressStringPoolRef = le_mem_CreatePool("Address pool", 100);
 
@@ -4544,6 +5171,12 @@ le_result_t assetData_Init
                                        le_hashmap_HashString,
                                        le_hashmap_EqualsString);
 
+    // Create InstanceMap that maps (assetData block, instanceId) to an InstanceData block.
+    InstanceMap = le_hashmap_Create("InstanceMap",
+                                    INSTANCE_MAP_SIZE,
+                                    HashInstanceKey,
+                                    EqualsInstanceKey);
+
 
     // Use a timer to delay reporting instance creation events to the modem for 15 seconds after
     // the last creation event. This allows us to aggregate multiple registration updates together.
@@ -5392,6 +6025,14 @@ le_result_t assetData_SetObserve
         linkPtr = le_dls_PeekNext(&instanceRef->fieldList, linkPtr);
     }
 
+#ifdef LEGATO_FEATURE_TIMESERIES
+    // Time series of these fields may be waiting for the observe.
+    if (isObserve && (result == LE_OK))
+    {
+        SendTimeSeriesSpool();
+    }
+#endif
+
     return result;
 }
 
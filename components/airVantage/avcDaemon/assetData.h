@@ -1057,13 +1057,14 @@ le_result_t assetData_client_StopTimeSeries
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Compress the accumulated CBOR encoded time series data and send it to server.
+ * Compress the accumulated CBOR encoded time series data and send it to server, or keep it in the
+ * time series spool while the session is not open.
  *
  * @return:
  *      - LE_OK on success
  *      - LE_NOT_FOUND if field not found
  *      - LE_CLOSED if time series not enabled on this field
- *      - LE_UNAVAILABLE if observe is not enabled on this field
+ *      - LE_UNAVAILABLE if observe is not enabled on this field, and the data can't be spooled
  *      - LE_FAULT if any other error
  */
 //--------------------------------------------------------------------------------------------------
@@ -1194,6 +1195,56 @@ LE_SHARED le_result_t assetData_client_RecordFloat
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a batch of samples of an integer variable field in time series.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if field not found
+ *      - LE_CLOSED if time series not enabled on this field
+ *      - LE_OVERFLOW if a sample was NOT added as the time series buffer is full; the samples
+ *                    before it were added.
+ *      - LE_NO_MEMORY if the samples were added but there is no space for next one.
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t assetData_client_RecordIntBatch
+(
+    assetData_InstanceDataRef_t instanceRef,    ///< [IN] Asset instance to use
+    int fieldId,                                ///< [IN] Field to write
+    const uint64_t* timeStampsPtr,              ///< [IN] Timestamps in msec
+    const int32_t* valuesPtr,                   ///< [IN] The values to write
+    size_t numSamples,                          ///< [IN] Number of samples
+    size_t* numRecordedPtr                      ///< [OUT] Number of samples added
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a batch of samples of a float variable field in time series.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_NOT_FOUND if field not found
+ *      - LE_CLOSED if time series not enabled on this field
+ *      - LE_OVERFLOW if a sample was NOT added as the time series buffer is full; the samples
+ *                    before it were added.
+ *      - LE_NO_MEMORY if the samples were added but there is no space for next one.
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+LE_SHARED le_result_t assetData_client_RecordFloatBatch
+(
+    assetData_InstanceDataRef_t instanceRef,    ///< [IN] Asset instance to use
+    int fieldId,                                ///< [IN] Field to write
+    const uint64_t* timeStampsPtr,              ///< [IN] Timestamps in msec
+    const double* valuesPtr,                    ///< [IN] The values to write
+    size_t numSamples,                          ///< [IN] Number of samples
+    size_t* numRecordedPtr                      ///< [OUT] Number of samples added
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Record the value of a boolean variable field in time series.
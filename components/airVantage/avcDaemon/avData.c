@@ -1401,6 +1401,164 @@ le_result_t le_avdata_RecordString
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a batch of samples of an integer variable field in time series.
+ *
+ * @note The client will be terminated if the instRef is not valid, the field doesn't exist, or the
+ *       numbers of timestamps and values differ.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_CLOSED if time series is not enabled on this field
+ *      - LE_OVERFLOW if a sample was NOT added as the time series buffer is full. The samples
+ *                    before it were added.
+ *      - LE_NO_MEMORY if the samples were added but there is no space for next one.
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_avdata_RecordIntBatch
+(
+    le_avdata_AssetInstanceRef_t instRef,
+        ///< [IN]
+
+    const char* fieldName,
+        ///< [IN]
+
+    const uint64_t* timeStampsPtr,
+        ///< [IN]
+
+    size_t timeStampsNumElements,
+        ///< [IN]
+
+    const int32_t* valuesPtr,
+        ///< [IN]
+
+    size_t valuesNumElements,
+        ///< [IN]
+
+    uint32_t* numRecordedPtr
+        ///< [OUT]
+)
+{
+    le_result_t result;
+    size_t numRecorded;
+
+    *numRecordedPtr = 0;
+
+    // Map safeRef to desired data
+    instRef = GetInstRefFromSafeRef(instRef, __func__);
+
+    int fieldId;
+
+    if ( assetData_GetFieldIdFromName(instRef, fieldName, &fieldId) != LE_OK )
+    {
+        LE_KILL_CLIENT("Invalid instance '%p' or unknown field name '%s'", instRef, fieldName);
+        return LE_FAULT;
+    }
+
+    if ( timeStampsNumElements != valuesNumElements )
+    {
+        LE_KILL_CLIENT("%zu timestamps for %zu values", timeStampsNumElements, valuesNumElements);
+        return LE_FAULT;
+    }
+
+    result = assetData_client_RecordIntBatch(instRef, fieldId, timeStampsPtr, valuesPtr,
+                                             valuesNumElements, &numRecorded);
+    *numRecordedPtr = numRecorded;
+
+    if (result == LE_NO_MEMORY)
+    {
+        LE_WARN("Time series buffer full for field=%i", fieldId);
+    }
+    else if (result != LE_OK)
+    {
+        LE_ERROR("Error recording field=%i after %zu samples", fieldId, numRecorded);
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record a batch of samples of a float variable field in time series.
+ *
+ * @note The client will be terminated if the instRef is not valid, the field doesn't exist, or the
+ *       numbers of timestamps and values differ.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_CLOSED if time series is not enabled on this field
+ *      - LE_OVERFLOW if a sample was NOT added as the time series buffer is full. The samples
+ *                    before it were added.
+ *      - LE_NO_MEMORY if the samples were added but there is no space for next one.
+ *      - LE_FAULT on any other error
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_avdata_RecordFloatBatch
+(
+    le_avdata_AssetInstanceRef_t instRef,
+        ///< [IN]
+
+    const char* fieldName,
+        ///< [IN]
+
+    const uint64_t* timeStampsPtr,
+        ///< [IN]
+
+    size_t timeStampsNumElements,
+        ///< [IN]
+
+    const double* valuesPtr,
+        ///< [IN]
+
+    size_t valuesNumElements,
+        ///< [IN]
+
+    uint32_t* numRecordedPtr
+        ///< [OUT]
+)
+{
+    le_result_t result;
+    size_t numRecorded;
+
+    *numRecordedPtr = 0;
+
+    // Map safeRef to desired data
+    instRef = GetInstRefFromSafeRef(instRef, __func__);
+
+    int fieldId;
+
+    if ( assetData_GetFieldIdFromName(instRef, fieldName, &fieldId) != LE_OK )
+    {
+        LE_KILL_CLIENT("Invalid instance '%p' or unknown field name '%s'", instRef, fieldName);
+        return LE_FAULT;
+    }
+
+    if ( timeStampsNumElements != valuesNumElements )
+    {
+        LE_KILL_CLIENT("%zu timestamps for %zu values", timeStampsNumElements, valuesNumElements);
+        return LE_FAULT;
+    }
+
+    result = assetData_client_RecordFloatBatch(instRef, fieldId, timeStampsPtr, valuesPtr,
+                                               valuesNumElements, &numRecorded);
+    *numRecordedPtr = numRecorded;
+
+    if (result == LE_NO_MEMORY)
+    {
+        LE_WARN("Time series buffer full for field=%i", fieldId);
+    }
+    else if (result != LE_OK)
+    {
+        LE_ERROR("Error recording field=%i after %zu samples", fieldId, numRecorded);
+    }
+
+    return result;
+}
+
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -0,0 +1,509 @@
+/**
+ * @file timeSeriesSpool.c
+ *
+ * Implementation of the time series spool sub-component.
+ *
+ * The spool file holds TIME_SERIES_SPOOL_SLOT_COUNT slots, each holding one compressed time series
+ * after a slot header. The time series of observed fields are sent while the others stay spooled,
+ * so the free slots are not contiguous: a new time series goes to the first free slot following the
+ * last written one, and the oldest time series is dropped only when all the slots are used. The
+ * slot headers are also kept in memory, and their sequence numbers give the order of the time
+ * series.
+ *
+ * A slot is written in two steps, its data and then its header, so that a slot interrupted by a
+ * power loss is discarded at the next startup. A slot is only written after its cleared header has
+ * reached the flash, so that the header of an old time series is never found with new data.
+ *
+ * <hr>
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#include "legato.h"
+
+#include "limit.h"
+#include "timeSeriesSpool.h"
+
+
+//--------------------------------------------------------------------------------------------------
+// Definitions
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Spool file identifier ("AVTS") and format version.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SPOOL_FILE_MAGIC 0x53545641
+#define SPOOL_FILE_VERSION 1
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes of a slot: the header followed by the compressed data.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SPOOL_SLOT_NUMBYTES (sizeof(SlotHeader_t) + TIME_SERIES_SPOOL_MAX_DATA_NUMBYTES)
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Spool file header, followed by the slots.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t magic;                             ///< SPOOL_FILE_MAGIC
+    uint16_t version;                           ///< SPOOL_FILE_VERSION
+    uint16_t slotNumBytes;                      ///< SPOOL_SLOT_NUMBYTES
+    uint32_t slotCount;                         ///< TIME_SERIES_SPOOL_SLOT_COUNT
+    uint32_t reserved;                          ///< Set to 0
+}
+FileHeader_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Slot header, describing the time series of the slot.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t sequence;                          ///< Spool order of the time series, 0 if empty
+    uint16_t dataNumBytes;                      ///< Number of bytes of compressed data
+    uint16_t reserved;                          ///< Set to 0
+    int32_t assetId;                            ///< Asset id
+    int32_t instanceId;                         ///< Asset instance id
+    int32_t fieldId;                            ///< Field of the time series
+    char appName[LIMIT_MAX_APP_NAME_BYTES];     ///< App containing the asset
+}
+SlotHeader_t;
+
+
+//--------------------------------------------------------------------------------------------------
+// Data structures
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Spool file descriptor, -1 if the spool is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+static int SpoolFd = -1;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Headers of the slots.
+ */
+//--------------------------------------------------------------------------------------------------
+static SlotHeader_t Slots[TIME_SERIES_SPOOL_SLOT_COUNT];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Slot following the last written one, number of spooled time series and next sequence number.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t NextSlot = 0;
+static uint32_t Count = 0;
+static uint32_t NextSequence = 1;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Buffer used to read back the data of a slot.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint8_t DataBuffer[TIME_SERIES_SPOOL_MAX_DATA_NUMBYTES];
+
+
+//--------------------------------------------------------------------------------------------------
+// Local functions
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the file offset of a slot.
+ */
+//--------------------------------------------------------------------------------------------------
+static off_t GetSlotOffset
+(
+    uint32_t slot
+)
+{
+    return sizeof(FileHeader_t) + (off_t)slot * SPOOL_SLOT_NUMBYTES;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mark a slot as empty, in memory and in the spool file. The caller syncs the spool file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ClearSlot
+(
+    uint32_t slot
+)
+{
+    if (Slots[slot].sequence != 0)
+    {
+        Count--;
+    }
+    memset(&Slots[slot], 0, sizeof(SlotHeader_t));
+
+    if (pwrite(SpoolFd, &Slots[slot], sizeof(SlotHeader_t), GetSlotOffset(slot))
+        != sizeof(SlotHeader_t))
+    {
+        LE_ERROR("Failed to clear time series spool slot %u: %m", slot);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the oldest time series whose sequence number is at least minSequence.
+ *
+ * @return The slot of the time series, or TIME_SERIES_SPOOL_SLOT_COUNT if there is none.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t FindOldestSlot
+(
+    uint32_t minSequence
+)
+{
+    uint32_t oldestSlot = TIME_SERIES_SPOOL_SLOT_COUNT;
+    uint32_t slot;
+
+    for (slot = 0; slot < TIME_SERIES_SPOOL_SLOT_COUNT; slot++)
+    {
+        if ((Slots[slot].sequence >= minSequence) && (Slots[slot].sequence != 0) &&
+            ((oldestSlot == TIME_SERIES_SPOOL_SLOT_COUNT) ||
+             (Slots[slot].sequence < Slots[oldestSlot].sequence)))
+        {
+            oldestSlot = slot;
+        }
+    }
+
+    return oldestSlot;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the first free slot following the last written one. The spool must not be full.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t FindFreeSlot
+(
+    void
+)
+{
+    uint32_t i;
+
+    for (i = 0; i < TIME_SERIES_SPOOL_SLOT_COUNT; i++)
+    {
+        uint32_t slot = (NextSlot + i) % TIME_SERIES_SPOOL_SLOT_COUNT;
+
+        if (Slots[slot].sequence == 0)
+        {
+            return slot;
+        }
+    }
+
+    LE_FATAL("No free slot in time series spool of %u time series", Count);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reset the spool file to empty slots.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_FAULT if the spool file could not be written
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ResetSpoolFile
+(
+    void
+)
+{
+    FileHeader_t header;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = SPOOL_FILE_MAGIC;
+    header.version = SPOOL_FILE_VERSION;
+    header.slotNumBytes = SPOOL_SLOT_NUMBYTES;
+    header.slotCount = TIME_SERIES_SPOOL_SLOT_COUNT;
+
+    // Empty slots are zero-filled by the truncation.
+    if ((ftruncate(SpoolFd, 0) != 0) ||
+        (pwrite(SpoolFd, &header, sizeof(header), 0) != sizeof(header)) ||
+        (ftruncate(SpoolFd, GetSlotOffset(TIME_SERIES_SPOOL_SLOT_COUNT)) != 0))
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Load the slot headers of the spool file, and find the next slot to write.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadSlots
+(
+    void
+)
+{
+    uint32_t newestSlot = 0;
+    uint32_t slot;
+
+    for (slot = 0; slot < TIME_SERIES_SPOOL_SLOT_COUNT; slot++)
+    {
+        if ((pread(SpoolFd, &Slots[slot], sizeof(SlotHeader_t), GetSlotOffset(slot))
+             != sizeof(SlotHeader_t)) ||
+            (Slots[slot].dataNumBytes > TIME_SERIES_SPOOL_MAX_DATA_NUMBYTES) ||
+            (Slots[slot].appName[sizeof(Slots[slot].appName) - 1] != '\0'))
+        {
+            memset(&Slots[slot], 0, sizeof(SlotHeader_t));
+        }
+
+        if (Slots[slot].sequence != 0)
+        {
+            Count++;
+            if (Slots[slot].sequence > Slots[newestSlot].sequence)
+            {
+                newestSlot = slot;
+            }
+        }
+    }
+
+    if (Count > 0)
+    {
+        NextSlot = (newestSlot + 1) % TIME_SERIES_SPOOL_SLOT_COUNT;
+        NextSequence = Slots[newestSlot].sequence + 1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// Interface functions
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Init this sub-component: open the spool file and load the list of spooled time series.
+ *
+ * If the spool file can't be opened, the spool is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+void timeSeriesSpool_Init
+(
+    void
+)
+{
+    FileHeader_t header;
+
+    if ((mkdir(TIME_SERIES_SPOOL_PATH, S_IRWXU) != 0) && (errno != EEXIST))
+    {
+        LE_ERROR("Failed to create '%s', time series spool disabled: %m",
+                 TIME_SERIES_SPOOL_PATH);
+        return;
+    }
+
+    SpoolFd = open(TIME_SERIES_SPOOL_FILE, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (SpoolFd == -1)
+    {
+        LE_ERROR("Failed to open '%s', time series spool disabled: %m", TIME_SERIES_SPOOL_FILE);
+        return;
+    }
+
+    if ((pread(SpoolFd, &header, sizeof(header), 0) == sizeof(header)) &&
+        (header.magic == SPOOL_FILE_MAGIC) &&
+        (header.version == SPOOL_FILE_VERSION) &&
+        (header.slotNumBytes == SPOOL_SLOT_NUMBYTES) &&
+        (header.slotCount == TIME_SERIES_SPOOL_SLOT_COUNT))
+    {
+        LoadSlots();
+    }
+    else if (ResetSpoolFile() != LE_OK)
+    {
+        LE_ERROR("Failed to reset '%s', time series spool disabled: %m", TIME_SERIES_SPOOL_FILE);
+        close(SpoolFd);
+        SpoolFd = -1;
+        return;
+    }
+
+    LE_INFO("%u time series in spool", Count);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is the spool available to store time series?
+ */
+//--------------------------------------------------------------------------------------------------
+bool timeSeriesSpool_IsEnabled
+(
+    void
+)
+{
+    return (SpoolFd != -1);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a compressed time series to the spool. When the spool is full, the oldest time series is
+ * dropped.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNAVAILABLE if the spool is disabled
+ *      - LE_OVERFLOW if the time series is too large
+ *      - LE_FAULT if the spool file could not be written
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeriesSpool_Add
+(
+    const char* appNamePtr,                     ///< [IN] App containing the asset
+    int assetId,                                ///< [IN] Asset id
+    int instanceId,                             ///< [IN] Asset instance id
+    int fieldId,                                ///< [IN] Field of the time series
+    const uint8_t* dataPtr,                     ///< [IN] Compressed time series
+    size_t dataNumBytes                         ///< [IN] Number of bytes of compressed data
+)
+{
+    SlotHeader_t header;
+    uint32_t slot;
+
+    if (SpoolFd == -1)
+    {
+        return LE_UNAVAILABLE;
+    }
+
+    memset(&header, 0, sizeof(header));
+    if ((dataNumBytes > TIME_SERIES_SPOOL_MAX_DATA_NUMBYTES) ||
+        (le_utf8_Copy(header.appName, appNamePtr, sizeof(header.appName), NULL) != LE_OK))
+    {
+        return LE_OVERFLOW;
+    }
+    header.sequence = NextSequence;
+    header.dataNumBytes = dataNumBytes;
+    header.assetId = assetId;
+    header.instanceId = instanceId;
+    header.fieldId = fieldId;
+
+    if (Count == TIME_SERIES_SPOOL_SLOT_COUNT)
+    {
+        slot = FindOldestSlot(1);
+        LE_WARN("Time series spool full, dropping time series of /%s/%d/%d/%d",
+                Slots[slot].appName,
+                Slots[slot].assetId,
+                Slots[slot].instanceId,
+                Slots[slot].fieldId);
+        ClearSlot(slot);
+        if (fdatasync(SpoolFd) != 0)
+        {
+            LE_ERROR("Failed to sync time series spool: %m");
+            return LE_FAULT;
+        }
+    }
+    else
+    {
+        slot = FindFreeSlot();
+    }
+
+    if ((pwrite(SpoolFd, dataPtr, dataNumBytes, GetSlotOffset(slot) + sizeof(SlotHeader_t))
+         != (ssize_t)dataNumBytes) ||
+        (fdatasync(SpoolFd) != 0) ||
+        (pwrite(SpoolFd, &header, sizeof(header), GetSlotOffset(slot)) != sizeof(header)) ||
+        (fdatasync(SpoolFd) != 0))
+    {
+        LE_ERROR("Failed to write time series spool slot %u: %m", slot);
+        ClearSlot(slot);
+        fdatasync(SpoolFd);
+        return LE_FAULT;
+    }
+
+    Slots[slot] = header;
+    Count++;
+    NextSlot = (slot + 1) % TIME_SERIES_SPOOL_SLOT_COUNT;
+    NextSequence++;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pass the spooled time series to a send handler, oldest first, and remove the ones it has sent.
+ *
+ * @return Number of time series sent.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t timeSeriesSpool_Send
+(
+    timeSeriesSpool_SendFunc_t sendFunc         ///< [IN] Send handler
+)
+{
+    uint32_t sentCount = 0;
+    uint32_t clearedCount = 0;
+    uint32_t sequence = 1;
+    uint32_t slot;
+
+    while ((slot = FindOldestSlot(sequence)) != TIME_SERIES_SPOOL_SLOT_COUNT)
+    {
+        SlotHeader_t* headerPtr = &Slots[slot];
+
+        sequence = headerPtr->sequence + 1;
+
+        if (pread(SpoolFd, DataBuffer, headerPtr->dataNumBytes,
+                  GetSlotOffset(slot) + sizeof(SlotHeader_t)) != headerPtr->dataNumBytes)
+        {
+            LE_ERROR("Failed to read time series spool slot %u: %m", slot);
+            ClearSlot(slot);
+            clearedCount++;
+            continue;
+        }
+
+        if (sendFunc(headerPtr->appName,
+                     headerPtr->assetId,
+                     headerPtr->instanceId,
+                     headerPtr->fieldId,
+                     DataBuffer,
+                     headerPtr->dataNumBytes))
+        {
+            ClearSlot(slot);
+            clearedCount++;
+            sentCount++;
+        }
+    }
+
+    // The cleared slots can be written again only once their headers are on the flash.
+    if ((clearedCount > 0) && (fdatasync(SpoolFd) != 0))
+    {
+        LE_ERROR("Failed to sync time series spool: %m");
+    }
+
+    if (sentCount > 0)
+    {
+        LE_INFO("%u spooled time series sent, %u left", sentCount, Count);
+    }
+
+    return sentCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of time series in the spool.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t timeSeriesSpool_GetCount
+(
+    void
+)
+{
+    return Count;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file timeSeriesSpool.h
+ *
+ * Interface for the time series spool sub-component.
+ *
+ * The spool keeps the compressed time series that could not be sent to the AirVantage server, in a
+ * file of fixed size, so that they survive a restart of the service or of the device.
+ *
+ * <hr>
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ *
+ */
+
+#ifndef LEGATO_TIME_SERIES_SPOOL_INCLUDE_GUARD
+#define LEGATO_TIME_SERIES_SPOOL_INCLUDE_GUARD
+
+#include "legato.h"
+
+
+//--------------------------------------------------------------------------------------------------
+// Definitions.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Spool directory and file.
+ */
+//--------------------------------------------------------------------------------------------------
+#ifdef LEGATO_EMBEDDED
+#define TIME_SERIES_SPOOL_PATH "/data/avcService/"
+#else
+#define TIME_SERIES_SPOOL_PATH "/tmp/avcService/"
+#endif
+#define TIME_SERIES_SPOOL_FILE TIME_SERIES_SPOOL_PATH "timeSeriesSpool"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of bytes of a compressed time series. A full time series buffer is 1024 bytes, and
+ * deflate can grow incompressible data by a few bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TIME_SERIES_SPOOL_MAX_DATA_NUMBYTES 1152
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of time series the spool can hold, i.e. about 150 KBytes of spool file.
+ */
+//--------------------------------------------------------------------------------------------------
+#define TIME_SERIES_SPOOL_SLOT_COUNT 128
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler called for each spooled time series, oldest first.
+ *
+ * @return true if the time series was sent and can be removed from the spool.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef bool (*timeSeriesSpool_SendFunc_t)
+(
+    const char* appNamePtr,                     ///< [IN] App containing the asset
+    int assetId,                                ///< [IN] Asset id
+    int instanceId,                             ///< [IN] Asset instance id
+    int fieldId,                                ///< [IN] Field of the time series
+    uint8_t* dataPtr,                           ///< [IN] Compressed time series
+    size_t dataNumBytes                         ///< [IN] Number of bytes of compressed data
+);
+
+
+//--------------------------------------------------------------------------------------------------
+// Interface functions
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Init this sub-component: open the spool file and load the list of spooled time series.
+ *
+ * If the spool file can't be opened, the spool is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+void timeSeriesSpool_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Is the spool available to store time series?
+ */
+//--------------------------------------------------------------------------------------------------
+bool timeSeriesSpool_IsEnabled
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a compressed time series to the spool. When the spool is full, the oldest time series is
+ * dropped.
+ *
+ * @return:
+ *      - LE_OK on success
+ *      - LE_UNAVAILABLE if the spool is disabled
+ *      - LE_OVERFLOW if the time series is too large
+ *      - LE_FAULT if the spool file could not be written
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t timeSeriesSpool_Add
+(
+    const char* appNamePtr,                     ///< [IN] App containing the asset
+    int assetId,                                ///< [IN] Asset id
+    int instanceId,                             ///< [IN] Asset instance id
+    int fieldId,                                ///< [IN] Field of the time series
+    const uint8_t* dataPtr,                     ///< [IN] Compressed time series
+    size_t dataNumBytes                         ///< [IN] Number of bytes of compressed data
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pass the spooled time series to a send handler, oldest first, and remove the ones it has sent.
+ *
+ * @return Number of time series sent.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t timeSeriesSpool_Send
+(
+    timeSeriesSpool_SendFunc_t sendFunc         ///< [IN] Send handler
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the number of time series in the spool.
+ */
+//--------------------------------------------------------------------------------------------------
+uint32_t timeSeriesSpool_GetCount
+(
+    void
+);
+
+#endif // LEGATO_TIME_SERIES_SPOOL_INCLUDE_GUARD
@@ -0,0 +1,415 @@
+//--------------------------------------------------------------------------------------------------
+/** @file cfgCache.c
+ *
+ * Caches configuration tree values on the client side.  Each cached value is kept as the node's
+ * type and its value string, which is what the configTree itself converts from on each typed read,
+ * so all the typed reads can be answered from one cached entry.
+ *
+ * Cached values are grouped by the node that contains them, and a change handler is registered on
+ * each such node.  When it fires, all the values cached under that node are dropped.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "cfgCache.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Estimated number of cached values, used to size the hash maps.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CACHE_SIZE_ESTIMATE         127
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A watched node, the parent node of one or more cached values.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char path[LE_CFG_STR_LEN_BYTES];            ///< Path to the node, the key in WatchMap.
+    le_cfg_ChangeHandlerRef_t handlerRef;       ///< Change handler registered on the node.
+    le_dls_List_t entryList;                    ///< Values cached under the node.
+}
+Watch_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A cached value.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char path[LE_CFG_STR_LEN_BYTES];            ///< Path to the value, the key in EntryMap.
+    le_cfg_nodeType_t type;                     ///< Type of the node when it was read.
+    char value[LE_CFG_STR_LEN_BYTES];           ///< The node's value string.
+    Watch_t* watchPtr;                          ///< The watched parent node.
+    le_dls_Link_t link;                         ///< Link in the watched node's entry list.
+}
+Entry_t;
+
+
+static le_mem_PoolRef_t WatchPool;
+static le_mem_PoolRef_t EntryPool;
+
+/// Watched nodes, by path.
+static le_hashmap_Ref_t WatchMap;
+
+/// Cached values, by path.
+static le_hashmap_Ref_t EntryMap;
+
+static cfgCache_Stats_t Stats;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drops all the values cached under a watched node.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DropEntries
+(
+    Watch_t* watchPtr               ///< [IN] The watched node.
+)
+{
+    le_dls_Link_t* linkPtr;
+
+    while ((linkPtr = le_dls_Pop(&watchPtr->entryList)) != NULL)
+    {
+        Entry_t* entryPtr = CONTAINER_OF(linkPtr, Entry_t, link);
+
+        le_hashmap_Remove(EntryMap, entryPtr->path);
+        le_mem_Release(entryPtr);
+
+        Stats.numEntries--;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called by the configTree when a watched node, or anything under it, changes.
+ */
+//--------------------------------------------------------------------------------------------------
+static void NodeChangeHandler
+(
+    void* contextPtr                ///< [IN] The watched node.
+)
+{
+    Watch_t* watchPtr = contextPtr;
+
+    LE_DEBUG("'%s' changed, dropping its cached values.", watchPtr->path);
+
+    Stats.invalidations += le_dls_NumLinks(&watchPtr->entryList);
+    DropEntries(watchPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the watched node for a value, starting to watch it if needed.
+ *
+ * @return
+ *      The watched node, or NULL if the path isn't absolute.
+ */
+//--------------------------------------------------------------------------------------------------
+static Watch_t* GetWatch
+(
+    const char* pathPtr             ///< [IN] Absolute path to the value.
+)
+{
+    // The parent is everything up to the last separator, keeping the separator if it's the root.
+    const char* rootPtr = strchr(pathPtr, '/');
+    const char* lastPtr = strrchr(pathPtr, '/');
+    const char* colonPtr = strchr(pathPtr, ':');
+
+    if (   (rootPtr == NULL)
+        || ((rootPtr != pathPtr) && ((colonPtr == NULL) || (colonPtr + 1 != rootPtr))))
+    {
+        LE_ERROR("Config path '%s' is not absolute.", pathPtr);
+        return NULL;
+    }
+
+    char parentPath[LE_CFG_STR_LEN_BYTES];
+    size_t parentLen = lastPtr - pathPtr;
+
+    if (lastPtr == rootPtr)
+    {
+        parentLen++;
+    }
+
+    memcpy(parentPath, pathPtr, parentLen);
+    parentPath[parentLen] = '\0';
+
+    Watch_t* watchPtr = le_hashmap_Get(WatchMap, parentPath);
+
+    if (watchPtr == NULL)
+    {
+        watchPtr = le_mem_ForceAlloc(WatchPool);
+
+        memcpy(watchPtr->path, parentPath, parentLen + 1);
+        watchPtr->entryList = LE_DLS_LIST_INIT;
+        watchPtr->handlerRef = le_cfg_AddChangeHandler(watchPtr->path, NodeChangeHandler, watchPtr);
+
+        le_hashmap_Put(WatchMap, watchPtr->path, watchPtr);
+        Stats.numWatches++;
+    }
+
+    return watchPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the cached value at a path, fetching it from the configTree if it isn't cached.
+ *
+ * @return
+ *      The cached value, or NULL if the path isn't valid.
+ */
+//--------------------------------------------------------------------------------------------------
+static const Entry_t* GetEntry
+(
+    const char* pathPtr             ///< [IN] Absolute path to the value.
+)
+{
+    Entry_t* entryPtr = le_hashmap_Get(EntryMap, pathPtr);
+
+    if (entryPtr != NULL)
+    {
+        Stats.hits++;
+        return entryPtr;
+    }
+
+    if (strlen(pathPtr) >= LE_CFG_STR_LEN_BYTES)
+    {
+        LE_ERROR("Config path '%s' is too long.", pathPtr);
+        return NULL;
+    }
+
+    // Watch for changes before reading, so that a change made in between isn't missed.
+    Watch_t* watchPtr = GetWatch(pathPtr);
+
+    if (watchPtr == NULL)
+    {
+        return NULL;
+    }
+
+    entryPtr = le_mem_ForceAlloc(EntryPool);
+
+    le_utf8_Copy(entryPtr->path, pathPtr, sizeof(entryPtr->path), NULL);
+    entryPtr->watchPtr = watchPtr;
+    entryPtr->link = LE_DLS_LINK_INIT;
+
+    le_cfg_IteratorRef_t iterRef = le_cfg_CreateReadTxn(pathPtr);
+
+    entryPtr->type = le_cfg_GetNodeType(iterRef, "");
+
+    if (le_cfg_GetString(iterRef, "", entryPtr->value, sizeof(entryPtr->value), "") != LE_OK)
+    {
+        // Can't happen, as the buffer is as big as a value can be.  Just don't cache it.
+        entryPtr->type = LE_CFG_TYPE_DOESNT_EXIST;
+    }
+
+    le_cfg_CancelTxn(iterRef);
+
+    le_dls_Queue(&watchPtr->entryList, &entryPtr->link);
+    le_hashmap_Put(EntryMap, entryPtr->path, entryPtr);
+
+    Stats.misses++;
+    Stats.numEntries++;
+
+    return entryPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a string value.
+ *
+ * @return
+ *      LE_OK if the value (or the default value) was copied to the buffer.
+ *      LE_OVERFLOW if it didn't fit in the buffer.
+ *      LE_BAD_PARAMETER if the path isn't absolute.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cfgCache_GetString
+(
+    const char* pathPtr,            ///< [IN] Absolute path to the value.
+    char* bufferPtr,                ///< [OUT] Buffer for the value.
+    size_t bufferSize,              ///< [IN] Size of the buffer, in bytes.
+    const char* defaultPtr          ///< [IN] Value to use if the node is empty or missing.
+)
+{
+    const Entry_t* entryPtr = GetEntry(pathPtr);
+
+    if (entryPtr == NULL)
+    {
+        return LE_BAD_PARAMETER;
+    }
+
+    switch (entryPtr->type)
+    {
+        case LE_CFG_TYPE_STRING:
+        case LE_CFG_TYPE_BOOL:
+        case LE_CFG_TYPE_INT:
+        case LE_CFG_TYPE_FLOAT:
+            return le_utf8_Copy(bufferPtr, entryPtr->value, bufferSize, NULL);
+
+        default:
+            return le_utf8_Copy(bufferPtr, defaultPtr, bufferSize, NULL);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads an integer value.  Float values are rounded to the nearest integer.
+ *
+ * @return
+ *      The value, or the default value if the node is empty, missing or not a number.
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t cfgCache_GetInt
+(
+    const char* pathPtr,            ///< [IN] Absolute path to the value.
+    int32_t defaultValue            ///< [IN] Value to use if the node is empty or missing.
+)
+{
+    const Entry_t* entryPtr = GetEntry(pathPtr);
+
+    if (entryPtr == NULL)
+    {
+        return defaultValue;
+    }
+
+    switch (entryPtr->type)
+    {
+        case LE_CFG_TYPE_INT:
+            return atoi(entryPtr->value);
+
+        case LE_CFG_TYPE_FLOAT:
+        {
+            double value = atof(entryPtr->value);
+            return (int32_t)(value >= 0.0 ? value + 0.5 : value - 0.5);
+        }
+
+        default:
+            return defaultValue;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a floating point value.
+ *
+ * @return
+ *      The value, or the default value if the node is empty, missing or not a number.
+ */
+//--------------------------------------------------------------------------------------------------
+double cfgCache_GetFloat
+(
+    const char* pathPtr,            ///< [IN] Absolute path to the value.
+    double defaultValue             ///< [IN] Value to use if the node is empty or missing.
+)
+{
+    const Entry_t* entryPtr = GetEntry(pathPtr);
+
+    if (entryPtr == NULL)
+    {
+        return defaultValue;
+    }
+
+    switch (entryPtr->type)
+    {
+        case LE_CFG_TYPE_INT:
+            return atoi(entryPtr->value);
+
+        case LE_CFG_TYPE_FLOAT:
+            return atof(entryPtr->value);
+
+        default:
+            return defaultValue;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a boolean value.
+ *
+ * @return
+ *      The value, or the default value if the node is empty, missing or not a boolean.
+ */
+//--------------------------------------------------------------------------------------------------
+bool cfgCache_GetBool
+(
+    const char* pathPtr,            ///< [IN] Absolute path to the value.
+    bool defaultValue               ///< [IN] Value to use if the node is empty or missing.
+)
+{
+    const Entry_t* entryPtr = GetEntry(pathPtr);
+
+    if ((entryPtr == NULL) || (entryPtr->type != LE_CFG_TYPE_BOOL))
+    {
+        return defaultValue;
+    }
+
+    // The configTree stores booleans as "t" and "f".
+    return strcmp(entryPtr->value, "f") != 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drops all the cached values.  The nodes stay watched, so that values read again are cached again
+ * without registering for changes again.
+ */
+//--------------------------------------------------------------------------------------------------
+void cfgCache_Flush
+(
+    void
+)
+{
+    le_hashmap_It_Ref_t iterRef = le_hashmap_GetIterator(WatchMap);
+
+    while (le_hashmap_NextNode(iterRef) == LE_OK)
+    {
+        DropEntries((Watch_t*)le_hashmap_GetValue(iterRef));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the cache statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+void cfgCache_GetStats
+(
+    cfgCache_Stats_t* statsPtr      ///< [OUT] The statistics.
+)
+{
+    *statsPtr = Stats;
+}
+
+
+COMPONENT_INIT
+{
+    WatchPool = le_mem_CreatePool("CfgCacheWatch", sizeof(Watch_t));
+    EntryPool = le_mem_CreatePool("CfgCacheEntry", sizeof(Entry_t));
+
+    WatchMap = le_hashmap_Create("CfgCacheWatches",
+                                 CACHE_SIZE_ESTIMATE,
+                                 le_hashmap_HashString,
+                                 le_hashmap_EqualsString);
+
+    EntryMap = le_hashmap_Create("CfgCacheEntries",
+                                 CACHE_SIZE_ESTIMATE,
+                                 le_hashmap_HashString,
+                                 le_hashmap_EqualsString);
+}
@@ -0,0 +1,131 @@
+//--------------------------------------------------------------------------------------------------
+/** @file cfgCache.h
+ *
+ * Cached read access to configuration tree values, for code that reads the same values over and
+ * over.  The first read of a value fetches it from the configTree, later reads are answered from
+ * the cache without any IPC.  Cached values are dropped whenever the configTree reports a change to
+ * the node containing them, so reads never return a value that has since been overwritten, once the
+ * change notification has been handled by the caller's event loop.
+ *
+ * Using the cache is optional, and can be mixed freely with the le_cfg API.  The results of the
+ * cfgCache_Get... functions are the same as those of the corresponding le_cfg_QuickGet...
+ * functions.
+ *
+ * Paths must be absolute, optionally with a tree name in front, (e.g. "/apps/foo/version", or
+ * "system:/apps/foo/version".)
+ *
+ * @note Changes made by the caller itself are only seen once its event loop has handled the change
+ *       notification.  Call cfgCache_Flush() after changing a value that must be read back right
+ *       away.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_CFG_CACHE_INCLUDE_GUARD
+#define LEGATO_CFG_CACHE_INCLUDE_GUARD
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cache statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t hits;                  ///< Reads answered from the cache.
+    uint64_t misses;                ///< Reads that had to fetch the value from the configTree.
+    uint64_t invalidations;         ///< Cached values dropped because their node changed.
+    size_t   numEntries;            ///< Number of values in the cache right now.
+    size_t   numWatches;            ///< Number of nodes watched for changes.
+}
+cfgCache_Stats_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a string value.
+ *
+ * @return
+ *      LE_OK if the value (or the default value) was copied to the buffer.
+ *      LE_OVERFLOW if it didn't fit in the buffer.
+ *      LE_BAD_PARAMETER if the path isn't absolute.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cfgCache_GetString
+(
+    const char* pathPtr,            ///< [IN] Absolute path to the value.
+    char* bufferPtr,                ///< [OUT] Buffer for the value.
+    size_t bufferSize,              ///< [IN] Size of the buffer, in bytes.
+    const char* defaultPtr          ///< [IN] Value to use if the node is empty or missing.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads an integer value.  Float values are rounded to the nearest integer.
+ *
+ * @return
+ *      The value, or the default value if the node is empty, missing or not a number.
+ */
+//--------------------------------------------------------------------------------------------------
+int32_t cfgCache_GetInt
+(
+    const char* pathPtr,            ///< [IN] Absolute path to the value.
+    int32_t defaultValue            ///< [IN] Value to use if the node is empty or missing.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a floating point value.
+ *
+ * @return
+ *      The value, or the default value if the node is empty, missing or not a number.
+ */
+//--------------------------------------------------------------------------------------------------
+double cfgCache_GetFloat
+(
+    const char* pathPtr,            ///< [IN] Absolute path to the value.
+    double defaultValue             ///< [IN] Value to use if the node is empty or missing.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a boolean value.
+ *
+ * @return
+ *      The value, or the default value if the node is empty, missing or not a boolean.
+ */
+//--------------------------------------------------------------------------------------------------
+bool cfgCache_GetBool
+(
+    const char* pathPtr,            ///< [IN] Absolute path to the value.
+    bool defaultValue               ///< [IN] Value to use if the node is empty or missing.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drops all the cached values.  The nodes stay watched, so that values read again are cached again
+ * without registering for changes again.
+ */
+//--------------------------------------------------------------------------------------------------
+void cfgCache_Flush
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the cache statistics.
+ */
+//--------------------------------------------------------------------------------------------------
+void cfgCache_GetStats
+(
+    cfgCache_Stats_t* statsPtr      ///< [OUT] The statistics.
+);
+
+
+#endif  // LEGATO_CFG_CACHE_INCLUDE_GUARD
@@ -22,4 +22,7 @@
 #define CFG_NODE_RATE               "acquisitionRate"
 #define CFG_POSITIONING_RATE_PATH   CFG_POSITIONING_PATH"/"CFG_NODE_RATE
 
+#define CFG_NODE_HISTORY_SIZE       "historySize"
+#define CFG_NODE_HISTORY_FILE       "historyFile"
+
 #endif // LEGATO_POSCFGENTRIES_INCLUDE_GUARD
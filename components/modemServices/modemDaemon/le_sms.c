@@ -45,6 +45,14 @@
 //--------------------------------------------------------------------------------------------------
 #define MAX_NUM_OF_SMS_MSG_IN_STORAGE   256
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of messages read at once from the storage area when the stored messages are listed.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMS_READ_BATCH_SIZE     16
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Maximum number of Message objects we expect to have at one time.
@@ -67,6 +75,27 @@
 //--------------------------------------------------------------------------------------------------
 #define SMS_MAX_SESSION 5
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of messages waiting to be sent asynchronously.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMS_SEND_QUEUE_MAX_DEPTH    64
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum number of times the sending of a message is retried after a temporary network failure.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMS_SEND_MAX_RETRIES        3
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delay before the first retry of a message sending, in seconds. It is doubled for each retry.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SMS_SEND_RETRY_DELAY        2
+
 //--------------------------------------------------------------------------------------------------
 /**
  * SMS command Type.
@@ -129,6 +158,8 @@ typedef struct le_sms_Msg
     void*             callBackPtr;                         ///< Callback response.
     void*             ctxPtr;                              ///< Context.
     le_msg_SessionRef_t sessionRef;                        ///< Client session reference.
+    le_clk_Time_t     queuedTime;                          ///< Time the SMS was queued for sending.
+    uint32_t          sendRetries;                         ///< Number of sending retries.
 
     /// SMS Status Report parameters
     uint8_t           messageReference;                             ///< TP Message Reference
@@ -242,6 +273,39 @@ typedef struct
 }
 MsgRefNode_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Statistics of the asynchronous sending queue.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t pendingCount;      ///< Number of messages waiting to be sent.
+    uint32_t maxPendingCount;   ///< Highest number of messages waiting to be sent.
+    uint32_t sendCount;         ///< Number of messages whose sending is over.
+    uint64_t totalLatency;      ///< Sum of the sending latencies, in milliseconds.
+    uint32_t maxLatency;        ///< Highest sending latency, in milliseconds.
+    uint32_t retryCount;        ///< Number of sending retries.
+}
+SendQueueStats_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Batch of messages read from the storage area, and decoded by the decoder thread.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t          numOfMsg;                             ///< Number of messages in the batch.
+    const uint32_t*   indexPtr;                             ///< Storage indexes of the messages.
+    le_result_t       readResult[SMS_READ_BATCH_SIZE];      ///< Result of the PDU reads.
+    pa_sms_Pdu_t      pdu[SMS_READ_BATCH_SIZE];             ///< PDUs read.
+    le_result_t       decodeResult[SMS_READ_BATCH_SIZE];    ///< Result of the PDU decoding.
+    pa_sms_Message_t  message[SMS_READ_BATCH_SIZE];         ///< Decoded messages.
+}
+MsgBatch_t;
+
 
 //--------------------------------------------------------------------------------------------------
 //                                       Static declarations
@@ -341,6 +405,36 @@ static le_event_Id_t SmsCommandEventId;
 //--------------------------------------------------------------------------------------------------
 static le_sem_Ref_t SmsSem;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thread decoding the messages read from the storage area, while the next ones are read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_thread_Ref_t SmsDecoderThreadRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Semaphore posted by the decoder thread when a batch of messages is decoded.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_sem_Ref_t DecodeSem;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Batches of messages read from the storage area: one is decoded while the other one is read.
+ */
+//--------------------------------------------------------------------------------------------------
+static MsgBatch_t MsgBatches[2];
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Statistics of the asynchronous sending queue, and the mutex protecting them (they are updated by
+ * the sender thread).
+ */
+//--------------------------------------------------------------------------------------------------
+static SendQueueStats_t SendQueueStats;
+static le_mutex_Ref_t   SendQueueMutex;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Structure for message statistics.
@@ -964,11 +1058,236 @@ static le_sms_Msg_t* CreateAndPopulateMessage
     return newSmsMsgObjPtr;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue a message object retrieved from memory to a list of received messages.
+ */
+//--------------------------------------------------------------------------------------------------
+static void QueueMessageInList
+(
+    le_sms_List_t      *msgListObjPtr,   ///< [IN] List of received messages.
+    le_sms_Msg_t       *newSmsMsgObjPtr, ///< [IN] Message object.
+    pa_sms_Storage_t    storage          ///< [IN] Storage used.
+)
+{
+    // Store sms area storage information.
+    newSmsMsgObjPtr->storage = storage;
+    newSmsMsgObjPtr->inAList = true;
+
+    // Allocate a new node message for the List SMS Message node.
+    le_sms_MsgReference_t* newReferencePtr =
+                    (le_sms_MsgReference_t*)le_mem_ForceAlloc(ReferencePool);
+
+    // Create a Safe Reference for this Message object.
+    newReferencePtr->msgRef = le_ref_CreateRef(MsgRefMap, newSmsMsgObjPtr);
+    (newSmsMsgObjPtr->smsUserCount)++;
+
+    LE_DEBUG("create reference node[%p], obj[%p], ref[%p], cpt (%d)",
+        newReferencePtr, newSmsMsgObjPtr,
+        newReferencePtr->msgRef, newSmsMsgObjPtr->smsUserCount);
+
+    newReferencePtr->listLink = LE_DLS_LINK_INIT;
+    // Insert the message in the List SMS Message node.
+    le_dls_Queue(&(msgListObjPtr->list), &(newReferencePtr->listLink));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Decode a batch of messages read from memory. This function is called in the decoder thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DecodeMsgBatch
+(
+    void* param1Ptr,    ///< [IN] Batch of messages.
+    void* param2Ptr     ///< [IN] Unused.
+)
+{
+    MsgBatch_t* batchPtr = (MsgBatch_t*)param1Ptr;
+    uint32_t    i;
+
+    for (i = 0; i < batchPtr->numOfMsg; i++)
+    {
+        if (batchPtr->readResult[i] != LE_OK)
+        {
+            continue;
+        }
+
+        batchPtr->decodeResult[i] = smsPdu_Decode(batchPtr->pdu[i].protocol,
+                                                  batchPtr->pdu[i].data,
+                                                  batchPtr->pdu[i].dataLen,
+                                                  true,
+                                                  &batchPtr->message[i]);
+    }
+
+    le_sem_Post(DecodeSem);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read several PDUs from memory, with pa_sms_RdPDUMsgBatchFromMem() if the platform adaptor
+ * supports it, or else one by one with pa_sms_RdPDUMsgFromMem().
+ *
+ * @return LE_FAULT        The function failed to get the messages from the preferred message
+ *                         storage.
+ * @return LE_TIMEOUT      No response was received from the Modem.
+ * @return LE_OK           The function succeeded, check resultArrayPtr for each message.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadPDUMsgBatch
+(
+    const uint32_t*     indexArrayPtr,  ///< [IN] The places of storage in memory.
+    uint32_t            numOfMsg,       ///< [IN] The number of messages to read.
+    pa_sms_Protocol_t   protocol,       ///< [IN] The protocol used for these messages
+    pa_sms_Storage_t    storage,        ///< [IN] SMS Storage used
+    pa_sms_Pdu_t*       msgArrayPtr,    ///< [OUT] The messages.
+    le_result_t*        resultArrayPtr  ///< [OUT] The result of the read of each message.
+)
+{
+    uint32_t i;
+    le_result_t res = pa_sms_RdPDUMsgBatchFromMem(indexArrayPtr, numOfMsg, protocol, storage,
+                                                  msgArrayPtr, resultArrayPtr);
+
+    if (LE_UNSUPPORTED != res)
+    {
+        return res;
+    }
+
+    for (i = 0; i < numOfMsg; i++)
+    {
+        resultArrayPtr[i] = pa_sms_RdPDUMsgFromMem(indexArrayPtr[i],
+                                                   protocol,
+                                                   storage,
+                                                   &msgArrayPtr[i]);
+        if (LE_TIMEOUT == resultArrayPtr[i])
+        {
+            return LE_TIMEOUT;
+        }
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read a batch of messages from memory.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadMsgBatch
+(
+    MsgBatch_t         *batchPtr,      ///< [OUT] Batch of messages.
+    pa_sms_Protocol_t   protocol,      ///< [IN] protocol to read.
+    uint32_t            numOfMsg,      ///< [IN] Number of message to read from memory.
+    const uint32_t     *arrayPtr,      ///< [IN] Array of message indexes.
+    pa_sms_Storage_t    storage        ///< [IN] Storage used.
+)
+{
+    le_result_t res;
+    uint32_t    i;
+
+    batchPtr->numOfMsg = numOfMsg;
+    batchPtr->indexPtr = arrayPtr;
+
+    for (i = 0; i < numOfMsg; i++)
+    {
+        batchPtr->readResult[i] = LE_FAULT;
+    }
+
+    le_sem_Wait(SmsSem);
+    res = ReadPDUMsgBatch(arrayPtr, numOfMsg, protocol, storage,
+                          batchPtr->pdu, batchPtr->readResult);
+    le_sem_Post(SmsSem);
+
+    if (res != LE_OK)
+    {
+        LE_ERROR("Failed to read a batch of messages (%d)", res);
+    }
+
+    for (i = 0; i < numOfMsg; i++)
+    {
+        if (batchPtr->readResult[i] != LE_OK)
+        {
+            LE_ERROR("pa_sms_RdMsgFromMem failed");
+        }
+        else if (batchPtr->pdu[i].dataLen > LE_SMS_PDU_MAX_BYTES)
+        {
+            LE_ERROR("PDU length out of range (%u) for message %d !",
+                            batchPtr->pdu[i].dataLen,
+                            arrayPtr[i]);
+            batchPtr->readResult[i] = LE_OUT_OF_RANGE;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a message object for each message of a decoded batch, and queue it to the list of
+ * received messages.
+ *
+ * @return The number of messages queued.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t QueueMsgBatch
+(
+    le_sms_List_t      *msgListObjPtr, ///< [OUT] List of received messages.
+    MsgBatch_t         *batchPtr,      ///< [IN] Batch of messages.
+    pa_sms_Storage_t    storage        ///< [IN] Storage used.
+)
+{
+    uint32_t numOfQueuedMsg = 0;
+    uint32_t i;
+
+    for (i = 0; i < batchPtr->numOfMsg; i++)
+    {
+        pa_sms_Pdu_t*     messagePduPtr = &batchPtr->pdu[i];
+        pa_sms_Message_t* messageConvertedPtr = &batchPtr->message[i];
+        le_sms_Msg_t*     newSmsMsgObjPtr;
+
+        if (batchPtr->readResult[i] != LE_OK)
+        {
+            continue;
+        }
+
+        if (batchPtr->decodeResult[i] == LE_OK)
+        {
+            if (messageConvertedPtr->type == PA_SMS_SUBMIT)
+            {
+                LE_WARN("Unexpected message type %d for message %d",
+                                messageConvertedPtr->type,
+                                batchPtr->indexPtr[i]);
+                continue;
+            }
+
+            newSmsMsgObjPtr = CreateAndPopulateMessage(batchPtr->indexPtr[i],
+                                                       messagePduPtr,
+                                                       messageConvertedPtr);
+        }
+        else
+        {
+            LE_WARN("Could not decode the message (idx.%d)", batchPtr->indexPtr[i]);
+            newSmsMsgObjPtr = CreateMessage(batchPtr->indexPtr[i], messagePduPtr);
+        }
+
+        if (newSmsMsgObjPtr == NULL)
+        {
+            LE_ERROR("Cannot create a new message object! Jump to next one...");
+            continue;
+        }
+
+        QueueMessageInList(msgListObjPtr, newSmsMsgObjPtr, storage);
+        numOfQueuedMsg++;
+    }
+
+    return numOfQueuedMsg;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Retrieve messages from memory. A new message object is created for each retrieved message and
  * then queued to the list of received messages.
  *
+ * The messages are read by batches of SMS_READ_BATCH_SIZE: a batch is decoded by the decoder
+ * thread while the next one is read, and the message objects are created in this thread.
+ *
  * @return LE_FAULT          In case of failure
  * @return A positive value  The number of messages read in memory
  */
@@ -982,9 +1301,10 @@ static int32_t GetMessagesFromMem
     pa_sms_Storage_t    storage        ///< [IN] Storage used.
 )
 {
-    pa_sms_Pdu_t messagePdu;
-    uint32_t     i;
-    uint32_t     numOfQueuedMsg=0;
+    MsgBatch_t*  decodingBatchPtr = NULL;
+    uint32_t     numOfReadMsg = 0;
+    uint32_t     numOfQueuedMsg = 0;
+    int          batchIdx = 0;
 
     if (msgListObjPtr == NULL)
     {
@@ -995,106 +1315,44 @@ static int32_t GetMessagesFromMem
         LE_FATAL("arrayPtr is NULL !");
     }
 
-    // Get Unread messages.
-    for (i=0 ; i < numOfMsg ; i++)
+    while ((numOfReadMsg < numOfMsg) || (decodingBatchPtr != NULL))
     {
-        // Try to read message for protocol mode.
-        le_result_t res;
-
-        le_sem_Wait(SmsSem);
-        res = pa_sms_RdPDUMsgFromMem(arrayPtr[i],protocol, storage, &messagePdu);
-        le_sem_Post(SmsSem);
+        MsgBatch_t* readBatchPtr = NULL;
 
-        if (res != LE_OK)
+        // Read the next batch while the previous one is decoded.
+        if (numOfReadMsg < numOfMsg)
         {
-            LE_ERROR("pa_sms_RdMsgFromMem failed");
-            continue;
-        }
+            uint32_t batchSize = numOfMsg - numOfReadMsg;
 
-        if (messagePdu.dataLen > LE_SMS_PDU_MAX_BYTES)
-        {
-            LE_ERROR("PDU length out of range (%u) for message %d !",
-                            messagePdu.dataLen,
-                            arrayPtr[i]);
-            continue;
-        }
+            if (batchSize > SMS_READ_BATCH_SIZE)
+            {
+                batchSize = SMS_READ_BATCH_SIZE;
+            }
+
+            readBatchPtr = &MsgBatches[batchIdx];
+            batchIdx = 1 - batchIdx;
 
-        // Try to decode message.
-        pa_sms_Message_t messageConverted;
+            ReadMsgBatch(readBatchPtr, protocol, batchSize, &arrayPtr[numOfReadMsg], storage);
+            numOfReadMsg += batchSize;
+        }
 
-        if (smsPdu_Decode(messagePdu.protocol,
-                          messagePdu.data,
-                          messagePdu.dataLen,
-                          true,
-                          &messageConverted) == LE_OK)
+        if (decodingBatchPtr != NULL)
         {
-            if (messageConverted.type != PA_SMS_SUBMIT)
-            {
-                le_sms_Msg_t* newSmsMsgObjPtr = CreateAndPopulateMessage(arrayPtr[i],
-                                &messagePdu,
-                                &messageConverted);
-                if (newSmsMsgObjPtr == NULL)
-                {
-                    LE_ERROR("Cannot create a new message object! Jump to next one...");
-                    continue;
-                }
-                // Store sms area storage information.
-                newSmsMsgObjPtr->storage = storage;
-                newSmsMsgObjPtr->inAList = true;
-
-                // Allocate a new node message for the List SMS Message node.
-                le_sms_MsgReference_t* newReferencePtr =
-                                (le_sms_MsgReference_t*)le_mem_ForceAlloc(ReferencePool);
-
-                // Create a Safe Reference for this Message object.
-                newReferencePtr->msgRef = le_ref_CreateRef(MsgRefMap, newSmsMsgObjPtr);
-                (newSmsMsgObjPtr->smsUserCount)++;
-
-                LE_DEBUG("create reference node[%p], obj[%p], ref[%p], cpt (%d)",
-                    newReferencePtr, newSmsMsgObjPtr,
-                    newReferencePtr->msgRef, newSmsMsgObjPtr->smsUserCount);
-
-                newReferencePtr->listLink = LE_DLS_LINK_INIT;
-                // Insert the message in the List SMS Message node.
-                le_dls_Queue(&(msgListObjPtr->list), &(newReferencePtr->listLink));
-                numOfQueuedMsg++;
-            }
-            else
-            {
-                LE_WARN("Unexpected message type %d for message %d",
-                                messageConverted.type,
-                                arrayPtr[i]);
-            }
+            le_sem_Wait(DecodeSem);
+            numOfQueuedMsg += QueueMsgBatch(msgListObjPtr, decodingBatchPtr, storage);
+
+            LE_DEBUG("%u/%u messages retrieved from storage %d",
+                     numOfReadMsg - (readBatchPtr ? readBatchPtr->numOfMsg : 0), numOfMsg,
+                     storage);
         }
-        else
+
+        if (readBatchPtr != NULL)
         {
-            LE_WARN("Could not decode the message (idx.%d)", arrayPtr[i]);
-            le_sms_Msg_t* newSmsMsgObjPtr = CreateMessage(arrayPtr[i], &messagePdu);
-            if (newSmsMsgObjPtr == NULL)
-            {
-                LE_ERROR("Cannot create a new message object! Jump to next one...");
-                continue;
-            }
-            // Store sms area storage information.
-            newSmsMsgObjPtr->storage = storage;
-            newSmsMsgObjPtr->inAList = true;
-
-            // Allocate a new node message for the List SMS Message node.
-            le_sms_MsgReference_t* newReferencePtr =
-                            (le_sms_MsgReference_t*)le_mem_ForceAlloc(ReferencePool);
-            // Create a Safe Reference for this Message object.
-            newReferencePtr->msgRef = le_ref_CreateRef(MsgRefMap, newSmsMsgObjPtr);
-            (newSmsMsgObjPtr->smsUserCount)++;
-
-            LE_DEBUG("create reference node[%p], obj[%p], ref[%p], cpt (%d)",
-                newReferencePtr, newSmsMsgObjPtr,
-                newReferencePtr->msgRef, newSmsMsgObjPtr->smsUserCount);
-
-            newReferencePtr->listLink = LE_DLS_LINK_INIT;
-            // Insert the message in the List SMS Message node.
-            le_dls_Queue(&(msgListObjPtr->list), &(newReferencePtr->listLink));
-            numOfQueuedMsg++;
+            le_event_QueueFunctionToThread(SmsDecoderThreadRef, DecodeMsgBatch,
+                                           readBatchPtr, NULL);
         }
+
+        decodingBatchPtr = readBatchPtr;
     }
 
     return numOfQueuedMsg;
@@ -2081,6 +2339,16 @@ static le_result_t SendAsyncSMS
         return LE_BAD_PARAMETER;
     }
 
+    le_mutex_Lock(SendQueueMutex);
+    if (SendQueueStats.pendingCount >= SMS_SEND_QUEUE_MAX_DEPTH)
+    {
+        le_mutex_Unlock(SendQueueMutex);
+        LE_WARN("Sending queue is full (%d messages)", SMS_SEND_QUEUE_MAX_DEPTH);
+        return LE_FAULT;
+    }
+    le_mutex_Unlock(SendQueueMutex);
+
+    // The PDU is encoded now, so that the sender thread only has to send it.
     result = CheckAndEncodeMessage(msgPtr);
 
     /* Send */
@@ -2140,6 +2408,17 @@ static le_result_t SendAsyncSMS
                 msgCommand.msgRef = msgRef;
                 msgPtr->callBackPtr = callBack;
                 msgPtr->ctxPtr = context;
+                msgPtr->queuedTime = le_clk_GetRelativeTime();
+                // A message object can be sent again: its retries start over.
+                msgPtr->sendRetries = 0;
+
+                le_mutex_Lock(SendQueueMutex);
+                SendQueueStats.pendingCount++;
+                if (SendQueueStats.pendingCount > SendQueueStats.maxPendingCount)
+                {
+                    SendQueueStats.maxPendingCount = SendQueueStats.pendingCount;
+                }
+                le_mutex_Unlock(SendQueueMutex);
 
                 LE_INFO("Send Send command for message (%p)", msgRef);
                 le_event_Report(SmsCommandEventId, &msgCommand, sizeof(msgCommand));
@@ -2162,6 +2441,222 @@ static le_result_t SendAsyncSMS
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a message sending failure is temporary, i.e. whether the sending can be retried.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsTemporarySendingError
+(
+    const pa_sms_SendingErrCode_t* errorCodePtr     ///< [IN] Sending error code.
+)
+{
+    switch (errorCodePtr->rp)
+    {
+        case LE_SMS_RP_ERROR_NETWORK_OUT_OF_ORDER:
+        case LE_SMS_RP_ERROR_TEMPORARY_FAILURE:
+        case LE_SMS_RP_ERROR_CONGESTION:
+        case LE_SMS_RP_ERROR_RESOURCES_UNAVAILABLE:
+            return true;
+
+        default:
+            break;
+    }
+
+    switch (errorCodePtr->tp)
+    {
+        case LE_SMS_TP_ERROR_SC_BUSY:
+        case LE_SMS_TP_ERROR_SIM_APP_TOOLKIT_BUSY:
+            return true;
+
+        default:
+            break;
+    }
+
+    switch (errorCodePtr->code3GPP2)
+    {
+        case LE_SMS_ERROR_NETWORK_RESOURCE_SHORTAGE:
+        case LE_SMS_ERROR_NETWORK_FAILURE:
+        case LE_SMS_ERROR_RADIO_IF_RESOURCE_SHORTAGE:
+            return true;
+
+        default:
+            break;
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the sending queue statistics when the sending of a message is over, whatever its result.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateSendQueueStats
+(
+    le_sms_Msg_t* msgPtr    ///< [IN] Message object.
+)
+{
+    le_clk_Time_t latency = le_clk_Sub(le_clk_GetRelativeTime(), msgPtr->queuedTime);
+    uint32_t latencyMs = latency.sec * 1000 + latency.usec / 1000;
+
+    le_mutex_Lock(SendQueueMutex);
+    SendQueueStats.sendCount++;
+    SendQueueStats.totalLatency += latencyMs;
+    if (latencyMs > SendQueueStats.maxLatency)
+    {
+        SendQueueStats.maxLatency = latencyMs;
+    }
+    le_mutex_Unlock(SendQueueMutex);
+
+    LE_DEBUG("Message (%p) sending over after %u ms, status %d",
+             msgPtr, latencyMs, msgPtr->pdu.status);
+}
+
+static void SendQueuedMessage(le_sms_MsgRef_t messageRef);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Timer handler to retry the sending of a message.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendRetryTimerHandler
+(
+    le_timer_Ref_t timerRef
+)
+{
+    le_sms_MsgRef_t messageRef = le_timer_GetContextPtr(timerRef);
+
+    le_timer_Delete(timerRef);
+
+    if (NULL == le_ref_Lookup(MsgRefMap, messageRef))
+    {
+        LE_DEBUG("No more message reference (%p) valid", messageRef);
+        return;
+    }
+
+    SendQueuedMessage(messageRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Schedule a new sending of a message after a temporary failure.
+ *
+ * The message stays in the sending state and the other queued messages are sent meanwhile.
+ *
+ * @return
+ *  - LE_OK     The sending is scheduled.
+ *  - LE_FAULT  The sending can't be retried.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ScheduleSendRetry
+(
+    le_sms_MsgRef_t messageRef,     ///< [IN] Message reference.
+    le_sms_Msg_t*   msgPtr,         ///< [IN] Message object.
+    int32_t         remainingTime   ///< [IN] Time left to send the message, in seconds.
+)
+{
+    int32_t delay = SMS_SEND_RETRY_DELAY << msgPtr->sendRetries;
+    le_clk_Time_t interval = { .sec = delay, .usec = 0 };
+    char timerName[20];
+
+    if ((msgPtr->sendRetries >= SMS_SEND_MAX_RETRIES) || (delay >= remainingTime))
+    {
+        return LE_FAULT;
+    }
+
+    snprintf(timerName, sizeof(timerName), "SMSRetry%p", messageRef);
+    le_timer_Ref_t timerRef = le_timer_Create(timerName);
+
+    le_timer_SetHandler(timerRef, SendRetryTimerHandler);
+    le_timer_SetContextPtr(timerRef, messageRef);
+    le_timer_SetInterval(timerRef, interval);
+    le_timer_Start(timerRef);
+
+    msgPtr->sendRetries++;
+
+    le_mutex_Lock(SendQueueMutex);
+    SendQueueStats.retryCount++;
+    le_mutex_Unlock(SendQueueMutex);
+
+    LE_INFO("Retry %u of message (%p) sending in %d s", msgPtr->sendRetries, messageRef, delay);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send a queued message, or schedule a new sending after a temporary failure. This function is
+ * called in the sender thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendQueuedMessage
+(
+    le_sms_MsgRef_t messageRef  ///< [IN] Message reference.
+)
+{
+    le_sms_Msg_t* msgPtr = le_ref_Lookup(MsgRefMap, messageRef);
+    int32_t remainingTime;
+    struct timespec currentTime = { 0 };
+    le_result_t res;
+
+    if (NULL == msgPtr)
+    {
+        LE_DEBUG("No more message reference (%p) valid", messageRef);
+        return;
+    }
+
+    le_sem_Wait(SmsSem);
+    LE_DEBUG("timer ref %p, ", msgPtr->timerRef);
+
+    // The sending timeout is now handled here.
+    msgPtr->timerRef = NULL;
+
+    if (clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
+    {
+        LE_ERROR("Cannot get current time");
+        msgPtr->pdu.status = LE_SMS_SENDING_FAILED;
+        le_sem_Post(SmsSem);
+        UpdateSendQueueStats(msgPtr);
+        SendSmsSendingStateEvent(messageRef);
+        return;
+    }
+    remainingTime = msgPtr->timeSendingLimit.tv_sec - currentTime.tv_sec;
+
+    if (remainingTime <= 0)
+    {
+        LE_ERROR("Bad remainingTime value %d", remainingTime);
+        msgPtr->pdu.status = LE_SMS_SENDING_TIMEOUT;
+    }
+    else
+    {
+        res = pa_sms_SendPduMsg(msgPtr->protocol,
+                        msgPtr->pdu.dataLen, msgPtr->pdu.data,
+                        remainingTime, &msgPtr->pdu.errorCode);
+        if (LE_OK == res)
+        {
+            msgPtr->pdu.status = LE_SMS_SENT;
+        }
+        else if (LE_TIMEOUT == res)
+        {
+            msgPtr->pdu.status = LE_SMS_SENDING_TIMEOUT;
+        }
+        else if (   IsTemporarySendingError(&msgPtr->pdu.errorCode)
+                 && (LE_OK == ScheduleSendRetry(messageRef, msgPtr, remainingTime)))
+        {
+            le_sem_Post(SmsSem);
+            return;
+        }
+        else
+        {
+            msgPtr->pdu.status = LE_SMS_SENDING_FAILED;
+        }
+    }
+    le_sem_Post(SmsSem);
+    UpdateSendQueueStats(msgPtr);
+    SendSmsSendingStateEvent(messageRef);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handler to process a command.
@@ -2175,6 +2670,11 @@ static void ProcessSmsSendingCommandHandler
     uint32_t command = ((CmdRequest_t*) msgCommand)->command;
     le_sms_MsgRef_t messageRef = ((CmdRequest_t*) msgCommand)->msgRef;
 
+    // The message is out of the queue, whatever happens to it now.
+    le_mutex_Lock(SendQueueMutex);
+    SendQueueStats.pendingCount--;
+    le_mutex_Unlock(SendQueueMutex);
+
     le_sms_Msg_t* msgPtr = le_ref_Lookup(MsgRefMap, messageRef);
 
     if (NULL == msgPtr)
@@ -2191,55 +2691,12 @@ static void ProcessSmsSendingCommandHandler
 
             if (!msgPtr->timeoutExpires)
             {
-                int32_t remainingTime = PA_SMS_SENDING_TIMEOUT;
-                le_result_t res = LE_TIMEOUT;
-
-                le_sem_Wait(SmsSem);
-                LE_DEBUG("timer ref %p, ", msgPtr->timerRef);
-                if (msgPtr->timerRef)
-                {
-                    msgPtr->timerRef = NULL;
-                    struct timespec currentTime = { 0 };
-                    if (clock_gettime(CLOCK_REALTIME, &currentTime) == -1)
-                    {
-                        LE_ERROR("Cannot get current time");
-                        msgPtr->pdu.status = LE_SMS_SENDING_FAILED;
-                        le_sem_Post(SmsSem);
-                        SendSmsSendingStateEvent(messageRef);
-                        return;
-                    }
-                    remainingTime = msgPtr->timeSendingLimit.tv_sec - currentTime.tv_sec;
-                }
-
-                if(remainingTime <= 0)
-                {
-                    LE_ERROR("Bad remainingTime value %d", remainingTime);
-                    msgPtr->pdu.status = LE_SMS_SENDING_TIMEOUT;
-                }
-                else
-                {
-                    res = pa_sms_SendPduMsg(msgPtr->protocol,
-                                    msgPtr->pdu.dataLen, msgPtr->pdu.data,
-                                    remainingTime, &msgPtr->pdu.errorCode);
-                    if (LE_OK == res)
-                    {
-                        msgPtr->pdu.status = LE_SMS_SENT;
-                    }
-                    else if (LE_TIMEOUT == res)
-                    {
-                        msgPtr->pdu.status = LE_SMS_SENDING_TIMEOUT;
-                    }
-                    else
-                    {
-                        msgPtr->pdu.status = LE_SMS_SENDING_FAILED;
-                    }
-                }
-                le_sem_Post(SmsSem);
-                SendSmsSendingStateEvent(messageRef);
+                SendQueuedMessage(messageRef);
             }
             else
             {
                 LE_DEBUG("Message (%p) already Expired", messageRef);
+                UpdateSendQueueStats(msgPtr);
             }
         }
         break;
@@ -2253,6 +2710,23 @@ static void ProcessSmsSendingCommandHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * This thread decodes the messages read from the storage areas.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* SmsDecoderThread
+(
+    void* contextPtr
+)
+{
+    le_sem_Post(DecodeSem);
+
+    // Run the event loop.
+    le_event_RunLoop();
+    return NULL;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * This thread does the actual work of Pool and send a SMS.
@@ -2410,12 +2884,21 @@ le_result_t le_sms_Init
 
     SmsSem = le_sem_Create("SmsSem", 1);
 
+    SendQueueMutex = le_mutex_CreateNonRecursive("SmsSendQueueMutex");
+    memset(&SendQueueStats, 0, sizeof(SendQueueStats));
+
     // Init the SMS command Event Id.
     SmsCommandEventId = le_event_CreateId("SmsSendCmd", sizeof(CmdRequest_t));
     le_thread_Start(le_thread_Create("SmsSenderThread", SmsSenderThread, NULL));
 
     le_sem_Wait(SmsSem);
 
+    // Start the thread decoding the messages read from the storage areas.
+    DecodeSem = le_sem_Create("SmsDecodeSem", 0);
+    SmsDecoderThreadRef = le_thread_Create("SmsDecoderThread", SmsDecoderThread, NULL);
+    le_thread_Start(SmsDecoderThreadRef);
+    le_sem_Wait(DecodeSem);
+
     // Register a handler function for new message indication.
     if (pa_sms_SetNewMsgHandler(NewSmsHandler) != LE_OK)
     {
@@ -2485,6 +2968,7 @@ le_sms_MsgRef_t le_sms_Create
     msgPtr->timeoutValue = PA_SMS_SENDING_TIMEOUT;
     msgPtr->callBackPtr = NULL;
     msgPtr->ctxPtr = NULL;
+    msgPtr->sendRetries = 0;
     msgPtr->format = LE_SMS_FORMAT_UNKNOWN;
     msgPtr->messageReference = 0;
     msgPtr->typeOfAddress = 0;
@@ -4877,6 +5361,33 @@ void le_sms_ResetCount
     SetMessageCount(LE_SMS_TYPE_BROADCAST_RX, 0);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the statistics of the asynchronous sending queue, since the start of the service.
+ *
+ * The latency of a message is the time from its queuing to the end of its sending, whatever the
+ * sending result.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_sms_GetSendQueueStats
+(
+    uint32_t* pendingCountPtr,      ///< [OUT] Number of messages waiting to be sent.
+    uint32_t* maxPendingCountPtr,   ///< [OUT] Highest number of messages waiting to be sent.
+    uint32_t* avgLatencyPtr,        ///< [OUT] Average sending latency, in milliseconds.
+    uint32_t* maxLatencyPtr,        ///< [OUT] Highest sending latency, in milliseconds.
+    uint32_t* retryCountPtr         ///< [OUT] Number of sending retries.
+)
+{
+    le_mutex_Lock(SendQueueMutex);
+    *pendingCountPtr = SendQueueStats.pendingCount;
+    *maxPendingCountPtr = SendQueueStats.maxPendingCount;
+    *avgLatencyPtr = SendQueueStats.sendCount ?
+                     (uint32_t)(SendQueueStats.totalLatency / SendQueueStats.sendCount) : 0;
+    *maxLatencyPtr = SendQueueStats.maxLatency;
+    *retryCountPtr = SendQueueStats.retryCount;
+    le_mutex_Unlock(SendQueueMutex);
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Enable SMS Status Report for outgoing messages.
@@ -575,59 +575,224 @@ static inline unsigned int Read7Bits
     return (a|b) & 0x7F;
 }
 
-static inline void Write7Bits
+static inline unsigned int ReadCdma7Bits
 (
-    uint8_t* bufferPtr,
-    uint8_t  val,
-    uint32_t pos
+    const uint8_t* bufferPtr,
+    uint32_t       pos
 )
 {
-    val &= 0x7F;
     uint8_t idx = pos/8;
 
+    return (((bufferPtr[idx]<<(pos&7))&0xFF)|(bufferPtr[idx+1]>>(8-(pos&7))))>>1;
+}
 
-    if (!(pos&7)) {
-        bufferPtr[idx] = val;
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pack 8 septets into 7 bytes (GSM 03.38 packing: the first septet is in the least significant
+ * bits of the first byte).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void Pack7BitsBlock
+(
+    const uint8_t* septetPtr,   ///< [IN] 8 septets
+    uint8_t*       bufferPtr    ///< [OUT] 7 bytes
+)
+{
+    uint64_t block = 0;
+    int i;
+
+    for (i = 7; i >= 0; i--)
+    {
+        block = (block << 7) | (septetPtr[i] & 0x7F);
     }
-    else if ((pos&7) == 1) {
-        bufferPtr[idx] = bufferPtr[idx] | (val<<1);
+
+    for (i = 0; i < 7; i++)
+    {
+        bufferPtr[i] = (uint8_t) block;
+        block >>= 8;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unpack 7 bytes into 8 septets (GSM 03.38 packing).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void Unpack7BitsBlock
+(
+    const uint8_t* bufferPtr,   ///< [IN] 7 bytes
+    uint8_t*       septetPtr    ///< [OUT] 8 septets
+)
+{
+    uint64_t block = 0;
+    int i;
+
+    for (i = 6; i >= 0; i--)
+    {
+        block = (block << 8) | bufferPtr[i];
     }
-    else {
-        bufferPtr[idx] = bufferPtr[idx] | (val<<(pos&7));
-        bufferPtr[idx+1] = (val>>(8-(pos&7)));
+
+    for (i = 0; i < 8; i++)
+    {
+        septetPtr[i] = block & 0x7F;
+        block >>= 7;
     }
 }
 
-static inline unsigned int ReadCdma7Bits
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pack 8 septets into 7 bytes (CDMA packing: the first septet is in the most significant bits of
+ * the first byte).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void PackCdma7BitsBlock
 (
-    const uint8_t* bufferPtr,
-    uint32_t       pos
+    const uint8_t* septetPtr,   ///< [IN] 8 septets
+    uint8_t*       bufferPtr    ///< [OUT] 7 bytes
 )
 {
-    uint8_t idx = pos/8;
+    uint64_t block = 0;
+    int i;
 
-    return (((bufferPtr[idx]<<(pos&7))&0xFF)|(bufferPtr[idx+1]>>(8-(pos&7))))>>1;
+    for (i = 0; i < 8; i++)
+    {
+        block = (block << 7) | (septetPtr[i] & 0x7F);
+    }
+
+    for (i = 6; i >= 0; i--)
+    {
+        bufferPtr[i] = (uint8_t) block;
+        block >>= 8;
+    }
 }
 
-static inline void WriteCdma7Bits
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unpack 7 bytes into 8 septets (CDMA packing).
+ */
+//--------------------------------------------------------------------------------------------------
+static inline void UnpackCdma7BitsBlock
 (
-    uint8_t* bufferPtr,
-    uint8_t  val,
-    uint32_t pos
+    const uint8_t* bufferPtr,   ///< [IN] 7 bytes
+    uint8_t*       septetPtr    ///< [OUT] 8 septets
 )
 {
-    val &= 0x7F;
-    uint8_t idx = pos/8;
+    uint64_t block = 0;
+    int i;
+
+    for (i = 0; i < 7; i++)
+    {
+        block = (block << 8) | bufferPtr[i];
+    }
+
+    for (i = 7; i >= 0; i--)
+    {
+        septetPtr[i] = block & 0x7F;
+        block >>= 7;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pack septets, 8 septets into 7 bytes at a time.
+ *
+ * The last byte is padded with zeros.
+ *
+ * @return the number of bytes written, or LE_OVERFLOW if bufferPtr is too small.
+ */
+//--------------------------------------------------------------------------------------------------
+static int32_t Pack7Bits
+(
+    const uint8_t* septetPtr,   ///< [IN] septets to pack
+    uint32_t       count,       ///< [IN] number of septets
+    uint8_t*       bufferPtr,   ///< [OUT] packed septets
+    size_t         bufferSize,  ///< [IN] bufferPtr size
+    bool           isCdma       ///< [IN] CDMA packing instead of GSM 03.38 packing
+)
+{
+    uint32_t size = (count * 7 + 7) / 8;
+    uint32_t r;
+
+    if (size > bufferSize)
+    {
+        return LE_OVERFLOW;
+    }
+
+    for (r = 0; r + 8 <= count; r += 8)
+    {
+        if (isCdma)
+        {
+            PackCdma7BitsBlock(&septetPtr[r], &bufferPtr[r / 8 * 7]);
+        }
+        else
+        {
+            Pack7BitsBlock(&septetPtr[r], &bufferPtr[r / 8 * 7]);
+        }
+    }
+
+    if (r < count)
+    {
+        uint8_t lastSeptets[8] = {0};
+        uint8_t lastBytes[7];
+
+        memcpy(lastSeptets, &septetPtr[r], count - r);
+
+        if (isCdma)
+        {
+            PackCdma7BitsBlock(lastSeptets, lastBytes);
+        }
+        else
+        {
+            Pack7BitsBlock(lastSeptets, lastBytes);
+        }
+
+        memcpy(&bufferPtr[r / 8 * 7], lastBytes, size - r / 8 * 7);
+    }
+
+    return size;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Unpack septets, 7 bytes into 8 septets at a time.
+ *
+ * Only the septets which don't start on a 7-byte boundary are read one at a time.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Unpack7Bits
+(
+    const uint8_t* bufferPtr,   ///< [IN] packed septets
+    uint32_t       pos,         ///< [IN] position of the first septet to unpack (in septets)
+    uint32_t       count,       ///< [IN] number of septets to unpack
+    uint8_t*       septetPtr,   ///< [OUT] unpacked septets
+    bool           isCdma       ///< [IN] CDMA packing instead of GSM 03.38 packing
+)
+{
+    uint32_t r = 0;
 
-    if (!(pos&7)) {
-        bufferPtr[idx] = val << 1;
+    while ((r < count) && ((pos + r) & 7))
+    {
+        septetPtr[r] = isCdma ? ReadCdma7Bits(bufferPtr, (pos + r) * 7)
+                              : Read7Bits(bufferPtr, (pos + r) * 7);
+        r++;
     }
-    else if ((pos&7) == 1) {
-        bufferPtr[idx] = bufferPtr[idx] | val;
+
+    for (; r + 8 <= count; r += 8)
+    {
+        if (isCdma)
+        {
+            UnpackCdma7BitsBlock(&bufferPtr[(pos + r) / 8 * 7], &septetPtr[r]);
+        }
+        else
+        {
+            Unpack7BitsBlock(&bufferPtr[(pos + r) / 8 * 7], &septetPtr[r]);
+        }
     }
-    else {
-        bufferPtr[idx] = bufferPtr[idx] | (val>>((pos&7)-1));
-        bufferPtr[idx+1] = ((val<<(8-((pos&7)-1)))&0xff);
+
+    for (; r < count; r++)
+    {
+        septetPtr[r] = isCdma ? ReadCdma7Bits(bufferPtr, (pos + r) * 7)
+                              : Read7Bits(bufferPtr, (pos + r) * 7);
     }
 }
 
@@ -649,7 +814,16 @@ static int32_t Convert8BitsTo7Bits
 {
     int read;
     int write = 0;
-    int size = 0;
+    int size;
+
+    if (length <= 0)
+    {
+        *a7bitsNumber = 0;
+        return 0;
+    }
+
+    // Each character may need an escape septet
+    uint8_t septets[2 * length];
 
     for (read = pos; read < length+pos; ++read)
     {
@@ -658,30 +832,16 @@ static int32_t Convert8BitsTo7Bits
         /* Escape */
         if (byte >= 128)
         {
-            if (size>a7bitSize)
-            {
-                return LE_OVERFLOW;
-            }
-
-            Write7Bits(a7bitPtr, 0x1B, write*7);
-            write++;
+            septets[write++] = 0x1B;
             byte -= 128;
         }
 
-        if (size>a7bitSize)
-        {
-            return LE_OVERFLOW;
-        }
-
-        Write7Bits(a7bitPtr, byte, write*7);
-        write++;
-
-        /* Number of 8 bit chars */
-        size = (write * 7);
-        size = (size % 8 != 0) ? (size/8 + 1) : (size/8);
+        septets[write++] = byte;
     }
 
-    if (size>a7bitSize)
+    size = Pack7Bits(septets, write, a7bitPtr, a7bitSize, false);
+
+    if (size == LE_OVERFLOW)
     {
         return LE_OVERFLOW;
     }
@@ -710,11 +870,19 @@ static int32_t Convert7BitsTo8Bits
     int r;
     int w;
 
+    if (length <= 0)
+    {
+        return 0;
+    }
+
+    uint8_t septets[length];
+
+    Unpack7Bits(a7bitPtr, pos, length, septets, false);
+
     w = 0;
-    for (r = pos; r < length+pos; r++)
+    for (r = 0; r < length; r++)
     {
-        uint8_t byte = Read7Bits(a7bitPtr, r*7);
-        byte = Ascii7to8[byte];
+        uint8_t byte = Ascii7to8[septets[r]];
 
         if (byte != 27)
         {
@@ -733,7 +901,7 @@ static int32_t Convert7BitsTo8Bits
             /* If we're escaped then the next byte have a special meaning. */
             r++;
 
-            byte = Read7Bits(a7bitPtr, r*7);
+            byte = (r < length) ? septets[r] : Read7Bits(a7bitPtr, (pos + r) * 7);
             if (w < a8bitSize)
             {
                 switch (byte)
@@ -1846,29 +2014,19 @@ static le_result_t EncodeCdma7BitsData
     uint8_t       *a7bitsNumber ///< [OUT] number of char in 7bitsPtr
 )
 {
-    int read;
-    int write = 0;
-    int size = 0;
+    int32_t size;
 
     memset(a7bitPtr,0,a7bitSize);
 
-    for (read = 0; read < a8bitPtrSize; ++read)
-    {
-        if (size>a7bitSize)
-        {
-            return LE_OVERFLOW;
-        }
-
-        WriteCdma7Bits(a7bitPtr, a8bitPtr[read], write*7);
-        write++;
+    size = Pack7Bits(a8bitPtr, a8bitPtrSize, a7bitPtr, a7bitSize, true);
 
-        /* Number of 8 bit chars */
-        size = (write * 7);
-        size = (size % 8 != 0) ? (size/8 + 1) : (size/8);
+    if (size == LE_OVERFLOW)
+    {
+        return LE_OVERFLOW;
     }
 
     /* Number of written chars */
-    *a7bitsNumber = write;
+    *a7bitsNumber = a8bitPtrSize;
 
     return LE_OK;
 }
@@ -1890,24 +2048,16 @@ static le_result_t DecodeCdma7bitsData
     uint32_t      *a8bitNumber   ///< [OUT] number of char written
 )
 {
-    int read;
-    int write;
-
     memset(a8bitPtr,0,a8bitSize);
 
-    for (read = 0, write = 0; read < a7bitPtrSize; read++, write++)
+    if (a7bitPtrSize > a8bitSize)
     {
-        if (write < a8bitSize)
-        {
-            a8bitPtr[write] = ReadCdma7Bits(a7bitPtr, read*7);
-        }
-        else
-        {
-            return LE_OVERFLOW;
-        }
+        return LE_OVERFLOW;
     }
 
-    *a8bitNumber = write;
+    Unpack7Bits(a7bitPtr, 0, a7bitPtrSize, a8bitPtr, true);
+
+    *a8bitNumber = a7bitPtrSize;
 
     return LE_OK;
 }
@@ -155,6 +155,30 @@ le_result_t pa_sms_RdPDUMsgFromMem
     return LE_FAULT;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * This function gets several messages from the preferred message storage.
+ *
+ * @return LE_FAULT        The function failed to get the messages from the preferred message
+ *                         storage.
+ * @return LE_TIMEOUT      No response was received from the Modem.
+ * @return LE_UNSUPPORTED  The platform can't read several messages in a single request.
+ * @return LE_OK           The function succeeded, check resultArrayPtr for each message.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pa_sms_RdPDUMsgBatchFromMem
+(
+    const uint32_t*     indexArrayPtr,  ///< [IN] The places of storage in memory.
+    uint32_t            numOfMsg,       ///< [IN] The number of messages to read.
+    pa_sms_Protocol_t   protocol,       ///< [IN] The protocol used for these messages
+    pa_sms_Storage_t    storage,        ///< [IN] SMS Storage used
+    pa_sms_Pdu_t*       msgArrayPtr,    ///< [OUT] The messages.
+    le_result_t*        resultArrayPtr  ///< [OUT] The result of the read of each message.
+)
+{
+    return LE_UNSUPPORTED;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * This function gets the indexes of messages stored in the preferred memory for a specific
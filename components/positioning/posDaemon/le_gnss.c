@@ -12,6 +12,7 @@
 #include "legato.h"
 #include "interfaces.h"
 #include "pa_gnss.h"
+#include "le_gnss_local.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -23,15 +24,14 @@
 /// Typically, we don't expect more than this number of concurrent activation requests.
 #define GNSS_POSITION_ACTIVATION_MAX      13      // Ideally should be a prime number.
 
-//--------------------------------------------------------------------------------------------------
-/**
- * NMEA node path definition
- *
- */
-//--------------------------------------------------------------------------------------------------
-#ifndef LE_GNSS_NMEA_NODE_PATH
-#define LE_GNSS_NMEA_NODE_PATH                  "/dev/nmea"
-#endif
+/// All the parameters of a position sample snapshot.
+#define SAMPLE_FIELDS_ALL  (LE_GNSS_SAMPLE_LATITUDE | LE_GNSS_SAMPLE_LONGITUDE |               \
+                            LE_GNSS_SAMPLE_HACCURACY | LE_GNSS_SAMPLE_ALTITUDE |               \
+                            LE_GNSS_SAMPLE_VACCURACY | LE_GNSS_SAMPLE_HSPEED |                 \
+                            LE_GNSS_SAMPLE_HSPEED_ACCURACY | LE_GNSS_SAMPLE_VSPEED |           \
+                            LE_GNSS_SAMPLE_VSPEED_ACCURACY | LE_GNSS_SAMPLE_DIRECTION |        \
+                            LE_GNSS_SAMPLE_DIRECTION_ACCURACY | LE_GNSS_SAMPLE_DATE |          \
+                            LE_GNSS_SAMPLE_TIME)
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -297,13 +297,6 @@ static le_dls_List_t PositionSampleList = LE_DLS_LIST_INIT;
 //--------------------------------------------------------------------------------------------------
 static le_ref_MapRef_t PositionSampleMap;
 
-//--------------------------------------------------------------------------------------------------
-/**
- * NMEA pipe file descriptor
- */
-//--------------------------------------------------------------------------------------------------
-static int NmeaPipeFd = -1;
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Position Handler destructor.
@@ -404,124 +397,6 @@ static void CreateNmeaPipe
            "Could not create %s. errno.%d (%s)", LE_GNSS_NMEA_NODE_PATH, errno, strerror(errno));
 }
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Open the NMEA pipe
- */
-//--------------------------------------------------------------------------------------------------
-static le_result_t OpenNmeaPipe
-(
-    void
-)
-{
-
-    // Check NMEA pipe file descriptor
-    if(NmeaPipeFd != -1)
-    {
-        return LE_DUPLICATE;
-    }
-
-    // Open NMEA pipe
-    do
-    {
-        if (((NmeaPipeFd=open(LE_GNSS_NMEA_NODE_PATH,
-                                O_WRONLY|O_APPEND|O_CLOEXEC|O_NONBLOCK)) == -1)
-            && (errno != EINTR))
-        {
-            LE_WARN_IF(errno != 6, "Open %s failure: errno.%d (%s)",
-                       LE_GNSS_NMEA_NODE_PATH, errno, strerror(errno));
-            return LE_FAULT;
-        }
-    }while (NmeaPipeFd==-1);
-
-    return LE_OK;
-}
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Close the NMEA pipe
- */
-//--------------------------------------------------------------------------------------------------
-static le_result_t CloseNmeaPipe
-(
-    void
-)
-{
-    le_result_t retResult = LE_OK;
-    int result;
-
-    // Check NMEA pipe file descriptor
-    if(NmeaPipeFd == -1)
-    {
-        LE_WARN("Invalid file descriptor. File already closed");
-        return LE_DUPLICATE;
-    }
-
-    // Close NMEA pipe
-    do
-    {
-        result = close(NmeaPipeFd);
-    }
-    while ((result != 0) && (errno == EINTR));
-
-    LE_ERROR_IF(result != 0, "Could not close %s. errno.%d (%s)",
-               LE_GNSS_NMEA_NODE_PATH, errno, strerror(errno));
-
-    if(result != 0)
-    {
-        retResult = LE_FAULT;
-    }
-    else
-    {
-        // Release the NMEA pipe file descriptor
-        NmeaPipeFd = -1;
-    }
-
-    return retResult;
-}
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Write the NMEA sentence to NMEA pipe
- */
-//--------------------------------------------------------------------------------------------------
-static le_result_t WriteNmeaPipe
-(
-    const char*  nmeaStringPtr          ///< [IN] Pointer to the NMEA sentence to write.
-)
-{
-    le_result_t resultNmeaPipe = LE_OK;
-    ssize_t resultWrite = 0;
-    ssize_t written = 0;
-    ssize_t stringSize = 0;
-
-    // Open the NMEA FIFO pipe
-    resultNmeaPipe = OpenNmeaPipe();
-
-    if((resultNmeaPipe == LE_OK)||(resultNmeaPipe == LE_DUPLICATE))
-    {
-        written = 0;
-        stringSize = strlen(nmeaStringPtr)+1;
-        // Write to NMEA pipe
-        while (written < stringSize)
-        {
-            resultWrite = write(NmeaPipeFd, nmeaStringPtr + written, stringSize - written);
-
-            if ((resultWrite < 0) && (errno != EINTR))
-            {
-                LE_ERROR("Could not write to %s (write error, errno.%d (%s))",
-                         LE_GNSS_NMEA_NODE_PATH, errno, strerror(errno));
-                CloseNmeaPipe();
-                return LE_FAULT;
-            }
-
-            written += resultWrite;
-        }
-    }
-
-    return LE_OK;
-}
-
 //--------------------------------------------------------------------------------------------------
 /**
  * The PA NMEA Handler.
@@ -535,10 +410,8 @@ static void PaNmeaHandler
 {
     LE_DEBUG("Handler Function called with PA NMEA %p", nmeaPtr);
 
-    // Write the NMEA sentence to the /dev/nmea device folder
-    WriteNmeaPipe(nmeaPtr);
-
-    le_mem_Release(nmeaPtr);
+    // Send the NMEA sentence to the /dev/nmea device folder and the NMEA streams
+    gnssNmea_Report(nmeaPtr);
 }
 
 
@@ -710,6 +583,9 @@ static void PaPositionHandler
     // Get the position sample data from the PA position data report
     GetPosSampleData(&LastPositionSample, positionPtr);
 
+    // Keep the fix in the position history
+    gnssHistory_Record(positionPtr);
+
     if(!NumOfPositionHandlers)
     {
         LE_DEBUG("No positioning handlers, exit Handler Function");
@@ -819,6 +695,9 @@ static void CloseSessionEventHandler
         // Get the next value in the reference mpa.
         result = le_ref_NextNode(iterRef);
     }
+
+    // Close the NMEA streams of the client session.
+    gnssNmea_CloseSession(sessionRef);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -925,6 +804,9 @@ le_result_t gnss_Init
     // Create the reference HashMap for positioning sample
     PositionSampleMap = le_ref_CreateMap("PositionSampleMap", GNSS_POSITION_SAMPLE_MAX);
 
+    // Initialize the NMEA streams
+    gnssNmea_Init();
+
     // Initialize the event client close function handler.
     le_msg_ServiceRef_t msgService = le_gnss_GetServiceRef();
     le_msg_AddServiceCloseHandler(msgService, CloseSessionEventHandler, NULL);
@@ -951,7 +833,11 @@ le_result_t gnss_Init
     // That node is a FIFO (named pipe): it will be managed from Legato (User space).
     if ((resultStat == 0) && (S_ISFIFO(nmeaFileStat.st_mode))) // FIFO (named pipe)
     {
-         if ((PaNmeaHandlerRef=pa_gnss_AddNmeaHandler(PaNmeaHandler)) == NULL)
+         if ((PaNmeaHandlerRef=pa_gnss_AddNmeaHandler(PaNmeaHandler)) != NULL)
+         {
+             gnssNmea_Start();
+         }
+         else
          {
              LE_ERROR("Failed to add PA NMEA handler!");
          }
@@ -966,6 +852,7 @@ le_result_t gnss_Init
         {
             // Create NMEA device folder
             CreateNmeaPipe();
+            gnssNmea_Start();
         }
         else
         {
@@ -1957,6 +1844,245 @@ le_result_t le_gnss_GetDirection
     return result;
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the position sample's fix state, location, altitude, date, time, speeds and direction in a
+ * single call.
+ *
+ * @return
+ *  - LE_FAULT         Function failed to find the positionSample.
+ *  - LE_OUT_OF_RANGE  At least one of the retrieved parameters is invalid.
+ *  - LE_OK            Function succeeded, all the parameters are valid.
+ *
+ * @note The parameters have the same resolutions as with the individual functions. An invalid
+ *       parameter is set to the same value as the individual function sets it to, and its bit is
+ *       cleared in validFieldsPtr.
+ *
+ * @note If the caller is passing an invalid Position sample reference or a null pointer into this
+ *       function, it is a fatal error, the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gnss_GetSnapshot
+(
+    le_gnss_SampleRef_t positionSampleRef,
+        ///< [IN]
+        ///< Position sample's reference.
+
+    le_gnss_SampleFieldBitMask_t* validFieldsPtr,
+        ///< [OUT]
+        ///< Valid parameters.
+
+    le_gnss_FixState_t* statePtr,
+        ///< [OUT]
+        ///< Position fix state.
+
+    int32_t* latitudePtr,
+        ///< [OUT]
+        ///< WGS84 Latitude in degrees, positive North [resolution 1e-6].
+
+    int32_t* longitudePtr,
+        ///< [OUT]
+        ///< WGS84 Longitude in degrees, positive East [resolution 1e-6].
+
+    int32_t* hAccuracyPtr,
+        ///< [OUT]
+        ///< Horizontal position's accuracy in meters [resolution 1e-2].
+
+    int32_t* altitudePtr,
+        ///< [OUT]
+        ///< Altitude in meters, above Mean Sea Level [resolution 1e-3].
+
+    int32_t* vAccuracyPtr,
+        ///< [OUT]
+        ///< Vertical position's accuracy in meters [resolution 1e-1].
+
+    uint32_t* hspeedPtr,
+        ///< [OUT]
+        ///< Horizontal speed in meters/second [resolution 1e-2].
+
+    uint32_t* hspeedAccuracyPtr,
+        ///< [OUT]
+        ///< Horizontal speed's accuracy estimate in meters/second [resolution 1e-1].
+
+    int32_t* vspeedPtr,
+        ///< [OUT]
+        ///< Vertical speed in meters/second [resolution 1e-2], positive up.
+
+    int32_t* vspeedAccuracyPtr,
+        ///< [OUT]
+        ///< Vertical speed's accuracy estimate in meters/second [resolution 1e-1].
+
+    uint32_t* directionPtr,
+        ///< [OUT]
+        ///< Direction in degrees [resolution 1e-1]. Range: 0 to 359.9, where 0 is True North.
+
+    uint32_t* directionAccuracyPtr,
+        ///< [OUT]
+        ///< Direction's accuracy estimate in degrees [resolution 1e-1].
+
+    uint16_t* yearPtr,
+        ///< [OUT]
+        ///< UTC Year A.D. [e.g. 2014].
+
+    uint16_t* monthPtr,
+        ///< [OUT]
+        ///< UTC Month into the year [range 1...12].
+
+    uint16_t* dayPtr,
+        ///< [OUT]
+        ///< UTC Days into the month [range 1...31].
+
+    uint16_t* hoursPtr,
+        ///< [OUT]
+        ///< UTC Hours into the day [range 0..23].
+
+    uint16_t* minutesPtr,
+        ///< [OUT]
+        ///< UTC Minutes into the hour [range 0..59].
+
+    uint16_t* secondsPtr,
+        ///< [OUT]
+        ///< UTC Seconds into the minute [range 0..59].
+
+    uint16_t* millisecondsPtr
+        ///< [OUT]
+        ///< UTC Milliseconds into the second [range 0..999].
+)
+{
+    le_result_t result = LE_OK;
+    le_gnss_SampleFieldBitMask_t validFields = 0;
+    le_gnss_PositionSample_t* samplePtr;
+    le_gnss_PositionSampleRequest_t* positionSampleRequestNodePtr
+                                            = le_ref_Lookup(PositionSampleMap,positionSampleRef);
+
+    // Check input pointers
+    if ((NULL == validFieldsPtr) || (NULL == statePtr)
+        || (NULL == latitudePtr) || (NULL == longitudePtr) || (NULL == hAccuracyPtr)
+        || (NULL == altitudePtr) || (NULL == vAccuracyPtr)
+        || (NULL == hspeedPtr) || (NULL == hspeedAccuracyPtr)
+        || (NULL == vspeedPtr) || (NULL == vspeedAccuracyPtr)
+        || (NULL == directionPtr) || (NULL == directionAccuracyPtr)
+        || (NULL == yearPtr) || (NULL == monthPtr) || (NULL == dayPtr)
+        || (NULL == hoursPtr) || (NULL == minutesPtr) || (NULL == secondsPtr)
+        || (NULL == millisecondsPtr))
+    {
+        LE_KILL_CLIENT("Invalid pointer provided!");
+        return LE_FAULT;
+    }
+
+    // Check position sample's reference
+    result = ValidatePositionSamplePtr(positionSampleRequestNodePtr);
+    if (LE_OK != result)
+    {
+        return result;
+    }
+
+    samplePtr = positionSampleRequestNodePtr->positionSampleNodePtr;
+
+    *statePtr = samplePtr->fixState;
+
+    *latitudePtr = INT32_MAX;
+    if (samplePtr->latitudeValid)
+    {
+        *latitudePtr = samplePtr->latitude;
+        validFields |= LE_GNSS_SAMPLE_LATITUDE;
+    }
+    *longitudePtr = INT32_MAX;
+    if (samplePtr->longitudeValid)
+    {
+        *longitudePtr = samplePtr->longitude;
+        validFields |= LE_GNSS_SAMPLE_LONGITUDE;
+    }
+    *hAccuracyPtr = INT32_MAX;
+    if (samplePtr->hAccuracyValid)
+    {
+        *hAccuracyPtr = samplePtr->hAccuracy;
+        validFields |= LE_GNSS_SAMPLE_HACCURACY;
+    }
+    *altitudePtr = INT32_MAX;
+    if (samplePtr->altitudeValid)
+    {
+        *altitudePtr = samplePtr->altitude;
+        validFields |= LE_GNSS_SAMPLE_ALTITUDE;
+    }
+    *vAccuracyPtr = INT32_MAX;
+    if (samplePtr->vAccuracyValid)
+    {
+        *vAccuracyPtr = samplePtr->vAccuracy;
+        validFields |= LE_GNSS_SAMPLE_VACCURACY;
+    }
+    *hspeedPtr = UINT32_MAX;
+    if (samplePtr->hSpeedValid)
+    {
+        *hspeedPtr = samplePtr->hSpeed;
+        validFields |= LE_GNSS_SAMPLE_HSPEED;
+    }
+    *hspeedAccuracyPtr = UINT32_MAX;
+    if (samplePtr->hSpeedAccuracyValid)
+    {
+        *hspeedAccuracyPtr = samplePtr->hSpeedAccuracy;
+        validFields |= LE_GNSS_SAMPLE_HSPEED_ACCURACY;
+    }
+    *vspeedPtr = INT32_MAX;
+    if (samplePtr->vSpeedValid)
+    {
+        *vspeedPtr = samplePtr->vSpeed;
+        validFields |= LE_GNSS_SAMPLE_VSPEED;
+    }
+    *vspeedAccuracyPtr = INT32_MAX;
+    if (samplePtr->vSpeedAccuracyValid)
+    {
+        *vspeedAccuracyPtr = samplePtr->vSpeedAccuracy;
+        validFields |= LE_GNSS_SAMPLE_VSPEED_ACCURACY;
+    }
+    *directionPtr = UINT32_MAX;
+    if (samplePtr->directionValid)
+    {
+        *directionPtr = samplePtr->direction;
+        validFields |= LE_GNSS_SAMPLE_DIRECTION;
+    }
+    *directionAccuracyPtr = UINT32_MAX;
+    if (samplePtr->directionAccuracyValid)
+    {
+        *directionAccuracyPtr = samplePtr->directionAccuracy;
+        validFields |= LE_GNSS_SAMPLE_DIRECTION_ACCURACY;
+    }
+
+    if (samplePtr->dateValid)
+    {
+        *yearPtr = samplePtr->year;
+        *monthPtr = samplePtr->month;
+        *dayPtr = samplePtr->day;
+        validFields |= LE_GNSS_SAMPLE_DATE;
+    }
+    else
+    {
+        *yearPtr = 0;
+        *monthPtr = 0;
+        *dayPtr = 0;
+    }
+
+    if (samplePtr->timeValid)
+    {
+        *hoursPtr = samplePtr->hours;
+        *minutesPtr = samplePtr->minutes;
+        *secondsPtr = samplePtr->seconds;
+        *millisecondsPtr = samplePtr->milliseconds;
+        validFields |= LE_GNSS_SAMPLE_TIME;
+    }
+    else
+    {
+        *hoursPtr = 0;
+        *minutesPtr = 0;
+        *secondsPtr = 0;
+        *millisecondsPtr = 0;
+    }
+
+    *validFieldsPtr = validFields;
+
+    return (validFields == SAMPLE_FIELDS_ALL) ? LE_OK : LE_OUT_OF_RANGE;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the Satellites Vehicle information.
@@ -3089,6 +3215,9 @@ le_result_t le_gnss_Stop
                 memset(&LastPositionSample, 0, sizeof(LastPositionSample));
                 LastPositionSample.fixState = LE_GNSS_STATE_FIX_NO_POS;
 
+                // Save the last fixes of the position history
+                gnssHistory_Flush();
+
                 GnssState = LE_GNSS_STATE_READY;
             }
         }
@@ -0,0 +1,530 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file le_gnssHistory.c
+ *
+ * This file contains the source code of the position history of the GNSS API.
+ *
+ * The fixes are kept in chronological order in a ring of HistoryFix_t, so that the first fix of a
+ * time range is found by a binary search. When a history file is configured, the ring is mirrored
+ * in the file: the fixes are written to their slot every HISTORY_FLUSH_COUNT fixes, and the ring
+ * is rebuilt from the slots at startup.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+
+#include "legato.h"
+#include "interfaces.h"
+#include "le_gnss_local.h"
+
+
+//--------------------------------------------------------------------------------------------------
+// Symbol and Enum definitions.
+//--------------------------------------------------------------------------------------------------
+
+/// History file identifier ("GNSH") and format version.
+#define HISTORY_FILE_MAGIC          0x48534e47
+#define HISTORY_FILE_VERSION        1
+
+/// Number of fixes between two writes of the history file (one minute at 1 Hz).
+#define HISTORY_FLUSH_COUNT         60
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Compact fix of the position history: 32 bytes.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t epochTime;     ///< Milliseconds since Jan. 1, 1970, 0 for an empty slot.
+    int32_t  latitude;      ///< WGS84 Latitude in degrees [resolution 1e-6].
+    int32_t  longitude;     ///< WGS84 Longitude in degrees [resolution 1e-6].
+    int32_t  altitude;      ///< Altitude in meters [resolution 1e-3], INT32_MAX if unknown.
+    uint16_t hAccuracy;     ///< Horizontal accuracy in meters [resolution 1e-2], UINT16_MAX if
+                            ///  unknown.
+    uint16_t hSpeed;        ///< Horizontal speed in m/s [resolution 1e-2], UINT16_MAX if unknown.
+    uint16_t direction;     ///< Direction in degrees [resolution 1e-1], UINT16_MAX if unknown.
+    uint16_t reserved[3];   ///< Set to 0.
+}
+HistoryFix_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * History file header, followed by the slots of the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t magic;         ///< HISTORY_FILE_MAGIC.
+    uint16_t version;       ///< HISTORY_FILE_VERSION.
+    uint16_t fixSize;       ///< sizeof(HistoryFix_t).
+    uint32_t capacity;      ///< Number of slots.
+    uint32_t reserved;      ///< Set to 0.
+}
+HistoryFileHeader_t;
+
+//--------------------------------------------------------------------------------------------------
+// Static declarations.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ring of fixes, NULL if the position history is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+static HistoryFix_t* HistoryPtr = NULL;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of slots of the ring, number of fixes in the ring and slot of the next fix.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t Capacity = 0;
+static uint32_t Count = 0;
+static uint32_t NextSlot = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * History file descriptor, -1 if the history is not saved, and number of fixes not yet saved.
+ */
+//--------------------------------------------------------------------------------------------------
+static int      HistoryFd = -1;
+static uint32_t UnsavedCount = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a fix of the ring by its chronological index, 0 being the oldest fix.
+ */
+//--------------------------------------------------------------------------------------------------
+static HistoryFix_t* GetFix
+(
+    uint32_t index
+)
+{
+    return &HistoryPtr[(NextSlot + Capacity - Count + index) % Capacity];
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Convert an unsigned value of a PA position report to a 16-bit value of a compact fix.
+ *
+ * @return The value, limited to UINT16_MAX - 1, or UINT16_MAX if it is unknown.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint16_t CompactValue
+(
+    bool     isValid,
+    uint32_t value
+)
+{
+    if (!isValid)
+    {
+        return UINT16_MAX;
+    }
+    return (value < UINT16_MAX) ? value : (UINT16_MAX - 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the first fix of the ring not older than a given time.
+ *
+ * @return Chronological index of the fix, Count if there is none.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t FindFix
+(
+    uint64_t epochTime      ///< [IN] Milliseconds since Jan. 1, 1970.
+)
+{
+    uint32_t low = 0;
+    uint32_t high = Count;
+
+    while (low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+
+        if (GetFix(middle)->epochTime < epochTime)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write consecutive slots of the ring to the history file.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteSlots
+(
+    uint32_t slot,
+    uint32_t slotCount
+)
+{
+    off_t   offset = sizeof(HistoryFileHeader_t) + (off_t)slot * sizeof(HistoryFix_t);
+    ssize_t size = (ssize_t)slotCount * sizeof(HistoryFix_t);
+
+    if (size != pwrite(HistoryFd, &HistoryPtr[slot], size, offset))
+    {
+        LE_ERROR("Failed to write the position history: %m");
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the history file and load its fixes in the ring. The file is reset if it does not match
+ * the ring, and the history is kept in memory only if it can't be opened.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadHistoryFile
+(
+    const char* filePathPtr
+)
+{
+    HistoryFileHeader_t header;
+    ssize_t size = (ssize_t)Capacity * sizeof(HistoryFix_t);
+    uint32_t newestSlot = 0;
+    uint32_t slot;
+    uint32_t i;
+
+    HistoryFd = open(filePathPtr, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (-1 == HistoryFd)
+    {
+        LE_ERROR("Failed to open position history file '%s': %m", filePathPtr);
+        return;
+    }
+
+    if ((sizeof(header) != read(HistoryFd, &header, sizeof(header))) ||
+        (HISTORY_FILE_MAGIC != header.magic) || (HISTORY_FILE_VERSION != header.version) ||
+        (sizeof(HistoryFix_t) != header.fixSize) || (Capacity != header.capacity) ||
+        (size != pread(HistoryFd, HistoryPtr, size, sizeof(header))))
+    {
+        LE_INFO("Reset position history file '%s'", filePathPtr);
+        memset(HistoryPtr, 0, size);
+        memset(&header, 0, sizeof(header));
+        header.magic = HISTORY_FILE_MAGIC;
+        header.version = HISTORY_FILE_VERSION;
+        header.fixSize = sizeof(HistoryFix_t);
+        header.capacity = Capacity;
+
+        // Empty slots are zero-filled by the truncation.
+        if ((0 != ftruncate(HistoryFd, 0)) ||
+            (sizeof(header) != pwrite(HistoryFd, &header, sizeof(header), 0)) ||
+            (0 != ftruncate(HistoryFd, sizeof(header) + size)))
+        {
+            LE_ERROR("Failed to reset position history file '%s': %m", filePathPtr);
+            close(HistoryFd);
+            HistoryFd = -1;
+        }
+        return;
+    }
+
+    // The newest fix ends the ring
+    for (slot = 0; slot < Capacity; slot++)
+    {
+        if (0 != HistoryPtr[slot].epochTime)
+        {
+            Count++;
+            if (HistoryPtr[slot].epochTime > HistoryPtr[newestSlot].epochTime)
+            {
+                newestSlot = slot;
+            }
+        }
+    }
+    NextSlot = (Count > 0) ? ((newestSlot + 1) % Capacity) : 0;
+
+    // Check that the fixes are in chronological order, as the ring is only written in order.
+    for (i = 1; i < Count; i++)
+    {
+        if ((0 == GetFix(i - 1)->epochTime) || (GetFix(i - 1)->epochTime >= GetFix(i)->epochTime))
+        {
+            LE_WARN("Position history file '%s' is corrupted, discard it", filePathPtr);
+            memset(HistoryPtr, 0, size);
+            Count = 0;
+            NextSlot = 0;
+            WriteSlots(0, Capacity);
+            break;
+        }
+    }
+
+    LE_INFO("%u fixes loaded from position history file '%s'", Count, filePathPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the position history, or change its configuration.
+ *
+ * @return
+ *  - LE_OK      The function succeeded.
+ *  - LE_FAULT   The ring could not be allocated, the history is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t gnssHistory_Init
+(
+    uint32_t    capacity,       ///< [IN] Number of fixes of the ring, 0 to disable the history.
+    const char* filePathPtr     ///< [IN] History file path, NULL or empty to keep the history in
+                                ///       memory only.
+)
+{
+    // Release the previous history
+    gnssHistory_Flush();
+    if (-1 != HistoryFd)
+    {
+        close(HistoryFd);
+        HistoryFd = -1;
+    }
+    free(HistoryPtr);
+    HistoryPtr = NULL;
+    Capacity = 0;
+    Count = 0;
+    NextSlot = 0;
+    UnsavedCount = 0;
+
+    if (0 == capacity)
+    {
+        LE_DEBUG("Position history disabled");
+        return LE_OK;
+    }
+
+    HistoryPtr = calloc(capacity, sizeof(HistoryFix_t));
+    if (NULL == HistoryPtr)
+    {
+        LE_ERROR("Failed to allocate a position history of %u fixes", capacity);
+        return LE_FAULT;
+    }
+    Capacity = capacity;
+
+    if ((NULL != filePathPtr) && ('\0' != filePathPtr[0]))
+    {
+        LoadHistoryFile(filePathPtr);
+    }
+
+    LE_INFO("Position history of %u fixes, %zu bytes", Capacity,
+            (size_t)Capacity * sizeof(HistoryFix_t));
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a PA position report to the position history, if it has a location and a time.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssHistory_Record
+(
+    const pa_Gnss_Position_t* positionPtr   ///< [IN] The PA position data report.
+)
+{
+    HistoryFix_t* fixPtr;
+
+    if ((0 == Capacity) || (!positionPtr->latitudeValid) || (!positionPtr->longitudeValid) ||
+        (!positionPtr->timeValid) || (0 == positionPtr->epochTime))
+    {
+        return;
+    }
+
+    // Keep the ring in chronological order
+    if ((Count > 0) && (positionPtr->epochTime <= GetFix(Count - 1)->epochTime))
+    {
+        LE_DEBUG("Fix at %"PRIu64" ms is not newer than the history", positionPtr->epochTime);
+        return;
+    }
+
+    fixPtr = &HistoryPtr[NextSlot];
+    memset(fixPtr, 0, sizeof(*fixPtr));
+    fixPtr->epochTime = positionPtr->epochTime;
+    fixPtr->latitude = positionPtr->latitude;
+    fixPtr->longitude = positionPtr->longitude;
+    fixPtr->altitude = positionPtr->altitudeValid ? positionPtr->altitude : INT32_MAX;
+    fixPtr->hAccuracy = CompactValue(positionPtr->hUncertaintyValid, positionPtr->hUncertainty);
+    fixPtr->hSpeed = CompactValue(positionPtr->hSpeedValid, positionPtr->hSpeed);
+    fixPtr->direction = CompactValue(positionPtr->directionValid, positionPtr->direction);
+
+    NextSlot = (NextSlot + 1) % Capacity;
+    if (Count < Capacity)
+    {
+        Count++;
+    }
+
+    if (-1 != HistoryFd)
+    {
+        UnsavedCount++;
+        if (UnsavedCount >= HISTORY_FLUSH_COUNT)
+        {
+            gnssHistory_Flush();
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the fixes not yet saved to the history file.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssHistory_Flush
+(
+    void
+)
+{
+    uint32_t unsavedCount;
+    uint32_t firstSlot;
+    uint32_t slotCount;
+
+    if ((-1 == HistoryFd) || (0 == UnsavedCount))
+    {
+        return;
+    }
+
+    unsavedCount = (UnsavedCount < Capacity) ? UnsavedCount : Capacity;
+    firstSlot = (NextSlot + Capacity - unsavedCount) % Capacity;
+
+    // The unsaved slots may wrap around the end of the ring.
+    slotCount = Capacity - firstSlot;
+    if (slotCount > unsavedCount)
+    {
+        slotCount = unsavedCount;
+    }
+    WriteSlots(firstSlot, slotCount);
+    if (unsavedCount > slotCount)
+    {
+        WriteSlots(0, unsavedCount - slotCount);
+    }
+
+    if (0 != fdatasync(HistoryFd))
+    {
+        LE_ERROR("Failed to sync the position history: %m");
+    }
+
+    UnsavedCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+// APIs.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a batch of fixes from the position history.
+ *
+ * The fixes are returned in chronological order. With a non null minimum interval, a fix is
+ * skipped when it is less than that interval after the previous returned fix.
+ *
+ * @return
+ *  - LE_OK            All the fixes of the time range have been returned.
+ *  - LE_OVERFLOW      The arrays are full and the time range has more fixes: call again with
+ *                     startTime set to the last returned epochTime plus 1 (or plus minInterval).
+ *  - LE_UNAVAILABLE   The position history is disabled.
+ *  - LE_BAD_PARAMETER The time range is invalid.
+ *  - LE_FAULT         An array pointer is NULL or the arrays have different sizes.
+ *
+ * @note Unknown values are set to INT32_MAX for hAccuracy and altitude, and to UINT32_MAX for
+ *       hSpeed and direction.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_gnss_GetPositionHistory
+(
+    uint64_t  startTime,                ///< [IN] Start of the time range (included), in
+                                        ///       milliseconds since Jan. 1, 1970.
+    uint64_t  stopTime,                 ///< [IN] End of the time range (included), in
+                                        ///       milliseconds since Jan. 1, 1970.
+    uint32_t  minInterval,              ///< [IN] Minimum interval between two returned fixes in
+                                        ///       milliseconds, 0 for all fixes.
+    uint64_t* epochTimePtr,             ///< [OUT] Milliseconds since Jan. 1, 1970.
+    size_t*   epochTimeNumElementsPtr,  ///< [INOUT]
+    int32_t*  latitudePtr,              ///< [OUT] WGS84 Latitude in degrees [resolution 1e-6].
+    size_t*   latitudeNumElementsPtr,   ///< [INOUT]
+    int32_t*  longitudePtr,             ///< [OUT] WGS84 Longitude in degrees [resolution 1e-6].
+    size_t*   longitudeNumElementsPtr,  ///< [INOUT]
+    int32_t*  hAccuracyPtr,             ///< [OUT] Horizontal accuracy in meters
+                                        ///        [resolution 1e-2].
+    size_t*   hAccuracyNumElementsPtr,  ///< [INOUT]
+    int32_t*  altitudePtr,              ///< [OUT] Altitude in meters [resolution 1e-3].
+    size_t*   altitudeNumElementsPtr,   ///< [INOUT]
+    uint32_t* hSpeedPtr,                ///< [OUT] Horizontal speed in m/s [resolution 1e-2].
+    size_t*   hSpeedNumElementsPtr,     ///< [INOUT]
+    uint32_t* directionPtr,             ///< [OUT] Direction in degrees [resolution 1e-1].
+    size_t*   directionNumElementsPtr   ///< [INOUT]
+)
+{
+    le_result_t result = LE_OK;
+    size_t maxCount;
+    size_t fixCount = 0;
+    uint32_t index;
+
+    if ((NULL == epochTimePtr) || (NULL == epochTimeNumElementsPtr) ||
+        (NULL == latitudePtr) || (NULL == latitudeNumElementsPtr) ||
+        (NULL == longitudePtr) || (NULL == longitudeNumElementsPtr) ||
+        (NULL == hAccuracyPtr) || (NULL == hAccuracyNumElementsPtr) ||
+        (NULL == altitudePtr) || (NULL == altitudeNumElementsPtr) ||
+        (NULL == hSpeedPtr) || (NULL == hSpeedNumElementsPtr) ||
+        (NULL == directionPtr) || (NULL == directionNumElementsPtr))
+    {
+        LE_KILL_CLIENT("Invalid pointer provided!");
+        return LE_FAULT;
+    }
+
+    // All the arrays have the same size
+    maxCount = *epochTimeNumElementsPtr;
+    if ((*latitudeNumElementsPtr != maxCount) || (*longitudeNumElementsPtr != maxCount) ||
+        (*hAccuracyNumElementsPtr != maxCount) || (*altitudeNumElementsPtr != maxCount) ||
+        (*hSpeedNumElementsPtr != maxCount) || (*directionNumElementsPtr != maxCount))
+    {
+        LE_KILL_CLIENT("Arrays of different sizes provided!");
+        return LE_FAULT;
+    }
+
+    if (0 == Capacity)
+    {
+        result = LE_UNAVAILABLE;
+    }
+    else if (startTime > stopTime)
+    {
+        LE_ERROR("Invalid time range [%"PRIu64", %"PRIu64"]", startTime, stopTime);
+        result = LE_BAD_PARAMETER;
+    }
+    else
+    {
+        index = FindFix(startTime);
+        while ((index < Count) && (GetFix(index)->epochTime <= stopTime))
+        {
+            HistoryFix_t* fixPtr = GetFix(index);
+
+            if (fixCount == maxCount)
+            {
+                result = LE_OVERFLOW;
+                break;
+            }
+
+            epochTimePtr[fixCount] = fixPtr->epochTime;
+            latitudePtr[fixCount] = fixPtr->latitude;
+            longitudePtr[fixCount] = fixPtr->longitude;
+            hAccuracyPtr[fixCount] = (UINT16_MAX == fixPtr->hAccuracy) ?
+                                     INT32_MAX : fixPtr->hAccuracy;
+            altitudePtr[fixCount] = fixPtr->altitude;
+            hSpeedPtr[fixCount] = (UINT16_MAX == fixPtr->hSpeed) ? UINT32_MAX : fixPtr->hSpeed;
+            directionPtr[fixCount] = (UINT16_MAX == fixPtr->direction) ?
+                                     UINT32_MAX : fixPtr->direction;
+            fixCount++;
+
+            // Skip the fixes less than minInterval after this one
+            index = (0 == minInterval) ? (index + 1) : FindFix(fixPtr->epochTime + minInterval);
+        }
+    }
+
+    *epochTimeNumElementsPtr = fixCount;
+    *latitudeNumElementsPtr = fixCount;
+    *longitudeNumElementsPtr = fixCount;
+    *hAccuracyNumElementsPtr = fixCount;
+    *altitudeNumElementsPtr = fixCount;
+    *hSpeedNumElementsPtr = fixCount;
+    *directionNumElementsPtr = fixCount;
+
+    return result;
+}
@@ -0,0 +1,641 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file le_gnssNmea.c
+ *
+ * This file contains the source code of the NMEA flow of the GNSS API.
+ *
+ * The NMEA frames reported by the PA are kept in a ring of NMEA_RING_SIZE frames, without being
+ * copied: the ring holds a reference on the PA buffer until the frame is overwritten. Each reader
+ * (the /dev/nmea named pipe, and the NMEA streams opened by the clients) has a cursor in the ring
+ * and a non-blocking file descriptor. The frames are written to a reader until its file descriptor
+ * is full; the reader then waits for it to be writable again, and loses the frames overwritten in
+ * the meantime. A slow reader therefore never blocks the PA handler nor the other readers.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+
+#include "legato.h"
+#include "interfaces.h"
+#include "le_gnss_local.h"
+
+#include <sys/socket.h>
+
+
+//--------------------------------------------------------------------------------------------------
+// Symbol and Enum definitions.
+//--------------------------------------------------------------------------------------------------
+
+/// Number of NMEA frames kept for the readers which do not keep up.
+#define NMEA_RING_SIZE              64
+
+/// Maximum number of NMEA streams.
+#define NMEA_STREAM_MAX             16
+
+/// Length of the address field of an NMEA sentence ("GPGGA" in "$GPGGA,...").
+#define NMEA_ADDRESS_LEN            5
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * NMEA frame of the ring.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char*                   framePtr;       ///< PA buffer, NULL for an empty slot.
+    size_t                  frameSize;      ///< Frame size, including the NUL terminator.
+    le_gnss_NmeaBitMask_t   sentenceType;   ///< Sentence type, 0 if not in le_gnss_NmeaBitMask_t.
+}
+NmeaFrame_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * NMEA reader structure.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_gnss_NmeaStreamRef_t ref;            ///< Stream reference, NULL for the NMEA pipe.
+    le_msg_SessionRef_t     sessionRef;     ///< Client session identifier.
+    int                     fd;             ///< Write end of the stream, -1 if closed.
+    le_fdMonitor_Ref_t      monitorRef;     ///< Monitor of fd.
+    bool                    isWaiting;      ///< True while waiting for fd to be writable.
+    le_gnss_NmeaBitMask_t   filterMask;     ///< Sentences to send, 0 for all of them.
+    uint64_t                nextFrame;      ///< Sequence number of the next frame to send.
+    char*                   partialPtr;     ///< Frame partially written to the named pipe.
+    size_t                  partialOffset;  ///< Bytes of partialPtr already written.
+    uint64_t                lostCount;      ///< Frames overwritten before being sent.
+    le_dls_Link_t           link;           ///< Link in StreamList.
+}
+NmeaReader_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sentence types of le_gnss_NmeaBitMask_t, by address field.
+ */
+//--------------------------------------------------------------------------------------------------
+static const struct
+{
+    const char*             address;
+    le_gnss_NmeaBitMask_t   mask;
+}
+SentenceTypes[] =
+{
+    { "GPGGA", LE_GNSS_NMEA_MASK_GPGGA },
+    { "GPGSA", LE_GNSS_NMEA_MASK_GPGSA },
+    { "GPGSV", LE_GNSS_NMEA_MASK_GPGSV },
+    { "GPRMC", LE_GNSS_NMEA_MASK_GPRMC },
+    { "GPVTG", LE_GNSS_NMEA_MASK_GPVTG },
+    { "GLGSV", LE_GNSS_NMEA_MASK_GLGSV },
+    { "GNGNS", LE_GNSS_NMEA_MASK_GNGNS },
+    { "GNGSA", LE_GNSS_NMEA_MASK_GNGSA },
+    { "GAGGA", LE_GNSS_NMEA_MASK_GAGGA },
+    { "GAGSA", LE_GNSS_NMEA_MASK_GAGSA },
+    { "GAGSV", LE_GNSS_NMEA_MASK_GAGSV },
+    { "GARMC", LE_GNSS_NMEA_MASK_GARMC },
+    { "GAVTG", LE_GNSS_NMEA_MASK_GAVTG },
+    { "GPGRS", LE_GNSS_NMEA_MASK_GPGRS },
+    { "GPGLL", LE_GNSS_NMEA_MASK_GPGLL },
+    { "PSTIS", LE_GNSS_NMEA_MASK_PSTIS },
+    { "PQXFI", LE_GNSS_NMEA_MASK_PQXFI | LE_GNSS_NMEA_MASK_PTYPE },
+};
+
+//--------------------------------------------------------------------------------------------------
+//                                       Static declarations
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Ring of the last NMEA frames, and sequence number of the next frame. The frame of sequence
+ * number N is in NmeaRing[N % NMEA_RING_SIZE].
+ */
+//--------------------------------------------------------------------------------------------------
+static NmeaFrame_t NmeaRing[NMEA_RING_SIZE];
+static uint64_t    NextFrame = 0;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * True once the PA reports the NMEA frames to the positioning service.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool NmeaStarted = false;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reader of the /dev/nmea named pipe.
+ */
+//--------------------------------------------------------------------------------------------------
+static NmeaReader_t PipeReader =
+{
+    .fd = -1,
+};
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory Pool and Safe Reference Map for NMEA streams, and list of the NMEA streams.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t NmeaStreamPoolRef;
+static le_ref_MapRef_t  NmeaStreamMap;
+static le_dls_List_t    StreamList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the sentence type of an NMEA frame.
+ *
+ * @return The sentence type, 0 if the sentence is not in le_gnss_NmeaBitMask_t.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_gnss_NmeaBitMask_t GetSentenceType
+(
+    const char* framePtr    ///< [IN] NMEA frame.
+)
+{
+    size_t i;
+
+    if ('$' != framePtr[0])
+    {
+        return 0;
+    }
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(SentenceTypes); i++)
+    {
+        if (0 == strncmp(framePtr + 1, SentenceTypes[i].address, NMEA_ADDRESS_LEN))
+        {
+            return SentenceTypes[i].mask;
+        }
+    }
+
+    // All the other proprietary sentences.
+    if ('P' == framePtr[1])
+    {
+        return LE_GNSS_NMEA_MASK_PTYPE;
+    }
+
+    return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close a file descriptor.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseFd
+(
+    int fd      ///< [IN] File descriptor.
+)
+{
+    int result;
+
+    do
+    {
+        result = close(fd);
+    }
+    while ((result != 0) && (errno == EINTR));
+
+    LE_ERROR_IF(result != 0, "Could not close fd %d. errno.%d (%s)", fd, errno, strerror(errno));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the file descriptor of a reader. A stream stays allocated until it is closed by its
+ * client, but does not get any frame anymore.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseReader
+(
+    NmeaReader_t* readerPtr     ///< [IN] NMEA reader.
+)
+{
+    if (-1 == readerPtr->fd)
+    {
+        return;
+    }
+
+    if (readerPtr->lostCount)
+    {
+        LE_INFO("NMEA reader %p lost %" PRIu64 " frames", readerPtr->ref, readerPtr->lostCount);
+    }
+
+    le_fdMonitor_Delete(readerPtr->monitorRef);
+    readerPtr->monitorRef = NULL;
+    CloseFd(readerPtr->fd);
+    readerPtr->fd = -1;
+    readerPtr->isWaiting = false;
+
+    if (readerPtr->partialPtr)
+    {
+        le_mem_Release(readerPtr->partialPtr);
+        readerPtr->partialPtr = NULL;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the pending NMEA frames to a reader, until its file descriptor is full.
+ *
+ * @return true if all the frames have been written, false if the file descriptor is full.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool WriteFrames
+(
+    NmeaReader_t* readerPtr     ///< [IN] NMEA reader.
+)
+{
+    const char* dataPtr;
+    size_t size;
+    ssize_t written;
+
+    while (-1 != readerPtr->fd)
+    {
+        if (readerPtr->partialPtr)
+        {
+            // Only the named pipe can be partially written.
+            dataPtr = readerPtr->partialPtr + readerPtr->partialOffset;
+            size = strlen(readerPtr->partialPtr) + 1 - readerPtr->partialOffset;
+        }
+        else
+        {
+            NmeaFrame_t* framePtr;
+
+            if (readerPtr->nextFrame == NextFrame)
+            {
+                return true;
+            }
+
+            if ((NextFrame - readerPtr->nextFrame) > NMEA_RING_SIZE)
+            {
+                readerPtr->lostCount += NextFrame - NMEA_RING_SIZE - readerPtr->nextFrame;
+                readerPtr->nextFrame = NextFrame - NMEA_RING_SIZE;
+            }
+
+            framePtr = &NmeaRing[readerPtr->nextFrame % NMEA_RING_SIZE];
+            if ((readerPtr->filterMask) && (0 == (readerPtr->filterMask & framePtr->sentenceType)))
+            {
+                readerPtr->nextFrame++;
+                continue;
+            }
+            dataPtr = framePtr->framePtr;
+            size = framePtr->frameSize;
+        }
+
+        written = write(readerPtr->fd, dataPtr, size);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if ((EAGAIN == errno) || (EWOULDBLOCK == errno))
+            {
+                return false;
+            }
+
+            LE_DEBUG("NMEA reader %p closed, errno.%d (%s)",
+                     readerPtr->ref, errno, strerror(errno));
+            CloseReader(readerPtr);
+            return true;
+        }
+
+        if (readerPtr->partialPtr)
+        {
+            readerPtr->partialOffset += written;
+            if ((size_t)written == size)
+            {
+                le_mem_Release(readerPtr->partialPtr);
+                readerPtr->partialPtr = NULL;
+            }
+        }
+        else
+        {
+            if ((size_t)written < size)
+            {
+                // Keep the frame, as it could be overwritten in the ring before its end is sent.
+                readerPtr->partialPtr = NmeaRing[readerPtr->nextFrame % NMEA_RING_SIZE].framePtr;
+                le_mem_AddRef(readerPtr->partialPtr);
+                readerPtr->partialOffset = written;
+            }
+            readerPtr->nextFrame++;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the pending NMEA frames to a reader, and wait for its file descriptor to be writable if
+ * it is full.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SendFrames
+(
+    NmeaReader_t* readerPtr     ///< [IN] NMEA reader.
+)
+{
+    if (WriteFrames(readerPtr))
+    {
+        if ((-1 != readerPtr->fd) && (readerPtr->isWaiting))
+        {
+            le_fdMonitor_Disable(readerPtr->monitorRef, POLLOUT);
+            readerPtr->isWaiting = false;
+        }
+    }
+    else if (!readerPtr->isWaiting)
+    {
+        le_fdMonitor_Enable(readerPtr->monitorRef, POLLOUT);
+        readerPtr->isWaiting = true;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Event handler of the file descriptor of a reader.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReaderFdHandler
+(
+    int   fd,       ///< [IN] File descriptor.
+    short events    ///< [IN] Bit map of events that occurred.
+)
+{
+    NmeaReader_t* readerPtr = le_fdMonitor_GetContextPtr();
+
+    if (events & (POLLERR | POLLHUP | POLLRDHUP))
+    {
+        LE_DEBUG("NMEA reader %p closed", readerPtr->ref);
+        CloseReader(readerPtr);
+    }
+    else if (events & POLLOUT)
+    {
+        SendFrames(readerPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start sending the NMEA frames to a reader, from the next reported frame.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartReader
+(
+    NmeaReader_t* readerPtr,    ///< [IN] NMEA reader.
+    int           fd            ///< [IN] Non-blocking write end of the reader.
+)
+{
+    readerPtr->fd = fd;
+    readerPtr->nextFrame = NextFrame;
+    readerPtr->partialPtr = NULL;
+    readerPtr->partialOffset = 0;
+    readerPtr->lostCount = 0;
+    readerPtr->isWaiting = false;
+    readerPtr->monitorRef = le_fdMonitor_Create("NmeaReader", fd, ReaderFdHandler, 0);
+    le_fdMonitor_SetContextPtr(readerPtr->monitorRef, readerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open the /dev/nmea named pipe if it has a reader.
+ */
+//--------------------------------------------------------------------------------------------------
+static void OpenPipeReader
+(
+    void
+)
+{
+    int fd;
+
+    do
+    {
+        fd = open(LE_GNSS_NMEA_NODE_PATH, O_WRONLY | O_APPEND | O_CLOEXEC | O_NONBLOCK);
+    }
+    while ((-1 == fd) && (EINTR == errno));
+
+    if (-1 == fd)
+    {
+        // ENXIO: nobody is reading the named pipe.
+        LE_WARN_IF(ENXIO != errno, "Open %s failure: errno.%d (%s)",
+                   LE_GNSS_NMEA_NODE_PATH, errno, strerror(errno));
+        return;
+    }
+
+    StartReader(&PipeReader, fd);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete an NMEA stream.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteStream
+(
+    NmeaReader_t* streamPtr     ///< [IN] NMEA stream.
+)
+{
+    CloseReader(streamPtr);
+    le_dls_Remove(&StreamList, &streamPtr->link);
+    le_ref_DeleteRef(NmeaStreamMap, streamPtr->ref);
+    le_mem_Release(streamPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+//                                       Local functions
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the NMEA flow.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssNmea_Init
+(
+    void
+)
+{
+    NmeaStreamPoolRef = le_mem_CreatePool("NmeaStreamPoolRef", sizeof(NmeaReader_t));
+    NmeaStreamMap = le_ref_CreateMap("NmeaStreamMap", NMEA_STREAM_MAX);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start distributing the NMEA frames, once the PA reports them to the positioning service.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssNmea_Start
+(
+    void
+)
+{
+    NmeaStarted = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add an NMEA frame reported by the PA to the ring, and send it to the readers.
+ *
+ * @note The ring takes over the reference of the caller on the frame.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssNmea_Report
+(
+    char* framePtr      ///< [IN] NMEA frame, allocated from a memory pool.
+)
+{
+    NmeaFrame_t* slotPtr = &NmeaRing[NextFrame % NMEA_RING_SIZE];
+    le_dls_Link_t* linkPtr;
+
+    if (slotPtr->framePtr)
+    {
+        le_mem_Release(slotPtr->framePtr);
+    }
+    slotPtr->framePtr = framePtr;
+    slotPtr->frameSize = strlen(framePtr) + 1;
+    slotPtr->sentenceType = GetSentenceType(framePtr);
+    NextFrame++;
+
+    // A reader waiting for its file descriptor to be writable is sent the frame later.
+    if (-1 == PipeReader.fd)
+    {
+        OpenPipeReader();
+    }
+    if ((-1 != PipeReader.fd) && (!PipeReader.isWaiting))
+    {
+        SendFrames(&PipeReader);
+    }
+
+    linkPtr = le_dls_Peek(&StreamList);
+    while (linkPtr)
+    {
+        NmeaReader_t* streamPtr = CONTAINER_OF(linkPtr, NmeaReader_t, link);
+
+        if ((-1 != streamPtr->fd) && (!streamPtr->isWaiting))
+        {
+            SendFrames(streamPtr);
+        }
+        linkPtr = le_dls_PeekNext(&StreamList, linkPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the NMEA streams of a closed client session.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssNmea_CloseSession
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] Closed client session.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&StreamList);
+
+    while (linkPtr)
+    {
+        NmeaReader_t* streamPtr = CONTAINER_OF(linkPtr, NmeaReader_t, link);
+
+        linkPtr = le_dls_PeekNext(&StreamList, linkPtr);
+        if (streamPtr->sessionRef == sessionRef)
+        {
+            DeleteStream(streamPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+//                                       Public declarations
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Open a stream of NMEA frames.
+ *
+ * @return
+ *  - A reference to the NMEA stream.
+ *  - NULL if the NMEA streams are not available or the stream could not be created.
+ */
+//--------------------------------------------------------------------------------------------------
+le_gnss_NmeaStreamRef_t le_gnss_OpenNmeaStream
+(
+    le_gnss_NmeaBitMask_t filterMask,   ///< [IN] NMEA sentences to receive, 0 for all of them.
+    int*                  streamFdPtr   ///< [OUT] File descriptor to read the NMEA frames from.
+)
+{
+    NmeaReader_t* streamPtr;
+    int fds[2];
+
+    if (NULL == streamFdPtr)
+    {
+        LE_KILL_CLIENT("streamFdPtr is NULL !");
+        return NULL;
+    }
+    *streamFdPtr = -1;
+
+    if (filterMask & ~LE_GNSS_NMEA_SENTENCES_MAX)
+    {
+        LE_ERROR("Wrong NMEA filter mask 0x%08X", filterMask);
+        return NULL;
+    }
+
+    if (!NmeaStarted)
+    {
+        LE_ERROR("NMEA frames are not available");
+        return NULL;
+    }
+
+    // One NMEA frame per packet, so that the client reads one frame at a time.
+    if (-1 == socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds))
+    {
+        LE_ERROR("Failed to create NMEA stream, errno.%d (%s)", errno, strerror(errno));
+        return NULL;
+    }
+    if (-1 == fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK))
+    {
+        LE_ERROR("Failed to create NMEA stream, errno.%d (%s)", errno, strerror(errno));
+        CloseFd(fds[0]);
+        CloseFd(fds[1]);
+        return NULL;
+    }
+
+    streamPtr = le_mem_ForceAlloc(NmeaStreamPoolRef);
+    memset(streamPtr, 0, sizeof(NmeaReader_t));
+    streamPtr->sessionRef = le_gnss_GetClientSessionRef();
+    streamPtr->filterMask = filterMask;
+    streamPtr->link = LE_DLS_LINK_INIT;
+    streamPtr->ref = le_ref_CreateRef(NmeaStreamMap, streamPtr);
+    StartReader(streamPtr, fds[0]);
+    le_dls_Queue(&StreamList, &streamPtr->link);
+
+    // The IPC layer closes the fd once it has been sent.
+    *streamFdPtr = fds[1];
+
+    LE_DEBUG("NMEA stream %p opened, filter 0x%08X", streamPtr->ref, filterMask);
+
+    return streamPtr->ref;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close a stream of NMEA frames.
+ *
+ * @note If the caller is passing an invalid stream reference into this function, it is a fatal
+ *       error and the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_gnss_CloseNmeaStream
+(
+    le_gnss_NmeaStreamRef_t streamRef   ///< [IN] NMEA stream reference.
+)
+{
+    NmeaReader_t* streamPtr = le_ref_Lookup(NmeaStreamMap, streamRef);
+
+    if (NULL == streamPtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", streamRef);
+        return;
+    }
+
+    DeleteStream(streamPtr);
+}
@@ -10,6 +10,17 @@
 #define LEGATO_GNSS_LOCAL_INCLUDE_GUARD
 
 #include "legato.h"
+#include "pa_gnss.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * NMEA node path definition
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef LE_GNSS_NMEA_NODE_PATH
+#define LE_GNSS_NMEA_NODE_PATH                  "/dev/nmea"
+#endif
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -24,4 +35,81 @@ le_result_t gnss_Init
     void
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the position history, or change its configuration.
+ *
+ * @return LE_FAULT  The ring could not be allocated, the history is disabled.
+ * @return LE_OK     The function succeed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t gnssHistory_Init
+(
+    uint32_t    capacity,       ///< [IN] Number of fixes of the ring, 0 to disable the history.
+    const char* filePathPtr     ///< [IN] History file path, NULL or empty to keep the history in
+                                ///       memory only.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a PA position report to the position history, if it has a location and a time.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssHistory_Record
+(
+    const pa_Gnss_Position_t* positionPtr   ///< [IN] The PA position data report.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the fixes not yet saved to the history file.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssHistory_Flush
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the NMEA streams.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssNmea_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start distributing the NMEA frames, once the PA reports them to the positioning service.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssNmea_Start
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Send an NMEA frame reported by the PA to /dev/nmea and to the NMEA streams.
+ *
+ * @note The NMEA flow takes over the reference of the caller on the frame.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssNmea_Report
+(
+    char* framePtr      ///< [IN] NMEA frame, allocated from a memory pool.
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Close the NMEA streams of a closed client session.
+ */
+//--------------------------------------------------------------------------------------------------
+void gnssNmea_CloseSession
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] Closed client session.
+);
+
 #endif // LEGATO_GNSS_LOCAL_INCLUDE_GUARD
@@ -12,6 +12,7 @@
 #include "legato.h"
 #include "interfaces.h"
 #include "le_gnss_local.h"
+#include "le_pos_local.h"
 #include "posCfgEntries.h"
 
 #include <math.h>
@@ -40,6 +41,16 @@
 
 #define CHECK_VALIDITY(_par_,_max_) ((_par_) == (_max_))? false : true
 
+/// All the parameters of a position sample snapshot.
+#define SAMPLE_FIELDS_ALL  (LE_POS_SAMPLE_LATITUDE | LE_POS_SAMPLE_LONGITUDE |                 \
+                            LE_POS_SAMPLE_HACCURACY | LE_POS_SAMPLE_ALTITUDE |                 \
+                            LE_POS_SAMPLE_VACCURACY | LE_POS_SAMPLE_HSPEED |                   \
+                            LE_POS_SAMPLE_HSPEED_ACCURACY | LE_POS_SAMPLE_VSPEED |             \
+                            LE_POS_SAMPLE_VSPEED_ACCURACY | LE_POS_SAMPLE_HEADING |            \
+                            LE_POS_SAMPLE_HEADING_ACCURACY | LE_POS_SAMPLE_DIRECTION |         \
+                            LE_POS_SAMPLE_DIRECTION_ACCURACY | LE_POS_SAMPLE_DATE |            \
+                            LE_POS_SAMPLE_TIME)
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Count of the number of activation requests that have not been released yet.
@@ -545,16 +556,22 @@ static le_result_t ComputeMove
     LE_DEBUG("Last Position lat.%d, long.%d",
                  posSampleHandlerNodePtr->lastLat, posSampleHandlerNodePtr->lastLong);
 
-    uint32_t horizontalMove = ComputeDistance(posSampleHandlerNodePtr->lastLat,
-                                              posSampleHandlerNodePtr->lastLong,
-                                              posParamPtr->latitude,
-                                              posParamPtr->longitude);
+    // A null magnitude is not checked by the caller, so don't compute the distance.
+    uint32_t horizontalMove = 0;
+    if (0 != posSampleHandlerNodePtr->horizontalMagnitude)
+    {
+        horizontalMove = ComputeDistance(posSampleHandlerNodePtr->lastLat,
+                                         posSampleHandlerNodePtr->lastLong,
+                                         posParamPtr->latitude,
+                                         posParamPtr->longitude);
+    }
 
     uint32_t verticalMove = abs(posParamPtr->altitude - posSampleHandlerNodePtr->lastAlt);
 
     LE_DEBUG("horizontalMove.%d, verticalMove.%d", horizontalMove, verticalMove);
 
-    if (INT32_MAX == posParamPtr->vAccuracy)
+    if ((0 == posSampleHandlerNodePtr->verticalMagnitude) ||
+        (INT32_MAX == posParamPtr->vAccuracy))
     {
         *vflagPtr = false;
     }
@@ -566,7 +583,8 @@ static le_result_t ComputeMove
                                    posParamPtr->vAccuracy/10);
     }
 
-    if (INT32_MAX == posParamPtr->hAccuracy)
+    if ((0 == posSampleHandlerNodePtr->horizontalMagnitude) ||
+        (INT32_MAX == posParamPtr->hAccuracy))
     {
         *hflagPtr = false;
     }
@@ -638,7 +656,7 @@ static void PosSampleHandlerfunc
         return;
     }
 
-    if (!NumOfHandlers)
+    if ((!NumOfHandlers) && (!posFence_IsActive()))
     {
         LE_DEBUG("No positioning Sample handler, exit Handler Function");
         // Release provided Position sample reference
@@ -662,6 +680,12 @@ static void PosSampleHandlerfunc
         LE_DEBUG("Position unknown [%d,%d,%d]", latitude, longitude, hAccuracy);
     }
 
+    // Geofences
+    if (locationValid)
+    {
+        posFence_ProcessLocation(latitude, longitude);
+    }
+
     // Get altitude
     result = le_gnss_GetAltitude(positionSampleRef, &altitude, &vAccuracy);
 
@@ -903,6 +927,22 @@ static void LoadPositioningFromConfigDb
     // Add a configDb handler to check if the acquition rate change.
     le_cfg_AddChangeHandler(CFG_POSITIONING_RATE_PATH, AcquitisionRateUpdate,NULL);
 
+    // Position history, disabled by default
+    char historyFile[LE_CFG_STR_LEN_BYTES] = {0};
+    int32_t historySize = le_cfg_GetInt(posCfg, CFG_NODE_HISTORY_SIZE, 0);
+    if (LE_OK != le_cfg_GetString(posCfg, CFG_NODE_HISTORY_FILE, historyFile,
+                                  sizeof(historyFile), ""))
+    {
+        LE_ERROR("Invalid position history file path");
+        historyFile[0] = '\0';
+    }
+    if (historySize < 0)
+    {
+        LE_ERROR("Invalid position history size %d", historySize);
+        historySize = 0;
+    }
+    gnssHistory_Init(historySize, historyFile);
+
     le_cfg_CancelTxn(posCfg);
 }
 
@@ -994,6 +1034,51 @@ static void PosCloseSessionEventHandler
         // Get the next value in the reference mpa
         result = le_ref_NextNode(iterRef);
     }
+
+    // Delete the geofences and geofence handlers of the client session.
+    posFence_CloseSession(sessionRef);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start receiving the GNSS position samples, if not already done.
+ *
+ * @return LE_FAULT  The function failed.
+ * @return LE_OK     The function succeed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pos_EnableSampleHandler
+(
+    void
+)
+{
+    if (NULL == GnssHandlerRef)
+    {
+        GnssHandlerRef = le_gnss_AddPositionHandler(PosSampleHandlerfunc, NULL);
+        if (NULL == GnssHandlerRef)
+        {
+            return LE_FAULT;
+        }
+    }
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop receiving the GNSS position samples, if there is no more movement or geofence handler.
+ */
+//--------------------------------------------------------------------------------------------------
+void pos_DisableSampleHandler
+(
+    void
+)
+{
+    if ((NULL != GnssHandlerRef) && (0 == NumOfHandlers) && (!posFence_IsActive()))
+    {
+        le_gnss_RemovePositionHandler(GnssHandlerRef);
+        GnssHandlerRef = NULL;
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1038,6 +1123,9 @@ COMPONENT_INIT
     NumOfHandlers = 0;
     GnssHandlerRef = NULL;
 
+    // Initialize the geofences
+    posFence_Init();
+
     // Create safe reference map for request references. The size of the map should be based on
     // the expected number of simultaneous data requests, so take a reasonable guess.
     ActivationRequestRefMap = le_ref_CreateMap("Positioning Client", POSITIONING_ACTIVATION_MAX);
@@ -1206,14 +1294,11 @@ le_pos_MovementHandlerRef_t le_pos_AddMovementHandler
     posSampleHandlerNodePtr->verticalMagnitude = verticalMagnitude;
 
     // Start acquisition
-    if (NumOfHandlers == 0)
+    if (LE_OK != pos_EnableSampleHandler())
     {
-        if ((GnssHandlerRef=le_gnss_AddPositionHandler(PosSampleHandlerfunc, NULL)) == NULL)
-        {
-            LE_ERROR("Failed to add PA GNSS's handler!");
-            le_mem_Release(posSampleHandlerNodePtr);
-            return NULL;
-        }
+        LE_ERROR("Failed to add PA GNSS's handler!");
+        le_mem_Release(posSampleHandlerNodePtr);
+        return NULL;
     }
 
     le_dls_Queue(&PosSampleHandlerList, &(posSampleHandlerNodePtr->link));
@@ -1262,11 +1347,7 @@ void le_pos_RemoveMovementHandler
         } while (linkPtr != NULL);
     }
 
-    if (NumOfHandlers == 0)
-    {
-        le_gnss_RemovePositionHandler(GnssHandlerRef);
-        GnssHandlerRef = NULL;
-    }
+    pos_DisableSampleHandler();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1886,6 +1967,245 @@ le_result_t le_pos_sample_GetFixState
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get all the parameters of the position sample in a single call.
+ *
+ * The parameters have the same units as with the individual accessors. An invalid parameter is
+ * set to the same value as the individual accessor sets it to, and its bit is cleared in
+ * validFieldsPtr.
+ *
+ * @return LE_FAULT         Function failed to find the positionSample.
+ * @return LE_OUT_OF_RANGE  At least one of the retrieved parameters is invalid.
+ * @return LE_OK            Function succeeded, all the parameters are valid.
+ * @return LE_BAD_PARAMETER Invalid reference provided.
+ *
+ * @note If the caller is passing an invalid Position reference or a null pointer into this
+ *       function, it is a fatal error, the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_pos_sample_GetSnapshot
+(
+    le_pos_SampleRef_t positionSampleRef,
+        ///< [IN] Position sample's reference.
+
+    le_pos_SampleFieldBitMask_t* validFieldsPtr,
+        ///< [OUT] Valid parameters.
+
+    le_pos_FixState_t* statePtr,
+        ///< [OUT] Position fix state.
+
+    int32_t* latitudePtr,
+        ///< [OUT] WGS84 Latitude in degrees, positive North [resolution 1e-6].
+
+    int32_t* longitudePtr,
+        ///< [OUT] WGS84 Longitude in degrees, positive East [resolution 1e-6].
+
+    int32_t* horizontalAccuracyPtr,
+        ///< [OUT] Horizontal position's accuracy in meters.
+
+    int32_t* altitudePtr,
+        ///< [OUT] Altitude in meters, above Mean Sea Level.
+
+    int32_t* altitudeAccuracyPtr,
+        ///< [OUT] Vertical position's accuracy in meters.
+
+    uint32_t* hSpeedPtr,
+        ///< [OUT] The Horizontal Speed in m/sec.
+
+    uint32_t* hSpeedAccuracyPtr,
+        ///< [OUT] The Horizontal Speed's accuracy in m/sec.
+
+    int32_t* vSpeedPtr,
+        ///< [OUT] The Vertical Speed in m/sec, positive up.
+
+    int32_t* vSpeedAccuracyPtr,
+        ///< [OUT] The Vertical Speed's accuracy in m/sec.
+
+    uint32_t* headingPtr,
+        ///< [OUT] Heading in degrees. Range: 0 to 359, where 0 is True North.
+
+    uint32_t* headingAccuracyPtr,
+        ///< [OUT] Heading's accuracy estimate in degrees.
+
+    uint32_t* directionPtr,
+        ///< [OUT] Direction indication in degrees. Range: 0 to 359, where 0 is True North.
+
+    uint32_t* directionAccuracyPtr,
+        ///< [OUT] Direction's accuracy estimate in degrees.
+
+    uint16_t* yearPtr,
+        ///< [OUT] UTC Year A.D. [e.g. 2014].
+
+    uint16_t* monthPtr,
+        ///< [OUT] UTC Month into the year [range 1...12].
+
+    uint16_t* dayPtr,
+        ///< [OUT] UTC Days into the month [range 1...31].
+
+    uint16_t* hoursPtr,
+        ///< [OUT] UTC Hours into the day [range 0..23].
+
+    uint16_t* minutesPtr,
+        ///< [OUT] UTC Minutes into the hour [range 0..59].
+
+    uint16_t* secondsPtr,
+        ///< [OUT] UTC Seconds into the minute [range 0..59].
+
+    uint16_t* millisecondsPtr
+        ///< [OUT] UTC Milliseconds into the second [range 0..999].
+)
+{
+    le_pos_SampleFieldBitMask_t validFields = 0;
+    le_pos_Sample_t* samplePtr;
+    PosSampleRequest_t* posSampleRequestPtr = le_ref_Lookup(PosSampleMap,positionSampleRef);
+    if (NULL == posSampleRequestPtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", positionSampleRef);
+        return LE_BAD_PARAMETER;
+    }
+
+    if (posSampleRequestPtr->posSampleNodePtr == NULL)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!",positionSampleRef);
+        return LE_FAULT;
+    }
+
+    if ((NULL == validFieldsPtr) || (NULL == statePtr)
+        || (NULL == latitudePtr) || (NULL == longitudePtr) || (NULL == horizontalAccuracyPtr)
+        || (NULL == altitudePtr) || (NULL == altitudeAccuracyPtr)
+        || (NULL == hSpeedPtr) || (NULL == hSpeedAccuracyPtr)
+        || (NULL == vSpeedPtr) || (NULL == vSpeedAccuracyPtr)
+        || (NULL == headingPtr) || (NULL == headingAccuracyPtr)
+        || (NULL == directionPtr) || (NULL == directionAccuracyPtr)
+        || (NULL == yearPtr) || (NULL == monthPtr) || (NULL == dayPtr)
+        || (NULL == hoursPtr) || (NULL == minutesPtr) || (NULL == secondsPtr)
+        || (NULL == millisecondsPtr))
+    {
+        LE_KILL_CLIENT("Invalid pointer provided!");
+        return LE_FAULT;
+    }
+
+    samplePtr = posSampleRequestPtr->posSampleNodePtr;
+
+    *statePtr = samplePtr->fixState;
+
+    // Same resolutions and invalid values as the individual accessors.
+    *latitudePtr = INT32_MAX;
+    if (samplePtr->latitudeValid)
+    {
+        *latitudePtr = samplePtr->latitude;
+        validFields |= LE_POS_SAMPLE_LATITUDE;
+    }
+    *longitudePtr = INT32_MAX;
+    if (samplePtr->longitudeValid)
+    {
+        *longitudePtr = samplePtr->longitude;
+        validFields |= LE_POS_SAMPLE_LONGITUDE;
+    }
+    *horizontalAccuracyPtr = INT32_MAX;
+    if (samplePtr->hAccuracyValid)
+    {
+        *horizontalAccuracyPtr = samplePtr->hAccuracy/100;
+        validFields |= LE_POS_SAMPLE_HACCURACY;
+    }
+    *altitudePtr = INT32_MAX;
+    if (samplePtr->altitudeValid)
+    {
+        *altitudePtr = samplePtr->altitude/1000;
+        validFields |= LE_POS_SAMPLE_ALTITUDE;
+    }
+    *altitudeAccuracyPtr = INT32_MAX;
+    if (samplePtr->vAccuracyValid)
+    {
+        *altitudeAccuracyPtr = samplePtr->vAccuracy/10;
+        validFields |= LE_POS_SAMPLE_VACCURACY;
+    }
+    *hSpeedPtr = UINT32_MAX;
+    if (samplePtr->hSpeedValid)
+    {
+        *hSpeedPtr = samplePtr->hSpeed/100;
+        validFields |= LE_POS_SAMPLE_HSPEED;
+    }
+    *hSpeedAccuracyPtr = UINT32_MAX;
+    if (samplePtr->hSpeedAccuracyValid)
+    {
+        *hSpeedAccuracyPtr = samplePtr->hSpeedAccuracy/10;
+        validFields |= LE_POS_SAMPLE_HSPEED_ACCURACY;
+    }
+    *vSpeedPtr = INT32_MAX;
+    if (samplePtr->vSpeedValid)
+    {
+        *vSpeedPtr = samplePtr->vSpeed/100;
+        validFields |= LE_POS_SAMPLE_VSPEED;
+    }
+    *vSpeedAccuracyPtr = INT32_MAX;
+    if (samplePtr->vSpeedAccuracyValid)
+    {
+        *vSpeedAccuracyPtr = samplePtr->vSpeedAccuracy/10;
+        validFields |= LE_POS_SAMPLE_VSPEED_ACCURACY;
+    }
+    *headingPtr = UINT32_MAX;
+    if (samplePtr->headingValid)
+    {
+        *headingPtr = samplePtr->heading;
+        validFields |= LE_POS_SAMPLE_HEADING;
+    }
+    *headingAccuracyPtr = UINT32_MAX;
+    if (samplePtr->headingAccuracyValid)
+    {
+        *headingAccuracyPtr = samplePtr->headingAccuracy;
+        validFields |= LE_POS_SAMPLE_HEADING_ACCURACY;
+    }
+    *directionPtr = UINT32_MAX;
+    if (samplePtr->directionValid)
+    {
+        *directionPtr = samplePtr->direction/10;
+        validFields |= LE_POS_SAMPLE_DIRECTION;
+    }
+    *directionAccuracyPtr = UINT32_MAX;
+    if (samplePtr->directionAccuracyValid)
+    {
+        *directionAccuracyPtr = samplePtr->directionAccuracy/10;
+        validFields |= LE_POS_SAMPLE_DIRECTION_ACCURACY;
+    }
+
+    if (samplePtr->dateValid)
+    {
+        *yearPtr = samplePtr->year;
+        *monthPtr = samplePtr->month;
+        *dayPtr = samplePtr->day;
+        validFields |= LE_POS_SAMPLE_DATE;
+    }
+    else
+    {
+        *yearPtr = 0;
+        *monthPtr = 0;
+        *dayPtr = 0;
+    }
+
+    if (samplePtr->timeValid)
+    {
+        *hoursPtr = samplePtr->hours;
+        *minutesPtr = samplePtr->minutes;
+        *secondsPtr = samplePtr->seconds;
+        *millisecondsPtr = samplePtr->milliseconds;
+        validFields |= LE_POS_SAMPLE_TIME;
+    }
+    else
+    {
+        *hoursPtr = 0;
+        *minutesPtr = 0;
+        *secondsPtr = 0;
+        *millisecondsPtr = 0;
+    }
+
+    *validFieldsPtr = validFields;
+
+    return (validFields == SAMPLE_FIELDS_ALL) ? LE_OK : LE_OUT_OF_RANGE;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * This function must be called to release the position sample.
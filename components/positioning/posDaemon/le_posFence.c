@@ -0,0 +1,939 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file le_posFence.c
+ *
+ * This file contains the source code of the geofences of the Positioning API.
+ *
+ * The geofences are indexed in grids of cells kept in a hash map: a geofence is added to each cell
+ * that its bounding box overlaps, so that only the geofences of the cells of a new position have to
+ * be checked. There are FENCE_GRID_LEVEL_COUNT grids, from fine to coarse cells (see GridCellSize),
+ * and each geofence is indexed in the finest grid where it overlaps at most FENCE_GRID_MAX_CELLS
+ * cells. The few geofences overlapping more cells than that in the coarsest grid are kept in a
+ * list, and checked at each position.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+
+#include "legato.h"
+#include "interfaces.h"
+#include "le_pos_local.h"
+
+#include <math.h>
+
+//--------------------------------------------------------------------------------------------------
+// Symbol and Enum definitions.
+//--------------------------------------------------------------------------------------------------
+
+/// Number of grids, see GridCellSize.
+#define FENCE_GRID_LEVEL_COUNT      2
+
+/// Geofences overlapping more cells than this are indexed in a coarser grid.
+#define FENCE_GRID_MAX_CELLS        64
+
+/// Expected number of grid cells in use.
+#define FENCE_GRID_MAP_SIZE         1024
+
+/// Expected number of geofences.
+#define FENCE_MAP_SIZE              256
+
+/// Typically, we don't expect more than this number of geofence handlers.
+#define FENCE_HANDLER_MAX           13      // Ideally should be a prime number.
+
+/// Length of a micro-degree of latitude in meters, for a mean earth radius of 6,371 km.
+#define METERS_PER_MICRODEGREE      0.111194927
+
+/// Latitude and longitude ranges, in micro-degrees.
+#define LATITUDE_MAX                90000000
+#define LONGITUDE_MAX               180000000
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofence shapes.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    FENCE_SHAPE_CIRCLE,     ///< Circle, defined by its center and radius.
+    FENCE_SHAPE_POLYGON     ///< Polygon, defined by its vertices.
+}
+FenceShape_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofence structure.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_pos_FenceRef_t   ref;                ///< Geofence reference.
+    FenceShape_t        shape;              ///< Geofence shape.
+    int32_t             minLat;             ///< Bounding box, in micro-degrees.
+    int32_t             maxLat;
+    int32_t             minLon;
+    int32_t             maxLon;
+    int32_t             centerLat;          ///< Center of a circle, in micro-degrees.
+    int32_t             centerLon;
+    double              radiusSquare;       ///< Square of the radius of a circle, in m².
+    double              lonScale;           ///< Length of a micro-degree of longitude at the
+                                            ///  center of a circle, in meters.
+    size_t              vertexCount;        ///< Number of vertices of a polygon.
+    int32_t             vertexLat[LE_POS_FENCE_MAX_VERTICES];   ///< Vertices of a polygon, in
+    int32_t             vertexLon[LE_POS_FENCE_MAX_VERTICES];   ///  micro-degrees.
+    bool                inside;             ///< True if the last position was inside.
+    uint32_t            insideFixCount;     ///< Last position found inside (see FixCount).
+    bool                isLarge;            ///< True if in LargeFenceList instead of a grid.
+    uint32_t            gridLevel;          ///< Grid the geofence is indexed in, if not large.
+    bool                transitionPending;  ///< True if in TransitionList.
+    le_msg_SessionRef_t sessionRef;         ///< Client session identifier.
+    le_dls_List_t       cellEntryList;      ///< Grid cell entries of the geofence.
+    le_dls_Link_t       largeLink;          ///< Link in LargeFenceList.
+    le_dls_Link_t       insideLink;         ///< Link in InsideFenceList.
+    le_dls_Link_t       transitionLink;     ///< Link in TransitionList.
+}
+Fence_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Grid cell structure.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t            key;                ///< Cell grid, row and column (see GridCellKey()).
+    le_dls_List_t       entryList;          ///< Geofences overlapping the cell.
+}
+GridCell_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Entry of a geofence in a grid cell.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    Fence_t*            fencePtr;           ///< Geofence.
+    GridCell_t*         cellPtr;            ///< Grid cell.
+    le_dls_Link_t       cellLink;           ///< Link in the cell's entry list.
+    le_dls_Link_t       fenceLink;          ///< Link in the geofence's entry list.
+}
+GridCellEntry_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofence handler structure.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    le_pos_FenceHandlerFunc_t   handlerFuncPtr;     ///< The handler function address.
+    void*                       handlerContextPtr;  ///< The handler function context.
+    le_msg_SessionRef_t         sessionRef;         ///< Client session identifier.
+    le_dls_Link_t               link;               ///< Object node link.
+}
+FenceHandler_t;
+
+//--------------------------------------------------------------------------------------------------
+//                                       Static declarations
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory Pools for geofences, grid cells, grid cell entries and geofence handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t FencePoolRef;
+static le_mem_PoolRef_t GridCellPoolRef;
+static le_mem_PoolRef_t GridCellEntryPoolRef;
+static le_mem_PoolRef_t FenceHandlerPoolRef;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Safe Reference Maps for geofences and geofence handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_ref_MapRef_t FenceRefMap;
+static le_ref_MapRef_t FenceHandlerRefMap;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the grid cells in micro-degrees, by grid level: 0.01 degree (about 1.1 km of latitude),
+ * enough for geofences of a few kilometers, and 1 degree for the regional ones.
+ */
+//--------------------------------------------------------------------------------------------------
+static const int32_t GridCellSize[FENCE_GRID_LEVEL_COUNT] = { 10000, 1000000 };
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Grid cells in use, of all grids, by key.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t GridMap;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofences too large to be indexed in the grid.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t LargeFenceList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofences the last position was inside.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t InsideFenceList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofences entered or exited at the current position, waiting to be reported.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t TransitionList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Geofence handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t FenceHandlerList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of positions checked, used to find out which geofences have been exited.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t FixCount;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the grid row of a latitude.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GridRow
+(
+    uint32_t level,         ///< [IN] Grid level.
+    int32_t latitude        ///< [IN] Latitude in micro-degrees.
+)
+{
+    return (uint32_t)(((int64_t)latitude + LATITUDE_MAX) / GridCellSize[level]);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the grid column of a longitude.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t GridColumn
+(
+    uint32_t level,         ///< [IN] Grid level.
+    int32_t longitude       ///< [IN] Longitude in micro-degrees.
+)
+{
+    return (uint32_t)(((int64_t)longitude + LONGITUDE_MAX) / GridCellSize[level]);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the hash map key of a grid cell. Rows and columns are below 2^24, even in the finest grid.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GridCellKey
+(
+    uint32_t level,
+    uint32_t row,
+    uint32_t column
+)
+{
+    return ((uint64_t)level << 56) | ((uint64_t)row << 28) | column;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check that a location is a valid WGS84 location.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsValidLocation
+(
+    int32_t latitude,
+    int32_t longitude
+)
+{
+    return (latitude >= -LATITUDE_MAX) && (latitude <= LATITUDE_MAX) &&
+           (longitude >= -LONGITUDE_MAX) && (longitude <= LONGITUDE_MAX);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Index a geofence, in the cells its bounding box overlaps in the finest grid where they are not
+ * too many, or in the large geofences list.
+ */
+//--------------------------------------------------------------------------------------------------
+static void IndexFence
+(
+    Fence_t* fencePtr
+)
+{
+    uint32_t level;
+    uint32_t minRow;
+    uint32_t maxRow;
+    uint32_t minColumn;
+    uint32_t maxColumn;
+    uint32_t row;
+    uint32_t column;
+
+    for (level = 0; level < FENCE_GRID_LEVEL_COUNT; level++)
+    {
+        minRow = GridRow(level, fencePtr->minLat);
+        maxRow = GridRow(level, fencePtr->maxLat);
+        minColumn = GridColumn(level, fencePtr->minLon);
+        maxColumn = GridColumn(level, fencePtr->maxLon);
+
+        if (((uint64_t)(maxRow - minRow + 1) * (maxColumn - minColumn + 1)) <=
+            FENCE_GRID_MAX_CELLS)
+        {
+            break;
+        }
+    }
+
+    if (FENCE_GRID_LEVEL_COUNT == level)
+    {
+        fencePtr->isLarge = true;
+        le_dls_Queue(&LargeFenceList, &fencePtr->largeLink);
+        return;
+    }
+
+    fencePtr->gridLevel = level;
+
+    for (row = minRow; row <= maxRow; row++)
+    {
+        for (column = minColumn; column <= maxColumn; column++)
+        {
+            uint64_t key = GridCellKey(level, row, column);
+            GridCell_t* cellPtr = le_hashmap_Get(GridMap, &key);
+            GridCellEntry_t* entryPtr;
+
+            if (NULL == cellPtr)
+            {
+                cellPtr = le_mem_ForceAlloc(GridCellPoolRef);
+                cellPtr->key = key;
+                cellPtr->entryList = LE_DLS_LIST_INIT;
+                le_hashmap_Put(GridMap, &cellPtr->key, cellPtr);
+            }
+
+            entryPtr = le_mem_ForceAlloc(GridCellEntryPoolRef);
+            entryPtr->fencePtr = fencePtr;
+            entryPtr->cellPtr = cellPtr;
+            entryPtr->cellLink = LE_DLS_LINK_INIT;
+            entryPtr->fenceLink = LE_DLS_LINK_INIT;
+            le_dls_Queue(&cellPtr->entryList, &entryPtr->cellLink);
+            le_dls_Queue(&fencePtr->cellEntryList, &entryPtr->fenceLink);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a geofence from the index, releasing the grid cells that are no longer used.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UnindexFence
+(
+    Fence_t* fencePtr
+)
+{
+    le_dls_Link_t* linkPtr;
+
+    if (fencePtr->isLarge)
+    {
+        le_dls_Remove(&LargeFenceList, &fencePtr->largeLink);
+        return;
+    }
+
+    while (NULL != (linkPtr = le_dls_Pop(&fencePtr->cellEntryList)))
+    {
+        GridCellEntry_t* entryPtr = CONTAINER_OF(linkPtr, GridCellEntry_t, fenceLink);
+        GridCell_t* cellPtr = entryPtr->cellPtr;
+
+        le_dls_Remove(&cellPtr->entryList, &entryPtr->cellLink);
+        le_mem_Release(entryPtr);
+
+        if (le_dls_IsEmpty(&cellPtr->entryList))
+        {
+            le_hashmap_Remove(GridMap, &cellPtr->key);
+            le_mem_Release(cellPtr);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a geofence, once its shape and bounding box are set.
+ *
+ * @return Reference to the geofence.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_pos_FenceRef_t AddFence
+(
+    Fence_t* fencePtr
+)
+{
+    fencePtr->inside = false;
+    fencePtr->insideFixCount = 0;
+    fencePtr->isLarge = false;
+    fencePtr->gridLevel = 0;
+    fencePtr->transitionPending = false;
+    fencePtr->sessionRef = le_pos_GetClientSessionRef();
+    fencePtr->cellEntryList = LE_DLS_LIST_INIT;
+    fencePtr->largeLink = LE_DLS_LINK_INIT;
+    fencePtr->insideLink = LE_DLS_LINK_INIT;
+    fencePtr->transitionLink = LE_DLS_LINK_INIT;
+
+    IndexFence(fencePtr);
+
+    fencePtr->ref = le_ref_CreateRef(FenceRefMap, fencePtr);
+
+    LE_DEBUG("Fence %p created, bounding box [%d,%d]-[%d,%d], %s %u", fencePtr->ref,
+             fencePtr->minLat, fencePtr->minLon, fencePtr->maxLat, fencePtr->maxLon,
+             fencePtr->isLarge ? "not indexed" : "grid", fencePtr->gridLevel);
+
+    return fencePtr->ref;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a geofence.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DeleteFence
+(
+    Fence_t* fencePtr
+)
+{
+    UnindexFence(fencePtr);
+
+    if (fencePtr->inside)
+    {
+        le_dls_Remove(&InsideFenceList, &fencePtr->insideLink);
+    }
+
+    if (fencePtr->transitionPending)
+    {
+        le_dls_Remove(&TransitionList, &fencePtr->transitionLink);
+    }
+
+    le_ref_DeleteRef(FenceRefMap, fencePtr->ref);
+    le_mem_Release(fencePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if a location is inside a geofence.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsInFence
+(
+    const Fence_t* fencePtr,
+    int32_t        latitude,
+    int32_t        longitude
+)
+{
+    if ((latitude < fencePtr->minLat) || (latitude > fencePtr->maxLat) ||
+        (longitude < fencePtr->minLon) || (longitude > fencePtr->maxLon))
+    {
+        return false;
+    }
+
+    if (FENCE_SHAPE_CIRCLE == fencePtr->shape)
+    {
+        // The circles are small enough to use an equirectangular projection around their center.
+        double dy = (double)(latitude - fencePtr->centerLat) * METERS_PER_MICRODEGREE;
+        double dx = (double)(longitude - fencePtr->centerLon) * fencePtr->lonScale;
+
+        return ((dx * dx) + (dy * dy)) <= fencePtr->radiusSquare;
+    }
+    else
+    {
+        // Count the polygon edges crossed by a ray going East from the location.
+        bool inside = false;
+        size_t i;
+        size_t j;
+
+        for (i = 0, j = fencePtr->vertexCount - 1; i < fencePtr->vertexCount; j = i++)
+        {
+            int32_t latI = fencePtr->vertexLat[i];
+            int32_t latJ = fencePtr->vertexLat[j];
+
+            if ((latI > latitude) != (latJ > latitude))
+            {
+                double lonI = fencePtr->vertexLon[i];
+                double lonJ = fencePtr->vertexLon[j];
+                double crossLon = lonI + ((double)latitude - latI) * (lonJ - lonI) /
+                                         ((double)latJ - latI);
+
+                if (longitude < crossLon)
+                {
+                    inside = !inside;
+                }
+            }
+        }
+
+        return inside;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check a geofence against the current location, and queue its transition if it was entered.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckFence
+(
+    Fence_t* fencePtr,
+    int32_t  latitude,
+    int32_t  longitude
+)
+{
+    if (IsInFence(fencePtr, latitude, longitude))
+    {
+        fencePtr->insideFixCount = FixCount;
+
+        if ((!fencePtr->inside) && (!fencePtr->transitionPending))
+        {
+            fencePtr->transitionPending = true;
+            le_dls_Queue(&TransitionList, &fencePtr->transitionLink);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Update the state of the geofences in TransitionList and call the geofence handlers.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReportTransitions
+(
+    void
+)
+{
+    le_dls_Link_t* linkPtr;
+
+    // A handler may delete geofences, so pop them one at a time.
+    while (NULL != (linkPtr = le_dls_Pop(&TransitionList)))
+    {
+        Fence_t* fencePtr = CONTAINER_OF(linkPtr, Fence_t, transitionLink);
+        le_pos_FenceRef_t fenceRef = fencePtr->ref;
+        le_msg_SessionRef_t sessionRef = fencePtr->sessionRef;
+        le_pos_FenceEvent_t event;
+        le_dls_Link_t* handlerLinkPtr;
+
+        fencePtr->transitionPending = false;
+
+        if (fencePtr->inside)
+        {
+            fencePtr->inside = false;
+            le_dls_Remove(&InsideFenceList, &fencePtr->insideLink);
+            event = LE_POS_FENCE_EXITED;
+        }
+        else
+        {
+            fencePtr->inside = true;
+            le_dls_Queue(&InsideFenceList, &fencePtr->insideLink);
+            event = LE_POS_FENCE_ENTERED;
+        }
+
+        LE_DEBUG("Fence %p %s", fenceRef, (LE_POS_FENCE_ENTERED == event) ? "entered" : "exited");
+
+        handlerLinkPtr = le_dls_Peek(&FenceHandlerList);
+        while (NULL != handlerLinkPtr)
+        {
+            FenceHandler_t* handlerPtr = CONTAINER_OF(handlerLinkPtr, FenceHandler_t, link);
+
+            // Get the next handler first, in case this one is removed.
+            handlerLinkPtr = le_dls_PeekNext(&FenceHandlerList, handlerLinkPtr);
+
+            if (handlerPtr->sessionRef == sessionRef)
+            {
+                handlerPtr->handlerFuncPtr(fenceRef, event, handlerPtr->handlerContextPtr);
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the geofences.
+ */
+//--------------------------------------------------------------------------------------------------
+void posFence_Init
+(
+    void
+)
+{
+    FencePoolRef = le_mem_CreatePool("FencePoolRef", sizeof(Fence_t));
+    GridCellPoolRef = le_mem_CreatePool("GridCellPoolRef", sizeof(GridCell_t));
+    GridCellEntryPoolRef = le_mem_CreatePool("GridCellEntryPoolRef", sizeof(GridCellEntry_t));
+    FenceHandlerPoolRef = le_mem_CreatePool("FenceHandlerPoolRef", sizeof(FenceHandler_t));
+
+    FenceRefMap = le_ref_CreateMap("FenceRefMap", FENCE_MAP_SIZE);
+    FenceHandlerRefMap = le_ref_CreateMap("FenceHandlerRefMap", FENCE_HANDLER_MAX);
+
+    GridMap = le_hashmap_Create("FenceGridMap", FENCE_GRID_MAP_SIZE,
+                                le_hashmap_HashUInt64, le_hashmap_EqualsUInt64);
+
+    FixCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if the geofences need the position samples.
+ *
+ * @return true if at least one geofence handler is registered.
+ */
+//--------------------------------------------------------------------------------------------------
+bool posFence_IsActive
+(
+    void
+)
+{
+    return !le_dls_IsEmpty(&FenceHandlerList);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the geofences against a new location, and report their transitions.
+ */
+//--------------------------------------------------------------------------------------------------
+void posFence_ProcessLocation
+(
+    int32_t latitude,       ///< [IN] WGS84 Latitude in degrees [resolution 1e-6].
+    int32_t longitude       ///< [IN] WGS84 Longitude in degrees [resolution 1e-6].
+)
+{
+    le_dls_Link_t* linkPtr;
+    uint32_t       level;
+
+    if ((!posFence_IsActive()) || (!IsValidLocation(latitude, longitude)))
+    {
+        return;
+    }
+
+    FixCount++;
+
+    // Geofences of the location's cell in each grid
+    for (level = 0; level < FENCE_GRID_LEVEL_COUNT; level++)
+    {
+        uint64_t key = GridCellKey(level, GridRow(level, latitude), GridColumn(level, longitude));
+        GridCell_t* cellPtr = le_hashmap_Get(GridMap, &key);
+
+        if (NULL == cellPtr)
+        {
+            continue;
+        }
+
+        linkPtr = le_dls_Peek(&cellPtr->entryList);
+        while (NULL != linkPtr)
+        {
+            GridCellEntry_t* entryPtr = CONTAINER_OF(linkPtr, GridCellEntry_t, cellLink);
+
+            CheckFence(entryPtr->fencePtr, latitude, longitude);
+            linkPtr = le_dls_PeekNext(&cellPtr->entryList, linkPtr);
+        }
+    }
+
+    // Geofences too large to be indexed
+    linkPtr = le_dls_Peek(&LargeFenceList);
+    while (NULL != linkPtr)
+    {
+        CheckFence(CONTAINER_OF(linkPtr, Fence_t, largeLink), latitude, longitude);
+        linkPtr = le_dls_PeekNext(&LargeFenceList, linkPtr);
+    }
+
+    // Geofences that were inside, and where the location was not found, have been exited.
+    linkPtr = le_dls_Peek(&InsideFenceList);
+    while (NULL != linkPtr)
+    {
+        Fence_t* fencePtr = CONTAINER_OF(linkPtr, Fence_t, insideLink);
+
+        if (fencePtr->insideFixCount != FixCount)
+        {
+            fencePtr->transitionPending = true;
+            le_dls_Queue(&TransitionList, &fencePtr->transitionLink);
+        }
+        linkPtr = le_dls_PeekNext(&InsideFenceList, linkPtr);
+    }
+
+    ReportTransitions();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete the geofences and geofence handlers of a closed client session.
+ */
+//--------------------------------------------------------------------------------------------------
+void posFence_CloseSession
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] Closed client session.
+)
+{
+    le_dls_Link_t* linkPtr;
+    le_ref_IterRef_t iterRef = le_ref_GetIterator(FenceRefMap);
+    le_result_t result = le_ref_NextNode(iterRef);
+
+    while (LE_OK == result)
+    {
+        Fence_t* fencePtr = (Fence_t*)le_ref_GetValue(iterRef);
+
+        // Get the next node first, as the geofence reference is deleted.
+        result = le_ref_NextNode(iterRef);
+
+        if (fencePtr->sessionRef == sessionRef)
+        {
+            LE_DEBUG("Delete fence %p, Session %p", fencePtr->ref, sessionRef);
+            DeleteFence(fencePtr);
+        }
+    }
+
+    iterRef = le_ref_GetIterator(FenceHandlerRefMap);
+    result = le_ref_NextNode(iterRef);
+    while (LE_OK == result)
+    {
+        FenceHandler_t* handlerPtr = (FenceHandler_t*)le_ref_GetValue(iterRef);
+        void* safeRef = (void*)le_ref_GetSafeRef(iterRef);
+
+        result = le_ref_NextNode(iterRef);
+
+        if (handlerPtr->sessionRef == sessionRef)
+        {
+            LE_DEBUG("Remove fence handler %p, Session %p", safeRef, sessionRef);
+            linkPtr = &handlerPtr->link;
+            le_dls_Remove(&FenceHandlerList, linkPtr);
+            le_ref_DeleteRef(FenceHandlerRefMap, safeRef);
+            le_mem_Release(handlerPtr);
+        }
+    }
+
+    pos_DisableSampleHandler();
+}
+
+//--------------------------------------------------------------------------------------------------
+// APIs.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Register an handler for the transitions of the geofences created by the client.
+ *
+ * @return A handler reference, which is only needed for later removal of the handler.
+ *
+ * @note Doesn't return on failure, so there's no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+le_pos_FenceTransitionHandlerRef_t le_pos_AddFenceTransitionHandler
+(
+    le_pos_FenceHandlerFunc_t   handlerPtr,     ///< [IN] The handler function.
+    void*                       contextPtr      ///< [IN] The context pointer
+)
+{
+    FenceHandler_t* fenceHandlerPtr;
+
+    if (NULL == handlerPtr)
+    {
+        LE_KILL_CLIENT("handlerPtr pointer is NULL!");
+        return NULL;
+    }
+
+    if (LE_OK != pos_EnableSampleHandler())
+    {
+        LE_ERROR("Failed to add PA GNSS's handler!");
+        return NULL;
+    }
+
+    fenceHandlerPtr = le_mem_ForceAlloc(FenceHandlerPoolRef);
+    fenceHandlerPtr->handlerFuncPtr = handlerPtr;
+    fenceHandlerPtr->handlerContextPtr = contextPtr;
+    fenceHandlerPtr->sessionRef = le_pos_GetClientSessionRef();
+    fenceHandlerPtr->link = LE_DLS_LINK_INIT;
+    le_dls_Queue(&FenceHandlerList, &fenceHandlerPtr->link);
+
+    return le_ref_CreateRef(FenceHandlerRefMap, fenceHandlerPtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Remove a geofence handler.
+ *
+ * @note Doesn't return on failure, so there's no need to check the return value for errors.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_pos_RemoveFenceTransitionHandler
+(
+    le_pos_FenceTransitionHandlerRef_t handlerRef   ///< [IN] The handler reference.
+)
+{
+    FenceHandler_t* fenceHandlerPtr = le_ref_Lookup(FenceHandlerRefMap, handlerRef);
+
+    if (NULL == fenceHandlerPtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", handlerRef);
+        return;
+    }
+
+    le_dls_Remove(&FenceHandlerList, &fenceHandlerPtr->link);
+    le_ref_DeleteRef(FenceHandlerRefMap, handlerRef);
+    le_mem_Release(fenceHandlerPtr);
+
+    pos_DisableSampleHandler();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a circular geofence.
+ *
+ * @note Geofences must not cross the 180th meridian: the bounding box of a circle is clipped to the
+ *       valid longitudes, so the part of a circle beyond the 180th meridian is never entered.  The
+ *       same applies beyond the poles.
+ *
+ * @return
+ *    - Reference to the geofence.
+ *    - NULL if a parameter is invalid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_pos_FenceRef_t le_pos_CreateCircleFence
+(
+    int32_t  latitude,      ///< [IN] WGS84 Latitude of the center in degrees, positive North
+                            ///       [resolution 1e-6].
+    int32_t  longitude,     ///< [IN] WGS84 Longitude of the center in degrees, positive East
+                            ///       [resolution 1e-6].
+    uint32_t radius         ///< [IN] Radius in meters.
+)
+{
+    Fence_t* fencePtr;
+    double   latDelta;
+    double   lonDelta;
+
+    if ((!IsValidLocation(latitude, longitude)) || (0 == radius))
+    {
+        LE_ERROR("Invalid circle: center [%d,%d], radius %u", latitude, longitude, radius);
+        return NULL;
+    }
+
+    fencePtr = le_mem_ForceAlloc(FencePoolRef);
+    fencePtr->shape = FENCE_SHAPE_CIRCLE;
+    fencePtr->centerLat = latitude;
+    fencePtr->centerLon = longitude;
+    fencePtr->radiusSquare = (double)radius * radius;
+    fencePtr->lonScale = METERS_PER_MICRODEGREE * cos((double)latitude / 1000000.0 * M_PI / 180);
+    fencePtr->vertexCount = 0;
+
+    // Bounding box, clipped to the valid latitudes and longitudes
+    latDelta = radius / METERS_PER_MICRODEGREE;
+    lonDelta = (fencePtr->lonScale > 0) ? (radius / fencePtr->lonScale) : (2.0 * LONGITUDE_MAX);
+    fencePtr->minLat = (int32_t)fmax(latitude - latDelta, -LATITUDE_MAX);
+    fencePtr->maxLat = (int32_t)fmin(latitude + latDelta, LATITUDE_MAX);
+    fencePtr->minLon = (int32_t)fmax(longitude - lonDelta, -LONGITUDE_MAX);
+    fencePtr->maxLon = (int32_t)fmin(longitude + lonDelta, LONGITUDE_MAX);
+
+    return AddFence(fencePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Create a polygon geofence.
+ *
+ * The vertices are given in order, the last one being connected to the first one.
+ *
+ * @return
+ *    - Reference to the geofence.
+ *    - NULL if there are less than 3 vertices or if a parameter is invalid.
+ */
+//--------------------------------------------------------------------------------------------------
+le_pos_FenceRef_t le_pos_CreatePolygonFence
+(
+    const int32_t* latitudePtr,             ///< [IN] WGS84 Latitudes of the vertices in
+                                            ///       degrees, positive North [resolution 1e-6].
+    size_t         latitudeNumElements,     ///< [IN] Number of latitudes.
+    const int32_t* longitudePtr,            ///< [IN] WGS84 Longitudes of the vertices in
+                                            ///       degrees, positive East [resolution 1e-6].
+    size_t         longitudeNumElements     ///< [IN] Number of longitudes.
+)
+{
+    Fence_t* fencePtr;
+    size_t   i;
+
+    if ((NULL == latitudePtr) || (NULL == longitudePtr) ||
+        (latitudeNumElements != longitudeNumElements) ||
+        (latitudeNumElements < 3) || (latitudeNumElements > LE_POS_FENCE_MAX_VERTICES))
+    {
+        LE_ERROR("Invalid polygon: %zu latitudes, %zu longitudes",
+                 latitudeNumElements, longitudeNumElements);
+        return NULL;
+    }
+
+    for (i = 0; i < latitudeNumElements; i++)
+    {
+        if (!IsValidLocation(latitudePtr[i], longitudePtr[i]))
+        {
+            LE_ERROR("Invalid polygon vertex %zu [%d,%d]", i, latitudePtr[i], longitudePtr[i]);
+            return NULL;
+        }
+    }
+
+    fencePtr = le_mem_ForceAlloc(FencePoolRef);
+    fencePtr->shape = FENCE_SHAPE_POLYGON;
+    fencePtr->vertexCount = latitudeNumElements;
+    fencePtr->minLat = LATITUDE_MAX;
+    fencePtr->maxLat = -LATITUDE_MAX;
+    fencePtr->minLon = LONGITUDE_MAX;
+    fencePtr->maxLon = -LONGITUDE_MAX;
+
+    for (i = 0; i < latitudeNumElements; i++)
+    {
+        fencePtr->vertexLat[i] = latitudePtr[i];
+        fencePtr->vertexLon[i] = longitudePtr[i];
+
+        if (latitudePtr[i] < fencePtr->minLat)
+        {
+            fencePtr->minLat = latitudePtr[i];
+        }
+        if (latitudePtr[i] > fencePtr->maxLat)
+        {
+            fencePtr->maxLat = latitudePtr[i];
+        }
+        if (longitudePtr[i] < fencePtr->minLon)
+        {
+            fencePtr->minLon = longitudePtr[i];
+        }
+        if (longitudePtr[i] > fencePtr->maxLon)
+        {
+            fencePtr->maxLon = longitudePtr[i];
+        }
+    }
+
+    return AddFence(fencePtr);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete a geofence.
+ *
+ * @note If the caller is passing an invalid geofence reference into this function,
+ *       it is a fatal error, the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+void le_pos_DeleteFence
+(
+    le_pos_FenceRef_t fenceRef      ///< [IN] Geofence reference.
+)
+{
+    Fence_t* fencePtr = le_ref_Lookup(FenceRefMap, fenceRef);
+
+    if (NULL == fencePtr)
+    {
+        LE_KILL_CLIENT("Invalid reference (%p) provided!", fenceRef);
+        return;
+    }
+
+    DeleteFence(fencePtr);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file le_pos_local.h
+ *
+ * Local Positioning Definitions, shared by the position and geofence modules.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#ifndef LEGATO_POS_LOCAL_INCLUDE_GUARD
+#define LEGATO_POS_LOCAL_INCLUDE_GUARD
+
+#include "legato.h"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start receiving the GNSS position samples, if not already done.
+ *
+ * @return LE_FAULT  The function failed.
+ * @return LE_OK     The function succeed.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t pos_EnableSampleHandler
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stop receiving the GNSS position samples, if there is no more movement or geofence handler.
+ */
+//--------------------------------------------------------------------------------------------------
+void pos_DisableSampleHandler
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initialize the geofences.
+ */
+//--------------------------------------------------------------------------------------------------
+void posFence_Init
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if the geofences need the position samples.
+ *
+ * @return true if at least one geofence handler is registered.
+ */
+//--------------------------------------------------------------------------------------------------
+bool posFence_IsActive
+(
+    void
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check the geofences against a new location, and report their transitions.
+ */
+//--------------------------------------------------------------------------------------------------
+void posFence_ProcessLocation
+(
+    int32_t latitude,       ///< [IN] WGS84 Latitude in degrees [resolution 1e-6].
+    int32_t longitude       ///< [IN] WGS84 Longitude in degrees [resolution 1e-6].
+);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Delete the geofences and geofence handlers of a closed client session.
+ */
+//--------------------------------------------------------------------------------------------------
+void posFence_CloseSession
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] Closed client session.
+);
+
+#endif // LEGATO_POS_LOCAL_INCLUDE_GUARD
@@ -2,18 +2,30 @@
 /**
  *  SMS Inbox Server
  *
- * When the service is activated, or when a SMS is received, the SMS is copied from the SIM to a
- * specific folder (SMSINBOX_PATH/MSG_PATH).
- *
- * Each SMS is copied into a dedicated file (named with a unique message identifier). The data
- * are stored using the Jannsson representation: Each data (imsi, SMS format, message length,
- * text/pdu, sender telephone number, timestamp, read/unread) are recorded with a key to retrieve
- * each value.
- *
- * Each application using the SMS Inbox Server possesses a configuration file in
- * SMSINBOX_PATH/CONF_PATH directory (also encoding using Jansson format): this file is used to
- * store the message identifier contained in the application mailbox. It is updated each time is new
- * SMS is received.
+ * When the service is activated, or when a SMS is received, the SMS is copied from the SIM to the
+ * message store (SMSINBOX_PATH/LOG_FILE).
+ *
+ * The message store is an append-only log of records:
+ * - a message record holds all the data of a SMS (imsi, SMS format, message length, text/binary/
+ *   pdu, sender telephone number, timestamp) and the message boxes of the applications holding
+ *   it, with its read/unread status in each of them;
+ * - a state record changes the status of a message in one message box (read/unread, deleted).
+ *   A compacted store starts with a state record for no message box, holding the highest message
+ *   identifier given so far, so that the identifiers of deleted messages are not given again.
+ *
+ * A message deleted from all the message boxes is gone. Each record is protected by a CRC, so a
+ * record torn by a power cut is dropped when the store is opened.
+ *
+ * The store is opened the first time a message box is opened or a SMS is received: the log is
+ * replayed into an in-memory index, made of a hashmap of the messages by message identifier and,
+ * for each message box, the list of its messages in message identifier order. The API functions
+ * are served from the index (only the payload is read from the log), and only append a record
+ * to the log when they change something. When the log is mostly made of dead records, the live
+ * messages are written into a new log that replaces it.
+ *
+ * Earlier versions of the service stored each SMS into a dedicated Jansson file (SMSINBOX_PATH/
+ * MSG_PATH) and the message identifiers of each message box into another one (SMSINBOX_PATH/
+ * CONF_PATH). Those files are imported into the message store when it is opened, then removed.
  *
  *  Copyright (C) Sierra Wireless Inc.
  */
@@ -44,19 +56,33 @@
 #else
 #define SMSINBOX_PATH "/tmp/smsInbox/"
 #endif
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message store file, and the file it is compacted into.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_FILE     "messages.log"
+#define LOG_TMP_FILE "messages.log.tmp"
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Legacy message and message box directories.
+ */
+//--------------------------------------------------------------------------------------------------
 #define MSG_PATH "msg/"
 #define CONF_PATH "cfg/"
 
 //--------------------------------------------------------------------------------------------------
 /**
- * File extension definition.
+ * Legacy file extension definition.
  */
 //--------------------------------------------------------------------------------------------------
 #define FILE_EXTENSION ".json"
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Json keys.
+ * Legacy Json keys.
  */
 //--------------------------------------------------------------------------------------------------
 #define JSON_FORMAT "format"
@@ -71,6 +97,61 @@
 #define JSON_ISDELETED "isDeleted"
 #define JSON_MSGINBOX "msgInBox"
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message store header. The version must be changed if the record format changes.
+ */
+//--------------------------------------------------------------------------------------------------
+#define LOG_MAGIC     "SMSINBX1"
+#define LOG_MAGIC_LEN 8
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record types.
+ */
+//--------------------------------------------------------------------------------------------------
+#define RECORD_MSG   1      ///< Message, with its status in each message box
+#define RECORD_STATE 2      ///< New status of a message in a message box
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Status of a message in a message box.
+ */
+//--------------------------------------------------------------------------------------------------
+#define STATE_IN_MBOX 0x01  ///< Message is in the message box (not deleted)
+#define STATE_UNREAD  0x02  ///< Message is unread
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Optional fields of a message.
+ */
+//--------------------------------------------------------------------------------------------------
+#define FIELD_SENDERTEL 0x01
+#define FIELD_TIMESTAMP 0x02
+#define FIELD_PAYLOAD   0x04
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of a record body.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_RECORD_LEN 1024
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Maximum length of a message payload (text, binary or PDU, with the text terminating null).
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_PAYLOAD_LEN (LE_SMS_PDU_MAX_BYTES+1)
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of bytes of dead records above which the message store is compacted, if there are also
+ * more of them than of live records.
+ */
+//--------------------------------------------------------------------------------------------------
+#define COMPACT_THRESHOLD 16384
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Maximum number of user applications.
@@ -139,40 +220,87 @@ typedef uint32_t MessageId_t;
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    json_t* jsonObjPtr;
-    json_t* jsonArrayPtr;
-    uint32_t currentMessageIndex;
-    uint32_t maxIndex;
+    MessageId_t currentMessageId;   ///< Last message returned (0 if not browsing)
+    MessageId_t lastMessageId;      ///< Last message of the message box when browsing started
 }
 BrowseCtx_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Entry description structure.
+ * Record header structure.
  *
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct
 {
-    enum
-    {
-        DESC_INT,
-        DESC_STRING,
-        DESC_BOOL
-    }                               type;       ///< Union type (string or integer
-    union
-    {
-        struct
-        {
-            char*   strPtr;                     ///< String
-            size_t  lenStr;                     ///< Length of the string
-        }                  str;                 ///< Value for string
-        uint32_t           val;                 ///< Value for integer
-        bool               boolVal;             ///< Boolean value
-    }                               uVal;       ///< Union type
+    uint8_t     type;               ///< Record type (RECORD_MSG or RECORD_STATE)
+    uint8_t     reserved;           ///< Reserved, 0
+    uint16_t    len;                ///< Length of the record body
+    uint32_t    crc;                ///< CRC32 of the record body
+}
+RecordHeader_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record being encoded.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t     data[sizeof(RecordHeader_t) + MAX_RECORD_LEN];  ///< Record header and body
+    size_t      len;                                            ///< Length of the body so far
+    bool        isOverflow;                                     ///< Body didn't fit
+}
+RecordBuf_t;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record being decoded.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const uint8_t*  dataPtr;        ///< Record body
+    size_t          len;            ///< Length of the record body
+    size_t          pos;            ///< Current position in the record body
+    bool            isError;        ///< Body is too short or malformed
 }
-EntryDesc_t;
+RecordReader_t;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message structure (message index entry).
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    MessageId_t     id;                                         ///< Message identifier
+    le_sms_Format_t format;                                     ///< SMS format
+    uint32_t        msgLen;                                     ///< Message length
+    uint8_t         fields;                                     ///< Optional fields (FIELD_xxx)
+    char            imsi[LE_SIM_IMSI_BYTES];                    ///< IMSI of the SIM
+    char            senderTel[LE_MDMDEFS_PHONE_NUM_MAX_BYTES];  ///< Sender telephone number
+    char            timestamp[LE_SMS_TIMESTAMP_MAX_BYTES];      ///< Time stamp
+    uint16_t        payloadLen;                                 ///< Length of the payload
+    uint16_t        payloadPos;                                 ///< Position of the payload
+                                                                ///  in the message record
+    off_t           recordOffset;                               ///< Offset of the message
+                                                                ///  record in the log
+    size_t          recordLen;                                  ///< Length of the message record
+    off_t           compactOffset;                              ///< recordOffset and recordLen
+    size_t          compactLen;                                 ///  in the compacted log
+    uint32_t        mboxMask;                                   ///< Message boxes holding it
+                                                                ///  (bit per Apps[] entry)
+    uint32_t        unreadMask;                                 ///< Message boxes where it is
+                                                                ///  unread
+    le_dls_Link_t   link;                                       ///< Link in the message list
+    le_dls_Link_t   mboxLinks[MAX_APPS];                        ///< Links in the message box
+                                                                ///  message lists
+}
+Message_t;
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -185,7 +313,7 @@ typedef struct
     char *    namePtr;                  ///< App name
     uint32_t inboxSize;                 ///< Max messages in the inbox
     uint32_t msgCount;                  ///< Number message
-
+    le_dls_List_t msgList;              ///< Messages, in message identifier order
 }
 MboxCtx_t;
 
@@ -319,6 +447,48 @@ static char SimImsi[LE_SIM_IMSI_BYTES];
 //--------------------------------------------------------------------------------------------------
 static MessageId_t NextMessageId = 1;
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory Pool for the messages.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t MsgPool;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Messages, by message identifier.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t MsgMap;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Messages, in message identifier order.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t MsgList = LE_DLS_LIST_INIT;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Message store file descriptor (-1 until the store is opened).
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static int LogFd = -1;
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Size of the message store, and number of bytes of its live records (latest message record of
+ * each message in the index).
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static off_t LogSize;
+static off_t LiveBytes;
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Memory Pool for SmsInbox Client Handler.
@@ -336,502 +506,706 @@ static le_ref_MapRef_t ActivationRequestRefMap;
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add a boolean value of a key in a Jason object
+ * Find a message box by name
  *
+ * @return
+ *      - Index of the message box in Apps[]
+ *      - -1 if there is no such message box
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddBooleanKeyInJsonObject
+static int FindMbox
 (
-    json_t *jsonObjPtr, ///<[IN] json object
-    const char* key,    ///<[IN] Key to be added
-    bool value          ///<[IN] Value to be added
+    const char* namePtr     ///<[IN] Message box name
 )
 {
-    json_t *jsonBoolPtr;
-    int ret = -1;
+    int i;
 
-    if ( value == true )
-    {
-        jsonBoolPtr = json_true();
-    }
-    else
+    for (i = 0; i < MAX_APPS; i++)
     {
-        jsonBoolPtr = json_false();
+        if (Apps[i].namePtr && (strcmp(Apps[i].namePtr, namePtr) == 0))
+        {
+            return i;
+        }
     }
 
-    if (jsonBoolPtr)
+    return -1;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the link of a message in the message list, or in a message box message list
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_Link_t* GetMsgLink
+(
+    Message_t* msgPtr,      ///<[IN] Message
+    int mboxIdx             ///<[IN] Message box index in Apps[], or -1 for the message list
+)
+{
+    return (mboxIdx < 0) ? &msgPtr->link : &msgPtr->mboxLinks[mboxIdx];
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the message of a link in the message list, or in a message box message list
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static Message_t* GetLinkMsg
+(
+    le_dls_Link_t* linkPtr, ///<[IN] Link
+    int mboxIdx             ///<[IN] Message box index in Apps[], or -1 for the message list
+)
+{
+    if (mboxIdx < 0)
     {
-        ret = json_object_set_new(jsonObjPtr, key, jsonBoolPtr);
+        return CONTAINER_OF(linkPtr, Message_t, link);
     }
-    else
+
+    return CONTAINER_OF(linkPtr - mboxIdx, Message_t, mboxLinks[0]);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Insert a message in the message list, or in a message box message list, in message identifier
+ * order. New messages have the highest identifier, so the list is searched from its tail.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void InsertMsgInList
+(
+    Message_t* msgPtr,      ///<[IN] Message
+    int mboxIdx             ///<[IN] Message box index in Apps[], or -1 for the message list
+)
+{
+    le_dls_List_t* listPtr = (mboxIdx < 0) ? &MsgList : &Apps[mboxIdx].msgList;
+    le_dls_Link_t* linkPtr = le_dls_PeekTail(listPtr);
+
+    while (linkPtr && (GetLinkMsg(linkPtr, mboxIdx)->id > msgPtr->id))
     {
-        LE_ERROR("Error during set of the key %s", key);
+        linkPtr = le_dls_PeekPrev(listPtr, linkPtr);
     }
 
-    if (ret == 0)
+    *GetMsgLink(msgPtr, mboxIdx) = LE_DLS_LINK_INIT;
+
+    if (linkPtr)
     {
-        return LE_OK;
+        le_dls_AddAfter(listPtr, linkPtr, GetMsgLink(msgPtr, mboxIdx));
     }
     else
     {
-        return LE_FAULT;
+        le_dls_Stack(listPtr, GetMsgLink(msgPtr, mboxIdx));
     }
 }
 
-
 //--------------------------------------------------------------------------------------------------
 /**
- * Add an integer value of a key in a Jason object
+ * Remove a message from the index, and free it
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddIntegerKeyInJsonObject
+static void UnindexMsg
 (
-    json_t *jsonObjPtr, ///<[IN] json object
-    const char* key,    ///<[IN] Key to be added
-    int  value          ///<[IN] Value to be added
+    Message_t* msgPtr       ///<[IN] Message
 )
 {
-    json_t *jsonIntPtr = json_integer(value);
-    int ret = -1;
+    int i;
 
-    if (jsonIntPtr)
+    for (i = 0; i < MAX_APPS; i++)
     {
-        if (json_is_array(jsonObjPtr))
-        {
-            ret = json_array_append_new(jsonObjPtr, jsonIntPtr);
-        }
-        else
+        if (msgPtr->mboxMask & (1U << i))
         {
-            ret = json_object_set_new(jsonObjPtr, key, jsonIntPtr);
+            le_dls_Remove(&Apps[i].msgList, &msgPtr->mboxLinks[i]);
+            Apps[i].msgCount--;
         }
     }
-    else
-    {
-        LE_ERROR("Error during set of the key %s", key);
-    }
 
-    if (ret == 0)
-    {
-        return LE_OK;
-    }
-    else
-    {
-        return LE_FAULT;
-    }
+    le_dls_Remove(&MsgList, &msgPtr->link);
+    le_hashmap_Remove(MsgMap, &msgPtr->id);
+    LiveBytes -= msgPtr->recordLen;
+
+    le_mem_Release(msgPtr);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add a string value of a key in a Jason object
+ * Add a message to the index, replacing the message with the same identifier if any. A message
+ * which is in no message box is freed.
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddStringKeyInJsonObject
+static void IndexMsg
 (
-    json_t *jsonObjPtr, ///<[IN] json object
-    const char* key,    ///<[IN] Key to be added
-    char* string        ///<[IN] String to be added
+    Message_t* msgPtr       ///<[IN] Message
 )
 {
-    json_t * jsonStrPtr = json_string(string);
-    int ret = -1;
+    Message_t* oldMsgPtr = le_hashmap_Get(MsgMap, &msgPtr->id);
+    int i;
 
-    if (jsonStrPtr)
+    if (oldMsgPtr)
     {
-        ret = json_object_set_new(jsonObjPtr, key, jsonStrPtr);
+        UnindexMsg(oldMsgPtr);
     }
-    else
+
+    if (msgPtr->id >= NextMessageId)
     {
-        LE_ERROR("Error during set of the key %s", key);
+        NextMessageId = msgPtr->id + 1;
     }
 
-    if (ret == 0)
+    if (0 == msgPtr->mboxMask)
     {
-        return LE_OK;
+        le_mem_Release(msgPtr);
+        return;
     }
-    else
+
+    InsertMsgInList(msgPtr, -1);
+
+    for (i = 0; i < MAX_APPS; i++)
     {
-        return LE_FAULT;
+        if (msgPtr->mboxMask & (1U << i))
+        {
+            InsertMsgInList(msgPtr, i);
+            Apps[i].msgCount++;
+        }
     }
+
+    le_hashmap_Put(MsgMap, &msgPtr->id, msgPtr);
+    LiveBytes += msgPtr->recordLen;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the SMSInbox directory path length
+ * Get the status of a message in a message box
  *
+ * @return STATE_xxx flags
  */
 //--------------------------------------------------------------------------------------------------
-static uint32_t GetSMSInboxMessagePathLen
+static uint8_t GetMsgState
 (
-    void
+    const Message_t* msgPtr,    ///<[IN] Message
+    int mboxIdx                 ///<[IN] Message box index in Apps[]
 )
 {
-    return 2*sizeof(MessageId_t)+strlen(SMSINBOX_PATH)+strlen(MSG_PATH)+strlen(FILE_EXTENSION)+1;
+    uint8_t state = 0;
+
+    if (msgPtr->mboxMask & (1U << mboxIdx))
+    {
+        state |= STATE_IN_MBOX;
+    }
+
+    if (msgPtr->unreadMask & (1U << mboxIdx))
+    {
+        state |= STATE_UNREAD;
+    }
+
+    return state;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the SMSInbox file path
+ * Set the status of a message in a message box in the index. A message deleted from its last
+ * message box is freed.
  *
  */
 //--------------------------------------------------------------------------------------------------
-static void GetSMSInboxMessagePath
+static void SetMsgState
 (
-    MessageId_t messageId,  ///[IN] message identifier
-    char* pathPtr,          ///<[OUT] path of the messageId file
-    uint32_t pathLen        ///<[IN] Length of pathPtr
+    Message_t* msgPtr,      ///<[IN] Message
+    int mboxIdx,            ///<[IN] Message box index in Apps[]
+    uint8_t state           ///<[IN] STATE_xxx flags
 )
 {
-    snprintf(pathPtr, pathLen, "%s%s%08x%s", SMSINBOX_PATH, MSG_PATH,
-                                            (int) messageId,
-                                            FILE_EXTENSION);
+    uint32_t mboxBit = 1U << mboxIdx;
+
+    if (state & STATE_UNREAD)
+    {
+        msgPtr->unreadMask |= mboxBit;
+    }
+    else
+    {
+        msgPtr->unreadMask &= ~mboxBit;
+    }
+
+    // A message is only added to a message box by its message record.
+    if (!(state & STATE_IN_MBOX) && (msgPtr->mboxMask & mboxBit))
+    {
+        le_dls_Remove(&Apps[mboxIdx].msgList, &msgPtr->mboxLinks[mboxIdx]);
+        Apps[mboxIdx].msgCount--;
+        msgPtr->mboxMask &= ~mboxBit;
+
+        if (0 == msgPtr->mboxMask)
+        {
+            UnindexMsg(msgPtr);
+        }
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the SMSInbox configuration path length
+ * Add bytes to a record body
  *
  */
 //--------------------------------------------------------------------------------------------------
-static uint32_t GetSMSInboxConfigPathLen
+static void PutBytes
 (
-    char* appNamePtr    ///<[IN] Application name
+    RecordBuf_t* bufPtr,    ///<[IN] Record
+    const void* dataPtr,    ///<[IN] Bytes to add
+    size_t len              ///<[IN] Number of bytes
 )
 {
-    return strlen(appNamePtr)+strlen(SMSINBOX_PATH)+strlen(CONF_PATH)+strlen(FILE_EXTENSION)+1;
+    if (bufPtr->isOverflow || (bufPtr->len + len > MAX_RECORD_LEN))
+    {
+        bufPtr->isOverflow = true;
+        return;
+    }
+
+    memcpy(&bufPtr->data[sizeof(RecordHeader_t) + bufPtr->len], dataPtr, len);
+    bufPtr->len += len;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Get the application's box file descriptor path
+ * Add integers to a record body (host byte order)
  *
  */
 //--------------------------------------------------------------------------------------------------
-static void GetSMSInboxConfigPath
+static void PutU8
+(
+    RecordBuf_t* bufPtr,    ///<[IN] Record
+    uint8_t value           ///<[IN] Value to add
+)
+{
+    PutBytes(bufPtr, &value, sizeof(value));
+}
+
+static void PutU16
+(
+    RecordBuf_t* bufPtr,    ///<[IN] Record
+    uint16_t value          ///<[IN] Value to add
+)
+{
+    PutBytes(bufPtr, &value, sizeof(value));
+}
+
+static void PutU32
 (
-    char* appNamePtr,   ///<[IN] Application name
-    char* pathPtr,      ///<[OUT] configuration file path
-    uint32_t pathLen    ///<[IN] path length
+    RecordBuf_t* bufPtr,    ///<[IN] Record
+    uint32_t value          ///<[IN] Value to add
 )
 {
-    snprintf(pathPtr, pathLen, "%s%s%s%s", SMSINBOX_PATH, CONF_PATH, appNamePtr, FILE_EXTENSION);
+    PutBytes(bufPtr, &value, sizeof(value));
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Modify Json object
+ * Add a string to a record body (length byte followed by the characters)
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ModifyJsonObj
+static void PutString
 (
-    json_t* jsonObjPtr,         ///<[IN] Json object (root object)
-    json_t* jsonValPtr,         ///<[IN] Json value to be modified
-    char*   key,                ///<[IN] Key to modify
-    EntryDesc_t * modifPtr      ///<[IN] Requested modification
+    RecordBuf_t* bufPtr,    ///<[IN] Record
+    const char* strPtr      ///<[IN] String to add
 )
 {
-    int res = 0;
+    size_t len = strlen(strPtr);
 
-    if (jsonValPtr == NULL)
+    if (len > UINT8_MAX)
     {
-        return LE_FAULT;
+        bufPtr->isOverflow = true;
+        return;
     }
 
-    switch (modifPtr->type)
-    {
-        case DESC_STRING:
-            // check the type
-            if (json_is_string(jsonValPtr) == false)
-            {
-                LE_ERROR("Bad key format");
-                res = -1;
-            }
-
-            if ( res == 0 )
-            {
-                res = json_string_set(jsonValPtr, modifPtr->uVal.str.strPtr);
-            }
-        break;
-        case DESC_INT:
-            // check the type
-            if (json_is_integer(jsonValPtr) == false )
-            {
-                LE_ERROR("Bad key format");
-                res = -1;
-            }
-
-            if ( res == 0 )
-            {
-                res = json_integer_set(jsonValPtr, modifPtr->uVal.val);
-            }
-        break;
-        case DESC_BOOL:
-            // check the type
-            if ( (json_is_true(jsonValPtr) != true) && (json_is_false(jsonValPtr) != true) )
-            {
-                LE_ERROR("Bad key format");
-                res = -1;
-            }
-
-            if (( res == 0 ) &&
-                (AddBooleanKeyInJsonObject(jsonObjPtr, key, modifPtr->uVal.boolVal) != LE_OK))
-            {
-                res = -1;
-            }
-        break;
-        default:
-            res = -1;
-        break;
-    }
+    PutU8(bufPtr, len);
+    PutBytes(bufPtr, strPtr, len);
+}
 
-    if (res < 0)
-    {
-        LE_ERROR(("Update error %d"), modifPtr->type);
-        return LE_FAULT;
-    }
-    else
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get bytes from a record body
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetBytes
+(
+    RecordReader_t* readerPtr,  ///<[IN] Record
+    void* dataPtr,              ///<[OUT] Bytes
+    size_t len                  ///<[IN] Number of bytes
+)
+{
+    if (readerPtr->isError || (readerPtr->pos + len > readerPtr->len))
     {
-        return LE_OK;
+        readerPtr->isError = true;
+        memset(dataPtr, 0, len);
+        return;
     }
 
+    memcpy(dataPtr, &readerPtr->dataPtr[readerPtr->pos], len);
+    readerPtr->pos += len;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Modify message file
+ * Get integers from a record body (host byte order)
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ModifyMsgEntry
+static uint8_t GetU8
 (
-    MessageId_t messageId,      ///<[IN] Message identifier to be modified
-    char* keyPtr[],              ///<[IN] Key to modify
-    uint8_t nbKey,              ///<[IN] Number of elements in keyPtr
-    EntryDesc_t * modifPtr      ///<[IN] Requested modification
+    RecordReader_t* readerPtr   ///<[IN] Record
 )
 {
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    json_error_t error;
-    le_result_t res;
-    int indexKey = -1;
+    uint8_t value;
 
-    GetSMSInboxMessagePath(messageId, path, pathLen);
+    GetBytes(readerPtr, &value, sizeof(value));
+    return value;
+}
+
+static uint16_t GetU16
+(
+    RecordReader_t* readerPtr   ///<[IN] Record
+)
+{
+    uint16_t value;
+
+    GetBytes(readerPtr, &value, sizeof(value));
+    return value;
+}
 
-    json_t* jsonRootPtr = json_load_file(path, 0, &error);
+static uint32_t GetU32
+(
+    RecordReader_t* readerPtr   ///<[IN] Record
+)
+{
+    uint32_t value;
+
+    GetBytes(readerPtr, &value, sizeof(value));
+    return value;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a string from a record body
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void GetString
+(
+    RecordReader_t* readerPtr,  ///<[IN] Record
+    char* strPtr,               ///<[OUT] String
+    size_t size                 ///<[IN] Size of strPtr
+)
+{
+    size_t len = GetU8(readerPtr);
 
-    if ( jsonRootPtr == NULL )
+    if (len >= size)
     {
-        LE_ERROR("json decoder error %s", error.text);
-        return LE_FAULT;
+        readerPtr->isError = true;
+        strPtr[0] = '\0';
+        return;
     }
 
-    json_t* jsonValPtr = jsonRootPtr;
-    json_t* jsonSubObjPtr = jsonRootPtr;
+    GetBytes(readerPtr, strPtr, len);
+    strPtr[len] = '\0';
+}
 
-    while ( ( json_is_object(jsonValPtr) == true ) && ( nbKey > indexKey ) )
+//--------------------------------------------------------------------------------------------------
+/**
+ * Encode a message record
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the record is too long
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t EncodeMsgRecord
+(
+    RecordBuf_t* bufPtr,        ///<[OUT] Record
+    Message_t* msgPtr,          ///<[IN] Message (its payloadPos is updated)
+    const uint8_t* payloadPtr   ///<[IN] Payload
+)
+{
+    uint8_t nbMbox = 0;
+    int i;
+
+    bufPtr->len = 0;
+    bufPtr->isOverflow = false;
+
+    PutU32(bufPtr, msgPtr->id);
+    PutU8(bufPtr, (uint8_t) msgPtr->format);
+    PutU32(bufPtr, msgPtr->msgLen);
+    PutU8(bufPtr, msgPtr->fields);
+    PutString(bufPtr, msgPtr->imsi);
+
+    if (msgPtr->fields & FIELD_SENDERTEL)
     {
-        indexKey++;
-        jsonSubObjPtr = jsonValPtr;
-        jsonValPtr = json_object_get(jsonSubObjPtr, keyPtr[indexKey]);
+        PutString(bufPtr, msgPtr->senderTel);
     }
 
-    if ( !jsonValPtr )
+    if (msgPtr->fields & FIELD_TIMESTAMP)
     {
-        if ((indexKey > -1) && (indexKey < nbKey))
-        {
-            LE_ERROR("Unable to get the object %s", keyPtr[indexKey]);
-        }
-        else
-        {
-            LE_ERROR("indexKey: %d is out of range", indexKey);
-        }
-
-        res = LE_FAULT;
+        PutString(bufPtr, msgPtr->timestamp);
     }
-    else
+
+    if (msgPtr->fields & FIELD_PAYLOAD)
     {
-        res = ModifyJsonObj(jsonSubObjPtr, jsonValPtr, keyPtr[indexKey], modifPtr);
+        PutU16(bufPtr, msgPtr->payloadLen);
+        msgPtr->payloadPos = sizeof(RecordHeader_t) + bufPtr->len;
+        PutBytes(bufPtr, payloadPtr, msgPtr->payloadLen);
     }
 
-    if ( res == LE_OK )
+    for (i = 0; i < MAX_APPS; i++)
     {
-        if (json_dump_file(jsonRootPtr, path, JSON_INDENT(1) | JSON_PRESERVE_ORDER) < 0)
+        if (msgPtr->mboxMask & (1U << i))
         {
-            LE_ERROR("json error");
-            res = LE_FAULT;
+            nbMbox++;
         }
     }
-    else
+
+    PutU8(bufPtr, nbMbox);
+
+    for (i = 0; i < MAX_APPS; i++)
     {
-        LE_ERROR("Something was wrong in ModifyJsonObj");
+        if (msgPtr->mboxMask & (1U << i))
+        {
+            PutString(bufPtr, Apps[i].namePtr);
+            PutU8(bufPtr, GetMsgState(msgPtr, i));
+        }
     }
 
-    json_decref(jsonRootPtr);
-
-    return res;
+    return bufPtr->isOverflow ? LE_OVERFLOW : LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read Json object
+ * Decode a message record. Message boxes which are not configured any more are ignored.
  *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT if the record is malformed
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t ReadJsonObj
+static le_result_t DecodeMsgRecord
 (
-    json_t* jsonValPtr,         ///<[IN] Json value to be read
-    char* keyPtr[],             ///<[IN] Key to read
-    uint8_t nbKey,              ///<[IN] Number of elements in keyPtr
-    EntryDesc_t * decodePtr     ///<[OUT] Decoding result
+    RecordReader_t* readerPtr,  ///<[IN] Record body
+    Message_t* msgPtr           ///<[OUT] Message
 )
 {
-    le_result_t res = LE_OK;
+    uint8_t nbMbox;
+
+    msgPtr->id = GetU32(readerPtr);
+    msgPtr->format = (le_sms_Format_t) GetU8(readerPtr);
+    msgPtr->msgLen = GetU32(readerPtr);
+    msgPtr->fields = GetU8(readerPtr);
+    GetString(readerPtr, msgPtr->imsi, sizeof(msgPtr->imsi));
 
-    if ( jsonValPtr == NULL )
+    if (msgPtr->fields & FIELD_SENDERTEL)
     {
-        LE_ERROR("No information");
-        return LE_FAULT;
+        GetString(readerPtr, msgPtr->senderTel, sizeof(msgPtr->senderTel));
     }
 
-    switch json_typeof(jsonValPtr)
+    if (msgPtr->fields & FIELD_TIMESTAMP)
     {
-        case JSON_STRING:
-        {
-            if ( decodePtr->type != DESC_STRING )
-            {
-                res = LE_FAULT;
-                LE_ERROR("Bad format");
-            }
+        GetString(readerPtr, msgPtr->timestamp, sizeof(msgPtr->timestamp));
+    }
 
-            if (res == LE_OK)
-            {
-                const char* strPtr = json_string_value((const json_t *)jsonValPtr);
-
-                if ( strlen(strPtr) >= decodePtr->uVal.str.lenStr )
-                {
-                    LE_ERROR("String too long");
-                    res = LE_OVERFLOW;
-                }
-                else
-                {
-                    strncpy(decodePtr->uVal.str.strPtr, strPtr, decodePtr->uVal.str.lenStr);
-                    decodePtr->uVal.str.lenStr = strlen(strPtr);
-                }
-            }
-        }
-        break;
-        case JSON_INTEGER:
+    if (msgPtr->fields & FIELD_PAYLOAD)
+    {
+        msgPtr->payloadLen = GetU16(readerPtr);
+        msgPtr->payloadPos = sizeof(RecordHeader_t) + readerPtr->pos;
+
+        if ((msgPtr->payloadLen > MAX_PAYLOAD_LEN) ||
+            (readerPtr->pos + msgPtr->payloadLen > readerPtr->len))
         {
-            if ( decodePtr->type != DESC_INT )
-            {
-                LE_ERROR("Bad format");
-                res = LE_FAULT;
-            }
-            else
-            {
-                decodePtr->uVal.val = json_integer_value((const json_t *)jsonValPtr);
-            }
+            return LE_FAULT;
         }
-        break;
-        case JSON_TRUE:
-        case JSON_FALSE:
+
+        readerPtr->pos += msgPtr->payloadLen;
+    }
+
+    nbMbox = GetU8(readerPtr);
+
+    while (nbMbox-- && !readerPtr->isError)
+    {
+        char name[UINT8_MAX + 1];
+
+        GetString(readerPtr, name, sizeof(name));
+
+        uint8_t state = GetU8(readerPtr);
+        int mboxIdx = FindMbox(name);
+
+        if ((mboxIdx >= 0) && (state & STATE_IN_MBOX))
         {
-            if ( decodePtr->type != DESC_BOOL )
-            {
-                LE_ERROR("Bad format");
-                res = LE_FAULT;
-            }
-            else
+            msgPtr->mboxMask |= 1U << mboxIdx;
+
+            if (state & STATE_UNREAD)
             {
-                decodePtr->uVal.boolVal = json_is_true((const json_t *)jsonValPtr);
+                msgPtr->unreadMask |= 1U << mboxIdx;
             }
         }
-        break;
-        case JSON_OBJECT:
+    }
+
+    return readerPtr->isError ? LE_FAULT : LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write a buffer into a file
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT on failure
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t WriteAll
+(
+    int fd,                 ///<[IN] File descriptor
+    const void* dataPtr,    ///<[IN] Data to write
+    size_t len              ///<[IN] Length of the data
+)
+{
+    const uint8_t* restPtr = dataPtr;
+    ssize_t writtenSize;
+
+    while (len > 0)
+    {
+        writtenSize = write(fd, restPtr, len);
+
+        if (writtenSize < 0)
         {
-            // if key-value is an object, read the next key
-            if (nbKey >= 1)
-            {
-                json_t* jsonSubValPtr = json_object_get(jsonValPtr, keyPtr[0]);
-
-                if ( jsonSubValPtr )
-                {
-                    res = ReadJsonObj(jsonSubValPtr, &keyPtr[1], nbKey-1,  decodePtr );
-                }
-                else
-                {
-                    res = LE_FAULT;
-                }
-            }
-            else
+            if (EINTR == errno)
             {
-                res = LE_FAULT;
+                continue;
             }
+
+            LE_ERROR("Write error: %m");
+            return LE_FAULT;
         }
-        break;
-        case JSON_ARRAY:
-        case JSON_REAL:
-        case JSON_NULL:
-        default:
-            res = LE_FAULT;
-        break;
+
+        len -= writtenSize;
+        restPtr += writtenSize;
     }
 
-    return res;
+    return LE_OK;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Read Application's config file
+ * Write a record into a file
  *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT on failure
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t GetMsgListFromMbox
+static le_result_t WriteRecord
 (
-    char* pathPtr,              ///<[IN] Application's config file path
-    json_t **jsonRootObjPtr,    ///<[OUT] json root object
-    json_t **jsonArrayPtr       ///<[OUT] messages in box list
+    int fd,                 ///<[IN] File descriptor
+    RecordBuf_t* bufPtr,    ///<[IN] Record
+    uint8_t type            ///<[IN] Record type
 )
 {
-    json_error_t error;
-    *jsonRootObjPtr = json_load_file(pathPtr, 0, &error);
+    RecordHeader_t header;
+
+    header.type = type;
+    header.reserved = 0;
+    header.len = bufPtr->len;
+    header.crc = le_crc_Crc32(&bufPtr->data[sizeof(RecordHeader_t)],
+                              bufPtr->len,
+                              LE_CRC_START_CRC32);
+
+    memcpy(bufPtr->data, &header, sizeof(header));
 
-    if ( !(*jsonRootObjPtr) )
+    return WriteAll(fd, bufPtr->data, sizeof(header) + bufPtr->len);
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a record to the message store
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT on failure (the store is left unchanged)
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t AppendRecord
+(
+    RecordBuf_t* bufPtr,    ///<[IN] Record
+    uint8_t type,           ///<[IN] Record type
+    off_t* offsetPtr        ///<[OUT] Offset of the record in the store
+)
+{
+    if (LogFd < 0)
     {
-        // File doesn't exist, create objects
-        *jsonRootObjPtr = json_object();
+        LE_ERROR("Message store is not open");
+        return LE_FAULT;
+    }
 
-        if ( !(*jsonRootObjPtr) )
+    if (WriteRecord(LogFd, bufPtr, type) != LE_OK)
+    {
+        // Don't leave a partial record behind, the next ones would be dropped at replay.
+        if (ftruncate(LogFd, LogSize) < 0)
         {
-            LE_ERROR("json error");
-            return LE_FAULT;
+            LE_ERROR("Unable to truncate the message store: %m");
         }
+
+        return LE_FAULT;
     }
 
-    *jsonArrayPtr = json_object_get(*jsonRootObjPtr, JSON_MSGINBOX);
+    if (offsetPtr)
+    {
+        *offsetPtr = LogSize;
+    }
+
+    LogSize += sizeof(RecordHeader_t) + bufPtr->len;
 
-    if ( !(*jsonArrayPtr) )
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the payload of a message from the message store
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT on failure
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadPayload
+(
+    const Message_t* msgPtr,    ///<[IN] Message
+    uint8_t* payloadPtr         ///<[OUT] Payload (payloadLen bytes)
+)
+{
+    off_t offset = msgPtr->recordOffset + msgPtr->payloadPos;
+    size_t len = msgPtr->payloadLen;
+    ssize_t readSize;
+
+    while (len > 0)
     {
-        // Array doesn't exist, create it
-        *jsonArrayPtr = json_array();
+        readSize = pread(LogFd, payloadPtr, len, offset);
 
-        if (!(*jsonArrayPtr))
+        if (readSize < 0)
         {
-            json_decref(*jsonRootObjPtr);
-            LE_ERROR("json error");
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            LE_ERROR("Unable to read message %08x: %m", (int) msgPtr->id);
             return LE_FAULT;
         }
 
-        if ( json_object_set(*jsonRootObjPtr, JSON_MSGINBOX, *jsonArrayPtr) < 0 )
+        if (0 == readSize)
         {
-            json_decref(*jsonRootObjPtr);
-            LE_ERROR("json error");
+            LE_ERROR("Message %08x is truncated", (int) msgPtr->id);
             return LE_FAULT;
         }
+
+        len -= readSize;
+        payloadPtr += readSize;
+        offset += readSize;
     }
 
     return LE_OK;
@@ -839,369 +1213,794 @@ static le_result_t GetMsgListFromMbox
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Remove a message from the application's cfg file
+ * Compact the message store: write the live messages, with their current status, into a new
+ * store which replaces the current one
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t DeleteMsgInAppCfg
+static void CompactStore
 (
-    char *appNamePtr,               ///<[IN] application name
-    MessageId_t deleteMessageId     ///<[IN] message to delete
+    void
 )
 {
-    uint32_t pathLen = GetSMSInboxConfigPathLen(appNamePtr);
-    char path[pathLen];
-    memset(path,0,pathLen);
-    GetSMSInboxConfigPath(appNamePtr, path, pathLen);
-    json_t *jsonObjPtr;
-    json_t *jsonArrayPtr;
+    le_result_t result = LE_OK;
+    RecordBuf_t buf;
+    off_t offset = LOG_MAGIC_LEN;
 
-    if (GetMsgListFromMbox(path, &jsonObjPtr, &jsonArrayPtr) != LE_OK)
+    LE_DEBUG("Compacting the message store (%lld bytes, %lld live)",
+             (long long) LogSize, (long long) LiveBytes);
+
+    int fd = open(SMSINBOX_PATH LOG_TMP_FILE,
+                  O_RDWR | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC,
+                  S_IRUSR | S_IWUSR);
+
+    if (fd < 0)
     {
-        return LE_FAULT;
+        LE_ERROR("Unable to create %s: %m", SMSINBOX_PATH LOG_TMP_FILE);
+        return;
     }
 
-    int i;
-    MessageId_t messageId;
+    result = WriteAll(fd, LOG_MAGIC, LOG_MAGIC_LEN);
+
+    // Keep the highest message identifier, which may belong to a deleted message. The state record
+    // is for no message box, so it doesn't change any message at replay.
+    if ((LE_OK == result) && (NextMessageId > 1))
+    {
+        buf.len = 0;
+        buf.isOverflow = false;
+        PutU32(&buf, NextMessageId - 1);
+        PutString(&buf, "");
+        PutU8(&buf, 0);
+
+        result = WriteRecord(fd, &buf, RECORD_STATE);
+        offset += sizeof(RecordHeader_t) + buf.len;
+    }
+
+    le_dls_Link_t* linkPtr = le_dls_Peek(&MsgList);
 
-    for (i=0; i < json_array_size(jsonArrayPtr); i++)
+    while (linkPtr && (LE_OK == result))
     {
-        json_t * jsonIntegerPtr = json_array_get(jsonArrayPtr, i);
+        Message_t* msgPtr = GetLinkMsg(linkPtr, -1);
+        uint8_t payload[MAX_PAYLOAD_LEN];
 
-        if (jsonIntegerPtr)
+        if (msgPtr->fields & FIELD_PAYLOAD)
         {
-            messageId = json_integer_value(jsonIntegerPtr);
+            result = ReadPayload(msgPtr, payload);
+        }
 
-            if (messageId == deleteMessageId)
-            {
-                LE_DEBUG("Remove %d", (int) messageId);
-                json_array_remove(jsonArrayPtr, i);
-            }
+        if (LE_OK == result)
+        {
+            result = EncodeMsgRecord(&buf, msgPtr, payload);
         }
-        else
+
+        if (LE_OK == result)
         {
-            LE_ERROR("Json error");
+            result = WriteRecord(fd, &buf, RECORD_MSG);
         }
+
+        msgPtr->compactOffset = offset;
+        msgPtr->compactLen = sizeof(RecordHeader_t) + buf.len;
+        offset += msgPtr->compactLen;
+
+        linkPtr = le_dls_PeekNext(&MsgList, linkPtr);
     }
 
-    le_result_t res = LE_OK;
-    if ( json_dump_file(jsonObjPtr, path, JSON_INDENT(1) | JSON_PRESERVE_ORDER) < 0 )
+    if ((LE_OK == result) && (fdatasync(fd) < 0))
     {
-        res = LE_FAULT;
+        LE_ERROR("Unable to sync %s: %m", SMSINBOX_PATH LOG_TMP_FILE);
+        result = LE_FAULT;
     }
 
-    json_decref(jsonObjPtr);
+    if ((LE_OK == result) && (rename(SMSINBOX_PATH LOG_TMP_FILE, SMSINBOX_PATH LOG_FILE) < 0))
+    {
+        LE_ERROR("Unable to rename %s: %m", SMSINBOX_PATH LOG_TMP_FILE);
+        result = LE_FAULT;
+    }
 
-    return res;
+    if (result != LE_OK)
+    {
+        close(fd);
+        unlink(SMSINBOX_PATH LOG_TMP_FILE);
+        return;
+    }
+
+    close(LogFd);
+    LogFd = fd;
+    LogSize = offset;
+    LiveBytes = offset - LOG_MAGIC_LEN;
+
+    for (linkPtr = le_dls_Peek(&MsgList); linkPtr; linkPtr = le_dls_PeekNext(&MsgList, linkPtr))
+    {
+        Message_t* msgPtr = GetLinkMsg(linkPtr, -1);
+
+        msgPtr->recordOffset = msgPtr->compactOffset;
+        msgPtr->recordLen = msgPtr->compactLen;
+    }
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Check if a message belongs to a message box
+ * Compact the message store if it is mostly made of dead records
  *
  */
 //--------------------------------------------------------------------------------------------------
+static void MaybeCompactStore
+(
+    void
+)
+{
+    off_t deadBytes = LogSize - LOG_MAGIC_LEN - LiveBytes;
 
-le_result_t CheckMessageIdInMbox
+    if ((deadBytes > COMPACT_THRESHOLD) && (deadBytes > LiveBytes))
+    {
+        CompactStore();
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Append a message to the message store, and add it to the index
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT on failure (the message is freed)
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t StoreMsg
 (
-    char* mboxName,
-    MessageId_t messageId
+    Message_t* msgPtr,          ///<[IN] Message
+    const uint8_t* payloadPtr   ///<[IN] Payload
 )
 {
-    json_t *jsonRootObjPtr;
-    json_t *jsonArrayPtr;
-    uint32_t pathLen = GetSMSInboxConfigPathLen(mboxName);
-    char path[pathLen];
-    GetSMSInboxConfigPath(mboxName, path, pathLen);
+    RecordBuf_t buf;
 
-    if ( GetMsgListFromMbox(path, &jsonRootObjPtr, &jsonArrayPtr) != LE_OK )
+    if ((EncodeMsgRecord(&buf, msgPtr, payloadPtr) != LE_OK) ||
+        (AppendRecord(&buf, RECORD_MSG, &msgPtr->recordOffset) != LE_OK))
     {
-        LE_ERROR("Error in GetMsgListFromMbox");
+        LE_ERROR("Unable to store message %08x", (int) msgPtr->id);
+        le_mem_Release(msgPtr);
         return LE_FAULT;
     }
 
-    int i = 0;
+    msgPtr->recordLen = sizeof(RecordHeader_t) + buf.len;
+
+    IndexMsg(msgPtr);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Change the status of a message in a message box. A message deleted from its last message box
+ * is freed.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateMsgState
+(
+    Message_t* msgPtr,      ///<[IN] Message
+    int mboxIdx,            ///<[IN] Message box index in Apps[]
+    uint8_t state           ///<[IN] STATE_xxx flags
+)
+{
+    RecordBuf_t buf = { .len = 0, .isOverflow = false };
+
+    if (GetMsgState(msgPtr, mboxIdx) == state)
+    {
+        return;
+    }
+
+    PutU32(&buf, msgPtr->id);
+    PutString(&buf, Apps[mboxIdx].namePtr);
+    PutU8(&buf, state);
+
+    // The index must not get ahead of the store, or the change would be lost at the next replay
+    // or compaction.
+    if (buf.isOverflow || (AppendRecord(&buf, RECORD_STATE, NULL) != LE_OK))
+    {
+        LE_ERROR("Unable to store the state of message %08x", (int) msgPtr->id);
+        return;
+    }
+
+    SetMsgState(msgPtr, mboxIdx, state);
+
+    MaybeCompactStore();
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Replay the message store into the index. A store ending with a torn or corrupted record is
+ * truncated before it.
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReplayStore
+(
+    void
+)
+{
+    struct stat st;
+    uint8_t* dataPtr = NULL;
+    off_t offset = 0;
+
+    if (fstat(LogFd, &st) < 0)
+    {
+        LE_ERROR("Unable to stat the message store: %m");
+        st.st_size = 0;
+    }
+
+    if (st.st_size > 0)
+    {
+        dataPtr = malloc(st.st_size);
+        LE_ASSERT(dataPtr);
+
+        while (offset < st.st_size)
+        {
+            ssize_t readSize = pread(LogFd, dataPtr + offset, st.st_size - offset, offset);
+
+            if ((readSize < 0) && (EINTR == errno))
+            {
+                continue;
+            }
 
-    while (i < json_array_size(jsonArrayPtr))
+            if (readSize <= 0)
+            {
+                LE_ERROR("Unable to read the message store: %m");
+                break;
+            }
+
+            offset += readSize;
+        }
+
+        st.st_size = offset;
+    }
+
+    if ((st.st_size < LOG_MAGIC_LEN) || (memcmp(dataPtr, LOG_MAGIC, LOG_MAGIC_LEN) != 0))
     {
-        json_t * jsonIntegerPtr = json_array_get(jsonArrayPtr, i);
-        MessageId_t msgId = 0;
+        if (st.st_size > 0)
+        {
+            LE_ERROR("Unrecognized message store, starting a new one");
+        }
 
-        if (jsonIntegerPtr)
+        free(dataPtr);
+
+        if ((ftruncate(LogFd, 0) < 0) || (WriteAll(LogFd, LOG_MAGIC, LOG_MAGIC_LEN) != LE_OK))
         {
-            msgId = json_integer_value(jsonIntegerPtr);
+            LE_ERROR("Unable to initialize the message store: %m");
         }
-        else
+
+        LogSize = LOG_MAGIC_LEN;
+        return;
+    }
+
+    offset = LOG_MAGIC_LEN;
+
+    while (offset + (off_t) sizeof(RecordHeader_t) <= st.st_size)
+    {
+        RecordHeader_t header;
+        RecordReader_t reader;
+
+        memcpy(&header, dataPtr + offset, sizeof(header));
+
+        reader.dataPtr = dataPtr + offset + sizeof(header);
+        reader.len = header.len;
+        reader.pos = 0;
+        reader.isError = false;
+
+        if ((offset + (off_t) sizeof(header) + header.len > st.st_size) ||
+            (le_crc_Crc32((uint8_t*) reader.dataPtr, reader.len, LE_CRC_START_CRC32) != header.crc))
         {
-            LE_ERROR("json error");
-            json_decref(jsonRootObjPtr);
-            return LE_FAULT;
+            break;
         }
 
-        if (msgId == messageId)
+        if (RECORD_MSG == header.type)
         {
-            json_decref(jsonRootObjPtr);
-            return LE_OK;
+            Message_t* msgPtr = le_mem_ForceAlloc(MsgPool);
+            memset(msgPtr, 0, sizeof(Message_t));
+
+            if (DecodeMsgRecord(&reader, msgPtr) != LE_OK)
+            {
+                le_mem_Release(msgPtr);
+                break;
+            }
+
+            msgPtr->recordOffset = offset;
+            msgPtr->recordLen = sizeof(header) + header.len;
+
+            IndexMsg(msgPtr);
         }
+        else if (RECORD_STATE == header.type)
+        {
+            char name[UINT8_MAX + 1];
+            MessageId_t messageId = GetU32(&reader);
 
-        i++;
+            GetString(&reader, name, sizeof(name));
+
+            uint8_t state = GetU8(&reader);
+
+            if (reader.isError)
+            {
+                break;
+            }
+
+            Message_t* msgPtr = le_hashmap_Get(MsgMap, &messageId);
+            int mboxIdx = FindMbox(name);
+
+            // The message may be gone, but its identifier must not be given again.
+            if (messageId >= NextMessageId)
+            {
+                NextMessageId = messageId + 1;
+            }
+
+            if (msgPtr && (mboxIdx >= 0))
+            {
+                SetMsgState(msgPtr, mboxIdx, state);
+            }
+        }
+        else
+        {
+            break;
+        }
+
+        offset += sizeof(header) + header.len;
     }
 
-    LE_ERROR("Bad msg id or mbox name");
-    json_decref(jsonRootObjPtr);
-    return LE_FAULT;
+    free(dataPtr);
+
+    if (offset != st.st_size)
+    {
+        LE_WARN("Dropping the end of the message store (offset %lld)", (long long) offset);
+
+        if (ftruncate(LogFd, offset) < 0)
+        {
+            LE_ERROR("Unable to truncate the message store: %m");
+        }
+    }
+
+    LogSize = offset;
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Decode message file
+ * Copy a string value of a legacy Json object
  *
+ * @return
+ *      - true if the key exists and its value fits
+ *      - false otherwise
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t DecodeMsgEntry
+static bool GetLegacyString
 (
-    char* mboxName,                      ///<[IN] mbox name
-    MessageId_t messageId,               ///<[IN] Message identifier to decode
-    char* keyPtr[],                      ///<[IN] Key to retrieve
-    uint8_t nbKey,                       ///<[IN] Number of elements in keyPtr
-    EntryDesc_t * decodePtr              ///<[IN/OUT] Decoding result
+    json_t* jsonObjPtr,     ///<[IN] Json object
+    const char* key,        ///<[IN] Key to read
+    char* strPtr,           ///<[OUT] String
+    size_t size             ///<[IN] Size of strPtr
 )
 {
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-    json_error_t error;
-    le_result_t res = LE_OK;
+    const char* valuePtr = json_string_value(json_object_get(jsonObjPtr, key));
 
-    GetSMSInboxMessagePath(messageId, path, pathLen);
+    return (valuePtr && (le_utf8_Copy(strPtr, valuePtr, size, NULL) == LE_OK));
+}
 
-    json_t* jsonRootPtr = json_load_file(path, JSON_REJECT_DUPLICATES, &error);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check if a legacy message box file lists a message
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsInLegacyMbox
+(
+    json_t* jsonArrayPtr,   ///<[IN] Message identifiers of the message box (may be NULL)
+    MessageId_t messageId   ///<[IN] Message identifier
+)
+{
+    size_t i;
 
-    if ( jsonRootPtr == NULL )
+    for (i = 0; i < json_array_size(jsonArrayPtr); i++)
     {
-        LE_ERROR("json decoder error %s", error.text);
-        DeleteMsgInAppCfg(mboxName, messageId);
-        return LE_FAULT;
+        if (json_integer_value(json_array_get(jsonArrayPtr, i)) == messageId)
+        {
+            return true;
+        }
     }
 
-    res = ReadJsonObj(jsonRootPtr, keyPtr, nbKey, decodePtr);
-
-    json_decref(jsonRootPtr);
-
-    return res;
+    return false;
 }
 
-
 //--------------------------------------------------------------------------------------------------
 /**
- * Check if an application requested the deletion of a message
+ * Import a legacy message file into the message store. It replaces the message with the same
+ * identifier if any.
  *
  */
 //--------------------------------------------------------------------------------------------------
-static bool IsDeleted
+static void ImportLegacyMsg
 (
-    MessageId_t messageId,  ///<[IN] Message identifier
-    char* appNamePtr        ///<[IN] Application name
+    const char* pathPtr,        ///<[IN] Message file path
+    MessageId_t messageId,      ///<[IN] Message identifier
+    json_t* mboxArrayPtr[]      ///<[IN] Message identifiers of each message box (may be NULL)
 )
 {
-    EntryDesc_t decode;
-    decode.type = DESC_BOOL;
-    char* key[2] = {JSON_ISDELETED, appNamePtr};
+    json_error_t error;
+    json_t* jsonRootPtr = json_load_file(pathPtr, JSON_REJECT_DUPLICATES, &error);
 
-    if (DecodeMsgEntry(appNamePtr, messageId, key, 2, &decode) == LE_OK)
+    if (NULL == jsonRootPtr)
     {
-        return decode.uVal.boolVal;
+        LE_ERROR("json decoder error %s", error.text);
+        return;
     }
-    else
+
+    Message_t* msgPtr = le_mem_ForceAlloc(MsgPool);
+    memset(msgPtr, 0, sizeof(Message_t));
+
+    msgPtr->id = messageId;
+    msgPtr->format = json_integer_value(json_object_get(jsonRootPtr, JSON_FORMAT));
+    msgPtr->msgLen = json_integer_value(json_object_get(jsonRootPtr, JSON_MSGLEN));
+    GetLegacyString(jsonRootPtr, JSON_IMSI, msgPtr->imsi, sizeof(msgPtr->imsi));
+
+    if (GetLegacyString(jsonRootPtr, JSON_SENDERTEL, msgPtr->senderTel,
+                        sizeof(msgPtr->senderTel)))
+    {
+        msgPtr->fields |= FIELD_SENDERTEL;
+    }
+
+    if (GetLegacyString(jsonRootPtr, JSON_TIMESTAMP, msgPtr->timestamp,
+                        sizeof(msgPtr->timestamp)))
+    {
+        msgPtr->fields |= FIELD_TIMESTAMP;
+    }
+
+    // Payloads were stored as hexadecimal strings.
+    const char* payloadKey = NULL;
+    uint8_t payload[MAX_PAYLOAD_LEN];
+
+    switch (msgPtr->format)
+    {
+        case LE_SMS_FORMAT_TEXT:
+            payloadKey = JSON_TEXT;
+        break;
+        case LE_SMS_FORMAT_BINARY:
+            payloadKey = JSON_BIN;
+        break;
+        case LE_SMS_FORMAT_PDU:
+            payloadKey = JSON_PDU;
+        break;
+        default:
+        break;
+    }
+
+    const char* hexPtr = payloadKey ?
+                         json_string_value(json_object_get(jsonRootPtr, payloadKey)) : NULL;
+
+    if (hexPtr)
     {
-        // if error, delete the message
-        return true;
+        int32_t payloadLen = le_hex_StringToBinary(hexPtr, strlen(hexPtr),
+                                                   payload, sizeof(payload));
+
+        if (payloadLen >= 0)
+        {
+            msgPtr->payloadLen = payloadLen;
+            msgPtr->fields |= FIELD_PAYLOAD;
+        }
+    }
+
+    json_t* jsonUnreadPtr = json_object_get(jsonRootPtr, JSON_ISUNREAD);
+    json_t* jsonDeletedPtr = json_object_get(jsonRootPtr, JSON_ISDELETED);
+    int i;
+
+    for (i = 0; i < MAX_APPS; i++)
+    {
+        if (Apps[i].namePtr && strlen(Apps[i].namePtr) &&
+            IsInLegacyMbox(mboxArrayPtr[i], messageId) &&
+            !json_is_true(json_object_get(jsonDeletedPtr, Apps[i].namePtr)))
+        {
+            msgPtr->mboxMask |= 1U << i;
+
+            if (json_is_true(json_object_get(jsonUnreadPtr, Apps[i].namePtr)))
+            {
+                msgPtr->unreadMask |= 1U << i;
+            }
+        }
     }
+
+    json_decref(jsonRootPtr);
+
+    StoreMsg(msgPtr, payload);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Perform the deleteion
+ * Import the legacy message and message box files into the message store, and remove them
  *
  */
 //--------------------------------------------------------------------------------------------------
-static void PerformDeletion
+static void ImportLegacyFiles
 (
-    MessageId_t messageId   ///<[IN] Message identifier
+    void
 )
 {
+    struct dirent **namelist;
+    json_t* mboxArrayPtr[MAX_APPS] = { NULL };
+    json_t* jsonRootPtr[MAX_APPS] = { NULL };
+    char path[PATH_MAX];
+    int nbEntries;
     int i;
-    bool deleted = true;
 
-    for (i=0; i < MAX_APPS; i++)
+    nbEntries = scandir(SMSINBOX_PATH MSG_PATH, &namelist, NULL, alphasort);
+
+    if (nbEntries < 0)
     {
-        if ( Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0) )
+        // No legacy files
+        return;
+    }
+
+    LE_INFO("Importing legacy messages");
+
+    for (i = 0; i < MAX_APPS; i++)
+    {
+        if (Apps[i].namePtr && strlen(Apps[i].namePtr))
         {
-            deleted &= IsDeleted(messageId, Apps[i].namePtr);
+            json_error_t error;
+
+            snprintf(path, sizeof(path), "%s%s%s%s", SMSINBOX_PATH, CONF_PATH,
+                                                     Apps[i].namePtr, FILE_EXTENSION);
+            jsonRootPtr[i] = json_load_file(path, 0, &error);
+            mboxArrayPtr[i] = json_object_get(jsonRootPtr[i], JSON_MSGINBOX);
         }
     }
 
-    // All applications mark this message to be delteted => erase physically the message
-    if (deleted)
+    for (i = 0; i < nbEntries; i++)
     {
-        uint16_t pathLen = GetSMSInboxMessagePathLen();
-        char path[pathLen];
-        memset(path,0,pathLen);
+        const char* namePtr = namelist[i]->d_name;
+        size_t len = strlen(namePtr);
+
+        if ((len > strlen(FILE_EXTENSION)) &&
+            (strcmp(namePtr + len - strlen(FILE_EXTENSION), FILE_EXTENSION) == 0))
+        {
+            char hexId[len + 1];
+            le_utf8_Copy(hexId, namePtr, len - strlen(FILE_EXTENSION) + 1, NULL);
 
-        GetSMSInboxMessagePath(messageId, path, pathLen);
+            int messageId = le_hex_HexaToInteger(hexId);
+
+            if (messageId > 0)
+            {
+                snprintf(path, sizeof(path), "%s%s%s", SMSINBOX_PATH, MSG_PATH, namePtr);
+                ImportLegacyMsg(path, messageId, mboxArrayPtr);
+            }
+        }
+    }
+
+    // Only remove the legacy files once the messages are safely in the store.
+    if (fdatasync(LogFd) < 0)
+    {
+        LE_ERROR("Unable to sync the message store: %m");
+    }
+    else
+    {
+        for (i = 0; i < nbEntries; i++)
+        {
+            snprintf(path, sizeof(path), "%s%s%s", SMSINBOX_PATH, MSG_PATH, namelist[i]->d_name);
+            unlink(path);
+        }
+
+        for (i = 0; i < MAX_APPS; i++)
+        {
+            if (Apps[i].namePtr && strlen(Apps[i].namePtr))
+            {
+                snprintf(path, sizeof(path), "%s%s%s%s", SMSINBOX_PATH, CONF_PATH,
+                                                         Apps[i].namePtr, FILE_EXTENSION);
+                unlink(path);
+            }
+        }
+
+        rmdir(SMSINBOX_PATH MSG_PATH);
+        rmdir(SMSINBOX_PATH CONF_PATH);
+    }
+
+    for (i = 0; i < MAX_APPS; i++)
+    {
+        if (jsonRootPtr[i])
+        {
+            json_decref(jsonRootPtr[i]);
+        }
+    }
 
-        unlink(path);
+    for (i = 0; i < nbEntries; i++)
+    {
+        free(namelist[i]);
     }
+
+    free(namelist);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Add a message in the application's cfg file
+ * Open the message store and build the index, the first time it is called
  *
+ * @return
+ *      - LE_OK on success
+ *      - LE_FAULT if the store can't be opened
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t AddMsgInAppCfg
+static le_result_t OpenStore
 (
-    MboxCtx_t* appsPtr,         ///<[IN] application config
-    MessageId_t messageId     ///<[IN] message to add
+    void
 )
 {
-    uint32_t pathLen = GetSMSInboxConfigPathLen(appsPtr->namePtr);
-    char path[pathLen];
-    GetSMSInboxConfigPath(appsPtr->namePtr, path, pathLen);
-    json_t* jsonMsgIdPtr = NULL;
-    json_t* jsonPtr;
-    json_t* jsonArrayPtr;
+    if (LogFd >= 0)
+    {
+        return LE_OK;
+    }
 
-    if ( GetMsgListFromMbox (path, &jsonPtr, &jsonArrayPtr) != LE_OK )
+    LogFd = open(SMSINBOX_PATH LOG_FILE,
+                 O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC,
+                 S_IRUSR | S_IWUSR);
+
+    if (LogFd < 0)
     {
+        LE_ERROR("Unable to open %s: %m", SMSINBOX_PATH LOG_FILE);
         return LE_FAULT;
     }
 
-    if ( json_array_size(jsonArrayPtr) == appsPtr->inboxSize )
-    {
-        // delete older entry
-        jsonMsgIdPtr = json_array_get(jsonArrayPtr, 0);
-        MessageId_t messageId = 0;
+    ReplayStore();
+    ImportLegacyFiles();
+    MaybeCompactStore();
 
-        if (jsonMsgIdPtr)
-        {
-            messageId = json_integer_value(jsonMsgIdPtr);
-        }
+    LE_DEBUG("Message store opened, NextMessageId %d", (int) NextMessageId);
 
-        if (messageId != 0)
-        {
-            json_array_remove(jsonArrayPtr, 0);
+    return LE_OK;
+}
 
-            EntryDesc_t modif;
-            modif.type = DESC_BOOL;
-            modif.uVal.boolVal = true;
-            char* key[2]={JSON_ISDELETED, appsPtr->namePtr};
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a message of a message box
+ *
+ * @return
+ *      - The message
+ *      - NULL if the message box doesn't hold this message
+ */
+//--------------------------------------------------------------------------------------------------
+static Message_t* GetMsgInMbox
+(
+    MboxCtx_t* mboxCtxPtr,  ///<[IN] Message box
+    MessageId_t messageId   ///<[IN] Message identifier
+)
+{
+    Message_t* msgPtr = (LogFd < 0) ? NULL : le_hashmap_Get(MsgMap, &messageId);
 
-            if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
-            {
-                LE_ERROR("Can't modify entry %08x", (int) messageId);
-            }
+    if ((NULL == msgPtr) || !(msgPtr->mboxMask & (1U << (mboxCtxPtr - Apps))))
+    {
+        LE_ERROR("Bad msg id or mbox name");
+        return NULL;
+    }
 
-            PerformDeletion(messageId);
-        }
-        else
-        {
-            json_decref(jsonPtr);
-            LE_ERROR("json error");
-            return LE_FAULT;
-        }
+    return msgPtr;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Mark a message as read or unread in a message box
+ *
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetMsgUnread
+(
+    MboxCtx_t* mboxCtxPtr,  ///<[IN] Message box
+    Message_t* msgPtr,      ///<[IN] Message
+    bool isUnread           ///<[IN] New status
+)
+{
+    int mboxIdx = mboxCtxPtr - Apps;
+
+    UpdateMsgState(msgPtr, mboxIdx, STATE_IN_MBOX | (isUnread ? STATE_UNREAD : 0));
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Copy a string field of a message
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the string doesn't fit
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t CopyMsgString
+(
+    const char* srcPtr,     ///<[IN] String
+    char* dstPtr,           ///<[OUT] Copy
+    size_t dstSize          ///<[IN] Size of dstPtr
+)
+{
+    if (strlen(srcPtr) >= dstSize)
+    {
+        LE_ERROR("String too long");
+        return LE_OVERFLOW;
     }
 
-    if (AddIntegerKeyInJsonObject(jsonArrayPtr, NULL, messageId) != LE_OK)
+    le_utf8_Copy(dstPtr, srcPtr, dstSize, NULL);
+
+    return LE_OK;
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the payload of a message
+ *
+ * @return
+ *      - LE_OK on success
+ *      - LE_OVERFLOW if the payload doesn't fit
+ *      - LE_FAULT if the message has no payload in this format, or on read failure
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetMsgPayload
+(
+    const Message_t* msgPtr,    ///<[IN] Message
+    le_sms_Format_t format,     ///<[IN] Expected format
+    uint8_t* payloadPtr,        ///<[OUT] Payload
+    size_t* lenPtr              ///<[IN/OUT] Size of payloadPtr, then length of the payload
+)
+{
+    if ((msgPtr->format != format) || !(msgPtr->fields & FIELD_PAYLOAD))
     {
-        json_decref(jsonPtr);
-        LE_ERROR("json error");
+        LE_ERROR("Bad format");
         return LE_FAULT;
     }
 
-    if ( json_dump_file(jsonPtr, path, JSON_INDENT(1) | JSON_PRESERVE_ORDER) < 0 )
+    if (msgPtr->payloadLen > *lenPtr)
     {
-        json_decref(jsonPtr);
-        LE_ERROR("json error");
-        return LE_FAULT;
+        LE_ERROR("String too long");
+        return LE_OVERFLOW;
     }
 
-    json_decref(jsonPtr);
-
-    // Use for the first initialization
-    if (jsonArrayPtr->refcount > 0)
+    if (ReadPayload(msgPtr, payloadPtr) != LE_OK)
     {
-        json_decref(jsonArrayPtr);
+        return LE_FAULT;
     }
 
+    *lenPtr = msgPtr->payloadLen;
+
     return LE_OK;
 }
 
-
-
 //--------------------------------------------------------------------------------------------------
 /**
- * Encode Json file
+ * Create a new message entry
  *
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t EncodeMsgEntry
+static le_result_t CreateMsgEntry
 (
-    uint32_t fd,            ///<[IN] file descriptor
-    le_sms_MsgRef_t msgRef  ///<[IN] SMS to be encoding
+    le_sms_MsgRef_t msgRef,     ///<[IN] SMS to be stored
+    MessageId_t *msgPtr         ///<[OUT] created messageId
 )
 {
-    json_t *jsonRootPtr = json_object();
-
-    if (!jsonRootPtr)
+    if (OpenStore() != LE_OK)
     {
-        LE_ERROR("Json error");
         return LE_FAULT;
     }
 
-    // Add imsi in json file
-    AddStringKeyInJsonObject(jsonRootPtr, JSON_IMSI, SimImsi);
-
-    // Add sms format in json file
-    le_sms_Format_t format = le_sms_GetFormat(msgRef);
-    AddIntegerKeyInJsonObject(jsonRootPtr, JSON_FORMAT, (int) format);
+    Message_t* newMsgPtr = le_mem_ForceAlloc(MsgPool);
+    memset(newMsgPtr, 0, sizeof(Message_t));
 
-    // Unread by default for all applications
-    json_t *jsonUnreadPtr = json_object();
+    MessageId_t messageId = NextMessageId;
+    uint8_t payload[MAX_PAYLOAD_LEN];
+    le_result_t result;
     int i;
-    for (i=0; i < MAX_APPS; i++)
-    {
-        if ( Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0) )
-        {
-            AddBooleanKeyInJsonObject(jsonUnreadPtr, Apps[i].namePtr, true);
-        }
-    }
 
-    json_object_set_new(jsonRootPtr, JSON_ISUNREAD, jsonUnreadPtr);
-
-    // Undeleted by default for all applications
-    json_t *jsonDeletePtr = json_object();
-    for (i=0; i < MAX_APPS; i++)
-    {
-        if ( Apps[i].namePtr && (strlen(Apps[i].namePtr) != 0) )
-        {
-            AddBooleanKeyInJsonObject(jsonDeletePtr, Apps[i].namePtr, false);
-        }
-    }
+    newMsgPtr->id = messageId;
+    le_utf8_Copy(newMsgPtr->imsi, SimImsi, sizeof(newMsgPtr->imsi), NULL);
 
-    json_object_set_new(jsonRootPtr, JSON_ISDELETED, jsonDeletePtr);
+    le_sms_Format_t format = le_sms_GetFormat(msgRef);
+    newMsgPtr->format = format;
 
     switch ( format )
     {
         case LE_SMS_FORMAT_TEXT:
         case LE_SMS_FORMAT_BINARY:
         {
-            char tel[LE_MDMDEFS_PHONE_NUM_MAX_BYTES];
-            memset(tel,0,LE_MDMDEFS_PHONE_NUM_MAX_BYTES);
-
             // Add phone number
-            le_result_t result = le_sms_GetSenderTel(msgRef, tel, LE_MDMDEFS_PHONE_NUM_MAX_BYTES);
+            result = le_sms_GetSenderTel(msgRef, newMsgPtr->senderTel,
+                                         sizeof(newMsgPtr->senderTel));
 
             if (result != LE_OK)
             {
@@ -1209,13 +2008,13 @@ static le_result_t EncodeMsgEntry
             }
             else
             {
-                LE_DEBUG("tel num: %s", tel);
-                AddStringKeyInJsonObject(jsonRootPtr, JSON_SENDERTEL, tel);
+                LE_DEBUG("tel num: %s", newMsgPtr->senderTel);
+                newMsgPtr->fields |= FIELD_SENDERTEL;
             }
 
             // Add timestamp
-            char timeStamp[LE_SMS_TIMESTAMP_MAX_BYTES];
-            result = le_sms_GetTimeStamp (msgRef, timeStamp, LE_SMS_TIMESTAMP_MAX_BYTES);
+            result = le_sms_GetTimeStamp(msgRef, newMsgPtr->timestamp,
+                                         sizeof(newMsgPtr->timestamp));
 
             if (result != LE_OK)
             {
@@ -1223,78 +2022,72 @@ static le_result_t EncodeMsgEntry
             }
             else
             {
-                LE_DEBUG("timestamp: %s", timeStamp);
-                AddStringKeyInJsonObject(jsonRootPtr, JSON_TIMESTAMP, timeStamp);
+                LE_DEBUG("timestamp: %s", newMsgPtr->timestamp);
+                newMsgPtr->fields |= FIELD_TIMESTAMP;
             }
 
-            size_t len = le_sms_GetUserdataLen(msgRef);
-            AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, len);
+            newMsgPtr->msgLen = le_sms_GetUserdataLen(msgRef);
 
             // Add a character for last '\0'
-            len++;
+            size_t len = newMsgPtr->msgLen + 1;
 
-            uint8_t bin[len];
-            memset(bin,0,len);
-            int32_t strLen = 2*len + 1;
-            char string[strLen];
-            memset(string,0,strLen);
-            const char* jsonKey;
+            if (len > sizeof(payload))
+            {
+                len = sizeof(payload);
+            }
+
+            memset(payload, 0, sizeof(payload));
 
             if (format == LE_SMS_FORMAT_TEXT)
             {
                 // Get text
-                result = le_sms_GetText(msgRef, (char*) bin, len);
-                jsonKey = JSON_TEXT;
+                result = le_sms_GetText(msgRef, (char*) payload, len);
             }
             else
             {
                 // Get binary
-                result = le_sms_GetBinary(msgRef, bin, &len);
-                jsonKey = JSON_BIN;
+                result = le_sms_GetBinary(msgRef, payload, &len);
             }
 
             if (result != LE_OK)
             {
                 LE_ERROR("Unable to get payload %d", result);
-                AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, 0);
+                newMsgPtr->msgLen = 0;
             }
             else
             {
-                // Convert payload in string: json supports only utf-8 characters.
-                // Some extended-ASCII characters can be sent by SMS (such as character with accent)
-                // and can't be convert directly in utf-8. A convertion in string solves this issue.
-                strLen = le_hex_BinaryToString(bin, len, string, strLen);
-                AddStringKeyInJsonObject(jsonRootPtr, jsonKey, string);
-
+                newMsgPtr->payloadLen = len;
+                newMsgPtr->fields |= FIELD_PAYLOAD;
             }
         }
         break;
 
         case LE_SMS_FORMAT_PDU:
         {
-            size_t len = le_sms_GetPDULen(msgRef);
-            AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, len);
+            newMsgPtr->msgLen = le_sms_GetPDULen(msgRef);
+
             // Add a character for last '\0'
-            len++;
-            uint8_t pdu[len];
-            memset(pdu,0,len);
-            int32_t strLen = 2*len + 1;
-            char string[strLen];
-            memset(string,0,strLen);
+            size_t len = newMsgPtr->msgLen + 1;
+
+            if (len > sizeof(payload))
+            {
+                len = sizeof(payload);
+            }
+
+            memset(payload, 0, sizeof(payload));
 
             // Add pdu
-            le_result_t result = le_sms_GetPDU(msgRef, pdu, &len);
+            result = le_sms_GetPDU(msgRef, payload, &len);
 
             if (result != LE_OK)
             {
                 LE_ERROR("Unable to get pdu %d", result);
-                AddIntegerKeyInJsonObject(jsonRootPtr, JSON_MSGLEN, 0);
+                newMsgPtr->msgLen = 0;
             }
             else
             {
-                // Convert pdu in string
-                strLen = le_hex_BinaryToString(pdu, len, string, strLen);
-                AddStringKeyInJsonObject(jsonRootPtr, JSON_PDU, string);
+                newMsgPtr->payloadLen = len;
+                newMsgPtr->fields |= FIELD_PAYLOAD;
             }
         }
         break;
@@ -1303,99 +2096,49 @@ static le_result_t EncodeMsgEntry
             LE_ERROR("Bad format %d", format);
     }
 
-    // Write json file in the file system
-    char* jsondumpStr = json_dumps( (const json_t *) jsonRootPtr,
-                                    JSON_INDENT(1) | JSON_PRESERVE_ORDER);
-    if (!jsondumpStr)
-    {
-        LE_ERROR("jsondumpStr is NULL");
-        return LE_FAULT;
-    }
-
-    char* restJsondumpStr = jsondumpStr;
-    ssize_t writeSize = strlen(jsondumpStr);
-    ssize_t writtenSize;
-
-    do
+    // Unread by default for all applications
+    for (i = 0; i < MAX_APPS; i++)
     {
-        writtenSize = write( fd, restJsondumpStr, writeSize );
-        if (writtenSize > 0)
+        if ( Apps[i].namePtr && strlen(Apps[i].namePtr) && Apps[i].inboxSize )
         {
-            writeSize -= writtenSize;
-            restJsondumpStr += writtenSize;
+            newMsgPtr->mboxMask |= 1U << i;
+            newMsgPtr->unreadMask |= 1U << i;
         }
     }
-    while ((writeSize > 0) && ((writtenSize >= 0) || (EINTR == errno)));
-
-    free(jsondumpStr);
-    json_decref(jsonRootPtr);
-
-    return LE_OK;
-}
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Create a new message entry
- *
- */
-//--------------------------------------------------------------------------------------------------
-static le_result_t CreateMsgEntry
-(
-    MessageId_t *msgPtr,    ///<[OUT] create messageId
-    int32_t *fdPtr         ///<[OUT] Created file descriptor
-)
-{
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path, 0, pathLen);
-
-    GetSMSInboxMessagePath(NextMessageId, path, pathLen);
 
-    *fdPtr = open( path, O_CREAT | O_RDWR | O_SYNC, S_IRUSR | S_IWUSR );
-
-    if (*fdPtr < 0)
+    if (StoreMsg(newMsgPtr, payload) != LE_OK)
     {
-        LE_ERROR("No such file: %s", path);
         return LE_FAULT;
     }
 
-    LE_DEBUG("New entry: %s", path);
+    // The SMS is deleted from the SIM afterwards: make sure it is on the disk.
+    if (fdatasync(LogFd) < 0)
+    {
+        LE_ERROR("Unable to sync the message store: %m");
+        return LE_FAULT;
+    }
 
-    int i;
+    LE_DEBUG("New entry: %08x", (int) messageId);
 
-    // For all the applications
+    // Delete the older entries of the full message boxes
     for (i = 0; i < MAX_APPS; i++)
     {
-        if ( Apps[i].namePtr && strlen(Apps[i].namePtr) )
+        while (Apps[i].msgCount > Apps[i].inboxSize)
         {
-            AddMsgInAppCfg(&Apps[i], NextMessageId);
+            Message_t* oldMsgPtr = GetLinkMsg(le_dls_Peek(&Apps[i].msgList), i);
+
+            LE_DEBUG("Remove %08x from %s", (int) oldMsgPtr->id, Apps[i].namePtr);
+            UpdateMsgState(oldMsgPtr, i, 0);
         }
     }
 
-    *msgPtr = NextMessageId;
+    *msgPtr = messageId;
 
-    NextMessageId++;
+    NextMessageId = messageId + 1;
 
     return LE_OK;
 }
 
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Convert the file name string in hexa
- *
- */
-//--------------------------------------------------------------------------------------------------
-static MessageId_t GetMessageId
-(
-    char* fileName  ///<[IN] file name to be converted
-)
-{
-    char *savePtr;
-    char *str = strtok_r(fileName,".", &savePtr);
-    return le_hex_HexaToInteger(str);
-}
-
 //--------------------------------------------------------------------------------------------------
 /**
  * Init the SMSInBox directory
@@ -1407,55 +2150,13 @@ static void InitSmsInBoxDirectory
     void
 )
 {
-    struct dirent **namelist;
-    uint32_t nbSmsEntries;
-
     LE_DEBUG("InitSmsInBoxDirectory");
 
-    // create directories
-    if (0 > mkdir( SMSINBOX_PATH, S_IRWXU|S_IRWXG ))
+    // create directory
+    if ((0 > mkdir( SMSINBOX_PATH, S_IRWXU|S_IRWXG )) && (EEXIST != errno))
     {
         LE_ERROR("Unable to create directory %s: %m", SMSINBOX_PATH);
-        return;
-    }
-    uint16_t pathLen = GetSMSInboxMessagePathLen();
-    char path[pathLen];
-    memset(path,0,pathLen);
-    snprintf(path, pathLen, "%s%s", SMSINBOX_PATH, CONF_PATH);
-    if (0 > mkdir( path, S_IRWXU|S_IRWXG ))
-    {
-        LE_ERROR("Unable to create directory %s: %m", path );
-        return;
-    }
-    memset(path,0,pathLen);
-    snprintf(path, pathLen, "%s%s", SMSINBOX_PATH, MSG_PATH);
-    if (0 > mkdir( path, S_IRWXU|S_IRWXG ))
-    {
-        LE_ERROR("Unable to create directory %s: %m", path );
-        return;
-    }
-
-
-    nbSmsEntries = scandir(path, &namelist, NULL, alphasort);
-
-    if ( nbSmsEntries > 2 )
-    {
-        uint8_t len = strlen(namelist[nbSmsEntries-1]->d_name);
-        char name[len+1];
-        memset(name, 0, len+1);
-        strncpy(name, namelist[nbSmsEntries-1]->d_name, len);
-        NextMessageId = GetMessageId(name);
-        NextMessageId++;
-
-        LE_DEBUG("NextMessageId %d", (int) NextMessageId);
-    }
-
-    while (nbSmsEntries--)
-    {
-        free(namelist[nbSmsEntries]);
     }
-
-    free(namelist);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1469,9 +2170,6 @@ static void MoveSmsFromSimToFolder
     void
 )
 {
-    int32_t fd;
-    le_result_t result = LE_OK;
-
     le_sms_MsgListRef_t msgListRef = le_sms_CreateRxMsgList();
 
     if (!msgListRef)
@@ -1486,18 +2184,7 @@ static void MoveSmsFromSimToFolder
     {
         MessageId_t msgId;
 
-        result = CreateMsgEntry(&msgId, &fd);
-
-        if (result == LE_OK)
-        {
-            if ( EncodeMsgEntry(fd, smsRef) != LE_OK )
-            {
-                LE_ERROR("Encoding issue");
-            }
-
-            close(fd);
-        }
-        else
+        if (CreateMsgEntry(smsRef, &msgId) != LE_OK)
         {
             LE_ERROR("Error during new entry creation");
         }
@@ -1525,18 +2212,10 @@ static void NewSmsMsgHandler
     void*           contextPtr
 )
 {
-    int32_t fd;
     le_result_t result;
     MessageId_t msgId;
 
-    result = CreateMsgEntry(&msgId, &fd);
-
-    if (result == LE_OK)
-    {
-        result = EncodeMsgEntry(fd, msgRef);
-        close(fd);
-
-    }
+    result = CreateMsgEntry(msgRef, &msgId);
 
     if (result == LE_OK)
     {
@@ -1729,6 +2408,14 @@ COMPONENT_INIT
     SmsInboxHandlerPoolRef = le_mem_CreatePool("SmsInboxHandlerPoolRef", sizeof(ClientRequest_t));
     le_mem_ExpandPool(SmsInboxHandlerPoolRef, MAX_APPS);
 
+    // Create a pool and a hashmap for the message index. They are filled when the message store
+    // is opened.
+    MsgPool = le_mem_CreatePool("SmsInboxMsgPool", sizeof(Message_t));
+    MsgMap = le_hashmap_Create("SmsInboxMsgMap",
+                               MAX_MBOX_SIZE,
+                               le_hashmap_HashUInt32,
+                               le_hashmap_EqualsUInt32);
+
     // Retrieve the smsInbox settings from the configuration tree
     LoadInboxSettings();
 
@@ -1780,6 +2467,12 @@ SmsInbox_SessionRef_t SmsInbox_Open
         return NULL;
     }
 
+    if (OpenStore() != LE_OK)
+    {
+        LE_ERROR("Message store unavailable");
+        return NULL;
+    }
+
     int i;
 
     for (i=0; i < MAX_APPS; i++)
@@ -1951,30 +2644,16 @@ void SmsInbox_DeleteMsg
         return;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxCtxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    Message_t* msgPtr = GetMsgInMbox(mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t modif;
-    modif.type = DESC_BOOL;
-    modif.uVal.boolVal = true;
-    char* key[2]={JSON_ISDELETED, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
-    {
-        LE_ERROR("ModifyMsgEntry error");
-    }
-
-    if (DeleteMsgInAppCfg(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId)
-                          != LE_OK)
-    {
-        LE_ERROR("DeleteMsgInAppCfg error");
-    }
-
-    PerformDeletion(messageId);
+    UpdateMsgState(msgPtr, mboxCtxPtr - Apps, 0);
 }
 
 
@@ -2022,13 +2701,14 @@ le_result_t SmsInbox_GetImsi
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    Message_t* msgPtr = GetMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
     le_result_t res;
 
     memset(imsiPtr,0,imsiNumElements);
@@ -2038,14 +2718,7 @@ le_result_t SmsInbox_GetImsi
         return LE_OVERFLOW;
     }
 
-    EntryDesc_t decode;
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = imsiPtr;
-    decode.uVal.str.lenStr = imsiNumElements;
-    char* key[1] = {JSON_IMSI};
-
-    if ((res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr,
-                              messageId, key, 1, &decode)) == LE_OK)
+    if ((res = CopyMsgString(msgPtr->imsi, imsiPtr, imsiNumElements)) == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
@@ -2089,27 +2762,17 @@ le_sms_Format_t SmsInbox_GetFormat
         return 0;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    Message_t* msgPtr = GetMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return 0;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
-    decode.type = DESC_INT;
-    char* key[1] = {JSON_FORMAT};
+    SmsInbox_MarkRead(sessionRef, msgId);
 
-    if (DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 1,
-                      &decode) == LE_OK)
-    {
-        SmsInbox_MarkRead(sessionRef, msgId);
-        return decode.uVal.val;
-    }
-    else
-    {
-        return LE_SMSINBOX_FORMAT_UNKNOWN;
-    }
+    return msgPtr->format;
 }
 
 
@@ -2154,23 +2817,24 @@ le_result_t SmsInbox_GetSenderTel
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    Message_t* msgPtr = GetMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
     le_result_t res;
-    EntryDesc_t decode;
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = telPtr;
-    decode.uVal.str.lenStr = telNumElements;
     memset(telPtr,0,telNumElements);
-    char* key[1] = {JSON_SENDERTEL};
 
-    if ((res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key,
-                              1, &decode)) == LE_OK)
+    if (!(msgPtr->fields & FIELD_SENDERTEL))
+    {
+        LE_ERROR("No sender telephone number");
+        return LE_FAULT;
+    }
+
+    if ((res = CopyMsgString(msgPtr->senderTel, telPtr, telNumElements)) == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
@@ -2224,23 +2888,24 @@ le_result_t SmsInbox_GetTimeStamp
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    Message_t* msgPtr = GetMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = timestampPtr;
-    decode.uVal.str.lenStr = timestampNumElements;
     memset(timestampPtr,0,timestampNumElements);
-    char* key[1] = {JSON_TIMESTAMP};
     le_result_t res;
 
-    if ( (res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId,
-                               key, 1, &decode)) == LE_OK )
+    if (!(msgPtr->fields & FIELD_TIMESTAMP))
+    {
+        LE_ERROR("No timestamp");
+        return LE_FAULT;
+    }
+
+    if ((res = CopyMsgString(msgPtr->timestamp, timestampPtr, timestampNumElements)) == LE_OK)
     {
         SmsInbox_MarkRead(sessionRef, msgId);
     }
@@ -2281,33 +2946,17 @@ size_t SmsInbox_GetMsgLen
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    Message_t* msgPtr = GetMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-
-    EntryDesc_t decode;
-    decode.type = DESC_INT;
-    char* key[1] = {JSON_MSGLEN};
-    le_result_t res;
-
-    if ( (res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr,
-                                messageId,
-                                key,
-                                1,
-                                &decode)) == LE_OK )
-    {
-        SmsInbox_MarkRead(sessionRef, msgId);
+    SmsInbox_MarkRead(sessionRef, msgId);
 
-        return decode.uVal.val;
-    }
-    else
-    {
-        return 0;
-    }
+    return msgPtr->msgLen;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2353,38 +3002,23 @@ le_result_t SmsInbox_GetText
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    Message_t* msgPtr = GetMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
     le_result_t res;
-    size_t len = 2*textNumElements+1;
-    char tmpTextPtr[len];
-    memset(tmpTextPtr,0,len);
+    size_t len = textNumElements;
     memset(textPtr,0,textNumElements);
 
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = tmpTextPtr;
-    decode.uVal.str.lenStr = len;
-    char* key[1] = {JSON_TEXT};
-
-    res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 1,
-                         &decode);
+    // The stored text includes its terminating null character
+    res = GetMsgPayload(msgPtr, LE_SMS_FORMAT_TEXT, (uint8_t*) textPtr, &len);
 
     if ( res == LE_OK )
     {
-        if ( le_hex_StringToBinary(tmpTextPtr,
-                                   decode.uVal.str.lenStr,
-                                   (uint8_t*) textPtr,
-                                   textNumElements ) < 0 )
-        {
-            return LE_FAULT;
-        }
-
         SmsInbox_MarkRead(sessionRef, msgId);
     }
 
@@ -2434,42 +3068,21 @@ le_result_t SmsInbox_GetBinary
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    Message_t* msgPtr = GetMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
     le_result_t res;
-    EntryDesc_t decode;
-    size_t len = 2*(*binNumElementsPtr)+1;
-    char tmpBinPtr[len];
-    memset(tmpBinPtr,0,len);
     memset(binPtr,0,*binNumElementsPtr);
 
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = tmpBinPtr;
-    decode.uVal.str.lenStr = len;
-    char* key[1] = {JSON_BIN};
-
-    res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId,
-                         key, 1, &decode);
+    res = GetMsgPayload(msgPtr, LE_SMS_FORMAT_BINARY, binPtr, binNumElementsPtr);
 
     if ( res == LE_OK )
     {
-        int32_t binNumElements = le_hex_StringToBinary(tmpBinPtr,
-                                                    decode.uVal.str.lenStr,
-                                                    binPtr,
-                                                    *binNumElementsPtr);
-
-        if ( binNumElements < 0 )
-        {
-            return LE_FAULT;
-        }
-
-        *binNumElementsPtr = binNumElements;
-
         SmsInbox_MarkRead(sessionRef, msgId);
     }
 
@@ -2523,42 +3136,21 @@ le_result_t SmsInbox_GetPdu
         return 0;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    Message_t* msgPtr = GetMsgInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return 0;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
     le_result_t res;
-    EntryDesc_t decode;
-    size_t len = 2*(*pduNumElementsPtr)+1;
-    char tmpPduPtr[len];
-    memset(tmpPduPtr,0,len);
     memset(pduPtr,0,*pduNumElementsPtr);
 
-    decode.type = DESC_STRING;
-    decode.uVal.str.strPtr = tmpPduPtr;
-    decode.uVal.str.lenStr = len;
-    char* key[1] = {JSON_PDU};
-
-    res = DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 1,
-                         &decode);
+    res = GetMsgPayload(msgPtr, LE_SMS_FORMAT_PDU, pduPtr, pduNumElementsPtr);
 
     if ( res == LE_OK )
     {
-        int32_t pduNumElements = le_hex_StringToBinary(tmpPduPtr,
-                                                    decode.uVal.str.lenStr,
-                                                    pduPtr,
-                                                    *pduNumElementsPtr);
-
-        if ( pduNumElements < 0 )
-        {
-            return LE_FAULT;
-        }
-
-        *pduNumElementsPtr = pduNumElements;
-
         SmsInbox_MarkRead(sessionRef, msgId);
     }
 
@@ -2597,75 +3189,27 @@ uint32_t SmsInbox_GetFirst
         return 0;
     }
 
-    uint32_t pathLen = GetSMSInboxConfigPathLen(clientRequestPtr->
-                                                mboxSessionPtr->mboxCtxPtr->namePtr);
-    char path[pathLen];
-    memset(path,0,pathLen);
-    GetSMSInboxConfigPath(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, path, pathLen);
-    le_result_t res = LE_OK;
-    MessageId_t messageId=0;
-
-    if ( GetMsgListFromMbox(path,
-                        &clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr,
-                        &clientRequestPtr->mboxSessionPtr->browseCtx.jsonArrayPtr) != LE_OK )
-    {
-        LE_ERROR("error in GetMsgListFromMbox");
-        return 0;
-    }
-
-    clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex =
-                      json_array_size(clientRequestPtr->mboxSessionPtr->browseCtx.jsonArrayPtr);
+    MboxCtx_t* mboxCtxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    BrowseCtx_t* browseCtxPtr = &clientRequestPtr->mboxSessionPtr->browseCtx;
+    int mboxIdx = mboxCtxPtr - Apps;
 
-    LE_DEBUG("maxIndex %d", clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex);
+    memset(browseCtxPtr, 0, sizeof(BrowseCtx_t));
 
-    if ( clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex > 0 )
-    {
-        json_t * jsonIntegerPtr =
-                 json_array_get(clientRequestPtr->mboxSessionPtr->browseCtx.jsonArrayPtr, 0);
-
-        if (jsonIntegerPtr)
-        {
-            messageId = json_integer_value(jsonIntegerPtr);
-        }
-        else
-        {
-            LE_ERROR("json error");
-            res = LE_FAULT;
-        }
+    le_dls_Link_t* firstLinkPtr = le_dls_Peek(&mboxCtxPtr->msgList);
 
-        if (messageId)
-        {
-            clientRequestPtr->mboxSessionPtr->browseCtx.currentMessageIndex = 1;
-        }
-        else
-        {
-            LE_ERROR("json error");
-            res = LE_FAULT;
-        }
-    }
-    else
+    if (NULL == firstLinkPtr)
     {
-        res = LE_FAULT;
         LE_DEBUG("Empty mbox");
+        return 0;
     }
 
-    if (res == LE_FAULT)
-    {
-        if (clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr)
-        {
-            json_decref(clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr);
-        }
-
-        memset(&clientRequestPtr->mboxSessionPtr->browseCtx, 0, sizeof(BrowseCtx_t));
+    // Messages received while browsing are not returned
+    browseCtxPtr->currentMessageId = GetLinkMsg(firstLinkPtr, mboxIdx)->id;
+    browseCtxPtr->lastMessageId = GetLinkMsg(le_dls_PeekTail(&mboxCtxPtr->msgList), mboxIdx)->id;
 
-        return 0;
-    }
-    else
-    {
-        return messageId;
-    }
+    LE_DEBUG("msgCount %d", mboxCtxPtr->msgCount);
 
-    return 0;
+    return browseCtxPtr->currentMessageId;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2693,58 +3237,42 @@ uint32_t SmsInbox_GetNext
         return LE_BAD_PARAMETER;
     }
 
-    while(clientRequestPtr->mboxSessionPtr->browseCtx.maxIndex !=
-          clientRequestPtr->mboxSessionPtr->browseCtx.currentMessageIndex)
-    {
-        LE_DEBUG("currentIndex %d, maxIndex %d", clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.currentMessageIndex,
-                                                 clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.maxIndex);
+    MboxCtx_t* mboxCtxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    BrowseCtx_t* browseCtxPtr = &clientRequestPtr->mboxSessionPtr->browseCtx;
+    int mboxIdx = mboxCtxPtr - Apps;
+    le_dls_Link_t* linkPtr = NULL;
 
-        json_t * jsonIntegerPtr = json_array_get(clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.jsonArrayPtr,
-                                                 clientRequestPtr->
-                                                 mboxSessionPtr->browseCtx.currentMessageIndex);
+    if (browseCtxPtr->currentMessageId)
+    {
+        Message_t* msgPtr = le_hashmap_Get(MsgMap, &browseCtxPtr->currentMessageId);
 
-        if (jsonIntegerPtr)
+        if (msgPtr && (msgPtr->mboxMask & (1U << mboxIdx)))
         {
-            MessageId_t messageId = json_integer_value(jsonIntegerPtr);
-
-            if (messageId > 0)
-            {
-                clientRequestPtr->mboxSessionPtr->browseCtx.currentMessageIndex++;
-
-                // Check if the message exist (it may be deleted since the GetFirst call)
-                uint16_t pathLen = GetSMSInboxMessagePathLen();
-                char path[pathLen];
-                memset(path, 0, pathLen);
-                GetSMSInboxMessagePath(messageId, path, pathLen);
-                int32_t fd = open(path, O_RDWR);
-
-                if (fd >= 0)
-                {
-                    // message is still existing
-                    close(fd);
-                    return messageId;
-                }
-
-                // else continue the parsing
-            }
-            else
-            {
-                LE_ERROR("json error");
-            }
+            linkPtr = le_dls_PeekNext(&mboxCtxPtr->msgList, &msgPtr->mboxLinks[mboxIdx]);
         }
         else
         {
-            LE_ERROR("json error");
+            // The current message was deleted since the previous call
+            linkPtr = le_dls_Peek(&mboxCtxPtr->msgList);
+
+            while (linkPtr &&
+                   (GetLinkMsg(linkPtr, mboxIdx)->id <= browseCtxPtr->currentMessageId))
+            {
+                linkPtr = le_dls_PeekNext(&mboxCtxPtr->msgList, linkPtr);
+            }
         }
     }
 
-    // Parsing end => free the memory
+    if (linkPtr && (GetLinkMsg(linkPtr, mboxIdx)->id <= browseCtxPtr->lastMessageId))
+    {
+        browseCtxPtr->currentMessageId = GetLinkMsg(linkPtr, mboxIdx)->id;
+
+        return browseCtxPtr->currentMessageId;
+    }
+
+    // Parsing end
     LE_DEBUG("No more messages");
-    json_decref(clientRequestPtr->mboxSessionPtr->browseCtx.jsonObjPtr);
-    memset(&clientRequestPtr->mboxSessionPtr->browseCtx, 0, sizeof(BrowseCtx_t));
+    memset(browseCtxPtr, 0, sizeof(BrowseCtx_t));
 
     return 0;
 }
@@ -2785,27 +3313,16 @@ bool SmsInbox_IsUnread
         return LE_BAD_PARAMETER;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxCtxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    Message_t* msgPtr = GetMsgInMbox(mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return LE_BAD_PARAMETER;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t decode;
-    decode.type = DESC_BOOL;
-    char* key[] = {JSON_ISUNREAD, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (DecodeMsgEntry(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, messageId, key, 2,
-                       &decode) == LE_OK)
-    {
-        return decode.uVal.boolVal;
-    }
-    else
-    {
-        LE_ERROR("Error in DecodeMsgEntry");
-        return false;
-    }
+    return (GetMsgState(msgPtr, mboxCtxPtr - Apps) & STATE_UNREAD) != 0;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2840,22 +3357,16 @@ void SmsInbox_MarkRead
         return;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxCtxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    Message_t* msgPtr = GetMsgInMbox(mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t modif;
-    modif.type = DESC_BOOL;
-    modif.uVal.boolVal = false;
-    char* key[2]={JSON_ISUNREAD, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
-    {
-        LE_ERROR("Error in ModifyMsgEntry");
-    }
+    SetMsgUnread(mboxCtxPtr, msgPtr, false);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -2890,22 +3401,16 @@ void SmsInbox_MarkUnread
         return;
     }
 
-    if (CheckMessageIdInMbox(clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr, msgId) != LE_OK)
+    MboxCtx_t* mboxCtxPtr = clientRequestPtr->mboxSessionPtr->mboxCtxPtr;
+    Message_t* msgPtr = GetMsgInMbox(mboxCtxPtr, msgId);
+
+    if (NULL == msgPtr)
     {
         LE_ERROR("message not included into the mbox");
         return;
     }
 
-    MessageId_t messageId = (MessageId_t) msgId;
-    EntryDesc_t modif;
-    modif.type = DESC_BOOL;
-    modif.uVal.boolVal = true;
-    char* key[2]={JSON_ISUNREAD, clientRequestPtr->mboxSessionPtr->mboxCtxPtr->namePtr};
-
-    if (ModifyMsgEntry(messageId, key, 2, &modif) != LE_OK)
-    {
-        LE_ERROR("Error in ModifyMsgEntry");
-    }
+    SetMsgUnread(mboxCtxPtr, msgPtr, true);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -211,6 +211,480 @@ static tdb_TreeRef_t QuickGetTree
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Buffer of batch records being built.  See le_cfg.api for the record format.
+ */
+// -------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint8_t* dataPtr;    ///< The records.
+    size_t size;         ///< Size of the buffer.
+    size_t used;         ///< Number of bytes of records in the buffer.
+    uint32_t skipCount;  ///< Number of records still to skip, read by previous calls.
+}
+BatchBuffer_t;
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Join a path relative to a base path onto it.
+ *
+ *  @return LE_OK if the path fits, LE_OVERFLOW if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t JoinPath
+(
+    const char* basePathPtr,  ///< [IN]  Base path, may be empty.
+    const char* subPathPtr,   ///< [IN]  Path relative to the base, may be empty.
+    char* pathPtr             ///< [OUT] Buffer of LE_CFG_STR_LEN_BYTES for the joined path.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    int len;
+
+    if ((basePathPtr[0] == '\0') || (subPathPtr[0] == '\0'))
+    {
+        len = snprintf(pathPtr, LE_CFG_STR_LEN_BYTES, "%s%s", basePathPtr, subPathPtr);
+    }
+    else
+    {
+        len = snprintf(pathPtr, LE_CFG_STR_LEN_BYTES, "%s/%s", basePathPtr, subPathPtr);
+    }
+
+    return (len < LE_CFG_STR_LEN_BYTES) ? LE_OK : LE_OVERFLOW;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Check that a path in a batch is relative, and stays in the iterator's tree.
+ *
+ *  @return True if the path can be used.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool IsBatchPathValid
+(
+    const char* pathPtr  ///< [IN] The path from the batch.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    return (pathPtr[0] != '/') && (tp_PathHasTreeSpecifier(pathPtr) == false);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Add a record to a batch buffer, unless it's one of the records to skip.
+ *
+ *  @return LE_OK if the record fits, LE_OVERFLOW if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t AppendRecord
+(
+    BatchBuffer_t* bufferPtr,  ///< [IN] The buffer to add to.
+    le_cfg_nodeType_t type,    ///< [IN] The node's type.
+    const char* pathPtr,       ///< [IN] The node's path, relative to the base of the batch.
+    const char* valuePtr       ///< [IN] The node's value.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (bufferPtr->skipCount > 0)
+    {
+        bufferPtr->skipCount--;
+        return LE_OK;
+    }
+
+    size_t pathSize = strlen(pathPtr) + 1;
+    size_t valueSize = strlen(valuePtr) + 1;
+
+    if (bufferPtr->used + 1 + pathSize + valueSize > bufferPtr->size)
+    {
+        return LE_OVERFLOW;
+    }
+
+    uint8_t* recordPtr = bufferPtr->dataPtr + bufferPtr->used;
+
+    recordPtr[0] = (uint8_t)type;
+    memcpy(recordPtr + 1, pathPtr, pathSize);
+    memcpy(recordPtr + 1 + pathSize, valuePtr, valueSize);
+
+    bufferPtr->used += 1 + pathSize + valueSize;
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Add a record for a single node to a batch buffer.  A stem gets a record, without a value.
+ *
+ *  @return LE_OK if the record fits, LE_OVERFLOW if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t AppendNodeRecord
+(
+    BatchBuffer_t* bufferPtr,  ///< [IN] The buffer to add to.
+    tdb_NodeRef_t nodeRef,     ///< [IN] The node, or NULL if it doesn't exist.
+    const char* pathPtr        ///< [IN] The node's path, relative to the base of the batch.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char value[LE_CFG_STR_LEN_BYTES] = "";
+    le_cfg_nodeType_t type = (nodeRef == NULL) ? LE_CFG_TYPE_DOESNT_EXIST
+                                               : tdb_GetNodeType(nodeRef);
+
+    switch (type)
+    {
+        case LE_CFG_TYPE_BOOL:
+            LE_ASSERT(le_utf8_Copy(value,
+                                   tdb_GetValueAsBool(nodeRef, false) ? "true" : "false",
+                                   sizeof(value),
+                                   NULL) == LE_OK);
+            break;
+
+        case LE_CFG_TYPE_STRING:
+        case LE_CFG_TYPE_INT:
+        case LE_CFG_TYPE_FLOAT:
+            tdb_GetValueAsString(nodeRef, value, sizeof(value), "");
+            break;
+
+        default:
+            break;
+    }
+
+    return AppendRecord(bufferPtr, type, pathPtr, value);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Add records for all of the values in a subtree to a batch buffer.
+ *
+ *  @return LE_OK if the records fit, LE_OVERFLOW if not.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t AppendSubtreeRecords
+(
+    BatchBuffer_t* bufferPtr,  ///< [IN] The buffer to add to.
+    tdb_NodeRef_t nodeRef,     ///< [IN] The root of the subtree.
+    char* pathPtr,             ///< [IN] Buffer of LE_CFG_STR_LEN_BYTES holding the node's path,
+                               ///<      relative to the base of the batch.  It's used to build
+                               ///<      the children's paths, and restored before returning.
+    size_t pathLen             ///< [IN] Length of the node's path.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    le_cfg_nodeType_t type = tdb_GetNodeType(nodeRef);
+
+    if (type == LE_CFG_TYPE_DOESNT_EXIST)
+    {
+        return LE_OK;
+    }
+
+    if (type != LE_CFG_TYPE_STEM)
+    {
+        return AppendNodeRecord(bufferPtr, nodeRef, pathPtr);
+    }
+
+    le_result_t result = LE_OK;
+    tdb_NodeRef_t childRef = tdb_GetFirstActiveChildNode(nodeRef);
+
+    while ((childRef != NULL) && (result == LE_OK))
+    {
+        size_t childPathLen = pathLen;
+
+        if (pathLen > 0)
+        {
+            pathPtr[childPathLen++] = '/';
+        }
+
+        result = tdb_GetNodeName(childRef,
+                                 pathPtr + childPathLen,
+                                 LE_CFG_STR_LEN_BYTES - childPathLen);
+
+        if (result == LE_OK)
+        {
+            result = AppendSubtreeRecords(bufferPtr,
+                                          childRef,
+                                          pathPtr,
+                                          childPathLen + strlen(pathPtr + childPathLen));
+        }
+
+        pathPtr[pathLen] = '\0';
+        childRef = tdb_GetNextActiveSiblingNode(childRef);
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a batch of values for the GetBatch and QuickGetBatch functions.
+ *
+ *  @return LE_OK, LE_NOT_FOUND, LE_OVERFLOW or LE_FORMAT_ERROR, see le_cfg_GetBatch().
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t GetBatch
+(
+    ni_IteratorRef_t iteratorRef,  ///< [IN] Iterator to read with.
+    const char* basePathPtr,       ///< [IN] Base path of the batch, relative to the iterator.
+    const uint8_t* pathListPtr,    ///< [IN] Paths to read, relative to the base path.
+    size_t pathListSize,           ///< [IN] Size of the path list, 0 to read the whole subtree.
+    BatchBuffer_t* bufferPtr       ///< [IN] Buffer for the records.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char path[LE_CFG_STR_LEN_BYTES] = "";
+
+    if (pathListSize == 0)
+    {
+        tdb_NodeRef_t nodeRef = ni_GetNode(iteratorRef, basePathPtr);
+
+        if (   (nodeRef == NULL)
+            || (tdb_GetNodeType(nodeRef) == LE_CFG_TYPE_DOESNT_EXIST))
+        {
+            return LE_NOT_FOUND;
+        }
+
+        return AppendSubtreeRecords(bufferPtr, nodeRef, path, 0);
+    }
+
+    if (pathListPtr[pathListSize - 1] != '\0')
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    const char* subPathPtr = (const char*)pathListPtr;
+    const char* endPtr = (const char*)pathListPtr + pathListSize;
+
+    while (subPathPtr < endPtr)
+    {
+        if (   (IsBatchPathValid(subPathPtr) == false)
+            || (JoinPath(basePathPtr, subPathPtr, path) != LE_OK))
+        {
+            return LE_FORMAT_ERROR;
+        }
+
+        le_result_t result = AppendNodeRecord(bufferPtr, ni_GetNode(iteratorRef, path), subPathPtr);
+
+        if (result != LE_OK)
+        {
+            return result;
+        }
+
+        subPathPtr += strlen(subPathPtr) + 1;
+    }
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Get the next record from a batch.
+ *
+ *  @return LE_OK if a record was read, LE_OUT_OF_RANGE at the end of the batch, or
+ *          LE_FORMAT_ERROR if the record is cut short.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t NextRecord
+(
+    const uint8_t* dataPtr,         ///< [IN]     The records.
+    size_t size,                    ///< [IN]     Size of the records.
+    size_t* offsetPtr,              ///< [IN/OUT] Offset of the record, updated to the next one.
+    le_cfg_nodeType_t* typePtr,     ///< [OUT]    The record's type.
+    const char** pathPtrPtr,        ///< [OUT]    The record's path.
+    const char** valuePtrPtr        ///< [OUT]    The record's value.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    size_t offset = *offsetPtr;
+
+    if (offset >= size)
+    {
+        return LE_OUT_OF_RANGE;
+    }
+
+    *typePtr = (le_cfg_nodeType_t)dataPtr[offset++];
+
+    const uint8_t* endPtr = (offset < size) ? memchr(dataPtr + offset, '\0', size - offset) : NULL;
+
+    if (endPtr == NULL)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    *pathPtrPtr = (const char*)dataPtr + offset;
+    offset = (endPtr - dataPtr) + 1;
+
+    endPtr = (offset < size) ? memchr(dataPtr + offset, '\0', size - offset) : NULL;
+
+    if (endPtr == NULL)
+    {
+        return LE_FORMAT_ERROR;
+    }
+
+    *valuePtrPtr = (const char*)dataPtr + offset;
+    *offsetPtr = (endPtr - dataPtr) + 1;
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Check that a record's value can be written as the record's type.
+ *
+ *  @return True if it can.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool IsRecordValueValid
+(
+    le_cfg_nodeType_t type,  ///< [IN] The record's type.
+    const char* valuePtr     ///< [IN] The record's value.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char* endPtr;
+
+    switch (type)
+    {
+        case LE_CFG_TYPE_EMPTY:
+        case LE_CFG_TYPE_DOESNT_EXIST:
+            return true;
+
+        case LE_CFG_TYPE_STRING:
+            return strlen(valuePtr) <= LE_CFG_STR_LEN;
+
+        case LE_CFG_TYPE_BOOL:
+            return (strcmp(valuePtr, "true") == 0) || (strcmp(valuePtr, "false") == 0);
+
+        case LE_CFG_TYPE_INT:
+        {
+            errno = 0;
+            long value = strtol(valuePtr, &endPtr, 10);
+
+            return    (valuePtr[0] != '\0')
+                   && (*endPtr == '\0')
+                   && (errno == 0)
+                   && (value >= INT32_MIN)
+                   && (value <= INT32_MAX);
+        }
+
+        case LE_CFG_TYPE_FLOAT:
+            errno = 0;
+            strtod(valuePtr, &endPtr);
+
+            return (valuePtr[0] != '\0') && (*endPtr == '\0') && (errno == 0);
+
+        default:
+            return false;
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write a batch of values for the SetBatch function.  All of the records are checked before any
+ *  of them are written, so a bad batch changes nothing.
+ *
+ *  @return LE_OK or LE_FORMAT_ERROR, see le_cfg_SetBatch().
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t SetBatch
+(
+    ni_IteratorRef_t iteratorRef,  ///< [IN] Iterator to write with.
+    const char* basePathPtr,       ///< [IN] Base path of the batch, relative to the iterator.
+    const uint8_t* dataPtr,        ///< [IN] The records to write.
+    size_t size                    ///< [IN] Size of the records.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    char path[LE_CFG_STR_LEN_BYTES];
+    le_cfg_nodeType_t type;
+    const char* subPathPtr;
+    const char* valuePtr;
+    size_t offset = 0;
+    le_result_t result;
+
+    while ((result = NextRecord(dataPtr, size, &offset, &type, &subPathPtr, &valuePtr)) == LE_OK)
+    {
+        if (   (IsBatchPathValid(subPathPtr) == false)
+            || (JoinPath(basePathPtr, subPathPtr, path) != LE_OK)
+            || (IsRecordValueValid(type, valuePtr) == false))
+        {
+            return LE_FORMAT_ERROR;
+        }
+    }
+
+    if (result != LE_OUT_OF_RANGE)
+    {
+        return result;
+    }
+
+    offset = 0;
+
+    while (NextRecord(dataPtr, size, &offset, &type, &subPathPtr, &valuePtr) == LE_OK)
+    {
+        JoinPath(basePathPtr, subPathPtr, path);
+
+        switch (type)
+        {
+            case LE_CFG_TYPE_EMPTY:
+                ni_SetEmpty(iteratorRef, path);
+                break;
+
+            case LE_CFG_TYPE_DOESNT_EXIST:
+                ni_DeleteNode(iteratorRef, path);
+                break;
+
+            case LE_CFG_TYPE_STRING:
+                ni_SetNodeValueString(iteratorRef, path, valuePtr);
+                break;
+
+            case LE_CFG_TYPE_BOOL:
+                ni_SetNodeValueBool(iteratorRef, path, strcmp(valuePtr, "true") == 0);
+                break;
+
+            case LE_CFG_TYPE_INT:
+                ni_SetNodeValueInt(iteratorRef, path, (int32_t)strtol(valuePtr, NULL, 10));
+                break;
+
+            case LE_CFG_TYPE_FLOAT:
+                ni_SetNodeValueFloat(iteratorRef, path, strtod(valuePtr, NULL));
+                break;
+
+            default:
+                LE_FATAL("Unexpected batch record type %d.", type);
+        }
+    }
+
+    return LE_OK;
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Create a read transaction and open a new iterator for traversing the configuration tree.
@@ -219,8 +693,8 @@ static tdb_TreeRef_t QuickGetTree
  *         Once the read timeout expires, then all active read iterators on that tree will be
  *         expired and the clients killed.
  *
- *  @note: A tree transaction is global to that tree; a long held read transaction will block other
- *         users write transactions from being comitted.
+ *  @note: The transaction reads a snapshot of the tree, so it doesn't block other users write
+ *         transactions from being comitted.
  *
  *  @return This will return a newly created iterator reference.
  */
@@ -1197,6 +1671,99 @@ void le_cfg_SetBool
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a number of values in one go, either a whole subtree or a list of paths.
+ *
+ *  \b Responds \b With:
+ *
+ *  This function will respond with one of the following values:
+ *
+ *          - LE_OK            - The values were read.
+ *          - LE_NOT_FOUND     - The base node doesn't exist.
+ *          - LE_OVERFLOW      - The values didn't all fit in the buffer.
+ *          - LE_FORMAT_ERROR  - The path list is malformed.
+ */
+// -------------------------------------------------------------------------------------------------
+void le_cfg_GetBatch
+(
+    le_cfg_ServerCmdRef_t commandRef,  ///< [IN] Reference used to generate a reply for this
+                                       ///<      request.
+    le_cfg_IteratorRef_t externalRef,  ///< [IN] Iterator to use as a basis for the transaction.
+    const char* pathPtr,               ///< [IN] Absolute or relative base path.
+    const uint8_t* pathListPtr,        ///< [IN] Paths to read, relative to the base path.
+    size_t pathListNumElements,        ///< [IN] Size of the path list.
+    uint32_t skipCount,                ///< [IN] Number of records to skip.
+    size_t recordsNumElements          ///< [IN] Maximum size of the records to return.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_DEBUG("** Reading a batch of values with iterator <%p>.", externalRef);
+    LE_DEBUG_IF((pathPtr != NULL) && (strlen(pathPtr) != 0), "** Offset by \"%s\"", pathPtr);
+
+    ni_IteratorRef_t iteratorRef = GetIteratorFromRef(externalRef);
+    uint8_t records[LE_CFG_BATCH_MAX_BYTES];
+    BatchBuffer_t buffer = { records, sizeof(records), 0, skipCount };
+    le_result_t result = LE_OK;
+
+    if (recordsNumElements < buffer.size)
+    {
+        buffer.size = recordsNumElements;
+    }
+
+    if ((NULL != pathPtr) && (NULL != iteratorRef)
+        && (false == CheckPathForSpecifier(pathPtr)))
+    {
+        result = GetBatch(iteratorRef, pathPtr, pathListPtr, pathListNumElements, &buffer);
+    }
+
+    le_cfg_GetBatchRespond(commandRef, result, records, buffer.used);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write a number of values in one go.  Nothing is written if any of the values is bad.
+ *
+ *  \b Responds \b With:
+ *
+ *  This function will respond with one of the following values:
+ *
+ *          - LE_OK            - The values were written.
+ *          - LE_FORMAT_ERROR  - The records are malformed, or a value doesn't match its type.
+ */
+// -------------------------------------------------------------------------------------------------
+void le_cfg_SetBatch
+(
+    le_cfg_ServerCmdRef_t commandRef,  ///< [IN] Reference used to generate a reply for this
+                                       ///<      request.
+    le_cfg_IteratorRef_t externalRef,  ///< [IN] Iterator to use as a basis for the transaction.
+    const char* pathPtr,               ///< [IN] Absolute or relative base path.
+    const uint8_t* recordsPtr,         ///< [IN] The values to write.
+    size_t recordsNumElements          ///< [IN] Size of the records.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_DEBUG("** Writing a batch of values with iterator <%p>.", externalRef);
+    LE_DEBUG_IF((pathPtr != NULL) && (strlen(pathPtr) != 0), "** Offset by \"%s\"", pathPtr);
+
+    ni_IteratorRef_t iteratorRef = GetWriteIteratorFromRef(externalRef);
+    le_result_t result = LE_OK;
+
+    if ((NULL != pathPtr) && (NULL != iteratorRef)
+        && (false == CheckPathForSpecifier(pathPtr)))
+    {
+        result = SetBatch(iteratorRef, pathPtr, recordsPtr, recordsNumElements);
+    }
+
+    le_cfg_SetBatchRespond(commandRef, result);
+}
+
+
+
+
 
 
 // -------------------------------------------------------------------------------------------------
@@ -1551,3 +2118,63 @@ void le_cfg_QuickSetBool
                               value);
     }
 }
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a number of values in one go, either a whole subtree or a list of paths.  The values are
+ *  all read from the same snapshot of the tree.
+ *
+ *  \b Responds \b With:
+ *
+ *  This function will respond with one of the following values:
+ *
+ *          - LE_OK            - The values were read.
+ *          - LE_NOT_FOUND     - The base node doesn't exist.
+ *          - LE_OVERFLOW      - The values didn't all fit in the buffer.
+ *          - LE_FORMAT_ERROR  - The path list is malformed.
+ */
+// -------------------------------------------------------------------------------------------------
+void le_cfg_QuickGetBatch
+(
+    le_cfg_ServerCmdRef_t commandRef,  ///< [IN] Reference used to generate a reply for this
+                                       ///<      request.
+    const char* pathPtr,               ///< [IN] Base path.
+    const uint8_t* pathListPtr,        ///< [IN] Paths to read, relative to the base path.
+    size_t pathListNumElements,        ///< [IN] Size of the path list.
+    uint32_t skipCount,                ///< [IN] Number of records to skip.
+    size_t recordsNumElements          ///< [IN] Maximum size of the records to return.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_DEBUG("** Quick get batch of values at \"%s\".", pathPtr);
+
+    tu_UserRef_t userRef = tu_GetCurrentConfigUserInfo();
+    tdb_TreeRef_t treeRef = QuickGetTree(userRef, TU_TREE_READ, pathPtr);
+
+    if (treeRef != NULL)
+    {
+        uint8_t records[LE_CFG_BATCH_MAX_BYTES];
+        BatchBuffer_t buffer = { records, sizeof(records), 0, skipCount };
+
+        if (recordsNumElements < buffer.size)
+        {
+            buffer.size = recordsNumElements;
+        }
+
+        // Read transactions never wait, so unlike the quick sets, this never needs queuing.
+        ni_IteratorRef_t iteratorRef = ni_CreateIterator(le_cfg_GetClientSessionRef(),
+                                                         userRef,
+                                                         treeRef,
+                                                         NI_READ,
+                                                         tp_GetPathOnly(pathPtr));
+
+        le_result_t result = GetBatch(iteratorRef, "", pathListPtr, pathListNumElements, &buffer);
+
+        ni_Release(iteratorRef);
+
+        le_cfg_QuickGetBatchRespond(commandRef, result, records, buffer.used);
+    }
+}
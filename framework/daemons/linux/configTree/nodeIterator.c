@@ -283,14 +283,19 @@ ni_IteratorRef_t ni_CreateIterator
         iteratorRef->timerRef = NULL;
     }
 
-    // If this is a write iterator, then shadow the tree instead of accessing it directly.
+    // If this is a write iterator, then shadow the tree instead of accessing it directly.  Read
+    // iterators get a snapshot of the tree, so that commits made while they're open don't change
+    // what they see, and don't have to wait for them either.
     if (iteratorRef->type == NI_WRITE)
     {
         iteratorRef->treeRef = tdb_ShadowTree(iteratorRef->treeRef);
     }
+    else
+    {
+        iteratorRef->treeRef = tdb_SnapshotTree(iteratorRef->treeRef);
+    }
 
-    // Get the root node of the requested tree, or if this is a write iterator...  Get the shadowed
-    // root node of the tree.
+    // Get the root node of the shadow or snapshot tree.
     iteratorRef->currentNodeRef = tdb_GetRootNode(iteratorRef->treeRef);
     iteratorRef->pathIterRef = le_pathIter_CreateForUnix("/");
 
@@ -309,7 +314,7 @@ ni_IteratorRef_t ni_CreateIterator
     }
 
     // Update the tree so that it can keep track of this iterator.
-    tdb_RegisterIterator(treeRef, iteratorRef);
+    tdb_RegisterIterator(iteratorRef->treeRef, iteratorRef);
 
     // All done.
     return iteratorRef;
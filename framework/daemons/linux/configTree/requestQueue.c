@@ -43,7 +43,6 @@ typedef enum
     RQ_INVALID,
 
     RQ_CREATE_WRITE_TXN,
-    RQ_COMMIT_WRITE_TXN,
     RQ_CREATE_READ_TXN,
     RQ_DELETE_TXN,
 
@@ -84,12 +83,6 @@ typedef struct UpdateRequest
         }
         createTxn;                               ///< Create new transaction info.
 
-        struct
-        {
-            ni_IteratorRef_t iteratorRef;        ///< Ptr to the iterator to commit.
-        }
-        commitTxn;
-
         struct
         {
             ni_IteratorRef_t iteratorRef;        ///< Ptr to the iterator to commit.
@@ -329,16 +322,6 @@ static void ProcessRequestQueue
                                               requestPtr->data.createTxn.pathPtr);
                     break;
 
-                case RQ_COMMIT_WRITE_TXN:
-                    LE_DEBUG("Committing deferred write txn for user %u (%s) on tree '%s'.",
-                             tu_GetUserId(requestPtr->userRef),
-                             tu_GetUserName(requestPtr->userRef),
-                             tdb_GetTreeName(requestPtr->treeRef));
-
-                    rq_HandleCommitTxnRequest(requestPtr->commandRef,
-                                              requestPtr->data.commitTxn.iteratorRef);
-                    break;
-
                case RQ_CREATE_READ_TXN:
                     LE_DEBUG("Starting deferred read txn for user %u (%s) on tree '%s'.",
                              tu_GetUserId(requestPtr->userRef),
@@ -471,14 +454,9 @@ static bool CanQuickSet
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // If there are active readers or writers on the tree then a quick write should be defered.
-    if (   (tdb_HasActiveReaders(treeRef) == false)
-        && (tdb_GetActiveWriteIter(treeRef) == NULL))
-    {
-        return true;
-    }
-
-    return false;
+    // If there's an active writer on the tree then a quick write should be defered.  Readers
+    // don't get in the way, they have their own snapshot of the tree.
+    return tdb_GetActiveWriteIter(treeRef) == NULL;
 }
 
 
@@ -571,16 +549,10 @@ void rq_HandleCreateTxnRequest
 )
 //--------------------------------------------------------------------------------------------------
 {
-    ni_IteratorRef_t writeIteratorRef = tdb_GetActiveWriteIter(treeRef);
-
-    if (   (iterType == NI_READ)
-        && (writeIteratorRef != NULL)
-        && (ni_IsClosed(writeIteratorRef)))
-    {
-        QueueCreateTxnRequest(userRef, treeRef, sessionRef, commandRef, iterType, pathPtr);
-    }
-    else if (   (iterType == NI_WRITE)
-             && (writeIteratorRef != NULL))
+    // Only one write transaction can be open on a tree at a time.  Read transactions work on a
+    // snapshot of the tree, so they never have to wait.
+    if (   (iterType == NI_WRITE)
+        && (tdb_GetActiveWriteIter(treeRef) != NULL))
     {
         QueueCreateTxnRequest(userRef, treeRef, sessionRef, commandRef, iterType, pathPtr);
     }
@@ -623,34 +595,21 @@ void rq_HandleCommitTxnRequest
 )
 //--------------------------------------------------------------------------------------------------
 {
-    if (ni_IsWriteable(iteratorRef) == false)
-    {
-        // Kill the iterator but do not try to comit it.
-        ni_Release(iteratorRef);
+    // The iterator's tree may go away along with the iterator, so get the request queue first.
+    le_sls_List_t* queuePtr = tdb_GetRequestQueue(ni_GetTree(iteratorRef));
 
-        le_cfg_CommitTxnRespond(commandRef);
-        ProcessRequestQueue(tdb_GetRequestQueue(ni_GetTree(iteratorRef)), NULL);
-    }
-    else if (tdb_HasActiveReaders(ni_GetTree(iteratorRef)) == false)
+    // Readers have their own snapshots of the tree, so a write can always be committed right away.
+    // A read iterator is simply killed, there's nothing to commit.
+    if (ni_IsWriteable(iteratorRef))
     {
         ni_Close(iteratorRef);
         ni_Commit(iteratorRef);
-        ni_Release(iteratorRef);
-
-        le_cfg_CommitTxnRespond(commandRef);
-        ProcessRequestQueue(tdb_GetRequestQueue(ni_GetTree(iteratorRef)), NULL);
     }
-    else
-    {
-        UpdateRequest_t* requestPtr = NewRequestBlock(RQ_COMMIT_WRITE_TXN,
-                                                      ni_GetUser(iteratorRef),
-                                                      ni_GetTree(iteratorRef),
-                                                      ni_GetSession(iteratorRef),
-                                                      commandRef);
 
-        requestPtr->data.commitTxn.iteratorRef = iteratorRef;
-        QueueRequest(tdb_GetRequestQueue(ni_GetTree(iteratorRef)), requestPtr);
-    }
+    ni_Release(iteratorRef);
+
+    le_cfg_CommitTxnRespond(commandRef);
+    ProcessRequestQueue(queuePtr, NULL);
 }
 
 
@@ -668,6 +627,9 @@ void rq_HandleCancelTxnRequest
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // The iterator's tree may go away along with the iterator, so get the request queue first.
+    le_sls_List_t* queuePtr = tdb_GetRequestQueue(ni_GetTree(iteratorRef));
+
     // Kill the iterator but do not try to comit it.
     ni_Release(iteratorRef);
 
@@ -680,7 +642,7 @@ void rq_HandleCancelTxnRequest
     }
 
     // Try to handle the tree's request backlog.  (If any.)
-    ProcessRequestQueue(tdb_GetRequestQueue(ni_GetTree(iteratorRef)), NULL);
+    ProcessRequestQueue(queuePtr, NULL);
 }
 
 
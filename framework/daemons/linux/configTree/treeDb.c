@@ -42,9 +42,9 @@
  *  incremented.  When it ends, the count is decremented.
  *
  *  When client requests are received that cannot be processed immediately, because of the state
- *  of the tree the request is for (e.g., if a write transaction commit request is received while
- *  there are read transactions in progress on the tree), then the request is queued onto the tree's
- *  Request Queue.
+ *  of the tree the request is for (e.g., if a write transaction create request is received while
+ *  there is already a write transaction in progress on the tree), then the request is queued onto
+ *  the tree's Request Queue.
  *
  *  <b>Shadow Trees:</b>
  *
@@ -68,6 +68,22 @@
  *  Shadow Trees don't have handlers, request queues, write iterator references or read iterator
  *  counts.
  *
+ *  <b>Snapshot Trees:</b>
+ *
+ *  Read transactions don't use the tree directly, they use a "Snapshot Tree".  A snapshot tree
+ *  holds a reference to the root node the tree had when the read transaction was created, and so
+ *  keeps that version of the tree's nodes alive for as long as the transaction lasts.
+ *
+ *  Commits never wait for read transactions to end.  If a write transaction is committed while
+ *  there are snapshots sharing the tree's nodes, then the tree's nodes are first copied, the
+ *  copy becomes the tree's new version and the changes are merged into it.  The snapshots keep
+ *  the old version, which is freed when the last of them is released.  So readers keep seeing the
+ *  tree exactly as it was when they started, and neither readers nor writers ever wait for each
+ *  other.
+ *
+ *  Like shadow trees, snapshot trees don't have handlers, request queues, write iterator
+ *  references or read iterator counts of their own.
+ *
  *  <b>Event Handler Registration:</b>
  *
  *  The config tree allows clients to register callbacks to be notified if certian sections of a
@@ -135,6 +151,8 @@
 #include "nodeIterator.h"
 #include "sysPaths.h"
 
+#include <sys/mman.h>
+
 
 
 
@@ -289,7 +307,11 @@ typedef struct Tree
                                           ///<   it is set to false, the tree is left alone.
 
     struct Tree* originalTreeRef;         ///< If non-NULL then this points back to the original
-                                          ///<   tree this one is shadowing.
+                                          ///<   tree this one is shadowing, or is a snapshot of.
+
+    bool isSnapshot;                      ///< Is this a read-only snapshot of the original tree?
+                                          ///<   If not, and there is an original tree, then this
+                                          ///<   is a shadow tree.
 
     char name[MAX_TREE_NAME_BYTES];       ///< The name of this tree.
 
@@ -305,6 +327,10 @@ typedef struct Tree
                                           ///<   this tree.  NULL if there are no writes
                                           ///<   pending.
 
+    size_t snapshotCount;                 ///< Count of active snapshots that share this tree's
+                                          ///<   current root node.  While this is non-zero, a
+                                          ///<   commit copies the nodes before changing them.
+
     le_sls_List_t requestList;            ///< Each tree maintains it's own list of pending
                                           ///<   requests.
 }
@@ -333,6 +359,116 @@ TokenType_t;
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ *  Tree files are saved in a binary format, laid out as a header, followed by an array of node
+ *  records, followed by a string table holding the node names and values.
+ *
+ *  The node records are in depth first order.  A stem's record is immediately followed by the
+ *  records of all of its children (and their children, etc).
+ *
+ *  The string table is a list of null terminated strings.  It always starts with an empty string,
+ *  so that offset 0 can be used for nodes without a name or a value.
+ *
+ *  All fields are in host byte order, the files never leave the device.  The magic number starts
+ *  with a byte that can't start a text tree file, so that files in the older text format (which is
+ *  still used for import and export) are recognized and converted when loaded.
+ **/
+//--------------------------------------------------------------------------------------------------
+#define BINARY_TREE_MAGIC   "\177CFG"
+
+/// Version of the binary tree format.  Bump this if the layout of the file changes.
+#define BINARY_TREE_VERSION 1
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Header of a binary tree file.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char magic[4];              ///< Always BINARY_TREE_MAGIC.
+    uint32_t version;           ///< Always BINARY_TREE_VERSION.
+    uint32_t nodeCount;         ///< Number of node records that follow the header.
+    uint32_t stringTableSize;   ///< Size of the string table, in bytes.
+}
+BinaryTreeHeader_t;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record of a node in a binary tree file.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint32_t nameOffset;        ///< Offset of the node's name in the string table.
+
+    union
+    {
+        uint32_t valueOffset;   ///< Offset of the node's value in the string table, if the node
+                                ///<   holds a value.
+        uint32_t childCount;    ///< Number of children, if the node is a stem.
+    };
+
+    uint8_t type;               ///< The le_cfg_nodeType_t of the node.
+    uint8_t reserved[3];        ///< Padding, always 0.
+}
+BinaryTreeNode_t;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A binary tree file image being built in memory, before being written out.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    BinaryTreeNode_t* nodesPtr;  ///< Node records.
+    size_t nodeCount;            ///< Number of node records used.
+    size_t nodeCapacity;         ///< Number of node records allocated.
+
+    char* stringsPtr;            ///< String table.
+    size_t stringsSize;          ///< Bytes of the string table used.
+    size_t stringsCapacity;      ///< Bytes of the string table allocated.
+
+    uint32_t* slotsPtr;          ///< Open addressed hash table of the offsets of the strings in
+                                 ///<   the string table, so that each one is only stored once.
+                                 ///<   0 marks an unused slot.
+    size_t slotCount;            ///< Number of slots, always a power of 2.
+    size_t slotsUsed;            ///< Number of slots in use.
+}
+BinaryTreeImage_t;
+
+
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * State kept while building tree nodes from a memory mapped binary tree file.
+ **/
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    const BinaryTreeNode_t* nodesPtr;  ///< Node records in the file.
+    uint32_t nodeCount;                ///< Number of node records in the file.
+    uint32_t nextIndex;                ///< Index of the next node record to read.
+
+    const char* stringsPtr;            ///< String table in the file.
+    uint32_t stringsSize;              ///< Size of the string table.
+}
+BinaryTreeReader_t;
+
+
+
+
 /// The memory pool responsible for tree nodes.
 static le_mem_PoolRef_t NodePoolRef = NULL;
 
@@ -1467,6 +1603,164 @@ static void FireLostChildren
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Make a copy of a node of an original tree, and all of its children.
+ *
+ *  Each node copied is left with its shadowRef pointing to its copy, (original tree nodes
+ *  otherwise never use it,) so that shadow nodes can be moved over to the copy afterwards.  Call
+ *  ClearCopyRefs() once done.
+ *
+ *  @return The copy of the node.
+ */
+// -------------------------------------------------------------------------------------------------
+static tdb_NodeRef_t CopyNode
+(
+    tdb_NodeRef_t nodeRef,       ///< [IN] The node to copy.
+    tdb_NodeRef_t parentCopyRef  ///< [IN] The copy of the node's parent, NULL for the root node.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    tdb_NodeRef_t copyRef = NewNode();
+
+    copyRef->parentRef = parentCopyRef;
+    copyRef->type = nodeRef->type;
+    copyRef->flags = nodeRef->flags;
+
+    if (nodeRef->nameRef != NULL)
+    {
+        copyRef->nameRef = dstr_NewFromDstr(nodeRef->nameRef);
+    }
+
+    if (nodeRef->type == LE_CFG_TYPE_STEM)
+    {
+        le_dls_Link_t* linkPtr = le_dls_Peek(&nodeRef->info.children);
+
+        while (linkPtr != NULL)
+        {
+            tdb_NodeRef_t childCopyRef = CopyNode(CONTAINER_OF(linkPtr, Node_t, siblingList),
+                                                  copyRef);
+
+            le_dls_Queue(&copyRef->info.children, &childCopyRef->siblingList);
+            linkPtr = le_dls_PeekNext(&nodeRef->info.children, linkPtr);
+        }
+    }
+    else if (nodeRef->info.valueRef != NULL)
+    {
+        copyRef->info.valueRef = dstr_NewFromDstr(nodeRef->info.valueRef);
+    }
+
+    nodeRef->shadowRef = copyRef;
+
+    return copyRef;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Clear the links to their copies that CopyNode() left in a node and its children.
+ */
+// -------------------------------------------------------------------------------------------------
+static void ClearCopyRefs
+(
+    tdb_NodeRef_t nodeRef  ///< [IN] The node that was copied.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    nodeRef->shadowRef = NULL;
+
+    if (nodeRef->type == LE_CFG_TYPE_STEM)
+    {
+        le_dls_Link_t* linkPtr = le_dls_Peek(&nodeRef->info.children);
+
+        while (linkPtr != NULL)
+        {
+            ClearCopyRefs(CONTAINER_OF(linkPtr, Node_t, siblingList));
+            linkPtr = le_dls_PeekNext(&nodeRef->info.children, linkPtr);
+        }
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Point a shadow node, and all of its shadow children, at the copies of the original nodes they
+ *  were shadowing.
+ *
+ *  The children are walked directly, rather than with tdb_GetFirstChildNode(), so that no new
+ *  shadow children are created along the way.
+ */
+// -------------------------------------------------------------------------------------------------
+static void MoveShadowRefsToCopy
+(
+    tdb_NodeRef_t shadowNodeRef  ///< [IN] The shadow node to update.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (shadowNodeRef->shadowRef != NULL)
+    {
+        shadowNodeRef->shadowRef = shadowNodeRef->shadowRef->shadowRef;
+        LE_ASSERT(shadowNodeRef->shadowRef != NULL);
+    }
+
+    if (shadowNodeRef->type == LE_CFG_TYPE_STEM)
+    {
+        le_dls_Link_t* linkPtr = le_dls_Peek(&shadowNodeRef->info.children);
+
+        while (linkPtr != NULL)
+        {
+            MoveShadowRefsToCopy(CONTAINER_OF(linkPtr, Node_t, siblingList));
+            linkPtr = le_dls_PeekNext(&shadowNodeRef->info.children, linkPtr);
+        }
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Called before merging a shadow tree into its original tree.  If there are snapshots sharing the
+ *  original tree's nodes, then those nodes are left to the snapshots, and the original tree gets a
+ *  new copy of them for the merge to change.
+ */
+// -------------------------------------------------------------------------------------------------
+static void NewTreeVersion
+(
+    tdb_TreeRef_t shadowTreeRef  ///< [IN] The shadow tree about to be merged.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    tdb_TreeRef_t originalTreeRef = shadowTreeRef->originalTreeRef;
+
+    if (originalTreeRef->snapshotCount == 0)
+    {
+        return;
+    }
+
+    LE_DEBUG("** Copying tree '%s', it is shared with %zu snapshot(s).",
+             originalTreeRef->name,
+             originalTreeRef->snapshotCount);
+
+    tdb_NodeRef_t oldRootRef = originalTreeRef->rootNodeRef;
+
+    originalTreeRef->rootNodeRef = CopyNode(oldRootRef, NULL);
+    MoveShadowRefsToCopy(shadowTreeRef->rootNodeRef);
+    ClearCopyRefs(oldRootRef);
+
+    // The snapshots each hold their own reference to the old root.  The last one released frees
+    // the old version of the tree.
+    le_mem_Release(oldRootRef);
+    originalTreeRef->snapshotCount = 0;
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Recursive function to merge a collection of shadow nodes with the original tree.
@@ -1581,10 +1875,12 @@ tdb_TreeRef_t NewTree
 
     treeRef->isDeletePending = false;
     treeRef->originalTreeRef = NULL;
+    treeRef->isSnapshot = false;
     treeRef->revisionId = 0;
     treeRef->rootNodeRef = (rootNodeRef != NULL) ? rootNodeRef : NewNode();
     treeRef->activeReadCount = 0;
     treeRef->activeWriteIterRef = NULL;
+    treeRef->snapshotCount = 0;
     treeRef->requestList = LE_SLS_LIST_INIT;
 
     return treeRef;
@@ -2458,106 +2754,684 @@ static void IncrementRevision
 
 // -------------------------------------------------------------------------------------------------
 /**
- *  Attempt to load a configuration tree from a config file.  This function will look for the latest
- *  valid version of the config file and load that one.
+ *  Find the slot of a string in the string hash table of a binary tree image.
+ *
+ *  @return The index of the slot holding the string, or of the empty slot where it would go.
  */
 // -------------------------------------------------------------------------------------------------
-static void LoadTree
+static size_t FindImageStringSlot
 (
-    tdb_TreeRef_t treeRef  ///< [IN] The tree object to load from the filesystem.
+    const BinaryTreeImage_t* imagePtr,  ///< [IN] The image to search.
+    const char* stringPtr               ///< [IN] The string to find.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    // If we don't know the revision then hunt it out from the filesystem.
-    if (treeRef->revisionId == 0)
+    size_t mask = imagePtr->slotCount - 1;
+    size_t index = le_hashmap_HashString(stringPtr) & mask;
+
+    while (   (imagePtr->slotsPtr[index] != 0)
+           && (strcmp(imagePtr->stringsPtr + imagePtr->slotsPtr[index], stringPtr) != 0))
     {
-        UpdateRevision(treeRef);
+        index = (index + 1) & mask;
     }
 
-    // If this tree has no root, create it now.
-    if (treeRef->rootNodeRef == NULL)
+    return index;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Add a string to the string table of a binary tree image, unless it's already there.
+ *
+ *  @return The offset of the string in the string table.
+ */
+// -------------------------------------------------------------------------------------------------
+static uint32_t AddImageString
+(
+    BinaryTreeImage_t* imagePtr,  ///< [IN] The image to add to.
+    const char* stringPtr         ///< [IN] The string to add.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // Empty strings all share the one at the start of the table.
+    if (stringPtr[0] == '\0')
     {
-        treeRef->rootNodeRef = NewNode();
+        return 0;
     }
 
-    // Ok, if we found a valid revision of the tree in the fs, try to load it now.
-    if (treeRef->revisionId != 0)
-    {
-        char pathPtr[LE_CFG_STR_LEN_BYTES] = "";
-        GetTreePath(treeRef->name, treeRef->revisionId, pathPtr, sizeof(pathPtr));
+    size_t slot = FindImageStringSlot(imagePtr, stringPtr);
 
-        LE_DEBUG("** Loading configuration tree from '%s'.", pathPtr);
+    if (imagePtr->slotsPtr[slot] != 0)
+    {
+        return imagePtr->slotsPtr[slot];
+    }
 
-        int fileRef = -1;
+    // Append the string to the table.
+    size_t size = strlen(stringPtr) + 1;
 
+    if (imagePtr->stringsSize + size > imagePtr->stringsCapacity)
+    {
         do
         {
-            fileRef = open(pathPtr, O_RDONLY);
+            imagePtr->stringsCapacity *= 2;
         }
-        while ((fileRef == -1) && (errno == EINTR));
+        while (imagePtr->stringsSize + size > imagePtr->stringsCapacity);
 
-        tdb_EnsureExists(treeRef->rootNodeRef);
+        imagePtr->stringsPtr = realloc(imagePtr->stringsPtr, imagePtr->stringsCapacity);
+        LE_ASSERT(imagePtr->stringsPtr != NULL);
+    }
 
-        if (fileRef == -1)
-        {
-            LE_ERROR("Could not open configuration tree file: %s, reason: %s",
-                     pathPtr,
-                     strerror(errno));
-        }
-        else
-        {
-            if (tdb_ReadTreeNode(treeRef->rootNodeRef, fileRef) == false)
-            {
-                LE_ERROR("Could not parse configuration tree file: %s.", pathPtr);
-                le_mem_Release(treeRef->rootNodeRef);
-                treeRef->rootNodeRef = NewNode();
-            }
+    uint32_t offset = imagePtr->stringsSize;
 
-            int retVal = -1;
+    memcpy(imagePtr->stringsPtr + offset, stringPtr, size);
+    imagePtr->stringsSize += size;
 
-            do
+    imagePtr->slotsPtr[slot] = offset;
+    imagePtr->slotsUsed++;
+
+    // Keep the hash table at most half full, so that searches stay short.
+    if (imagePtr->slotsUsed * 2 > imagePtr->slotCount)
+    {
+        uint32_t* oldSlotsPtr = imagePtr->slotsPtr;
+        size_t oldSlotCount = imagePtr->slotCount;
+        size_t i;
+
+        imagePtr->slotCount *= 2;
+        imagePtr->slotsPtr = calloc(imagePtr->slotCount, sizeof(uint32_t));
+        LE_ASSERT(imagePtr->slotsPtr != NULL);
+
+        for (i = 0; i < oldSlotCount; i++)
+        {
+            if (oldSlotsPtr[i] != 0)
             {
-                retVal = close(fileRef);
+                const char* oldStringPtr = imagePtr->stringsPtr + oldSlotsPtr[i];
+                imagePtr->slotsPtr[FindImageStringSlot(imagePtr, oldStringPtr)] = oldSlotsPtr[i];
             }
-            while ((retVal == -1) && (errno == EINTR));
         }
+
+        free(oldSlotsPtr);
     }
+
+    return offset;
 }
 
 
 
+
 // -------------------------------------------------------------------------------------------------
 /**
- *  Removes the handler object from the given registration object.  This function will also free the
- *  memory that the handler object had used.
+ *  Add a node and all of its active children to a binary tree image.
  */
 // -------------------------------------------------------------------------------------------------
-static void RemoveHandler
+static void AddImageNode
 (
-    Registration_t* registrationPtr,  ///< [IN] The registration object to remove the link from.
-    Handler_t* handlerPtr             ///< [IN] The handler object we're removing.
+    BinaryTreeImage_t* imagePtr,  ///< [IN] The image to add to.
+    tdb_NodeRef_t nodeRef,        ///< [IN] The node to add.
+    uint32_t nameOffset           ///< [IN] Offset of the node's name in the string table.
 )
 // -------------------------------------------------------------------------------------------------
 {
-    // Kill the ref, and remove the object from the registration list.
-    le_ref_DeleteRef(HandlerSafeRefMap, handlerPtr->safeRef);
-    le_dls_Remove(&registrationPtr->handlerList, &handlerPtr->link);
+    static char stringBuffer[LE_CFG_STR_LEN_BYTES] = "";
 
-    // Clear out the link data, just to be safe.
-    handlerPtr->link = LE_DLS_LINK_INIT;
-    handlerPtr->sessionRef = NULL;
-    handlerPtr->registrationPtr = NULL;
-    handlerPtr->safeRef = NULL;
+    if (imagePtr->nodeCount == imagePtr->nodeCapacity)
+    {
+        imagePtr->nodeCapacity *= 2;
+        imagePtr->nodesPtr = realloc(imagePtr->nodesPtr,
+                                     imagePtr->nodeCapacity * sizeof(BinaryTreeNode_t));
+        LE_ASSERT(imagePtr->nodesPtr != NULL);
+    }
 
-    // Finally kill the object.
-    le_mem_Release(handlerPtr);
-}
+    // The node array may move as children are added, so keep the index rather than a pointer.
+    size_t index = imagePtr->nodeCount++;
 
+    memset(&imagePtr->nodesPtr[index], 0, sizeof(BinaryTreeNode_t));
+    imagePtr->nodesPtr[index].nameOffset = nameOffset;
+    imagePtr->nodesPtr[index].type = LE_CFG_TYPE_EMPTY;
 
+    // Missing and deleted nodes are written as empty, just like the text format does.
+    if (   (nodeRef == NULL)
+        || (IsDeleted(nodeRef) == true))
+    {
+        return;
+    }
 
+    switch (nodeRef->type)
+    {
+        case LE_CFG_TYPE_EMPTY:
+        case LE_CFG_TYPE_DOESNT_EXIST:
+            break;
 
-// -------------------------------------------------------------------------------------------------
-/**
+        case LE_CFG_TYPE_STRING:
+        case LE_CFG_TYPE_BOOL:
+        case LE_CFG_TYPE_INT:
+        case LE_CFG_TYPE_FLOAT:
+            tdb_GetValueAsString(nodeRef, stringBuffer, sizeof(stringBuffer), "");
+            imagePtr->nodesPtr[index].type = nodeRef->type;
+            imagePtr->nodesPtr[index].valueOffset = AddImageString(imagePtr, stringBuffer);
+            break;
+
+        case LE_CFG_TYPE_STEM:
+            {
+                uint32_t childCount = 0;
+                tdb_NodeRef_t childRef = tdb_GetFirstActiveChildNode(nodeRef);
+
+                while (childRef != NULL)
+                {
+                    tdb_GetNodeName(childRef, stringBuffer, sizeof(stringBuffer));
+                    AddImageNode(imagePtr, childRef, AddImageString(imagePtr, stringBuffer));
+
+                    childCount++;
+                    childRef = tdb_GetNextActiveSiblingNode(childRef);
+                }
+
+                imagePtr->nodesPtr[index].type = LE_CFG_TYPE_STEM;
+                imagePtr->nodesPtr[index].childCount = childCount;
+            }
+            break;
+    }
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Write a whole buffer to a file descriptor, retrying after interruptions and short writes.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteDescriptor
+(
+    int descriptor,       ///< [IN] The file being written to.
+    const void* dataPtr,  ///< [IN] The data being written to the file.
+    size_t dataSize       ///< [IN] The amount of data being written.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    const uint8_t* bytePtr = dataPtr;
+
+    while (dataSize > 0)
+    {
+        ssize_t written = write(descriptor, bytePtr, dataSize);
+
+        if (written == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            LE_EMERG("Failed to write to config tree file (%m).");
+            return LE_IO_ERROR;
+        }
+
+        bytePtr += written;
+        dataSize -= written;
+    }
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Serialize a tree node and it's children to a file in the binary tree format.  The whole file is
+ *  built in memory first and then written with a handful of system calls.  Names and values that
+ *  appear more than once, (which is common, think of "procs" or "args",) are only stored once.
+ *
+ *  @return LE_OK if the write succeeded, LE_IO_ERROR if the write failed.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t WriteBinaryTree
+(
+    tdb_NodeRef_t nodeRef,  ///< [IN] Write the contents of this node.
+    int descriptor          ///< [IN] The file descriptor to write to.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    BinaryTreeImage_t image;
+
+    image.nodeCapacity = 64;
+    image.nodeCount = 0;
+    image.nodesPtr = malloc(image.nodeCapacity * sizeof(BinaryTreeNode_t));
+    LE_ASSERT(image.nodesPtr != NULL);
+
+    image.stringsCapacity = 1024;
+    image.stringsSize = 1;
+    image.stringsPtr = malloc(image.stringsCapacity);
+    LE_ASSERT(image.stringsPtr != NULL);
+    image.stringsPtr[0] = '\0';
+
+    image.slotCount = 256;
+    image.slotsUsed = 0;
+    image.slotsPtr = calloc(image.slotCount, sizeof(uint32_t));
+    LE_ASSERT(image.slotsPtr != NULL);
+
+    AddImageNode(&image, nodeRef, 0);
+
+    le_result_t result = LE_OK;
+
+    if (   (image.nodeCount > UINT32_MAX)
+        || (image.stringsSize > UINT32_MAX))
+    {
+        LE_EMERG("Config tree is too large to be saved.");
+        result = LE_IO_ERROR;
+    }
+    else
+    {
+        BinaryTreeHeader_t header;
+
+        memcpy(header.magic, BINARY_TREE_MAGIC, sizeof(header.magic));
+        header.version = BINARY_TREE_VERSION;
+        header.nodeCount = image.nodeCount;
+        header.stringTableSize = image.stringsSize;
+
+        result = WriteDescriptor(descriptor, &header, sizeof(header));
+
+        if (result == LE_OK)
+        {
+            result = WriteDescriptor(descriptor,
+                                     image.nodesPtr,
+                                     image.nodeCount * sizeof(BinaryTreeNode_t));
+        }
+
+        if (result == LE_OK)
+        {
+            result = WriteDescriptor(descriptor, image.stringsPtr, image.stringsSize);
+        }
+    }
+
+    free(image.nodesPtr);
+    free(image.stringsPtr);
+    free(image.slotsPtr);
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Get a string from the string table of a binary tree file.
+ *
+ *  @return The string, or NULL if the offset is outside of the string table.
+ */
+// -------------------------------------------------------------------------------------------------
+static const char* GetImageString
+(
+    const BinaryTreeReader_t* readerPtr,  ///< [IN] The file being read.
+    uint32_t offset                       ///< [IN] Offset of the string.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // The table is known to end with a null, so every offset inside it is a valid string.
+    if (offset >= readerPtr->stringsSize)
+    {
+        return NULL;
+    }
+
+    return readerPtr->stringsPtr + offset;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Build a node's value, and if the node is a stem, all of its children, from the next record of a
+ *  binary tree file.  The node must be new and empty.
+ *
+ *  Records are known to have been written from a valid tree, so the names are not checked for
+ *  duplicates.  This is what makes loading a large stem linear instead of quadratic.
+ *
+ *  @return LE_OK if the read is successful.
+ *          LE_FORMAT_ERROR if the file is corrupt.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t ReadBinaryNode
+(
+    BinaryTreeReader_t* readerPtr,  ///< [IN] The file being read.
+    tdb_NodeRef_t nodeRef,          ///< [IN] The node we're reading a value for.
+    size_t pathLen                  ///< [IN] The length of the path including nodeRef.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    if (readerPtr->nextIndex >= readerPtr->nodeCount)
+    {
+        LE_ERROR("Unexpected end of node records.");
+        return LE_FORMAT_ERROR;
+    }
+
+    const BinaryTreeNode_t* recordPtr = &readerPtr->nodesPtr[readerPtr->nextIndex++];
+
+    switch (recordPtr->type)
+    {
+        case LE_CFG_TYPE_EMPTY:
+            break;
+
+        case LE_CFG_TYPE_STRING:
+        case LE_CFG_TYPE_BOOL:
+        case LE_CFG_TYPE_INT:
+        case LE_CFG_TYPE_FLOAT:
+            {
+                const char* valuePtr = GetImageString(readerPtr, recordPtr->valueOffset);
+
+                if (valuePtr == NULL)
+                {
+                    LE_ERROR("Bad value offset, %" PRIu32 ".", recordPtr->valueOffset);
+                    return LE_FORMAT_ERROR;
+                }
+
+                nodeRef->type = recordPtr->type;
+                nodeRef->info.valueRef = dstr_NewFromCstr(valuePtr);
+            }
+            break;
+
+        case LE_CFG_TYPE_STEM:
+            {
+                uint32_t childCount = recordPtr->childCount;
+
+                if (childCount > (readerPtr->nodeCount - readerPtr->nextIndex))
+                {
+                    LE_ERROR("Bad child count, %" PRIu32 ".", childCount);
+                    return LE_FORMAT_ERROR;
+                }
+
+                while (childCount-- > 0)
+                {
+                    const BinaryTreeNode_t* childRecordPtr =
+                                                       &readerPtr->nodesPtr[readerPtr->nextIndex];
+                    const char* namePtr = GetImageString(readerPtr, childRecordPtr->nameOffset);
+
+                    if (namePtr == NULL)
+                    {
+                        LE_ERROR("Bad name offset, %" PRIu32 ".", childRecordPtr->nameOffset);
+                        return LE_FORMAT_ERROR;
+                    }
+
+                    size_t strLen = strlen(namePtr);
+                    size_t newPathLen = pathLen + 1 + strLen;
+
+                    if (   (strLen == 0)
+                        || (strLen > LE_CFG_NAME_LEN)
+                        || (newPathLen > LE_CFG_STR_LEN))
+                    {
+                        LE_ERROR("Bad node name, '%s'.", namePtr);
+                        return LE_FORMAT_ERROR;
+                    }
+
+                    tdb_NodeRef_t childRef = NewChildNode(nodeRef);
+                    childRef->nameRef = dstr_NewFromCstr(namePtr);
+
+                    le_result_t result = ReadBinaryNode(readerPtr, childRef, newPathLen);
+
+                    if (result != LE_OK)
+                    {
+                        return result;
+                    }
+                }
+            }
+            break;
+
+        default:
+            LE_ERROR("Bad node type, %u.", recordPtr->type);
+            return LE_FORMAT_ERROR;
+    }
+
+    return LE_OK;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Read a whole tree from a file in the binary tree format.  The file is memory mapped read-only
+ *  and the nodes are built straight from the mapped records, without any parsing or copying of
+ *  the file's contents into intermediate buffers.
+ *
+ *  @return LE_OK if the read is successful.
+ *          LE_UNSUPPORTED if the file isn't in the binary format.
+ *          LE_FORMAT_ERROR if the file is corrupt.
+ *          LE_IO_ERROR if the file could not be mapped.
+ */
+// -------------------------------------------------------------------------------------------------
+static le_result_t ReadBinaryTree
+(
+    tdb_NodeRef_t rootRef,  ///< [IN] The new, empty, root node of the tree.
+    int descriptor          ///< [IN] The file to read from.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    struct stat fileStat;
+
+    if (fstat(descriptor, &fileStat) == -1)
+    {
+        LE_ERROR("Could not stat configuration tree file (%m).");
+        return LE_IO_ERROR;
+    }
+
+    if (fileStat.st_size < (off_t)sizeof(BinaryTreeHeader_t))
+    {
+        return LE_UNSUPPORTED;
+    }
+
+    size_t fileSize = fileStat.st_size;
+    const uint8_t* filePtr = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    if (filePtr == MAP_FAILED)
+    {
+        LE_ERROR("Could not map configuration tree file (%m).");
+        return LE_IO_ERROR;
+    }
+
+    le_result_t result = LE_OK;
+    const BinaryTreeHeader_t* headerPtr = (const BinaryTreeHeader_t*)filePtr;
+
+    if (memcmp(headerPtr->magic, BINARY_TREE_MAGIC, sizeof(headerPtr->magic)) != 0)
+    {
+        result = LE_UNSUPPORTED;
+    }
+    else if (headerPtr->version != BINARY_TREE_VERSION)
+    {
+        LE_ERROR("Unknown binary tree format version, %" PRIu32 ".", headerPtr->version);
+        result = LE_FORMAT_ERROR;
+    }
+    else if (   (headerPtr->nodeCount == 0)
+             || (headerPtr->stringTableSize == 0)
+             || (  sizeof(BinaryTreeHeader_t)
+                 + ((uint64_t)headerPtr->nodeCount * sizeof(BinaryTreeNode_t))
+                 + headerPtr->stringTableSize != fileSize))
+    {
+        LE_ERROR("Binary tree file size does not match its header.");
+        result = LE_FORMAT_ERROR;
+    }
+    else
+    {
+        BinaryTreeReader_t reader;
+
+        reader.nodesPtr = (const BinaryTreeNode_t*)(filePtr + sizeof(BinaryTreeHeader_t));
+        reader.nodeCount = headerPtr->nodeCount;
+        reader.nextIndex = 0;
+        reader.stringsPtr = (const char*)(reader.nodesPtr + reader.nodeCount);
+        reader.stringsSize = headerPtr->stringTableSize;
+
+        if (   (reader.stringsPtr[0] != '\0')
+            || (reader.stringsPtr[reader.stringsSize - 1] != '\0'))
+        {
+            LE_ERROR("Binary tree file has a bad string table.");
+            result = LE_FORMAT_ERROR;
+        }
+        else
+        {
+            result = ReadBinaryNode(&reader, rootRef, ComputePathLength(rootRef));
+
+            if (   (result == LE_OK)
+                && (reader.nextIndex != reader.nodeCount))
+            {
+                LE_ERROR("Unexpected node records at end of file.");
+                result = LE_FORMAT_ERROR;
+            }
+        }
+    }
+
+    if (munmap((void*)filePtr, fileSize) == -1)
+    {
+        LE_ERROR("Could not unmap configuration tree file (%m).");
+    }
+
+    return result;
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Attempt to load a configuration tree from a config file.  This function will look for the latest
+ *  valid version of the config file and load that one.
+ *
+ *  Files in the binary format are memory mapped and loaded directly.  Files in the older text
+ *  format are parsed.
+ *
+ *  @return True if the tree was loaded from a text file, and so should be saved again to convert
+ *          it to the binary format.  False otherwise.
+ */
+// -------------------------------------------------------------------------------------------------
+static bool LoadTree
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree object to load from the filesystem.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    bool isTextFile = false;
+
+    // If we don't know the revision then hunt it out from the filesystem.
+    if (treeRef->revisionId == 0)
+    {
+        UpdateRevision(treeRef);
+    }
+
+    // If this tree has no root, create it now.
+    if (treeRef->rootNodeRef == NULL)
+    {
+        treeRef->rootNodeRef = NewNode();
+    }
+
+    // Ok, if we found a valid revision of the tree in the fs, try to load it now.
+    if (treeRef->revisionId != 0)
+    {
+        char pathPtr[LE_CFG_STR_LEN_BYTES] = "";
+        GetTreePath(treeRef->name, treeRef->revisionId, pathPtr, sizeof(pathPtr));
+
+        LE_DEBUG("** Loading configuration tree from '%s'.", pathPtr);
+
+        int fileRef = -1;
+
+        do
+        {
+            fileRef = open(pathPtr, O_RDONLY);
+        }
+        while ((fileRef == -1) && (errno == EINTR));
+
+        tdb_EnsureExists(treeRef->rootNodeRef);
+
+        if (fileRef == -1)
+        {
+            LE_ERROR("Could not open configuration tree file: %s, reason: %s",
+                     pathPtr,
+                     strerror(errno));
+        }
+        else
+        {
+            le_clk_Time_t startTime = le_clk_GetRelativeTime();
+            le_result_t result = ReadBinaryTree(treeRef->rootNodeRef, fileRef);
+
+            if (result == LE_UNSUPPORTED)
+            {
+                isTextFile = true;
+
+                if (tdb_ReadTreeNode(treeRef->rootNodeRef, fileRef))
+                {
+                    result = LE_OK;
+                }
+                else
+                {
+                    result = LE_FORMAT_ERROR;
+                }
+            }
+
+            if (result != LE_OK)
+            {
+                LE_ERROR("Could not parse configuration tree file: %s.", pathPtr);
+                le_mem_Release(treeRef->rootNodeRef);
+                treeRef->rootNodeRef = NewNode();
+                isTextFile = false;
+            }
+            else
+            {
+                le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+                LE_DEBUG("** Loaded %s file '%s' in %ld.%06ld s.",
+                         isTextFile ? "text" : "binary",
+                         pathPtr,
+                         (long)elapsed.sec,
+                         (long)elapsed.usec);
+            }
+
+            int retVal = -1;
+
+            do
+            {
+                retVal = close(fileRef);
+            }
+            while ((retVal == -1) && (errno == EINTR));
+        }
+    }
+
+    return isTextFile;
+}
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Removes the handler object from the given registration object.  This function will also free the
+ *  memory that the handler object had used.
+ */
+// -------------------------------------------------------------------------------------------------
+static void RemoveHandler
+(
+    Registration_t* registrationPtr,  ///< [IN] The registration object to remove the link from.
+    Handler_t* handlerPtr             ///< [IN] The handler object we're removing.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // Kill the ref, and remove the object from the registration list.
+    le_ref_DeleteRef(HandlerSafeRefMap, handlerPtr->safeRef);
+    le_dls_Remove(&registrationPtr->handlerList, &handlerPtr->link);
+
+    // Clear out the link data, just to be safe.
+    handlerPtr->link = LE_DLS_LINK_INIT;
+    handlerPtr->sessionRef = NULL;
+    handlerPtr->registrationPtr = NULL;
+    handlerPtr->safeRef = NULL;
+
+    // Finally kill the object.
+    le_mem_Release(handlerPtr);
+}
+
+
+
+
+// -------------------------------------------------------------------------------------------------
+/**
  *  This function is called by the hash map ForEach function, which is invoked when a session closed
  *  event occurs.
  *
@@ -2634,6 +3508,90 @@ static void DeleteTreeFile
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Save a tree to a new revision of its tree file, in the binary format, then remove the file of
+ *  the previous revision.
+ */
+// -------------------------------------------------------------------------------------------------
+static void SaveTree
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree to save.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    // Increment revision of the tree and open a tree file for writing.
+    int oldId = treeRef->revisionId;
+
+    IncrementRevision(treeRef);
+
+    char filePath[LE_CFG_STR_LEN_BYTES] = "";
+    GetTreePath(treeRef->name, treeRef->revisionId, filePath, sizeof(filePath));
+
+    LE_DEBUG("Attempting to serialize the tree to '%s'.", filePath);
+
+    int fileRef = -1;
+
+    do
+    {
+        fileRef = open(filePath, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    }
+    while (   (fileRef == -1)
+           && (errno == EINTR));
+
+    if ((-1 == fileRef) && (EROFS == errno))
+    {
+        // In case we are R/O for the config tree, we discard the update to flash
+        return;
+    }
+
+    if (fileRef == -1)
+    {
+        LE_EMERG("Failed to open config file '%s' (%m).", filePath);
+        LE_EMERG("Changes have been merged in memory, however they could not be committed to the "
+                 "filesystem!!");
+        return;
+    }
+
+    // We have a tree file to write to, so stream the new tree to it then close the output file.
+    le_clk_Time_t startTime = le_clk_GetRelativeTime();
+    le_result_t writeResult = WriteBinaryTree(treeRef->rootNodeRef, fileRef);
+    int retVal = -1;
+
+    do
+    {
+        retVal = close(fileRef);
+    }
+    while ((retVal == -1) && (errno == EINTR));
+
+    LE_EMERG_IF(retVal == -1, "An error occurred while closing the tree file: %s", strerror(errno));
+
+
+    // Finally remove the old version of the tree file, if there is one.
+    if (writeResult == LE_OK)
+    {
+        le_clk_Time_t elapsed = le_clk_Sub(le_clk_GetRelativeTime(), startTime);
+
+        LE_DEBUG("** Saved '%s' in %ld.%06ld s.", filePath, (long)elapsed.sec, (long)elapsed.usec);
+
+        if (   (oldId != 0)
+            && (TreeFileExists(treeRef->name, oldId)))
+        {
+            GetTreePath(treeRef->name, oldId, filePath, sizeof(filePath));
+            DeleteTreeFile(filePath);
+        }
+    }
+    else
+    {
+        // The write failed, delete the new file we attempted to create.
+        LE_EMERG("The attempt to write to the config tree file, '%s,' failed.", filePath);
+        DeleteTreeFile(filePath);
+    }
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Find the root node represented by the path ref.
@@ -2821,7 +3779,13 @@ tdb_TreeRef_t tdb_GetTree
         treeRef = NewTree(treeNamePtr, NULL);
         le_hashmap_Put(TreeCollectionRef, treeRef->name, treeRef);
 
-        LoadTree(treeRef);
+        // Trees still stored in the text format are converted right away, so that they can be
+        // mapped the next time they're loaded.
+        if (LoadTree(treeRef))
+        {
+            LE_INFO("Converting configuration tree '%s' to the binary format.", treeRef->name);
+            SaveTree(treeRef);
+        }
     }
 
     // Finally return the tree we have to the user.
@@ -2924,6 +3888,35 @@ tdb_TreeRef_t tdb_ShadowTree
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Called to create a new read-only snapshot of an existing tree.  The snapshot shares the tree's
+ *  current nodes, and keeps seeing them as they are now, even if changes are committed to the
+ *  tree later.
+ *
+ *  @return Pointer to the new snapshot tree.
+ */
+// -------------------------------------------------------------------------------------------------
+tdb_TreeRef_t tdb_SnapshotTree
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree to take a snapshot of.
+)
+// -------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(treeRef->originalTreeRef == NULL);
+
+    le_mem_AddRef(treeRef->rootNodeRef);
+
+    tdb_TreeRef_t snapshotRef = NewTree(treeRef->name, treeRef->rootNodeRef);
+    snapshotRef->originalTreeRef = treeRef;
+    snapshotRef->isSnapshot = true;
+
+    return snapshotRef;
+}
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Called to create a new tree that shadows an existing one.
@@ -3032,6 +4025,11 @@ void tdb_RegisterIterator
     LE_ASSERT(treeRef != NULL);
     LE_ASSERT(iteratorRef != NULL);
 
+    if (treeRef->isSnapshot)
+    {
+        treeRef->originalTreeRef->snapshotCount++;
+    }
+
     if (treeRef->originalTreeRef != NULL)
     {
         treeRef = treeRef->originalTreeRef;
@@ -3067,6 +4065,14 @@ void tdb_UnregisterIterator
     LE_ASSERT(treeRef != NULL);
     LE_ASSERT(iteratorRef != NULL);
 
+    // If the snapshot still shares the tree's nodes, then it's no longer in the way of commits.
+    if (   (treeRef->isSnapshot)
+        && (treeRef->rootNodeRef == treeRef->originalTreeRef->rootNodeRef))
+    {
+        LE_ASSERT(treeRef->originalTreeRef->snapshotCount > 0);
+        treeRef->originalTreeRef->snapshotCount--;
+    }
+
     if (treeRef->originalTreeRef != NULL)
     {
         treeRef = treeRef->originalTreeRef;
@@ -3138,6 +4144,8 @@ void tdb_MergeTree
 {
     // Get our shadow tree's root node and merge it's changes into the real tree.  Create a path
     // iterator to track the merge and allow for update handlers to be called.
+    NewTreeVersion(shadowTreeRef);
+
     tdb_NodeRef_t nodeRef = shadowTreeRef->rootNodeRef;
     le_pathIter_Ref_t pathRef = CreateBasePath(shadowTreeRef->originalTreeRef->name);
 
@@ -3147,69 +4155,8 @@ void tdb_MergeTree
     // Now, go through and call the triggered callbacks.
     FireTriggeredCallbacks();
 
-    // Now increment revision of the tree and open a tree file for writing.
-    tdb_TreeRef_t originalTreeRef = shadowTreeRef->originalTreeRef;
-    int oldId = originalTreeRef->revisionId;
-
-    IncrementRevision(originalTreeRef);
-
-    char filePath[LE_CFG_STR_LEN_BYTES] = "";
-    GetTreePath(originalTreeRef->name, originalTreeRef->revisionId, filePath, sizeof(filePath));
-
-    LE_DEBUG("Changes merged, now attempting to serialize the tree to '%s'.", filePath);
-
-    int fileRef = -1;
-
-    do
-    {
-        fileRef = open(filePath, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
-    }
-    while (   (fileRef == -1)
-           && (errno == EINTR));
-
-    if ((-1 == fileRef) && (EROFS == errno))
-    {
-        // In case we are R/O for the config tree, we discard the update to flash
-        return;
-    }
-
-    if (fileRef == -1)
-    {
-        LE_EMERG("Failed to open config file '%s' (%m).", filePath);
-        LE_EMERG("Changes have been merged in memory, however they could not be committed to the "
-                 "filesystem!!");
-        return;
-    }
-
-    // We have a tree file to write to, so stream the new tree to it then close the output file.
-    le_result_t writeResult = tdb_WriteTreeNode(originalTreeRef->rootNodeRef, fileRef);
-    int retVal = -1;
-
-    do
-    {
-        retVal = close(fileRef);
-    }
-    while ((retVal == -1) && (errno == EINTR));
-
-    LE_EMERG_IF(retVal == -1, "An error occurred while closing the tree file: %s", strerror(errno));
-
-
-    // Finally remove the old version of the tree file, if there is one.
-    if (writeResult == LE_OK)
-    {
-        if (   (oldId != 0)
-            && (TreeFileExists(originalTreeRef->name, oldId)))
-        {
-            GetTreePath(originalTreeRef->name, oldId, filePath, sizeof(filePath));
-            DeleteTreeFile(filePath);
-        }
-    }
-    else
-    {
-        // The write failed, delete the new file we attempted to create.
-        LE_EMERG("The attempt to write to the config tree file, '%s,' failed.", filePath);
-        DeleteTreeFile(filePath);
-    }
+    // Finally, save the updated tree.
+    SaveTree(shadowTreeRef->originalTreeRef);
 }
 
 
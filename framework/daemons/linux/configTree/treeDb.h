@@ -121,6 +121,23 @@ tdb_TreeRef_t tdb_ShadowTree
 
 
 
+// -------------------------------------------------------------------------------------------------
+/**
+ *  Called to create a new read-only snapshot of an existing tree.  The snapshot shares the tree's
+ *  current nodes, and keeps seeing them as they are now, even if changes are committed to the
+ *  tree later.
+ *
+ *  @return Pointer to the new snapshot tree.
+ */
+// -------------------------------------------------------------------------------------------------
+tdb_TreeRef_t tdb_SnapshotTree
+(
+    tdb_TreeRef_t treeRef  ///< [IN] The tree to take a snapshot of.
+);
+
+
+
+
 // -------------------------------------------------------------------------------------------------
 /**
  *  Called to create a new tree that shadows an existing one.
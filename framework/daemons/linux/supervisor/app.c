@@ -48,6 +48,7 @@
 #include "user.h"
 #include "le_cfg_interface.h"
 #include "resourceLimits.h"
+#include "resourceUsage.h"
 #include "smack.h"
 #include "supervisor.h"
 #include "cgroups.h"
@@ -341,6 +342,7 @@ typedef struct app_Ref
     le_timer_Ref_t  killTimer;          // Timeout timer for killing processes.
     le_sls_List_t   additionalLinks;    // List of additional links that are temporarily added to
                                         // the app.
+    cgrp_GroupRef_t cgroupRef;          // Handle on the app's cgroups.
 }
 App_t;
 
@@ -374,6 +376,36 @@ FileLinkNode_t;
 static le_mem_PoolRef_t FileLinkNodePool;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Record of the SMACK rules loaded for an app.  Outlives the app object, so that an app that is
+ * re-created with the same hash (e.g., re-installed unchanged) doesn't recompute and reload them.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    char appName[LIMIT_MAX_APP_NAME_BYTES];     ///< Name of the app.  Key in LoadedSmackRules.
+    char appHash[LIMIT_MD5_STR_BYTES];          ///< Hash of the app the rules were computed for.
+}
+LoadedSmackRules_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The memory pool for loaded SMACK rule records.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t LoadedSmackRulesPool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Loaded SMACK rule records, keyed by app name.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t LoadedSmackRules;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Prototype for process stopped handler.
@@ -667,6 +699,8 @@ static le_result_t GetDevID
 //--------------------------------------------------------------------------------------------------
 static le_result_t SetDevicePermissions
 (
+    smack_RuleSetRef_t ruleSetRef,  ///< [IN] Rule set to add the device rule to, or NULL if the
+                                    ///       app's rules are already loaded.
     const char* appSmackLabelPtr,   ///< [IN] SMACK label of the app.
     const char* devPathPtr,         ///< [IN] Source path.
     const char* permPtr             ///< [IN] Permissions.
@@ -699,7 +733,10 @@ static le_result_t SetDevicePermissions
     }
 
     // Set the SMACK rule to allow the app to access the device.
-    smack_SetRule(appSmackLabelPtr, permPtr, devLabel);
+    if (ruleSetRef != NULL)
+    {
+        smack_AddRule(ruleSetRef, appSmackLabelPtr, permPtr, devLabel);
+    }
 
     return LE_OK;
 }
@@ -716,7 +753,9 @@ static le_result_t SetDevicePermissions
 //--------------------------------------------------------------------------------------------------
 static le_result_t SetCfgDevicePermissions
 (
-    app_Ref_t appRef                ///< [IN] The application.
+    app_Ref_t appRef,               ///< [IN] The application.
+    smack_RuleSetRef_t ruleSetRef   ///< [IN] Rule set to add the device rules to, or NULL if the
+                                    ///       app's rules are already loaded.
 )
 {
     // Create an iterator for the app.
@@ -746,7 +785,7 @@ static le_result_t SetCfgDevicePermissions
             char permStr[MAX_DEVICE_PERM_STR_BYTES];
             GetCfgPermissions(appCfg, permStr, sizeof(permStr));
 
-            if (SetDevicePermissions(appLabel, srcPath, permStr) != LE_OK)
+            if (SetDevicePermissions(ruleSetRef, appLabel, srcPath, permStr) != LE_OK)
             {
                 LE_ERROR("Failed to set permissions (%s) for app '%s' on device '%s'.",
                          permStr,
@@ -775,7 +814,8 @@ static le_result_t SetCfgDevicePermissions
 static void SetSmackRulesForBindings
 (
     app_Ref_t appRef,                   ///< [IN] Reference to the application.
-    const char* appLabelPtr             ///< [IN] Smack label for the app.
+    const char* appLabelPtr,            ///< [IN] Smack label for the app.
+    smack_RuleSetRef_t ruleSetRef       ///< [IN] Rule set to add the rules to.
 )
 {
     // Create a config read transaction to the bindings section for the application.
@@ -787,6 +827,7 @@ static void SetSmackRulesForBindings
     {
         // No bindings.
         le_cfg_CancelTxn(bindCfg);
+        return;
     }
 
     do
@@ -801,8 +842,8 @@ static void SetSmackRulesForBindings
             smack_GetAppLabel(serverName, serverLabel, sizeof(serverLabel));
 
             // Set the SMACK label to/from the server.
-            smack_SetRule(appLabelPtr, "rw", serverLabel);
-            smack_SetRule(serverLabel, "rw", appLabelPtr);
+            smack_AddRule(ruleSetRef, appLabelPtr, "rw", serverLabel);
+            smack_AddRule(ruleSetRef, serverLabel, "rw", appLabelPtr);
         }
     } while (le_cfg_GoToNextSibling(bindCfg) == LE_OK);
 
@@ -818,7 +859,8 @@ static void SetSmackRulesForBindings
 static void SetDefaultSmackRules
 (
     const char* appNamePtr,             ///< [IN] App name.
-    const char* appLabelPtr             ///< [IN] Smack label for the app.
+    const char* appLabelPtr,            ///< [IN] Smack label for the app.
+    smack_RuleSetRef_t ruleSetRef       ///< [IN] Rule set to add the rules to.
 )
 {
 #define NUM_PERMISSONS      7
@@ -849,15 +891,48 @@ static void SetDefaultSmackRules
         char dirLabel[LIMIT_MAX_SMACK_LABEL_BYTES];
         smack_GetAppAccessLabel(appNamePtr, mode, dirLabel, sizeof(dirLabel));
 
-        smack_SetRule(appLabelPtr, permissionStr[i], dirLabel);
+        smack_AddRule(ruleSetRef, appLabelPtr, permissionStr[i], dirLabel);
     }
 
     // Set default permissions between the app and the framework.
-    smack_SetRule("framework", "w", appLabelPtr);
-    smack_SetRule(appLabelPtr, "rw", "framework");
+    smack_AddRule(ruleSetRef, "framework", "w", appLabelPtr);
+    smack_AddRule(ruleSetRef, appLabelPtr, "rw", "framework");
 
     // Set default permissions to allow the app to access the syslog.
-    smack_SetRule(appLabelPtr, "w", "syslog");
+    smack_AddRule(ruleSetRef, appLabelPtr, "w", "syslog");
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the hash of the installed version of an application from its install directory link.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if the app is not installed or the hash could not be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetAppHash
+(
+    app_Ref_t appRef,                   ///< [IN] The application reference.
+    char hashBuf[LIMIT_MD5_STR_BYTES]   ///< [OUT] Buffer to hold the app's hash.
+)
+{
+    char linkContent[LIMIT_MAX_PATH_BYTES];
+
+    ssize_t bytesRead = readlink(appRef->installDirPath, linkContent, sizeof(linkContent));
+
+    if ( (bytesRead < 0) || (bytesRead >= sizeof(linkContent)) )
+    {
+        return LE_FAULT;
+    }
+
+    linkContent[bytesRead] = '\0';
+
+    return le_utf8_Copy(hashBuf,
+                        le_path_GetBasenamePtr(linkContent, "/"),
+                        LIMIT_MD5_STR_BYTES,
+                        NULL) == LE_OK ? LE_OK : LE_FAULT;
 }
 
 
@@ -871,6 +946,13 @@ static void CleanupAppSmackSettings
     app_Ref_t appRef                    ///< [IN] The application reference.
 )
 {
+    LoadedSmackRules_t* loadedPtr = le_hashmap_Remove(LoadedSmackRules, appRef->name);
+
+    if (loadedPtr != NULL)
+    {
+        le_mem_Release(loadedPtr);
+    }
+
     // Clean up SMACK rules.
     char appLabel[LIMIT_MAX_SMACK_LABEL_BYTES];
     smack_GetAppLabel(appRef->name, appLabel, sizeof(appLabel));
@@ -879,10 +961,40 @@ static void CleanupAppSmackSettings
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Releases the SMACK rules of an app that is being deleted.  The rules are kept loaded if the same
+ * version of the app is still installed, since they are only used by the app's own processes and
+ * will be needed again when the app is re-created.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void ReleaseAppSmackSettings
+(
+    app_Ref_t appRef                    ///< [IN] The application reference.
+)
+{
+    LoadedSmackRules_t* loadedPtr = le_hashmap_Get(LoadedSmackRules, appRef->name);
+    char appHash[LIMIT_MD5_STR_BYTES];
+
+    if ( (loadedPtr != NULL) &&
+         (GetAppHash(appRef, appHash) == LE_OK) &&
+         (strcmp(loadedPtr->appHash, appHash) == 0) )
+    {
+        return;
+    }
+
+    CleanupAppSmackSettings(appRef);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Sets SMACK rules for an application.
  *
+ * The rules are computed into a rule set and loaded in bulk.  If the rules loaded for the same
+ * version of the app are still in place, only the binding rules and the device file labels are
+ * refreshed.
+ *
  * @return
  *      LE_OK if successful.
  *      LE_FAULT if there was an error.
@@ -893,19 +1005,60 @@ static le_result_t SetSmackRules
     app_Ref_t appRef                    ///< [IN] Reference to the application.
 )
 {
-    // Clear out any residual SMACK rules from a previous incarnation of the Legato framework,
-    // in case it wasn't shut down cleanly.
-    CleanupAppSmackSettings(appRef);
+    char appHash[LIMIT_MD5_STR_BYTES];
+    bool haveHash = (GetAppHash(appRef, appHash) == LE_OK);
+
+    LoadedSmackRules_t* loadedPtr = le_hashmap_Get(LoadedSmackRules, appRef->name);
 
     // Get the app label.
     char appLabel[LIMIT_MAX_SMACK_LABEL_BYTES];
     smack_GetAppLabel(appRef->name, appLabel, sizeof(appLabel));
 
-    SetDefaultSmackRules(appRef->name, appLabel);
+    smack_RuleSetRef_t ruleSetRef = smack_CreateRuleSet();
+
+    if (haveHash && (loadedPtr != NULL) && (strcmp(loadedPtr->appHash, appHash) == 0))
+    {
+        LE_DEBUG("SMACK rules for app '%s' are already loaded.", appRef->name);
+
+        // The binding rules are reloaded anyway: the ones that have a server app as subject are
+        // revoked with the server's own rules when the server is updated or removed.
+        SetSmackRulesForBindings(appRef, appLabel, ruleSetRef);
+        smack_LoadRuleSet(ruleSetRef);
+        smack_DeleteRuleSet(ruleSetRef);
+
+        return SetCfgDevicePermissions(appRef, NULL);
+    }
+
+    // Clear out any residual SMACK rules from a previous version of the app or a previous
+    // incarnation of the Legato framework, in case it wasn't shut down cleanly.
+    CleanupAppSmackSettings(appRef);
+
+    SetDefaultSmackRules(appRef->name, appLabel, ruleSetRef);
+
+    SetSmackRulesForBindings(appRef, appLabel, ruleSetRef);
 
-    SetSmackRulesForBindings(appRef, appLabel);
+    le_result_t result = SetCfgDevicePermissions(appRef, ruleSetRef);
 
-    return SetCfgDevicePermissions(appRef);
+    if (result == LE_OK)
+    {
+        smack_LoadRuleSet(ruleSetRef);
+
+        if (haveHash)
+        {
+            loadedPtr = le_mem_ForceAlloc(LoadedSmackRulesPool);
+
+            LE_ASSERT(le_utf8_Copy(loadedPtr->appName, appRef->name,
+                                   sizeof(loadedPtr->appName), NULL) == LE_OK);
+            LE_ASSERT(le_utf8_Copy(loadedPtr->appHash, appHash,
+                                   sizeof(loadedPtr->appHash), NULL) == LE_OK);
+
+            le_hashmap_Put(LoadedSmackRules, loadedPtr->appName, loadedPtr);
+        }
+    }
+
+    smack_DeleteRuleSet(ruleSetRef);
+
+    return result;
 }
 
 
@@ -952,12 +1105,12 @@ static le_result_t KillAppProcs
 )
 {
     // Freeze app procs.
-    if (cgrp_frz_Freeze(appRef->name) == LE_OK)
+    if (cgrp_grp_Freeze(appRef->cgroupRef) == LE_OK)
     {
         // Wait till procs are frozen.
         while (1)
         {
-            cgrp_FreezeState_t freezeState = cgrp_frz_GetState(appRef->name);
+            cgrp_FreezeState_t freezeState = cgrp_grp_GetFreezeState(appRef->cgroupRef);
 
             if (freezeState == CGRP_FROZEN)
             {
@@ -993,7 +1146,7 @@ static le_result_t KillAppProcs
     }
 
     // Thaw app procs to allow them to run and process the signal we sent them.
-    if (cgrp_frz_Thaw(appRef->name) != LE_OK)
+    if (cgrp_grp_Thaw(appRef->cgroupRef) != LE_OK)
     {
         LE_ERROR("Could not thaw processes for application '%s'.", appRef->name);
     }
@@ -2466,6 +2619,12 @@ void app_Init
     AppPool = le_mem_CreatePool("Apps", sizeof(App_t));
     FileLinkNodePool = le_mem_CreatePool("Links", sizeof(FileLinkNode_t));
     ProcContainerPool = le_mem_CreatePool("ProcContainers", sizeof(ProcContainer_t));
+    LoadedSmackRulesPool = le_mem_CreatePool("LoadedSmackRules", sizeof(LoadedSmackRules_t));
+
+    LoadedSmackRules = le_hashmap_Create("LoadedSmackRules",
+                                         31,
+                                         le_hashmap_HashString,
+                                         le_hashmap_EqualsString);
 
     proc_Init();
 
@@ -2619,6 +2778,7 @@ app_Ref_t app_Create
     appPtr->additionalLinks = LE_SLS_LIST_INIT;
     appPtr->state = APP_STATE_STOPPED;
     appPtr->killTimer = NULL;
+    appPtr->cgroupRef = NULL;
 
     // Get a config iterator for this app.
     le_cfg_IteratorRef_t cfgIterator = le_cfg_CreateReadTxn(appPtr->cfgPathRoot);
@@ -2708,6 +2868,18 @@ app_Ref_t app_Create
         while (le_cfg_GoToNextSibling(cfgIterator) == LE_OK);
     }
 
+    // Create the app's cgroups.  The handle keeps them open for as long as the app object exists.
+    appPtr->cgroupRef = cgrp_grp_Create(appPtr->name);
+
+    if (appPtr->cgroupRef == NULL)
+    {
+        LE_ERROR("Could not create cgroups.  Application %s cannot be started.", appPtr->name);
+
+        goto failed;
+    }
+
+    resUsage_AddApp(appPtr);
+
     // Set the resource limit for this application.
     if (resLim_SetAppLimits(appPtr) != LE_OK)
     {
@@ -2717,15 +2889,10 @@ app_Ref_t app_Create
         goto failed;
     }
 
-    // Enable "notify_on_release" for this app, so the Supervisor will be notified when this app
+    // Enable release notification for this app, so the Supervisor will be notified when this app
     // stops.
-    // Need to account for the characters other than app name in the path of notify_on_release.
-    char notifyPath[LIMIT_MAX_APP_NAME_BYTES + 41] = {0};
-    LE_ASSERT(snprintf(notifyPath, sizeof(notifyPath),
-                       "/sys/fs/cgroup/freezer/%s/notify_on_release", appPtr->name)
-              < sizeof(notifyPath));
-
-    file_WriteStr(notifyPath, "1", 0);
+    LE_ERROR_IF(cgrp_grp_EnableReleaseNotify(appPtr->cgroupRef) != LE_OK,
+                "Could not enable release notification for app '%s'.", appPtr->name);
 
     // Set SMACK rules for this app.
     // Setup the runtime area in the file system.
@@ -2783,10 +2950,16 @@ void app_Delete
     app_Ref_t appRef                    ///< [IN] Reference to the application to delete.
 )
 {
-    CleanupAppSmackSettings(appRef);
+    ReleaseAppSmackSettings(appRef);
+
+    // Remove the app's cgroups, which also removes the resource limits.
+    if (appRef->cgroupRef != NULL)
+    {
+        resUsage_RemoveApp(appRef);
 
-    // Remove the resource limits.
-    resLim_CleanupApp(appRef);
+        LE_ERROR_IF(cgrp_grp_Delete(appRef->cgroupRef) != LE_OK,
+                    "Could not remove cgroups for application '%s'.", appRef->name);
+    }
 
     // Delete all the process containers.
     DeleteProcContainersList(appRef->procs);
@@ -3135,6 +3308,23 @@ const char* app_GetConfigPath
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the handle on an application's cgroups.
+ *
+ * @return
+ *      The application's cgroup handle.
+ */
+//--------------------------------------------------------------------------------------------------
+cgrp_GroupRef_t app_GetCgroup
+(
+    app_Ref_t appRef                    ///< [IN] The application reference.
+)
+{
+    return appRef->cgroupRef;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets an application's supplementary groups list.
@@ -3934,7 +4124,9 @@ le_result_t app_SetDevPerm
     char appLabel[LIMIT_MAX_SMACK_LABEL_BYTES];
     smack_GetAppLabel(app_GetName(appRef), appLabel, sizeof(appLabel));
 
-    le_result_t result = SetDevicePermissions(appLabel, pathPtr, permissionPtr);
+    smack_RuleSetRef_t ruleSetRef = smack_CreateRuleSet();
+
+    le_result_t result = SetDevicePermissions(ruleSetRef, appLabel, pathPtr, permissionPtr);
 
     if (result != LE_OK)
     {
@@ -3943,6 +4135,21 @@ le_result_t app_SetDevPerm
                  appRef->name,
                  pathPtr);
     }
+    else
+    {
+        smack_LoadRuleSet(ruleSetRef);
+
+        // The app's rules no longer match its installed version, so make sure they are revoked
+        // rather than kept when the app is deleted.
+        LoadedSmackRules_t* loadedPtr = le_hashmap_Remove(LoadedSmackRules, appRef->name);
+
+        if (loadedPtr != NULL)
+        {
+            le_mem_Release(loadedPtr);
+        }
+    }
+
+    smack_DeleteRuleSet(ruleSetRef);
 
     return result;
 }
@@ -9,6 +9,7 @@
 #define LEGATO_SRC_APP_INCLUDE_GUARD
 
 #include "watchdogAction.h"
+#include "cgroups.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -316,6 +317,20 @@ const char* app_GetWorkingDir
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the handle on an application's cgroups.
+ *
+ * @return
+ *      The application's cgroup handle.
+ */
+//--------------------------------------------------------------------------------------------------
+cgrp_GroupRef_t app_GetCgroup
+(
+    app_Ref_t appRef                    ///< [IN] The application reference.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets an application's configuration path.
@@ -70,6 +70,7 @@
 #include "properties.h"
 #include "smack.h"
 #include "cgroups.h"
+#include "resourceUsage.h"
 #include "file.h"
 #include "installer.h"
 
@@ -983,6 +984,32 @@ static void MarkAppAsStopped
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called when the last process has exited the cgroup of an app.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AppStopped
+(
+    const char* appNamePtr          ///< [IN] Name of the app, which is also the name of its cgroup.
+)
+{
+    AppContainer_t* appContainerPtr = GetActiveApp(appNamePtr);
+    if (appContainerPtr == NULL)
+    {
+        // App may be missing in some fault cases when shutting down the system.
+        // App has already been cleaned up, so safe to ignore shutdown notification.
+        LE_WARN("Cannot find active app '%s'", appNamePtr);
+    }
+    else
+    {
+        app_Ref_t appRef = appContainerPtr->appRef;
+
+        MarkAppAsStopped(appRef, appContainerPtr);
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Handler function called when the last process has exited a freezer cgroup.
@@ -1007,19 +1034,7 @@ static void AppStopHandler
 
         if (numBytesRead > 0)
         {
-            AppContainer_t* appContainerPtr = GetActiveApp(appName);
-            if (appContainerPtr == NULL)
-            {
-                // App may be missing in some fault cases when shutting down the system.
-                // App has already been cleaned up, so safe to ignore shutdown notification.
-                LE_WARN("Cannot find active app '%s'", appName);
-            }
-            else
-            {
-                app_Ref_t appRef = appContainerPtr->appRef;
-
-                MarkAppAsStopped(appRef, appContainerPtr);
-            }
+            AppStopped(appName);
         }
         else if (numBytesRead == 0)
         {
@@ -1123,6 +1138,7 @@ void apps_Init
 )
 {
     app_Init();
+    resUsage_Init();
 
     // Create memory pools.
     AppContainerPool = le_mem_CreatePool("appContainers", sizeof(AppContainer_t));
@@ -1145,9 +1161,17 @@ void apps_Init
                                                   AppStopHandler, POLLIN);
 
     // Specify the program to be run when the last process exits a freezer sub-group. This program
-    // notifies the Supervisor which app has stopped.
-    file_WriteStr("/sys/fs/cgroup/freezer/release_agent",
-                  "/legato/systems/current/bin/_appStopClient", 0);
+    // notifies the Supervisor which app has stopped.  The unified cgroup hierarchy has no release
+    // agent: the cgroups library watches the apps' cgroups and tells us directly instead.
+    if (!cgrp_IsUnified())
+    {
+        file_WriteStr("/sys/fs/cgroup/freezer/release_agent",
+                      "/legato/systems/current/bin/_appStopClient", 0);
+    }
+    else
+    {
+        cgrp_SetReleaseHandler(AppStopped);
+    }
 }
 
 
@@ -2205,6 +2229,83 @@ le_result_t le_appInfo_GetHash
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a summary of the recent resource usage of an application.
+ *
+ * @return
+ *      LE_OK if the usage was successfully retrieved.
+ *      LE_NOT_FOUND if no samples have been taken for the application, for example because it is
+ *                   not running.
+ *
+ * @note If the application name pointer is null or if its string is empty or of bad format it is a
+ *       fatal error, the function will not return.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_appInfo_GetUsage
+(
+    const char* appName,
+        ///< [IN]
+        ///< Application name.
+
+    uint32_t numSamples,
+        ///< [IN]
+        ///< Number of most recent samples to summarize.
+
+    uint32_t* cpuPermillePtr,
+        ///< [OUT]
+        ///< Average cpu use over the samples.
+
+    uint32_t* peakCpuPermillePtr,
+        ///< [OUT]
+        ///< Highest cpu use in a single sample.
+
+    uint64_t* rssBytesPtr,
+        ///< [OUT]
+        ///< Resident memory at the latest sample.
+
+    uint64_t* peakRssBytesPtr,
+        ///< [OUT]
+        ///< Highest resident memory in the samples.
+
+    uint32_t* pageFaultsPtr,
+        ///< [OUT]
+        ///< Page faults during the samples.
+
+    uint32_t* majorPageFaultsPtr
+        ///< [OUT]
+        ///< Page faults that needed I/O during the samples.
+)
+{
+    if (!IsAppNameValid(appName))
+    {
+        LE_KILL_CLIENT("Invalid app name.");
+        return LE_FAULT;
+    }
+
+    // Keep sampling while this client is connected.
+    resUsage_AddConsumer(le_appInfo_GetClientSessionRef());
+
+    resUsage_Summary_t summary;
+
+    le_result_t result = resUsage_GetSummary(appName, numSamples, &summary);
+
+    if (result != LE_OK)
+    {
+        return result;
+    }
+
+    *cpuPermillePtr = summary.cpuPermille;
+    *peakCpuPermillePtr = summary.peakCpuPermille;
+    *rssBytesPtr = summary.rssBytes;
+    *peakRssBytesPtr = summary.peakRssBytes;
+    *pageFaultsPtr = summary.pageFaults;
+    *majorPageFaultsPtr = summary.majorPageFaults;
+
+    return LE_OK;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * A watchdog has timed out. This function determines the watchdogAction to take and applies it.
@@ -1350,6 +1350,23 @@ const char* proc_GetAppName
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the application that this process belongs to.
+ *
+ * @return
+ *      The application reference.
+ */
+//--------------------------------------------------------------------------------------------------
+app_Ref_t proc_GetApp
+(
+    proc_Ref_t procRef             ///< [IN] The process reference.
+)
+{
+    return procRef->appRef;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the process's config path.
@@ -179,6 +179,20 @@ const char* proc_GetAppName
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the application that this process belongs to.
+ *
+ * @return
+ *      The application reference.
+ */
+//--------------------------------------------------------------------------------------------------
+app_Ref_t proc_GetApp
+(
+    proc_Ref_t procRef             ///< [IN] The process reference.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get the process's config path.
@@ -179,9 +179,11 @@ static int GetCfgResourceLimit
     int defaultValue                // The default value to use if the config value is invalid.
 )
 {
-    int limitValue = le_cfg_GetInt(limitCfg, nodeName, defaultValue);
+    // Every limit is read for every process start, so classify the node with a single config
+    // tree request rather than separate existence, emptiness and type checks.
+    le_cfg_nodeType_t nodeType = le_cfg_GetNodeType(limitCfg, nodeName);
 
-    if (!le_cfg_NodeExists(limitCfg, nodeName))
+    if (nodeType == LE_CFG_TYPE_DOESNT_EXIST)
     {
         LE_INFO("Configured resource limit %s is not available.  Using the default value %d.",
                  nodeName, defaultValue);
@@ -189,7 +191,7 @@ static int GetCfgResourceLimit
         return defaultValue;
     }
 
-    if (le_cfg_IsEmpty(limitCfg, nodeName))
+    if (nodeType == LE_CFG_TYPE_EMPTY)
     {
         LE_WARN("Configured resource limit %s is empty.  Using the default value %d.",
                  nodeName, defaultValue);
@@ -197,7 +199,7 @@ static int GetCfgResourceLimit
         return defaultValue;
     }
 
-    if (le_cfg_GetNodeType(limitCfg, nodeName) != LE_CFG_TYPE_INT)
+    if (nodeType != LE_CFG_TYPE_INT)
     {
         LE_ERROR("Configured resource limit %s is the wrong type.  Using the default value %d.",
                  nodeName, defaultValue);
@@ -205,6 +207,8 @@ static int GetCfgResourceLimit
         return defaultValue;
     }
 
+    int limitValue = le_cfg_GetInt(limitCfg, nodeName, defaultValue);
+
     if (limitValue < 0)
     {
         LE_ERROR("Configured resource limit %s is negative.  Using the default value %d.",
@@ -321,33 +325,8 @@ le_result_t resLim_SetAppLimits
     app_Ref_t appRef                ///< [IN] The application to set resource limits for.
 )
 {
-    const char* appNamePtr = app_GetName(appRef);
-
-    // Create cgroups for this application in each of the cgroup subsystems.
-    cgrp_SubSys_t subSys = 0;
-    while (subSys < CGRP_NUM_SUBSYSTEMS)
-    {
-        switch(cgrp_Create(subSys, appNamePtr))
-        {
-            case LE_FAULT:
-                return LE_FAULT;
-
-            case LE_DUPLICATE:
-                // Try to delete the cgroup.
-                if (cgrp_Delete(subSys, appNamePtr) != LE_OK)
-                {
-                    return LE_FAULT;
-                }
-
-                // Go on and try to create it again.
-                break;
-
-            default:
-                // Successfully created the cgroup go onto the next sub system.
-                subSys++;
-                break;
-        }
-    }
+    // The app's cgroups were created with the app; stage its limits and write them in one pass.
+    cgrp_GroupRef_t cgroupRef = app_GetCgroup(appRef);
 
     // Create a config iterator for this app.
     le_cfg_IteratorRef_t appCfg = le_cfg_CreateReadTxn(app_GetConfigPath(appRef));
@@ -355,26 +334,18 @@ le_result_t resLim_SetAppLimits
     // Get the cpu share value from the config.
     int cpuShare = GetCfgResourceLimit(appCfg, CFG_NODE_LIMIT_CPU_SHARE, DEFAULT_LIMIT_CPU_SHARE);
 
-    // Set the cpu limit.
-    if (cgrp_cpu_SetShare(appNamePtr, cpuShare) != LE_OK)
-    {
-        le_cfg_CancelTxn(appCfg);
-        return LE_FAULT;
-    }
+    cgrp_grp_SetCpuShare(cgroupRef, cpuShare);
 
-    // Set the memory limit.
+    // Get the memory limit.
     int maxMemoryBytes = GetCfgResourceLimit(appCfg,
                                              CFG_NODE_LIMIT_MAX_MEMORY_BYTES,
                                              DEFAULT_LIMIT_MAX_MEMORY_BYTES);
 
-    if (cgrp_mem_SetLimit(appNamePtr, maxMemoryBytes / 1024) != LE_OK)
-    {
-        le_cfg_CancelTxn(appCfg);
-        return LE_FAULT;
-    }
+    cgrp_grp_SetMemLimit(cgroupRef, maxMemoryBytes / 1024);
 
     le_cfg_CancelTxn(appCfg);
-    return LE_OK;
+
+    return cgrp_grp_Apply(cgroupRef);
 }
 
 
@@ -465,41 +436,11 @@ le_result_t resLim_SetProcLimits
                         DEFAULT_LIMIT_MAX_QUEUED_SIGNALS);
     }
 
-    // Add the process to its app's cgroups in each of the cgroup subsystems.
-    cgrp_SubSys_t subSys = 0;
-    for (; subSys < CGRP_NUM_SUBSYSTEMS; subSys++)
-    {
-        // Do not add realtime processes to the cpu cgroup.
-        if ( (subSys != CGRP_SUBSYS_CPU) || (!proc_IsRealtime(procRef)) )
-        {
-            LE_ASSERT(cgrp_AddProc(subSys, proc_GetAppName(procRef), pid) == LE_OK);
-        }
-    }
+    // Add the process to its app's cgroups in each of the cgroup subsystems.  Do not add realtime
+    // processes to the cpu cgroup.
+    LE_ASSERT(cgrp_grp_AddProc(app_GetCgroup(proc_GetApp(procRef)), pid, proc_IsRealtime(procRef))
+              == LE_OK);
 
     return LE_OK;
 }
 
-
-//--------------------------------------------------------------------------------------------------
-/**
- * Cleans up any resources used to set the resource limits for an application.  This should be
- * called when an app is completely stopped, meaning all processes in the application have been
- * killed.
- */
-//--------------------------------------------------------------------------------------------------
-void resLim_CleanupApp
-(
-    app_Ref_t appRef                ///< [IN] Application to clean up resources for.
-)
-{
-    const char* appNamePtr = app_GetName(appRef);
-
-    // Remove cgroups for this app in each of the cgroup subsystems.
-    cgrp_SubSys_t subSys = 0;
-    for (; subSys < CGRP_NUM_SUBSYSTEMS; subSys++)
-    {
-        LE_ERROR_IF(cgrp_Delete(subSys, appNamePtr) != LE_OK,
-                    "Could not remove %s cgroup for application '%s'.",
-                    cgrp_SubSysName(subSys), appNamePtr);
-    }
-}
@@ -58,17 +58,4 @@ le_result_t resLim_SetProcLimits
 );
 
 
-//--------------------------------------------------------------------------------------------------
-/**
- * Cleans up any resources used to set the resource limits for an application.  This should be
- * called when an app is completely stopped, meaning all processes in the application have been
- * killed.
- */
-//--------------------------------------------------------------------------------------------------
-void resLim_CleanupApp
-(
-    app_Ref_t appRef                ///< [IN] Application to clean up resources for.
-);
-
-
 #endif  // LEGATO_SRC_RESOURCE_LIMITS_INCLUDE_GUARD
@@ -0,0 +1,503 @@
+//--------------------------------------------------------------------------------------------------
+/** @file supervisor/resourceUsage.c
+ *
+ * Periodically samples the cpu time, resident memory and page fault counters of every running
+ * application's cgroups into a fixed-size ring buffer per application, so that recent usage can be
+ * queried without reading any counters at query time.
+ *
+ * Sampling only runs while some client is interested in the usage: it starts when a client first
+ * asks for it, and stops, discarding the samples, when the last such client disconnects.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+
+#include "legato.h"
+#include "interfaces.h"
+#include "resourceUsage.h"
+#include "cgroups.h"
+#include "limit.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Number of samples kept for each application.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_SAMPLES                 LE_APPINFO_MAX_USAGE_SAMPLES
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Interval between samples, in milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+#define SAMPLE_INTERVAL_MS          LE_APPINFO_USAGE_SAMPLE_INTERVAL_MS
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A resource usage sample, covering the interval since the previous sample.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t rssBytes;              ///< Resident memory at the end of the interval.
+    uint32_t cpuPermille;           ///< Cpu use during the interval.
+    uint32_t pageFaults;            ///< Page faults during the interval.
+    uint32_t majorPageFaults;       ///< Major page faults during the interval.
+}
+Sample_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Resource usage of an application.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    app_Ref_t       appRef;                 ///< The application.
+    bool            haveCounters;           ///< true if lastCounters is from the previous sample.
+    cgrp_Usage_t    lastCounters;           ///< Counters read at the previous sample.
+    le_clk_Time_t   lastTime;               ///< Time of the previous sample.
+    size_t          nextIndex;              ///< Index in samples[] where the next sample goes.
+    size_t          numSamples;             ///< Number of valid samples.
+    Sample_t        samples[MAX_SAMPLES];   ///< Ring buffer of samples.
+    le_dls_Link_t   link;                   ///< Link in the list of sampled applications.
+}
+AppUsage_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of application resource usage objects.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t AppUsagePool;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * List of sampled applications.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_dls_List_t AppUsageList = LE_DLS_LIST_INIT;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sessions of the clients that have asked for resource usage, keyed by session reference.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_hashmap_Ref_t ConsumerMap;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sampling timer.  Only runs while there are applications in the list and clients in the
+ * consumer map.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_timer_Ref_t SampleTimer;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the increase of a counter, treating a counter that went backwards as not having moved.
+ *
+ * @return
+ *      The increase, saturated to 32 bits.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint32_t CounterDelta
+(
+    uint64_t previous,              ///< [IN] Previous value of the counter.
+    uint64_t current                ///< [IN] Current value of the counter.
+)
+{
+    if (current <= previous)
+    {
+        return 0;
+    }
+
+    uint64_t delta = current - previous;
+
+    return (delta > UINT32_MAX) ? UINT32_MAX : (uint32_t)delta;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Drops the samples and counters of an application, so that a stopped application has no usage
+ * and the next run starts a fresh set of samples.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ResetSamples
+(
+    AppUsage_t* appUsagePtr         ///< [IN] The application's resource usage.
+)
+{
+    appUsagePtr->haveCounters = false;
+    appUsagePtr->numSamples = 0;
+    appUsagePtr->nextIndex = 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes a resource usage sample of an application.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SampleApp
+(
+    AppUsage_t* appUsagePtr         ///< [IN] The application's resource usage.
+)
+{
+    cgrp_Usage_t counters;
+
+    // Only running apps are sampled.  Samples from a previous run are not kept.
+    if (   (app_GetState(appUsagePtr->appRef) != APP_STATE_RUNNING)
+        || (cgrp_grp_GetUsage(app_GetCgroup(appUsagePtr->appRef), &counters) != LE_OK) )
+    {
+        ResetSamples(appUsagePtr);
+        return;
+    }
+
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    if (appUsagePtr->haveCounters)
+    {
+        le_clk_Time_t elapsed = le_clk_Sub(now, appUsagePtr->lastTime);
+        uint64_t elapsedUs = ((uint64_t)elapsed.sec * 1000000) + elapsed.usec;
+
+        Sample_t* samplePtr = &appUsagePtr->samples[appUsagePtr->nextIndex];
+
+        // Nanoseconds of cpu time per microsecond of wall time is tenths of a percent.
+        uint64_t cpuTimeNs = (counters.cpuTimeNs > appUsagePtr->lastCounters.cpuTimeNs) ?
+                             (counters.cpuTimeNs - appUsagePtr->lastCounters.cpuTimeNs) : 0;
+        samplePtr->cpuPermille = (elapsedUs == 0) ? 0 : CounterDelta(0, cpuTimeNs / elapsedUs);
+        samplePtr->rssBytes = counters.rssBytes;
+        samplePtr->pageFaults = CounterDelta(appUsagePtr->lastCounters.pageFaults,
+                                             counters.pageFaults);
+        samplePtr->majorPageFaults = CounterDelta(appUsagePtr->lastCounters.majorPageFaults,
+                                                  counters.majorPageFaults);
+
+        appUsagePtr->nextIndex = (appUsagePtr->nextIndex + 1) % MAX_SAMPLES;
+
+        if (appUsagePtr->numSamples < MAX_SAMPLES)
+        {
+            appUsagePtr->numSamples++;
+        }
+    }
+
+    appUsagePtr->lastCounters = counters;
+    appUsagePtr->lastTime = now;
+    appUsagePtr->haveCounters = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sampling timer handler.  Samples every application in the list.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SampleTimerHandler
+(
+    le_timer_Ref_t timerRef         ///< [IN] The sampling timer.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&AppUsageList);
+
+    while (linkPtr != NULL)
+    {
+        SampleApp(CONTAINER_OF(linkPtr, AppUsage_t, link));
+
+        linkPtr = le_dls_PeekNext(&AppUsageList, linkPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts or stops the sampling timer depending on whether there are applications to sample and
+ * clients interested in their usage.  When sampling stops, the samples are discarded, as they
+ * would be stale by the time sampling starts again.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UpdateSampling
+(
+    void
+)
+{
+    bool isNeeded = !le_dls_IsEmpty(&AppUsageList) && (le_hashmap_Size(ConsumerMap) > 0);
+
+    if (isNeeded == le_timer_IsRunning(SampleTimer))
+    {
+        return;
+    }
+
+    if (isNeeded)
+    {
+        // Read the counters now, so the first samples are ready after one interval.
+        SampleTimerHandler(SampleTimer);
+
+        LE_ASSERT(le_timer_Start(SampleTimer) == LE_OK);
+    }
+    else
+    {
+        le_timer_Stop(SampleTimer);
+
+        le_dls_Link_t* linkPtr = le_dls_Peek(&AppUsageList);
+
+        while (linkPtr != NULL)
+        {
+            AppUsage_t* appUsagePtr = CONTAINER_OF(linkPtr, AppUsage_t, link);
+
+            appUsagePtr->haveCounters = false;
+            appUsagePtr->nextIndex = 0;
+            appUsagePtr->numSamples = 0;
+
+            linkPtr = le_dls_PeekNext(&AppUsageList, linkPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Service close handler.  Stops sampling when the last client interested in resource usage
+ * disconnects.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ConsumerCloseHandler
+(
+    le_msg_SessionRef_t sessionRef,         ///< [IN] Session reference of the client.
+    void*               contextPtr          ///< [IN] Not used.
+)
+{
+    if (le_hashmap_Remove(ConsumerMap, sessionRef) != NULL)
+    {
+        UpdateSampling();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finds the resource usage of an application by its reference.
+ *
+ * @return
+ *      The application's resource usage, or NULL if it is not being sampled.
+ */
+//--------------------------------------------------------------------------------------------------
+static AppUsage_t* FindByRef
+(
+    app_Ref_t appRef                ///< [IN] The application.
+)
+{
+    le_dls_Link_t* linkPtr = le_dls_Peek(&AppUsageList);
+
+    while (linkPtr != NULL)
+    {
+        AppUsage_t* appUsagePtr = CONTAINER_OF(linkPtr, AppUsage_t, link);
+
+        if (appUsagePtr->appRef == appRef)
+        {
+            return appUsagePtr;
+        }
+
+        linkPtr = le_dls_PeekNext(&AppUsageList, linkPtr);
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the resource usage sampler.
+ */
+//--------------------------------------------------------------------------------------------------
+void resUsage_Init
+(
+    void
+)
+{
+    AppUsagePool = le_mem_CreatePool("AppUsage", sizeof(AppUsage_t));
+
+    SampleTimer = le_timer_Create("ResourceUsage");
+    LE_ASSERT(le_timer_SetMsInterval(SampleTimer, SAMPLE_INTERVAL_MS) == LE_OK);
+    LE_ASSERT(le_timer_SetRepeat(SampleTimer, 0) == LE_OK);
+    LE_ASSERT(le_timer_SetHandler(SampleTimer, SampleTimerHandler) == LE_OK);
+
+    ConsumerMap = le_hashmap_Create("UsageConsumers",
+                                    31,
+                                    le_hashmap_HashVoidPointer,
+                                    le_hashmap_EqualsVoidPointer);
+
+    le_msg_AddServiceCloseHandler(le_appInfo_GetServiceRef(), ConsumerCloseHandler, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Registers a client as interested in resource usage.  Sampling runs from the first client's
+ * registration until the last registered client disconnects.
+ */
+//--------------------------------------------------------------------------------------------------
+void resUsage_AddConsumer
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] Session reference of the client.
+)
+{
+    if (!le_hashmap_ContainsKey(ConsumerMap, sessionRef))
+    {
+        le_hashmap_Put(ConsumerMap, sessionRef, sessionRef);
+        UpdateSampling();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts sampling the resource usage of an application.  Samples are only taken while the
+ * application is running.  The application's cgroups must have been created.
+ */
+//--------------------------------------------------------------------------------------------------
+void resUsage_AddApp
+(
+    app_Ref_t appRef                ///< [IN] The application to sample.
+)
+{
+    AppUsage_t* appUsagePtr = le_mem_ForceAlloc(AppUsagePool);
+
+    memset(appUsagePtr, 0, sizeof(*appUsagePtr));
+    appUsagePtr->appRef = appRef;
+    appUsagePtr->link = LE_DLS_LINK_INIT;
+
+    le_dls_Queue(&AppUsageList, &appUsagePtr->link);
+
+    UpdateSampling();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops sampling the resource usage of an application and discards its samples.
+ */
+//--------------------------------------------------------------------------------------------------
+void resUsage_RemoveApp
+(
+    app_Ref_t appRef                ///< [IN] The application.
+)
+{
+    AppUsage_t* appUsagePtr = FindByRef(appRef);
+
+    if (appUsagePtr == NULL)
+    {
+        return;
+    }
+
+    le_dls_Remove(&AppUsageList, &appUsagePtr->link);
+    le_mem_Release(appUsagePtr);
+
+    UpdateSampling();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Summarizes the most recent resource usage samples of an application.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if there are no samples for the application, or it is not running.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t resUsage_GetSummary
+(
+    const char* appNamePtr,         ///< [IN] Name of the application.
+    size_t numSamples,              ///< [IN] Number of most recent samples to summarize.  0 means
+                                    ///       all the samples that are kept.
+    resUsage_Summary_t* summaryPtr  ///< [OUT] Summary of the samples.
+)
+{
+    AppUsage_t* appUsagePtr = NULL;
+    le_dls_Link_t* linkPtr = le_dls_Peek(&AppUsageList);
+
+    while (linkPtr != NULL)
+    {
+        AppUsage_t* candidatePtr = CONTAINER_OF(linkPtr, AppUsage_t, link);
+
+        if (strncmp(app_GetName(candidatePtr->appRef), appNamePtr, LIMIT_MAX_APP_NAME_BYTES) == 0)
+        {
+            appUsagePtr = candidatePtr;
+            break;
+        }
+
+        linkPtr = le_dls_PeekNext(&AppUsageList, linkPtr);
+    }
+
+    if (appUsagePtr == NULL)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    // The app may have stopped since the last sample was taken.
+    if (app_GetState(appUsagePtr->appRef) != APP_STATE_RUNNING)
+    {
+        ResetSamples(appUsagePtr);
+    }
+
+    if (appUsagePtr->numSamples == 0)
+    {
+        return LE_NOT_FOUND;
+    }
+
+    if ((numSamples == 0) || (numSamples > appUsagePtr->numSamples))
+    {
+        numSamples = appUsagePtr->numSamples;
+    }
+
+    memset(summaryPtr, 0, sizeof(*summaryPtr));
+    summaryPtr->numSamples = numSamples;
+
+    // Walk back from the newest sample.
+    uint64_t cpuTotal = 0;
+    uint64_t faults = 0;
+    uint64_t majorFaults = 0;
+    size_t index = appUsagePtr->nextIndex;
+    size_t i;
+
+    for (i = 0; i < numSamples; i++)
+    {
+        index = (index == 0) ? (MAX_SAMPLES - 1) : (index - 1);
+
+        const Sample_t* samplePtr = &appUsagePtr->samples[index];
+
+        if (i == 0)
+        {
+            summaryPtr->rssBytes = samplePtr->rssBytes;
+        }
+
+        cpuTotal += samplePtr->cpuPermille;
+        faults += samplePtr->pageFaults;
+        majorFaults += samplePtr->majorPageFaults;
+
+        if (samplePtr->cpuPermille > summaryPtr->peakCpuPermille)
+        {
+            summaryPtr->peakCpuPermille = samplePtr->cpuPermille;
+        }
+
+        if (samplePtr->rssBytes > summaryPtr->peakRssBytes)
+        {
+            summaryPtr->peakRssBytes = samplePtr->rssBytes;
+        }
+    }
+
+    summaryPtr->cpuPermille = cpuTotal / numSamples;
+    summaryPtr->pageFaults = CounterDelta(0, faults);
+    summaryPtr->majorPageFaults = CounterDelta(0, majorFaults);
+
+    return LE_OK;
+}
@@ -0,0 +1,96 @@
+//--------------------------------------------------------------------------------------------------
+/** @file supervisor/resourceUsage.h
+ *
+ * API for sampling the resource usage of applications.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+#ifndef LEGATO_SRC_RESOURCE_USAGE_INCLUDE_GUARD
+#define LEGATO_SRC_RESOURCE_USAGE_INCLUDE_GUARD
+
+#include "app.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Summary of an application's resource usage over a number of samples.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t   numSamples;            ///< Number of samples summarized.
+    uint32_t cpuPermille;           ///< Average cpu use, in tenths of a percent of one cpu.
+    uint32_t peakCpuPermille;       ///< Highest cpu use in a single sample.
+    uint64_t rssBytes;              ///< Resident memory at the latest sample.
+    uint64_t peakRssBytes;          ///< Highest resident memory in the samples.
+    uint32_t pageFaults;            ///< Page faults during the samples.
+    uint32_t majorPageFaults;       ///< Page faults that needed I/O during the samples.
+}
+resUsage_Summary_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes the resource usage sampler.
+ */
+//--------------------------------------------------------------------------------------------------
+void resUsage_Init
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Registers a client as interested in resource usage.  Sampling runs from the first client's
+ * registration until the last registered client disconnects.
+ */
+//--------------------------------------------------------------------------------------------------
+void resUsage_AddConsumer
+(
+    le_msg_SessionRef_t sessionRef  ///< [IN] Session reference of the client.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts sampling the resource usage of an application.  Samples are only taken while the
+ * application is running.  The application's cgroups must have been created.
+ */
+//--------------------------------------------------------------------------------------------------
+void resUsage_AddApp
+(
+    app_Ref_t appRef                ///< [IN] The application to sample.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stops sampling the resource usage of an application and discards its samples.
+ */
+//--------------------------------------------------------------------------------------------------
+void resUsage_RemoveApp
+(
+    app_Ref_t appRef                ///< [IN] The application.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Summarizes the most recent resource usage samples of an application.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_NOT_FOUND if there are no samples for the application, or it is not running.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t resUsage_GetSummary
+(
+    const char* appNamePtr,         ///< [IN] Name of the application.
+    size_t numSamples,              ///< [IN] Number of most recent samples to summarize.  0 means
+                                    ///       all the samples that are kept.
+    resUsage_Summary_t* summaryPtr  ///< [OUT] Summary of the samples.
+);
+
+
+#endif  // LEGATO_SRC_RESOURCE_USAGE_INCLUDE_GUARD
@@ -5,7 +5,13 @@
  * Implementation of the Update Pack parser.  This file parses an update pack, and drives the
  * rest of the update based on the contents of the update pack.
  *
- * This is single-threaded, event-driven code that shares the main thread's event loop.
+ * This is event-driven code that shares the main thread's event loop.  Payload bytes are read
+ * by the main thread and fed to an unpack pipeline in which decompression and extraction run as
+ * separate processes.  If the section header carries a "crc32" member, the same payload buffers
+ * are also handed to a hashing thread, so that integrity checking overlaps with reading,
+ * decompression and extraction instead of being done afterwards.  The main thread never waits for
+ * the hash thread: it stops reading the input while all the buffers are being hashed, and only
+ * goes on with the update once the payload CRC32 has been checked.
  *
  * Copyright (C) Sierra Wireless Inc.
  */
@@ -24,6 +30,12 @@
 /// An MD5 hash string is 32 characters long, plus a null terminator.
 #define MD5_STRING_BYTES 33
 
+/// Size of the blocks the payload is read (and hashed) in.
+#define PAYLOAD_BLOCK_BYTES 16384
+
+/// Number of payload blocks that can be in flight between the main thread and the hash thread.
+#define PAYLOAD_BLOCK_COUNT 4
+
 /// File descriptor to read the update pack from.
 static int InputFd = -1;
 
@@ -60,6 +72,61 @@ static size_t PayloadBytesCopied;
 /// Percentage complete on current task.
 static unsigned int PercentDone;
 
+/// The payload CRC32 obtained from a JSON header (only valid if ExpectedCrcValid is true).
+static uint32_t ExpectedCrc;
+
+/// true if the JSON header contained a "crc32" member.
+static bool ExpectedCrcValid;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Payload block.  Filled by the main thread and hashed by the hash thread.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t  len;                            ///< Number of valid bytes in data.
+    uint8_t data[PAYLOAD_BLOCK_BYTES];      ///< Payload bytes.
+}
+PayloadBlock_t;
+
+/// Ring of payload blocks shared by the main thread and the hash thread.
+static PayloadBlock_t PayloadBlocks[PAYLOAD_BLOCK_COUNT];
+
+/// Index of the next block to be filled by the main thread.
+static size_t NextBlockIndex = 0;
+
+/// Number of blocks handed over to the hash thread and not given back yet.
+static size_t BlocksInFlight = 0;
+
+/// true if reading the input is paused until the hash thread gives a block back.
+static bool InputPaused = false;
+
+/// true if the payload currently being unpacked is being hashed.
+static bool HashingPayload = false;
+
+/// Incremented when a hashed payload is abandoned, so that its CRC32 is ignored.
+static size_t HashGeneration = 0;
+
+/// true if the unpack pipeline finished before the payload CRC32 was checked.
+static bool UntarFinished = false;
+
+/// Exit status of the unpack pipeline (only valid if UntarFinished is true).
+static int UntarStatus;
+
+/// CRC32 being computed.  Only used by the hash thread.
+static uint32_t HashCrc;
+
+/// The main thread, which runs the unpack.
+static le_thread_Ref_t MainThread = NULL;
+
+/// The hash thread (NULL until the first update is started).
+static le_thread_Ref_t HashThread = NULL;
+
+/// Path to a stand-alone bzip2 decompressor (NULL if tar must decompress by itself).
+static const char* DecompressorPath = NULL;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -161,6 +228,16 @@ static void Reset
 
     DeleteFdMonitor();
 
+    // Ignore the CRC32 of the abandoned payload.  The blocks still being hashed are given back
+    // by the hash thread later.
+    if (HashingPayload)
+    {
+        HashingPayload = false;
+        HashGeneration++;
+    }
+    InputPaused = false;
+    UntarFinished = false;
+
     // Close the pipes.
     if (InputFd != -1)
     {
@@ -350,6 +427,7 @@ static void StartParsing
     AppName[0] = '\0';
     Md5[0] = '\0';
     PayloadSize = 0;
+    ExpectedCrcValid = false;
 
     // Set the state
     State = STATE_PARSING_JSON;
@@ -361,19 +439,16 @@ static void StartParsing
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Completion callback for "tar xj" operation.
+ * Go on with the update once a payload has been unpacked and, if it is hashed, its CRC32 has been
+ * checked.
  */
 //--------------------------------------------------------------------------------------------------
-static void UntarDone
+static void PayloadUnpacked
 (
-    pipeline_Ref_t pipeline,
-    int status
+    int status  ///< Exit status of the unpack pipeline.
 )
 //--------------------------------------------------------------------------------------------------
 {
-    pipeline_Delete(Pipeline);
-    Pipeline = NULL;
-
     if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS))
     {
         if (WIFEXITED(status))
@@ -427,6 +502,33 @@ static void UntarDone
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Completion callback for "tar xj" operation.
+ */
+//--------------------------------------------------------------------------------------------------
+static void UntarDone
+(
+    pipeline_Ref_t pipeline,
+    int status
+)
+//--------------------------------------------------------------------------------------------------
+{
+    pipeline_Delete(Pipeline);
+    Pipeline = NULL;
+
+    // Don't use the extracted files until the payload CRC32 has been checked.
+    if (HashingPayload)
+    {
+        UntarFinished = true;
+        UntarStatus = status;
+        return;
+    }
+
+    PayloadUnpacked(status);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Completion callback for skip forward operation that is done instead of an app unpack + install
@@ -461,6 +563,195 @@ static void SkipForwardDone
 }
 
 
+static void InputFdEventHandler(int fd, short events);
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Main function of the hash thread.  The payload blocks are handed over to it through its event
+ * queue.
+ */
+//--------------------------------------------------------------------------------------------------
+static void* HashThreadMain
+(
+    void* contextPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    le_event_RunLoop();
+
+    return NULL; // Should not happen
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called in the main thread when the hash thread gives a block back.  Resumes reading the input
+ * if it was waiting for a free block.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BlockHashed
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    LE_ASSERT(BlocksInFlight > 0);
+    BlocksInFlight--;
+
+    if (InputPaused)
+    {
+        InputPaused = false;
+        InputFdMonitor = le_fdMonitor_Create("unpack", InputFd, InputFdEventHandler, POLLIN);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Called in the main thread with the CRC32 of a payload.  Checks it, and goes on with the update
+ * if the unpack pipeline has already finished.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PayloadHashed
+(
+    void* crcPtr,           ///< CRC32 of the payload.
+    void* generationPtr     ///< HashGeneration when the payload was hashed.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    uint32_t crc = (uint32_t)(uintptr_t)crcPtr;
+
+    // Ignore the CRC32 of a payload abandoned in the meantime.
+    if (!HashingPayload || ((size_t)(uintptr_t)generationPtr != HashGeneration))
+    {
+        return;
+    }
+
+    HashingPayload = false;
+
+    if (crc != ExpectedCrc)
+    {
+        LE_ERROR("Malformed update pack (payload CRC32 is 0x%08" PRIx32
+                 ", expected 0x%08" PRIx32 ").",
+                 crc,
+                 ExpectedCrc);
+        HandleFormatError();
+        return;
+    }
+
+    LE_DEBUG("Payload CRC32 verified: 0x%08" PRIx32, crc);
+
+    if (UntarFinished)
+    {
+        UntarFinished = false;
+        PayloadUnpacked(UntarStatus);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start computing the CRC32 of a payload.  Runs in the hash thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartHash
+(
+    void* param1Ptr,
+    void* param2Ptr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    HashCrc = LE_CRC_START_CRC32;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a payload block to the CRC32 and give the block back to the main thread.  Runs in the hash
+ * thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void HashBlock
+(
+    void* blockPtr,
+    void* param2Ptr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    PayloadBlock_t* payloadBlockPtr = blockPtr;
+
+    HashCrc = le_crc_Crc32(payloadBlockPtr->data, payloadBlockPtr->len, HashCrc);
+
+    le_event_QueueFunctionToThread(MainThread, BlockHashed, NULL, NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finalize the CRC32 of a payload and send it to the main thread.  Runs in the hash thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FinishHash
+(
+    void* generationPtr,
+    void* param2Ptr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Same convention as zlib's crc32().
+    uint32_t crc = HashCrc ^ 0xFFFFFFFFU;
+
+    le_event_QueueFunctionToThread(MainThread,
+                                   PayloadHashed,
+                                   (void*)(uintptr_t)crc,
+                                   generationPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a payload block to read into.
+ *
+ * @return Pointer to the block, or NULL if all the blocks are being hashed.
+ */
+//--------------------------------------------------------------------------------------------------
+static PayloadBlock_t* GetFreeBlock
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Blocks of an abandoned payload may still be in flight, even if this one isn't hashed.
+    if (BlocksInFlight == PAYLOAD_BLOCK_COUNT)
+    {
+        return NULL;
+    }
+
+    return &PayloadBlocks[NextBlockIndex];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Hand a block obtained from GetFreeBlock() over to the hash thread.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SubmitBlock
+(
+    PayloadBlock_t* blockPtr,   ///< The block.
+    size_t len                  ///< Number of bytes in the block.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    blockPtr->len = len;
+    NextBlockIndex = (NextBlockIndex + 1) % PAYLOAD_BLOCK_COUNT;
+    BlocksInFlight++;
+
+    le_event_QueueFunctionToThread(HashThread, HashBlock, blockPtr, NULL);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Copy bytes from the input fd to the pipeline's input fd until the input fd's read buffer is
@@ -473,16 +764,26 @@ static void CopyBytesToPipeline
 )
 //--------------------------------------------------------------------------------------------------
 {
-    char buffer[1024];
-
     // Keep copying as much as we can until we've copied all the payload.
     while (PayloadBytesCopied < PayloadSize)
     {
+        // Get a block to read into.  If the payload is being hashed, the same block is handed
+        // over to the hash thread once it has been written to the pipeline.
+        PayloadBlock_t* blockPtr = GetFreeBlock();
+        if (blockPtr == NULL)
+        {
+            // Stop reading until the hash thread gives a block back (see BlockHashed()).
+            DeleteFdMonitor();
+            InputPaused = true;
+            break;
+        }
+        uint8_t* buffer = blockPtr->data;
+
         // Compute the number of bytes to read.
         size_t bytesToRead = PayloadSize - PayloadBytesCopied;
-        if (bytesToRead > sizeof(buffer))
+        if (bytesToRead > PAYLOAD_BLOCK_BYTES)
         {
-            bytesToRead = sizeof(buffer);
+            bytesToRead = PAYLOAD_BLOCK_BYTES;
         }
 
         // Read the bytes, retrying if interrupted by a signal.
@@ -542,6 +843,12 @@ static void CopyBytesToPipeline
             goto error;
         }
 
+        // Hash the block while the next one is being read.
+        if (HashingPayload)
+        {
+            SubmitBlock(blockPtr, readResult);
+        }
+
         // Update the static progress variables and report progress to the client.
         PayloadBytesCopied += readResult;
         PercentDone = (100 * PayloadBytesCopied) / PayloadSize;
@@ -556,6 +863,17 @@ static void CopyBytesToPipeline
     if (PayloadBytesCopied == PayloadSize)
     {
         DeleteFdMonitor();
+
+        // Get the payload's CRC32 (see PayloadHashed()).  The pipeline can finish in the meantime,
+        // but the extracted files are only used once the CRC32 has been checked.
+        if (HashingPayload)
+        {
+            le_event_QueueFunctionToThread(HashThread,
+                                           FinishHash,
+                                           (void*)(uintptr_t)HashGeneration,
+                                           NULL);
+        }
+
         fd_Close(PipelineFd);
         PipelineFd = -1;
     }
@@ -579,7 +897,7 @@ static void DiscardPayloadBytes
 )
 //--------------------------------------------------------------------------------------------------
 {
-    char buffer[1024];
+    uint8_t buffer[PAYLOAD_BLOCK_BYTES];
 
     // Keep reading as much as we can until we've read all the payload.
     while (PayloadBytesCopied < PayloadSize)
@@ -668,6 +986,58 @@ static void InputFdEventHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look for a stand-alone bzip2 decompressor.  If one is found, decompression is done in its own
+ * process, in parallel with extraction.
+ *
+ * @return Path to the decompressor, or NULL if not found.
+ **/
+//--------------------------------------------------------------------------------------------------
+static const char* FindDecompressor
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const char* candidates[] = { "/usr/bin/bzip2", "/bin/bzip2", "/usr/bin/bunzip2",
+                                        "/bin/bunzip2" };
+    size_t i;
+
+    for (i = 0; i < NUM_ARRAY_MEMBERS(candidates); i++)
+    {
+        if (access(candidates[i], X_OK) == 0)
+        {
+            return candidates[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function that runs in the unpack pipeline's decompression process.
+ **/
+//--------------------------------------------------------------------------------------------------
+static int Decompress
+(
+    void* param
+)
+//--------------------------------------------------------------------------------------------------
+{
+    const char* decompressorPath = param;
+
+    fd_CloseAllNonStd();
+
+    // Both bzip2 and bunzip2 accept "-dc".
+    execl(decompressorPath, decompressorPath, "-dc", (char*)NULL);
+
+    LE_FATAL("Failed to exec '%s' (%m)", decompressorPath);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Function that runs in the unpack pipeline's "tar" process.
@@ -686,8 +1056,17 @@ static int Untar
     fd_CloseAllNonStd();
 
     // Try bsdtar first.  If that fails, fallback to tar.
-    execl("/usr/bin/bsdtar", "bsdtar", "xjmop", "-f", "-", "-C", unpackDir, (char*)NULL);
-    execl("/bin/tar", "tar", "xjop", "-C", unpackDir, (char*)NULL);
+    // If there is a decompression process ahead of us in the pipeline, the input is a plain tar.
+    if (DecompressorPath != NULL)
+    {
+        execl("/usr/bin/bsdtar", "bsdtar", "xmop", "-f", "-", "-C", unpackDir, (char*)NULL);
+        execl("/bin/tar", "tar", "xop", "-C", unpackDir, (char*)NULL);
+    }
+    else
+    {
+        execl("/usr/bin/bsdtar", "bsdtar", "xjmop", "-f", "-", "-C", unpackDir, (char*)NULL);
+        execl("/bin/tar", "tar", "xjop", "-C", unpackDir, (char*)NULL);
+    }
 
     LE_FATAL("Failed to exec tar (%m)");
 }
@@ -708,12 +1087,24 @@ static void StartUntar
 
     PayloadBytesCopied = 0;
 
-    // Create a pipeline: PipelineFd -> tar
+    // Create a pipeline: PipelineFd -> [bzip2 -dc ->] tar
     Pipeline = pipeline_Create();
     PipelineFd = pipeline_CreateInputPipe(Pipeline);
+    if (DecompressorPath != NULL)
+    {
+        pipeline_Append(Pipeline, Decompress, (void*)DecompressorPath);
+    }
     pipeline_Append(Pipeline, Untar, (void*)dirPath);
     pipeline_Start(Pipeline, UntarDone);
 
+    // Hash the payload alongside the unpack if the header told us what to expect.
+    HashingPayload = ExpectedCrcValid;
+    UntarFinished = false;
+    if (HashingPayload)
+    {
+        le_event_QueueFunctionToThread(HashThread, StartHash, NULL, NULL);
+    }
+
     fd_SetNonBlocking(InputFd);
 
     // Create FD Monitor for the Input FD.
@@ -1108,6 +1499,43 @@ static void SizeEventHandler
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * "crc32" member parsing event function.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Crc32EventHandler
+(
+    le_json_Event_t event
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (event != LE_JSON_NUMBER)
+    {
+        LE_ERROR("Malformed update pack (expected crc32 to be a number; got %s).",
+                 le_json_GetEventName(event));
+        HandleFormatError();
+    }
+    else
+    {
+        double number = le_json_GetNumber();
+
+        ExpectedCrc = (uint32_t)number;
+
+        if (number != (double)ExpectedCrc)
+        {
+            LE_ERROR("Malformed update pack (invalid payload CRC32: %f).", number);
+            HandleFormatError();
+        }
+        else
+        {
+            ExpectedCrcValid = true;
+            LE_DEBUG("CRC32: 0x%08" PRIx32, ExpectedCrc);
+        }
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Event handler function called by the JSON parser when it encounters things during parsing.
@@ -1168,6 +1596,10 @@ static void JsonEventHandler
             {
                 le_json_SetEventHandler(SizeEventHandler);
             }
+            else if (strcmp(memberName, "crc32") == 0)
+            {
+                le_json_SetEventHandler(Crc32EventHandler);
+            }
             else
             {
                 LE_ERROR("Malformed update pack (unexpected object member '%s').", memberName);
@@ -1210,6 +1642,17 @@ void updateUnpack_Start
 {
     LE_ASSERT(State == STATE_IDLE);
 
+    // Start the hash thread and look for a decompressor the first time through.
+    if (HashThread == NULL)
+    {
+        MainThread = le_thread_GetCurrent();
+
+        HashThread = le_thread_Create("UnpackHash", HashThreadMain, NULL);
+        le_thread_Start(HashThread);
+
+        DecompressorPath = FindDecompressor();
+    }
+
     InputFd = fd;
     ProgressFunc = progressFunc;
     PercentDone = 0;
@@ -70,6 +70,18 @@
  *
  *
  *
+ * Kicks don't restart the watchdog's timer.  Instead, the time of the last kick is recorded and
+ * the timer is left running; when it expires, the handler checks whether the process was kicked
+ * in the meantime and, if so, re-arms the timer for the remainder of the interval counted from
+ * the last kick.  This keeps processes that kick at a high rate from causing constant timer
+ * churn in the daemon.
+ *
+ * Processes can also kick through a heartbeat counter in shared memory (see
+ * le_wdog_GetHeartbeat()), which avoids the IPC round trip as well.  The counter is only
+ * sampled when the timer expires: if it changed since the last sample, the process is considered
+ * alive and the timer is re-armed for a full interval.  A hung process using a heartbeat is
+ * therefore detected between one and two timeouts after its last heartbeat.
+ *
  * Besides le_wdog_Kick(), a command to temporarily change the timeout is provided.
  * le_wdog_Timeout(milliseconds) will adjust the current timeout and restart the timer.
  * This timeout will be effective for one time only reverting to the default value at the next
@@ -107,6 +119,8 @@
 #include "interfaces.h"
 #include "user.h"
 #include "fileDescriptor.h"
+#include "smack.h"
+#include <sys/mman.h>
 
 
 //--------------------------------------------------------------------------------------------------
@@ -188,6 +202,13 @@
 //--------------------------------------------------------------------------------------------------
 #define NO_PROC      -1
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory in which the shared memory backing heartbeat counters is created.
+ */
+//--------------------------------------------------------------------------------------------------
+#define HEARTBEAT_DIR "/tmp"
+
 //--------------------------------------------------------------------------------------------------
 /**
  *  Definition of Watchdog object, pool for allocation of watchdogs and container for organizing and
@@ -205,6 +226,12 @@ typedef struct
                                         ///< beyond it's maximum period by being treated as a
                                         ///< non-mandatory watchdog.
     le_timer_Ref_t timer;               ///< The timer this watchdog uses
+    bool kickIntervalRunning;           ///< true if the timer was started with the kick interval,
+                                        ///< in which case kicks can be recorded lazily.
+    le_clk_Time_t startTime;            ///< Relative time at which the timer was (re)started
+    le_clk_Time_t lastKickTime;         ///< Relative time of the last lazily recorded kick
+    volatile uint32_t* heartbeatPtr;    ///< Shared heartbeat counter (NULL if none)
+    uint32_t lastHeartbeat;             ///< Value of the heartbeat counter at the last sample
 }
 WatchdogObj_t;
 
@@ -270,6 +297,102 @@ static le_hashmap_Ref_t MandatoryWatchdogRefs;  ///< The container used to track
 
 static le_mem_PoolRef_t ExternalWatchdogPool;   ///< The memory pool external for watchdog handlers
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release the heartbeat counter of a watchdog, if it has one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void DetachHeartbeat
+(
+    WatchdogObj_t* dogPtr
+)
+{
+    if (dogPtr->heartbeatPtr != NULL)
+    {
+        LE_CRIT_IF(munmap((void*)dogPtr->heartbeatPtr, sizeof(uint32_t)) != 0,
+                   "Failed to unmap heartbeat of proc %d (%m)", dogPtr->procId);
+        dogPtr->heartbeatPtr = NULL;
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start (or restart) a watchdog's timer.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartWatchdogTimer
+(
+    WatchdogObj_t* dogPtr,
+    le_clk_Time_t interval,     ///< Time until expiry.
+    bool isKickInterval         ///< true if this is the watchdog's regular kick interval.
+)
+{
+    // timer should be stopped here so this should never fail
+    LE_ASSERT(LE_OK == le_timer_SetInterval(dogPtr->timer, interval));
+    le_timer_Start(dogPtr->timer);
+
+    dogPtr->kickIntervalRunning = isKickInterval;
+    dogPtr->startTime = le_clk_GetRelativeTime();
+    dogPtr->lastKickTime = dogPtr->startTime;
+    if (dogPtr->heartbeatPtr != NULL)
+    {
+        dogPtr->lastHeartbeat = *(dogPtr->heartbeatPtr);
+    }
+}
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Check whether a watchdog whose timer just expired was kicked while the timer was running
+ * (either lazily through le_wdog_Kick() or through its heartbeat counter).  If so, the timer is
+ * re-armed.
+ *
+ * The heartbeat counts as a kick whatever interval the timer was started with, including one set
+ * by le_wdog_Timeout().  Lazy kicks only apply to the regular kick interval, as le_wdog_Timeout()
+ * restarts the timer itself.
+ *
+ * @return true if the watchdog was re-armed, false if it has really expired.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool RearmIfKicked
+(
+    WatchdogObj_t* dogPtr
+)
+{
+    if ((dogPtr->heartbeatPtr != NULL) && (*(dogPtr->heartbeatPtr) != dogPtr->lastHeartbeat))
+    {
+        // Kicked through the heartbeat at some point since the last sample.
+        StartWatchdogTimer(dogPtr, dogPtr->kickTimeoutInterval, true);
+        return true;
+    }
+
+    if (!dogPtr->kickIntervalRunning)
+    {
+        return false;
+    }
+
+    le_clk_Time_t now = le_clk_GetRelativeTime();
+
+    if (le_clk_GreaterThan(dogPtr->lastKickTime, dogPtr->startTime))
+    {
+        // Kicked through IPC.  Expire one kick interval after the last kick.
+        le_clk_Time_t deadline = le_clk_Add(dogPtr->lastKickTime, dogPtr->kickTimeoutInterval);
+
+        if (le_clk_GreaterThan(deadline, now))
+        {
+            le_clk_Time_t lastKickTime = dogPtr->lastKickTime;
+
+            StartWatchdogTimer(dogPtr, le_clk_Sub(deadline, now), true);
+
+            // The remainder is still counted from that kick.
+            dogPtr->startTime = lastKickTime;
+            dogPtr->lastKickTime = lastKickTime;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Remove the watchdog from our container, free the timer it contains and then free the storage
@@ -286,12 +409,15 @@ static void DeleteWatchdog
     {
         // All good. The dog was in the hash
         LE_DEBUG("Cleaning up watchdog resources for %d", deadDogPtr->procId);
+        // The heartbeat belongs to the process, not to the (possibly mandatory) watchdog.
+        DetachHeartbeat(deadDogPtr);
         // Give the watchdog one more kick if it hasn't had one, then release it.
         // This allows mandatory watchdogs (which still exist in the MandatoryWatchdogRefs
         // one more kick to restart before they're considered expired.
         if (deadDogPtr->procId >= 0)
         {
             deadDogPtr->procId = NO_PROC;
+            deadDogPtr->kickIntervalRunning = false;
             le_timer_SetContextPtr(deadDogPtr->timer, (void*)((intptr_t)NO_PROC));
             le_timer_Start(deadDogPtr->timer);
         }
@@ -387,6 +513,11 @@ static void WatchdogHandleExpiry
     {
         uid_t appId = expiredDog->appId;
 
+        if (RearmIfKicked(expiredDog))
+        {
+            return;
+        }
+
 
         if (LE_OK == le_appInfo_GetName(procId, appName, sizeof(appName) ))
         {
@@ -711,6 +842,9 @@ static void InitNewWatchdog
     newDogPtr->appId = appId;
     newDogPtr->kickTimeoutInterval = kickTimeoutInterval;
     newDogPtr->maxKickTimeoutInterval = maxKickTimeoutInterval;
+    newDogPtr->kickIntervalRunning = false;
+    newDogPtr->heartbeatPtr = NULL;
+    newDogPtr->lastHeartbeat = 0;
     if (le_clk_GreaterThan(newDogPtr->kickTimeoutInterval, newDogPtr->maxKickTimeoutInterval))
     {
         newDogPtr->kickTimeoutInterval = newDogPtr->maxKickTimeoutInterval;
@@ -767,6 +901,7 @@ static WatchdogObj_t* CreateNewWatchdog
         // Stop the timer -- mandatory timers are always running, even if process
         // doesn't exist.
         le_timer_Stop(newDogPtr->timer);
+        newDogPtr->kickIntervalRunning = false;
         // Then update the proc ID to point to this new process.
         LE_ASSERT(LE_OK == le_timer_SetContextPtr(newDogPtr->timer,
                                                   (void*)((intptr_t)clientPid)));
@@ -798,6 +933,8 @@ static void CleanupWdog
 {
     WatchdogObj_t* deadDogPtr = objectPtr;
 
+    DetachHeartbeat(deadDogPtr);
+
     // If this watchdog has a timer, delete it.
     if (deadDogPtr->timer)
     {
@@ -836,10 +973,9 @@ static void CreateMandatoryWatchdog
              newDogPtr->key.appId, newDogPtr->key.procName);
     LE_ASSERT(NULL == le_hashmap_Put(MandatoryWatchdogRefs, &(newDogPtr->key), newDogPtr));
 
-    // Immediately start this watchdog.
-    LE_ASSERT(LE_OK == le_timer_SetInterval(newDogPtr->watchdog.timer,
-                                            newDogPtr->watchdog.kickTimeoutInterval));
-    le_timer_Start(newDogPtr->watchdog.timer);
+    // Immediately start this watchdog.  There's no process to kick it yet, so this is not
+    // treated as a kick interval.
+    StartWatchdogTimer(&(newDogPtr->watchdog), newDogPtr->watchdog.kickTimeoutInterval, false);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -922,7 +1058,18 @@ static void ResetClientWatchdog
     WatchdogObj_t* watchDogPtr = GetClientWatchdogPtr();
     if (watchDogPtr != NULL)
     {
+        // A plain kick while the timer is already running with the kick interval is just
+        // recorded; the expiry handler takes care of pushing the deadline out.
+        if ((timeout == TIMEOUT_KICK)
+            && watchDogPtr->kickIntervalRunning
+            && le_timer_IsRunning(watchDogPtr->timer))
+        {
+            watchDogPtr->lastKickTime = le_clk_GetRelativeTime();
+            return;
+        }
+
         le_timer_Stop(watchDogPtr->timer);
+        watchDogPtr->kickIntervalRunning = false;
         if (timeout == TIMEOUT_KICK)
         {
             timeoutValue = watchDogPtr->kickTimeoutInterval;
@@ -946,10 +1093,7 @@ static void ResetClientWatchdog
 
         if (!le_clk_Equal(timeoutValue, MakeTimerInterval(LE_WDOG_TIMEOUT_NEVER)))
         {
-            // timer should be stopped here so this should never fail
-            // testing
-            LE_ASSERT(LE_OK == le_timer_SetInterval(watchDogPtr->timer, timeoutValue));
-            le_timer_Start(watchDogPtr->timer);
+            StartWatchdogTimer(watchDogPtr, timeoutValue, (timeout == TIMEOUT_KICK));
         }
         else
         {
@@ -992,6 +1136,77 @@ void le_wdog_Kick
     ResetClientWatchdog(TIMEOUT_KICK);
 }
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get a heartbeat counter that can be used to kick the watchdog without IPC.
+ *
+ * @return
+ *      - LE_OK if the heartbeat was created.
+ *      - LE_FAULT if the shared memory could not be created.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t le_wdog_GetHeartbeat
+(
+    int* heartbeatFdPtr ///< [OUT] Shared memory holding the heartbeat counter.
+)
+{
+    char path[] = HEARTBEAT_DIR "/wdogHeartbeatXXXXXX";
+    WatchdogObj_t* watchDogPtr = GetClientWatchdogPtr();
+
+    *heartbeatFdPtr = -1;
+
+    if (watchDogPtr == NULL)
+    {
+        return LE_FAULT;
+    }
+
+    // The backing file is unlinked right away; the mappings keep it alive.
+    int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        LE_ERROR("Failed to create heartbeat for proc %d (%m)", watchDogPtr->procId);
+        return LE_FAULT;
+    }
+
+    // Give the shared memory the client's label so that a sandboxed client can map it.
+    if (smack_IsEnabled())
+    {
+        char label[LIMIT_MAX_SMACK_LABEL_BYTES];
+
+        if (   (smack_GetProcLabel(watchDogPtr->procId, label, sizeof(label)) != LE_OK)
+            || (smack_SetLabel(path, label) != LE_OK))
+        {
+            LE_WARN("Could not label heartbeat for proc %d", watchDogPtr->procId);
+        }
+    }
+    unlink(path);
+
+    void* memPtr = MAP_FAILED;
+    if (ftruncate(fd, sizeof(uint32_t)) == 0)
+    {
+        memPtr = mmap(NULL, sizeof(uint32_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (memPtr == MAP_FAILED)
+    {
+        LE_ERROR("Failed to map heartbeat for proc %d (%m)", watchDogPtr->procId);
+        fd_Close(fd);
+        return LE_FAULT;
+    }
+
+    // Replace any previous heartbeat; the client gets a fresh counter.
+    DetachHeartbeat(watchDogPtr);
+    watchDogPtr->heartbeatPtr = memPtr;
+    watchDogPtr->lastHeartbeat = 0;
+
+    // Getting a heartbeat counts as a kick.
+    ResetClientWatchdog(TIMEOUT_KICK);
+
+    // The IPC layer closes the fd once it has been sent.
+    *heartbeatFdPtr = fd;
+
+    return LE_OK;
+}
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Register a function to be called to kick an external watchdog.
@@ -22,7 +22,16 @@
  * event-driven manner: As JSON data is received, asynchronous call-back functions are called
  * to deliver parsed information or an error message.
  *
+ * le_json_ParseBuffer() does the same for a JSON document that is already in memory, such as a
+ * buffer received from somewhere else or a file mapped using mmap().  The buffer must stay valid
+ * until parsing stops.
+ *
  * Parsing stops automatically when the end of the document is reached or an error is encountered.
+ * When parsing a file descriptor, the parser never consumes anything past the end of the document,
+ * so the rest of the stream can still be read from the file descriptor afterwards.  Regular files
+ * and stream sockets are read a block at a time; for other kinds of file descriptors (e.g., pipes)
+ * this requires reading one byte at a time, so prefer files, sockets, or le_json_ParseBuffer()
+ * for large documents.
  *
  * le_json_Cleanup() must be called to release memory resources allocated by the parser.
  *
@@ -199,8 +208,9 @@ typedef void (* le_json_ErrorHandler_t)
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Parsing session reference.  Refers to a parsing session started by le_json_Parse().  Pass this
- * to le_json_Cleanup() to stop the parsing and clean up memory allocated by the parser.
+ * Parsing session reference.  Refers to a parsing session started by le_json_Parse() or
+ * le_json_ParseBuffer().  Pass this to le_json_Cleanup() to stop the parsing and clean up memory
+ * allocated by the parser.
  */
 //--------------------------------------------------------------------------------------------------
 typedef struct le_json_ParsingSession* le_json_ParsingSessionRef_t;
@@ -222,6 +232,28 @@ le_json_ParsingSessionRef_t le_json_Parse
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a JSON document held in memory.  No system calls are made to read the document.
+ *
+ * As with le_json_Parse(), this returns immediately and the handlers are called later, from the
+ * calling thread's event loop.
+ *
+ * @warning The buffer must not be changed or freed until parsing has stopped.
+ *
+ * @return Reference to the JSON parsing session started by this function call.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_ParsingSessionRef_t le_json_ParseBuffer
+(
+    const void* bufferPtr,  ///< The JSON document.
+    size_t bufferSize,      ///< Number of bytes in the buffer.
+    le_json_EventHandler_t  eventHandler,   ///< Function to call when normal parsing events happen.
+    le_json_ErrorHandler_t  errorHandler,   ///< Function to call when errors happen.
+    void* opaquePtr   ///< Opaque pointer to be fetched by handlers using le_json_GetOpaquePtr().
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Stops parsing and cleans up memory allocated by the parser.
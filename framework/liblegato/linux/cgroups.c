@@ -12,6 +12,8 @@
 #include "fileDescriptor.h"
 #include "fileSystem.h"
 #include "killProc.h"
+#include <sys/vfs.h>
+#include <sys/inotify.h>
 
 
 //--------------------------------------------------------------------------------------------------
@@ -71,6 +73,111 @@ static const char* SubSysName[CGRP_NUM_SUBSYSTEMS] = {"cpu,cpuacct", "memory", "
 #define FREEZE_STATE_FILENAME       "freezer.state"
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release notification file.  Only exists in the legacy (v1) hierarchies.
+ */
+//--------------------------------------------------------------------------------------------------
+#define NOTIFY_ON_RELEASE_FILENAME  "notify_on_release"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Memory usage files.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MEM_USAGE_FILENAME          "memory.memsw.usage_in_bytes"
+#define MEM_MAX_USAGE_FILENAME      "memory.memsw.max_usage_in_bytes"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Usage counter files.  The cpu accounting file holds the total cpu time used by the cgroup in
+ * nanoseconds; the memory statistics file holds "key value" lines.
+ */
+//--------------------------------------------------------------------------------------------------
+#define CPU_USAGE_FILENAME          "cpuacct.usage"
+#define MEM_STAT_FILENAME           "memory.stat"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Equivalent files in the cgroup v2 unified hierarchy.  In v2 the freezer is part of the core
+ * cgroup interface: it is controlled through cgroup.freeze and its state is reported in
+ * cgroup.events.
+ */
+//--------------------------------------------------------------------------------------------------
+#define V2_THREADS_FILENAME         "cgroup.threads"
+#define V2_CPU_WEIGHT_FILENAME      "cpu.weight"
+#define V2_MEM_LIMIT_FILENAME       "memory.max"
+#define V2_FREEZE_FILENAME          "cgroup.freeze"
+#define V2_EVENTS_FILENAME          "cgroup.events"
+#define V2_MEM_USAGE_FILENAME       "memory.current"
+#define V2_MEM_MAX_USAGE_FILENAME   "memory.peak"
+#define V2_SUBTREE_CONTROL_FILENAME "cgroup.subtree_control"
+#define V2_CPU_STAT_FILENAME        "cpu.stat"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File system magic number of a cgroup v2 mount (from linux/magic.h, which older toolchains lack).
+ */
+//--------------------------------------------------------------------------------------------------
+#ifndef CGROUP2_SUPER_MAGIC
+#define CGROUP2_SUPER_MAGIC         0x63677270
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Default cpu share of a cgroup, and the default cgroup v2 cpu weight it corresponds to.
+ */
+//--------------------------------------------------------------------------------------------------
+#define DEFAULT_CPU_SHARE           1024
+#define DEFAULT_CPU_WEIGHT          100
+#define MAX_CPU_WEIGHT              10000
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cgroup files that are named differently in the legacy and unified hierarchies.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    FILE_TASKS = 0,
+    FILE_CPU_SHARE,
+    FILE_MEM_LIMIT,
+    FILE_FREEZE,
+    FILE_FREEZE_STATE,
+    FILE_MEM_USAGE,
+    FILE_MEM_MAX_USAGE,
+    FILE_CPU_USAGE,
+    NUM_FILES
+}
+CgrpFile_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * File names indexed by [unified][file].
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* FileNames[2][NUM_FILES] =
+{
+    {
+        TASKS_FILENAME, CPU_SHARES_FILENAME, MEM_LIMIT_FILENAME, FREEZE_STATE_FILENAME,
+        FREEZE_STATE_FILENAME, MEM_USAGE_FILENAME, MEM_MAX_USAGE_FILENAME, CPU_USAGE_FILENAME
+    },
+    {
+        V2_THREADS_FILENAME, V2_CPU_WEIGHT_FILENAME, V2_MEM_LIMIT_FILENAME, V2_FREEZE_FILENAME,
+        V2_EVENTS_FILENAME, V2_MEM_USAGE_FILENAME, V2_MEM_MAX_USAGE_FILENAME, V2_CPU_STAT_FILENAME
+    }
+};
+
+#define FILE_NAME(file)             FileNames[cgrp_IsUnified() ? 1 : 0][file]
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Maximum digits in a cgroup integer value.
@@ -84,107 +191,172 @@ static const char* SubSysName[CGRP_NUM_SUBSYSTEMS] = {"cpu,cpuacct", "memory", "
  * Maximum number of bytes in a freezing state string.
  */
 //--------------------------------------------------------------------------------------------------
-#define MAX_FREEZE_STATE_BYTES      20
+#define MAX_FREEZE_STATE_BYTES      64
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Checks if all cgroup subsystems are mounted.
+ * Maximum number of bytes of a statistics file that are read.  The counters that are used are
+ * near the start of the files, so a longer file is parsed as far as it was read.
+ */
+//--------------------------------------------------------------------------------------------------
+#define MAX_STAT_BYTES              4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cgroup handle.  Refers to the cgroup with a given name in every sub-system and keeps the cgroup
+ * directories, and the files that are written repeatedly over the group's life, open.
+ *
+ * In the unified hierarchy all sub-systems share one directory, so only index 0 of the fd arrays
+ * is used.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct cgrp_Group
+{
+    char name[LIMIT_MAX_PATH_BYTES];            ///< Name of the cgroup.
+    int dirFd[CGRP_NUM_SUBSYSTEMS];             ///< Cgroup directories, -1 if not open.
+    int procsFd[CGRP_NUM_SUBSYSTEMS];           ///< Procs files (write only), -1 until first use.
+    int freezeFd;                               ///< Freeze control file, -1 until first use.
+    int freezeStateFd;                          ///< Freeze state file, -1 until first use.
+    int cpuUsageFd;                             ///< Cpu usage file, -1 until first use.
+    int memStatFd;                              ///< Memory statistics file, -1 until first use.
+    ssize_t pendingCpuShare;                    ///< Staged cpu share, -1 if none.
+    ssize_t appliedCpuShare;                    ///< Cpu share currently in effect.
+    ssize_t pendingMemLimit;                    ///< Staged memory limit in KB, -1 if none.
+    ssize_t appliedMemLimit;                    ///< Memory limit in effect in KB, -1 if unlimited.
+    int releaseWatch;                           ///< Watch on cgroup.events (unified hierarchy
+                                                ///  only), -1 if release notify is not enabled.
+    bool isPopulated;                           ///< true if processes were seen in the cgroup
+                                                ///  since the last release notification.
+}
+Group_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pool of cgroup handles.  Created on first use.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t GroupPool = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Release notification in the unified hierarchy: inotify instance watching the cgroup.events files,
+ * its fd monitor, the cgroups indexed by watch descriptor, and the handler to call.  Created on
+ * first use.
+ */
+//--------------------------------------------------------------------------------------------------
+static int ReleaseInotifyFd = -1;
+static le_fdMonitor_Ref_t ReleaseFdMonitor = NULL;
+static le_hashmap_Ref_t ReleaseWatchMap = NULL;
+static cgrp_ReleaseHandler_t ReleaseHandler = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Whether /sys/fs/cgroup is a cgroup v2 unified hierarchy: -1 if not yet checked, otherwise 0 or 1.
+ */
+//--------------------------------------------------------------------------------------------------
+static int UnifiedState = -1;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether the cgroups are a cgroup v2 unified hierarchy rather than one legacy (v1)
+ * hierarchy per sub-system.  A unified hierarchy is used only if one is already mounted on the
+ * cgroup root when it is first checked; otherwise the legacy hierarchies are set up by cgrp_Init().
  *
  * @return
- *      true if all subsystems are mounted.
- *      false otherwise.
+ *      true if the unified hierarchy is in use.
  */
 //--------------------------------------------------------------------------------------------------
-static bool IsAllSubSysMounted
+bool cgrp_IsUnified
 (
     void
 )
 {
-    cgrp_SubSys_t subSys = 0;
-
-    for (; subSys < CGRP_NUM_SUBSYSTEMS; subSys++)
+    if (UnifiedState < 0)
     {
-        char dir[LIMIT_MAX_PATH_BYTES] = ROOT_PATH;
+        struct statfs fsInfo;
 
-        LE_ASSERT(le_path_Concat("/", dir, sizeof(dir), SubSysName[subSys], (char*)NULL) == LE_OK);
-
-        if (!fs_IsMounted(SubSysName[subSys], dir))
-        {
-            return false;
-        }
+        UnifiedState = (   (statfs(ROOT_PATH, &fsInfo) == 0)
+                        && (fsInfo.f_type == CGROUP2_SUPER_MAGIC) ) ? 1 : 0;
     }
 
-    return true;
+    return (UnifiedState == 1);
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Setup a separate cgroup hierarchy for each supported subsystem.
+ * Gets the index into the per sub-system arrays of a handle for a sub-system.
  */
 //--------------------------------------------------------------------------------------------------
-static void MountSubSys
+static inline int DirIndex
 (
-    void
+    cgrp_SubSys_t subsystem         ///< [IN] Sub-system.
 )
 {
-    // Setup a separate cgroup hierarchy for each supported subsystem.
-    cgrp_SubSys_t subSys = 0;
-    for (; subSys < CGRP_NUM_SUBSYSTEMS; subSys++)
-    {
-        char dir[LIMIT_MAX_PATH_BYTES] = ROOT_PATH;
-
-        LE_ASSERT(le_path_Concat("/", dir, sizeof(dir), SubSysName[subSys], (char*)NULL) == LE_OK);
+    return cgrp_IsUnified() ? 0 : subsystem;
+}
 
-        LE_ASSERT(le_dir_Make(dir, S_IRWXU) != LE_FAULT);
 
-        LE_FATAL_IF(mount(SubSysName[subSys], dir, "cgroup", 0, SubSysName[subSys]) != 0,
-                    "Could not mount cgroup subsystem '%s'.  %m.", SubSysName[subSys]);
+//--------------------------------------------------------------------------------------------------
+/**
+ * Builds the path to a cgroup, or to a file in a cgroup if fileNamePtr is not NULL.
+ */
+//--------------------------------------------------------------------------------------------------
+static void BuildPath
+(
+    cgrp_SubSys_t subsystem,        ///< [IN] Sub-system of the cgroup.
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    const char* fileNamePtr,        ///< [IN] Name of the file, or NULL for the cgroup itself.
+    char* pathPtr,                  ///< [OUT] Buffer for the path.
+    size_t pathSize                 ///< [IN] Size of the buffer.
+)
+{
+    LE_ASSERT(le_utf8_Copy(pathPtr, ROOT_PATH, pathSize, NULL) == LE_OK);
 
-        LE_INFO("Mounted cgroup hierarchy for subsystem '%s'.", SubSysName[subSys]);
+    if (cgrp_IsUnified())
+    {
+        LE_ASSERT(le_path_Concat("/", pathPtr, pathSize, cgroupNamePtr, fileNamePtr,
+                                 (char*)NULL) == LE_OK);
+    }
+    else
+    {
+        LE_ASSERT(le_path_Concat("/", pathPtr, pathSize, SubSysName[subsystem], cgroupNamePtr,
+                                 fileNamePtr, (char*)NULL) == LE_OK);
     }
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Initializes cgroups for the system.  Sets up a hierarchy for each supported subsystem.
+ * Opens a file relative to a directory file descriptor, retrying if interrupted.
  *
- * @note Should be called once for the entire system, subsequent calls to this function will have no
- *       effect.  Must be called before any of the other functions in this API is called.
- *
- * @note Failures will cause the calling process to exit.
+ * @return
+ *      The file descriptor of the opened file if successful.
+ *      A negative value if there was an error.
  */
 //--------------------------------------------------------------------------------------------------
-void cgrp_Init
+static int OpenAt
 (
-    void
+    int dirFd,                      ///< [IN] Directory fd, or AT_FDCWD for an absolute path.
+    const char* pathPtr,            ///< [IN] Path of the file.
+    int flags                       ///< [IN] Open flags.
 )
 {
-    // Setup the cgroup root directory if it does not already exist.
-    if (!fs_IsMounted(ROOT_NAME, ROOT_PATH))
-    {
-        LE_FATAL_IF(mount(ROOT_NAME, ROOT_PATH, "tmpfs", 0, NULL) !=0,
-                        "Could not mount cgroup root file system. %m.");
+    int fd;
 
-        MountSubSys();
-    }
-    else
+    do
     {
-        // Check whether all cgroup subsystems are mounted.
-        if (!IsAllSubSysMounted())
-        {
-            // Unmount everything in cgroup.
-            LE_FATAL_IF(umount2(ROOT_PATH, MNT_DETACH) != 0,
-                            "Could not unmount cgroup root file system. %m");
-            // Mount cgroup root directory.
-            LE_FATAL_IF(mount(ROOT_NAME, ROOT_PATH, "tmpfs", 0, NULL) != 0,
-                            "Could not mount cgroup root file system.  %m.");
-
-            MountSubSys();
-        }
+        fd = openat(dirFd, pathPtr, flags | O_CLOEXEC);
     }
+    while ((fd < 0) && (errno == EINTR));
+
+    return fd;
 }
 
 
@@ -207,18 +379,11 @@ static int OpenCgrpFile
 )
 {
     // Create the path to the cgroup file.
-    char path[LIMIT_MAX_PATH_BYTES] = ROOT_PATH;
-    LE_ASSERT(le_path_Concat("/", path, sizeof(path), SubSysName[subsystem], cgroupNamePtr,
-                             fileNamePtr, (char*)NULL) == LE_OK);
+    char path[LIMIT_MAX_PATH_BYTES];
+    BuildPath(subsystem, cgroupNamePtr, fileNamePtr, path, sizeof(path));
 
     // Open the cgroup file.
-    int fd;
-
-    do
-    {
-        fd = open(path, accessMode);
-    }
-    while ((fd < 0) && (errno == EINTR));
+    int fd = OpenAt(AT_FDCWD, path, accessMode);
 
     if (fd < 0)
     {
@@ -231,11 +396,7 @@ static int OpenCgrpFile
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Writes a string to a cgroup file.  Overwrites what is currently in the file.
- *
- * @note  Certain file types cannot accept certain types of data, and the write may fail with a
- *        specific errno value.  If the write fails with errno ESRCH this function will return
- *        LE_OUT_OF_RANGE.
+ * Writes a string to an open cgroup file.  Overwrites what is currently in the file.
  *
  * @return
  *      LE_OK if successful.
@@ -243,11 +404,11 @@ static int OpenCgrpFile
  *      LE_FAULT if there was some other error.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t WriteToFile
+static le_result_t WriteToFd
 (
-    cgrp_SubSys_t subsystem,        ///< [IN] Sub-system of the cgroup.
+    int fd,                         ///< [IN] Open cgroup file.
     const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
-    const char* fileNamePtr,        ///< [IN] File to write to.
+    const char* fileNamePtr,        ///< [IN] Name of the file.
     const char* string              ///< [IN] String to write into the file.
 )
 {
@@ -255,16 +416,7 @@ static le_result_t WriteToFile
     size_t len = strlen(string);
     LE_ASSERT(len > 0);
 
-    // Open the file.
-    int fd = OpenCgrpFile(subsystem, cgroupNamePtr, fileNamePtr, O_WRONLY);
-
-    if (fd < 0)
-    {
-        return LE_FAULT;
-    }
-
     // Write the string to the file.
-    le_result_t result = LE_OK;
     ssize_t numBytesWritten = 0;
 
     do
@@ -280,85 +432,47 @@ static le_result_t WriteToFile
 
         if (errno == ESRCH)
         {
-            result = LE_OUT_OF_RANGE;
-        }
-        else
-        {
-            result = LE_FAULT;
+            return LE_OUT_OF_RANGE;
         }
-    }
 
-    fd_Close(fd);
+        return LE_FAULT;
+    }
 
-    return result;
+    return LE_OK;
 }
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Gets a value from a cgroup file.  The value is read as a string and so a NULL-terminator is
- * always appended to the end of the read value in bufPtr.
+ * Writes a string to a cgroup file.  Overwrites what is currently in the file.
+ *
+ * @note  Certain file types cannot accept certain types of data, and the write may fail with a
+ *        specific errno value.  If the write fails with errno ESRCH this function will return
+ *        LE_OUT_OF_RANGE.
  *
  * @return
  *      LE_OK if successful.
- *      LE_OVERFLOW if the provided buffer is too small.
- *      LE_FAULT if there was an error.
+ *      LE_OUT_OF_RANGE if an attempt was made to write a value that the file cannot accept.
+ *      LE_FAULT if there was some other error.
  */
 //--------------------------------------------------------------------------------------------------
-static le_result_t GetValue
+static le_result_t WriteToFile
 (
     cgrp_SubSys_t subsystem,        ///< [IN] Sub-system of the cgroup.
     const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
-    const char* fileNamePtr,        ///< [IN] File name to read from.
-    char* bufPtr,                   ///< [OUT] Buffer to store the value in.
-    size_t bufSize                  ///< [IN] Size of the buffer.
+    const char* fileNamePtr,        ///< [IN] File to write to.
+    const char* string              ///< [IN] String to write into the file.
 )
 {
     // Open the file.
-    int fd = OpenCgrpFile(subsystem, cgroupNamePtr, fileNamePtr, O_RDONLY);
+    int fd = OpenCgrpFile(subsystem, cgroupNamePtr, fileNamePtr, O_WRONLY);
 
     if (fd < 0)
     {
         return LE_FAULT;
     }
 
-    // Read the value from the file.
-    ssize_t numBytesRead;
-
-    do
-    {
-        numBytesRead = read(fd, bufPtr, bufSize);
-    }
-    while ( (numBytesRead == -1) && (errno == EINTR) );
-
-    le_result_t result = LE_FAULT;
-
-    // Check if the read value is valid.
-    if (numBytesRead == -1)
-    {
-        LE_ERROR("Could not read file '%s' in cgroup '%s'.  %m.", fileNamePtr, cgroupNamePtr);
-        result = LE_FAULT;
-    }
-    else if (numBytesRead == bufSize)
-    {
-        // The value in the file is larger than the provided buffer.  Truncate the buffer.
-        bufPtr[bufSize-1] = '\0';
-        result = LE_OVERFLOW;
-    }
-    else if ((numBytesRead >= 0) && (numBytesRead < bufSize))
-    {
-        // Null-terminate the string.
-        bufPtr[numBytesRead] = '\0';
-
-        // Remove trailing newline characters.
-        while ((numBytesRead > 0) && (bufPtr[numBytesRead - 1] == '\n'))
-        {
-            numBytesRead--;
-            bufPtr[numBytesRead] = '\0';
-        }
-
-        result = LE_OK;
-    }
+    le_result_t result = WriteToFd(fd, cgroupNamePtr, fileNamePtr, string);
 
     fd_Close(fd);
 
@@ -368,17 +482,268 @@ static le_result_t GetValue
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Reads a PID from the opened procs or tasks file specified by fd.  Updates the file offset of fd.
+ * Writes a string to a file in a cgroup directory that is held open by a handle.
  *
  * @return
- *      The current PID read from the file if successful.
- *      LE_OUT_OF_RANGE if there is nothing left to read.
+ *      LE_OK if successful.
+ *      LE_OUT_OF_RANGE if an attempt was made to write a value that the file cannot accept.
  *      LE_FAULT if there was some other error.
  */
 //--------------------------------------------------------------------------------------------------
-static pid_t GetTasksId
+static le_result_t WriteAt
 (
-    int fd                      ///< [IN] File descriptor to an opened procs or tasks file.
+    Group_t* groupPtr,              ///< [IN] Cgroup handle.
+    cgrp_SubSys_t subsystem,        ///< [IN] Sub-system of the cgroup.
+    const char* fileNamePtr,        ///< [IN] File to write to.
+    const char* string              ///< [IN] String to write into the file.
+)
+{
+    int fd = OpenAt(groupPtr->dirFd[DirIndex(subsystem)], fileNamePtr, O_WRONLY);
+
+    if (fd < 0)
+    {
+        LE_ERROR("Could not open file '%s' in cgroup '%s'.  %m.", fileNamePtr, groupPtr->name);
+        return LE_FAULT;
+    }
+
+    le_result_t result = WriteToFd(fd, groupPtr->name, fileNamePtr, string);
+
+    fd_Close(fd);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the value of an open cgroup file from its start, so that a file kept open can be read
+ * repeatedly.  The value is read as a string and so a NULL-terminator is always appended to the
+ * end of the read value in bufPtr.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the provided buffer is too small.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadFromFd
+(
+    int fd,                         ///< [IN] Open cgroup file.
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    const char* fileNamePtr,        ///< [IN] File name to read from.
+    char* bufPtr,                   ///< [OUT] Buffer to store the value in.
+    size_t bufSize                  ///< [IN] Size of the buffer.
+)
+{
+    // Read the value from the file.
+    ssize_t numBytesRead;
+
+    do
+    {
+        numBytesRead = pread(fd, bufPtr, bufSize, 0);
+    }
+    while ( (numBytesRead == -1) && (errno == EINTR) );
+
+    // Check if the read value is valid.
+    if (numBytesRead == -1)
+    {
+        LE_ERROR("Could not read file '%s' in cgroup '%s'.  %m.", fileNamePtr, cgroupNamePtr);
+        return LE_FAULT;
+    }
+    else if (numBytesRead == bufSize)
+    {
+        // The value in the file is larger than the provided buffer.  Truncate the buffer.
+        bufPtr[bufSize-1] = '\0';
+        return LE_OVERFLOW;
+    }
+
+    // Null-terminate the string.
+    bufPtr[numBytesRead] = '\0';
+
+    // Remove trailing newline characters.
+    while ((numBytesRead > 0) && (bufPtr[numBytesRead - 1] == '\n'))
+    {
+        numBytesRead--;
+        bufPtr[numBytesRead] = '\0';
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets a value from a cgroup file.  The value is read as a string and so a NULL-terminator is
+ * always appended to the end of the read value in bufPtr.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the provided buffer is too small.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t GetValue
+(
+    cgrp_SubSys_t subsystem,        ///< [IN] Sub-system of the cgroup.
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    const char* fileNamePtr,        ///< [IN] File name to read from.
+    char* bufPtr,                   ///< [OUT] Buffer to store the value in.
+    size_t bufSize                  ///< [IN] Size of the buffer.
+)
+{
+    // Open the file.
+    int fd = OpenCgrpFile(subsystem, cgroupNamePtr, fileNamePtr, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return LE_FAULT;
+    }
+
+    le_result_t result = ReadFromFd(fd, cgroupNamePtr, fileNamePtr, bufPtr, bufSize);
+
+    fd_Close(fd);
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks if all cgroup subsystems are mounted.
+ *
+ * @return
+ *      true if all subsystems are mounted.
+ *      false otherwise.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsAllSubSysMounted
+(
+    void
+)
+{
+    cgrp_SubSys_t subSys = 0;
+
+    for (; subSys < CGRP_NUM_SUBSYSTEMS; subSys++)
+    {
+        char dir[LIMIT_MAX_PATH_BYTES] = ROOT_PATH;
+
+        LE_ASSERT(le_path_Concat("/", dir, sizeof(dir), SubSysName[subSys], (char*)NULL) == LE_OK);
+
+        if (!fs_IsMounted(SubSysName[subSys], dir))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Setup a separate cgroup hierarchy for each supported subsystem.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MountSubSys
+(
+    void
+)
+{
+    // Setup a separate cgroup hierarchy for each supported subsystem.
+    cgrp_SubSys_t subSys = 0;
+    for (; subSys < CGRP_NUM_SUBSYSTEMS; subSys++)
+    {
+        char dir[LIMIT_MAX_PATH_BYTES] = ROOT_PATH;
+
+        LE_ASSERT(le_path_Concat("/", dir, sizeof(dir), SubSysName[subSys], (char*)NULL) == LE_OK);
+
+        LE_ASSERT(le_dir_Make(dir, S_IRWXU) != LE_FAULT);
+
+        LE_FATAL_IF(mount(SubSysName[subSys], dir, "cgroup", 0, SubSysName[subSys]) != 0,
+                    "Could not mount cgroup subsystem '%s'.  %m.", SubSysName[subSys]);
+
+        LE_INFO("Mounted cgroup hierarchy for subsystem '%s'.", SubSysName[subSys]);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Initializes cgroups for the system.  Sets up a hierarchy for each supported subsystem.
+ *
+ * @note Should be called once for the entire system, subsequent calls to this function will have no
+ *       effect.  Must be called before any of the other functions in this API is called.
+ *
+ * @note Failures will cause the calling process to exit.
+ */
+//--------------------------------------------------------------------------------------------------
+void cgrp_Init
+(
+    void
+)
+{
+    if (cgrp_IsUnified())
+    {
+        // The cgroup v2 hierarchy is already mounted.  The freezer is built in, but the cpu and
+        // memory controllers must be enabled for the child cgroups.  Enable them one at a time so
+        // that a controller the kernel does not provide does not prevent enabling the other one.
+        static const char* controllers[] = {"+cpu", "+memory"};
+        size_t i;
+
+        int fd = OpenAt(AT_FDCWD, ROOT_PATH "/" V2_SUBTREE_CONTROL_FILENAME, O_WRONLY);
+        LE_FATAL_IF(fd < 0, "Could not open cgroup subtree control file.  %m.");
+
+        for (i = 0; i < NUM_ARRAY_MEMBERS(controllers); i++)
+        {
+            LE_ERROR_IF(WriteToFd(fd, "/", V2_SUBTREE_CONTROL_FILENAME, controllers[i]) != LE_OK,
+                        "Could not enable cgroup controller '%s'.", controllers[i] + 1);
+        }
+
+        fd_Close(fd);
+
+        LE_INFO("Using the cgroup v2 unified hierarchy.");
+        return;
+    }
+
+    // Setup the cgroup root directory if it does not already exist.
+    if (!fs_IsMounted(ROOT_NAME, ROOT_PATH))
+    {
+        LE_FATAL_IF(mount(ROOT_NAME, ROOT_PATH, "tmpfs", 0, NULL) !=0,
+                        "Could not mount cgroup root file system. %m.");
+
+        MountSubSys();
+    }
+    else
+    {
+        // Check whether all cgroup subsystems are mounted.
+        if (!IsAllSubSysMounted())
+        {
+            // Unmount everything in cgroup.
+            LE_FATAL_IF(umount2(ROOT_PATH, MNT_DETACH) != 0,
+                            "Could not unmount cgroup root file system. %m");
+            // Mount cgroup root directory.
+            LE_FATAL_IF(mount(ROOT_NAME, ROOT_PATH, "tmpfs", 0, NULL) != 0,
+                            "Could not mount cgroup root file system.  %m.");
+
+            MountSubSys();
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a PID from the opened procs or tasks file specified by fd.  Updates the file offset of fd.
+ *
+ * @return
+ *      The current PID read from the file if successful.
+ *      LE_OUT_OF_RANGE if there is nothing left to read.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+static pid_t GetTasksId
+(
+    int fd                      ///< [IN] File descriptor to an opened procs or tasks file.
 )
 {
     // Read a pid from the file.
@@ -454,9 +819,8 @@ le_result_t cgrp_Create
 )
 {
     // Create the path to the cgroup.
-    char path[LIMIT_MAX_PATH_BYTES] = ROOT_PATH;
-    LE_ASSERT(le_path_Concat("/", path, sizeof(path), SubSysName[subsystem], cgroupNamePtr,
-                             (char*)NULL) == LE_OK);
+    char path[LIMIT_MAX_PATH_BYTES];
+    BuildPath(subsystem, cgroupNamePtr, NULL, path, sizeof(path));
 
     // Create the cgroup.
     le_result_t result = le_dir_Make(path, S_IRWXU);
@@ -568,7 +932,7 @@ ssize_t cgrp_GetThreadList
 )
 {
     // Open the cgroup's tasks file for reading.
-    int fd = OpenCgrpFile(subsystem, cgroupNamePtr, TASKS_FILENAME, O_RDONLY);
+    int fd = OpenCgrpFile(subsystem, cgroupNamePtr, FILE_NAME(FILE_TASKS), O_RDONLY);
 
     if (fd < 0)
     {
@@ -696,7 +1060,7 @@ bool cgrp_IsEmpty
 )
 {
     // Open the cgroup's tasks file for reading.
-    int fd = OpenCgrpFile(subsystem, cgroupNamePtr, TASKS_FILENAME, O_RDONLY);
+    int fd = OpenCgrpFile(subsystem, cgroupNamePtr, FILE_NAME(FILE_TASKS), O_RDONLY);
 
     if (fd < 0)
     {
@@ -744,9 +1108,8 @@ le_result_t cgrp_Delete
 )
 {
     // Create the path to the cgroup.
-    char path[LIMIT_MAX_PATH_BYTES] = ROOT_PATH;
-    LE_ASSERT(le_path_Concat("/", path, sizeof(path), SubSysName[subsystem], cgroupNamePtr,
-                             (char*)NULL) == LE_OK);
+    char path[LIMIT_MAX_PATH_BYTES];
+    BuildPath(subsystem, cgroupNamePtr, NULL, path, sizeof(path));
 
     // Attempt to remove the cgroup directory.
     if (rmdir(path) != 0)
@@ -792,54 +1155,167 @@ const char* cgrp_SubSysName
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Sets the cpu share of a cgroup.
- *
- * Cpu share is used to calculate the cpu percentage for a process relative to all other processes
- * in the system.  Newly created cgroups and processes not belonging to a cgroup are given a default
- * value of 1024.  The actual percentage of the cpu given to a process is calculated as:
- *
- * (share value of process) / (sum of shares from all processes contending for the cpu)
- *
- * All processes within a cgroup share the available cpu share for that cgroup.
- *
- * For example:
- *
- * cgroupA is configured with the default share value, 1024.
- * cgroupB is configured with 512 as its share value.
- * cgroupC is configured with 2048 as its share value.
- *
- * cgroupA has one process running.
- * cgroupB has two processes running.
- * cgroupC has one process running.
- *
- * Assuming that all processes in cgroupA, cgroupB and cgroupC are running and not blocked waiting
- * for some I/O or timer event and that another system process is also running.
- *
- * Sum of all shares (including the one system process) is 1024 + 512 + 2048 + 1024 = 4608
- *
- * The process in cgroupA will get 1024/4608 = 22% of the cpu.
- * The two processes in cgroupB will share 512/4608 = 11% of the cpu, each process getting 5.5%.
- * The process in cgroupC will get 2048/4608 = 44% of the cpu.
- * The system process will get 1024/4608 = 22% of the cpu.
- *
- * @return
- *      LE_OK if successful.
- *      LE_FAULT if there was an error.
+ * Converts a cpu share to the string to write to the cpu share file.  In the unified hierarchy the
+ * share is scaled to a cpu weight so that the default share maps onto the default weight and the
+ * ratios between cgroups are kept.
  */
 //--------------------------------------------------------------------------------------------------
-le_result_t cgrp_cpu_SetShare
+static void FormatCpuShare
 (
-    const char* cgroupNamePtr,      ///< Name of the cgroup to set the share for.
-    size_t share                    ///< Share value to set.  See the function header for more
-                                    ///  details.
+    size_t share,                   ///< [IN] Cpu share.
+    char* bufPtr,                   ///< [OUT] Buffer for the string.
+    size_t bufSize                  ///< [IN] Size of the buffer.
+)
+{
+    size_t value = share;
+
+    if (cgrp_IsUnified())
+    {
+        value = (share * DEFAULT_CPU_WEIGHT) / DEFAULT_CPU_SHARE;
+
+        if (value < 1)
+        {
+            value = 1;
+        }
+        else if (value > MAX_CPU_WEIGHT)
+        {
+            value = MAX_CPU_WEIGHT;
+        }
+    }
+
+    LE_ASSERT(snprintf(bufPtr, bufSize, "%zd", value) < bufSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks the memory limit read back from a cgroup against the one that was written, and warns if
+ * the kernel adjusted it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckMemLimit
+(
+    const char* cgroupNamePtr,      ///< [IN] Name of the cgroup.
+    const char* limitStr,           ///< [IN] Limit that was written.
+    const char* readLimitStr        ///< [IN] Limit that was read back.
+)
+{
+    if (strcmp(limitStr, readLimitStr) != 0)
+    {
+        LE_WARN("The memory limit for %s was actually set to %s instead of %s because of either \
+page rounding or memory availability.", cgroupNamePtr, readLimitStr, limitStr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the string to write to the freeze control file to freeze or thaw a cgroup.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* FreezeValue
+(
+    bool freeze                     ///< [IN] true to freeze, false to thaw.
+)
+{
+    if (cgrp_IsUnified())
+    {
+        return freeze ? "1" : "0";
+    }
+
+    return freeze ? "FROZEN" : "THAWED";
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parses the contents of a cgroup's freeze state file.
+ *
+ * @return
+ *      Freeze state of the cgroup.
+ */
+//--------------------------------------------------------------------------------------------------
+static cgrp_FreezeState_t ParseFreezeState
+(
+    char* stateStr                  ///< [IN] Contents of the freeze state file.
+)
+{
+    if (cgrp_IsUnified())
+    {
+        // cgroup.events holds "key value" lines, one of which is "frozen 0" or "frozen 1".
+        char* frozenPtr = strstr(stateStr, "frozen ");
+
+        LE_FATAL_IF(frozenPtr == NULL, "No freeze state in cgroup events '%s'.", stateStr);
+
+        return (frozenPtr[sizeof("frozen ") - 1] == '1') ? CGRP_FROZEN : CGRP_THAWED;
+    }
+
+    RemoveTrailingWhiteSpace(stateStr);
+
+    if ( (strcmp(stateStr, "THAWED") == 0) ||
+         (strcmp(stateStr, "FREEZING") == 0) )
+    {
+        return CGRP_THAWED;
+    }
+    else if (strcmp(stateStr, "FROZEN") == 0)
+    {
+        return CGRP_FROZEN;
+    }
+
+    LE_FATAL("Unrecognized freeze state '%s'.", stateStr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the cpu share of a cgroup.
+ *
+ * Cpu share is used to calculate the cpu percentage for a process relative to all other processes
+ * in the system.  Newly created cgroups and processes not belonging to a cgroup are given a default
+ * value of 1024.  The actual percentage of the cpu given to a process is calculated as:
+ *
+ * (share value of process) / (sum of shares from all processes contending for the cpu)
+ *
+ * All processes within a cgroup share the available cpu share for that cgroup.
+ *
+ * For example:
+ *
+ * cgroupA is configured with the default share value, 1024.
+ * cgroupB is configured with 512 as its share value.
+ * cgroupC is configured with 2048 as its share value.
+ *
+ * cgroupA has one process running.
+ * cgroupB has two processes running.
+ * cgroupC has one process running.
+ *
+ * Assuming that all processes in cgroupA, cgroupB and cgroupC are running and not blocked waiting
+ * for some I/O or timer event and that another system process is also running.
+ *
+ * Sum of all shares (including the one system process) is 1024 + 512 + 2048 + 1024 = 4608
+ *
+ * The process in cgroupA will get 1024/4608 = 22% of the cpu.
+ * The two processes in cgroupB will share 512/4608 = 11% of the cpu, each process getting 5.5%.
+ * The process in cgroupC will get 2048/4608 = 44% of the cpu.
+ * The system process will get 1024/4608 = 22% of the cpu.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_cpu_SetShare
+(
+    const char* cgroupNamePtr,      ///< Name of the cgroup to set the share for.
+    size_t share                    ///< Share value to set.  See the function header for more
+                                    ///  details.
 )
 {
     // Convert the value to a string.
     char shareStr[MAX_DIGITS];
-    LE_ASSERT(snprintf(shareStr, sizeof(shareStr), "%zd", share) < sizeof(shareStr));
+    FormatCpuShare(share, shareStr, sizeof(shareStr));
 
     // Write the share value to the file.
-    if (WriteToFile(CGRP_SUBSYS_CPU, cgroupNamePtr, CPU_SHARES_FILENAME, shareStr) != LE_OK)
+    if (WriteToFile(CGRP_SUBSYS_CPU, cgroupNamePtr, FILE_NAME(FILE_CPU_SHARE), shareStr) != LE_OK)
     {
         return LE_FAULT;
     }
@@ -871,7 +1347,7 @@ le_result_t cgrp_mem_SetLimit
     LE_ASSERT(snprintf(limitStr, sizeof(limitStr), "%zd", limit * 1024) < sizeof(limitStr));
 
     // Write the limit to the file.
-    if (WriteToFile(CGRP_SUBSYS_MEM, cgroupNamePtr, MEM_LIMIT_FILENAME, limitStr) != LE_OK)
+    if (WriteToFile(CGRP_SUBSYS_MEM, cgroupNamePtr, FILE_NAME(FILE_MEM_LIMIT), limitStr) != LE_OK)
     {
         return LE_FAULT;
     }
@@ -881,18 +1357,14 @@ le_result_t cgrp_mem_SetLimit
 
     if (GetValue(CGRP_SUBSYS_MEM,
                  cgroupNamePtr,
-                 MEM_LIMIT_FILENAME,
+                 FILE_NAME(FILE_MEM_LIMIT),
                  readLimitStr,
                  sizeof(readLimitStr)) != LE_OK)
     {
         return LE_FAULT;
     }
 
-    if (strcmp(limitStr, readLimitStr) != 0)
-    {
-        LE_WARN("The memory limit for %s was actually set to %s instead of %s because of either \
-page rounding or memory availability.", cgroupNamePtr, readLimitStr, limitStr);
-    }
+    CheckMemLimit(cgroupNamePtr, limitStr, readLimitStr);
 
     return LE_OK;
 }
@@ -915,7 +1387,8 @@ le_result_t cgrp_frz_Freeze
     const char* cgroupNamePtr       ///< [IN] Name of the cgroup.
 )
 {
-    if (WriteToFile(CGRP_SUBSYS_FREEZE, cgroupNamePtr, FREEZE_STATE_FILENAME, "FROZEN") != LE_OK)
+    if (WriteToFile(CGRP_SUBSYS_FREEZE, cgroupNamePtr, FILE_NAME(FILE_FREEZE),
+                    FreezeValue(true)) != LE_OK)
     {
         return LE_FAULT;
     }
@@ -941,7 +1414,8 @@ le_result_t cgrp_frz_Thaw
     const char* cgroupNamePtr       ///< [IN] Name of the cgroup.
 )
 {
-    if (WriteToFile(CGRP_SUBSYS_FREEZE, cgroupNamePtr, FREEZE_STATE_FILENAME, "THAWED") != LE_OK)
+    if (WriteToFile(CGRP_SUBSYS_FREEZE, cgroupNamePtr, FILE_NAME(FILE_FREEZE),
+                    FreezeValue(false)) != LE_OK)
     {
         return LE_FAULT;
     }
@@ -968,7 +1442,7 @@ cgrp_FreezeState_t cgrp_frz_GetState
 
     le_result_t result = GetValue(CGRP_SUBSYS_FREEZE,
                                   cgroupNamePtr,
-                                  FREEZE_STATE_FILENAME,
+                                  FILE_NAME(FILE_FREEZE_STATE),
                                   stateStr,
                                   sizeof(stateStr));
 
@@ -979,19 +1453,7 @@ cgrp_FreezeState_t cgrp_frz_GetState
         return LE_FAULT;
     }
 
-    RemoveTrailingWhiteSpace(stateStr);
-
-    if ( (strcmp(stateStr, "THAWED") == 0) ||
-         (strcmp(stateStr, "FREEZING") == 0) )
-    {
-        return CGRP_THAWED;
-    }
-    else if (strcmp(stateStr, "FROZEN") == 0)
-    {
-        return CGRP_FROZEN;
-    }
-
-    LE_FATAL("Unrecognized freeze state '%s'.", stateStr);
+    return ParseFreezeState(stateStr);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1013,7 +1475,7 @@ ssize_t cgrp_GetMemUsed
 
     if (GetValue(CGRP_SUBSYS_MEM,
                  cgroupNamePtr,
-                 "memory.memsw.usage_in_bytes",
+                 FILE_NAME(FILE_MEM_USAGE),
                  buffer,
                  sizeof(buffer)) == LE_OK)
     {
@@ -1046,7 +1508,7 @@ ssize_t cgrp_GetMaxMemUsed
 
     if (GetValue(CGRP_SUBSYS_MEM,
                  cgroupNamePtr,
-                 "memory.memsw.max_usage_in_bytes",
+                 FILE_NAME(FILE_MEM_MAX_USAGE),
                  buffer,
                  sizeof(buffer)) == LE_OK)
     {
@@ -1062,3 +1524,806 @@ ssize_t cgrp_GetMaxMemUsed
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Closes a file descriptor held by a cgroup handle, if it is open.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CloseGroupFd
+(
+    int* fdPtr                      ///< [IN/OUT] File descriptor, set to -1 once closed.
+)
+{
+    if (*fdPtr >= 0)
+    {
+        fd_Close(*fdPtr);
+        *fdPtr = -1;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the number of cgroup directories a handle holds: one per sub-system, or a single one in the
+ * unified hierarchy.
+ */
+//--------------------------------------------------------------------------------------------------
+static inline int NumGroupDirs
+(
+    void
+)
+{
+    return cgrp_IsUnified() ? 1 : CGRP_NUM_SUBSYSTEMS;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates the cgroup with the specified name in every sub-system and returns a handle that keeps
+ * the cgroup directories open.  A cgroup left behind with the same name (for example by a previous
+ * instance that did not clean up) is deleted and re-created so that it starts with default
+ * attributes.
+ *
+ * Attributes set through the handle are staged and only written to the cgroup by cgrp_grp_Apply().
+ *
+ * @return
+ *      Reference to the cgroup handle if successful.
+ *      NULL if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+cgrp_GroupRef_t cgrp_grp_Create
+(
+    const char* cgroupNamePtr       ///< [IN] Name of the cgroup to create.
+)
+{
+    if (GroupPool == NULL)
+    {
+        GroupPool = le_mem_CreatePool("CgroupHandles", sizeof(Group_t));
+    }
+
+    Group_t* groupPtr = le_mem_ForceAlloc(GroupPool);
+    int i;
+
+    for (i = 0; i < CGRP_NUM_SUBSYSTEMS; i++)
+    {
+        groupPtr->dirFd[i] = -1;
+        groupPtr->procsFd[i] = -1;
+    }
+
+    groupPtr->freezeFd = -1;
+    groupPtr->freezeStateFd = -1;
+    groupPtr->cpuUsageFd = -1;
+    groupPtr->memStatFd = -1;
+    groupPtr->pendingCpuShare = -1;
+    groupPtr->appliedCpuShare = DEFAULT_CPU_SHARE;
+    groupPtr->pendingMemLimit = -1;
+    groupPtr->appliedMemLimit = -1;
+    groupPtr->releaseWatch = -1;
+    groupPtr->isPopulated = false;
+
+    if (le_utf8_Copy(groupPtr->name, cgroupNamePtr, sizeof(groupPtr->name), NULL) != LE_OK)
+    {
+        LE_ERROR("Cgroup name '%s' is too long.", cgroupNamePtr);
+        le_mem_Release(groupPtr);
+        return NULL;
+    }
+
+    for (i = 0; i < NumGroupDirs(); i++)
+    {
+        le_result_t result = cgrp_Create(i, cgroupNamePtr);
+
+        if (result == LE_DUPLICATE)
+        {
+            // Stale cgroup.  Remove it and try again.
+            if (cgrp_Delete(i, cgroupNamePtr) == LE_OK)
+            {
+                result = cgrp_Create(i, cgroupNamePtr);
+            }
+        }
+
+        if (result != LE_OK)
+        {
+            goto failed;
+        }
+
+        char path[LIMIT_MAX_PATH_BYTES];
+        BuildPath(i, cgroupNamePtr, NULL, path, sizeof(path));
+
+        groupPtr->dirFd[i] = OpenAt(AT_FDCWD, path, O_RDONLY | O_DIRECTORY);
+
+        if (groupPtr->dirFd[i] < 0)
+        {
+            LE_ERROR("Could not open cgroup '%s'.  %m.", path);
+
+            // The directory exists, so remove it with the others.
+            groupPtr->dirFd[i] = -2;
+            goto failed;
+        }
+    }
+
+    return groupPtr;
+
+failed:
+
+    for (i = 0; (i < NumGroupDirs()) && (groupPtr->dirFd[i] != -1); i++)
+    {
+        if (groupPtr->dirFd[i] >= 0)
+        {
+            fd_Close(groupPtr->dirFd[i]);
+        }
+
+        cgrp_Delete(i, cgroupNamePtr);
+    }
+
+    le_mem_Release(groupPtr);
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the name of the cgroup a handle refers to.
+ *
+ * @return
+ *      Name of the cgroup.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* cgrp_grp_GetName
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+)
+{
+    return groupRef->name;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stages the cpu share of a cgroup.  See cgrp_cpu_SetShare() for the meaning of the share.  The
+ * value is written by the next call to cgrp_grp_Apply().
+ */
+//--------------------------------------------------------------------------------------------------
+void cgrp_grp_SetCpuShare
+(
+    cgrp_GroupRef_t groupRef,       ///< [IN] Cgroup handle.
+    size_t share                    ///< [IN] Share value to set.
+)
+{
+    groupRef->pendingCpuShare = share;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stages the memory limit of a cgroup.  The value is written by the next call to cgrp_grp_Apply().
+ */
+//--------------------------------------------------------------------------------------------------
+void cgrp_grp_SetMemLimit
+(
+    cgrp_GroupRef_t groupRef,       ///< [IN] Cgroup handle.
+    size_t limit                    ///< [IN] Memory limit in kilobytes.
+)
+{
+    groupRef->pendingMemLimit = limit;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes all the staged attributes of a cgroup in one pass.  Attributes that already have the
+ * staged value, including the kernel defaults of a newly created cgroup, are not written again.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if an attribute could not be set.  Attributes that were not set stay staged.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_Apply
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+)
+{
+    char valueStr[MAX_DIGITS];
+
+    if (groupRef->pendingCpuShare >= 0)
+    {
+        if (groupRef->pendingCpuShare != groupRef->appliedCpuShare)
+        {
+            FormatCpuShare(groupRef->pendingCpuShare, valueStr, sizeof(valueStr));
+
+            if (WriteAt(groupRef, CGRP_SUBSYS_CPU, FILE_NAME(FILE_CPU_SHARE), valueStr) != LE_OK)
+            {
+                return LE_FAULT;
+            }
+
+            groupRef->appliedCpuShare = groupRef->pendingCpuShare;
+        }
+
+        groupRef->pendingCpuShare = -1;
+    }
+
+    if (groupRef->pendingMemLimit >= 0)
+    {
+        if (groupRef->pendingMemLimit != groupRef->appliedMemLimit)
+        {
+            const char* fileNamePtr = FILE_NAME(FILE_MEM_LIMIT);
+
+            LE_ASSERT(snprintf(valueStr, sizeof(valueStr), "%zd", groupRef->pendingMemLimit * 1024)
+                      < sizeof(valueStr));
+
+            // Write the limit and read it back through the same file to see if it was set properly.
+            int fd = OpenAt(groupRef->dirFd[DirIndex(CGRP_SUBSYS_MEM)], fileNamePtr, O_RDWR);
+
+            if (fd < 0)
+            {
+                LE_ERROR("Could not open file '%s' in cgroup '%s'.  %m.",
+                         fileNamePtr, groupRef->name);
+                return LE_FAULT;
+            }
+
+            char readLimitStr[MAX_DIGITS] = {0};
+
+            if (   (WriteToFd(fd, groupRef->name, fileNamePtr, valueStr) != LE_OK)
+                || (ReadFromFd(fd, groupRef->name, fileNamePtr,
+                               readLimitStr, sizeof(readLimitStr)) != LE_OK) )
+            {
+                fd_Close(fd);
+                return LE_FAULT;
+            }
+
+            fd_Close(fd);
+
+            CheckMemLimit(groupRef->name, valueStr, readLimitStr);
+
+            groupRef->appliedMemLimit = groupRef->pendingMemLimit;
+        }
+
+        groupRef->pendingMemLimit = -1;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds a process to a cgroup in every sub-system with a single call.  The procs files are kept
+ * open by the handle, so adding a process costs one write per sub-system.
+ *
+ * @note In the unified hierarchy a process belongs to the same cgroup for every sub-system, so it
+ *       cannot be kept out of the cpu sub-system and excludeCpu has no effect.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OUT_OF_RANGE if the process doesn't exist.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_AddProc
+(
+    cgrp_GroupRef_t groupRef,       ///< [IN] Cgroup handle.
+    pid_t pidToAdd,                 ///< [IN] PID of the process to add.
+    bool excludeCpu                 ///< [IN] true to leave the process out of the cpu sub-system.
+)
+{
+    char pidStr[MAX_DIGITS];
+    LE_ASSERT(snprintf(pidStr, sizeof(pidStr), "%d", pidToAdd) < sizeof(pidStr));
+
+    int i;
+    for (i = 0; i < NumGroupDirs(); i++)
+    {
+        if (excludeCpu && !cgrp_IsUnified() && (i == CGRP_SUBSYS_CPU))
+        {
+            continue;
+        }
+
+        if (groupRef->procsFd[i] < 0)
+        {
+            groupRef->procsFd[i] = OpenAt(groupRef->dirFd[i], PROCS_FILENAME, O_WRONLY);
+
+            if (groupRef->procsFd[i] < 0)
+            {
+                LE_ERROR("Could not open file '%s' in cgroup '%s'.  %m.",
+                         PROCS_FILENAME, groupRef->name);
+                return LE_FAULT;
+            }
+        }
+
+        le_result_t result = WriteToFd(groupRef->procsFd[i], groupRef->name, PROCS_FILENAME, pidStr);
+
+        if (result != LE_OK)
+        {
+            return result;
+        }
+    }
+
+    // The process may be gone before its arrival shows in the cgroup's events.
+    groupRef->isPopulated = true;
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Freezes or thaws all the tasks in a cgroup through the handle's cached freeze control file.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t SetGroupFrozen
+(
+    cgrp_GroupRef_t groupRef,       ///< [IN] Cgroup handle.
+    bool freeze                     ///< [IN] true to freeze, false to thaw.
+)
+{
+    const char* fileNamePtr = FILE_NAME(FILE_FREEZE);
+
+    if (groupRef->freezeFd < 0)
+    {
+        groupRef->freezeFd = OpenAt(groupRef->dirFd[DirIndex(CGRP_SUBSYS_FREEZE)],
+                                    fileNamePtr,
+                                    O_WRONLY);
+
+        if (groupRef->freezeFd < 0)
+        {
+            LE_ERROR("Could not open file '%s' in cgroup '%s'.  %m.", fileNamePtr, groupRef->name);
+            return LE_FAULT;
+        }
+    }
+
+    if (WriteToFd(groupRef->freezeFd, groupRef->name, fileNamePtr, FreezeValue(freeze)) != LE_OK)
+    {
+        return LE_FAULT;
+    }
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Freezes all the tasks in a cgroup.  Behaves like cgrp_frz_Freeze() but does not need to look up
+ * the cgroup in the file system.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_Freeze
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+)
+{
+    return SetGroupFrozen(groupRef, true);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thaws all the tasks in a cgroup.  Behaves like cgrp_frz_Thaw() but does not need to look up the
+ * cgroup in the file system.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_Thaw
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+)
+{
+    return SetGroupFrozen(groupRef, false);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the freeze state of a cgroup.  The state file is kept open by the handle so that polling
+ * for a freeze to complete costs one read per poll.
+ *
+ * @return
+ *      Freeze state of the cgroup if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+cgrp_FreezeState_t cgrp_grp_GetFreezeState
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+)
+{
+    const char* fileNamePtr = FILE_NAME(FILE_FREEZE_STATE);
+
+    if (groupRef->freezeStateFd < 0)
+    {
+        groupRef->freezeStateFd = OpenAt(groupRef->dirFd[DirIndex(CGRP_SUBSYS_FREEZE)],
+                                         fileNamePtr,
+                                         O_RDONLY);
+
+        if (groupRef->freezeStateFd < 0)
+        {
+            LE_ERROR("Could not open file '%s' in cgroup '%s'.  %m.", fileNamePtr, groupRef->name);
+            return LE_FAULT;
+        }
+    }
+
+    char stateStr[MAX_FREEZE_STATE_BYTES] = {0};
+
+    le_result_t result = ReadFromFd(groupRef->freezeStateFd,
+                                    groupRef->name,
+                                    fileNamePtr,
+                                    stateStr,
+                                    sizeof(stateStr));
+
+    LE_FATAL_IF(result == LE_OVERFLOW, "Freeze state string '%s...' is too long.", stateStr);
+
+    if (result == LE_FAULT)
+    {
+        return LE_FAULT;
+    }
+
+    return ParseFreezeState(stateStr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a file of a cgroup through a file descriptor cached in the handle, opening it on first use.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OVERFLOW if the file was truncated to fit the buffer.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_result_t ReadCachedFile
+(
+    cgrp_GroupRef_t groupRef,       ///< [IN] Cgroup handle.
+    cgrp_SubSys_t subsystem,        ///< [IN] Sub-system the file belongs to.
+    const char* fileNamePtr,        ///< [IN] Name of the file.
+    int* fdPtr,                     ///< [IN/OUT] Cached file descriptor.
+    char* bufPtr,                   ///< [OUT] Buffer to store the contents in.
+    size_t bufSize                  ///< [IN] Size of the buffer.
+)
+{
+    if (*fdPtr < 0)
+    {
+        *fdPtr = OpenAt(groupRef->dirFd[DirIndex(subsystem)], fileNamePtr, O_RDONLY);
+
+        if (*fdPtr < 0)
+        {
+            LE_ERROR("Could not open file '%s' in cgroup '%s'.  %m.", fileNamePtr, groupRef->name);
+            return LE_FAULT;
+        }
+    }
+
+    return ReadFromFd(*fdPtr, groupRef->name, fileNamePtr, bufPtr, bufSize);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks a cgroup's events after they changed, and calls the release handler if the cgroup has
+ * become empty.  Unified hierarchy only.
+ */
+//--------------------------------------------------------------------------------------------------
+static void CheckRelease
+(
+    Group_t* groupPtr               ///< [IN] Cgroup handle.
+)
+{
+    char eventsStr[MAX_FREEZE_STATE_BYTES] = {0};
+
+    // In the unified hierarchy the freeze state file is cgroup.events.
+    if (ReadCachedFile(groupPtr,
+                       CGRP_SUBSYS_FREEZE,
+                       FILE_NAME(FILE_FREEZE_STATE),
+                       &groupPtr->freezeStateFd,
+                       eventsStr,
+                       sizeof(eventsStr)) != LE_OK)
+    {
+        return;
+    }
+
+    // cgroup.events holds "key value" lines, one of which is "populated 0" or "populated 1".
+    char* populatedPtr = strstr(eventsStr, "populated ");
+
+    if (populatedPtr == NULL)
+    {
+        LE_ERROR("No populated state in events '%s' of cgroup '%s'.", eventsStr, groupPtr->name);
+        return;
+    }
+
+    if (populatedPtr[sizeof("populated ") - 1] == '1')
+    {
+        groupPtr->isPopulated = true;
+    }
+    else if (groupPtr->isPopulated)
+    {
+        groupPtr->isPopulated = false;
+
+        if (ReleaseHandler != NULL)
+        {
+            ReleaseHandler(groupPtr->name);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Fd event handler of the inotify instance watching the cgroup.events files.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReleaseInotifyHandler
+(
+    int fd,                         ///< [IN] Inotify fd.
+    short events                    ///< [IN] Fd events.
+)
+{
+    // Big enough for a batch of events, which have no name as the files themselves are watched.
+    char buf[32 * sizeof(struct inotify_event)]
+        __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+    for (;;)
+    {
+        ssize_t numBytesRead;
+
+        do
+        {
+            numBytesRead = read(fd, buf, sizeof(buf));
+        }
+        while ( (numBytesRead == -1) && (errno == EINTR) );
+
+        if (numBytesRead <= 0)
+        {
+            LE_ERROR_IF((numBytesRead == -1) && (errno != EAGAIN),
+                        "Could not read cgroup events.  %m.");
+            return;
+        }
+
+        char* eventPtr = buf;
+
+        while (eventPtr < buf + numBytesRead)
+        {
+            struct inotify_event* inotifyEventPtr = (struct inotify_event*)eventPtr;
+
+            // The release handler may delete the cgroup, so look it up for each event.
+            Group_t* groupPtr = le_hashmap_Get(ReleaseWatchMap,
+                                               (void*)(intptr_t)inotifyEventPtr->wd);
+
+            if (groupPtr != NULL)
+            {
+                CheckRelease(groupPtr);
+            }
+
+            eventPtr += sizeof(struct inotify_event) + inotifyEventPtr->len;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the handler called when the last process leaves a cgroup whose release notification is
+ * enabled.  Only used in the unified hierarchy: the legacy hierarchies run the release agent
+ * instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void cgrp_SetReleaseHandler
+(
+    cgrp_ReleaseHandler_t handler   ///< [IN] Handler.
+)
+{
+    ReleaseHandler = handler;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets notified when the last process leaves the cgroup.  In the legacy hierarchies the kernel
+ * runs the release agent of the freezer sub-system.  In the unified hierarchy the cgroup's events
+ * are watched and the handler set by cgrp_SetReleaseHandler() is called.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_EnableReleaseNotify
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+)
+{
+    if (!cgrp_IsUnified())
+    {
+        return WriteAt(groupRef, CGRP_SUBSYS_FREEZE, NOTIFY_ON_RELEASE_FILENAME, "1");
+    }
+
+    if (groupRef->releaseWatch >= 0)
+    {
+        return LE_OK;
+    }
+
+    if (ReleaseInotifyFd < 0)
+    {
+        ReleaseInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (ReleaseInotifyFd < 0)
+        {
+            LE_ERROR("Could not create inotify instance for cgroup events.  %m.");
+            return LE_FAULT;
+        }
+
+        ReleaseWatchMap = le_hashmap_Create("CgroupReleaseWatches",
+                                            31,
+                                            le_hashmap_HashVoidPointer,
+                                            le_hashmap_EqualsVoidPointer);
+
+        ReleaseFdMonitor = le_fdMonitor_Create("CgroupEvents",
+                                               ReleaseInotifyFd,
+                                               ReleaseInotifyHandler,
+                                               POLLIN);
+    }
+
+    char path[LIMIT_MAX_PATH_BYTES];
+    BuildPath(CGRP_SUBSYS_FREEZE, groupRef->name, FILE_NAME(FILE_FREEZE_STATE), path, sizeof(path));
+
+    // cgroup.events is modified whenever its populated state changes.
+    groupRef->releaseWatch = inotify_add_watch(ReleaseInotifyFd, path, IN_MODIFY);
+
+    if (groupRef->releaseWatch < 0)
+    {
+        LE_ERROR("Could not watch '%s'.  %m.", path);
+        return LE_FAULT;
+    }
+
+    le_hashmap_Put(ReleaseWatchMap, (void*)(intptr_t)groupRef->releaseWatch, groupRef);
+
+    // Catch up with processes that left before the watch was added.
+    CheckRelease(groupRef);
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the value of a key from the contents of a statistics file made of "key value" lines.
+ *
+ * @return
+ *      The value, or 0 if the key is not present.
+ */
+//--------------------------------------------------------------------------------------------------
+static uint64_t GetStatValue
+(
+    const char* statPtr,            ///< [IN] Contents of the file.
+    const char* keyPtr              ///< [IN] Key to look up.
+)
+{
+    size_t keyLen = strlen(keyPtr);
+    const char* linePtr = statPtr;
+
+    while (linePtr != NULL)
+    {
+        if ((strncmp(linePtr, keyPtr, keyLen) == 0) && (linePtr[keyLen] == ' '))
+        {
+            return strtoull(linePtr + keyLen + 1, NULL, 10);
+        }
+
+        linePtr = strchr(linePtr, '\n');
+
+        if (linePtr != NULL)
+        {
+            linePtr++;
+        }
+    }
+
+    return 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the usage counters of a cgroup.  The counter files are kept open by the handle, so a
+ * sample costs one read per file.
+ *
+ * @note Processes that are not in the cgroup for the cpu sub-system (see cgrp_grp_AddProc()) are
+ *       not included in the cpu time.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_GetUsage
+(
+    cgrp_GroupRef_t groupRef,       ///< [IN] Cgroup handle.
+    cgrp_Usage_t* usagePtr          ///< [OUT] Usage counters.
+)
+{
+    char buf[MAX_STAT_BYTES];
+
+    if (ReadCachedFile(groupRef, CGRP_SUBSYS_CPU, FILE_NAME(FILE_CPU_USAGE), &groupRef->cpuUsageFd,
+                       buf, sizeof(buf)) == LE_FAULT)
+    {
+        return LE_FAULT;
+    }
+
+    if (cgrp_IsUnified())
+    {
+        usagePtr->cpuTimeNs = GetStatValue(buf, "usage_usec") * 1000;
+    }
+    else
+    {
+        usagePtr->cpuTimeNs = strtoull(buf, NULL, 10);
+    }
+
+    if (ReadCachedFile(groupRef, CGRP_SUBSYS_MEM, MEM_STAT_FILENAME, &groupRef->memStatFd,
+                       buf, sizeof(buf)) == LE_FAULT)
+    {
+        return LE_FAULT;
+    }
+
+    usagePtr->rssBytes = GetStatValue(buf, cgrp_IsUnified() ? "anon" : "rss");
+    usagePtr->pageFaults = GetStatValue(buf, "pgfault");
+    usagePtr->majorPageFaults = GetStatValue(buf, "pgmajfault");
+
+    return LE_OK;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes the cgroup in every sub-system and releases the handle.  The handle is released even if
+ * a cgroup could not be deleted.
+ *
+ * @note A cgroup can only be removed when there are no processes in the group.
+ *
+ * @return
+ *      LE_OK if the cgroups were successfully deleted.
+ *      LE_BUSY if a cgroup could not be deleted because there are still processes in it.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_Delete
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+)
+{
+    le_result_t result = LE_OK;
+    int i;
+
+    if (groupRef->releaseWatch >= 0)
+    {
+        le_hashmap_Remove(ReleaseWatchMap, (void*)(intptr_t)groupRef->releaseWatch);
+        inotify_rm_watch(ReleaseInotifyFd, groupRef->releaseWatch);
+        groupRef->releaseWatch = -1;
+    }
+
+    CloseGroupFd(&groupRef->freezeFd);
+    CloseGroupFd(&groupRef->freezeStateFd);
+    CloseGroupFd(&groupRef->cpuUsageFd);
+    CloseGroupFd(&groupRef->memStatFd);
+
+    for (i = 0; i < NumGroupDirs(); i++)
+    {
+        CloseGroupFd(&groupRef->procsFd[i]);
+        CloseGroupFd(&groupRef->dirFd[i]);
+
+        le_result_t deleteResult = cgrp_Delete(i, groupRef->name);
+
+        if (result == LE_OK)
+        {
+            result = deleteResult;
+        }
+    }
+
+    le_mem_Release(groupRef);
+
+    return result;
+}
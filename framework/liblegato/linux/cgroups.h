@@ -6,6 +6,8 @@
  * @ref c_cgrp_settingAttributes <br>
  * @ref c_cgrp_addingProcesses <br>
  * @ref c_cgrp_delete <br>
+ * @ref c_cgrp_handles <br>
+ * @ref c_cgrp_unified <br>
  * @ref c_cgrp_threadSafety <br>
  *
  *
@@ -92,6 +94,43 @@
  * processes.
  *
  *
+ * @section c_cgrp_handles Cgroup Handles
+ *
+ * The functions above look up the cgroup in the file system on every call.  A user that manages a
+ * cgroup for a long time, such as the Supervisor for an app, should instead create it with
+ * cgrp_grp_Create().  This creates the cgroup in every sub-system and returns a handle that keeps
+ * the cgroup directories, and the files written over the group's life, open:
+ *
+ * @code
+ *      cgrp_GroupRef_t groupRef = cgrp_grp_Create("MyApp");
+ *
+ *      // Stage the attributes then write them all in one pass.
+ *      cgrp_grp_SetCpuShare(groupRef, 512);
+ *      cgrp_grp_SetMemLimit(groupRef, 100);
+ *      cgrp_grp_Apply(groupRef);
+ *
+ *      // Add a process to the cgroup in every sub-system.
+ *      cgrp_grp_AddProc(groupRef, pid, false);
+ *
+ *      // Suspend and resume all the processes.
+ *      cgrp_grp_Freeze(groupRef);
+ *      cgrp_grp_Thaw(groupRef);
+ *
+ *      // Remove the cgroup once it is empty.
+ *      cgrp_grp_Delete(groupRef);
+ * @endcode
+ *
+ *
+ * @section c_cgrp_unified Unified Hierarchy
+ *
+ * If a cgroup v2 unified hierarchy is already mounted on /sys/fs/cgroup it is used instead of one
+ * hierarchy per sub-system (see cgrp_IsUnified()).  All sub-systems then share one cgroup per name,
+ * the cpu share is converted to a cpu weight and the freezer is driven through cgroup.freeze.
+ * Unified hierarchies have no release agent: instead, the cgroup.events file of each cgroup whose
+ * release notification is enabled is watched, and the handler set by cgrp_SetReleaseHandler() is
+ * called when the cgroup becomes empty.
+ *
+ *
  * @section c_cgrp_threadSafety Thread Safety
  *
  * The functions in this API are not thread safe.  Other synchronization methods must be used to
@@ -132,6 +171,40 @@ typedef enum
 cgrp_FreezeState_t;
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a cgroup handle.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct cgrp_Group* cgrp_GroupRef_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Usage counters of a cgroup.  All the counters are cumulative except the resident memory.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    uint64_t cpuTimeNs;             ///< Cpu time used by the cgroup's tasks, in nanoseconds.
+    uint64_t rssBytes;              ///< Resident anonymous memory, in bytes.
+    uint64_t pageFaults;            ///< Number of page faults.
+    uint64_t majorPageFaults;       ///< Number of page faults that needed I/O.
+}
+cgrp_Usage_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Handler called when the last process leaves a cgroup.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef void (*cgrp_ReleaseHandler_t)
+(
+    const char* cgroupNamePtr       ///< [IN] Name of the cgroup.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Initializes cgroups for the system.  Sets up a hierarchy for each supported subsystem.
@@ -148,6 +221,22 @@ void cgrp_Init
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether the cgroups are a cgroup v2 unified hierarchy rather than one legacy (v1)
+ * hierarchy per sub-system.  A unified hierarchy is used only if one is already mounted on the
+ * cgroup root when it is first checked; otherwise the legacy hierarchies are set up by cgrp_Init().
+ *
+ * @return
+ *      true if the unified hierarchy is in use.
+ */
+//--------------------------------------------------------------------------------------------------
+bool cgrp_IsUnified
+(
+    void
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Creates a cgroup with the specified name in the specified sub-system.  If the cgroup already
@@ -435,4 +524,218 @@ ssize_t cgrp_GetMaxMemUsed
     const char* cgroupNamePtr       ///< [IN] Name of the cgroup.
 );
 
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates the cgroup with the specified name in every sub-system and returns a handle that keeps
+ * the cgroup directories open.  A cgroup left behind with the same name (for example by a previous
+ * instance that did not clean up) is deleted and re-created so that it starts with default
+ * attributes.
+ *
+ * Attributes set through the handle are staged and only written to the cgroup by cgrp_grp_Apply().
+ *
+ * @return
+ *      Reference to the cgroup handle if successful.
+ *      NULL if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+cgrp_GroupRef_t cgrp_grp_Create
+(
+    const char* cgroupNamePtr       ///< [IN] Name of the cgroup to create.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the name of the cgroup a handle refers to.
+ *
+ * @return
+ *      Name of the cgroup.
+ */
+//--------------------------------------------------------------------------------------------------
+const char* cgrp_grp_GetName
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stages the cpu share of a cgroup.  See cgrp_cpu_SetShare() for the meaning of the share.  The
+ * value is written by the next call to cgrp_grp_Apply().
+ */
+//--------------------------------------------------------------------------------------------------
+void cgrp_grp_SetCpuShare
+(
+    cgrp_GroupRef_t groupRef,       ///< [IN] Cgroup handle.
+    size_t share                    ///< [IN] Share value to set.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Stages the memory limit of a cgroup.  The value is written by the next call to cgrp_grp_Apply().
+ */
+//--------------------------------------------------------------------------------------------------
+void cgrp_grp_SetMemLimit
+(
+    cgrp_GroupRef_t groupRef,       ///< [IN] Cgroup handle.
+    size_t limit                    ///< [IN] Memory limit in kilobytes.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes all the staged attributes of a cgroup in one pass.  Attributes that already have the
+ * staged value, including the kernel defaults of a newly created cgroup, are not written again.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if an attribute could not be set.  Attributes that were not set stay staged.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_Apply
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds a process to a cgroup in every sub-system with a single call.  The procs files are kept
+ * open by the handle, so adding a process costs one write per sub-system.
+ *
+ * @note In the unified hierarchy a process belongs to the same cgroup for every sub-system, so it
+ *       cannot be kept out of the cpu sub-system and excludeCpu has no effect.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_OUT_OF_RANGE if the process doesn't exist.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_AddProc
+(
+    cgrp_GroupRef_t groupRef,       ///< [IN] Cgroup handle.
+    pid_t pidToAdd,                 ///< [IN] PID of the process to add.
+    bool excludeCpu                 ///< [IN] true to leave the process out of the cpu sub-system.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Freezes all the tasks in a cgroup.  Behaves like cgrp_frz_Freeze() but does not need to look up
+ * the cgroup in the file system.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_Freeze
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Thaws all the tasks in a cgroup.  Behaves like cgrp_frz_Thaw() but does not need to look up the
+ * cgroup in the file system.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_Thaw
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the freeze state of a cgroup.  The state file is kept open by the handle so that polling
+ * for a freeze to complete costs one read per poll.
+ *
+ * @return
+ *      Freeze state of the cgroup if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+cgrp_FreezeState_t cgrp_grp_GetFreezeState
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the handler called when the last process leaves a cgroup whose release notification is
+ * enabled.  Only used in the unified hierarchy: the legacy hierarchies run the release agent
+ * instead.
+ */
+//--------------------------------------------------------------------------------------------------
+void cgrp_SetReleaseHandler
+(
+    cgrp_ReleaseHandler_t handler   ///< [IN] Handler.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets notified when the last process leaves the cgroup.  In the legacy hierarchies the kernel
+ * runs the release agent of the freezer sub-system.  In the unified hierarchy the cgroup's events
+ * are watched and the handler set by cgrp_SetReleaseHandler() is called.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_EnableReleaseNotify
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the usage counters of a cgroup.  The counter files are kept open by the handle, so a
+ * sample costs one read per file.
+ *
+ * @note Processes that are not in the cgroup for the cpu sub-system (see cgrp_grp_AddProc()) are
+ *       not included in the cpu time.
+ *
+ * @return
+ *      LE_OK if successful.
+ *      LE_FAULT if there was an error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_GetUsage
+(
+    cgrp_GroupRef_t groupRef,       ///< [IN] Cgroup handle.
+    cgrp_Usage_t* usagePtr          ///< [OUT] Usage counters.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes the cgroup in every sub-system and releases the handle.  The handle is released even if
+ * a cgroup could not be deleted.
+ *
+ * @note A cgroup can only be removed when there are no processes in the group.
+ *
+ * @return
+ *      LE_OK if the cgroups were successfully deleted.
+ *      LE_BUSY if a cgroup could not be deleted because there are still processes in it.
+ *      LE_FAULT if there was some other error.
+ */
+//--------------------------------------------------------------------------------------------------
+le_result_t cgrp_grp_Delete
+(
+    cgrp_GroupRef_t groupRef        ///< [IN] Cgroup handle.
+);
+
 #endif // LEGATO_SRC_CGROUPS_INCLUDE_GUARD
@@ -13,6 +13,28 @@
 /// including the null terminator.
 #define MAX_STRING_BYTES 1024
 
+/// Number of bytes read from the file descriptor at a time, when the input allows reading ahead.
+#define READ_BLOCK_BYTES 4096
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Kinds of input the parser can read the JSON document from.
+ *
+ * The parser must never consume bytes past the end of the document, because the client may go on
+ * to read something else from the same file descriptor.  So it can only read ahead if it can give
+ * back what it didn't use.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef enum
+{
+    INPUT_STREAM,   ///< Pipe, tty, etc.  Read one byte at a time.
+    INPUT_FILE,     ///< Seekable file.  Read in blocks, seek back over unused bytes when stopping.
+    INPUT_SOCKET,   ///< Stream socket.  Peek blocks, then consume only the bytes that were used.
+    INPUT_MEMORY,   ///< Buffer in memory.  No reading required.
+}
+Input_t;
+
 
 //--------------------------------------------------------------------------------------------------
 /**
@@ -54,9 +76,14 @@ typedef struct le_json_ParsingSession
     size_t numBytes;                ///< # of bytes of content in the buffer.
     double number;                  ///< Value of last number parsed.
 
+    Input_t inputType;              ///< Kind of input the document is read from.
     int fd;                         ///< File descriptor to read the JSON document from.
     le_fdMonitor_Ref_t fdMonitor;   ///< File Descriptor Monitor used to monitor the fd.
-    size_t bytesRead;               ///< # of bytes read from the file descriptor.
+    const char* blockPtr;           ///< Block of input being processed (NULL if none).
+    size_t blockSize;               ///< # of bytes in the block.
+    size_t blockPos;                ///< # of bytes of the block that have been processed.
+    char readBuffer[READ_BLOCK_BYTES];  ///< Buffer blocks are read into from the fd.
+    size_t bytesRead;               ///< # of bytes of the document processed so far.
     size_t line;                    ///< Line number of the JSON document (starts at 1).
 
     le_json_ErrorHandler_t errorHandler; ///< Function to call when errors happen.
@@ -116,6 +143,75 @@ static inline bool NotStopped
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Finishes with the current input block: gives back to the file descriptor any bytes that were
+ * read ahead but not processed, or consumes the bytes that were only peeked at.  Afterwards, the
+ * file descriptor is positioned just after the last byte processed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SettleBlock
+(
+    Parser_t* parserPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (parserPtr->blockPtr == NULL)
+    {
+        return;
+    }
+
+    switch (parserPtr->inputType)
+    {
+        case INPUT_FILE:
+
+            if (parserPtr->blockPos < parserPtr->blockSize)
+            {
+                off_t unused = parserPtr->blockSize - parserPtr->blockPos;
+
+                LE_ERROR_IF(lseek(parserPtr->fd, -unused, SEEK_CUR) == -1,
+                            "Failed to give back %zd unused bytes to fd %d (%m).",
+                            (ssize_t)unused, parserPtr->fd);
+            }
+            break;
+
+        case INPUT_SOCKET:
+        {
+            // The peeked data is still queued on the socket, so this can't block or come up short.
+            size_t remaining = parserPtr->blockPos;
+
+            while (remaining > 0)
+            {
+                ssize_t result = recv(parserPtr->fd, parserPtr->readBuffer, remaining, 0);
+
+                if (result <= 0)
+                {
+                    if ((result == -1) && (errno == EINTR))
+                    {
+                        continue;
+                    }
+
+                    LE_ERROR("Failed to consume %zu parsed bytes from fd %d (%m).",
+                             remaining, parserPtr->fd);
+                    break;
+                }
+
+                remaining -= result;
+            }
+            break;
+        }
+
+        case INPUT_STREAM:
+        case INPUT_MEMORY:
+            break;
+    }
+
+    parserPtr->blockPtr = NULL;
+    parserPtr->blockSize = 0;
+    parserPtr->blockPos = 0;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Stops parsing.  (Stopping a stopped parser is okay.)
@@ -130,8 +226,16 @@ static void StopParsing
     if (NotStopped(parserPtr))
     {
         parserPtr->next = EXPECT_NOTHING;
-        le_fdMonitor_Delete(parserPtr->fdMonitor);
-        parserPtr->fdMonitor = NULL;
+
+        // Leave the fd positioned just after the end of what was parsed, before any handler
+        // gets a chance to read from it.
+        SettleBlock(parserPtr);
+
+        if (parserPtr->fdMonitor != NULL)
+        {
+            le_fdMonitor_Delete(parserPtr->fdMonitor);
+            parserPtr->fdMonitor = NULL;
+        }
     }
 }
 
@@ -613,7 +717,7 @@ static void ParseString
     if (c == '"')
     {
         // It's not string terminating if it is escaped.
-        if ((parserPtr->bytesRead == 0) || (parserPtr->buffer[parserPtr->bytesRead - 1] != '\\'))
+        if ((parserPtr->numBytes == 0) || (parserPtr->buffer[parserPtr->numBytes - 1] != '\\'))
         {
             // Make we have a valid UTF-8 string.
             if (!le_utf8_IsFormatCorrect(parserPtr->buffer))
@@ -851,6 +955,44 @@ static void ProcessChar
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Runs a block of the JSON document through the parser, until the block is used up or parsing
+ * stops.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ProcessBlock
+(
+    Parser_t* parserPtr,
+    const char* blockPtr,
+    size_t blockSize
+)
+//--------------------------------------------------------------------------------------------------
+{
+    parserPtr->blockPtr = blockPtr;
+    parserPtr->blockSize = blockSize;
+    parserPtr->blockPos = 0;
+
+    while (NotStopped(parserPtr) && (parserPtr->blockPos < parserPtr->blockSize))
+    {
+        char c = blockPtr[parserPtr->blockPos];
+
+        // Count the byte as processed before the handlers see its effects, so that if they
+        // stop parsing the fd is left positioned just after it.
+        parserPtr->blockPos++;
+        parserPtr->bytesRead++;
+        if (c == '\n')
+        {
+            parserPtr->line++;
+        }
+        ProcessChar(parserPtr, c);
+    }
+
+    // If parsing stopped, the block has already been settled.
+    SettleBlock(parserPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Read data from the JSON document file descriptor and process it.
@@ -865,11 +1007,26 @@ static void ReadData
 {
     while (NotStopped(parserPtr))
     {
-        char c;
         ssize_t bytesRead;
         do
         {
-            bytesRead = read(fd, &c, 1);
+            switch (parserPtr->inputType)
+            {
+                case INPUT_FILE:
+                    bytesRead = read(fd, parserPtr->readBuffer, sizeof(parserPtr->readBuffer));
+                    break;
+
+                case INPUT_SOCKET:
+                    bytesRead = recv(fd,
+                                     parserPtr->readBuffer,
+                                     sizeof(parserPtr->readBuffer),
+                                     MSG_PEEK | MSG_DONTWAIT);
+                    break;
+
+                default:
+                    bytesRead = read(fd, parserPtr->readBuffer, 1);
+                    break;
+            }
         }
         while ((bytesRead == -1) && (errno == EINTR));
 
@@ -914,14 +1071,50 @@ static void ReadData
         }
         else
         {
-            parserPtr->bytesRead++;
-            if (c == '\n')
-            {
-                parserPtr->line++;
-            }
-            ProcessChar(parserPtr, c);
+            ProcessBlock(parserPtr, parserPtr->readBuffer, bytesRead);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Works out what kind of input a file descriptor is, and so how far the parser can read ahead.
+ */
+//--------------------------------------------------------------------------------------------------
+static Input_t GetInputType
+(
+    int fd
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat fileStat;
+
+    if (fstat(fd, &fileStat) != 0)
+    {
+        // Let the first read report the problem.
+        return INPUT_STREAM;
+    }
+
+    if (S_ISREG(fileStat.st_mode) && (lseek(fd, 0, SEEK_CUR) != -1))
+    {
+        return INPUT_FILE;
+    }
+
+    if (S_ISSOCK(fileStat.st_mode))
+    {
+        // Peeking only works for byte streams.  A datagram would be lost if it was partly read.
+        int sockType;
+        socklen_t optLen = sizeof(sockType);
+
+        if ( (getsockopt(fd, SOL_SOCKET, SO_TYPE, &sockType, &optLen) == 0)
+            && (sockType == SOCK_STREAM) )
+        {
+            return INPUT_SOCKET;
         }
     }
+
+    return INPUT_STREAM;
 }
 
 
@@ -975,29 +1168,31 @@ static void FdEventHandler
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Parse a JSON document received via a file descriptor.
+ * Creates a parser object, ready to start parsing a document from the top level.  The caller
+ * sets up the input.
  *
- * @return Reference to the JSON parsing session started by this function call.
+ * @return Pointer to the parser object.
  */
 //--------------------------------------------------------------------------------------------------
-le_json_ParsingSessionRef_t le_json_Parse
+static Parser_t* CreateParser
 (
-    int fd, ///< File descriptor to read the JSON document from.
     le_json_EventHandler_t  eventHandler,   ///< Function to call when normal parsing events happen.
     le_json_ErrorHandler_t  errorHandler,   ///< Function to call when errors happen.
     void* opaquePtr   ///< Opaque pointer to be fetched by handlers using le_json_GetOpaquePtr().
 )
 //--------------------------------------------------------------------------------------------------
 {
-    // Create a Parser.
     Parser_t* parserPtr = le_mem_ForceAlloc(ParserPool);
 
     parserPtr->next = EXPECT_OBJECT_OR_ARRAY;
     parserPtr->numBytes = 0;
 
-    parserPtr->fd = fd;
-    parserPtr->fdMonitor = le_fdMonitor_Create("le_json", fd, FdEventHandler, POLLIN);
-    le_fdMonitor_SetContextPtr(parserPtr->fdMonitor, parserPtr);
+    parserPtr->inputType = INPUT_STREAM;
+    parserPtr->fd = -1;
+    parserPtr->fdMonitor = NULL;
+    parserPtr->blockPtr = NULL;
+    parserPtr->blockSize = 0;
+    parserPtr->blockPos = 0;
     parserPtr->bytesRead = 0;
     parserPtr->line = 1;
 
@@ -1016,6 +1211,98 @@ le_json_ParsingSessionRef_t le_json_Parse
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a JSON document received via a file descriptor.
+ *
+ * @return Reference to the JSON parsing session started by this function call.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_ParsingSessionRef_t le_json_Parse
+(
+    int fd, ///< File descriptor to read the JSON document from.
+    le_json_EventHandler_t  eventHandler,   ///< Function to call when normal parsing events happen.
+    le_json_ErrorHandler_t  errorHandler,   ///< Function to call when errors happen.
+    void* opaquePtr   ///< Opaque pointer to be fetched by handlers using le_json_GetOpaquePtr().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Parser_t* parserPtr = CreateParser(eventHandler, errorHandler, opaquePtr);
+
+    parserPtr->inputType = GetInputType(fd);
+    parserPtr->fd = fd;
+    parserPtr->fdMonitor = le_fdMonitor_Create("le_json", fd, FdEventHandler, POLLIN);
+    le_fdMonitor_SetContextPtr(parserPtr->fdMonitor, parserPtr);
+
+    return parserPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Function queued to the event loop to parse a JSON document held in memory.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ParseMemory
+(
+    void* param1Ptr,    ///< Parser object.
+    void* param2Ptr     ///< Not used.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Parser_t* parserPtr = param1Ptr;
+
+    // The parser holds a reference for this function until it has run, so it is still valid even
+    // if the client called le_json_Cleanup() in the meantime.
+    ProcessBlock(parserPtr, parserPtr->blockPtr, parserPtr->blockSize);
+
+    if (NotStopped(parserPtr))
+    {
+        // The document has been truncated.
+        Error(parserPtr, LE_JSON_READ_ERROR, "Unexpected end-of-file.");
+    }
+
+    le_mem_Release(parserPtr);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parse a JSON document held in memory, for example a buffer filled in by the caller or a file
+ * that the caller has mapped with mmap().
+ *
+ * Like le_json_Parse(), this returns immediately, and the handlers are called later from the
+ * calling thread's event loop.  No system calls are made to read the document.
+ *
+ * @warning The buffer must not be changed or freed until parsing has stopped.
+ *
+ * @return Reference to the JSON parsing session started by this function call.
+ */
+//--------------------------------------------------------------------------------------------------
+le_json_ParsingSessionRef_t le_json_ParseBuffer
+(
+    const void* bufferPtr,  ///< The JSON document.
+    size_t bufferSize,      ///< Number of bytes in the buffer.
+    le_json_EventHandler_t  eventHandler,   ///< Function to call when normal parsing events happen.
+    le_json_ErrorHandler_t  errorHandler,   ///< Function to call when errors happen.
+    void* opaquePtr   ///< Opaque pointer to be fetched by handlers using le_json_GetOpaquePtr().
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Parser_t* parserPtr = CreateParser(eventHandler, errorHandler, opaquePtr);
+
+    parserPtr->inputType = INPUT_MEMORY;
+    parserPtr->blockPtr = bufferPtr;
+    parserPtr->blockSize = bufferSize;
+
+    // Hold a reference for the queued function.
+    le_mem_AddRef(parserPtr);
+    le_event_QueueFunction(ParseMemory, parserPtr, NULL);
+
+    return parserPtr;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Stops parsing and cleans up memory allocated by the parser.
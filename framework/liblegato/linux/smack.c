@@ -14,6 +14,7 @@
 #include "limit.h"
 #include "fileSystem.h"
 #include "fileDescriptor.h"
+#include <sys/utsname.h>
 
 
 //--------------------------------------------------------------------------------------------------
@@ -34,42 +35,42 @@
 
 //--------------------------------------------------------------------------------------------------
 /**
- * SMACK load file location.
+ * SMACK load file name.
  */
 //--------------------------------------------------------------------------------------------------
-#define SMACK_LOAD_FILE                     SMACK_FS_DIR "/load2"
+#define SMACK_LOAD_FILE                     "load2"
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * SMACK access file location.
+ * SMACK access file name.
  */
 //--------------------------------------------------------------------------------------------------
-#define SMACK_ACCESS_FILE                   SMACK_FS_DIR "/access2"
+#define SMACK_ACCESS_FILE                   "access2"
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * SMACK revoke subject file location.
+ * SMACK revoke subject file name.
  */
 //--------------------------------------------------------------------------------------------------
-#define SMACK_REVOKE_FILE                   SMACK_FS_DIR "/revoke-subject"
+#define SMACK_REVOKE_FILE                   "revoke-subject"
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * SMACK netlabel file location.
+ * SMACK netlabel file name.
  */
 //--------------------------------------------------------------------------------------------------
-#define SMACK_NETLABEL_FILE                 SMACK_FS_DIR "/netlabel"
+#define SMACK_NETLABEL_FILE                 "netlabel"
 
 
 //--------------------------------------------------------------------------------------------------
 /**
- * SMACK ipv6host file location.
+ * SMACK ipv6host file name.
  */
 //--------------------------------------------------------------------------------------------------
-#define SMACK_IPV6HOST_FILE                 SMACK_FS_DIR "/ipv6host"
+#define SMACK_IPV6HOST_FILE                 "ipv6host"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -102,24 +103,106 @@
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Set SMACK netlabel exception to grant applications permission to communicate with the Internet
- * via IPv4.
+ * Largest write the SMACK load file accepts.  The kernel only guarantees one page per write and
+ * truncates anything longer, so rule sets are kept in chunks of at most this size that each end on
+ * a rule boundary.
  */
 //--------------------------------------------------------------------------------------------------
-static void SetSmackNetlabelExceptions
+#define LOAD_CHUNK_BYTES                    4095
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A set of SMACK rules that is loaded with as few writes as possible.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct smack_RuleSet
+{
+    le_sls_List_t chunks;           ///< List of RuleChunk_t holding the rule strings.
+    size_t numRules;                ///< Number of rules in the set.
+}
+RuleSet_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A chunk of newline-terminated SMACK rule strings, written to the load file in one write.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct
+{
+    size_t len;                     ///< Number of bytes used in buf.
+    char buf[LOAD_CHUNK_BYTES];     ///< Rule strings, each terminated by a newline.
+    le_sls_Link_t link;             ///< Link in the rule set's list of chunks.
+}
+RuleChunk_t;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Pools for rule sets and rule chunks.  Created the first time a rule set is created.
+ */
+//--------------------------------------------------------------------------------------------------
+static le_mem_PoolRef_t RuleSetPool = NULL;
+static le_mem_PoolRef_t RuleChunkPool = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory the SMACK file system is accessed through.  Can be changed with smack_SetFsDir().
+ */
+//--------------------------------------------------------------------------------------------------
+static char FsDir[LIMIT_MAX_PATH_BYTES] = SMACK_FS_DIR;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Opens one of the SMACK file system's files.
+ *
+ * @return
+ *      The file descriptor, or -1 if the file could not be opened (errno is set).
+ */
+//--------------------------------------------------------------------------------------------------
+static int OpenSmackFile
 (
-    void
+    const char* fileNamePtr,        ///< [IN] Name of the file in the SMACK file system.
+    int flags                       ///< [IN] Open flags.
 )
 {
-    // Open the calling process's smack file.
+    char path[LIMIT_MAX_PATH_BYTES] = "";
+
+    if (le_path_Concat("/", path, sizeof(path), FsDir, fileNamePtr, NULL) != LE_OK)
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
     int fd;
 
     do
     {
-        fd = open(SMACK_NETLABEL_FILE, O_WRONLY);
+        fd = open(path, flags | O_CLOEXEC);
     }
     while ( (fd == -1) && (errno == EINTR) );
 
+    return fd;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Set SMACK netlabel exception to grant applications permission to communicate with the Internet
+ * via IPv4.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SetSmackNetlabelExceptions
+(
+    void
+)
+{
+    // Open the calling process's smack file.
+    int fd = OpenSmackFile(SMACK_NETLABEL_FILE, O_WRONLY);
+
     LE_FATAL_IF(fd == -1, "Could not open %s.  %m.\n", SMACK_NETLABEL_FILE);
 
     // Write netlabel to the file.
@@ -162,13 +245,7 @@ static void SetSmackIPv6HostExceptions
 )
 {
     // Open the calling process's smack file.
-    int fd;
-
-    do
-    {
-        fd = open(SMACK_IPV6HOST_FILE, O_WRONLY);
-    }
-    while ( (fd == -1) && (errno == EINTR) );
+    int fd = OpenSmackFile(SMACK_IPV6HOST_FILE, O_WRONLY);
 
     if (fd == -1)
     {
@@ -525,13 +602,7 @@ void smack_SetRule
     MakeRuleStr(subjectLabelPtr, accessModePtr, objectLabelPtr, rule, sizeof(rule));
 
     // Open the SMACK load file.
-    int fd;
-
-    do
-    {
-        fd = open(SMACK_LOAD_FILE, O_WRONLY);
-    }
-    while ( (fd == -1) && (errno == EINTR) );
+    int fd = OpenSmackFile(SMACK_LOAD_FILE, O_WRONLY);
 
     LE_FATAL_IF(fd == -1, "Could not open %s.  %m.\n", SMACK_LOAD_FILE);
 
@@ -577,13 +648,7 @@ bool smack_HasAccess
     MakeRuleStr(subjectLabelPtr, accessModePtr, objectLabelPtr, rule, sizeof(rule));
 
     // Open the SMACK access file.
-    int fd;
-
-    do
-    {
-        fd = open(SMACK_ACCESS_FILE, O_RDWR);
-    }
-    while ( (fd == -1) && (errno == EINTR) );
+    int fd = OpenSmackFile(SMACK_ACCESS_FILE, O_RDWR);
 
     LE_FATAL_IF(fd == -1, "Could not open %s.  %m.\n", SMACK_ACCESS_FILE);
 
@@ -627,13 +692,7 @@ void smack_RevokeSubject
 )
 {
     // Open the SMACK revoke file.
-    int fd;
-
-    do
-    {
-        fd = open(SMACK_REVOKE_FILE, O_WRONLY);
-    }
-    while ( (fd == -1) && (errno == EINTR) );
+    int fd = OpenSmackFile(SMACK_REVOKE_FILE, O_WRONLY);
 
     LE_FATAL_IF(fd == -1, "Could not open %s.  %m.\n", SMACK_REVOKE_FILE);
 
@@ -654,6 +713,237 @@ void smack_RevokeSubject
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether the kernel accepts more than one rule per write to the load file.  Kernels before
+ * 3.12 only parse the first rule of a write and silently drop the rest.
+ *
+ * @return
+ *      true if a write may contain several newline-separated rules.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool IsMultiRuleWriteSupported
+(
+    void
+)
+{
+    static int isSupported = -1;
+
+    if (isSupported < 0)
+    {
+        struct utsname sysInfo;
+        unsigned int major = 0;
+        unsigned int minor = 0;
+
+        isSupported = (uname(&sysInfo) == 0) &&
+                      (sscanf(sysInfo.release, "%u.%u", &major, &minor) == 2) &&
+                      ((major > 3) || ((major == 3) && (minor >= 12)));
+    }
+
+    return isSupported;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes newline-terminated rule strings to the SMACK load file.
+ *
+ * @note If there's an error, this function will kill the calling process.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteRules
+(
+    int fd,                         ///< [IN] SMACK load file.
+    const char* bufPtr,             ///< [IN] Rule strings.
+    size_t len                      ///< [IN] Number of bytes in bufPtr.
+)
+{
+    while (len > 0)
+    {
+        ssize_t numBytes;
+
+        do
+        {
+            numBytes = write(fd, bufPtr, len);
+        }
+        while ( (numBytes == -1) && (errno == EINTR) );
+
+        LE_FATAL_IF(numBytes <= 0, "Could not write SMACK rules.  %m.");
+
+        bufPtr += numBytes;
+        len -= numBytes;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an empty SMACK rule set.  Rules are added with smack_AddRule() and are not in effect until
+ * the set is loaded with smack_LoadRuleSet().
+ *
+ * @return
+ *      Reference to the rule set.
+ */
+//--------------------------------------------------------------------------------------------------
+smack_RuleSetRef_t smack_CreateRuleSet
+(
+    void
+)
+{
+    if (RuleSetPool == NULL)
+    {
+        RuleSetPool = le_mem_CreatePool("SmackRuleSet", sizeof(RuleSet_t));
+        RuleChunkPool = le_mem_CreatePool("SmackRuleChunk", sizeof(RuleChunk_t));
+    }
+
+    RuleSet_t* ruleSetPtr = le_mem_ForceAlloc(RuleSetPool);
+
+    ruleSetPtr->chunks = LE_SLS_LIST_INIT;
+    ruleSetPtr->numRules = 0;
+
+    return ruleSetPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds an explicit SMACK rule to a rule set.  The access mode is the same as for smack_SetRule().
+ *
+ * @note If there's an error, this function will kill the calling process.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_AddRule
+(
+    smack_RuleSetRef_t ruleSetRef,  ///< [IN] Rule set to add the rule to.
+    const char* subjectLabelPtr,    ///< [IN] Subject label.
+    const char* accessModePtr,      ///< [IN] Access mode. See smack_SetRule() for details.
+    const char* objectLabelPtr      ///< [IN] Object label.
+)
+{
+    CheckLabel(subjectLabelPtr);
+    CheckLabel(objectLabelPtr);
+
+    char rule[SMACK_RULE_STR_BYTES];
+    MakeRuleStr(subjectLabelPtr, accessModePtr, objectLabelPtr, rule, sizeof(rule));
+
+    size_t ruleLength = strlen(rule);
+
+    // Append to the last chunk, or start a new one if the rule doesn't fit.
+    le_sls_Link_t* linkPtr = le_sls_PeekTail(&ruleSetRef->chunks);
+    RuleChunk_t* chunkPtr = (linkPtr == NULL) ? NULL : CONTAINER_OF(linkPtr, RuleChunk_t, link);
+
+    if ( (chunkPtr == NULL) || (chunkPtr->len + ruleLength + 1 > sizeof(chunkPtr->buf)) )
+    {
+        chunkPtr = le_mem_ForceAlloc(RuleChunkPool);
+        chunkPtr->len = 0;
+        chunkPtr->link = LE_SLS_LINK_INIT;
+
+        le_sls_Queue(&ruleSetRef->chunks, &chunkPtr->link);
+    }
+
+    memcpy(&chunkPtr->buf[chunkPtr->len], rule, ruleLength);
+    chunkPtr->len += ruleLength;
+    chunkPtr->buf[chunkPtr->len++] = '\n';
+
+    ruleSetRef->numRules++;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Loads all the rules of a rule set.  The load file is opened once and the rules are written a
+ * page at a time, or one rule per write on kernels that don't support multi-rule writes.
+ *
+ * @note If there's an error, this function will kill the calling process.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_LoadRuleSet
+(
+    smack_RuleSetRef_t ruleSetRef   ///< [IN] Rule set to load.
+)
+{
+    if (ruleSetRef->numRules == 0)
+    {
+        return;
+    }
+
+    int fd = OpenSmackFile(SMACK_LOAD_FILE, O_WRONLY);
+
+    LE_FATAL_IF(fd == -1, "Could not open %s.  %m.\n", SMACK_LOAD_FILE);
+
+    bool isMultiRule = IsMultiRuleWriteSupported();
+    le_sls_Link_t* linkPtr = le_sls_Peek(&ruleSetRef->chunks);
+
+    while (linkPtr != NULL)
+    {
+        RuleChunk_t* chunkPtr = CONTAINER_OF(linkPtr, RuleChunk_t, link);
+
+        if (isMultiRule)
+        {
+            WriteRules(fd, chunkPtr->buf, chunkPtr->len);
+        }
+        else
+        {
+            const char* rulePtr = chunkPtr->buf;
+            const char* endPtr = chunkPtr->buf + chunkPtr->len;
+
+            while (rulePtr < endPtr)
+            {
+                const char* newlinePtr = memchr(rulePtr, '\n', endPtr - rulePtr);
+
+                WriteRules(fd, rulePtr, newlinePtr + 1 - rulePtr);
+                rulePtr = newlinePtr + 1;
+            }
+        }
+
+        linkPtr = le_sls_PeekNext(&ruleSetRef->chunks, linkPtr);
+    }
+
+    fd_Close(fd);
+
+    LE_DEBUG("Loaded %zu SMACK rules.", ruleSetRef->numRules);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a rule set.  Rules that were loaded stay in effect.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_DeleteRuleSet
+(
+    smack_RuleSetRef_t ruleSetRef   ///< [IN] Rule set to delete.
+)
+{
+    le_sls_Link_t* linkPtr = le_sls_Pop(&ruleSetRef->chunks);
+
+    while (linkPtr != NULL)
+    {
+        le_mem_Release(CONTAINER_OF(linkPtr, RuleChunk_t, link));
+
+        linkPtr = le_sls_Pop(&ruleSetRef->chunks);
+    }
+
+    le_mem_Release(ruleSetRef);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the directory the SMACK file system is accessed through.  This is only meant for tests,
+ * which can point it at a directory of regular files to see what would be written to smackfs.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_SetFsDir
+(
+    const char* dirPathPtr          ///< [IN] Directory path.
+)
+{
+    LE_FATAL_IF(le_utf8_Copy(FsDir, dirPathPtr, sizeof(FsDir), NULL) != LE_OK,
+                "SMACK file system path '%s' is too long.", dirPathPtr);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets an application's SMACK label.
@@ -934,6 +1224,82 @@ void smack_RevokeSubject
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an empty SMACK rule set.
+ *
+ * @return
+ *      Reference to the rule set.
+ */
+//--------------------------------------------------------------------------------------------------
+smack_RuleSetRef_t smack_CreateRuleSet
+(
+    void
+)
+{
+    return NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds an explicit SMACK rule to a rule set.
+ *
+ * @note If there is an error this function will kill the calling process.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_AddRule
+(
+    smack_RuleSetRef_t ruleSetRef,  ///< [IN] Rule set to add the rule to.
+    const char* subjectLabelPtr,    ///< [IN] Subject label.
+    const char* accessModePtr,      ///< [IN] Access mode. See smack_SetRule() for details.
+    const char* objectLabelPtr      ///< [IN] Object label.
+)
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Loads all the rules of a rule set.
+ *
+ * @note If there is an error this function will kill the calling process.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_LoadRuleSet
+(
+    smack_RuleSetRef_t ruleSetRef   ///< [IN] Rule set to load.
+)
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a rule set.  Rules that were loaded stay in effect.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_DeleteRuleSet
+(
+    smack_RuleSetRef_t ruleSetRef   ///< [IN] Rule set to delete.
+)
+{
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the directory the SMACK file system is accessed through.  Only meant for tests.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_SetFsDir
+(
+    const char* dirPathPtr          ///< [IN] Directory path.
+)
+{
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets an application's SMACK label.
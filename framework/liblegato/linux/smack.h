@@ -63,6 +63,10 @@
  * Use smack_SetRule() to set an explicit SMACK rule that gives a specified subject access to a
  * specified object.
  *
+ * When many rules are set at once, add them to a rule set with smack_AddRule() and load them all
+ * with smack_LoadRuleSet().  The set is written to the SMACK load file in as few writes as the
+ * kernel allows, instead of opening the file and writing it once per rule.
+ *
  * Copyright (C) Sierra Wireless Inc.
  */
 
@@ -80,6 +84,14 @@
 #define SMACK_APP_PREFIX          "app."
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a set of SMACK rules.
+ */
+//--------------------------------------------------------------------------------------------------
+typedef struct smack_RuleSet* smack_RuleSetRef_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Shows whether SMACK is enabled or disabled in the Legato Framework.
@@ -217,6 +229,73 @@ void smack_RevokeSubject
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates an empty SMACK rule set.  Rules are added with smack_AddRule() and are not in effect until
+ * the set is loaded with smack_LoadRuleSet().
+ *
+ * @return
+ *      Reference to the rule set.
+ */
+//--------------------------------------------------------------------------------------------------
+smack_RuleSetRef_t smack_CreateRuleSet
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Adds an explicit SMACK rule to a rule set.  The access mode is the same as for smack_SetRule().
+ *
+ * @note If there is an error this function will kill the calling process.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_AddRule
+(
+    smack_RuleSetRef_t ruleSetRef,  ///< [IN] Rule set to add the rule to.
+    const char* subjectLabelPtr,    ///< [IN] Subject label.
+    const char* accessModePtr,      ///< [IN] Access mode. See smack_SetRule() for details.
+    const char* objectLabelPtr      ///< [IN] Object label.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Loads all the rules of a rule set.
+ *
+ * @note If there is an error this function will kill the calling process.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_LoadRuleSet
+(
+    smack_RuleSetRef_t ruleSetRef   ///< [IN] Rule set to load.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deletes a rule set.  Rules that were loaded stay in effect.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_DeleteRuleSet
+(
+    smack_RuleSetRef_t ruleSetRef   ///< [IN] Rule set to delete.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the directory the SMACK file system is accessed through.  This is only meant for tests,
+ * which can point it at a directory of regular files to see what would be written to smackfs.
+ */
+//--------------------------------------------------------------------------------------------------
+void smack_SetFsDir
+(
+    const char* dirPathPtr          ///< [IN] Directory path.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets an application's SMACK label.
@@ -125,6 +125,10 @@ options {
 
 @footer
 {
+    # Parsed interfaces, by path, search path and interface name.  A batch of ifgen jobs often
+    # parses the same .api files (and the files they import) many times over.
+    ParsedInterfaces = {}
+
     def ParseCode(apiFile, searchPath=[], ifaceName=None):
         if os.path.isabs(apiFile) or os.path.isfile(apiFile):
             apiPath = apiFile
@@ -139,15 +143,19 @@ options {
                 # path but at least will raise a reasonable exception
                 apiPath = apiFile
 
+        if ifaceName == None:
+            ifaceName = os.path.splitext(os.path.basename(apiPath))[0]
+
+        cacheKey = (os.path.abspath(apiPath), tuple(searchPath), ifaceName)
+        if cacheKey in ParsedInterfaces:
+            return ParsedInterfaces[cacheKey]
+
         fileStream = ANTLRFileStream(apiPath, 'utf-8')
         lexer = interfaceLexer(fileStream)
         tokens = CommonTokenStream(lexer)
         parser = interfaceParser(tokens)
         parser.searchPath=searchPath
-        if ifaceName == None:
-            parser.iface.name = os.path.splitext(os.path.basename(apiPath))[0]
-        else:
-            parser.iface.name = ifaceName
+        parser.iface.name = ifaceName
         parser.iface.path = apiPath
 
         iface = parser.apiDocument()
@@ -164,6 +172,8 @@ options {
                                                                DOC_PRE_COMMENT,
                                                                DOC_POST_COMMENT ]) ])
 
+        ParsedInterfaces[cacheKey] = iface
+
         return iface
 }
 
@@ -2689,6 +2689,10 @@ def main(argv, stdin=sys.stdin, stdout=sys.stdout, stderr=sys.stderr):
 
 
 
+# Parsed interfaces, by path, search path and interface name.  A batch of ifgen jobs often
+# parses the same .api files (and the files they import) many times over.
+ParsedInterfaces = {}
+
 def ParseCode(apiFile, searchPath=[], ifaceName=None):
     if os.path.isabs(apiFile) or os.path.isfile(apiFile):
         apiPath = apiFile
@@ -2703,15 +2707,19 @@ def ParseCode(apiFile, searchPath=[], ifaceName=None):
             # path but at least will raise a reasonable exception
             apiPath = apiFile
 
+    if ifaceName == None:
+        ifaceName = os.path.splitext(os.path.basename(apiPath))[0]
+
+    cacheKey = (os.path.abspath(apiPath), tuple(searchPath), ifaceName)
+    if cacheKey in ParsedInterfaces:
+        return ParsedInterfaces[cacheKey]
+
     fileStream = ANTLRFileStream(apiPath, 'utf-8')
     lexer = interfaceLexer(fileStream)
     tokens = CommonTokenStream(lexer)
     parser = interfaceParser(tokens)
     parser.searchPath=searchPath
-    if ifaceName == None:
-        parser.iface.name = os.path.splitext(os.path.basename(apiPath))[0]
-    else:
-        parser.iface.name = ifaceName
+    parser.iface.name = ifaceName
     parser.iface.path = apiPath
 
     iface = parser.apiDocument()
@@ -2728,6 +2736,8 @@ def ParseCode(apiFile, searchPath=[], ifaceName=None):
                                                            DOC_PRE_COMMENT,
                                                            DOC_POST_COMMENT ]) ])
 
+    ParsedInterfaces[cacheKey] = iface
+
     return iface
 
 
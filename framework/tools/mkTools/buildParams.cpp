@@ -26,6 +26,8 @@ BuildParams_t::BuildParams_t
     target("localhost"),
     codeGenOnly(false),
     isStandAloneComp(false),
+    printBuildReport(false),
+    updateCrc32(false),
     argc(0),
     argv(NULL)
 //--------------------------------------------------------------------------------------------------
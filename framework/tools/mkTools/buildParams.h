@@ -35,6 +35,8 @@ struct BuildParams_t
     bool                    codeGenOnly;        ///< true = only generate code, don't compile, etc.
     bool                    isStandAloneComp;   ///< true = generate stand-alone component
     bool                    binPack;            ///< true = generate a binary package for redist.
+    bool                    printBuildReport;   ///< true = report where the build time went.
+    bool                    updateCrc32;        ///< true = put payload CRC32s in update packs.
 
     int                     argc;               ///< Number of arguments (argc to main)
     const char**            argv;               ///< Argument list (argv to main)
@@ -53,6 +53,19 @@ void AppBuildScriptGenerator_t::GenerateAppBuildRules
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // Only put the CRC32 of the tarball in the update pack header if asked to, because older
+    // targets reject update packs with unknown header members.
+    std::string crc32Step;
+    std::string crc32Member;
+    if (buildParams.updateCrc32)
+    {
+        // Get the CRC32 of the tarball (from the trailer of a gzip stream), so the target can
+        // verify the payload while it is unpacking it.
+        crc32Step = "            crc32=`gzip -1 -c $workingDir/$name.$target | tail -c 8 | $\n"
+                    "                   od -An -N4 -tu4 --endian=little | tr -d ' '` && $\n";
+        crc32Member = "              printf '\"crc32\":%s,\\n' \"$$crc32\" && $\n";
+    }
+
     script <<
         // Add a bundled file into the app's staging area.
         "rule BundleFile\n"
@@ -65,16 +78,10 @@ void AppBuildScriptGenerator_t::GenerateAppBuildRules
         "  description = Creating info.properties\n"
         // Delete the old info.properties file, if there is one.
         "  command = rm -f $out && $\n"
-        // Compute the MD5 checksum of the staging area.
-        // Don't follow symlinks (-P), and include the directory structure and the contents of
-        // symlinks as part of the MD5 hash.
-        "            md5=$$( ( cd $workingDir/staging && $\n"
-        "                      find -P -print0 |LC_ALL=C sort -z && $\n"
-        "                      find -P -type f -print0 |LC_ALL=C sort -z |xargs -0 md5sum && $\n"
-        "                      find -P -type l -print0 |LC_ALL=C sort -z"
-                             " |xargs -0 -r -n 1 readlink $\n"
-        "                    ) | md5sum) && $\n"
-        "            md5=$${md5%% *} && $\n"
+        // Compute the MD5 checksum of the staging area (see dirHash.h), only re-reading the
+        // files that have changed since the last build.
+        "            md5=`" << buildParams.argv[0] << " --md5-dir $workingDir/staging"
+                               " $workingDir/staging.md5cache` && $\n"
         // Generate the app's info.properties file.
         "            ( echo \"app.name=$name\" && $\n"
         "              echo \"app.md5=$$md5\" && $\n"
@@ -92,6 +99,7 @@ void AppBuildScriptGenerator_t::GenerateAppBuildRules
                         " -cjf - --mtime=$adefPath) > $workingDir/$name.$target && $\n"
         // Get the size of the tarball.
         "            tarballSize=`stat -c '%s' $workingDir/$name.$target` && $\n"
+        << crc32Step <<
         // Get the app's MD5 hash from its info.properties file.
         "            md5=`grep '^app.md5=' $in | sed 's/^app.md5=//'` && $\n"
         // Generate a JSON header and concatenate the tarball to it to create the update pack.
@@ -100,6 +108,7 @@ void AppBuildScriptGenerator_t::GenerateAppBuildRules
         "              printf '\"name\":\"$name\",\\n' && $\n"
         "              printf '\"version\":\"$version\",\\n' && $\n"
         "              printf '\"md5\":\"%s\",\\n' \"$$md5\" && $\n"
+        << crc32Member <<
         "              printf '\"size\":%s\\n' \"$$tarballSize\" && $\n"
         "              printf '}' && $\n"
         "              cat $workingDir/$name.$target $\n"
@@ -732,6 +741,9 @@ void AppBuildScriptGenerator_t::Generate
         GenerateAppBundleBuildStatement(appPtr, buildParams.outputDir);
     }
 
+    // Add the build statements for the IPC code generation queued above.
+    componentGeneratorPtr->GenerateIfgenBatchStatements();
+
     // Add a build statement for the build.ninja file itself.
     GenerateNinjaScriptBuildStatement(appPtr);
 }
@@ -749,11 +761,15 @@ void Generate
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating build script");
+
     std::string filePath = path::Minimize(buildParams.workingDir + "/build.ninja");
 
     AppBuildScriptGenerator_t appGenerator(filePath, buildParams);
 
     appGenerator.Generate(appPtr);
+
+    GenerateObjectMap(NULL, appPtr, NULL, buildParams);
 }
 
 
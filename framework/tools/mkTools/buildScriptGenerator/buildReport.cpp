@@ -0,0 +1,869 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file buildReport.cpp
+ *
+ * Works out where the time went in the last ninja build, in terms of the components, APIs,
+ * executables, apps and modules the build script was generated from.
+ *
+ * When a build script is generated, an object map is written next to it.  The map lists the
+ * directories (and a few individual files) that each model object's build outputs are put in.
+ * After a build, ninja's log gives the start and end time of each output built, and the build
+ * script itself gives the rule used to build it and the inputs it waited for.  Each output is
+ * attributed to the model object with the longest path in the map that contains the output.
+ *
+ * <hr>
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "mkTools.h"
+#include "buildScriptCommon.h"
+#include <iomanip>
+
+
+namespace ninja
+{
+
+
+/// Name of the object map file, in the working directory.
+#define OBJECT_MAP_FILE_NAME "build.objects"
+
+/// Name of the log file ninja writes in the build directory.
+#define NINJA_LOG_FILE_NAME ".ninja_log"
+
+/// Number of entries to print in each of the lists of top offenders.
+#define TOP_OFFENDER_COUNT 10
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A build statement in a build script, and how long it took in the last build.
+ */
+//--------------------------------------------------------------------------------------------------
+struct Edge_t
+{
+    std::string rule;                   ///< Name of the rule used.
+    std::vector<std::string> outputs;   ///< Absolute paths of the outputs.
+    std::vector<std::string> inputs;    ///< Absolute paths of the inputs, including implicit
+                                        ///  and order-only ones.
+    std::string objectName;             ///< Model object the outputs belong to ("" if unknown).
+
+    bool wasRun;                        ///< true if run by the last build.
+    long duration;                      ///< Time taken (ms), if run by the last build.
+
+    // Used when finding the critical path.
+    enum { UNVISITED, VISITING, VISITED } state;
+    long pathDuration;                  ///< Duration of the longest chain ending with this edge.
+    Edge_t* prevPtr;                    ///< Previous edge in that chain, or NULL if none.
+
+    Edge_t() : wasRun(false), duration(0), state(UNVISITED), pathDuration(0), prevPtr(NULL) {}
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the path ninja will see for a path written in a build script or object map.
+ *
+ * @return The absolute, minimized path.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string NormalizePath
+(
+    const std::string& filePath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return path::Minimize(path::MakeAbsolute(filePath));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add a model object's build outputs to an object map.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddObject
+(
+    std::map<std::string, std::string>& objectMap,  ///< Object names, by path.
+    const std::string& kind,                        ///< Kind of object (e.g., "component").
+    const std::string& name,                        ///< Object name.
+    const std::string& filePath,                    ///< Path, relative to the working directory
+                                                    ///  if not absolute.
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (filePath.empty())
+    {
+        return;
+    }
+
+    std::string fullPath = filePath;
+
+    if (!path::IsAbsolute(fullPath))
+    {
+        fullPath = path::Combine(buildParams.workingDir, fullPath);
+    }
+
+    objectMap[NormalizePath(fullPath)] = kind + " " + name;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add an executable's build outputs to an object map.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddExe
+(
+    std::map<std::string, std::string>& objectMap,
+    const model::Exe_t* exePtr,
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string name = exePtr->name;
+    std::string objDir;
+
+    if (exePtr->appPtr != NULL)
+    {
+        name = exePtr->appPtr->name + "/" + name;
+        objDir = path::Combine(exePtr->appPtr->workingDir, "obj/" + exePtr->name);
+    }
+    else
+    {
+        objDir = "obj/" + exePtr->name;
+    }
+
+    AddObject(objectMap, "exe", name, objDir, buildParams);
+    AddObject(objectMap, "exe", name, exePtr->path, buildParams);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Add an app's build outputs, including its executables, to an object map.
+ */
+//--------------------------------------------------------------------------------------------------
+static void AddApp
+(
+    std::map<std::string, std::string>& objectMap,
+    const model::App_t* appPtr,
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    AddObject(objectMap, "app", appPtr->name, appPtr->workingDir, buildParams);
+
+    for (auto& mapEntry : appPtr->executables)
+    {
+        AddExe(objectMap, mapEntry.second, buildParams);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the object map for a build script, for the build report to attribute build times to
+ * model objects with.  All the components and .api files modelled are included, along with the
+ * given system, app or stand-alone executable (any of which may be NULL).
+ *
+ * @throw mk::Exception_t if the file can't be written.
+ **/
+//--------------------------------------------------------------------------------------------------
+void GenerateObjectMap
+(
+    const model::System_t* systemPtr,
+    const model::App_t* appPtr,
+    const model::Exe_t* exePtr,
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::map<std::string, std::string> objectMap;
+
+    if (systemPtr != NULL)
+    {
+        AddObject(objectMap, "system", systemPtr->name, path::MakeAbsolute(buildParams.workingDir),
+                  buildParams);
+
+        for (auto& mapEntry : systemPtr->apps)
+        {
+            AddApp(objectMap, mapEntry.second, buildParams);
+        }
+
+        for (auto& mapEntry : systemPtr->modules)
+        {
+            AddObject(objectMap, "module", mapEntry.first, mapEntry.second->workingDir,
+                      buildParams);
+        }
+    }
+
+    if (appPtr != NULL)
+    {
+        AddApp(objectMap, appPtr, buildParams);
+
+        // The app's bundles are put in the output directory.
+        auto bundlePath = path::MakeAbsolute(path::Combine(buildParams.outputDir, appPtr->name))
+                        + "." + buildParams.target;
+
+        AddObject(objectMap, "app", appPtr->name, bundlePath + ".update", buildParams);
+        AddObject(objectMap, "app", appPtr->name, bundlePath + ".app", buildParams);
+    }
+
+    if (exePtr != NULL)
+    {
+        AddExe(objectMap, exePtr, buildParams);
+    }
+
+    for (auto& mapEntry : model::ApiFile_t::GetApiFileMap())
+    {
+        auto apiFilePtr = mapEntry.second;
+
+        AddObject(objectMap, "api", path::GetLastNode(apiFilePtr->path), apiFilePtr->codeGenDir,
+                  buildParams);
+    }
+
+    for (auto& mapEntry : model::Component_t::GetComponentMap())
+    {
+        auto componentPtr = mapEntry.second;
+
+        AddObject(objectMap, "component", componentPtr->name, componentPtr->workingDir,
+                  buildParams);
+
+        // The library may have been put in the library output directory instead.
+        if (componentPtr->HasCOrCppCode() || componentPtr->HasJavaCode())
+        {
+            auto infoPtr = componentPtr->getTargetInfo<target::LinuxComponentInfo_t>();
+
+            AddObject(objectMap, "component", componentPtr->name, path::MakeAbsolute(infoPtr->lib),
+                      buildParams);
+        }
+    }
+
+    std::string filePath = path::Combine(buildParams.workingDir, OBJECT_MAP_FILE_NAME);
+
+    std::ofstream mapFile(filePath, std::ofstream::trunc);
+
+    for (auto& mapEntry : objectMap)
+    {
+        mapFile << mapEntry.second << '\t' << mapEntry.first << '\n';
+    }
+
+    mapFile.close();
+
+    if (mapFile.fail())
+    {
+        throw mk::Exception_t(
+            mk::format(LE_I18N("Failed to write file '%s'."), filePath)
+        );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the object map written by GenerateObjectMap().  A missing map just gives an empty one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadObjectMap
+(
+    std::map<std::string, std::string>& objectMap,  ///< [OUT] Object names, by path.
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::ifstream mapFile(path::Combine(buildParams.workingDir, OBJECT_MAP_FILE_NAME));
+    std::string line;
+
+    while (std::getline(mapFile, line))
+    {
+        auto tabPos = line.find('\t');
+
+        if (tabPos != std::string::npos)
+        {
+            objectMap[line.substr(tabPos + 1)] = line.substr(0, tabPos);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the model object a build output belongs to.
+ *
+ * @return The object's name, or "" if it doesn't belong to any.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string FindObject
+(
+    const std::map<std::string, std::string>& objectMap,
+    std::string filePath                                    ///< Absolute path of the output.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    while (filePath.size() > 1)
+    {
+        auto i = objectMap.find(filePath);
+
+        if (i != objectMap.end())
+        {
+            return i->second;
+        }
+
+        filePath = path::GetContainingDir(filePath);
+    }
+
+    return "";
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Substitute the variables in a string from a build script, and remove the escapes.
+ *
+ * Only the file-level variables are known, which are all the build scripts use in paths.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string Expand
+(
+    const std::string& text,
+    const std::map<std::string, std::string>& variables
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string result;
+    size_t i = 0;
+
+    while (i < text.size())
+    {
+        char c = text[i++];
+
+        if ((c != '$') || (i == text.size()))
+        {
+            result += c;
+            continue;
+        }
+
+        std::string name;
+
+        if (text[i] == '{')
+        {
+            auto endPos = text.find('}', i);
+
+            if (endPos == std::string::npos)
+            {
+                endPos = text.size();
+            }
+
+            name = text.substr(i + 1, endPos - i - 1);
+            i = endPos + 1;
+        }
+        else if (isalnum(text[i]) || (text[i] == '_') || (text[i] == '-'))
+        {
+            while ((i < text.size()) && (isalnum(text[i]) || (text[i] == '_') || (text[i] == '-')))
+            {
+                name += text[i++];
+            }
+        }
+        else
+        {
+            // "$$", "$ " or "$:".
+            result += text[i++];
+            continue;
+        }
+
+        auto varIter = variables.find(name);
+
+        if (varIter != variables.end())
+        {
+            result += varIter->second;
+        }
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Split a build statement into its parts.  Escaped spaces and colons are left escaped, for
+ * Expand() to deal with.
+ *
+ * @return The outputs, ":", the rule, and the inputs, with the "|", "||" and "|@" separators.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::vector<std::string> SplitBuildStatement
+(
+    const std::string& line     ///< The statement, without "build ".
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::string> words;
+    std::string word;
+    bool seenColon = false;
+
+    for (size_t i = 0; i < line.size(); i++)
+    {
+        char c = line[i];
+
+        if ((c == '$') && (i + 1 < line.size()))
+        {
+            word += c;
+            word += line[++i];
+        }
+        else if ((c == ' ') || ((c == ':') && !seenColon))
+        {
+            if (!word.empty())
+            {
+                words.push_back(word);
+                word.clear();
+            }
+
+            if (c == ':')
+            {
+                words.push_back(":");
+                seenColon = true;
+            }
+        }
+        else
+        {
+            word += c;
+        }
+    }
+
+    if (!word.empty())
+    {
+        words.push_back(word);
+    }
+
+    return words;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the build statements from a build script.
+ *
+ * @throw mk::Exception_t if the script can't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadBuildScript
+(
+    std::list<Edge_t>& edges,       ///< [OUT] The build statements.
+    const std::string& filePath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::ifstream scriptFile(filePath);
+
+    if (!scriptFile.is_open())
+    {
+        throw mk::Exception_t(
+            mk::format(LE_I18N("Failed to open file '%s' for reading."), filePath)
+        );
+    }
+
+    std::map<std::string, std::string> variables;
+    std::string line;
+
+    while (std::getline(scriptFile, line))
+    {
+        // Join continued lines.  A line is continued if it ends with an odd number of '$'s.
+        for (;;)
+        {
+            auto dollarCount = line.size() - line.find_last_not_of('$') - 1;
+
+            if ((dollarCount % 2) == 0)
+            {
+                break;
+            }
+
+            std::string nextLine;
+
+            if (!std::getline(scriptFile, nextLine))
+            {
+                break;
+            }
+
+            line.pop_back();
+            line += nextLine.substr(std::min(nextLine.find_first_not_of(' '), nextLine.size()));
+        }
+
+        // Skip blank lines, comments and the variable bindings of rules and build statements.
+        if (line.empty() || (line[0] == '#') || (line[0] == ' '))
+        {
+            continue;
+        }
+
+        if (line.compare(0, 6, "build ") == 0)
+        {
+            Edge_t edge;
+            bool isInput = false;
+
+            for (auto& word : SplitBuildStatement(line.substr(6)))
+            {
+                if (word == ":")
+                {
+                    isInput = true;
+                }
+                else if (word == "|@")
+                {
+                    // Validations aren't needed before the outputs are built.
+                    break;
+                }
+                else if ((word == "|") || (word == "||"))
+                {
+                    continue;
+                }
+                else if (isInput && edge.rule.empty())
+                {
+                    edge.rule = word;
+                }
+                else if (isInput)
+                {
+                    edge.inputs.push_back(NormalizePath(Expand(word, variables)));
+                }
+                else
+                {
+                    edge.outputs.push_back(NormalizePath(Expand(word, variables)));
+                }
+            }
+
+            if (!edge.outputs.empty())
+            {
+                edges.push_back(edge);
+            }
+        }
+        else
+        {
+            // A file-level variable definition, or a rule, pool or default statement.
+            auto equalsPos = line.find('=');
+
+            if (   (equalsPos != std::string::npos)
+                && (line.compare(0, 5, "rule ") != 0)
+                && (line.compare(0, 5, "pool ") != 0)  )
+            {
+                auto name = line.substr(0, line.find_last_not_of(' ', equalsPos - 1) + 1);
+                auto valuePos = std::min(line.find_first_not_of(' ', equalsPos + 1), line.size());
+
+                variables[name] = Expand(line.substr(valuePos), variables);
+            }
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Read the times taken to build each output in the last build from ninja's log.
+ *
+ * Each build appends to the log, in the order the outputs were finished, with times measured in
+ * milliseconds from the start of that build.  So the last build's entries are those after the
+ * last point where the end times go backwards.
+ *
+ * @return false if there's no log.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadNinjaLog
+(
+    std::map<std::string, std::pair<long, long>>& times,   ///< [OUT] Start and end times (ms),
+                                                            ///  by absolute output path.
+    const std::string& filePath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::ifstream logFile(filePath);
+
+    if (!logFile.is_open())
+    {
+        return false;
+    }
+
+    std::string line;
+    long lastEndTime = 0;
+
+    while (std::getline(logFile, line))
+    {
+        // The header (e.g., "# ninja log v5") says which version of the log format this is.
+        // The fields used here are the same in all of them.
+        if (line.empty() || (line[0] == '#'))
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string startTime;
+        std::string endTime;
+        std::string modTime;
+        std::string outputPath;
+
+        if (   !std::getline(fields, startTime, '\t')
+            || !std::getline(fields, endTime, '\t')
+            || !std::getline(fields, modTime, '\t')
+            || !std::getline(fields, outputPath, '\t')  )
+        {
+            continue;
+        }
+
+        long start = strtol(startTime.c_str(), NULL, 10);
+        long end = strtol(endTime.c_str(), NULL, 10);
+
+        if (end < lastEndTime)
+        {
+            times.clear();
+        }
+
+        lastEndTime = end;
+        times[NormalizePath(outputPath)] = std::make_pair(start, end);
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the longest (by time taken) chain of edges run by the last build that ends with a given
+ * edge, where each edge in the chain needs an output of the one before it.
+ */
+//--------------------------------------------------------------------------------------------------
+static void FindLongestPath
+(
+    Edge_t* edgePtr,
+    const std::map<std::string, Edge_t*>& producers     ///< Edges run, by output path.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (edgePtr->state != Edge_t::UNVISITED)
+    {
+        // If VISITING, there's a cycle, which ninja wouldn't have built.  Stop here anyway.
+        return;
+    }
+
+    edgePtr->state = Edge_t::VISITING;
+
+    for (auto& input : edgePtr->inputs)
+    {
+        auto i = producers.find(input);
+
+        if (i == producers.end())
+        {
+            continue;
+        }
+
+        auto inputEdgePtr = i->second;
+
+        FindLongestPath(inputEdgePtr, producers);
+
+        if (   (inputEdgePtr->state == Edge_t::VISITED)
+            && (   (edgePtr->prevPtr == NULL)
+                || (inputEdgePtr->pathDuration > edgePtr->prevPtr->pathDuration)  )  )
+        {
+            edgePtr->prevPtr = inputEdgePtr;
+        }
+    }
+
+    edgePtr->pathDuration = edgePtr->duration;
+
+    if (edgePtr->prevPtr != NULL)
+    {
+        edgePtr->pathDuration += edgePtr->prevPtr->pathDuration;
+    }
+
+    edgePtr->state = Edge_t::VISITED;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print the names with the longest total times in a table of total times and step counts.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintTopOffenders
+(
+    std::ostream& outputStream,
+    const std::string& title,
+    const std::map<std::string, std::pair<long, size_t>>& totals    ///< Time (ms) and number
+                                                                    ///  of steps, by name.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::vector<std::pair<std::string, std::pair<long, size_t>>> sorted(totals.begin(),
+                                                                        totals.end());
+
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const std::pair<std::string, std::pair<long, size_t>>& a,
+                        const std::pair<std::string, std::pair<long, size_t>>& b)
+                     {
+                         return a.second.first > b.second.first;
+                     });
+
+    if (sorted.size() > TOP_OFFENDER_COUNT)
+    {
+        sorted.resize(TOP_OFFENDER_COUNT);
+    }
+
+    outputStream << std::endl << title << std::endl;
+
+    for (auto& entry : sorted)
+    {
+        outputStream << "  " << std::setw(10) << entry.second.first << " ms"
+                     << "  " << std::left << std::setw(8)
+                     << ("(x" + std::to_string(entry.second.second) + ")")
+                     << std::right << entry.first << std::endl;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print a report on the last ninja build run on the build script in the working directory:
+ * its critical path, and the model objects, rules and steps that took the most time.
+ *
+ * @throw mk::Exception_t if the build script can't be read.
+ **/
+//--------------------------------------------------------------------------------------------------
+void PrintReport
+(
+    const mk::BuildParams_t& buildParams,
+    std::ostream& outputStream
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::list<Edge_t> edges;
+    ReadBuildScript(edges, path::Combine(buildParams.workingDir, "build.ninja"));
+
+    // ninja keeps its log in the build directory, which is the working directory.
+    std::map<std::string, std::pair<long, long>> times;
+    auto logPath = path::Combine(buildParams.workingDir, NINJA_LOG_FILE_NAME);
+
+    if (!ReadNinjaLog(times, logPath))
+    {
+        outputStream << mk::format(LE_I18N("No ninja log found at '%s'."), logPath) << std::endl;
+        return;
+    }
+
+    std::map<std::string, std::string> objectMap;
+    ReadObjectMap(objectMap, buildParams);
+
+    // Find out which edges were run, how long they took, and what they belong to.
+    std::map<std::string, Edge_t*> producers;
+    std::map<std::string, std::pair<long, size_t>> objectTotals;
+    std::map<std::string, std::pair<long, size_t>> ruleTotals;
+    std::vector<Edge_t*> edgesRun;
+    long totalDuration = 0;
+    long elapsedTime = 0;
+
+    for (auto& edge : edges)
+    {
+        for (auto& output : edge.outputs)
+        {
+            auto i = times.find(output);
+
+            if (i != times.end())
+            {
+                edge.wasRun = true;
+                edge.duration = std::max(edge.duration, i->second.second - i->second.first);
+                elapsedTime = std::max(elapsedTime, i->second.second);
+            }
+        }
+
+        if (!edge.wasRun)
+        {
+            continue;
+        }
+
+        edge.objectName = FindObject(objectMap, edge.outputs.front());
+
+        if (edge.objectName.empty())
+        {
+            edge.objectName = LE_I18N("(other)");
+        }
+
+        for (auto& output : edge.outputs)
+        {
+            producers[output] = &edge;
+        }
+
+        objectTotals[edge.objectName].first += edge.duration;
+        objectTotals[edge.objectName].second++;
+        ruleTotals[edge.rule].first += edge.duration;
+        ruleTotals[edge.rule].second++;
+        totalDuration += edge.duration;
+        edgesRun.push_back(&edge);
+    }
+
+    outputStream << std::endl
+                 << mk::format(LE_I18N("Build report: %zu steps run, taking %ld ms in total,"
+                                       " %ld ms elapsed."),
+                               edgesRun.size(), totalDuration, elapsedTime)
+                 << std::endl;
+
+    if (edgesRun.empty())
+    {
+        return;
+    }
+
+    // Find the end of the longest chain of dependent steps.
+    Edge_t* lastEdgePtr = NULL;
+
+    for (auto edgePtr : edgesRun)
+    {
+        FindLongestPath(edgePtr, producers);
+
+        if ((lastEdgePtr == NULL) || (edgePtr->pathDuration > lastEdgePtr->pathDuration))
+        {
+            lastEdgePtr = edgePtr;
+        }
+    }
+
+    std::list<Edge_t*> criticalPath;
+
+    for (auto edgePtr = lastEdgePtr; edgePtr != NULL; edgePtr = edgePtr->prevPtr)
+    {
+        criticalPath.push_front(edgePtr);
+    }
+
+    outputStream << std::endl
+                 << mk::format(LE_I18N("Critical path (%ld ms):"), lastEdgePtr->pathDuration)
+                 << std::endl;
+
+    for (auto edgePtr : criticalPath)
+    {
+        outputStream << "  " << std::setw(10) << edgePtr->duration << " ms"
+                     << "  " << std::left << std::setw(24) << edgePtr->rule
+                     << " " << std::setw(32) << edgePtr->objectName << std::right
+                     << " " << path::GetLastNode(edgePtr->outputs.front()) << std::endl;
+    }
+
+    PrintTopOffenders(outputStream, LE_I18N("Slowest components, APIs, executables and apps:"),
+                      objectTotals);
+
+    PrintTopOffenders(outputStream, LE_I18N("Slowest rules:"), ruleTotals);
+
+    std::stable_sort(edgesRun.begin(), edgesRun.end(),
+                     [](const Edge_t* aPtr, const Edge_t* bPtr)
+                     {
+                         return aPtr->duration > bPtr->duration;
+                     });
+
+    if (edgesRun.size() > TOP_OFFENDER_COUNT)
+    {
+        edgesRun.resize(TOP_OFFENDER_COUNT);
+    }
+
+    outputStream << std::endl << LE_I18N("Slowest steps:") << std::endl;
+
+    for (auto edgePtr : edgesRun)
+    {
+        outputStream << "  " << std::setw(10) << edgePtr->duration << " ms"
+                     << "  " << std::left << std::setw(24) << edgePtr->rule
+                     << " " << std::setw(32) << edgePtr->objectName << std::right
+                     << " " << path::GetLastNode(edgePtr->outputs.front()) << std::endl;
+    }
+}
+
+
+} // namespace ninja
@@ -324,10 +324,14 @@ void BuildScriptGenerator_t::GenerateBuildRules
     script << "            $externalCommand\n"
               "\n";
 
-    // Generate a rule for running ifgen.
+    // Generate a rule for running a batch of ifgen jobs in one ifgen process.  ifgen doesn't
+    // touch generated files that haven't changed, so check which outputs really did change.
     script << "rule GenInterfaceCode\n"
               "  description = Generating IPC interface code\n"
-              "  command = ifgen --output-dir $outputDir $ifgenFlags $in\n"
+              "  command = ifgen --batch $batchFile\n"
+              "  rspfile = $batchFile\n"
+              "  rspfile_content = $ifgenJobs\n"
+              "  restat = 1\n"
               "\n";
 
     // Generate a rule for copying a file.
@@ -51,6 +51,23 @@ std::string EscapeString
     const std::string &str
 );
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write the object map for a build script, for the build report to attribute build times to
+ * model objects with.  All the components and .api files modelled are included, along with the
+ * given system, app or stand-alone executable (any of which may be NULL).
+ *
+ * @throw mk::Exception_t if the file can't be written.
+ **/
+//--------------------------------------------------------------------------------------------------
+void GenerateObjectMap
+(
+    const model::System_t* systemPtr,
+    const model::App_t* appPtr,
+    const model::Exe_t* exePtr,
+    const mk::BuildParams_t& buildParams
+);
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Generic build script generator.
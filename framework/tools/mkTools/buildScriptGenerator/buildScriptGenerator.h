@@ -21,6 +21,10 @@
  * those things to be done before the scripts are run.  The ninja scripts will run ifgen to
  * generate interface code, though.
  *
+ * Each script is accompanied by an object map, listing which component, API, executable, app, etc.
+ * each directory of build outputs belongs to.  After a build, ninja::PrintReport() uses it, along
+ * with the script and ninja's log, to report where the build time went.
+ *
  * Each script includes a rule to check that none of the definition files that it is generated
  * from have been changed.  If they have, the script will delete itself and run the appropriate
  * mktool to regenerate itself.
@@ -99,6 +103,21 @@ void Generate
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Print a report on the last ninja build run on the build script in the working directory:
+ * its critical path, and the model objects, rules and steps that took the most time.
+ *
+ * @throw mk::Exception_t if the build script can't be read.
+ **/
+//--------------------------------------------------------------------------------------------------
+void PrintReport
+(
+    const mk::BuildParams_t& buildParams,
+    std::ostream& outputStream
+);
+
+
 } // namespace ninja
 
 #endif // LEGATO_NINJA_SCRIPT_GENERATOR_H_INCLUDE_GUARD
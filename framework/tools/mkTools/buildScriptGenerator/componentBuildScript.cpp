@@ -818,22 +818,129 @@ void ComponentBuildScriptGenerator_t::GenerateBuildStatements
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Write out to a given script file a space-separated list of paths to all the .api files needed
- * by a given .api file (specified through USETYPES statements in the .api files).
+ * Add to a given set the paths to all the .api files needed by a given .api file (specified
+ * through USETYPES statements in the .api files).
  **/
 //--------------------------------------------------------------------------------------------------
 void ComponentBuildScriptGenerator_t::GetIncludedApis
 (
+    std::set<std::string>& result,
     const model::ApiFile_t* apiFilePtr
 )
 //--------------------------------------------------------------------------------------------------
 {
     for (auto includedApiPtr : apiFilePtr->includes)
     {
-        script << " " << includedApiPtr->path;
+        result.insert(includedApiPtr->path);
 
         // Recurse.
-        GetIncludedApis(includedApiPtr);
+        GetIncludedApis(result, includedApiPtr);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Queue an ifgen run that generates a given set of files from a given .api file.  The queued runs
+ * are written to the script as batched build statements by GenerateIfgenBatchStatements().
+ **/
+//--------------------------------------------------------------------------------------------------
+void ComponentBuildScriptGenerator_t::AddIfgenJob
+(
+    const std::string& outputFiles,     ///< Space-separated paths of the generated files.
+    const model::ApiFile_t* apiFilePtr,
+    const std::string& ifgenFlags,
+    const std::string& outputDir
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The callers build their lists with a separator before or after each item.
+    auto trim = [](const std::string& str)
+    {
+        auto start = str.find_first_not_of(' ');
+
+        if (start == std::string::npos)
+        {
+            return std::string();
+        }
+
+        return str.substr(start, str.find_last_not_of(' ') - start + 1);
+    };
+
+    ifgenJobs.push_back({ trim(outputFiles), apiFilePtr, trim(ifgenFlags), outputDir });
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Write to the script the build statements for all the queued ifgen runs.
+ *
+ * Rather than a build statement per run, each starting its own ifgen process that parses the .api
+ * file and everything it imports over again, runs are grouped into batches that are each done by
+ * one ifgen process.  Runs for the same .api file are kept together, so that it's parsed only
+ * once.  The batches are kept small enough that ninja can still run several of them at once.
+ *
+ * ifgen leaves generated files untouched when their contents don't change, so rebuilding a batch
+ * because one of its .api files changed only rebuilds what depends on that .api file.
+ **/
+//--------------------------------------------------------------------------------------------------
+void ComponentBuildScriptGenerator_t::GenerateIfgenBatchStatements
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Maximum number of ifgen runs in one batch.
+    const size_t maxBatchSize = 32;
+
+    ifgenJobs.sort([](const IfgenJob_t& a, const IfgenJob_t& b)
+                   {
+                       return a.apiFilePtr->path < b.apiFilePtr->path;
+                   });
+
+    while (!ifgenJobs.empty())
+    {
+        std::string outputFiles;
+        std::string jobs;
+        std::list<std::string> apiFiles;
+        std::set<std::string> includedApis;
+        size_t batchSize = 0;
+
+        while ((!ifgenJobs.empty()) && (batchSize < maxBatchSize))
+        {
+            const IfgenJob_t& job = ifgenJobs.front();
+
+            outputFiles += " " + job.outputFiles;
+            jobs += " $\n      --job --output-dir " + job.outputDir + " " + job.ifgenFlags +
+                    " $ifgenFlags " + job.apiFilePtr->path;
+
+            if (apiFiles.empty() || (apiFiles.back() != job.apiFilePtr->path))
+            {
+                apiFiles.push_back(job.apiFilePtr->path);
+            }
+            GetIncludedApis(includedApis, job.apiFilePtr);
+
+            ifgenJobs.pop_front();
+            batchSize++;
+        }
+
+        script << "build" << outputFiles << ": GenInterfaceCode";
+        for (const auto& apiFile : apiFiles)
+        {
+            script << " " << apiFile;
+        }
+        if (!includedApis.empty())
+        {
+            script << " |";
+            for (const auto& apiFile : includedApis)
+            {
+                script << " " << apiFile;
+            }
+        }
+        script << "\n"
+                  "  batchFile = $builddir/ifgenBatch" << ifgenBatchCount++ << ".rsp\n"
+                  "  ifgenJobs =" << jobs << "\n"
+                  "\n";
     }
 }
 
@@ -857,15 +964,10 @@ void ComponentBuildScriptGenerator_t::GenerateTypesOnlyBuildStatement
     {
         generatedIPC.insert(cFiles.interfaceFile);
 
-        script << "build $builddir/" << cFiles.interfaceFile << ":"
-                  " GenInterfaceCode " << ifPtr->apiFilePtr->path << " |";
-        GetIncludedApis(ifPtr->apiFilePtr);
-        script << "\n"
-                  "  ifgenFlags = --gen-interface"
-                  " --name-prefix " << ifPtr->internalName <<
-                  " $ifgenFlags\n"
-                  "  outputDir = $builddir/" << path::GetContainingDir(cFiles.interfaceFile) << "\n"
-                  "\n";
+        AddIfgenJob("$builddir/" + cFiles.interfaceFile,
+                    ifPtr->apiFilePtr,
+                    "--gen-interface --name-prefix " + ifPtr->internalName,
+                    "$builddir/" + path::GetContainingDir(cFiles.interfaceFile));
     }
 }
 
@@ -889,16 +991,10 @@ void ComponentBuildScriptGenerator_t::GenerateJavaTypesOnlyBuildStatement
     {
         generatedIPC.insert(javaFiles.interfaceSourceFile);
 
-        script << "build " <<
-                  path::Combine(buildParams.workingDir, javaFiles.interfaceSourceFile) << ":"
-                  " GenInterfaceCode " << ifPtr->apiFilePtr->path << " |";
-        GetIncludedApis(ifPtr->apiFilePtr);
-        script << "\n"
-                  "  ifgenFlags = --gen-interface --lang Java"
-                  " --name-prefix " << ifPtr->internalName << " $ifgenFlags\n"
-                  "  outputDir = $builddir/" <<
-                  path::Combine(ifPtr->componentPtr->workingDir, "src") << "\n"
-                  "\n";
+        AddIfgenJob(path::Combine(buildParams.workingDir, javaFiles.interfaceSourceFile),
+                    ifPtr->apiFilePtr,
+                    "--gen-interface --lang Java --name-prefix " + ifPtr->internalName,
+                    "$builddir/" + path::Combine(ifPtr->componentPtr->workingDir, "src"));
     }
 }
 
@@ -922,13 +1018,10 @@ void ComponentBuildScriptGenerator_t::GenerateClientUsetypesBuildStatement
     {
         generatedIPC.insert(headerFile);
 
-        script << "build $builddir/" << headerFile <<
-                  ": GenInterfaceCode " << apiFilePtr->path << " |";
-        GetIncludedApis(apiFilePtr);
-        script << "\n"
-                  "  outputDir = $builddir/" << path::GetContainingDir(headerFile) << "\n"
-                  "  ifgenFlags = --gen-interface $ifgenFlags\n"
-                  "\n";
+        AddIfgenJob("$builddir/" + headerFile,
+                    apiFilePtr,
+                    "--gen-interface",
+                    "$builddir/" + path::GetContainingDir(headerFile));
     }
 }
 
@@ -952,13 +1045,10 @@ void ComponentBuildScriptGenerator_t::GenerateServerUsetypesBuildStatement
     {
         generatedIPC.insert(headerFile);
 
-        script << "build $builddir/" << headerFile <<
-                  ": GenInterfaceCode " << apiFilePtr->path << " |";
-        GetIncludedApis(apiFilePtr);
-        script << "\n"
-                  "  outputDir = $builddir/" << path::GetContainingDir(headerFile) << "\n"
-                  "  ifgenFlags = --gen-server-interface $ifgenFlags\n"
-                  "\n";
+        AddIfgenJob("$builddir/" + headerFile,
+                    apiFilePtr,
+                    "--gen-server-interface",
+                    "$builddir/" + path::GetContainingDir(headerFile));
     }
 }
 
@@ -981,14 +1071,10 @@ void ComponentBuildScriptGenerator_t::GenerateJavaUsetypesBuildStatement
     if (generatedIPC.find(interfaceFile) == generatedIPC.end())
     {
         generatedIPC.insert(interfaceFile);
-        script << "build " << path::Combine(buildParams.workingDir, interfaceFile) <<
-                  ": GenInterfaceCode " << apiFilePtr->path << " |";
-        GetIncludedApis(apiFilePtr);
-        script << "\n"
-                  "  outputDir = $builddir/" <<
-                  path::Combine(apiFilePtr->codeGenDir, "src") << "\n"
-                  "  ifgenFlags = --gen-interface --lang Java $ifgenFlags\n"
-                  "\n";
+        AddIfgenJob(path::Combine(buildParams.workingDir, interfaceFile),
+                    apiFilePtr,
+                    "--gen-interface --lang Java",
+                    "$builddir/" + path::Combine(apiFilePtr->codeGenDir, "src"));
     }
 }
 
@@ -1072,12 +1158,10 @@ void ComponentBuildScriptGenerator_t::GenerateCBuildStatement
     if (!generatedFiles.empty())
     {
         ifgenFlags += " --name-prefix " + ifPtr->internalName;
-        script << "build" << generatedFiles <<
-                  ": GenInterfaceCode " << ifPtr->apiFilePtr->path << " |";
-        GetIncludedApis(ifPtr->apiFilePtr);
-        script << "\n"
-                  "  ifgenFlags =" << ifgenFlags << " $ifgenFlags\n"
-                  "  outputDir = $builddir/" << path::GetContainingDir(cFiles.sourceFile) << "\n\n";
+        AddIfgenJob(generatedFiles,
+                    ifPtr->apiFilePtr,
+                    ifgenFlags,
+                    "$builddir/" + path::GetContainingDir(cFiles.sourceFile));
     }
 }
 
@@ -1120,17 +1204,14 @@ void ComponentBuildScriptGenerator_t::GenerateJavaBuildStatement
         requiredFlags += " " + apiFlag;
     }
 
-    script << "build " << generatedFiles << ": $\n"
-              "      GenInterfaceCode " << apiFilePtr->path << " | ";
-
-    GetIncludedApis(apiFilePtr);
-
-    script << "\n"
-              "  ifgenFlags = --lang Java" << requiredFlags << " --name-prefix "
-           << internalName << " $ifgenFlags\n"
-              "  outputDir = " << path::Combine(buildParams.workingDir,
-                                                path::Combine(componentPtr->workingDir, "src"))
-           << "\n\n";
+    if (!generatedFiles.empty())
+    {
+        AddIfgenJob(generatedFiles,
+                    apiFilePtr,
+                    "--lang Java" + requiredFlags + " --name-prefix " + internalName,
+                    path::Combine(buildParams.workingDir,
+                                  path::Combine(componentPtr->workingDir, "src")));
+    }
 }
 
 
@@ -1240,13 +1321,10 @@ void ComponentBuildScriptGenerator_t::GenerateCBuildStatement
             ifgenFlags += " --async-server";
         }
         ifgenFlags += " --name-prefix " + ifPtr->internalName;
-        script << "build" << generatedFiles << ":"
-                  " GenInterfaceCode " << ifPtr->apiFilePtr->path << " |";
-        GetIncludedApis(ifPtr->apiFilePtr);
-        script << "\n"
-                  "  ifgenFlags =" << ifgenFlags << " $ifgenFlags\n"
-                  "  outputDir = $builddir/" << path::GetContainingDir(cFiles.sourceFile) << "\n"
-                  "\n";
+        AddIfgenJob(generatedFiles,
+                    ifPtr->apiFilePtr,
+                    ifgenFlags,
+                    "$builddir/" + path::GetContainingDir(cFiles.sourceFile));
     }
 }
 
@@ -1502,6 +1580,7 @@ void ComponentBuildScriptGenerator_t::Generate
 
     // Add build statements for all the IPC interfaces' generated files.
     GenerateIpcBuildStatements(componentPtr);
+    GenerateIfgenBatchStatements();
 
     // Add a build statement for the build.ninja file itself.
     GenerateNinjaScriptBuildStatement(componentPtr);
@@ -1520,11 +1599,15 @@ void Generate
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating build script");
+
     std::string filePath = path::Combine(buildParams.workingDir, "build.ninja");
 
     ComponentBuildScriptGenerator_t componentGenerator(filePath, buildParams);
 
     componentGenerator.Generate(componentPtr);
+
+    GenerateObjectMap(NULL, NULL, NULL, buildParams);
 }
 
 
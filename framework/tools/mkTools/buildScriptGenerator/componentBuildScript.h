@@ -20,9 +20,21 @@ class ComponentBuildScriptGenerator_t : protected RequireBaseGenerator_t
     friend struct RequireBaseGenerator_t;
     friend struct RequireComponentGenerator_t;
 
+    protected:
+        /// An ifgen run waiting to be written to the script as part of a batch.
+        struct IfgenJob_t
+        {
+            std::string outputFiles;
+            const model::ApiFile_t* apiFilePtr;
+            std::string ifgenFlags;
+            std::string outputDir;
+        };
+
     protected:
         std::set<std::string> generatedComponents;
         std::set<std::string> generatedIPC;
+        std::list<IfgenJob_t> ifgenJobs;
+        unsigned int ifgenBatchCount = 0;
     protected:
         virtual void GetImplicitDependencies(model::Component_t* componentPtr);
         virtual void GetExternalDependencies(model::Component_t* componentPtr);
@@ -32,7 +44,12 @@ class ComponentBuildScriptGenerator_t : protected RequireBaseGenerator_t
         virtual void GetJavaInterfaceFiles(std::list<std::string>& result,
                                            model::Component_t* componentPtr);
 
-        virtual void GetIncludedApis(const model::ApiFile_t* apiFilePtr);
+        virtual void GetIncludedApis(std::set<std::string>& result,
+                                     const model::ApiFile_t* apiFilePtr);
+        virtual void AddIfgenJob(const std::string& outputFiles,
+                                 const model::ApiFile_t* apiFilePtr,
+                                 const std::string& ifgenFlags,
+                                 const std::string& outputDir);
 
         virtual void GenerateTypesOnlyBuildStatement(const model::ApiTypesOnlyInterface_t* ifPtr);
         virtual void GenerateJavaTypesOnlyBuildStatement(const model::ApiTypesOnlyInterface_t* ifPtr);
@@ -96,6 +113,7 @@ class ComponentBuildScriptGenerator_t : protected RequireBaseGenerator_t
         virtual void GenerateBuildStatements(model::Component_t* componentPtr);
         virtual void GenerateBuildStatementsRecursive(model::Component_t* componentPtr);
         virtual void GenerateIpcBuildStatements(model::Component_t* componentPtr);
+        virtual void GenerateIfgenBatchStatements(void);
 
         virtual ~ComponentBuildScriptGenerator_t() {}
 };
@@ -465,6 +465,7 @@ void ExeBuildScriptGenerator_t::Generate
 
     // Add build statements for all the IPC interfaces' generated files.
     GenerateIpcBuildStatements(exePtr);
+    componentGeneratorPtr->GenerateIfgenBatchStatements();
 
     // Add a build statement for the build.ninja file itself.
     GenerateNinjaScriptBuildStatement(exePtr);
@@ -485,11 +486,15 @@ void Generate
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating build script");
+
     std::string filePath = path::Minimize(buildParams.workingDir + "/build.ninja");
 
     ExeBuildScriptGenerator_t scriptGenerator(filePath, buildParams);
 
     scriptGenerator.Generate(exePtr);
+
+    GenerateObjectMap(NULL, NULL, exePtr, buildParams);
 }
 
 
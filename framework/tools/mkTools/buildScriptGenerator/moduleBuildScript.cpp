@@ -204,6 +204,8 @@ void Generate
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating build script");
+
     std::string filePath = path::Minimize(buildParams.workingDir + "/build.ninja");
 
     ModuleBuildScriptGenerator_t scriptGenerator(filePath, buildParams);
@@ -65,10 +65,12 @@ void SystemBuildScriptGenerator_t::GenerateSystemBuildRules
     // Copy the framework bin and lib directories into the system's staging area.
     "            mkdir -p $stagingDir/bin && $\n"
     "            mkdir -p $stagingDir/lib && $\n"
+    // Keep their modification times, so their cached MD5 hashes can be used (see below).
     "            find $$LEGATO_ROOT/build/$target/framework/bin/* -type d -prune -o"
-                                  " -print | xargs cp -P -t $stagingDir/bin && $\n"
+                " -print | xargs cp -P --preserve=timestamps -t $stagingDir/bin && $\n"
     "            find $$LEGATO_ROOT/build/$target/framework/lib/* -type d -prune -o"
-                       " \\( -type f -o -type l \\) -print | xargs cp -P -t $stagingDir/lib && $\n"
+                " \\( -type f -o -type l \\) -print"
+                " | xargs cp -P --preserve=timestamps -t $stagingDir/lib && $\n"
 
     // Create modules directory and copy kernel modules into it
     "            mkdir -p $stagingDir/modules && $\n"
@@ -124,15 +126,11 @@ void SystemBuildScriptGenerator_t::GenerateSystemBuildRules
     // Delete the old info.properties file, if there is one.
     "            rm -f $stagingDir/info.properties && $\n"
 
-    // Compute the MD5 checksum of the staging area.
-    // Don't follow symlinks (-P), and include the directory structure and the contents of symlinks
-    // as part of the MD5 hash.
-    "            md5=$$( ( cd $stagingDir && $\n"
-    "                      find -P -print0 |LC_ALL=C sort -z && $\n"
-    "                      find -P -type f -print0 |LC_ALL=C sort -z |xargs -0 md5sum && $\n"
-    "                      find -P -type l -print0 |LC_ALL=C sort -z |xargs -0 -r -n 1 readlink $\n"
-    "                    ) | md5sum) && $\n"
-    "            md5=$${md5%% *} && $\n"
+    // Compute the MD5 checksum of the staging area (see dirHash.h), only re-reading the files
+    // that have changed since the last build.  The apps are included as symlinks named after their
+    // own MD5 hashes, so their contents aren't read again here.
+    "            md5=`" << buildParams.argv[0] << " --md5-dir $stagingDir"
+                       " $builddir/staging.md5cache` && $\n"
 
     // Get the Legato framework version and append the MD5 sum to it to get the system version.
     "           frameworkVersion=$$( cat $$LEGATO_ROOT/version ) && $\n"
@@ -151,8 +149,20 @@ void SystemBuildScriptGenerator_t::GenerateSystemBuildRules
                  " --mtime=" << systemPtr->defFilePtr->path << " -C $stagingDir . && $\n"
 
     // Get the size of the tarball.
-    "            tarballSize=`stat -c '%s' $builddir/" << systemPtr->name << ".$target` && $\n"
+    "            tarballSize=`stat -c '%s' $builddir/" << systemPtr->name << ".$target` && $\n";
 
+    // Only put the CRC32 of the tarball in the update pack header if asked to, because older
+    // targets reject update packs with unknown header members.
+    if (buildParams.updateCrc32)
+    {
+        script <<
+        // Get the CRC32 of the tarball (from the trailer of a gzip stream), so the target can
+        // verify the payload while it is unpacking it.
+        "            crc32=`gzip -1 -c $builddir/" << systemPtr->name << ".$target | tail -c 8 | "
+                                            "od -An -N4 -tu4 --endian=little | tr -d ' '` && $\n";
+    }
+
+    script <<
     // Get the app's MD5 hash from its info.properties file.
     "            md5=`grep '^system.md5=' $stagingDir/info.properties | "
                                                                     "sed 's/^system.md5=//'` && $\n"
@@ -160,7 +170,15 @@ void SystemBuildScriptGenerator_t::GenerateSystemBuildRules
     // to create the system update pack.
     "            ( printf '{\\n' && $\n"
     "              printf '\"command\":\"updateSystem\",\\n' && $\n"
-    "              printf '\"md5\":\"%s\",\\n' \"$$md5\" && $\n"
+    "              printf '\"md5\":\"%s\",\\n' \"$$md5\" && $\n";
+
+    if (buildParams.updateCrc32)
+    {
+        script <<
+        "              printf '\"crc32\":%s,\\n' \"$$crc32\" && $\n";
+    }
+
+    script <<
     "              printf '\"size\":%s\\n' \"$$tarballSize\" && $\n"
     "              printf '}' && $\n"
     "              cat $builddir/" << systemPtr->name << ".$target && $\n"
@@ -373,6 +391,9 @@ void SystemBuildScriptGenerator_t::Generate
             componentGeneratorPtr->GenerateIpcBuildStatements(mapEntry.second);
         }
 
+        // Add the build statements for the IPC code generation queued above.
+        componentGeneratorPtr->GenerateIfgenBatchStatements();
+
         // Generate build statement for packing everything into a system update pack.
         GenerateSystemPackBuildStatement(systemPtr);
     }
@@ -393,11 +414,15 @@ void Generate
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating build script");
+
     std::string filePath = path::Minimize(buildParams.workingDir + "/build.ninja");
 
     SystemBuildScriptGenerator_t systemGenerator(filePath, buildParams);
 
     systemGenerator.Generate(systemPtr);
+
+    GenerateObjectMap(systemPtr, NULL, NULL, buildParams);
 }
 
 
@@ -26,7 +26,13 @@ int main(int argc, const char** argv)
     {
         std::string fileName = path::GetLastNode(argv[0]);
 
-        if (fileName == "mkexe")
+        // The build scripts run the tool that generated them with "--md5-dir <dir> <cache file>"
+        // to compute the MD5 hash of an app's or system's staging area.
+        if ((argc == 4) && (strcmp(argv[1], "--md5-dir") == 0))
+        {
+            std::cout << dirHash::Compute(argv[2], argv[3]) << std::endl;
+        }
+        else if (fileName == "mkexe")
         {
             cli::MakeExecutable(argc, argv);
         }
@@ -10,6 +10,8 @@
 #include "mkCommon.h"
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
 
 
 namespace
@@ -259,6 +261,100 @@ void FindToolChain
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Run ninja in a child process, wait for it to finish, then print a report on where the build
+ * time went and exit with ninja's exit code.  Never returns.
+ *
+ * @throw mk::Exception_t if ninja can't be run.
+ */
+//--------------------------------------------------------------------------------------------------
+static void RunNinjaAndReport
+(
+    const std::vector<const char*>& ninjaArgs,  ///< Arguments, including the NULL terminator.
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // The child process writes the errno from a failed exec to this pipe, which is closed without
+    // anything being written to it when the exec succeeds.
+    int errorPipe[2];
+
+    if (pipe2(errorPipe, O_CLOEXEC) != 0)
+    {
+        int errCode = errno;
+
+        throw mk::Exception_t(
+            mk::format(LE_I18N("Failed to create pipe (%s)."), strerror(errCode))
+        );
+    }
+
+    std::cout.flush();
+
+    pid_t pid = fork();
+
+    if (pid < 0)
+    {
+        int errCode = errno;
+
+        throw mk::Exception_t(
+            mk::format(LE_I18N("Failed to fork process for ninja (%s)."), strerror(errCode))
+        );
+    }
+
+    if (pid == 0)
+    {
+        close(errorPipe[0]);
+
+        (void)execvp("ninja", const_cast<char* const*>(ninjaArgs.data()));
+
+        int errCode = errno;
+        (void)write(errorPipe[1], &errCode, sizeof(errCode));
+        _exit(EXIT_FAILURE);
+    }
+
+    close(errorPipe[1]);
+
+    int errCode;
+    ssize_t bytesRead;
+
+    do
+    {
+        bytesRead = read(errorPipe[0], &errCode, sizeof(errCode));
+    }
+    while ((bytesRead < 0) && (errno == EINTR));
+
+    close(errorPipe[0]);
+
+    int status;
+
+    while ((waitpid(pid, &status, 0) < 0) && (errno == EINTR))
+    {
+    }
+
+    if (bytesRead == sizeof(errCode))
+    {
+        throw mk::Exception_t(
+            mk::format(LE_I18N("Failed to execute ninja (%s)."), strerror(errCode))
+        );
+    }
+
+    // A report on a failed build is still useful, as far as the build went.
+    try
+    {
+        ninja::PrintReport(buildParams, std::cout);
+    }
+    catch (mk::Exception_t& e)
+    {
+        std::cerr << mk::format(LE_I18N("** Warning: Failed to produce build report: %s"),
+                                e.what())
+                  << std::endl;
+    }
+
+    exit(WIFEXITED(status) ? WEXITSTATUS(status) : EXIT_FAILURE);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Run the Ninja build tool.  Executes the build.ninja script in the root of the working directory
@@ -280,30 +376,30 @@ void RunNinja
 
     if (file::FileExists(ninjaFilePath))
     {
+        std::vector<const char*> ninjaArgs = { "ninja" };
+
         if (buildParams.beVerbose)
         {
             std::cout << LE_I18N("Executing ninja build system...") << std::endl;
             std::cout << mk::format(LE_I18N("$ ninja -v -d explain -f %s"), ninjaFilePath)
                       << std::endl;
 
-            (void)execlp("ninja",
-                         "ninja",
-                         "-v",
-                         "-d", "explain",
-                         "-f", ninjaFilePath.c_str(),
-                         (char*)NULL);
+            ninjaArgs.insert(ninjaArgs.end(), { "-v", "-d", "explain" });
 
             // REMINDER: If you change the list of arguments passed to ninja, don't forget to
             //           update the std::cout message above that to match your changes.
         }
-        else
+
+        ninjaArgs.insert(ninjaArgs.end(), { "-f", ninjaFilePath.c_str(), (const char*)NULL });
+
+        // To report on the build, this process has to still be around when ninja finishes.
+        if (buildParams.printBuildReport)
         {
-            (void)execlp("ninja",
-                         "ninja",
-                         "-f", ninjaFilePath.c_str(),
-                         (char*)NULL);
+            RunNinjaAndReport(ninjaArgs, buildParams);
         }
 
+        (void)execvp("ninja", const_cast<char* const*>(ninjaArgs.data()));
+
         int errCode = errno;
 
         throw mk::Exception_t(
@@ -325,6 +421,8 @@ void GenerateCode
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating code");
+
     // Create a working directory to build the component in.
     file::MakeDir(path::Combine(buildParams.workingDir, componentPtr->workingDir));
 
@@ -343,11 +441,13 @@ void GenerateCode
 //--------------------------------------------------------------------------------------------------
 void GenerateCode
 (
-    const std::set<model::Component_t*>& components,  ///< Set of components to generate code for.
+    const model::ComponentPtrSet_t& components,  ///< Set of components to generate code for.
     const mk::BuildParams_t& buildParams
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating code");
+
     for (auto componentPtr : components)
     {
         GenerateCode(componentPtr, buildParams);
@@ -367,6 +467,8 @@ void GenerateCode
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating code");
+
     for (auto& mapEntry : components)
     {
         GenerateCode(mapEntry.second, buildParams);
@@ -386,6 +488,8 @@ void GenerateCode
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating code");
+
     // Create the working directory, if it doesn't already exist.
     file::MakeDir(path::Combine(buildParams.workingDir, appPtr->workingDir));
 
@@ -64,7 +64,7 @@ void GenerateCode
 //--------------------------------------------------------------------------------------------------
 void GenerateCode
 (
-    const std::set<model::Component_t*>& components,  ///< Set of components to generate code for.
+    const model::ComponentPtrSet_t& components,  ///< Set of components to generate code for.
     const mk::BuildParams_t& buildParams
 );
 
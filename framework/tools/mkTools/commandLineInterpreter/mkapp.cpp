@@ -42,6 +42,9 @@ static std::string AppName;
 /// a new build.ninja.
 static bool DontRunNinja = false;
 
+/// true if the time spent in each phase should be printed.
+static bool ShowTimings = false;
+
 /// Steps to run to generate a Linux app
 static const generator::AppGenerator_t LinuxSteps[] =
 {
@@ -223,6 +226,27 @@ static void GetCommandLineArgs
                                   " This is useful for supporting context-sensitive auto-complete"
                                   " and related features in source code editors, for example."));
 
+    args::AddOptionalFlag(&ShowTimings,
+                          'T',
+                          "timings",
+                          LE_I18N("Print how long was spent parsing, modelling and generating"
+                                  " code, configuration and build scripts."));
+
+    args::AddOptionalFlag(&BuildParams.printBuildReport,
+                          'R',
+                          "build-report",
+                          LE_I18N("After running ninja, print the critical path of the build and"
+                                  " the components, APIs, executables, apps, rules and steps that"
+                                  " took the most time."));
+
+    args::AddOptionalFlag(&BuildParams.updateCrc32,
+                          'u',
+                          "update-crc32",
+                          LE_I18N("Add the CRC32 of each payload to the update pack headers, so the"
+                                  " target can verify the payloads while unpacking them. Targets"
+                                  " running a Legato version that doesn't know the crc32 member"
+                                  " reject such update packs."));
+
     args::AddOptionalFlag(&BuildParams.binPack,
                           'b',
                           "bin-pack",
@@ -289,6 +313,11 @@ void MakeApp
 {
     GetCommandLineArgs(argc, argv);
 
+    if (ShowTimings)
+    {
+        timing::Enable();
+    }
+
     BuildParams.argc = argc;
     BuildParams.argv = argv;
 
@@ -299,6 +328,9 @@ void MakeApp
     // Set the target-specific environment variables (e.g., LEGATO_TARGET).
     envVars::SetTargetSpecific(BuildParams);
 
+    // Keep parsed definition files in the working directory, to reuse them in later builds.
+    parser::cache::SetDir(path::Combine(BuildParams.workingDir, "parseCache"));
+
     // If we have been asked not to run Ninja, then delete the staging area because it probably
     // will contain some of the wrong files now that .Xdef file have changed.
     if (DontRunNinja)
@@ -359,6 +391,8 @@ void MakeApp
     // Now delete the appPtr
     delete appPtr;
 
+    timing::PrintReport(std::cout);
+
     // If we haven't been asked not to, run ninja.
     if (!DontRunNinja)
     {
@@ -34,6 +34,9 @@ std::string BuildOutputPath = "";
 // a new build.ninja.
 static bool DontRunNinja = false;
 
+/// true if the time spent in each phase should be printed.
+static bool ShowTimings = false;
+
 static generator::ComponentGenerator_t LinuxSteps[] =
 {
     code::GenerateInterfacesHeader,
@@ -212,6 +215,19 @@ static void GetCommandLineArgs
                                   " This is useful for supporting context-sensitive auto-complete"
                                   " and related features in source code editors, for example."));
 
+    args::AddOptionalFlag(&ShowTimings,
+                          'T',
+                          "timings",
+                          LE_I18N("Print how long was spent parsing, modelling and generating"
+                                  " code, configuration and build scripts."));
+
+    args::AddOptionalFlag(&BuildParams.printBuildReport,
+                          'R',
+                          "build-report",
+                          LE_I18N("After running ninja, print the critical path of the build and"
+                                  " the components, APIs, executables, apps, rules and steps that"
+                                  " took the most time."));
+
     // Any remaining parameters on the command-line are treated as a component path.
     // Note: there should only be one.
     args::SetLooseArgHandler(componentPathSet);
@@ -249,6 +265,11 @@ void MakeComponent
 {
     GetCommandLineArgs(argc, argv);
 
+    if (ShowTimings)
+    {
+        timing::Enable();
+    }
+
     BuildParams.argc = argc;
     BuildParams.argv = argv;
 
@@ -259,6 +280,9 @@ void MakeComponent
     // Set the target-specific environment variables (e.g., LEGATO_TARGET).
     envVars::SetTargetSpecific(BuildParams);
 
+    // Keep parsed definition files in the working directory, to reuse them in later builds.
+    parser::cache::SetDir(path::Combine(BuildParams.workingDir, "parseCache"));
+
     // If we have not been asked to ignore any already existing build.ninja, and the command-line
     // arguments and environment variables we were given are the same as last time, just run ninja.
     if (!DontRunNinja)
@@ -310,6 +334,8 @@ void MakeComponent
     // Run all steps to generate a Linux component
     generator::RunAllGenerators(LinuxSteps, componentPtr, BuildParams);
 
+    timing::PrintReport(std::cout);
+
     // If we haven't been asked not to, run ninja.
     if (!DontRunNinja)
     {
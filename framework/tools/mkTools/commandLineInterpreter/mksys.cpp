@@ -39,6 +39,9 @@ static std::string SystemName;
 /// a new build.ninja.
 static bool DontRunNinja = false;
 
+/// true if the time spent in each phase should be printed.
+static bool ShowTimings = false;
+
 /// Steps to run to generate a Linux system
 static const generator::SystemGenerator_t LinuxSteps[] =
 {
@@ -196,6 +199,27 @@ static void GetCommandLineArgs
                                   " context-sensitive auto-complete and related features in"
                                   " source code editors, for example."));
 
+    args::AddOptionalFlag(&ShowTimings,
+                          'T',
+                          "timings",
+                          LE_I18N("Print how long was spent parsing, modelling and generating"
+                                  " code, configuration and build scripts."));
+
+    args::AddOptionalFlag(&BuildParams.printBuildReport,
+                          'R',
+                          "build-report",
+                          LE_I18N("After running ninja, print the critical path of the build and"
+                                  " the components, APIs, executables, apps, rules and steps that"
+                                  " took the most time."));
+
+    args::AddOptionalFlag(&BuildParams.updateCrc32,
+                          'u',
+                          "update-crc32",
+                          LE_I18N("Add the CRC32 of each payload to the update pack headers, so the"
+                                  " target can verify the payloads while unpacking them. Targets"
+                                  " running a Legato version that doesn't know the crc32 member"
+                                  " reject such update packs."));
+
     // Any remaining parameters on the command-line are treated as the .sdef file path.
     // Note: there should only be one parameter not prefixed by an argument identifier.
     args::SetLooseArgHandler(sdefFileNameSet);
@@ -247,6 +271,11 @@ void MakeSystem
 {
     GetCommandLineArgs(argc, argv);
 
+    if (ShowTimings)
+    {
+        timing::Enable();
+    }
+
     BuildParams.argc = argc;
     BuildParams.argv = argv;
 
@@ -257,6 +286,9 @@ void MakeSystem
     // Set the target-specific environment variables (e.g., LEGATO_TARGET).
     envVars::SetTargetSpecific(BuildParams);
 
+    // Keep parsed definition files in the working directory, to reuse them in later builds.
+    parser::cache::SetDir(path::Combine(BuildParams.workingDir, "parseCache"));
+
     // Compute the staging directory path.
     auto stagingDir = path::Combine(BuildParams.workingDir, "staging");
 
@@ -308,6 +340,8 @@ void MakeSystem
     // Now delete the appPtr
     delete systemPtr;
 
+    timing::PrintReport(std::cout);
+
     // If we haven't been asked not to, run ninja.
     if (!DontRunNinja)
     {
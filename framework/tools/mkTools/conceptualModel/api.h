@@ -68,6 +68,24 @@ protected:
 };
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Orders API file objects by path, so sets of them are iterated in the same order on every run,
+ * no matter where the objects were allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+struct ApiFilePtrLess_t
+{
+    bool operator()(const ApiFile_t* a, const ApiFile_t* b) const
+    {
+        return a->path < b->path;
+    }
+};
+
+/// Convenience typedef for constructing sets of API file objects.
+typedef std::set<const ApiFile_t*, ApiFilePtrLess_t> ApiFilePtrSet_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Structure to hold paths to the C code for a generated interface.
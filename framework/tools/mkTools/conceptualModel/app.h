@@ -43,7 +43,7 @@ struct App_t : public HasTargetInfo_t
 
     std::string preloadedMd5; ///< MD5 hash of preloaded app (empty if not specified).
 
-    std::set<Component_t*> components;  ///< Set of components used in this app.
+    ComponentPtrSet_t components;       ///< Set of components used in this app.
 
     std::map<std::string, Exe_t*> executables;  ///< Collection of executables defined in this app.
 
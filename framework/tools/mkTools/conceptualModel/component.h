@@ -48,8 +48,8 @@ struct Component_t : public HasTargetInfo_t
     std::list<ApiServerInterface_t*> serverApis;  ///< List of server-side interfaces implemented.
     std::list<ApiClientInterface_t*> clientApis;  ///< List of client-side interfaces needed.
 
-    std::set<const ApiFile_t*> clientUsetypesApis; ///< .api files imported by client-side APIs.
-    std::set<const ApiFile_t*> serverUsetypesApis; ///< .api files imported by server-side APIs.
+    ApiFilePtrSet_t clientUsetypesApis; ///< .api files imported by client-side APIs.
+    ApiFilePtrSet_t serverUsetypesApis; ///< .api files imported by server-side APIs.
 
     std::set<std::string> implicitDependencies; ///< Changes to these files triggers a re-link.
 
@@ -121,6 +121,24 @@ public:
 };
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Orders component objects by directory, so sets of them are iterated in the same order on every
+ * run, no matter where the objects were allocated.
+ */
+//--------------------------------------------------------------------------------------------------
+struct ComponentPtrLess_t
+{
+    bool operator()(const Component_t* a, const Component_t* b) const
+    {
+        return a->dir < b->dir;
+    }
+};
+
+/// Convenience typedef for constructing sets of component objects.
+typedef std::set<Component_t*, ComponentPtrLess_t> ComponentPtrSet_t;
+
+
 struct Exe_t;
 
 //--------------------------------------------------------------------------------------------------
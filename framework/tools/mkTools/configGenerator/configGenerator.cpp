@@ -786,6 +786,8 @@ void Generate
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating configuration");
+
     std::string filePath = path::Combine(buildParams.workingDir, appPtr->ConfigFilePath());
 
     file::MakeDir(path::GetContainingDir(filePath));
@@ -1045,6 +1047,8 @@ void Generate
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Generating configuration");
+
     file::MakeDir(path::Combine(buildParams.workingDir, "staging/config"));
 
     GenerateModulesConfig(systemPtr, buildParams);
@@ -0,0 +1,395 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file dirHash.cpp
+ *
+ * Computes the MD5 hash of a directory tree, caching the hashes of the files in it.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "mkTools.h"
+#include <fts.h>
+#include <limits.h>
+#include <string.h>
+#include <unistd.h>
+
+
+namespace dirHash
+{
+
+
+/// First line of a cache file.  Change the version if the format changes.
+#define CACHE_FILE_HEADER "# mk dir hash cache v1"
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Cached MD5 hash of a file's contents, and what the file looked like when it was hashed.
+ */
+//--------------------------------------------------------------------------------------------------
+struct CacheEntry_t
+{
+    off_t size;
+    struct timespec modTime;
+    std::string md5;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Loads a cache file.  A missing or unrecognized file gives an empty cache.
+ */
+//--------------------------------------------------------------------------------------------------
+static void LoadCache
+(
+    std::map<std::string, CacheEntry_t>& cache,     ///< [OUT] Cache entries, by relative path.
+    const std::string& cachePath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::ifstream cacheFile(cachePath);
+    std::string line;
+
+    if (!std::getline(cacheFile, line) || (line != CACHE_FILE_HEADER))
+    {
+        return;
+    }
+
+    // Each line is "<md5> <size> <seconds>.<nanoseconds> <path>".
+    while (std::getline(cacheFile, line))
+    {
+        CacheEntry_t entry;
+        long long size;
+        long long seconds;
+        long nanoseconds;
+        char md5[33];
+        int pathPos;
+
+        if (sscanf(line.c_str(), "%32s %lld %lld.%ld %n",
+                   md5, &size, &seconds, &nanoseconds, &pathPos) == 4)
+        {
+            entry.md5 = md5;
+            entry.size = size;
+            entry.modTime.tv_sec = seconds;
+            entry.modTime.tv_nsec = nanoseconds;
+            cache[line.substr(pathPos)] = entry;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Saves a cache file.  Failure to save it isn't an error; it will just be rebuilt next time.
+ */
+//--------------------------------------------------------------------------------------------------
+static void SaveCache
+(
+    const std::map<std::string, CacheEntry_t>& cache,
+    const std::string& cachePath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Write to a temporary file and rename it, so that an interrupted build can't leave a
+    // partial cache file behind.
+    auto tempPath = cachePath + "." + std::to_string(getpid());
+
+    {
+        std::ofstream cacheFile(tempPath, std::ofstream::trunc);
+
+        cacheFile << CACHE_FILE_HEADER << '\n';
+
+        for (auto& mapEntry : cache)
+        {
+            auto& entry = mapEntry.second;
+
+            cacheFile << entry.md5 << ' ' << entry.size << ' '
+                      << entry.modTime.tv_sec << '.' << entry.modTime.tv_nsec << ' '
+                      << mapEntry.first << '\n';
+        }
+
+        cacheFile.close();
+
+        if (cacheFile.fail())
+        {
+            unlink(tempPath.c_str());
+            return;
+        }
+    }
+
+    if (rename(tempPath.c_str(), cachePath.c_str()) != 0)
+    {
+        unlink(tempPath.c_str());
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the MD5 hash of a file's contents.
+ *
+ * @return The hash, as a string of hex digits.
+ *
+ * @throw mk::Exception_t if the file can't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string HashFile
+(
+    const std::string& filePath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        int err = errno;
+
+        throw mk::Exception_t(
+            mk::format(LE_I18N("Failed to open file '%s' (%s)."), filePath, strerror(err))
+        );
+    }
+
+    MD5 hash;
+    char buffer[64 * 1024];
+    ssize_t bytesRead;
+
+    while ((bytesRead = read(fd, buffer, sizeof(buffer))) != 0)
+    {
+        if (bytesRead < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            int err = errno;
+            close(fd);
+
+            throw mk::Exception_t(
+                mk::format(LE_I18N("Failed to read file '%s' (%s)."), filePath, strerror(err))
+            );
+        }
+
+        hash.update(buffer, bytesRead);
+    }
+
+    close(fd);
+
+    return hash.finalize().hexdigest();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the line md5sum prints for a file.  Backslashes and newlines in the name are escaped, in
+ * which case the line starts with a backslash.
+ *
+ * @return The line, including the newline.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string Md5sumLine
+(
+    const std::string& md5,
+    const std::string& name
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (name.find_first_of("\\\n") == std::string::npos)
+    {
+        return md5 + "  " + name + "\n";
+    }
+
+    std::string line = "\\" + md5 + "  ";
+
+    for (char c : name)
+    {
+        if (c == '\\')
+        {
+            line += "\\\\";
+        }
+        else if (c == '\n')
+        {
+            line += "\\n";
+        }
+        else
+        {
+            line += c;
+        }
+    }
+
+    return line + "\n";
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the MD5 hash of a directory tree.
+ *
+ * @return The hash, as a string of hex digits.
+ *
+ * @throw mk::Exception_t if the directory can't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+std::string Compute
+(
+    const std::string& dirPath,     ///< Path to the directory.
+    const std::string& cachePath    ///< Path to the file to cache file hashes in ("" = none).
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Paths are hashed as find prints them when run in the directory ("." and "./<path>").
+    std::string rootPath = dirPath;
+
+    while ((rootPath.size() > 1) && (rootPath.back() == '/'))
+    {
+        rootPath.pop_back();
+    }
+
+    std::vector<std::string> allPaths;
+    std::vector<std::string> filePaths;
+    std::vector<std::string> linkPaths;
+    std::map<std::string, struct stat> fileStats;
+
+    char* pathArrayPtr[] = { const_cast<char*>(rootPath.c_str()), NULL };
+    FTS* ftsPtr = fts_open(pathArrayPtr, FTS_PHYSICAL | FTS_NOCHDIR, NULL);
+
+    if (ftsPtr == NULL)
+    {
+        int err = errno;
+
+        throw mk::Exception_t(
+            mk::format(LE_I18N("Failed to read directory '%s' (%s)."), rootPath, strerror(err))
+        );
+    }
+
+    FTSENT* entPtr;
+
+    while ((entPtr = fts_read(ftsPtr)) != NULL)
+    {
+        std::string relPath = "." + std::string(entPtr->fts_path + rootPath.size());
+
+        switch (entPtr->fts_info)
+        {
+            case FTS_DP:
+                // Directories were already seen on the way in.
+                continue;
+
+            case FTS_DNR:
+            case FTS_ERR:
+            case FTS_NS:
+            {
+                std::string failedPath = entPtr->fts_path;
+                int err = entPtr->fts_errno;
+                fts_close(ftsPtr);
+
+                throw mk::Exception_t(
+                    mk::format(LE_I18N("Failed to read '%s' (%s)."), failedPath, strerror(err))
+                );
+            }
+
+            case FTS_F:
+                filePaths.push_back(relPath);
+                fileStats[relPath] = *entPtr->fts_statp;
+                break;
+
+            case FTS_SL:
+            case FTS_SLNONE:
+                linkPaths.push_back(relPath);
+                break;
+        }
+
+        allPaths.push_back(relPath);
+    }
+
+    fts_close(ftsPtr);
+
+    // Sort as "LC_ALL=C sort" does.
+    std::sort(allPaths.begin(), allPaths.end());
+    std::sort(filePaths.begin(), filePaths.end());
+    std::sort(linkPaths.begin(), linkPaths.end());
+
+    MD5 hash;
+
+    for (auto& relPath : allPaths)
+    {
+        hash.update(relPath.c_str(), relPath.size() + 1);
+    }
+
+    // Get the file hashes, from the cache if the files haven't changed since they were cached.
+    // Files modified in the last second aren't cached, as they could be modified again without
+    // their modification time changing.
+    std::map<std::string, CacheEntry_t> cache;
+    std::map<std::string, CacheEntry_t> newCache;
+    time_t startTime = time(NULL);
+
+    if (!cachePath.empty())
+    {
+        LoadCache(cache, cachePath);
+    }
+
+    for (auto& relPath : filePaths)
+    {
+        auto& fileStat = fileStats[relPath];
+        auto cacheIter = cache.find(relPath);
+        std::string fileMd5;
+
+        if (   (cacheIter != cache.end())
+            && (cacheIter->second.size == fileStat.st_size)
+            && (cacheIter->second.modTime.tv_sec == fileStat.st_mtim.tv_sec)
+            && (cacheIter->second.modTime.tv_nsec == fileStat.st_mtim.tv_nsec)  )
+        {
+            fileMd5 = cacheIter->second.md5;
+        }
+        else
+        {
+            fileMd5 = HashFile(path::Combine(rootPath, relPath));
+        }
+
+        if (   (fileStat.st_mtim.tv_sec < startTime - 1)
+            && (relPath.find('\n') == std::string::npos)  )
+        {
+            newCache[relPath] = { fileStat.st_size, fileStat.st_mtim, fileMd5 };
+        }
+
+        auto line = Md5sumLine(fileMd5, relPath);
+        hash.update(line.c_str(), line.size());
+    }
+
+    // xargs runs md5sum once even if there are no files, and it hashes its (empty) input.
+    if (filePaths.empty())
+    {
+        auto line = Md5sumLine(MD5("").hexdigest(), "-");
+        hash.update(line.c_str(), line.size());
+    }
+
+    for (auto& relPath : linkPaths)
+    {
+        char target[PATH_MAX];
+        auto linkPath = path::Combine(rootPath, relPath);
+        ssize_t targetLength = readlink(linkPath.c_str(), target, sizeof(target));
+
+        if (targetLength < 0)
+        {
+            int err = errno;
+
+            throw mk::Exception_t(
+                mk::format(LE_I18N("Failed to read symlink '%s' (%s)."), linkPath, strerror(err))
+            );
+        }
+
+        hash.update(target, targetLength);
+        hash.update("\n", 1);
+    }
+
+    if (!cachePath.empty())
+    {
+        SaveCache(newCache, cachePath);
+    }
+
+    return hash.finalize().hexdigest();
+}
+
+
+} // namespace dirHash
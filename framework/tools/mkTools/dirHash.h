@@ -0,0 +1,50 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file dirHash.h
+ *
+ * Computes the MD5 hash of a directory tree (e.g., an app's or system's staging area), as used
+ * in the app and system info.properties files.
+ *
+ * The hash is the same as the build scripts used to compute with this shell pipeline, run in
+ * the directory:
+ *
+ * @verbatim
+   ( find -P -print0 |LC_ALL=C sort -z &&
+     find -P -type f -print0 |LC_ALL=C sort -z |xargs -0 md5sum &&
+     find -P -type l -print0 |LC_ALL=C sort -z |xargs -0 -r -n 1 readlink
+   ) | md5sum
+   @endverbatim
+ *
+ * but the MD5 hashes of the files' contents are cached, by path, size and modification time, so
+ * only the files that have changed since the last time are read.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_MKTOOLS_DIR_HASH_H_INCLUDE_GUARD
+#define LEGATO_MKTOOLS_DIR_HASH_H_INCLUDE_GUARD
+
+namespace dirHash
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Computes the MD5 hash of a directory tree.
+ *
+ * @return The hash, as a string of hex digits.
+ *
+ * @throw mk::Exception_t if the directory can't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+std::string Compute
+(
+    const std::string& dirPath,     ///< Path to the directory.
+    const std::string& cachePath    ///< Path to the file to cache file hashes in ("" = none).
+);
+
+
+} // namespace dirHash
+
+#endif // LEGATO_MKTOOLS_DIR_HASH_H_INCLUDE_GUARD
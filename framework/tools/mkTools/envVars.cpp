@@ -19,6 +19,40 @@ namespace envVars
 {
 
 
+/// Snapshot the calling thread reads variables from instead of the process environment, if any.
+static thread_local const Snapshot_t* ThreadSnapshotPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Look up a variable in the calling thread's snapshot, or in the process environment if it
+ * doesn't have one.
+ *
+ * @return  Pointer to the value, or NULL if not found.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char* Find
+(
+    const std::string& name  ///< The name of the environment variable.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (ThreadSnapshotPtr == NULL)
+    {
+        return getenv(name.c_str());
+    }
+
+    auto i = ThreadSnapshotPtr->find(name);
+
+    if (i == ThreadSnapshotPtr->end())
+    {
+        return NULL;
+    }
+
+    return i->second.c_str();
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetch the value of a given optional environment variable.
@@ -32,7 +66,7 @@ std::string Get
 )
 //--------------------------------------------------------------------------------------------------
 {
-    const char* value = getenv(name.c_str());
+    const char* value = Find(name);
 
     if (value == nullptr)
     {
@@ -58,7 +92,7 @@ std::string GetRequired
 )
 //--------------------------------------------------------------------------------------------------
 {
-    const char* value = getenv(name.c_str());
+    const char* value = Find(name);
 
     if (value == nullptr)
     {
@@ -84,6 +118,14 @@ void Set
 )
 //--------------------------------------------------------------------------------------------------
 {
+    if (ThreadSnapshotPtr != NULL)
+    {
+        throw mk::Exception_t(
+            mk::format(LE_I18N("Internal error: environment variable '%s' set by a thread reading"
+                               " from a snapshot."), name)
+        );
+    }
+
     if (setenv(name.c_str(), value.c_str(), true /* overwrite existing */) != 0)
     {
         throw mk::Exception_t(
@@ -360,14 +402,14 @@ std::string DoSubstitution
 
         case UNBRACKETED_VAR_NAME:
             // The end of the string terminates the environment variable name.
-            // Look up the environment variable, and if found, add its value to the result.
+            // Mark variable name as used
+            if (usedVarsPtr)
             {
-                const char* envVarPtr = getenv(envVarName.c_str());
-                if (envVarPtr != NULL)
-                {
-                    result += envVarPtr;
-                }
+                usedVarsPtr->insert(envVarName);
             }
+
+            // Look up the environment variable, and if found, add its value to the result.
+            result += Get(envVarName);
             break;
 
         case BRACKETED_VAR_NAME:
@@ -378,6 +420,55 @@ std::string DoSubstitution
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes a copy of the process environment.
+ *
+ * @return The variables, by name.
+ */
+//--------------------------------------------------------------------------------------------------
+Snapshot_t TakeSnapshot
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    Snapshot_t snapshot;
+
+    for (int i = 0; environ[i] != NULL; i++)
+    {
+        const char* equalsPtr = strchr(environ[i], '=');
+
+        if (equalsPtr != NULL)
+        {
+            snapshot[std::string(environ[i], equalsPtr - environ[i])] = equalsPtr + 1;
+        }
+    }
+
+    return snapshot;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes Get(), GetRequired() and DoSubstitution() read from a snapshot when called from the
+ * calling thread, instead of from the process environment, which is only safe to read from the
+ * main thread.  The snapshot must stay in place until the thread goes back to the process
+ * environment by passing NULL.
+ *
+ * Set() throws an exception when called from a thread that's reading from a snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+void UseSnapshot
+(
+    const Snapshot_t* snapshotPtr   ///< The snapshot, or NULL for the process environment.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    ThreadSnapshotPtr = snapshotPtr;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Gets the file system path to the file in which environment variabls are saved.
@@ -15,6 +15,10 @@ namespace envVars
 {
 
 
+/// A copy of the environment variables, by name.
+typedef std::map<std::string, std::string> Snapshot_t;
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Fetch the value of a given optional environment variable.
@@ -101,6 +105,35 @@ std::string DoSubstitution
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Takes a copy of the process environment.
+ *
+ * @return The variables, by name.
+ */
+//--------------------------------------------------------------------------------------------------
+Snapshot_t TakeSnapshot
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Makes Get(), GetRequired() and DoSubstitution() read from a snapshot when called from the
+ * calling thread, instead of from the process environment, which is only safe to read from the
+ * main thread.  The snapshot must stay in place until the thread goes back to the process
+ * environment by passing NULL.
+ *
+ * Set() throws an exception when called from a thread that's reading from a snapshot.
+ */
+//--------------------------------------------------------------------------------------------------
+void UseSnapshot
+(
+    const Snapshot_t* snapshotPtr   ///< The snapshot, or NULL for the process environment.
+);
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Saves the environment variables (in a file in the build's working directory)
@@ -308,7 +308,8 @@ void MakeDir
 
         int status = mkdir(path.c_str(), mode);
 
-        if (status != 0)
+        // Someone else may have created it in the meantime.
+        if ((status != 0) && !((errno == EEXIST) && DirectoryExists(path)))
         {
             int err = errno;
 
@@ -40,10 +40,12 @@
 #include "exception.h"
 #include "buildParams.h"
 #include "envVars.h"
+#include "timing.h"
 #include "path.h"
 #include "file.h"
 #include "format.h"
 #include "md5.h"
+#include "dirHash.h"
 #include "parseTree/parseTree.h"
 #include "parser/parser.h"
 #include "conceptualModel/conceptualModel.h"
@@ -1663,6 +1663,45 @@ static void EnsurePathIsSet
 
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start parsing the .cdef files of the components listed in an app's "components:" and
+ * "executables:" sections, so they're ready by the time they're modelled.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartParsingComponents
+(
+    model::App_t* appPtr,
+    const parseTree::AdefFile_t* adefFilePtr,
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (auto sectionPtr : adefFilePtr->sections)
+    {
+        auto& sectionName = sectionPtr->firstTokenPtr->text;
+
+        if (sectionName == "components")
+        {
+            for (auto tokenPtr : ToTokenListSectionPtr(sectionPtr)->Contents())
+            {
+                StartParsingComponent(tokenPtr, buildParams, { appPtr->dir });
+            }
+        }
+        else if (sectionName == "executables")
+        {
+            for (auto itemPtr : ToCompoundItemListPtr(sectionPtr)->Contents())
+            {
+                for (auto tokenPtr : ToTokenListPtr(itemPtr)->Contents())
+                {
+                    StartParsingComponent(tokenPtr, buildParams, { appPtr->dir });
+                }
+            }
+        }
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get a conceptual model for a single application whose .adef file can be found at a given path.
@@ -1678,6 +1717,8 @@ model::App_t* GetApp
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Modelling");
+
     // Save the old CURDIR environment variable value and set it to the dir containing this file.
     auto oldDir = envVars::Get("CURDIR");
     envVars::Set("CURDIR", path::MakeAbsolute(path::GetContainingDir(adefPath)));
@@ -1688,6 +1729,8 @@ model::App_t* GetApp
     // Create a new App_t object for this app.
     auto appPtr = new model::App_t(adefFilePtr);
 
+    StartParsingComponents(appPtr, adefFilePtr, buildParams);
+
     if (buildParams.beVerbose)
     {
         std::cout << mk::format(LE_I18N("Modelling application: '%s'\n"
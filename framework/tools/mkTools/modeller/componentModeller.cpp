@@ -338,7 +338,7 @@ static void AddBundledItems
 //--------------------------------------------------------------------------------------------------
 static void GetUsetypesApis
 (
-    std::set<const model::ApiFile_t*>& set,    ///< Set to add the USETYPES-included .api files to.
+    model::ApiFilePtrSet_t& set,    ///< Set to add the USETYPES-included .api files to.
     model::ApiFile_t* apiFilePtr
 )
 //--------------------------------------------------------------------------------------------------
@@ -906,6 +906,67 @@ static void PrintSummary
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Find the directory of a component, searching a given list of directories before the build's
+ * source search directories.
+ *
+ * @return The path to the directory, or "" if not found.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string FindComponent
+(
+    const std::string& componentPath,   ///< Component path, after variable substitution.
+    const mk::BuildParams_t& buildParams,
+    const std::list<std::string>& preSearchDirs ///< Dirs to search before buildParams source dirs
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto resolvedPath = file::FindComponent(componentPath, preSearchDirs);
+    if (resolvedPath.empty())
+    {
+        resolvedPath = file::FindComponent(componentPath, buildParams.sourceDirs);
+    }
+
+    return resolvedPath;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start parsing the .cdef files of the sub-components listed in a component's "requires:"
+ * section, so they're ready by the time they're modelled.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartParsingSubComponents
+(
+    model::Component_t* componentPtr,
+    const parseTree::CdefFile_t* cdefFilePtr,
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (auto sectionPtr : cdefFilePtr->sections)
+    {
+        if (sectionPtr->firstTokenPtr->text != "requires")
+        {
+            continue;
+        }
+
+        for (auto memberPtr : parseTree::ToCompoundItemListPtr(sectionPtr)->Contents())
+        {
+            if (memberPtr->firstTokenPtr->text == "component")
+            {
+                for (auto itemPtr : parseTree::ToTokenListPtr(memberPtr)->Contents())
+                {
+                    StartParsingComponent(itemPtr, buildParams, { componentPtr->dir });
+                }
+            }
+        }
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Get a conceptual model for a single component residing in a given directory.
@@ -920,6 +981,8 @@ model::Component_t* GetComponent
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Modelling");
+
     // If component has already been modelled, return a pointer to the previously created object.
     auto componentPtr = model::Component_t::GetComponent(componentDir);
     if (componentPtr != NULL)
@@ -940,6 +1003,8 @@ model::Component_t* GetComponent
     // build's root working directory.
     componentPtr = model::Component_t::CreateComponent(cdefFilePtr);
 
+    StartParsingSubComponents(componentPtr, cdefFilePtr, buildParams);
+
     if (buildParams.beVerbose)
     {
         std::cout << mk::format(LE_I18N("Modelling component: '%s'\n"
@@ -1060,11 +1125,7 @@ model::Component_t* GetComponent
         return NULL;
     }
 
-    auto resolvedPath = file::FindComponent(componentPath, preSearchDirs);
-    if (resolvedPath.empty())
-    {
-        resolvedPath = file::FindComponent(componentPath, buildParams.sourceDirs);
-    }
+    auto resolvedPath = FindComponent(componentPath, buildParams, preSearchDirs);
     if (resolvedPath.empty())
     {
         tokenPtr->ThrowException(
@@ -1077,6 +1138,47 @@ model::Component_t* GetComponent
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start parsing the .cdef file of a component specified by a given FILE_PATH token on a worker
+ * thread, unless it has already been modelled.  Errors are left for GetComponent() to report.
+ */
+//--------------------------------------------------------------------------------------------------
+void StartParsingComponent
+(
+    const parseTree::Token_t* tokenPtr,
+    const mk::BuildParams_t& buildParams,
+    const std::list<std::string>& preSearchDirs ///< Dirs to search before buildParams source dirs
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string resolvedPath;
+
+    try
+    {
+        auto componentPath = path::Unquote(envVars::DoSubstitution(tokenPtr->text));
+
+        if (!componentPath.empty())
+        {
+            resolvedPath = FindComponent(componentPath, buildParams, preSearchDirs);
+        }
+    }
+    catch (mk::Exception_t& e)
+    {
+        return;
+    }
+
+    if (   resolvedPath.empty()
+        || (model::Component_t::GetComponent(path::MakeAbsolute(resolvedPath)) != NULL))
+    {
+        return;
+    }
+
+    parser::ahead::Start(path::Combine(path::MakeAbsolute(resolvedPath), "Component.cdef"),
+                         parseTree::DefFile_t::CDEF);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Adds an instance of a given component to a given executable.
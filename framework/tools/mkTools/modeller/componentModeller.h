@@ -34,6 +34,20 @@ model::Component_t* GetComponent
 );
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start parsing the .cdef file of a component specified by a given FILE_PATH token on a worker
+ * thread, unless it has already been modelled.  Errors are left for GetComponent() to report.
+ */
+//--------------------------------------------------------------------------------------------------
+void StartParsingComponent
+(
+    const parseTree::Token_t* tokenPtr,
+    const mk::BuildParams_t& buildParams,
+    const std::list<std::string>& preSearchDirs ///< Dirs to search before buildParams source dirs
+);
+
+
 } // namespace modeller
 
 #endif // LEGATO_MKTOOLS_COMPONENT_MODELLER_H_INCLUDE_GUARD
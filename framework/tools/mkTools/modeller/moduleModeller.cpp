@@ -179,6 +179,8 @@ model::Module_t* GetModule
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Modelling");
+
     // Save the old CURDIR environment variable value and set it to the dir containing this file.
     auto oldDir = envVars::Get("CURDIR");
     envVars::Set("CURDIR", path::MakeAbsolute(path::GetContainingDir(mdefPath)));
@@ -694,6 +694,53 @@ static void ModelBindingsSection
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Start parsing the .adef files of all the apps in a list of "apps:" sections, so they're ready
+ * by the time they're modelled.  Binary apps and apps that can't be found are left for ModelApp()
+ * to deal with.
+ */
+//--------------------------------------------------------------------------------------------------
+static void StartParsingApps
+(
+    const std::list<const parseTree::CompoundItem_t*>& appsSections,
+    const mk::BuildParams_t& buildParams
+)
+//--------------------------------------------------------------------------------------------------
+{
+    for (auto sectionPtr : appsSections)
+    {
+        auto appsSectionPtr = dynamic_cast<const parseTree::CompoundItemList_t*>(sectionPtr);
+
+        for (auto itemPtr : appsSectionPtr->Contents())
+        {
+            std::string appSpec;
+
+            try
+            {
+                appSpec = path::Unquote(envVars::DoSubstitution(itemPtr->firstTokenPtr->text));
+            }
+            catch (mk::Exception_t& e)
+            {
+                continue;
+            }
+
+            if (!path::HasSuffix(appSpec, ".adef"))
+            {
+                appSpec += ".adef";
+            }
+
+            auto filePath = file::FindFile(appSpec, buildParams.sourceDirs);
+
+            if (!filePath.empty())
+            {
+                parser::ahead::Start(filePath, parseTree::DefFile_t::ADEF);
+            }
+        }
+    }
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Model all the apps from all the "apps:" sections and add them to a system.
@@ -707,6 +754,8 @@ static void ModelApps
 )
 //--------------------------------------------------------------------------------------------------
 {
+    StartParsingApps(appsSections, buildParams);
+
     for (auto sectionPtr : appsSections)
     {
         ModelAppsSection(systemPtr, sectionPtr, buildParams);
@@ -889,6 +938,8 @@ model::System_t* GetSystem
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Modelling");
+
     // Save the old CURDIR environment variable value and set it to the dir containing this file.
     auto oldDir = envVars::Get("CURDIR");
     envVars::Set("CURDIR", path::MakeAbsolute(path::GetContainingDir(sdefPath)));
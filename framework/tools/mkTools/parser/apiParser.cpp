@@ -81,6 +81,21 @@ void GetDependencies
 )
 //--------------------------------------------------------------------------------------------------
 {
+    timing::Scope_t timingScope("Scanning .api files");
+
+    std::list<std::string> dependencies;
+
+    // If the file hasn't changed since it was last parsed, use the cached dependencies.
+    if (cache::LoadApiDependencies(filePath, dependencies))
+    {
+        for (auto& dependency : dependencies)
+        {
+            handlerFunc(std::string(dependency));
+        }
+
+        return;
+    }
+
     // Make sure the file exists.
     if (!file::FileExists(filePath))
     {
@@ -108,6 +123,7 @@ void GetDependencies
             std::string dependency = ParseUseTypesStatement(inputStream);
             if (!dependency.empty())
             {
+                dependencies.push_back(dependency);
                 handlerFunc(std::move(dependency));
             }
         }
@@ -151,6 +167,8 @@ void GetDependencies
             mk::format(LE_I18N("Failed to read from file '%s'."), filePath)
         );
     }
+
+    cache::SaveApiDependencies(filePath, dependencies);
 }
 
 
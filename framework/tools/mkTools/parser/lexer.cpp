@@ -27,7 +27,6 @@ Lexer_t::LexerContext_t::LexerContext_t
 )
 //--------------------------------------------------------------------------------------------------
 :   filePtr(filePtr),
-    inputStream(filePtr->path),
     line(1),
     column(0),
     ifNestDepth(0)
@@ -40,6 +39,9 @@ Lexer_t::LexerContext_t::LexerContext_t
             mk::format(LE_I18N("File not found: '%s'."), filePtr->path)
         );
     }
+
+    std::ifstream inputStream(filePtr->path, std::ios::binary);
+
     if (!inputStream.is_open())
     {
         throw mk::Exception_t(
@@ -47,8 +49,9 @@ Lexer_t::LexerContext_t::LexerContext_t
         );
     }
 
-    // Read in the first characters.
-    Buffer(2);
+    // Read in the whole file at once, rather than a character at a time.
+    std::ostringstream contentStream;
+    contentStream << inputStream.rdbuf();
 
     if (inputStream.bad())
     {
@@ -56,11 +59,21 @@ Lexer_t::LexerContext_t::LexerContext_t
             mk::format(LE_I18N("Failed to read from file '%s'."), filePtr->path)
         );
     }
+
+    const std::string& content = contentStream.str();
+
+    // Characters are kept as values from 0 to 255, like std::ifstream::get() returns them.
+    nextChars.assign(reinterpret_cast<const unsigned char*>(content.data()),
+                     reinterpret_cast<const unsigned char*>(content.data()) + content.size());
+    nextChars.push_back(EOF);
+
+    Buffer(2);
 }
 
 //--------------------------------------------------------------------------------------------------
 /**
- * Ensure at least n elements are present in the lookahead character buffer
+ * Ensure at least n elements are present in the lookahead character buffer, padding it with EOF
+ * past the end of the file.
  */
 //--------------------------------------------------------------------------------------------------
 void Lexer_t::LexerContext_t::Buffer
@@ -68,9 +81,9 @@ void Lexer_t::LexerContext_t::Buffer
     size_t n
 )
 {
-    while (inputStream.good() && (nextChars.size() < n))
+    while (nextChars.size() < n)
     {
-        nextChars.push_back(inputStream.get());
+        nextChars.push_back(EOF);
     }
 }
 
@@ -85,7 +98,8 @@ Lexer_t::Lexer_t
     parseTree::DefFile_t* fileObjPtr
 )
 //--------------------------------------------------------------------------------------------------
-:   beVerbose(false)
+:   beVerbose(false),
+    dependsOnFileTests(false)
 //--------------------------------------------------------------------------------------------------
 {
     // Setup the lexer context for the top-level file
@@ -795,6 +809,9 @@ void Lexer_t::ProcessIncludeDirective
     if (includePath == "")
     {
         includePath = file::FindFile(filePath, { envVars::Get("LEGATO_ROOT") });
+
+        // Creating the file in the including file's directory would change what gets included.
+        dependsOnFileTests = true;
     }
 
     if (includePath == "")
@@ -1118,6 +1135,7 @@ bool Lexer_t::PullAndEvalBoolExpression
                 auto curDir = path::GetContainingDir(context.top().filePtr->path);
 
                 result = (file::FindFile(fileName, { curDir }) != "");
+                dependsOnFileTests = true;
 
                 MarkVarsUsed(substitutedVars, fileNamePtr);
             }
@@ -1132,6 +1150,7 @@ bool Lexer_t::PullAndEvalBoolExpression
                 auto curDir = path::GetContainingDir(context.top().filePtr->path);
 
                 result = (file::FindDirectory(fileName, { curDir }) != "");
+                dependsOnFileTests = true;
 
                 MarkVarsUsed(substitutedVars, fileNamePtr);
             }
@@ -2413,6 +2432,30 @@ parseTree::Token_t *Lexer_t::FindVarUse
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Get the names of all the build variables used by processing directives.
+ *
+ * @return The names.
+ */
+//--------------------------------------------------------------------------------------------------
+std::set<std::string> Lexer_t::UsedVarNames
+(
+    void
+) const
+//--------------------------------------------------------------------------------------------------
+{
+    std::set<std::string> names;
+
+    for (auto& varUse : usedVars)
+    {
+        names.insert(varUse.first);
+    }
+
+    return names;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Advance the current file position by one character, appending the character into a given string
@@ -2441,11 +2484,6 @@ void Lexer_t::AdvanceOneCharacter
 
     context.top().nextChars.pop_front();
     context.top().Buffer(2);
-
-    if (context.top().inputStream.bad())
-    {
-        ThrowException(LE_I18N("Failed to fetch next character from file."));
-    }
 }
 
 
@@ -45,6 +45,13 @@ class Lexer_t
         // Find if a build variable has been used by the lexer in a processing directive
         parseTree::Token_t *FindVarUse(const std::string &name);
 
+        // Get the names of all the build variables used by processing directives.
+        std::set<std::string> UsedVarNames() const;
+
+        // true if the tokens depend on which files exist, not just on the content of the files
+        // read (e.g., because of a file_exists() or dir_exists() directive).
+        bool DependsOnFileTests() const { return dependsOnFileTests; }
+
         // true = print progress messages to the standard output stream.
         bool beVerbose;
 
@@ -58,9 +65,8 @@ class Lexer_t
         {
             parseTree::DefFileFragment_t* filePtr;  ///< Pointer to the File object for the file being parsed.
 
-            std::ifstream inputStream;      ///< File input stream from which tokens will be matched.
-            std::deque<int> nextChars;      ///< File buffer for characters read from the input
-                                            ///< stream but not yet consumed.
+            std::deque<int> nextChars;      ///< Characters of the file not yet consumed, ending
+                                            ///< with EOF.
             size_t line;                    ///< File line number.
             size_t column;                  ///< Char index on line (treat tab & return same as space).
             size_t ifNestDepth;             ///< Current number of nested #if directives.
@@ -76,6 +82,7 @@ class Lexer_t
                                                              /// These variables should not be
                                                              /// overriden or the results may be
                                                              /// confusing.
+        bool dependsOnFileTests;    ///< true if the tokens depend on which files exist.
 
         void NextToken();
         void NextTokenOrDirective();
@@ -0,0 +1,472 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file parseAhead.cpp  Parses definition files on worker threads, ahead of the modellers.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "mkTools.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+
+namespace parser
+{
+
+namespace ahead
+{
+
+
+/// Maximum number of worker threads.  Parsing is mostly I/O and memory allocation, so more than
+/// a few threads doesn't help.
+#define MAX_THREADS 8
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A file to be parsed by a worker thread.
+ */
+//--------------------------------------------------------------------------------------------------
+struct Job_t
+{
+    enum State_t
+    {
+        QUEUED,     ///< Waiting for a worker thread.
+        RUNNING,    ///< Being parsed.
+        DONE        ///< Finished.  filePtr is NULL if the parse failed.
+    };
+
+    std::string path;                       ///< Absolute path to the file.
+    parseTree::DefFile_t::Type_t type;      ///< Type of the file.
+    envVars::Snapshot_t env;                ///< Build variables to parse the file with.
+    State_t state;
+    parseTree::DefFile_t* filePtr;          ///< The parse tree, once DONE.
+    std::set<std::string> usedVars;         ///< Build variables used by processing directives.
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * The worker threads, and the jobs they work on.
+ */
+//--------------------------------------------------------------------------------------------------
+class Pool_t
+{
+    public:
+
+        Pool_t();
+        ~Pool_t();
+
+        std::mutex mutex;                       ///< Protects everything below.
+        std::condition_variable queuedCond;     ///< Signalled when a job is queued, or stopping.
+        std::condition_variable doneCond;       ///< Signalled when a job is DONE.
+        std::deque<Job_t*> queue;               ///< QUEUED jobs, oldest first.
+        std::map<std::string, Job_t*> jobs;     ///< Jobs not yet taken, by path.
+        bool isStopping;
+
+    private:
+
+        std::vector<std::thread> threads;
+
+        void Work();
+};
+
+
+/// The job being run by the calling thread, if it's a worker thread.
+static thread_local Job_t* CurrentJobPtr = NULL;
+
+/// The pool, once a file has been started.  Only used by the main thread.
+static Pool_t* PoolPtr = NULL;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Constructor.  Starts the worker threads.
+ */
+//--------------------------------------------------------------------------------------------------
+Pool_t::Pool_t
+(
+)
+//--------------------------------------------------------------------------------------------------
+:   isStopping(false)
+//--------------------------------------------------------------------------------------------------
+{
+    unsigned int threadCount = std::min(std::thread::hardware_concurrency(),
+                                        (unsigned int)MAX_THREADS);
+
+    for (unsigned int i = 0; i < threadCount; i++)
+    {
+        threads.push_back(std::thread(&Pool_t::Work, this));
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor.  Lets the worker threads finish the jobs they're running, and waits for them.
+ * Jobs not started yet are dropped.
+ */
+//--------------------------------------------------------------------------------------------------
+Pool_t::~Pool_t
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+
+    queuedCond.notify_all();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Parses a job's file.  Runs on a worker thread, with the pool's mutex unlocked.
+ */
+//--------------------------------------------------------------------------------------------------
+static void Run
+(
+    Job_t* jobPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    timing::Scope_t timingScope("Parsing ahead (worker threads)");
+
+    CurrentJobPtr = jobPtr;
+    envVars::UseSnapshot(&jobPtr->env);
+
+    try
+    {
+        switch (jobPtr->type)
+        {
+            case parseTree::DefFile_t::CDEF:
+                jobPtr->filePtr = cdef::Parse(jobPtr->path, false);
+                break;
+
+            case parseTree::DefFile_t::ADEF:
+                jobPtr->filePtr = adef::Parse(jobPtr->path, false);
+                break;
+
+            case parseTree::DefFile_t::MDEF:
+                jobPtr->filePtr = mdef::Parse(jobPtr->path, false);
+                break;
+
+            case parseTree::DefFile_t::SDEF:
+                break;
+        }
+    }
+    catch (std::exception& e)
+    {
+        // The modeller will run into the same error when it parses the file itself.
+        jobPtr->filePtr = NULL;
+    }
+
+    envVars::UseSnapshot(NULL);
+    CurrentJobPtr = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Body of the worker threads.
+ */
+//--------------------------------------------------------------------------------------------------
+void Pool_t::Work
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;)
+    {
+        queuedCond.wait(lock, [this] { return isStopping || !queue.empty(); });
+
+        if (isStopping)
+        {
+            return;
+        }
+
+        auto jobPtr = queue.front();
+        queue.pop_front();
+        jobPtr->state = Job_t::RUNNING;
+
+        lock.unlock();
+        Run(jobPtr);
+        lock.lock();
+
+        jobPtr->state = Job_t::DONE;
+        doneCond.notify_all();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the pool, starting the worker threads the first time.
+ *
+ * @return The pool, or NULL if there's no point in parsing ahead on this machine.
+ */
+//--------------------------------------------------------------------------------------------------
+static Pool_t* GetPool
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    static const unsigned int cpuCount = std::thread::hardware_concurrency();
+
+    if (cpuCount < 2)
+    {
+        return NULL;
+    }
+
+    // Being a local static, the pool is destroyed (and its threads stopped) before anything the
+    // threads use that was created before it.
+    static Pool_t pool;
+
+    return &pool;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts parsing a .cdef, .adef or .mdef file on a worker thread, unless it's already started.
+ * Must be called from the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void Start
+(
+    const std::string& filePath,                ///< Path to the file.
+    parseTree::DefFile_t::Type_t fileType       ///< Type of the file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (fileType == parseTree::DefFile_t::SDEF)
+    {
+        return;
+    }
+
+    auto poolPtr = PoolPtr = GetPool();
+
+    if (poolPtr == NULL)
+    {
+        return;
+    }
+
+    // Same path as the DefFile_t constructor gives it.
+    auto path = path::MakeAbsolute(filePath);
+
+    std::unique_lock<std::mutex> lock(poolPtr->mutex);
+
+    if (poolPtr->jobs.find(path) != poolPtr->jobs.end())
+    {
+        return;
+    }
+
+    auto jobPtr = new Job_t();
+    jobPtr->path = path;
+    jobPtr->type = fileType;
+    jobPtr->state = Job_t::QUEUED;
+    jobPtr->filePtr = NULL;
+
+    // The modellers set CURDIR to the directory containing the file while parsing it.
+    jobPtr->env = envVars::TakeSnapshot();
+    jobPtr->env["CURDIR"] = path::MakeAbsolute(path::GetContainingDir(path));
+
+    poolPtr->jobs[path] = jobPtr;
+    poolPtr->queue.push_back(jobPtr);
+
+    lock.unlock();
+    poolPtr->queuedCond.notify_one();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Moves a parse tree from one definition file object to another, empty, one.
+ */
+//--------------------------------------------------------------------------------------------------
+static void MoveParseTree
+(
+    parseTree::DefFile_t* fromPtr,
+    parseTree::DefFile_t* toPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Tokens and items found in the file itself (rather than in a file it includes) point back
+    // to the file object.
+    for (auto tokenPtr = fromPtr->lastTokenPtr; tokenPtr != NULL; tokenPtr = tokenPtr->prevPtr)
+    {
+        if (tokenPtr->filePtr == fromPtr)
+        {
+            tokenPtr->filePtr = toPtr;
+        }
+    }
+
+    std::function<void(parseTree::CompoundItem_t*)> moveItem =
+        [fromPtr, toPtr, &moveItem](parseTree::CompoundItem_t* itemPtr)
+        {
+            if (itemPtr->filePtr == fromPtr)
+            {
+                itemPtr->filePtr = toPtr;
+            }
+
+            auto listPtr = dynamic_cast<parseTree::CompoundItemList_t*>(itemPtr);
+
+            if (listPtr != NULL)
+            {
+                for (auto contentPtr : listPtr->Contents())
+                {
+                    moveItem(contentPtr);
+                }
+            }
+        };
+
+    for (auto sectionPtr : fromPtr->sections)
+    {
+        moveItem(sectionPtr);
+    }
+
+    toPtr->version = fromPtr->version;
+    toPtr->firstTokenPtr = fromPtr->firstTokenPtr;
+    toPtr->lastTokenPtr = fromPtr->lastTokenPtr;
+    toPtr->includedFiles.swap(fromPtr->includedFiles);
+    toPtr->sections.swap(fromPtr->sections);
+
+    fromPtr->firstTokenPtr = NULL;
+    fromPtr->lastTokenPtr = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Populates an empty definition file object from a parse started with Start(), if there is one
+ * and the result can be used.
+ *
+ * @return true if the object was populated, false if it has to be parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+bool Take
+(
+    parseTree::DefFile_t* defFilePtr    ///< The definition file object to populate.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Worker threads parse the files they're given themselves.
+    if (CurrentJobPtr != NULL)
+    {
+        return false;
+    }
+
+    auto poolPtr = PoolPtr;
+
+    if (poolPtr == NULL)
+    {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(poolPtr->mutex);
+
+    auto i = poolPtr->jobs.find(defFilePtr->path);
+
+    if ((i == poolPtr->jobs.end()) || (i->second->type != defFilePtr->type))
+    {
+        return false;
+    }
+
+    std::unique_ptr<Job_t> jobPtr(i->second);
+    poolPtr->jobs.erase(i);
+
+    // If no worker has got to it yet, parsing it here is quicker than waiting.
+    if (jobPtr->state == Job_t::QUEUED)
+    {
+        poolPtr->queue.erase(std::find(poolPtr->queue.begin(),
+                                       poolPtr->queue.end(),
+                                       jobPtr.get()));
+        return false;
+    }
+
+    {
+        timing::Scope_t timingScope("Waiting for worker threads");
+
+        poolPtr->doneCond.wait(lock, [&jobPtr] { return jobPtr->state == Job_t::DONE; });
+    }
+
+    lock.unlock();
+
+    if (jobPtr->filePtr == NULL)
+    {
+        return false;
+    }
+
+    // Check that the build variables the worker used have the values the modeller would have
+    // given it.  Note that the worker's copy of the environment has variables that aren't set
+    // as empty, as does envVars::Get().
+    for (auto& name : jobPtr->usedVars)
+    {
+        auto envIter = jobPtr->env.find(name);
+        const std::string& value = (envIter == jobPtr->env.end() ? "" : envIter->second);
+
+        if (envVars::Get(name) != value)
+        {
+            return false;
+        }
+    }
+
+    // The worker's file object is left empty.  It's not deleted, as parse tree objects never are.
+    MoveParseTree(jobPtr->filePtr, defFilePtr);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether the calling thread is one of the worker threads.
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsWorkerThread
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return (CurrentJobPtr != NULL);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records the build variables used by the processing directives of the file being parsed.  Does
+ * nothing unless called from a worker thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void NoteUsedVars
+(
+    const std::set<std::string>& usedVars
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (CurrentJobPtr != NULL)
+    {
+        CurrentJobPtr->usedVars.insert(usedVars.begin(), usedVars.end());
+    }
+}
+
+
+} // namespace ahead
+
+} // namespace parser
@@ -0,0 +1,83 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file parseAhead.h  Parses definition files on worker threads, ahead of the modellers.
+ *
+ * The modellers only learn which .cdef files they need as they work their way through the .sdef
+ * and .adef files, and they have to work through them in order.  When a modeller finds files it
+ * is going to need later (e.g., all the apps in a system, or all the components of an app), it
+ * calls Start() for each of them, so that they can be parsed in parallel while it carries on.
+ * When the modeller gets to one of those files, ParseFile() takes the parse tree from the worker
+ * thread instead of parsing the file itself, waiting for the worker to finish if it has to.
+ *
+ * Worker threads read build variables from a copy of the environment taken when the file was
+ * started, with CURDIR set to the directory containing the file, as the modellers do.  A parse
+ * tree is only used if the build variables used by its processing directives still have the same
+ * values when the modeller gets to the file.  Otherwise, or if the worker ran into an error (which
+ * will be reported when the modeller parses the file itself), the file is parsed again as usual.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_MKTOOLS_PARSE_AHEAD_H_INCLUDE_GUARD
+#define LEGATO_MKTOOLS_PARSE_AHEAD_H_INCLUDE_GUARD
+
+namespace ahead
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts parsing a .cdef, .adef or .mdef file on a worker thread, unless it's already started.
+ * Must be called from the main thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void Start
+(
+    const std::string& filePath,                ///< Path to the file.
+    parseTree::DefFile_t::Type_t fileType       ///< Type of the file.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Populates an empty definition file object from a parse started with Start(), if there is one
+ * and the result can be used.
+ *
+ * @return true if the object was populated, false if it has to be parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+bool Take
+(
+    parseTree::DefFile_t* defFilePtr    ///< The definition file object to populate.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Checks whether the calling thread is one of the worker threads.
+ *
+ * @return true if it is.
+ */
+//--------------------------------------------------------------------------------------------------
+bool IsWorkerThread
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Records the build variables used by the processing directives of the file being parsed.  Does
+ * nothing unless called from a worker thread.
+ */
+//--------------------------------------------------------------------------------------------------
+void NoteUsedVars
+(
+    const std::set<std::string>& usedVars
+);
+
+
+} // namespace ahead
+
+#endif // LEGATO_MKTOOLS_PARSE_AHEAD_H_INCLUDE_GUARD
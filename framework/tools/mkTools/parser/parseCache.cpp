@@ -0,0 +1,1127 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file parseCache.cpp  Implementation of the on-disk cache of parsed definition files.
+ *
+ * Each entry is a file in the cache directory, named after the MD5 hash of the path of the file
+ * it caches.  Its content is a sequence of unsigned decimal numbers, each followed by a space,
+ * and of strings, each written as its length in bytes, a colon, and the bytes themselves.
+ *
+ * Every entry starts with a header:
+ *  - the format identifier,
+ *  - the stamp of the mk tools executable that wrote it,
+ *  - the number of build variables, then each one's name and value,
+ *  - the number of files read, then each one's path, modification time (seconds and
+ *    nanoseconds), size and MD5 hash.
+ *
+ * A .api file entry then holds the number of dependencies, followed by the dependencies.
+ *
+ * A definition file entry has one file per fragment (the file itself, followed by the files it
+ * includes), and then holds, for each fragment, the number of tokens, each token's type, line,
+ * column and text, then the number of included files, and for each one the index of the
+ * #include token and the index of the included fragment.  Then comes the number of top-level
+ * sections, followed by the sections.  Each section or item is written as its content type, its
+ * first and last tokens, then the number of its content items, followed by the content items
+ * (tokens or nested items, depending on the content type).  A token reference is written as the
+ * fragment index plus one (0 = NULL), then the index of the token in the fragment.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "mkTools.h"
+#include <atomic>
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace parser
+{
+
+namespace cache
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Identifies the cache entry format.  Must be changed whenever the format changes.
+ */
+//--------------------------------------------------------------------------------------------------
+static const char FormatId[] = "mkParseCache 1";
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Directory the cache entries are kept in.  Empty if the cache is disabled.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string CacheDir;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Identity of a file as it was when it was read.
+ */
+//--------------------------------------------------------------------------------------------------
+struct FileStamp_t
+{
+    std::string path;
+    uint64_t mtimeSec;
+    uint64_t mtimeNsec;
+    uint64_t size;
+    std::string md5;    ///< MD5 hash of the content, or "" if not computed.
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reference to a token, as the index of its fragment plus one (0 = NULL), and its index in the
+ * fragment.
+ */
+//--------------------------------------------------------------------------------------------------
+struct TokenRef_t
+{
+    size_t fragment;
+    size_t index;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A section or item, as read from a cache entry.
+ */
+//--------------------------------------------------------------------------------------------------
+struct CachedItem_t
+{
+    parseTree::Content_t::Type_t type;
+    TokenRef_t first;
+    TokenRef_t last;
+    std::vector<TokenRef_t> tokens;     ///< Content of a TokenList_t.
+    std::vector<CachedItem_t> items;    ///< Content of a CompoundItemList_t.
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A token, as read from a cache entry.
+ */
+//--------------------------------------------------------------------------------------------------
+struct CachedToken_t
+{
+    parseTree::Token_t::Type_t type;
+    size_t line;
+    size_t column;
+    std::string text;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * A definition file fragment, as read from a cache entry.
+ */
+//--------------------------------------------------------------------------------------------------
+struct CachedFragment_t
+{
+    std::vector<CachedToken_t> tokens;
+    std::vector<std::pair<size_t, size_t>> includes;    ///< #include token index, fragment index.
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Serializes a cache entry.
+ */
+//--------------------------------------------------------------------------------------------------
+class Writer_t
+{
+    public:
+
+        void Number(uint64_t value)
+        {
+            buffer += std::to_string(value);
+            buffer += ' ';
+        }
+
+        void String(const std::string& value)
+        {
+            buffer += std::to_string(value.size());
+            buffer += ':';
+            buffer += value;
+        }
+
+        const std::string& Buffer() const { return buffer; }
+
+    private:
+
+        std::string buffer;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Deserializes a cache entry.
+ *
+ * @throw mk::Exception_t if the entry is malformed.
+ */
+//--------------------------------------------------------------------------------------------------
+class Reader_t
+{
+    public:
+
+        Reader_t(const std::string& buffer): buffer(buffer), pos(0) {}
+
+        uint64_t Number()
+        {
+            return ReadDigits(' ');
+        }
+
+        std::string String()
+        {
+            uint64_t length = ReadDigits(':');
+
+            if (length > buffer.size() - pos)
+            {
+                throw mk::Exception_t("truncated string");
+            }
+
+            std::string result = buffer.substr(pos, length);
+            pos += length;
+
+            return result;
+        }
+
+        bool AtEnd() const { return pos == buffer.size(); }
+
+    private:
+
+        uint64_t ReadDigits(char terminator)
+        {
+            uint64_t value = 0;
+            size_t start = pos;
+
+            while ((pos < buffer.size()) && isdigit(buffer[pos]))
+            {
+                value = (value * 10) + (buffer[pos] - '0');
+                pos++;
+            }
+
+            if ((pos == start) || (pos == buffer.size()) || (buffer[pos] != terminator))
+            {
+                throw mk::Exception_t("malformed number");
+            }
+            pos++;
+
+            return value;
+        }
+
+        const std::string& buffer;
+        size_t pos;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the whole content of a file.
+ *
+ * @return true if successful, false if the file couldn't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadFile
+(
+    const std::string& filePath,
+    std::string& content
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::ifstream inputStream(filePath, std::ios::binary);
+
+    if (!inputStream.is_open())
+    {
+        return false;
+    }
+
+    std::ostringstream contentStream;
+    contentStream << inputStream.rdbuf();
+
+    if (inputStream.bad())
+    {
+        return false;
+    }
+
+    content = contentStream.str();
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the modification time and size of a file.
+ *
+ * @return true if successful, false if the file doesn't exist.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool StatFile
+(
+    const std::string& filePath,
+    FileStamp_t& stamp
+)
+//--------------------------------------------------------------------------------------------------
+{
+    struct stat statBuf;
+
+    if (stat(filePath.c_str(), &statBuf) != 0)
+    {
+        return false;
+    }
+
+    stamp.path = filePath;
+    stamp.mtimeSec = statBuf.st_mtim.tv_sec;
+    stamp.mtimeNsec = statBuf.st_mtim.tv_nsec;
+    stamp.size = statBuf.st_size;
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the stamp of a file, including the MD5 hash of its content.
+ *
+ * @return true if successful, false if the file couldn't be read.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool GetFileStamp
+(
+    const std::string& filePath,
+    FileStamp_t& stamp
+)
+//--------------------------------------------------------------------------------------------------
+{
+    std::string content;
+
+    // Stat first, so that a change made while reading makes the stamp stale rather than wrong.
+    if (!StatFile(filePath, stamp) || !ReadFile(filePath, content))
+    {
+        return false;
+    }
+
+    stamp.md5 = md5(content);
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the stamp of the running mk tools executable, so that entries written by a different build
+ * of the tools aren't used.
+ *
+ * @return The stamp, or "" if the executable can't be found.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string ReadToolStamp
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    char exePath[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", exePath, sizeof(exePath) - 1);
+    FileStamp_t stamp;
+
+    if (length > 0)
+    {
+        exePath[length] = '\0';
+
+        if (StatFile(exePath, stamp))
+        {
+            return stamp.path + " " + std::to_string(stamp.mtimeSec) + "." +
+                   std::to_string(stamp.mtimeNsec) + " " + std::to_string(stamp.size);
+        }
+    }
+
+    return "";
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the stamp of the running mk tools executable, reading it the first time only.
+ */
+//--------------------------------------------------------------------------------------------------
+static const std::string& GetToolStamp
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    // Initialization of a local static is thread-safe, so this may be called from any thread.
+    static const std::string toolStamp = ReadToolStamp();
+
+    return toolStamp;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the path of the cache entry for a given file.
+ */
+//--------------------------------------------------------------------------------------------------
+static std::string GetEntryPath
+(
+    const std::string& kind,        ///< "api" or "def".
+    const std::string& filePath     ///< Absolute path of the cached file.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return path::Combine(CacheDir, kind + "-" + md5(path::MakeCanonical(filePath)));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes the header of a cache entry.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteHeader
+(
+    Writer_t& writer,
+    const std::set<std::string>& usedVars,
+    const std::vector<FileStamp_t>& stamps
+)
+//--------------------------------------------------------------------------------------------------
+{
+    writer.String(FormatId);
+    writer.String(GetToolStamp());
+
+    writer.Number(usedVars.size());
+    for (auto& name : usedVars)
+    {
+        writer.String(name);
+        writer.String(envVars::Get(name));
+    }
+
+    writer.Number(stamps.size());
+    for (auto& stamp : stamps)
+    {
+        writer.String(stamp.path);
+        writer.Number(stamp.mtimeSec);
+        writer.Number(stamp.mtimeNsec);
+        writer.Number(stamp.size);
+        writer.String(stamp.md5);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads the header of a cache entry and checks that the entry is still valid.
+ *
+ * @return true if the entry is valid, false if not.
+ *
+ * @throw mk::Exception_t if the entry is malformed.
+ */
+//--------------------------------------------------------------------------------------------------
+static bool ReadHeader
+(
+    Reader_t& reader,
+    std::set<std::string>& usedVars,        ///< [OUT] Build variables used.
+    std::vector<FileStamp_t>& stamps,       ///< [OUT] Files read.
+    bool& isStale                           ///< [OUT] true if any file stamps need refreshing.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if ((reader.String() != FormatId) || (reader.String() != GetToolStamp()))
+    {
+        return false;
+    }
+
+    for (auto count = reader.Number(); count > 0; count--)
+    {
+        std::string name = reader.String();
+
+        if (reader.String() != envVars::Get(name))
+        {
+            return false;
+        }
+
+        usedVars.insert(name);
+    }
+
+    isStale = false;
+
+    for (auto count = reader.Number(); count > 0; count--)
+    {
+        FileStamp_t stamp;
+        FileStamp_t current;
+
+        stamp.path = reader.String();
+        stamp.mtimeSec = reader.Number();
+        stamp.mtimeNsec = reader.Number();
+        stamp.size = reader.Number();
+        stamp.md5 = reader.String();
+
+        if (!StatFile(stamp.path, current))
+        {
+            return false;
+        }
+
+        // If the file was touched but not changed, the entry is still good, but its stamps
+        // should be updated so the content doesn't have to be hashed again next time.
+        if (   (current.mtimeSec != stamp.mtimeSec)
+            || (current.mtimeNsec != stamp.mtimeNsec)
+            || (current.size != stamp.size))
+        {
+            if (!GetFileStamp(stamp.path, current) || (current.md5 != stamp.md5))
+            {
+                return false;
+            }
+
+            stamp = current;
+            isStale = true;
+        }
+
+        stamps.push_back(stamp);
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a cache entry file.  Errors are ignored, as they just mean the file will be parsed again
+ * next time.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteEntry
+(
+    const std::string& entryPath,
+    const Writer_t& writer
+)
+//--------------------------------------------------------------------------------------------------
+{
+    try
+    {
+        file::MakeDir(CacheDir);
+    }
+    catch (mk::Exception_t& e)
+    {
+        return;
+    }
+
+    // Write to a temporary file and rename it, so a concurrent reader never sees a partial entry.
+    // Entries may be written by several threads, so the name is unique within the process too.
+    static std::atomic<unsigned int> tempFileCount(0);
+    std::string tempPath = entryPath + mk::format(".%d.%u", getpid(), tempFileCount++);
+    {
+        std::ofstream outputStream(tempPath, std::ios::binary | std::ios::trunc);
+
+        outputStream << writer.Buffer();
+
+        if (!outputStream.good())
+        {
+            outputStream.close();
+            unlink(tempPath.c_str());
+            return;
+        }
+    }
+
+    if (rename(tempPath.c_str(), entryPath.c_str()) != 0)
+    {
+        unlink(tempPath.c_str());
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the directory the cache entries are kept in, enabling the cache.  The directory is created
+ * when the first entry is saved.
+ */
+//--------------------------------------------------------------------------------------------------
+void SetDir
+(
+    const std::string& dirPath
+)
+//--------------------------------------------------------------------------------------------------
+{
+    CacheDir = path::MakeAbsolute(dirPath);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a token reference.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteTokenRef
+(
+    Writer_t& writer,
+    const std::unordered_map<const parseTree::Token_t*, TokenRef_t>& tokenRefs,
+    const parseTree::Token_t* tokenPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (tokenPtr == NULL)
+    {
+        writer.Number(0);
+        writer.Number(0);
+    }
+    else
+    {
+        auto& ref = tokenRefs.at(tokenPtr);
+
+        writer.Number(ref.fragment + 1);
+        writer.Number(ref.index);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Writes a section or item, and all its content.
+ */
+//--------------------------------------------------------------------------------------------------
+static void WriteItem
+(
+    Writer_t& writer,
+    const std::unordered_map<const parseTree::Token_t*, TokenRef_t>& tokenRefs,
+    const parseTree::CompoundItem_t* itemPtr
+)
+//--------------------------------------------------------------------------------------------------
+{
+    writer.Number(itemPtr->type);
+    WriteTokenRef(writer, tokenRefs, itemPtr->firstTokenPtr);
+    WriteTokenRef(writer, tokenRefs, itemPtr->lastTokenPtr);
+
+    auto listPtr = dynamic_cast<const parseTree::CompoundItemList_t*>(itemPtr);
+
+    if (listPtr != NULL)
+    {
+        writer.Number(listPtr->Contents().size());
+        for (auto contentPtr : listPtr->Contents())
+        {
+            WriteItem(writer, tokenRefs, contentPtr);
+        }
+    }
+    else
+    {
+        auto tokenListPtr = parseTree::ToTokenListPtr(itemPtr);
+
+        writer.Number(tokenListPtr->Contents().size());
+        for (auto tokenPtr : tokenListPtr->Contents())
+        {
+            WriteTokenRef(writer, tokenRefs, tokenPtr);
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Saves the parse tree of a definition file that has just been parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+void Save
+(
+    const parseTree::DefFile_t* defFilePtr,     ///< The definition file object.
+    const std::set<std::string>& usedVars       ///< Build variables used by directives.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (CacheDir.empty() || (defFilePtr->type == parseTree::DefFile_t::SDEF))
+    {
+        return;
+    }
+
+    // List the fragments, the file itself first, then the files it includes, depth first.
+    std::vector<const parseTree::DefFileFragment_t*> fragments;
+    std::unordered_map<const parseTree::DefFileFragment_t*, size_t> fragmentIndexes;
+    std::stack<const parseTree::DefFileFragment_t*> toVisit;
+
+    toVisit.push(defFilePtr);
+
+    while (!toVisit.empty())
+    {
+        auto fragmentPtr = toVisit.top();
+        toVisit.pop();
+
+        fragmentIndexes[fragmentPtr] = fragments.size();
+        fragments.push_back(fragmentPtr);
+
+        for (auto& include : fragmentPtr->includedFiles)
+        {
+            toVisit.push(include.second);
+        }
+    }
+
+    std::vector<FileStamp_t> stamps(fragments.size());
+    std::vector<std::vector<const parseTree::Token_t*>> fragmentTokens(fragments.size());
+    std::unordered_map<const parseTree::Token_t*, TokenRef_t> tokenRefs;
+
+    for (size_t i = 0; i < fragments.size(); i++)
+    {
+        if (!GetFileStamp(fragments[i]->path, stamps[i]))
+        {
+            return;
+        }
+
+        // Each fragment's tokens are chained together, starting from its last token.
+        auto tokenPtr = fragments[i]->lastTokenPtr;
+        while (tokenPtr != NULL)
+        {
+            fragmentTokens[i].push_back(tokenPtr);
+            tokenPtr = tokenPtr->prevPtr;
+        }
+        std::reverse(fragmentTokens[i].begin(), fragmentTokens[i].end());
+
+        for (size_t j = 0; j < fragmentTokens[i].size(); j++)
+        {
+            tokenRefs[fragmentTokens[i][j]] = { i, j };
+        }
+    }
+
+    Writer_t writer;
+
+    WriteHeader(writer, usedVars, stamps);
+
+    for (size_t i = 0; i < fragments.size(); i++)
+    {
+        writer.Number(fragmentTokens[i].size());
+        for (auto tokenPtr : fragmentTokens[i])
+        {
+            writer.Number(tokenPtr->type);
+            writer.Number(tokenPtr->line);
+            writer.Number(tokenPtr->column);
+            writer.String(tokenPtr->text);
+        }
+
+        writer.Number(fragments[i]->includedFiles.size());
+        for (auto& include : fragments[i]->includedFiles)
+        {
+            writer.Number(tokenRefs.at(include.first).index);
+            writer.Number(fragmentIndexes.at(include.second));
+        }
+    }
+
+    writer.Number(defFilePtr->sections.size());
+    for (auto sectionPtr : defFilePtr->sections)
+    {
+        WriteItem(writer, tokenRefs, sectionPtr);
+    }
+
+    WriteEntry(GetEntryPath("def", defFilePtr->path), writer);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a token reference, checking that it refers to a token that exists.
+ *
+ * @throw mk::Exception_t if the entry is malformed.
+ */
+//--------------------------------------------------------------------------------------------------
+static TokenRef_t ReadTokenRef
+(
+    Reader_t& reader,
+    const std::vector<CachedFragment_t>& fragments
+)
+//--------------------------------------------------------------------------------------------------
+{
+    TokenRef_t ref;
+
+    ref.fragment = reader.Number();
+    ref.index = reader.Number();
+
+    if (   (ref.fragment > fragments.size())
+        || ((ref.fragment > 0) && (ref.index >= fragments[ref.fragment - 1].tokens.size())))
+    {
+        throw mk::Exception_t("bad token reference");
+    }
+
+    return ref;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Reads a section or item, and all its content.
+ *
+ * @throw mk::Exception_t if the entry is malformed.
+ */
+//--------------------------------------------------------------------------------------------------
+static void ReadItem
+(
+    Reader_t& reader,
+    const std::vector<CachedFragment_t>& fragments,
+    CachedItem_t& item
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto type = reader.Number();
+
+    if ((type == parseTree::Content_t::TOKEN) || (type > parseTree::Content_t::MODULE))
+    {
+        throw mk::Exception_t("bad content type");
+    }
+
+    item.type = static_cast<parseTree::Content_t::Type_t>(type);
+    item.first = ReadTokenRef(reader, fragments);
+    item.last = ReadTokenRef(reader, fragments);
+
+    if (item.first.fragment == 0)
+    {
+        throw mk::Exception_t("missing first token");
+    }
+
+    auto count = reader.Number();
+
+    switch (item.type)
+    {
+        case parseTree::Content_t::COMPLEX_SECTION:
+        case parseTree::Content_t::APP:
+        case parseTree::Content_t::MODULE:
+
+            item.items.resize(count);
+            for (auto& subItem : item.items)
+            {
+                ReadItem(reader, fragments, subItem);
+            }
+            break;
+
+        default:
+
+            for (; count > 0; count--)
+            {
+                item.tokens.push_back(ReadTokenRef(reader, fragments));
+            }
+            break;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Creates a section or item, and all its content, from what was read from a cache entry.
+ *
+ * @return A pointer to the new object.
+ */
+//--------------------------------------------------------------------------------------------------
+static parseTree::CompoundItem_t* BuildItem
+(
+    const std::vector<std::vector<parseTree::Token_t*>>& tokens,
+    const CachedItem_t& item
+)
+//--------------------------------------------------------------------------------------------------
+{
+    auto tokenPtr = [&tokens](const TokenRef_t& ref) -> parseTree::Token_t*
+        {
+            return (ref.fragment == 0) ? NULL : tokens[ref.fragment - 1][ref.index];
+        };
+
+    parseTree::CompoundItem_t* itemPtr;
+
+    switch (item.type)
+    {
+        case parseTree::Content_t::COMPLEX_SECTION:
+        case parseTree::Content_t::APP:
+        case parseTree::Content_t::MODULE:
+        {
+            parseTree::CompoundItemList_t* listPtr;
+
+            if (item.type == parseTree::Content_t::COMPLEX_SECTION)
+            {
+                listPtr = new parseTree::ComplexSection_t(tokenPtr(item.first));
+            }
+            else if (item.type == parseTree::Content_t::APP)
+            {
+                listPtr = new parseTree::App_t(tokenPtr(item.first));
+            }
+            else
+            {
+                listPtr = new parseTree::Module_t(tokenPtr(item.first));
+            }
+
+            for (auto& subItem : item.items)
+            {
+                listPtr->AddContent(BuildItem(tokens, subItem));
+            }
+
+            itemPtr = listPtr;
+            break;
+        }
+
+        default:
+        {
+            auto listPtr = parseTree::CreateTokenList(item.type, tokenPtr(item.first));
+
+            // Some token lists (e.g., bindings) add their first token to their content themselves.
+            for (size_t i = listPtr->Contents().size(); i < item.tokens.size(); i++)
+            {
+                listPtr->AddContent(tokenPtr(item.tokens[i]));
+            }
+
+            itemPtr = listPtr;
+            break;
+        }
+    }
+
+    itemPtr->lastTokenPtr = tokenPtr(item.last);
+
+    return itemPtr;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Populates an empty definition file object from its cache entry, if it has a valid one.
+ *
+ * @return true if the object was populated, false if it has to be parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+bool Load
+(
+    parseTree::DefFile_t* defFilePtr,   ///< The definition file object to populate.
+    std::set<std::string>& usedVars     ///< [OUT] Build variables used by directives.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (CacheDir.empty() || (defFilePtr->type == parseTree::DefFile_t::SDEF))
+    {
+        return false;
+    }
+
+    std::string buffer;
+
+    if (!ReadFile(GetEntryPath("def", defFilePtr->path), buffer))
+    {
+        return false;
+    }
+
+    std::vector<FileStamp_t> stamps;
+    std::vector<CachedFragment_t> fragments;
+    std::vector<CachedItem_t> sections;
+    bool isStale;
+
+    // Read and check everything before touching the definition file object.
+    try
+    {
+        Reader_t reader(buffer);
+
+        if (   !ReadHeader(reader, usedVars, stamps, isStale)
+            || stamps.empty()
+            || (stamps[0].path != defFilePtr->path))
+        {
+            return false;
+        }
+
+        fragments.resize(stamps.size());
+
+        for (auto& fragment : fragments)
+        {
+            fragment.tokens.resize(reader.Number());
+            for (auto& token : fragment.tokens)
+            {
+                auto type = reader.Number();
+
+                if (type > parseTree::Token_t::DIRECTIVE)
+                {
+                    throw mk::Exception_t("bad token type");
+                }
+
+                token.type = static_cast<parseTree::Token_t::Type_t>(type);
+                token.line = reader.Number();
+                token.column = reader.Number();
+                token.text = reader.String();
+            }
+
+            for (auto count = reader.Number(); count > 0; count--)
+            {
+                size_t tokenIndex = reader.Number();
+                size_t fragmentIndex = reader.Number();
+
+                if (   (tokenIndex >= fragment.tokens.size())
+                    || (fragmentIndex == 0)
+                    || (fragmentIndex >= stamps.size()))
+                {
+                    throw mk::Exception_t("bad include");
+                }
+
+                fragment.includes.push_back(std::make_pair(tokenIndex, fragmentIndex));
+            }
+        }
+
+        sections.resize(reader.Number());
+        for (auto& section : sections)
+        {
+            ReadItem(reader, fragments, section);
+        }
+
+        if (!reader.AtEnd())
+        {
+            return false;
+        }
+    }
+    catch (mk::Exception_t& e)
+    {
+        return false;
+    }
+
+    // Rebuild the fragments and their tokens.
+    std::vector<parseTree::DefFileFragment_t*> fragmentPtrs;
+    std::vector<std::vector<parseTree::Token_t*>> tokenPtrs(fragments.size());
+
+    fragmentPtrs.push_back(defFilePtr);
+    for (size_t i = 1; i < fragments.size(); i++)
+    {
+        fragmentPtrs.push_back(new parseTree::DefFileFragment_t(stamps[i].path));
+    }
+
+    for (size_t i = 0; i < fragments.size(); i++)
+    {
+        for (auto& token : fragments[i].tokens)
+        {
+            auto tokenPtr = new parseTree::Token_t(token.type,
+                                                   fragmentPtrs[i],
+                                                   token.line,
+                                                   token.column);
+            tokenPtr->text = token.text;
+            tokenPtrs[i].push_back(tokenPtr);
+        }
+
+        for (auto& include : fragments[i].includes)
+        {
+            fragmentPtrs[i]->includedFiles.insert(
+                std::make_pair(tokenPtrs[i][include.first], fragmentPtrs[include.second])
+            );
+        }
+    }
+
+    // Rebuild the parse tree.
+    for (auto& section : sections)
+    {
+        defFilePtr->sections.push_back(BuildItem(tokenPtrs, section));
+    }
+
+    if (isStale)
+    {
+        Save(defFilePtr, usedVars);
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the dependencies of a .api file from its cache entry, if it has a valid one.
+ *
+ * @return true if the dependencies were found, false if the file has to be parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+bool LoadApiDependencies
+(
+    const std::string& filePath,            ///< Path to the .api file.
+    std::list<std::string>& dependencies    ///< [OUT] The USETYPES dependencies, in order.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (CacheDir.empty())
+    {
+        return false;
+    }
+
+    std::string absPath = path::MakeAbsolute(filePath);
+    std::string buffer;
+
+    if (!ReadFile(GetEntryPath("api", absPath), buffer))
+    {
+        return false;
+    }
+
+    std::set<std::string> usedVars;
+    std::vector<FileStamp_t> stamps;
+    std::list<std::string> result;
+    bool isStale;
+
+    try
+    {
+        Reader_t reader(buffer);
+
+        if (   !ReadHeader(reader, usedVars, stamps, isStale)
+            || (stamps.size() != 1)
+            || (stamps[0].path != absPath))
+        {
+            return false;
+        }
+
+        for (auto count = reader.Number(); count > 0; count--)
+        {
+            result.push_back(reader.String());
+        }
+
+        if (!reader.AtEnd())
+        {
+            return false;
+        }
+    }
+    catch (mk::Exception_t& e)
+    {
+        return false;
+    }
+
+    dependencies = std::move(result);
+
+    if (isStale)
+    {
+        SaveApiDependencies(absPath, dependencies);
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Saves the dependencies of a .api file that has just been parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+void SaveApiDependencies
+(
+    const std::string& filePath,                ///< Path to the .api file.
+    const std::list<std::string>& dependencies  ///< The USETYPES dependencies, in order.
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (CacheDir.empty())
+    {
+        return;
+    }
+
+    std::string absPath = path::MakeAbsolute(filePath);
+    std::vector<FileStamp_t> stamps(1);
+
+    if (!GetFileStamp(absPath, stamps[0]))
+    {
+        return;
+    }
+
+    Writer_t writer;
+
+    WriteHeader(writer, {}, stamps);
+
+    writer.Number(dependencies.size());
+    for (auto& dependency : dependencies)
+    {
+        writer.String(dependency);
+    }
+
+    WriteEntry(GetEntryPath("api", absPath), writer);
+}
+
+
+} // namespace cache
+
+} // namespace parser
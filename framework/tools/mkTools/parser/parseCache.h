@@ -0,0 +1,95 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file parseCache.h  On-disk cache of parsed definition files and .api file dependencies.
+ *
+ * Each cache entry holds the parse tree of one .cdef, .adef or .mdef file (including the tokens
+ * of any files it #includes), or the list of USETYPES dependencies of one .api file.  An entry is
+ * only used if every file it was read from still has the same modification time and size (or,
+ * failing that, the same MD5 hash of its content), if every build variable used by the
+ * processing directives still has the same value, and if the entry was written by the same mk
+ * tools executable.
+ *
+ * .sdef files are never cached, because parsing them defines build variables.  Neither are files
+ * whose parse depends on which other files exist (file_exists(), dir_exists(), or an #include
+ * that was only found under $LEGATO_ROOT), because that can't be checked from the files read.
+ *
+ * The cache is disabled until SetDir() is called.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_MKTOOLS_PARSE_CACHE_H_INCLUDE_GUARD
+#define LEGATO_MKTOOLS_PARSE_CACHE_H_INCLUDE_GUARD
+
+namespace cache
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Sets the directory the cache entries are kept in, enabling the cache.  The directory is created
+ * when the first entry is saved.
+ */
+//--------------------------------------------------------------------------------------------------
+void SetDir
+(
+    const std::string& dirPath
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Populates an empty definition file object from its cache entry, if it has a valid one.
+ *
+ * @return true if the object was populated, false if it has to be parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+bool Load
+(
+    parseTree::DefFile_t* defFilePtr,   ///< The definition file object to populate.
+    std::set<std::string>& usedVars     ///< [OUT] Build variables used by directives.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Saves the parse tree of a definition file that has just been parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+void Save
+(
+    const parseTree::DefFile_t* defFilePtr,     ///< The definition file object.
+    const std::set<std::string>& usedVars       ///< Build variables used by directives.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Gets the dependencies of a .api file from its cache entry, if it has a valid one.
+ *
+ * @return true if the dependencies were found, false if the file has to be parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+bool LoadApiDependencies
+(
+    const std::string& filePath,            ///< Path to the .api file.
+    std::list<std::string>& dependencies    ///< [OUT] The USETYPES dependencies, in order.
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Saves the dependencies of a .api file that has just been parsed.
+ */
+//--------------------------------------------------------------------------------------------------
+void SaveApiDependencies
+(
+    const std::string& filePath,                ///< Path to the .api file.
+    const std::list<std::string>& dependencies  ///< The USETYPES dependencies, in order.
+);
+
+
+} // namespace cache
+
+#endif // LEGATO_MKTOOLS_PARSE_CACHE_H_INCLUDE_GUARD
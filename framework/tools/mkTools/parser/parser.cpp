@@ -305,6 +305,9 @@ parseTree::CompoundItemList_t* ParseSimpleNamedItemListSection
  * The section parser function must return a pointer to a section (CompoundItem_t, which will be
  * added to the list of sections in the DefFile_t), or throw an exception on error.
  *
+ * If the file has already been parsed by a worker thread (see parseAhead.h), or has a valid entry
+ * in the parse cache, the DefFile_t is populated from that instead.
+ *
  * @throw mk::Exception_t if an error is encountered.
  */
 //--------------------------------------------------------------------------------------------------
@@ -316,6 +319,37 @@ void ParseFile
 )
 //--------------------------------------------------------------------------------------------------
 {
+    // Time spent on worker threads is measured separately.
+    timing::Scope_t timingScope(ahead::IsWorkerThread() ? NULL : "Parsing");
+
+    if (ahead::Take(defFilePtr))
+    {
+        if (beVerbose)
+        {
+            std::cout << mk::format(LE_I18N("Parsing file: '%s'."), defFilePtr->path)
+                      << std::endl;
+        }
+
+        return;
+    }
+
+    std::set<std::string> usedVars;
+
+    // If the file hasn't changed since it was last parsed, use the cached parse tree.
+    if (cache::Load(defFilePtr, usedVars))
+    {
+        if (beVerbose)
+        {
+            std::cout << mk::format(LE_I18N("Using cached parse tree for file: '%s'."),
+                                    defFilePtr->path)
+                      << std::endl;
+        }
+
+        ahead::NoteUsedVars(usedVars);
+
+        return;
+    }
+
     if (beVerbose)
     {
         std::cout << mk::format(LE_I18N("Parsing file: '%s'."), defFilePtr->path)
@@ -338,6 +372,15 @@ void ParseFile
             lexer.UnexpectedChar(LE_I18N("Unexpected character %s"));
         }
     }
+
+    usedVars = lexer.UsedVarNames();
+
+    ahead::NoteUsedVars(usedVars);
+
+    if (!lexer.DependsOnFileTests())
+    {
+        cache::Save(defFilePtr, usedVars);
+    }
 }
 
 
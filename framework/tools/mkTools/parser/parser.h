@@ -14,6 +14,8 @@
  * - @ref mdefParser.h
  * - @ref sdefParser.h
  * - @ref apiParser.h
+ * - @ref parseCache.h
+ * - @ref parseAhead.h
  *
  * Also, there's a set of parsing functions declared in @ref parser.h that are shared by multiple
  * parsers.
@@ -23,6 +25,13 @@
  * function, which is used internally and by the parsing functions to throw exceptions containing
  * error reports with the current file path, line number and column number in them.
  *
+ * Parse trees of .cdef, .adef and .mdef files, and the dependencies of .api files, are kept in an
+ * on-disk cache (see @ref parseCache.h) in the build's working directory, so that files that
+ * haven't changed since the last build don't have to be parsed again.
+ *
+ * The modellers can also have files they're going to need later parsed in parallel, on worker
+ * threads (see @ref parseAhead.h).
+ *
  * <hr>
  *
  * Copyright (C) Sierra Wireless Inc.
@@ -50,6 +59,8 @@ namespace parser
 #include "mdefParser.h"
 #include "sdefParser.h"
 #include "apiParser.h"
+#include "parseCache.h"
+#include "parseAhead.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -0,0 +1,180 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file timing.cpp
+ *
+ * Measures how long the mk tools spend in each phase of a build.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#include "mkTools.h"
+#include <iomanip>
+#include <mutex>
+#include <string.h>
+
+
+namespace timing
+{
+
+
+/// Time and number of times spent in a phase.
+typedef struct
+{
+    const char* name;
+    std::chrono::steady_clock::duration total;
+    size_t count;
+}
+Phase_t;
+
+
+/// true once Enable() has been called.
+static bool IsEnabled = false;
+
+/// When Enable() was called.
+static std::chrono::steady_clock::time_point StartTime;
+
+/// Phases, in the order they were first entered.  Protected by PhasesMutex.
+static std::vector<Phase_t> Phases;
+static std::mutex PhasesMutex;
+
+/// Phases being measured on the calling thread.  Phases are compared by name, not by pointer, as
+/// the same string literal may have different addresses in different source files.
+static thread_local std::set<std::string> ActivePhases;
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts measuring time.
+ */
+//--------------------------------------------------------------------------------------------------
+void Enable
+(
+    void
+)
+//--------------------------------------------------------------------------------------------------
+{
+    StartTime = std::chrono::steady_clock::now();
+    IsEnabled = true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Constructor.  Starts measuring, unless the phase is already being measured on this thread.
+ */
+//--------------------------------------------------------------------------------------------------
+Scope_t::Scope_t
+(
+    const char* name    ///< The phase, or NULL.
+)
+//--------------------------------------------------------------------------------------------------
+:   phaseName(NULL)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsEnabled || (name == NULL))
+    {
+        return;
+    }
+
+    if (ActivePhases.insert(name).second)
+    {
+        phaseName = name;
+        startTime = std::chrono::steady_clock::now();
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Destructor.  Adds the time since construction to the phase.
+ */
+//--------------------------------------------------------------------------------------------------
+Scope_t::~Scope_t
+(
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (phaseName == NULL)
+    {
+        return;
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - startTime;
+
+    ActivePhases.erase(phaseName);
+
+    std::lock_guard<std::mutex> lock(PhasesMutex);
+
+    for (auto& phase : Phases)
+    {
+        if (strcmp(phase.name, phaseName) == 0)
+        {
+            phase.total += elapsed;
+            phase.count++;
+            return;
+        }
+    }
+
+    Phases.push_back({ phaseName, elapsed, 1 });
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Converts a duration to milliseconds.
+ */
+//--------------------------------------------------------------------------------------------------
+static double ToMilliseconds
+(
+    std::chrono::steady_clock::duration duration
+)
+//--------------------------------------------------------------------------------------------------
+{
+    return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(duration).count();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the time spent in each phase so far, in the order the phases were first entered.
+ * Does nothing if Enable() hasn't been called.
+ */
+//--------------------------------------------------------------------------------------------------
+void PrintReport
+(
+    std::ostream& outputStream
+)
+//--------------------------------------------------------------------------------------------------
+{
+    if (!IsEnabled)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(PhasesMutex);
+
+    outputStream << LE_I18N("Timings:") << std::endl;
+
+    auto flags = outputStream.flags();
+    auto precision = outputStream.precision();
+    outputStream << std::fixed << std::setprecision(1);
+
+    for (auto& phase : Phases)
+    {
+        outputStream << "  " << std::left << std::setw(40) << phase.name
+                     << std::right << std::setw(10) << ToMilliseconds(phase.total) << " ms"
+                     << "  (x" << phase.count << ")" << std::endl;
+    }
+
+    outputStream << "  " << std::left << std::setw(40) << LE_I18N("Total")
+                 << std::right << std::setw(10)
+                 << ToMilliseconds(std::chrono::steady_clock::now() - StartTime) << " ms"
+                 << std::endl;
+
+    outputStream.flags(flags);
+    outputStream.precision(precision);
+}
+
+
+} // namespace timing
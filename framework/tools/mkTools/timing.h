@@ -0,0 +1,75 @@
+//--------------------------------------------------------------------------------------------------
+/**
+ * @file timing.h
+ *
+ * Measures how long the mk tools spend in each phase of a build (parsing, modelling, code
+ * generation, etc.), for the report printed when the --timings option is given.
+ *
+ * Time is only measured once Enable() has been called.  Phases can be timed from any thread.
+ * A phase entered again while it is already being timed on the same thread (e.g., by recursion)
+ * is only counted once.
+ *
+ * Copyright (C) Sierra Wireless Inc.
+ */
+//--------------------------------------------------------------------------------------------------
+
+#ifndef LEGATO_MKTOOLS_TIMING_H_INCLUDE_GUARD
+#define LEGATO_MKTOOLS_TIMING_H_INCLUDE_GUARD
+
+#include <chrono>
+
+namespace timing
+{
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Starts measuring time.
+ */
+//--------------------------------------------------------------------------------------------------
+void Enable
+(
+    void
+);
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Measures the time spent in a phase, from construction until destruction.
+ *
+ * Phase names must be string literals (or otherwise live until the report is printed).  A NULL
+ * phase name measures nothing.
+ */
+//--------------------------------------------------------------------------------------------------
+class Scope_t
+{
+    public:
+
+        Scope_t(const char* phaseName);
+        ~Scope_t();
+
+    private:
+
+        const char* phaseName;  ///< The phase, or NULL if not measuring.
+        std::chrono::steady_clock::time_point startTime;
+
+        Scope_t(const Scope_t&) = delete;
+        Scope_t& operator=(const Scope_t&) = delete;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the time spent in each phase so far, in the order the phases were first entered.
+ * Does nothing if Enable() hasn't been called.
+ */
+//--------------------------------------------------------------------------------------------------
+void PrintReport
+(
+    std::ostream& outputStream
+);
+
+
+} // namespace timing
+
+#endif // LEGATO_MKTOOLS_TIMING_H_INCLUDE_GUARD
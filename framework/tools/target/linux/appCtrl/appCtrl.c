@@ -202,6 +202,7 @@ static void PrintHelp
         "    app status [<appName>]\n"
         "    app version <appName>\n"
         "    app info [<appName>]\n"
+        "    app usage [<appName>]\n"
         "    app runProc <appName> <procName> [options]\n"
         "    app runProc <appName> [<procName>] --exe=<exePath> [options]\n"
         "\n"
@@ -249,6 +250,14 @@ static void PrintHelp
         "       If no name is given, prints the information of all installed applications.\n"
         "       If a name is given, prints the information of the specified application.\n"
         "\n"
+        "    app usage [<appName>]\n"
+        "       If no name is given, prints the recent resource usage of all installed\n"
+        "       applications.  If a name is given, prints the recent resource usage of the\n"
+        "       specified application.  The cpu use, resident memory and page faults are\n"
+        "       summarized over the last minute, as sampled by the Supervisor.  The Supervisor\n"
+        "       only samples while a client is asking for the usage, so if no samples have been\n"
+        "       taken yet this waits for a few of them.\n"
+        "\n"
         "    app runProc <appName> <procName> [options]\n"
         "       Runs a configured process inside an app using the process settings from the\n"
         "       configuration database.  If an exePath is provided as an option then the specified\n"
@@ -664,6 +673,81 @@ static void PrintStatus
 }
 
 
+//--------------------------------------------------------------------------------------------------
+/**
+ * Prints the recent resource usage of an application.
+ */
+//--------------------------------------------------------------------------------------------------
+static void PrintAppUsage
+(
+    const char* appNamePtr      ///< [IN] Application name to get the usage for.
+)
+{
+    uint32_t cpuPermille;
+    uint32_t peakCpuPermille;
+    uint64_t rssBytes;
+    uint64_t peakRssBytes;
+    uint32_t pageFaults;
+    uint32_t majorPageFaults;
+
+    le_appInfo_ConnectService();
+
+    le_result_t result = le_appInfo_GetUsage(appNamePtr, 0, &cpuPermille, &peakCpuPermille,
+                                             &rssBytes, &peakRssBytes, &pageFaults,
+                                             &majorPageFaults);
+
+    // The first request starts the sampling, so give the Supervisor time to take some samples.
+    // Once is enough, as sampling then goes on until we disconnect.
+    static bool hasWaitedForSamples = false;
+
+    if ((result == LE_NOT_FOUND) && !hasWaitedForSamples)
+    {
+        hasWaitedForSamples = true;
+        sleep(2 * LE_APPINFO_USAGE_SAMPLE_INTERVAL_MS / 1000 + 1);
+
+        result = le_appInfo_GetUsage(appNamePtr, 0, &cpuPermille, &peakCpuPermille, &rssBytes,
+                                     &peakRssBytes, &pageFaults, &majorPageFaults);
+    }
+
+    if (result != LE_OK)
+    {
+        printf("[no samples] %s\n", appNamePtr);
+        return;
+    }
+
+    printf("%s\n", appNamePtr);
+    printf("    cpu: %u.%u%% (peak %u.%u%%)\n",
+           cpuPermille / 10, cpuPermille % 10, peakCpuPermille / 10, peakCpuPermille % 10);
+    printf("    rss: %" PRIu64 " KB (peak %" PRIu64 " KB)\n", rssBytes / 1024, peakRssBytes / 1024);
+    printf("    page faults: %u (major %u)\n", pageFaults, majorPageFaults);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+/**
+ * Implements the "usage" command.
+ *
+ * @note This function does not return.
+ **/
+//--------------------------------------------------------------------------------------------------
+static void PrintUsage
+(
+    void
+)
+{
+    if (AppNamePtr == NULL)
+    {
+        ListInstalledApps(PrintAppUsage);
+    }
+    else
+    {
+        PrintAppUsage(AppNamePtr);
+    }
+
+    exit(EXIT_SUCCESS);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 /**
  * Parses a line of the APP_INFO_FILE for display.
@@ -1872,6 +1956,14 @@ static void CommandArgHandler
         le_arg_AddPositionalCallback(AppNameArgHandler);
         le_arg_AllowLessPositionalArgsThanCallbacks();
     }
+    else if (strcmp(command, "usage") == 0)
+    {
+        CommandFunc = PrintUsage;
+
+        // Accept an optional app name argument.
+        le_arg_AddPositionalCallback(AppNameArgHandler);
+        le_arg_AllowLessPositionalArgsThanCallbacks();
+    }
     else
     {
         fprintf(stderr, "Unknown command '%s'.  Try --help.\n", command);